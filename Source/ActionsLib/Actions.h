@@ -24,6 +24,8 @@ template <typename ElemType>
 void DoAdapt(const ConfigParameters& config);
 template <typename ElemType>
 void DoEdit(const ConfigParameters& config);
+template <typename ElemType>
+void DoBenchmarkNetwork(const ConfigParameters& config);
 
 // evaluation (EvalActions.cpp)
 template <typename ElemType>
@@ -42,6 +44,12 @@ template <typename ElemType>
 void DoWriteWordAndClassInfo(const ConfigParameters& config);
 template <typename ElemType>
 void DoTopologyPlot(const ConfigParameters& config);
+template <typename ElemType>
+void DoReaderBench(const ConfigParameters& config);
+template <typename ElemType>
+void DoDumpBinaryTrace(const ConfigParameters& config);
+template <typename ElemType>
+void DoRemapVocabulary(const ConfigParameters& config);
 
 // special purpose (EsotericActions.cp)
 template <typename ElemType>
@@ -18,6 +18,7 @@
 #include "SimpleEvaluator.h"
 #include "SimpleOutputWriter.h"
 #include "BestGpu.h"
+#include "MPIWrapper.h"
 #include "ScriptableObjects.h"
 #include "BrainScriptEvaluator.h"
 
@@ -66,6 +67,8 @@ static void DoEvalBase(const ConfigParameters& config, IDataReader<ElemType>& re
     }
 
     auto net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, modelPath);
+    if (config(L"graphOptimizations", false)) // eval-only rewrite; the model file is never re-saved here
+        net->EnableGraphOptimizations(true);
 
     SimpleEvaluator<ElemType> eval(net, numMBsToShowResult, traceLevel);
     eval.Evaluate(&reader, evalNodeNamesVector, mbSize[0], epochSize);
@@ -122,11 +125,8 @@ void DoCrossValidate(const ConfigParameters& config)
         evalNodeNamesVector.push_back(evalNodeNames[i]);
     }
 
-    std::vector<std::vector<double>> cvErrorResults;
+    // build the list of checkpoint models to evaluate (identical on every MPI rank)
     std::vector<std::wstring> cvModels;
-
-    DataReader<ElemType> cvDataReader(readerConfig);
-
     bool finalModelEvaluated = false;
     for (size_t i = cvInterval[0]; i <= cvInterval[2]; i += cvInterval[1])
     {
@@ -145,23 +145,62 @@ void DoCrossValidate(const ConfigParameters& config)
         }
 
         cvModels.push_back(cvModelPath);
-        auto net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, cvModelPath);
+    }
+
+    if (cvModels.size() == 0)
+    {
+        LogicError("No model is evaluated.");
+    }
+
+    // When running under MPI (parallelTrain=true and mpiexec), fan the checkpoints out across the
+    // ranks: rank r evaluates every numRanks-th model on its own device and network instance, and
+    // the result table is reassembled in order below. One process per GPU is the multi-GPU model
+    // of this code base (a process cannot drive more than one GPU, see EnforceOneGPUOnly()), so
+    // e.g. 4 local ranks with deviceId=auto spread the checkpoint list over 4 GPUs of the box.
+    const size_t numRanks = (g_mpi != nullptr) ? g_mpi->NumNodesInUse() : 1;
+    const size_t myRank = (g_mpi != nullptr) ? g_mpi->CurrentNodeRank() : 0;
+
+    DataReader<ElemType> cvDataReader(readerConfig);
+
+    std::vector<std::vector<double>> cvErrorResults(cvModels.size());
+    for (size_t m = 0; m < cvModels.size(); m++)
+    {
+        if (m % numRanks != myRank)
+            continue; // another rank evaluates this one
+
+        auto net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, cvModels[m]);
+        if (config(L"graphOptimizations", false)) // eval-only rewrite; the model file is never re-saved here
+            net->EnableGraphOptimizations(true);
 
         SimpleEvaluator<ElemType> eval(net, numMBsToShowResult, traceLevel);
 
-        fprintf(stderr, "model %ls --> \n", cvModelPath.c_str());
-        auto evalErrors = eval.Evaluate(&cvDataReader, evalNodeNamesVector, mbSize[0], epochSize);
-        cvErrorResults.push_back(evalErrors);
+        fprintf(stderr, "model %ls --> \n", cvModels[m].c_str());
+        // each rank scores its models on the full eval set, locally: distributed reading and the
+        // AllReduce inside Evaluate() must stay off here, or every model would only see 1/numRanks
+        // of the data, the AllReduce would sum the partial results of different models, and ranks
+        // owning unequal model counts would issue unequal numbers of collectives (deadlock)
+        cvErrorResults[m] = eval.Evaluate(&cvDataReader, evalNodeNamesVector, mbSize[0], epochSize, false /*distributed*/);
 
         ::Sleep(1000 * sleepSecondsBetweenRuns);
     }
 
-    // find best model
-    if (cvErrorResults.size() == 0)
+    // gather the other ranks' results: every model's error row was filled by exactly one rank,
+    // so a sum-allreduce of the zero-initialized table hands the complete table to every rank
+    if (numRanks > 1)
     {
-        LogicError("No model is evaluated.");
+        size_t numErrs = (myRank == 0) ? cvErrorResults[0].size() : 0; // rank 0 always owns model 0
+        g_mpi->AllReduce(&numErrs, 1);
+        std::vector<double> allErrors(cvModels.size() * numErrs, 0.0);
+        for (size_t m = 0; m < cvModels.size(); m++)
+            if (!cvErrorResults[m].empty())
+                std::copy(cvErrorResults[m].begin(), cvErrorResults[m].end(), allErrors.begin() + m * numErrs);
+        g_mpi->AllReduce(allErrors);
+        for (size_t m = 0; m < cvModels.size(); m++)
+            cvErrorResults[m].assign(allErrors.begin() + m * numErrs, allErrors.begin() + (m + 1) * numErrs);
     }
 
+    // find best model
+
     std::vector<double> minErrors;
     std::vector<int> minErrIds;
     std::vector<double> evalErrors = cvErrorResults[0];
@@ -184,11 +223,14 @@ void DoCrossValidate(const ConfigParameters& config)
         }
     }
 
-    fprintf(stderr, "Best models:\n");
-    fprintf(stderr, "------------\n");
-    for (int i = 0; i < minErrors.size(); ++i)
+    if ((g_mpi == nullptr) || g_mpi->IsMainNode()) // every rank has the full table; report it once
     {
-        fprintf(stderr, "Based on Err[%d]: Best model = %ls with min err %.8g\n", i, cvModels[minErrIds[i]].c_str(), minErrors[i]);
+        fprintf(stderr, "Best models:\n");
+        fprintf(stderr, "------------\n");
+        for (int i = 0; i < minErrors.size(); ++i)
+        {
+            fprintf(stderr, "Based on Err[%d]: Best model = %ls with min err %.8g\n", i, cvModels[minErrIds[i]].c_str(), minErrors[i]);
+        }
     }
 }
 
@@ -227,6 +269,8 @@ void DoWriteOutput(const ConfigParameters& config)
     }
 
     auto net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, modelPath);
+    if (config(L"graphOptimizations", false)) // eval-only rewrite; the model file is never re-saved here
+        net->EnableGraphOptimizations(true);
 
     SimpleOutputWriter<ElemType> writer(net, 1);
 
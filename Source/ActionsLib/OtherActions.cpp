@@ -15,6 +15,9 @@
 #include "Config.h"
 #include "ScriptableObjects.h"
 #include "BrainScriptEvaluator.h"
+#include "ProgressTracing.h"
+#include "ParallelLineScan.h"
+#include "fileutil.h"
 
 #include <string>
 #include <chrono>
@@ -117,6 +120,125 @@ void DoCreateLabelMap(const ConfigParameters& config)
 template void DoCreateLabelMap<float>(const ConfigParameters& config);
 template void DoCreateLabelMap<double>(const ConfigParameters& config);
 
+// ===========================================================================
+// DoReaderBench() - implements CNTK "readerBench" command
+//
+// Drives the configured reader through StartMinibatchLoop()/GetMinibatch() at
+// maximum speed, without any network attached, and reports throughput
+// (minibatches/s, samples/s, MB/s), per-call latency percentiles, and how the
+// time splits between the reader call itself, the layout copy, and a
+// first-touch pass over the returned data. This makes reader configurations
+// (e.g. HTKMLFReader frame mode vs. rollingwindow) comparable without running
+// a training job. Note that I/O vs. parse time cannot be separated below the
+// IDataReader interface without instrumenting every reader plugin; the
+// per-call latency distribution is the observable proxy (cold calls hit I/O,
+// warm calls measure parse/copy).
+// ===========================================================================
+
+// latency percentile over a sample set; 'fraction' in [0,1]
+static double Percentile(std::vector<double> samples, double fraction)
+{
+    if (samples.empty())
+        return 0;
+    std::sort(samples.begin(), samples.end());
+    return samples[(size_t)(fraction * (samples.size() - 1))];
+}
+
+template <typename ElemType>
+void DoReaderBench(const ConfigParameters& config)
+{
+    ConfigParameters readerConfig(config(L"reader"));
+    readerConfig.Insert("traceLevel", config(L"traceLevel", "0"));
+
+    size_t minibatchSize = config(L"minibatchSize", "256");
+    size_t epochSize = config(L"epochSize", "0"); // 0 = whole dataset
+    size_t numPasses = config(L"numPasses", "1");
+    // device of the matrices the reader fills; default CPU measures the reader alone,
+    // a GPU id includes the host-to-device copy the way training would see it
+    DEVICEID_TYPE deviceId = config(L"deviceId", "-1");
+
+    std::vector<std::wstring> featureNames;
+    std::vector<std::wstring> labelNames;
+    GetFileConfigNames(readerConfig, featureNames, labelNames);
+    if (featureNames.empty())
+        RuntimeError("DoReaderBench: reader configuration declares no feature inputs");
+
+    std::list<Matrix<ElemType>> matrixStorage; // owns the matrices; 'matrices' holds the pointers GetMinibatch() wants
+    std::map<std::wstring, Matrix<ElemType>*> matrices;
+    for (const std::wstring& name : featureNames)
+    {
+        matrixStorage.emplace_back(deviceId);
+        matrices[name] = &matrixStorage.back();
+    }
+    for (const std::wstring& name : labelNames)
+    {
+        matrixStorage.emplace_back(deviceId);
+        matrices[name] = &matrixStorage.back();
+    }
+
+    DataReader<ElemType> dataReader(readerConfig);
+    auto pMBLayout = make_shared<MBLayout>();
+
+    std::vector<double> callLatenciesMs;
+    double getMs = 0, layoutMs = 0, touchMs = 0;
+    size_t numMinibatches = 0, numSamples = 0;
+    unsigned long long numBytes = 0;
+    double checksum = 0; // keeps the first-touch pass from being optimized away
+
+    auto t_benchStart = std::chrono::high_resolution_clock::now();
+    for (size_t pass = 0; pass < numPasses; pass++)
+    {
+        dataReader.StartMinibatchLoop(minibatchSize, pass, epochSize == 0 ? requestDataSize : epochSize);
+        for (;;)
+        {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            bool wasDataRead = dataReader.GetMinibatch(matrices);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            if (!wasDataRead)
+                break;
+            dataReader.CopyMBLayoutTo(pMBLayout);
+            auto t2 = std::chrono::high_resolution_clock::now();
+            // touch everything the reader produced, like the network's first kernel would;
+            // this is where a lazy device transfer or page-in would show up
+            for (auto& iter : matrices)
+            {
+                Matrix<ElemType>& m = *iter.second;
+                if (m.GetNumElements() == 0)
+                    continue;
+                checksum += m.SumOfElements();
+                numBytes += (unsigned long long) m.GetNumElements() * sizeof(ElemType);
+            }
+            auto t3 = std::chrono::high_resolution_clock::now();
+
+            double callMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+            callLatenciesMs.push_back(callMs);
+            getMs += callMs;
+            layoutMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+            touchMs += std::chrono::duration<double, std::milli>(t3 - t2).count();
+            numMinibatches++;
+            numSamples += matrices[featureNames[0]]->GetNumCols();
+        }
+    }
+    auto t_benchEnd = std::chrono::high_resolution_clock::now();
+    double totalSec = std::chrono::duration<double>(t_benchEnd - t_benchStart).count();
+
+    if (numMinibatches == 0)
+        RuntimeError("DoReaderBench: the reader produced no minibatches");
+
+    double spentMs = getMs + layoutMs + touchMs;
+    fprintf(stderr, "DoReaderBench: %d minibatches of up to %d samples, %d pass(es), device %d (checksum %g)\n",
+            (int) numMinibatches, (int) minibatchSize, (int) numPasses, (int) deviceId, checksum);
+    fprintf(stderr, "DoReaderBench: throughput  %10.2f minibatches/s  %12.1f samples/s  %10.2f MB/s\n",
+            numMinibatches / totalSec, numSamples / totalSec, numBytes / totalSec / 1e6);
+    fprintf(stderr, "DoReaderBench: GetMinibatch() latency  p50 %8.3f ms  p90 %8.3f ms  p99 %8.3f ms  max %8.3f ms\n",
+            Percentile(callLatenciesMs, 0.5), Percentile(callLatenciesMs, 0.9), Percentile(callLatenciesMs, 0.99), Percentile(callLatenciesMs, 1.0));
+    fprintf(stderr, "DoReaderBench: time split  reader %5.1f%%  layout copy %5.1f%%  first touch %5.1f%%\n",
+            100.0 * getMs / spentMs, 100.0 * layoutMs / spentMs, 100.0 * touchMs / spentMs);
+}
+
+template void DoReaderBench<float>(const ConfigParameters& config);
+template void DoReaderBench<double>(const ConfigParameters& config);
+
 // ===========================================================================
 // DoParameterSVD() - implements CNTK "SVD" command
 // ===========================================================================
@@ -258,26 +380,21 @@ void DoWriteWordAndClassInfo(const ConfigParameters& config)
     Matrix<ElemType> wrd2cls(deviceId);
     Matrix<ElemType> cls2idx(deviceId);
 
-    // FILE *fp = fopen(inputFile.c_str(), "rt");
-    ifstream fp(inputFile.c_str());
-    if (!fp)
-    {
-        RuntimeError("inputFile cannot be read");
-    }
-
     if (nbrCls > 0)
     {
         cls2idx.Resize(nbrCls, 1);
     }
-    std::unordered_map<string, double> v_count;
-
-    // get line
-    string str;
-    vector<string> vstr;
     long long prevClsIdx = -1;
-    string token;
-    while (getline(fp, str))
+
+    // Counting pass as a multi-threaded map-reduce: the corpus is split into byte shards that are
+    // counted in parallel into per-shard hash maps, which are then merged. On multi-GB corpora
+    // this pass is where virtually all of the action's time goes.
+    typedef std::unordered_map<string, double> WordCountMap;
+    auto countLine = [](WordCountMap& counts, const string& inputLine)
     {
+        string str = inputLine;
+        if (!str.empty() && str[str.size() - 1] == '\r') // shards are read in binary mode; drop CR-LF remnants
+            str.erase(str.size() - 1);
         str.erase(0, str.find_first_not_of(' ')); // prefixing spaces
         str.erase(str.find_last_not_of(' ') + 1); // surfixing spaces
         int sposition = str.find("</s> ");
@@ -292,13 +409,18 @@ void DoWriteWordAndClassInfo(const ConfigParameters& config)
             str = str + " </s>";
         }
 
-        vstr = msra::strfun::split(str, "\t ");
+        vector<string> vstr = msra::strfun::split(str, "\t ");
         for (int i = 1; i < vstr.size(); i++)
         {
-            v_count[vstr[i]]++;
+            counts[vstr[i]]++;
         }
-    }
-    fp.close();
+    };
+    auto mergeCounts = [](WordCountMap& into, const WordCountMap& from)
+    {
+        for (WordCountMap::const_iterator iter = from.begin(); iter != from.end(); iter++)
+            into[iter->first] += iter->second;
+    };
+    std::unordered_map<string, double> v_count = ParallelLineMapReduce<WordCountMap>(inputFile, countLine, mergeCounts);
 
     std::cerr << "no truncated vocabulary: " << v_count.size() << std::endl;
 
@@ -457,6 +579,134 @@ void DoWriteWordAndClassInfo(const ConfigParameters& config)
 template void DoWriteWordAndClassInfo<float>(const ConfigParameters& config);
 template void DoWriteWordAndClassInfo<double>(const ConfigParameters& config);
 
+// ===========================================================================
+// DoRemapVocabulary() - implements CNTK "remapVocabulary" command
+// ===========================================================================
+
+///
+/// for action remapVocabulary
+///
+/// reorders a vocabulary by descending sample frequency and permutes the matching
+/// rows (and optionally columns) of a trained model's parameters to match, so that
+/// the most frequent words occupy a contiguous block at the top of the output layer.
+/// Scoring only the frequent words then reads a compact region of the softmax
+/// weights instead of rows scattered across the whole matrix.
+///
+/// To use this command, user need to specify:
+///     1)  modelPath        -- path to the existing model
+///     2)  outputModelPath  -- where to write the remapped model
+///     3)  vocabFile        -- vocabulary file as written by writeWordAndClass
+///                             (columns: index count word class)
+///     4)  outputVocabFile  -- where to write the reordered vocabulary
+///     5)  rowNodeNames     -- parameter nodes whose rows are indexed by word id
+///                             (output-layer weight and bias)
+///     6)  colNodeNames     -- parameter nodes whose columns are indexed by word id
+///                             (e.g. an input embedding), optional
+///
+/// The readers take word ids from the index column of the vocabulary file, so the
+/// rewritten file is all the runtime support needed; no reader change is required.
+/// The class column is carried over per word, but class-based cross entropy assumes
+/// words sorted by class, so this command is only meaningful for models with a flat
+/// softmax output layer.
+template <typename ElemType>
+void DoRemapVocabulary(const ConfigParameters& config)
+{
+    wstring modelPath = config(L"modelPath");
+    wstring outputModelPath = config(L"outputModelPath");
+    string vocabFile = config(L"vocabFile");
+    string outputVocabFile = config(L"outputVocabFile");
+    ConfigArray rowNodeNames = config(L"rowNodeNames");
+    ConfigArray colNodeNames = config(L"colNodeNames", "");
+
+    // read the vocabulary file; same format as ReadClassInfo() expects
+    ifstream fp(vocabFile.c_str());
+    if (!fp)
+        RuntimeError("cannot open vocabulary file %s", vocabFile.c_str());
+
+    vector<size_t> counts;
+    vector<string> words;
+    vector<int> classes;
+    string str;
+    vector<string> vstr;
+    while (getline(fp, str))
+    {
+        str.erase(0, str.find_first_not_of(" \t"));
+        str.erase(str.find_last_not_of(" \t") + 1);
+        if (str.empty())
+            continue;
+        vstr = msra::strfun::split(str, "\t ");
+        if (vstr.size() != 4)
+            RuntimeError("malformed vocabulary line '%s', expecting 'index count word class'", str.c_str());
+        size_t idx = (size_t) stoi(vstr[0]);
+        if (idx != counts.size())
+            RuntimeError("vocabulary file is not sorted by index, found %d at position %d", (int) idx, (int) counts.size());
+        counts.push_back((size_t) stof(vstr[1]));
+        words.push_back(vstr[2]);
+        classes.push_back(stoi(vstr[3]));
+    }
+    fp.close();
+    size_t vocabSize = words.size();
+    if (vocabSize == 0)
+        RuntimeError("vocabulary file %s is empty", vocabFile.c_str());
+
+    // permutation: perm[newId] = oldId, by descending count; ties keep their old order
+    vector<size_t> perm(vocabSize);
+    for (size_t i = 0; i < vocabSize; i++)
+        perm[i] = i;
+    std::stable_sort(perm.begin(), perm.end(), [&counts](size_t a, size_t b)
+                     {
+                         return counts[a] > counts[b];
+                     });
+
+    // permute the model parameters to match
+    ComputationNetwork net(CPUDEVICE);
+    net.Load<ElemType>(modelPath);
+
+    auto permuteNode = [&](const wstring& nodeName, bool permuteRows)
+    {
+        auto node = net.GetNodeFromName(nodeName);
+        Matrix<ElemType>& value = node->As<ComputationNode<ElemType>>()->Value();
+        size_t rows = value.GetNumRows();
+        size_t cols = value.GetNumCols();
+        size_t wordDim = permuteRows ? rows : cols;
+        if (wordDim != vocabSize)
+            RuntimeError("node '%ls' has %d %s but the vocabulary has %d words",
+                         nodeName.c_str(), (int) wordDim, permuteRows ? "rows" : "columns", (int) vocabSize);
+        Matrix<ElemType> permuted(rows, cols, CPUDEVICE);
+        for (size_t i = 0; i < vocabSize; i++)
+        {
+            if (permuteRows)
+                for (size_t c = 0; c < cols; c++)
+                    permuted(i, c) = value(perm[i], c);
+            else
+                for (size_t r = 0; r < rows; r++)
+                    permuted(r, i) = value(r, perm[i]);
+        }
+        value.SetValue(permuted);
+        fprintf(stderr, "remapVocabulary: permuted %s of node '%ls' [%d x %d]\n",
+                permuteRows ? "rows" : "columns", nodeName.c_str(), (int) rows, (int) cols);
+    };
+
+    for (int i = 0; i < rowNodeNames.size(); ++i)
+        permuteNode(rowNodeNames[i], true);
+    for (int i = 0; i < colNodeNames.size(); ++i)
+        permuteNode(colNodeNames[i], false);
+
+    net.Save(outputModelPath);
+
+    // write the reordered vocabulary; same format as DoWriteWordAndClassInfo() above
+    std::ofstream ofvocab;
+    ofvocab.open(outputVocabFile.c_str());
+    if (!ofvocab)
+        RuntimeError("cannot write to %s", outputVocabFile.c_str());
+    for (size_t i = 0; i < vocabSize; i++)
+        ofvocab << "     " << i << "\t     " << counts[perm[i]] << "\t" << words[perm[i]] << "\t" << classes[perm[i]] << std::endl;
+    ofvocab.close();
+}
+
+template void DoRemapVocabulary<float>(const ConfigParameters& config);
+template void DoRemapVocabulary<double>(const ConfigParameters& config);
+
 // ===========================================================================
 // DoTopologyPlot() - implements CNTK "plot" command
 // ===========================================================================
@@ -512,3 +762,29 @@ void DoTopologyPlot(const ConfigParameters& config)
 
 template void DoTopologyPlot<float>(const ConfigParameters& config);
 template void DoTopologyPlot<double>(const ConfigParameters& config);
+
+// ===========================================================================
+// DoDumpBinaryTrace() - implements CNTK "dumpBinaryTrace" command
+// ===========================================================================
+
+// converts a binary trace file (top-level config parameter 'binaryTraceFile',
+// see BinaryProgressTracing) back into the textual trace format
+// config parameters:
+//  traceFile  - the binary trace file to convert
+//  outputFile - where to write the text (default: stdout)
+template <typename ElemType>
+void DoDumpBinaryTrace(const ConfigParameters& config)
+{
+    wstring traceFile = config(L"traceFile");
+    wstring outputFile = config(L"outputFile", L"");
+
+    FILE* fin = fopenOrDie(traceFile, L"rb");
+    FILE* fout = outputFile.empty() ? stdout : fopenOrDie(outputFile, L"w");
+    BinaryProgressTracing::ConvertToText(fin, fout);
+    fclose(fin);
+    if (fout != stdout)
+        fclose(fout);
+}
+
+template void DoDumpBinaryTrace<float>(const ConfigParameters& config);
+template void DoDumpBinaryTrace<double>(const ConfigParameters& config);
@@ -26,12 +26,17 @@
 #include "ScriptableObjects.h"
 #include "BrainScriptEvaluator.h"
 #include "BrainScriptParser.h"
+#include "MPIWrapper.h"
+#include "ProgressTracing.h"
+#include "fileutil.h"
 
 #include <string>
 #include <chrono>
 #include <algorithm>
 #include <vector>
 #include <iostream>
+#include <fstream>
+#include <iterator>
 #include <queue>
 #include <set>
 #include <memory>
@@ -78,6 +83,94 @@ function<ComputationNetworkPtr(DEVICEID_TYPE)> GetCreateNetworkFn(const ConfigPa
     NOT_IMPLEMENTED;
 } // old CNTK config does not support lambdas
 
+// ===========================================================================
+// network cache ('networkCacheFile' config parameter)
+//
+// On a warm restart (e.g. after cluster preemption) re-running the network
+// description through the NDL/SimpleNetworkBuilder machinery can take a long
+// time for large graphs. When a cache file is configured, the freshly built
+// network is saved there once, and later runs reload it directly as long as
+// the network description text is unchanged (tracked through a hash stored in
+// a sidecar .key file). Note that checkpointed runs (startEpoch > 0) already
+// load the epoch model directly; the cache covers the cold-start path.
+// ===========================================================================
+
+static uint64_t HashNetworkDescription(const std::string& text)
+{
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        hash ^= (unsigned char) text[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// GetNetworkDescriptionText - collect the text that determines the built network
+// Returns an empty string if the configuration style does not expose raw text
+// (e.g. fully parsed BrainScript), in which case the cache stays disabled.
+static std::string GetNetworkDescriptionText(const ConfigParameters& config)
+{
+    static const char* builderIds[] = {"NDLNetworkBuilder", "SimpleNetworkBuilder", "BrainScriptNetworkBuilder", "ExperimentalNetworkBuilder"};
+    for (size_t i = 0; i < _countof(builderIds); i++)
+    {
+        if (!config.Exists(builderIds[i]))
+            continue;
+
+        std::string text = std::string(builderIds[i]) + ":" + std::string(config(builderIds[i]));
+
+        // an NDL section usually just points at script files; fold their contents into
+        // the text so that editing the scripts invalidates the cache as well
+        ConfigParameters builderConfig(config(builderIds[i]));
+        static const wchar_t* fileIds[] = {L"networkDescription", L"ndlMacros"};
+        for (size_t j = 0; j < _countof(fileIds); j++)
+        {
+            std::wstring path = builderConfig(fileIds[j], L"");
+            if (path.empty() || !fexists(path))
+                continue;
+            std::ifstream script(msra::strfun::utf8(path).c_str(), std::ifstream::binary);
+            text += std::string(std::istreambuf_iterator<char>(script), std::istreambuf_iterator<char>());
+        }
+        return text;
+    }
+    return std::string();
+}
+static std::string GetNetworkDescriptionText(const ScriptableObjects::IConfigRecord&)
+{
+    return std::string(); // BrainScript configs arrive here already parsed; no raw text to hash
+}
+
+// GetReaderDescriptionText - collect the text that determines the training input
+// The reader block names the input files (plus any settings that change how they are read),
+// so its raw text doubles as the staleness key for the precompute cache.
+static std::string GetReaderDescriptionText(const ConfigParameters& config)
+{
+    if (!config.Exists("reader"))
+        return std::string();
+    return std::string(config("reader"));
+}
+static std::string GetReaderDescriptionText(const ScriptableObjects::IConfigRecord&)
+{
+    return std::string(); // same limitation as GetNetworkDescriptionText()
+}
+
+static bool NetworkCacheIsValid(const std::wstring& cacheFile, const std::string& cacheKey)
+{
+    if (!fexists(cacheFile))
+        return false;
+    std::ifstream keyFile((msra::strfun::utf8(cacheFile) + ".key").c_str());
+    std::string storedKey;
+    if (!(keyFile >> storedKey))
+        return false;
+    return storedKey == cacheKey;
+}
+
+static void WriteNetworkCacheKey(const std::wstring& cacheFile, const std::string& cacheKey)
+{
+    std::ofstream keyFile((msra::strfun::utf8(cacheFile) + ".key").c_str(), std::ofstream::trunc);
+    keyFile << cacheKey;
+}
+
 // function to create an object of a certain type, using both old CNTK config and BrainScript
 template <class C>
 shared_ptr<C> CreateObject(const ScriptableObjects::IConfigRecord& config, const wchar_t* id)
@@ -93,14 +186,11 @@ shared_ptr<C> CreateObject(const ConfigParameters& config, const wchar_t* id)
     return make_shared<C>(readerConfig);                           // old CNTK config specifies a dictionary which then must be explicitly instantiated
 }
 
+// determine the network-creation function from the config
+// We have several ways to create that network. Shared between DoTrain() and DoBenchmarkNetwork().
 template <class ConfigRecordType, typename ElemType>
-void DoTrain(const ConfigRecordType& config)
+static function<ComputationNetworkPtr(DEVICEID_TYPE)> GetNetworkBuilderFn(const ConfigRecordType& config, DEVICEID_TYPE deviceId)
 {
-    bool makeMode = config(L"makeMode", true);
-    DEVICEID_TYPE deviceId = DeviceFromConfig(config);
-
-    // determine the network-creation function
-    // We have several ways to create that network.
     function<ComputationNetworkPtr(DEVICEID_TYPE)> createNetworkFn;
 
     if (config.Exists(L"createNetwork"))
@@ -154,6 +244,76 @@ void DoTrain(const ConfigRecordType& config)
     {
         RuntimeError("No network builder found in the config file. NDLNetworkBuilder or SimpleNetworkBuilde must be specified");
     }
+    return createNetworkFn;
+}
+
+template <class ConfigRecordType, typename ElemType>
+void DoTrain(const ConfigRecordType& config)
+{
+    bool makeMode = config(L"makeMode", true);
+    DEVICEID_TYPE deviceId = DeviceFromConfig(config);
+
+    function<ComputationNetworkPtr(DEVICEID_TYPE)> createNetworkFn = GetNetworkBuilderFn<ConfigRecordType, ElemType>(config, deviceId);
+
+    // optional network cache: reload the network built (and validated) by a previous
+    // run instead of re-running the builder, keyed by the network description text
+    wstring networkCacheFile = config(L"networkCacheFile", L"");
+    if (!networkCacheFile.empty())
+    {
+        std::string desc = GetNetworkDescriptionText(config);
+        if (desc.empty())
+            fprintf(stderr, "networkCacheFile: network description text not available in this configuration style, cache disabled\n");
+        else
+        {
+            char hashString[32];
+            sprintf(hashString, "%016llx", (unsigned long long) HashNetworkDescription(desc + msra::strfun::utf8(ElemTypeName<ElemType>())));
+            std::string cacheKey = hashString;
+            auto buildNetworkFn = createNetworkFn;
+            createNetworkFn = [buildNetworkFn, networkCacheFile, cacheKey](DEVICEID_TYPE deviceId) -> ComputationNetworkPtr
+            {
+                if (NetworkCacheIsValid(networkCacheFile, cacheKey))
+                {
+                    fprintf(stderr, "Loading network from cache %ls (network description unchanged)\n", networkCacheFile.c_str());
+                    try
+                    {
+                        return ComputationNetwork::CreateFromFile<ElemType>(deviceId, networkCacheFile);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        fprintf(stderr, "networkCacheFile: failed to load %ls (%s), rebuilding the network\n", networkCacheFile.c_str(), e.what());
+                    }
+                }
+                auto net = buildNetworkFn(deviceId);
+                // refresh the cache for the next restart; best effort, and in parallel runs
+                // only the main node writes (Save itself enforces the same rule)
+                if ((g_mpi == nullptr) || g_mpi->IsMainNode())
+                {
+                    try
+                    {
+                        net->Save(networkCacheFile);
+                        WriteNetworkCacheKey(networkCacheFile, cacheKey);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        fprintf(stderr, "networkCacheFile: failed to write %ls (%s)\n", networkCacheFile.c_str(), e.what());
+                    }
+                }
+                return net;
+            };
+        }
+    }
+
+    // time network construction for the startup profile, wherever SGD ends up invoking the builder
+    {
+        auto buildNetworkFn = createNetworkFn;
+        createNetworkFn = [buildNetworkFn](DEVICEID_TYPE deviceId) -> ComputationNetworkPtr
+        {
+            StartupProfiling::BeginPhase("networkBuild");
+            auto net = buildNetworkFn(deviceId);
+            StartupProfiling::EndPhase();
+            return net;
+        };
+    }
 
     auto dataReader = CreateObject<DataReader<ElemType>>(config, L"reader");
 
@@ -172,6 +332,18 @@ void DoTrain(const ConfigRecordType& config)
         optimizer = make_shared<SGD<ElemType>>(configSGD);
     }
 
+    // seed the key that validates the precompute cache ('preComputeCacheFile' SGD parameter):
+    // a hash over the reader text, so that changing the input file list invalidates the cache
+    {
+        std::string readerDesc = GetReaderDescriptionText(config);
+        if (!readerDesc.empty())
+        {
+            char hashString[32];
+            sprintf(hashString, "%016llx", (unsigned long long) HashNetworkDescription(readerDesc + msra::strfun::utf8(ElemTypeName<ElemType>())));
+            optimizer->SetPreComputeCacheKey(hashString);
+        }
+    }
+
     optimizer->Train(createNetworkFn, deviceId, dataReader.get(), cvDataReader.get(), makeMode);
 }
 
@@ -252,6 +424,120 @@ void DoAdapt(const ConfigParameters& config)
 template void DoAdapt<float>(const ConfigParameters& config);
 template void DoAdapt<double>(const ConfigParameters& config);
 
+// ===========================================================================
+// DoBenchmarkNetwork() - implements CNTK "benchmark" command
+//
+// Builds the network from the config (or loads 'modelPath' if it points to an
+// existing model) and drives it with synthetically generated minibatches,
+// bypassing the reader entirely. Reports forward/backward/update throughput,
+// plus the per-node breakdown from the node-timing facility, giving a
+// reader-independent number to compare hardware, builds and graph changes.
+// ===========================================================================
+
+template <typename ElemType>
+void DoBenchmarkNetwork(const ConfigParameters& config)
+{
+    DEVICEID_TYPE deviceId = DeviceFromConfig(config);
+
+    size_t mbSize = config(L"minibatchSize", "256");
+    size_t numMinibatches = config(L"numMinibatches", "50");
+    size_t warmupMinibatches = config(L"warmupMinibatches", "5"); // untimed runs to absorb lazy allocation and library warmup
+    double learnRatePerSample = config(L"learningRatePerSample", "0.001");
+    bool nodeTiming = config(L"nodeTiming", "true");
+
+    ComputationNetworkPtr net;
+    wstring modelPath = config(L"modelPath", L"");
+    if (!modelPath.empty() && fexists(modelPath))
+    {
+        fprintf(stderr, "DoBenchmarkNetwork: loading model %ls\n", modelPath.c_str());
+        net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, modelPath);
+    }
+    else
+        net = GetNetworkBuilderFn<ConfigParameters, ElemType>(config, deviceId)(deviceId);
+    net->CompileNetwork();
+
+    auto& criterionNodes = net->FinalCriterionNodes();
+    if (criterionNodes.empty())
+        RuntimeError("DoBenchmarkNetwork: network has no criterion node to train against.");
+    auto criterionNode = criterionNodes[0];
+    auto& featureNodes = net->FeatureNodes();
+    auto& labelNodes = net->LabelNodes();
+    auto& learnableNodes = net->LearnableParameterNodes(criterionNode);
+
+    net->AllocateAllMatrices({}, {}, criterionNode);
+    net->StartEvaluateMinibatchLoop(criterionNode);
+
+    // generate one synthetic minibatch in place of the reader: uniform random features and
+    // deterministic one-hot labels. The same minibatch is reused every iteration; the work per
+    // iteration is identical to training, only the data is fake.
+    net->GetMBLayoutPtr()->InitAsFrameMode(mbSize);
+    for (auto& node : featureNodes)
+    {
+        auto& value = node->As<ComputationNode<ElemType>>()->Value();
+        value.Resize(node->GetSampleLayout().GetNumElements(), mbSize);
+        value.SetUniformRandomValue((ElemType) -1, (ElemType) 1, 1 /*fixed seed, reproducible runs*/);
+        node->NotifyFunctionValuesMBSizeModified();
+    }
+    for (auto& node : labelNodes)
+    {
+        size_t rows = node->GetSampleLayout().GetNumElements();
+        std::vector<ElemType> oneHot(rows * mbSize, 0);
+        for (size_t j = 0; j < mbSize; j++)
+            oneHot[(j * 7919) % rows + j * rows] = 1;
+        node->As<ComputationNode<ElemType>>()->Value().SetValue(rows, mbSize, net->GetDeviceId(), oneHot.data());
+        node->NotifyFunctionValuesMBSizeModified();
+    }
+
+    fprintf(stderr, "DoBenchmarkNetwork: %d minibatches of %d samples (%d warmup) on device %d\n",
+            (int) numMinibatches, (int) mbSize, (int) warmupMinibatches, (int) deviceId);
+
+    double forwardMs = 0, backwardMs = 0, updateMs = 0;
+    for (size_t mb = 0; mb < warmupMinibatches + numMinibatches; mb++)
+    {
+        bool timed = mb >= warmupMinibatches;
+        if (nodeTiming && mb == warmupMinibatches)
+            net->EnableNodeTiming(true); // start the per-node breakdown after warmup
+
+        ComputationNetwork::BumpEvalTimeStamp(featureNodes);
+        ComputationNetwork::BumpEvalTimeStamp(labelNodes);
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        net->ForwardProp(criterionNode);
+        criterionNode->As<ComputationNode<ElemType>>()->Value().Get00Element(); // forces completion of async GPU work
+        auto t1 = std::chrono::high_resolution_clock::now();
+        net->Backprop(criterionNode);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        for (auto& node : learnableNodes)
+        {
+            if (!node->IsParameterUpdateRequired())
+                continue;
+            auto n = dynamic_pointer_cast<ComputationNode<ElemType>>(node);
+            // plain gradient-descent step; representative of the memory-bound update pass
+            Matrix<ElemType>::ScaleAndAdd((ElemType) -learnRatePerSample, n->Gradient(), n->Value());
+        }
+        auto t3 = std::chrono::high_resolution_clock::now();
+
+        if (timed)
+        {
+            forwardMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            backwardMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+            updateMs += std::chrono::duration<double, std::milli>(t3 - t2).count();
+        }
+    }
+
+    double totalMs = forwardMs + backwardMs + updateMs;
+    size_t totalSamples = mbSize * numMinibatches;
+    fprintf(stderr, "DoBenchmarkNetwork: forward  %10.3f ms/MB  (%10.1f samples/sec)\n", forwardMs / numMinibatches, totalSamples * 1000.0 / forwardMs);
+    fprintf(stderr, "DoBenchmarkNetwork: backward %10.3f ms/MB  (%10.1f samples/sec)\n", backwardMs / numMinibatches, totalSamples * 1000.0 / backwardMs);
+    fprintf(stderr, "DoBenchmarkNetwork: update   %10.3f ms/MB  (%10.1f samples/sec)\n", updateMs / numMinibatches, totalSamples * 1000.0 / updateMs);
+    fprintf(stderr, "DoBenchmarkNetwork: total    %10.3f ms/MB  (%10.1f samples/sec)\n", totalMs / numMinibatches, totalSamples * 1000.0 / totalMs);
+    if (nodeTiming)
+        net->ReportNodeTiming();
+}
+
+template void DoBenchmarkNetwork<float>(const ConfigParameters& config);
+template void DoBenchmarkNetwork<double>(const ConfigParameters& config);
+
 // ===========================================================================
 // DoEdit() - implements CNTK "edit" command
 // ===========================================================================
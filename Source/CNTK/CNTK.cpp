@@ -38,6 +38,10 @@
 #if defined(_WIN32)
 #include "io.h"
 #endif
+#ifdef __UNIX__
+#include <sys/stat.h> // for mkfifo() in daemon mode
+#include <errno.h>
+#endif
 #include "buildinfo.h"
 #include "hostname.h"
 #ifdef LEAKDETECT
@@ -45,6 +49,7 @@
 #endif
 #include <vector>
 #include <iostream>
+#include <sstream>
 #include <queue>
 #include <set>
 #include <memory>
@@ -145,6 +150,24 @@ static void DisableLegacyUsage(const ConfigParameters& TopLevelConfig, const Con
     }
 }
 
+// apply the top-level CPU placement options (shared between the old CNTK and the BrainScript config paths)
+// On multi-socket machines, pinning the OpenMP workers and placing large matrix buffers deliberately
+// avoids streaming matrix data from remote NUMA nodes, which is much slower than local streaming.
+static void SetCPUMemoryPlacement(const wstring& numaAllocationPolicy, bool pinCPUThreads, bool useHugePages)
+{
+    if (numaAllocationPolicy == L"localize")
+        CPUMatrix<float /*any will do*/>::SetNumaAllocationPolicy(NumaAllocationPolicy::localize);
+    else if (numaAllocationPolicy == L"interleave")
+        CPUMatrix<float>::SetNumaAllocationPolicy(NumaAllocationPolicy::interleave);
+    else if (numaAllocationPolicy != L"none")
+        InvalidArgument("numaAllocationPolicy: must be 'none', 'localize', or 'interleave'.");
+
+    if (pinCPUThreads)
+        CPUMatrix<float>::PinWorkerThreads();
+
+    CPUMatrix<float>::SetUseHugePages(useHugePages);
+}
+
 // process the command
 template <typename ElemType>
 void DoCommands(const ConfigParameters& config)
@@ -159,6 +182,18 @@ void DoCommands(const ConfigParameters& config)
         std::cerr << "Using " << numCPUThreads << " CPU threads" << endl;
     }
 
+    // measure on this machine where parallel CPU math starts to pay off, instead of
+    // fanning small recurrent-step loops out to every core (see CalibrateParallelism())
+    if (config(L"calibrateCPUParallelism", true))
+        CPUMatrix<ElemType>::CalibrateParallelism();
+
+    SetCPUMemoryPlacement((const wstring&) config(L"numaAllocationPolicy", L"none"), config(L"pinCPUThreads", false), config(L"useHugePages", false));
+
+    // determinism mode: bitwise-reproducible runs, e.g. to A/B a kernel change against an
+    // identical baseline (see CommonMatrix.h); costs some reduction throughput
+    if (config(L"forceDeterministicAlgorithms", false))
+        SetDeterministicComputation(true);
+
     bool progressTracing = config(L"progressTracing", false);
 
     // temporary hack to prevent users from failling for a small breaking change related to the "truncated" flag (will be redone bigger and better some day)
@@ -193,6 +228,11 @@ void DoCommands(const ConfigParameters& config)
         ProgressTracing::TraceTotalNumberOfSteps(fullTotalMaxEpochs); // enable tracing, using this as the total number of epochs
     }
 
+    // binary trace channel (see BinaryProgressTracing; convert the file with the "dumpBinaryTrace" command)
+    wstring binaryTraceFile = config(L"binaryTraceFile", L"");
+    if (!binaryTraceFile.empty() && ((g_mpi == nullptr) || g_mpi->IsMainNode()))
+        BinaryProgressTracing::Enable(binaryTraceFile);
+
     size_t fullEpochsOffset = 0;
 
     // execute the commands
@@ -221,6 +261,14 @@ void DoCommands(const ConfigParameters& config)
             {
                 DoAdapt<ElemType>(commandParams);
             }
+            else if (action[j] == "benchmark")
+            {
+                DoBenchmarkNetwork<ElemType>(commandParams);
+            }
+            else if (action[j] == "readerBench")
+            {
+                DoReaderBench<ElemType>(commandParams);
+            }
             else if (action[j] == "test" || action[j] == "eval")
             {
                 DoEval<ElemType>(commandParams);
@@ -257,6 +305,10 @@ void DoCommands(const ConfigParameters& config)
             {
                 DoWriteWordAndClassInfo<ElemType>(commandParams);
             }
+            else if (action[j] == "remapVocabulary")
+            {
+                DoRemapVocabulary<ElemType>(commandParams);
+            }
             else if (action[j] == "plot")
             {
                 DoTopologyPlot<ElemType>(commandParams);
@@ -265,6 +317,10 @@ void DoCommands(const ConfigParameters& config)
             {
                 DoParameterSVD<ElemType>(commandParams);
             }
+            else if (action[j] == "dumpBinaryTrace")
+            {
+                DoDumpBinaryTrace<ElemType>(commandParams);
+            }
             else
             {
                 RuntimeError("unknown action: %s  in command set: %s", action[j].c_str(), command[i].c_str());
@@ -411,7 +467,9 @@ int wmainWithBS(int argc, wchar_t* argv[]) // called from wmain which is a wrapp
 
     fprintf(stderr, "\n\nBrainScript -->\n\n%ls\n\n", bs.c_str());
 
+    StartupProfiling::BeginPhase("configParse");
     let expr = BS::ParseConfigExpression(bs, move(includePaths)); // parse
+    StartupProfiling::EndPhase();
     let valp = BS::Evaluate(expr);                                // evaluate parse into a dictionary
     let& config = valp.AsRef<ScriptableObjects::IConfigRecord>(); // this is the dictionary
 
@@ -456,6 +514,10 @@ int wmainWithBS(int argc, wchar_t* argv[]) // called from wmain which is a wrapp
     numCPUThreads = CPUMatrix<float /*any will do*/>::SetNumThreads(numCPUThreads);
     if (numCPUThreads > 0)
         fprintf(stderr, "Using %d CPU threads.\n", numCPUThreads);
+    if (config(L"calibrateCPUParallelism", true))
+        CPUMatrix<float /*any will do*/>::CalibrateParallelism();
+
+    SetCPUMemoryPlacement(config(L"numaAllocationPolicy", wstring(L"none")), config(L"pinCPUThreads", false), config(L"useHugePages", false));
 
     bool progressTracing = config(L"progressTracing", false);
     size_t fullTotalMaxEpochs = 1; // BUGBUG: BS does not allow me to read out the max epochs parameters, as that would instantiate and thus execute the objects
@@ -501,7 +563,9 @@ int wmainWithBS(int argc, wchar_t* argv[]) // called from wmain which is a wrapp
 int wmainOldCNTKConfig(int argc, wchar_t* argv[]) // called from wmain which is a wrapper that catches & repots Win32 exceptions
 {
     ConfigParameters config;
+    StartupProfiling::BeginPhase("configParse");
     std::string rawConfigString = ConfigParameters::ParseCommandLine(argc, argv, config);
+    StartupProfiling::EndPhase();
 
     // get the command param set they want
     wstring logpath = config(L"stderr", L"");
@@ -610,6 +674,103 @@ int wmainOldCNTKConfig(int argc, wchar_t* argv[]) // called from wmain which is
     return EXIT_SUCCESS;
 }
 
+// ---------------------------------------------------------------------------
+// daemon mode: one resident process runs successive jobs
+// ---------------------------------------------------------------------------
+
+// run one job given as a complete cntk argument list, dispatching exactly like wmain1()
+static int RunDaemonJob(std::vector<std::wstring>& args)
+{
+    std::vector<wchar_t*> argvVector;
+    for (auto& arg : args)
+        argvVector.push_back(const_cast<wchar_t*>(arg.c_str()));
+
+    bool isOldCNTKConfig = false;
+    for (size_t i = 0; i < argvVector.size() && !isOldCNTKConfig; i++)
+        isOldCNTKConfig |= !_wcsnicmp(L"configFile=", argvVector[i], 11);
+    if (isOldCNTKConfig)
+        return wmainOldCNTKConfig((int) argvVector.size(), argvVector.data());
+    return wmainWithBS((int) argvVector.size(), argvVector.data());
+}
+
+// Daemon mode keeps this process resident--and with it the GPU/CUDA context, whose creation costs
+// seconds per process--and runs successive jobs submitted as complete cntk command lines, one per
+// line, through the given pipe (a FIFO, which is created if missing, on Linux; pass "-" to read
+// from stdin on any platform). A line reading "quit" shuts the daemon down; a failing job is
+// reported but does not take the daemon down. With keepModelsWarm, models loaded by read-only
+// actions (eval, cv, write) are additionally kept loaded across jobs. Parallel (MPI) jobs cannot
+// be run through the daemon, since MPI can only be initialized once per process.
+static int DaemonLoop(const wstring& pipePath, bool keepModelsWarm)
+{
+    ComputationNetwork::EnableModelCache(keepModelsWarm);
+
+    bool isStdin = (pipePath == L"-");
+#ifdef __UNIX__
+    if (!isStdin)
+    {
+        string pipePath8 = msra::strfun::utf8(pipePath);
+        if (mkfifo(pipePath8.c_str(), 0666) != 0 && errno != EEXIST)
+            RuntimeError("DaemonLoop: cannot create pipe '%s': %s", pipePath8.c_str(), strerror(errno));
+    }
+#endif
+    fprintf(stderr, "CNTK daemon: accepting jobs from %ls\n", pipePath.c_str());
+
+    size_t numJobsRun = 0;
+    for (;;)
+    {
+        FILE* pipe = isStdin ? stdin : fopenOrDie(pipePath, L"rb");
+        char buf[16384];
+        while (fgets(buf, sizeof(buf), pipe))
+        {
+            // strip the line ending, convert, and tokenize into an argument list
+            wstring line = msra::strfun::utf16(buf);
+            std::vector<std::wstring> args;
+            args.push_back(L"cntk"); // (argv[0] placeholder)
+            std::wistringstream tokens(line);
+            wstring token;
+            while (tokens >> token)
+                args.push_back(token);
+            if (args.size() == 1) // empty line
+                continue;
+
+            if (args[1] == L"quit")
+            {
+                fprintf(stderr, "CNTK daemon: shutting down after %d jobs\n", (int) numJobsRun);
+                ComputationNetwork::EnableModelCache(false); // drop any warm models
+                return EXIT_SUCCESS;
+            }
+
+            fprintf(stderr, "CNTK daemon: running job: %ls\n", line.c_str());
+            try
+            {
+                RunDaemonJob(args);
+                fprintf(stderr, "CNTK daemon: job completed\n");
+            }
+            catch (const ScriptableObjects::ScriptingException& err)
+            {
+                fprintf(stderr, "CNTK daemon: job FAILED with EXCEPTION: %s\n", err.what());
+                err.PrintError();
+            }
+            catch (const std::exception& err)
+            {
+                fprintf(stderr, "CNTK daemon: job FAILED with EXCEPTION: %s\n", err.what());
+            }
+            catch (...)
+            {
+                fprintf(stderr, "CNTK daemon: job FAILED with unknown EXCEPTION\n");
+            }
+            numJobsRun++;
+            fflush(stderr);
+        }
+        if (isStdin) // EOF on stdin means no more jobs
+            break;
+        fclose(pipe); // a FIFO signals EOF when the submitting writer closes it; reopen and wait for the next writer
+    }
+    fprintf(stderr, "CNTK daemon: shutting down after %d jobs\n", (int) numJobsRun);
+    ComputationNetwork::EnableModelCache(false);
+    return EXIT_SUCCESS;
+}
+
 // ---------------------------------------------------------------------------
 // main wrapper that catches C++ exceptions and prints them
 // ---------------------------------------------------------------------------
@@ -621,6 +782,18 @@ int wmain1(int argc, wchar_t* argv[]) // called from wmain which is a wrapper th
         PrintBuiltInfo(); // print build info directly in case that user provides zero argument (convenient for checking build type)
         if (argc <= 1)
             InvalidArgument("No command-line argument given.");
+        // daemon mode: stay resident and accept successive jobs through a pipe
+        wstring daemonPipe;
+        bool keepModelsWarm = false;
+        for (int i = 1; i < argc; i++)
+        {
+            if (!_wcsnicmp(L"daemon=", argv[i], 7))
+                daemonPipe = argv[i] + 7;
+            else if (!_wcsnicmp(L"daemonKeepModelsWarm=", argv[i], 21))
+                keepModelsWarm = !_wcsicmp(argv[i] + 21, L"true") || !wcscmp(argv[i] + 21, L"1");
+        }
+        if (!daemonPipe.empty())
+            return DaemonLoop(daemonPipe, keepModelsWarm);
         // detect legacy CNTK configuration
         bool isOldCNTKConfig = false;
         for (int i = 0; i < argc && !isOldCNTKConfig; i++)
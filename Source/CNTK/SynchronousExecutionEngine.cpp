@@ -201,6 +201,25 @@ void SynchronousNodeEvaluator<ElemType>::Evaluate(NDLNode<ElemType>* node, const
             nodePtr->SetParameterUpdateRequired(needGradient);
         }
     }
+    else if (cnNodeType == OperationNameOf(RowScatterNode))
+    {
+        if (parameter.size() != 3)
+            RuntimeError("RowScatter should have three parameters. Usage: RowScatter(numRows, origNodeName, indexNodeName).");
+
+        nodeParamCount = 2;
+        nodeParamStart = 1;
+
+        if (pass == ndlPassInitial)
+        {
+            // evaluate only scalar parameters
+            vector<void*> params = EvaluateParameters(node, baseName, 0, parameter.size(), pass);
+            size_t num_rows = ((NDLNode<ElemType>*) params[0])->GetScalar();
+
+            bool needGradient = node->GetOptionalParameter("needGradient", "false");
+            nodePtr = builder.RowScatter(NULL, NULL, num_rows, name);
+            nodePtr->SetParameterUpdateRequired(needGradient);
+        }
+    }
     else if (cnNodeType == OperationNameOf(RowRepeatNode))
     {
         if (parameter.size() != 2)
@@ -43,6 +43,7 @@ int bestGPUDummy = 42; // put something into this CPP, as to avoid a linker warn
 #define PATH_DELIMITER '/'
 #endif // __WINDOWS__
 #include <stdio.h>
+#include <stdlib.h> // for getenv() (probe cache location)
 #include <string.h>
 #include <algorithm>
 
@@ -92,14 +93,18 @@ private:
     BestGpuFlags m_lastFlags; // flag state at last query
     int m_lastCount;          // count of devices (with filtering of allowed Devices)
     std::vector<ProcessorData*> m_procData;
-    int m_allowedDevices; // bitfield of allowed devices
+    int m_allowedDevices;        // bitfield of allowed devices
+    double m_freeMemoryWeight;   // scoring weight of the free-memory fraction (see GetDevices())
+    double m_utilizationWeight;  // scoring weight of the compute-utilization counters
     void GetCudaProperties();
     void GetNvmlData();
     void QueryNvmlData();
+    bool TryLoadProbeCache(int driverVersion); // reuse static probe results from a previous run
+    void SaveProbeCache(int driverVersion);
 
 public:
     BestGpu()
-        : m_initialized(false), m_nvmlData(false), m_cudaData(false), m_deviceCount(0), m_queryCount(0), m_lastFlags(bestGpuNormal), m_lastCount(0), m_allowedDevices(-1)
+        : m_initialized(false), m_nvmlData(false), m_cudaData(false), m_deviceCount(0), m_queryCount(0), m_lastFlags(bestGpuNormal), m_lastCount(0), m_allowedDevices(-1), m_freeMemoryWeight(0.2), m_utilizationWeight(0.15)
     {
         Init();
     }
@@ -112,6 +117,11 @@ public:
         m_allowedDevices &= ~(1 << device);
     }
     void AllowAll();                                                                          // reset to allow all GPUs (no allowed list)
+    void SetSelectionWeights(double freeMemoryWeight, double utilizationWeight)               // tune the free-memory vs. utilization trade-off of the device score
+    {
+        m_freeMemoryWeight = freeMemoryWeight;
+        m_utilizationWeight = utilizationWeight;
+    }
     bool UseMultiple();                                                                       // using multiple GPUs?
     int GetDevice(BestGpuFlags flags = bestGpuNormal);                                        // get a single device
     static const int AllDevices = -1;                                                         // can be used to specify all GPUs in GetDevices() call
@@ -127,7 +137,7 @@ private:
 // 'cpu'  - use the CPU
 // 0      - or some other single number, use a single GPU with CUDA ID same as the number
 // This can only be called with the same parameters each time, and 'auto' is determined upon first call.
-static DEVICEID_TYPE SelectDevice(DEVICEID_TYPE deviceId, bool bLockGPU)
+static DEVICEID_TYPE SelectDevice(DEVICEID_TYPE deviceId, bool bLockGPU, double freeMemoryWeight = 0.2, double utilizationWeight = 0.15)
 {
     // This can only be called with the same parameter.
     static DEVICEID_TYPE lastDeviceId = DEVICEID_NOTYETDETERMINED;
@@ -145,6 +155,7 @@ static DEVICEID_TYPE SelectDevice(DEVICEID_TYPE deviceId, bool bLockGPU)
             static BestGpu* g_bestGpu = nullptr;
             if (g_bestGpu == nullptr)
                 g_bestGpu = new BestGpu();
+            g_bestGpu->SetSelectionWeights(freeMemoryWeight, utilizationWeight);
             deviceId = (DEVICEID_TYPE)
                            g_bestGpu->GetDevice(BestGpuFlags(bLockGPU ? (bestGpuAvoidSharing | bestGpuExclusiveLock) : bestGpuAvoidSharing));
             bestDeviceId = deviceId;
@@ -161,10 +172,12 @@ static DEVICEID_TYPE SelectDevice(DEVICEID_TYPE deviceId, bool bLockGPU)
 DEVICEID_TYPE DeviceFromConfig(const ScriptableObjects::IConfigRecord& config)
 {
     bool bLockGPU = config(L"lockGPU", true);
+    double freeMemoryWeight = config(L"bestGpuFreeMemoryWeight", 0.2);     // scoring weights for 'auto' selection
+    double utilizationWeight = config(L"bestGpuUtilizationWeight", 0.15);
     // we need to deal with the old CNTK config semantics where 'deviceId' can be either a string or an int
     auto valpp = config.Find(L"deviceId");
     if (!valpp)
-        return SelectDevice(DEVICEID_AUTO, bLockGPU); // not given at all: default
+        return SelectDevice(DEVICEID_AUTO, bLockGPU, freeMemoryWeight, utilizationWeight); // not given at all: default
     auto valp = *valpp;                               // (the type is not determined at this point)
     if (valp.Is<ScriptableObjects::String>())
     {
@@ -172,7 +185,7 @@ DEVICEID_TYPE DeviceFromConfig(const ScriptableObjects::IConfigRecord& config)
         if (val == L"cpu")
             return SelectDevice(CPUDEVICE, false);
         else if (val == L"auto")
-            return SelectDevice(DEVICEID_AUTO, bLockGPU);
+            return SelectDevice(DEVICEID_AUTO, bLockGPU, freeMemoryWeight, utilizationWeight);
         else
             InvalidArgument("Invalid value '%ls' for deviceId parameter. Allowed are 'auto' and 'cpu' (case-sensitive).", val.c_str());
     }
@@ -187,11 +200,13 @@ DEVICEID_TYPE DeviceFromConfig(const ConfigParameters& config)
 {
     ConfigValue val = config("deviceId", "auto");
     bool bLockGPU = config(L"lockGPU", true);
+    double freeMemoryWeight = config("bestGpuFreeMemoryWeight", "0.2");     // scoring weights for 'auto' selection
+    double utilizationWeight = config("bestGpuUtilizationWeight", "0.15");
 
     if (!_stricmp(val.c_str(), "cpu"))
         return SelectDevice(CPUDEVICE, false);
     else if (!_stricmp(val.c_str(), "auto"))
-        return SelectDevice(DEVICEID_AUTO, bLockGPU);
+        return SelectDevice(DEVICEID_AUTO, bLockGPU, freeMemoryWeight, utilizationWeight);
     else
         return SelectDevice((int) val, bLockGPU);
 }
@@ -279,12 +294,89 @@ void BestGpu::Init()
 
     if (m_deviceCount > 0)
     {
-        GetCudaProperties();
+        // probing every device (cudaSetDevice/cudaGetDeviceProperties/cudaDeviceReset below) creates
+        // and tears down a context per device, which takes seconds on multi-GPU machines. The static
+        // properties cannot change without a driver change, so we cache them across runs keyed by the
+        // driver version; only the dynamic NVML counters are queried every time.
+        int driverVersion = 0;
+        cudaDriverGetVersion(&driverVersion);
+        if (!TryLoadProbeCache(driverVersion))
+        {
+            GetCudaProperties();
+            SaveProbeCache(driverVersion);
+        }
         GetNvmlData();
     }
     m_initialized = true;
 }
 
+// location of the probe cache; per-machine, so a shared temp directory is the right scope
+static std::string GetProbeCachePath()
+{
+    const char* tempDir = getenv("TEMP"); // Windows convention
+    if (tempDir == nullptr)
+        tempDir = getenv("TMPDIR");
+    if (tempDir == nullptr)
+        tempDir = "/tmp";
+    return std::string(tempDir) + PATH_DELIMITER + "cntk_gpu_probe_cache";
+}
+
+// TryLoadProbeCache - fill the static per-device properties from the probe cache file
+// driverVersion - the current CUDA driver version; the cache is only valid for the version it was written under
+// returns: true if the cache was usable (device count and driver version match)
+bool BestGpu::TryLoadProbeCache(int driverVersion)
+{
+    FILE* f = fopen(GetProbeCachePath().c_str(), "r");
+    if (f == nullptr)
+        return false;
+
+    int version = 0, cachedDriverVersion = 0, deviceCount = 0;
+    bool ok = fscanf(f, "CNTKGpuProbeCache %d driverVersion %d deviceCount %d", &version, &cachedDriverVersion, &deviceCount) == 3 &&
+              version == 1 && cachedDriverVersion == driverVersion && deviceCount == m_deviceCount;
+    for (int i = 0; ok && i < m_deviceCount; i++)
+    {
+        int deviceId, pciBusID, cores, tccDriver;
+        unsigned long long totalMem;
+        ok = fscanf(f, " device %d %d %d %llu %d", &deviceId, &pciBusID, &cores, &totalMem, &tccDriver) == 5 && deviceId == i;
+        if (ok)
+        {
+            ProcessorData* pd = m_procData[i];
+            pd->deviceId = deviceId;
+            pd->cores = cores;
+            pd->cudaTotalMem = (size_t) totalMem;
+            pd->cudaFreeMem = 0; // dynamic, not cached; the score falls back to the NVML numbers
+            pd->deviceProp.pciBusID = pciBusID;
+            pd->deviceProp.tccDriver = tccDriver;
+        }
+    }
+    fclose(f);
+    if (ok)
+        m_cudaData = m_procData.size() > 0;
+    return ok;
+}
+
+// SaveProbeCache - persist the static per-device properties for the next run; best-effort
+void BestGpu::SaveProbeCache(int driverVersion)
+{
+    if (!m_cudaData)
+        return;
+
+    std::string path = GetProbeCachePath();
+    std::string tmpPath = path + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "w");
+    if (f == nullptr)
+        return;
+
+    fprintf(f, "CNTKGpuProbeCache 1 driverVersion %d deviceCount %d\n", driverVersion, m_deviceCount);
+    for (ProcessorData* pd : m_procData)
+        fprintf(f, "device %d %d %d %llu %d\n", pd->deviceId, pd->deviceProp.pciBusID, pd->cores, (unsigned long long) pd->cudaTotalMem, pd->deviceProp.tccDriver ? 1 : 0);
+    fclose(f);
+
+    // write-then-rename so a concurrent job never reads a partially written cache
+    remove(path.c_str());
+    rename(tmpPath.c_str(), path.c_str());
+}
+
 BestGpu::~BestGpu()
 {
     for (ProcessorData* data : m_procData)
@@ -385,10 +477,10 @@ std::vector<int> BestGpu::GetDevices(int number, BestGpuFlags p_bestFlags)
     // get latest data
     QueryNvmlData();
 
-    double utilGpuW = 0.15;
-    double utilMemW = 0.1;
+    double utilGpuW = m_utilizationWeight;
+    double utilMemW = m_utilizationWeight * 2.0 / 3.0;
     double speedW = 0.2;
-    double freeMemW = 0.2;
+    double freeMemW = m_freeMemoryWeight;
     double mlAppRunningW = 0.2;
 
     // if it's a requery, just use the same flags as last time
@@ -427,7 +519,7 @@ std::vector<int> BestGpu::GetDevices(int number, BestGpuFlags p_bestFlags)
         score += pd->cores / 1000.0f * speedW;
         double mem = pd->memory.total > 0 ? pd->memory.free / (double) pd->memory.total : 1000000; // I saw this to be 0 when remoted in
         // if it's not a tcc driver, then it's WDDM driver and values will be off because windows allocates all the memory from the nvml point of view
-        if (!pd->deviceProp.tccDriver || pd->memory.total == 0)
+        if ((!pd->deviceProp.tccDriver || pd->memory.total == 0) && pd->cudaFreeMem > 0) // cudaFreeMem is 0 when properties came from the probe cache; keep the NVML numbers then
             mem = pd->cudaFreeMem / (double) pd->cudaTotalMem;
         score += mem * freeMemW;
         score += ((pd->cnFound || pd->dbnFound) ? 0 : 1) * mlAppRunningW;
@@ -15,6 +15,8 @@
 #include "DataReader.h"
 #include "Config.h"
 #include "ScriptableObjects.h"
+#include "ProgressTracing.h"
+#include <future>
 
 using namespace std;
 
@@ -38,6 +40,20 @@ std::string GetReaderName(double)
     return name;
 }
 
+// Keep a per-stream config section alive while that stream's Init runs on a concurrent thread.
+// The legacy ConfigParameters path materializes sections as temporaries that die with the loop
+// iteration that looked them up, so those are copied; BrainScript records are owned by the config
+// tree and can be referenced in place.
+static const ConfigParameters* KeepAliveForInit(const ConfigParameters& section, std::vector<std::shared_ptr<ConfigParameters>>& keepAlive)
+{
+    keepAlive.push_back(std::make_shared<ConfigParameters>(section));
+    return keepAlive.back().get();
+}
+static const ScriptableObjects::IConfigRecord* KeepAliveForInit(const ScriptableObjects::IConfigRecord& section, std::vector<std::shared_ptr<ConfigParameters>>&)
+{
+    return &section;
+}
+
 template <class ElemType>
 template <class ConfigRecordType>
 void DataReader<ElemType>::InitFromConfig(const ConfigRecordType& /*config*/)
@@ -68,6 +84,7 @@ DataReader<ElemType>::DataReader(const ConfigRecordType& config)
 
     assert(m_dataReaders.empty());
 
+    StartupProfiling::BeginPhase("readerPluginLoad");
     bool hasMultipleReaders = config.Exists(L"readers");
     if (hasMultipleReaders)
     {
@@ -91,20 +108,43 @@ DataReader<ElemType>::DataReader(const ConfigRecordType& config)
         m_ioNames.push_back(ioName);
         getReaderProc(&m_dataReaders[ioName]);
     }
+    StartupProfiling::EndPhase();
+    StartupProfiling::BeginPhase("readerInit");
 
     // now pass that to concurrent reader so we can read ahead
     // m_DataReader = new ConcurrentReader<ElemType>(m_DataReader);
     // NOW we can init
     // TODO: merge with the code above, but we first need to get the nbrUttPerMinibatch initialized inside each reader
+    // The per-stream Init phases are independent (each reader parses its own config section and
+    // opens its own files) and dominate multi-IO startup, so run them on concurrent threads when
+    // there is more than one stream. parallelInit=false restores strictly serial startup.
+    bool parallelInit = (m_ioNames.size() > 1) && (bool) config(L"parallelInit", true);
+    std::vector<std::future<void>> initTasks;
+    std::vector<std::shared_ptr<ConfigParameters>> keepAlive; // see KeepAliveForInit()
     for (const auto& ioName : m_ioNames)
     {
-        const ConfigRecordType& thisIO = hasMultipleReaders ? config(ioName) : config /*legacy*/;
-        m_dataReaders[ioName]->Init(thisIO);
-
-        // pass on some global option    --TODO: Why is this not done inside each reader??
+        const ConfigRecordType& ioSection = hasMultipleReaders ? config(ioName) : config /*legacy*/;
+        const ConfigRecordType* thisIO = KeepAliveForInit(ioSection, keepAlive);
         size_t nbrUttPerMinibatch = config(L"nbruttsineachrecurrentiter", (size_t) 1);
-        m_dataReaders[ioName]->SetNumParallelSequences(nbrUttPerMinibatch);
+        IDataReader<ElemType>* dataReader = m_dataReaders[ioName];
+        auto initTask = [dataReader, thisIO, nbrUttPerMinibatch]()
+        {
+            dataReader->Init(*thisIO);
+
+            // pass on some global option    --TODO: Why is this not done inside each reader??
+            dataReader->SetNumParallelSequences(nbrUttPerMinibatch);
+        };
+        if (parallelInit)
+            initTasks.push_back(std::async(std::launch::async, initTask));
+        else
+            initTask();
     }
+    for (auto& initTask : initTasks)
+        initTask.get(); // (rethrows if that stream's Init failed)
+    StartupProfiling::EndPhase();
+
+    // optionally fetch the streams of a multi-reader config on parallel threads (see GetMinibatch())
+    m_parallelFetch = (m_ioNames.size() > 1) && (bool) config(L"parallelFetch", false);
 }
 
 template DataReader<float>::DataReader(const ConfigParameters&);
@@ -183,6 +223,40 @@ bool DataReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<ElemType>*
     Then this returned number is compared against the specified number. If these two numbers are not consistent, return with logic error.
     The logic error can be avoided usually with an exchange of reading orders.
     */
+    if (m_parallelFetch)
+    {
+        // fetch all streams concurrently, one thread per child reader; streams of different
+        // readers fill different entries of the matrices map, so each worker operates on a
+        // private copy of the map (sharing the Matrix objects) and the copies are merged back
+        // afterwards in reader order, same as the sequential path would have produced
+        std::vector<std::map<std::wstring, Matrix<ElemType>*>> readerMatrices(m_ioNames.size(), matrices);
+        std::vector<std::future<bool>> fetches;
+        for (size_t i = 0; i < m_ioNames.size(); i++)
+        {
+            IDataReader<ElemType>* reader = m_dataReaders[m_ioNames[i]];
+            auto* readerMatricesPtr = &readerMatrices[i];
+            fetches.push_back(std::async(std::launch::async, [reader, readerMatricesPtr]()
+                                         {
+                                             return reader->GetMinibatch(*readerMatricesPtr);
+                                         }));
+        }
+        for (size_t i = 0; i < m_ioNames.size(); i++)
+            bRet &= fetches[i].get(); // (also rethrows any exception from the worker thread)
+        for (size_t i = 0; i < m_ioNames.size(); i++)
+            for (const auto& entry : readerMatrices[i])
+                matrices[entry.first] = entry.second;
+        // the readers walk the same corpus in the same order, so the streams stay aligned by
+        // construction; verify the same per-minibatch consistency the sequential path enforces
+        for (size_t i = 0; i < m_ioNames.size(); i++)
+        {
+            thisNbr = m_dataReaders[m_ioNames[i]]->GetNumParallelSequences();
+            if (nbr > 0 && thisNbr != nbr)
+                LogicError("DataReader<ElemType>::GetMinibatch: readers returned inconsistent numbers of utterances per minibatch; these streams cannot be fetched in parallel (remove parallelFetch)");
+            nbr = thisNbr;
+        }
+        return bRet;
+    }
+
     for (size_t i = 0; i < m_ioNames.size(); i++)
     {
         if (nbr > 0)
@@ -226,6 +300,20 @@ bool DataReader<ElemType>::GetHmmData(msra::asr::simplesenonehmm* hmm)
     return bRet;
 }
 
+// GetWriteRecordInfo - Get the record index and frame count of each parallel sequence in the
+// current write-mode minibatch, when the underlying reader batches or reorders records
+// returns - true if any underlying reader provided the information
+template <class ElemType>
+bool DataReader<ElemType>::GetWriteRecordInfo(std::vector<std::pair<size_t, size_t>>& recordInfo)
+{
+    bool bRet = false;
+    for (size_t i = 0; i < m_ioNames.size(); i++)
+    {
+        bRet |= m_dataReaders[m_ioNames[i]]->GetWriteRecordInfo(recordInfo);
+    }
+    return bRet;
+}
+
 template <class ElemType>
 size_t DataReader<ElemType>::GetNumParallelSequences()
 {
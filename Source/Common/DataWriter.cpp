@@ -44,9 +44,70 @@ void DataWriter<ElemType>::InitFromConfig(const ConfigRecordType& /*config*/)
 template <class ElemType>
 void DataWriter<ElemType>::Destroy()
 {
+    DrainWriteQueue(); // pending blocks must reach the plugin before it shuts down
     m_dataWriter->Destroy();
 }
 
+// writer-thread main loop: pop blocks in submission order and hand them to the plugin
+template <class ElemType>
+void DataWriter<ElemType>::WriterThreadProc()
+{
+    for (;;)
+    {
+        std::unique_ptr<PendingWrite> block;
+        bool failedEarlier;
+        {
+            std::unique_lock<std::mutex> lock(m_writeMutex);
+            m_queueNonEmpty.wait(lock, [this]
+                                 {
+                                     return !m_writeQueue.empty() || m_finishWriting;
+                                 });
+            if (m_writeQueue.empty())
+                return; // finished and drained
+            block = std::move(m_writeQueue.front());
+            m_writeQueue.pop_front();
+            failedEarlier = (m_writerException != nullptr);
+        }
+        m_queueNonFull.notify_one();
+
+        if (failedEarlier) // a previous block failed; discard the rest rather than write past a gap
+            continue;
+        try
+        {
+            std::map<std::wstring, void*, nocase_compare> matrices;
+            for (auto& entry : block->matrices)
+                matrices[entry.first] = (void*) entry.second.get();
+            m_dataWriter->SaveData(block->recordStart, matrices, block->numRecords, block->datasetSize, block->byteVariableSized);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            m_writerException = std::current_exception();
+        }
+    }
+}
+
+// finish all queued writes and stop the writer thread; errors that happened on the writer
+// thread after the last SaveData() call are reported here
+template <class ElemType>
+void DataWriter<ElemType>::DrainWriteQueue()
+{
+    if (!m_writerThread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        m_finishWriting = true;
+    }
+    m_queueNonEmpty.notify_one();
+    m_writerThread.join();
+    if (m_writerException)
+    {
+        auto exception = m_writerException;
+        m_writerException = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
 // DataWriter Constructor
 // config - [in] configuration data for the data writer
 template <class ElemType>
@@ -87,6 +148,14 @@ DataWriter<ElemType>::DataWriter(const ConfigRecordType& config)
     getWriterProc(&m_dataWriter);
 
     m_dataWriter->Init(config);
+
+    // ordered write-behind mode (see the declaration in DataWriter.h)
+    m_asyncWriteDepth = config(L"asyncWriteDepth", (size_t) 0);
+    if (m_asyncWriteDepth > 0)
+        m_writerThread = std::thread([this]
+                                     {
+                                         WriterThreadProc();
+                                     });
 }
 
 template DataWriter<float>::DataWriter(const ConfigParameters&);
@@ -98,6 +167,14 @@ template DataWriter<double>::DataWriter(const ScriptableObjects::IConfigRecord&)
 template <class ElemType>
 DataWriter<ElemType>::~DataWriter()
 {
+    try
+    {
+        DrainWriteQueue();
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "~DataWriter: a queued write failed: %s\n", e.what()); // (cannot throw from a destructor)
+    }
     // free up resources
     if (m_dataWriter)
         m_dataWriter->Destroy();
@@ -120,7 +197,39 @@ void DataWriter<ElemType>::GetSections(std::map<std::wstring, SectionType, nocas
 template <class ElemType>
 bool DataWriter<ElemType>::SaveData(size_t recordStart, const std::map<std::wstring, void*, nocase_compare>& matrices, size_t numRecords, size_t datasetSize, size_t byteVariableSized)
 {
-    return m_dataWriter->SaveData(recordStart, matrices, numRecords, datasetSize, byteVariableSized);
+    if (m_asyncWriteDepth == 0)
+        return m_dataWriter->SaveData(recordStart, matrices, numRecords, datasetSize, byteVariableSized);
+
+    // write-behind: deep-copy the block to host memory and queue it for the writer thread
+    std::unique_ptr<PendingWrite> block(new PendingWrite);
+    block->recordStart = recordStart;
+    block->numRecords = numRecords;
+    block->datasetSize = datasetSize;
+    block->byteVariableSized = byteVariableSized;
+    for (const auto& iter : matrices)
+    {
+        const Matrix<ElemType>& source = *(const Matrix<ElemType>*) iter.second; // (this mode requires the Matrix-pointer convention, see DataWriter.h)
+        std::unique_ptr<Matrix<ElemType>> copy(new Matrix<ElemType>(CPUDEVICE));
+        copy->SetValue(source);
+        block->matrices.push_back(std::make_pair(iter.first, std::move(copy)));
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_writeMutex);
+        m_queueNonFull.wait(lock, [this]
+                            {
+                                return m_writeQueue.size() < m_asyncWriteDepth || m_writerException;
+                            });
+        if (m_writerException) // a queued block failed; surface the error at the submission site
+        {
+            auto exception = m_writerException;
+            m_writerException = nullptr;
+            std::rethrow_exception(exception);
+        }
+        m_writeQueue.push_back(std::move(block));
+    }
+    m_queueNonEmpty.notify_one();
+    return true;
 }
 
 // SaveMapping - save a map into the file
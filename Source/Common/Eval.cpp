@@ -136,6 +136,63 @@ void Eval<ElemType>::ResetState()
     m_eval->ResetState();
 }
 
+// EvaluateOnline - interactive-priority variant of Evaluate()
+template <class ElemType>
+void Eval<ElemType>::EvaluateOnline(std::map<std::wstring, std::vector<ElemType>*>& inputs, std::map<std::wstring, std::vector<ElemType>*>& outputs)
+{
+    m_eval->EvaluateOnline(inputs, outputs);
+}
+
+// StartEvaluateStream - Prepare the network for EvaluateStream() calls.
+// outputNodeName - name of node that will be evaluated
+template <class ElemType>
+void Eval<ElemType>::StartEvaluateStream(const std::wstring& outputNodeName)
+{
+    m_eval->StartEvaluateStream(outputNodeName);
+}
+
+// BindInputBuffer - bind a caller-owned buffer as the data source of an input node
+template <class ElemType>
+void Eval<ElemType>::BindInputBuffer(const std::wstring& nodeName, ElemType* buffer, size_t maxSamples)
+{
+    m_eval->BindInputBuffer(nodeName, buffer, maxSamples);
+}
+
+// BindOutputBuffer - bind a caller-owned buffer as the destination of an output node
+template <class ElemType>
+void Eval<ElemType>::BindOutputBuffer(const std::wstring& nodeName, ElemType* buffer, size_t maxSamples)
+{
+    m_eval->BindOutputBuffer(nodeName, buffer, maxSamples);
+}
+
+// EvaluateStream - evaluate the bound input buffers into the bound output buffers
+template <class ElemType>
+void Eval<ElemType>::EvaluateStream(size_t numSamples)
+{
+    m_eval->EvaluateStream(numSamples);
+}
+
+// SaveRecurrentState - snapshot the recurrent state carried by the model's delay nodes
+template <class ElemType>
+size_t Eval<ElemType>::SaveRecurrentState()
+{
+    return m_eval->SaveRecurrentState();
+}
+
+// RestoreRecurrentState - load a snapshot back; the next call continues that stream
+template <class ElemType>
+void Eval<ElemType>::RestoreRecurrentState(size_t stateId)
+{
+    m_eval->RestoreRecurrentState(stateId);
+}
+
+// ReleaseRecurrentState - free a snapshot
+template <class ElemType>
+void Eval<ElemType>::ReleaseRecurrentState(size_t stateId)
+{
+    m_eval->ReleaseRecurrentState(stateId);
+}
+
 //The explicit instantiation
 template class Eval<double>;
 template class Eval<float>;
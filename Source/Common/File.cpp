@@ -14,6 +14,8 @@
 #include <string>
 #include <stdint.h>
 #include <locale>
+#include <limits>  // for FormatFloatText()
+#include <cstring> // for memcpy()/memmove() in FormatFloatText()
 #ifdef _WIN32
 #define NOMINMAX
 #include "Windows.h"
@@ -161,14 +163,14 @@ void File::Flush()
 // str - string to store the line
 void File::GetLine(wstring& str)
 {
-    str = fgetlinew(m_file);
+    fgetlinew(m_file, str);
 }
 
 // GetLine - get a line from the file
 // str - string
 void File::GetLine(string& str)
 {
-    str = fgetline(m_file);
+    fgetline(m_file, str);
 }
 
 // GetLines - get all lines from a file
@@ -287,10 +289,11 @@ File& File::operator>>(std::wstring& val)
 {
     attempt([&]
             {
+                // assign-in-place readers: no allocation once val has reached its steady-state capacity
                 if (IsTextBased())
-                    val = fgetwtoken(m_file);
+                    fgetwtoken(m_file, val);
                 else
-                    val = fgetwstring(m_file);
+                    fgetwstring(m_file, val);
             });
     return *this;
 }
@@ -302,9 +305,9 @@ File& File::operator>>(std::string& val)
     attempt([&]
             {
                 if (IsTextBased())
-                    val = fgettoken(m_file);
+                    fgettoken(m_file, val);
                 else
-                    val = fgetstring(m_file);
+                    fgetstring(m_file, val);
             });
     return *this;
 }
@@ -721,4 +724,358 @@ void File::SetPosition(uint64_t pos)
         RuntimeError("File: attempted to SetPosition() on non-seekable stream");
     fsetpos(m_file, pos);
 }
+
+// -----------------------------------------------------------------------
+// FormatFloatText() -- fast float-to-text formatting for bulk output paths
+// -----------------------------------------------------------------------
+// Grisu2 shortest-representation conversion (Loitsch, "Printing Floating-Point Numbers
+// Quickly and Accurately with Integers", PLDI 2010). The significand is scaled by a cached
+// power of ten into a 64-bit fixed-point number from which the digits fall out with integer
+// divisions only--no multi-precision arithmetic and no stdio. Grisu2 emits the shortest
+// digit string that still parses back to the exact input value for >99% of inputs, and a
+// correctly parsed-back (just not always shortest) string for the rest, which is all that
+// text dumps need. This is what lets FormatTextRows() run several times faster than
+// per-value fprintf()/ostream formatting.
+
+namespace
+{
+// a floating-point number as significand * 2^exponent, with all precision in a uint64_t
+struct DiyFp
+{
+    uint64_t f;
+    int e;
+};
+
+// multiply with rounding of the dropped lower 64 bits of the 128-bit product
+static inline DiyFp DiyFpMultiply(DiyFp x, DiyFp y)
+{
+    const uint64_t M32 = 0xFFFFFFFFULL;
+    const uint64_t a = x.f >> 32, b = x.f & M32;
+    const uint64_t c = y.f >> 32, d = y.f & M32;
+    const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+    tmp += 1ULL << 31; // round the dropped half
+    DiyFp r = {ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64};
+    return r;
+}
+
+// cached powers of ten 10^k for k = -348, -340, ..., 340, as correctly rounded
+// normalized DiyFps; one entry per 8 decimal exponents spans all doubles
+static const uint64_t kCachedPowersF[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+    0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+    0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+    0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+    0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+    0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+    0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+    0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+    0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+    0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+    0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+    0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+    0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+    0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+    0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+};
+static const int16_t kCachedPowersE[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034,
+    -1007, -980, -954, -927, -901, -874, -847, -821,
+    -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396,
+    -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242,
+    269, 295, 322, 348, 375, 402, 428, 455,
+    481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+// pick the cached power of ten that scales a number with binary exponent e into a range
+// where at most one decimal exponent adjustment is needed; returns its decimal exponent in K
+static inline DiyFp GetCachedPower(int e, int* K)
+{
+    const double dk = (-61 - e) * 0.30102999566398114 + 347; // dk is positive, so the cast truncates towards the right index
+    int k = (int) dk;
+    if (dk - k > 0.0)
+        k++;
+    const unsigned index = (unsigned) ((k >> 3) + 1);
+    *K = -(-348 + (int) (index << 3));
+    DiyFp r = {kCachedPowersF[index], (int) kCachedPowersE[index]};
+    return r;
+}
+
+static inline unsigned CountDecimalDigit32(uint32_t n)
+{
+    if (n < 10) return 1;
+    if (n < 100) return 2;
+    if (n < 1000) return 3;
+    if (n < 10000) return 4;
+    if (n < 100000) return 5;
+    if (n < 1000000) return 6;
+    if (n < 10000000) return 7;
+    if (n < 100000000) return 8;
+    if (n < 1000000000) return 9;
+    return 10;
+}
+
+// nudge the last digit towards the scaled input w as long as the result stays inside the
+// rounding interval (delta), so that the shortest digit string also parses back correctly
+static inline void GrisuRound(char* buffer, int len, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t wpW)
+{
+    while (rest < wpW && delta - rest >= tenKappa &&
+           (rest + tenKappa < wpW || wpW - rest > rest + tenKappa - wpW))
+    {
+        buffer[len - 1]--;
+        rest += tenKappa;
+    }
+}
+
+// generate the digits of the scaled upper boundary Mp, stopping as soon as the remaining
+// uncertainty (delta = Mp - Mm) covers the rest; W is the scaled input value itself
+static void DigitGen(const DiyFp W, const DiyFp Mp, uint64_t delta, char* buffer, int* len, int* K)
+{
+    static const uint32_t kPow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+    const DiyFp one = {1ULL << -Mp.e, Mp.e};
+    const uint64_t wpW = Mp.f - W.f;
+    uint32_t p1 = (uint32_t) (Mp.f >> -one.e); // integral part
+    uint64_t p2 = Mp.f & (one.f - 1);          // fractional part
+    int kappa = (int) CountDecimalDigit32(p1);
+    *len = 0;
+    while (kappa > 0) // integral digits
+    {
+        const uint32_t d = p1 / kPow10[kappa - 1];
+        p1 %= kPow10[kappa - 1];
+        if (d != 0 || *len != 0)
+            buffer[(*len)++] = (char) ('0' + d);
+        kappa--;
+        const uint64_t tmp = ((uint64_t) p1 << -one.e) + p2;
+        if (tmp <= delta)
+        {
+            *K += kappa;
+            GrisuRound(buffer, *len, delta, tmp, (uint64_t) kPow10[kappa] << -one.e, wpW);
+            return;
+        }
+    }
+    for (;;) // fractional digits
+    {
+        p2 *= 10;
+        delta *= 10;
+        kappa--;
+        const char d = (char) (p2 >> -one.e);
+        if (d != 0 || *len != 0)
+            buffer[(*len)++] = (char) ('0' + d);
+        p2 &= one.f - 1;
+        if (p2 < delta)
+        {
+            *K += kappa;
+            GrisuRound(buffer, *len, delta, p2, one.f, wpW * kPow10[-kappa]);
+            return;
+        }
+    }
+}
+
+// core conversion of a positive finite value given as an (unnormalized) DiyFp; produces
+// the digit string in buffer so that value = 0.[buffer] rounded, i.e. value ~ buffer * 10^K
+// lowerBoundaryIsCloser: the value is a power of two, so its lower neighbor is nearer
+static void Grisu2(DiyFp v, bool lowerBoundaryIsCloser, char* buffer, int* length, int* K)
+{
+    // the rounding interval boundaries m- and m+, normalized to the full 64 bits
+    DiyFp mPlus = {(v.f << 1) + 1, v.e - 1};
+    while (!(mPlus.f & (1ULL << 63)))
+    {
+        mPlus.f <<= 1;
+        mPlus.e--;
+    }
+    DiyFp mMinus;
+    if (lowerBoundaryIsCloser)
+    {
+        mMinus.f = (v.f << 2) - 1;
+        mMinus.e = v.e - 2;
+    }
+    else
+    {
+        mMinus.f = (v.f << 1) - 1;
+        mMinus.e = v.e - 1;
+    }
+    mMinus.f <<= mMinus.e - mPlus.e;
+    mMinus.e = mPlus.e;
+
+    DiyFp w = v; // the value itself, normalized
+    while (!(w.f & (1ULL << 63)))
+    {
+        w.f <<= 1;
+        w.e--;
+    }
+
+    const DiyFp cMk = GetCachedPower(mPlus.e, K);
+    const DiyFp W = DiyFpMultiply(w, cMk);
+    DiyFp Wp = DiyFpMultiply(mPlus, cMk);
+    DiyFp Wm = DiyFpMultiply(mMinus, cMk);
+    Wm.f++; // shrink the interval by one ulp on each side to stay safe under the
+    Wp.f--; // rounding error of the cached-power multiplication
+    DigitGen(W, Wp, Wp.f - Wm.f, buffer, length, K);
+}
+
+static inline char* WriteExponent(int K, char* buffer)
+{
+    if (K < 0)
+    {
+        *buffer++ = '-';
+        K = -K;
+    }
+    if (K >= 100)
+    {
+        *buffer++ = (char) ('0' + K / 100);
+        K %= 100;
+        *buffer++ = (char) ('0' + K / 10);
+        *buffer++ = (char) ('0' + K % 10);
+    }
+    else if (K >= 10)
+    {
+        *buffer++ = (char) ('0' + K / 10);
+        *buffer++ = (char) ('0' + K % 10);
+    }
+    else
+        *buffer++ = (char) ('0' + K);
+    return buffer;
+}
+
+// lay out the raw digit string as plain decimal notation where compact, exponent
+// notation otherwise; returns one past the last character written
+static char* Prettify(char* buffer, int length, int k)
+{
+    const int kk = length + k; // value = buffer * 10^k = 0.[buffer] * 10^kk
+    if (length <= kk && kk <= 21)
+    {
+        // integral number with trailing zeros, e.g. 1234000
+        for (int i = length; i < kk; i++)
+            buffer[i] = '0';
+        return &buffer[kk];
+    }
+    else if (0 < kk && kk <= 21)
+    {
+        // decimal point inside the digit string, e.g. 12.34
+        memmove(&buffer[kk + 1], &buffer[kk], length - kk);
+        buffer[kk] = '.';
+        return &buffer[length + 1];
+    }
+    else if (-6 < kk && kk <= 0)
+    {
+        // pure fraction with leading zeros, e.g. 0.001234
+        const int offset = 2 - kk;
+        memmove(&buffer[offset], &buffer[0], length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        for (int i = 2; i < offset; i++)
+            buffer[i] = '0';
+        return &buffer[length + offset];
+    }
+    else if (length == 1)
+    {
+        // single digit in exponent notation, e.g. 1e30
+        buffer[1] = 'e';
+        return WriteExponent(kk - 1, &buffer[2]);
+    }
+    else
+    {
+        // exponent notation, e.g. 1.234e30
+        memmove(&buffer[2], &buffer[1], length - 1);
+        buffer[1] = '.';
+        buffer[length + 1] = 'e';
+        return WriteExponent(kk - 1, &buffer[length + 2]);
+    }
+}
+
+// decompose an IEEE double into a DiyFp; returns whether the lower neighbor is closer
+static inline bool UnpackFloatingPoint(double value, DiyFp& v)
+{
+    uint64_t u;
+    memcpy(&u, &value, sizeof(u));
+    const uint64_t significand = u & 0x000FFFFFFFFFFFFFULL;
+    const int biasedExponent = (int) ((u & 0x7FF0000000000000ULL) >> 52);
+    if (biasedExponent != 0) // normal
+    {
+        v.f = significand + (1ULL << 52);
+        v.e = biasedExponent - 1075;
+    }
+    else // denormal
+    {
+        v.f = significand;
+        v.e = -1074;
+    }
+    return v.f == (1ULL << 52); // a power of two: the gap below is half the gap above
+}
+
+// same for an IEEE single; going through the single-precision boundaries (rather than
+// formatting (double) value) is what keeps float output short, e.g. 0.1f -> "0.1"
+static inline bool UnpackFloatingPoint(float value, DiyFp& v)
+{
+    uint32_t u;
+    memcpy(&u, &value, sizeof(u));
+    const uint32_t significand = u & 0x007FFFFF;
+    const int biasedExponent = (int) ((u & 0x7F800000) >> 23);
+    if (biasedExponent != 0) // normal
+    {
+        v.f = (uint64_t) significand + (1ULL << 23);
+        v.e = biasedExponent - 150;
+    }
+    else // denormal
+    {
+        v.f = significand;
+        v.e = -149;
+    }
+    return v.f == (1ULL << 23);
+}
+
+template <class ElemType>
+static inline size_t FormatFloatTextImpl(char* buffer, ElemType value)
+{
+    char* p = buffer;
+    if (value != value) // NaN
+    {
+        memcpy(p, "nan", 3);
+        return 3;
+    }
+    if (value < 0)
+    {
+        *p++ = '-';
+        value = -value;
+    }
+    if (value == 0)
+    {
+        *p++ = '0';
+        return p - buffer;
+    }
+    if (value > std::numeric_limits<ElemType>::max()) // +infinity (sign already emitted)
+    {
+        memcpy(p, "inf", 3);
+        return (p - buffer) + 3;
+    }
+    DiyFp v;
+    const bool lowerBoundaryIsCloser = UnpackFloatingPoint(value, v);
+    int length, K;
+    Grisu2(v, lowerBoundaryIsCloser, p, &length, &K);
+    return Prettify(p, length, K) - buffer;
+}
+} // namespace
+
+size_t File::FormatFloatText(char* buffer, double value)
+{
+    return FormatFloatTextImpl(buffer, value);
+}
+
+size_t File::FormatFloatText(char* buffer, float value)
+{
+    return FormatFloatTextImpl(buffer, value);
+}
+
 } } }
@@ -11,6 +11,8 @@
 #include "DebugUtil.h"
 #include <string>
 #include <vector>
+#include <map>   // for Plugin's module cache
+#include <mutex> // ditto
 #include <assert.h>
 #if __unix__
 #include <dlfcn.h> // for Plugin
@@ -552,6 +554,23 @@ class Plugin
 {
     HMODULE m_hModule;      // module handle for the writer DLL
     std::wstring m_dllName; // name of the writer DLL
+
+    // process-wide cache of loaded modules: multi-stream reader configs request the same module
+    // once per stream, so each name hits the loader only once per process
+    static HMODULE LoadModule(const std::wstring& dllName)
+    {
+        static std::mutex s_loadedModulesMutex;
+        static std::map<std::wstring, HMODULE> s_loadedModules;
+        std::unique_lock<std::mutex> lock(s_loadedModulesMutex);
+        auto iter = s_loadedModules.find(dllName);
+        if (iter != s_loadedModules.end())
+            return iter->second;
+        HMODULE hModule = LoadLibrary(dllName.c_str());
+        if (hModule != NULL)
+            s_loadedModules[dllName] = hModule;
+        return hModule;
+    }
+
 public:
     Plugin()
         : m_hModule(NULL)
@@ -562,7 +581,7 @@ public:
     {
         m_dllName = msra::strfun::utf16(plugin);
         m_dllName += L".dll";
-        m_hModule = LoadLibrary(m_dllName.c_str());
+        m_hModule = LoadModule(m_dllName);
         if (m_hModule == NULL)
             RuntimeError("Plugin not found: %s", msra::strfun::utf8(m_dllName).c_str());
         // create a variable of each type just to call the proper templated version
@@ -580,6 +599,22 @@ class Plugin
 private:
     void* handle;
 
+    // process-wide cache of loaded modules; see the Windows variant above. dlopen() refcounts
+    // repeated loads, but each call still probes the search path on the file system.
+    static void* LoadModule(const std::string& soName)
+    {
+        static std::mutex s_loadedModulesMutex;
+        static std::map<std::string, void*> s_loadedModules;
+        std::unique_lock<std::mutex> lock(s_loadedModulesMutex);
+        auto iter = s_loadedModules.find(soName);
+        if (iter != s_loadedModules.end())
+            return iter->second;
+        void* handle = dlopen(soName.c_str(), RTLD_LAZY);
+        if (handle != NULL)
+            s_loadedModules[soName] = handle;
+        return handle;
+    }
+
 public:
     Plugin()
         : handle(NULL)
@@ -590,15 +625,14 @@ public:
     {
         string soName = msra::strfun::utf8(plugin);
         soName = soName + ".so";
-        void* handle = dlopen(soName.c_str(), RTLD_LAZY);
+        handle = LoadModule(soName);
         if (handle == NULL)
             RuntimeError("Plugin not found: %s (error: %s)", soName.c_str(), dlerror());
         return dlsym(handle, proc.c_str());
     }
+    // modules are owned by the process-wide cache and stay loaded (see the Windows note above)
     ~Plugin()
     {
-        if (handle != NULL)
-            dlclose(handle);
     }
 };
 #endif
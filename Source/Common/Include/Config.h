@@ -501,9 +501,9 @@ public:
                     // check for custom separator character
                     // If the opening brace is immediately followed by any of the customSeparators,
                     // change m_separator (inside seps) to that character.
-                    // The parser lets you change the default separator to something else. For example the default separator for an array is usually the �:� (I think)
+                    // The parser lets you change the default separator to something else. For example the default separator for an array is usually the �:� (I think)
                     // (12:45:23:46)
-                    // However if you are using strings, and one of those strings contains a �:�, you might want to change the separator to something else:
+                    // However if you are using strings, and one of those strings contains a �:�, you might want to change the separator to something else:
                     // (;this;is;a;path:;c:\mydir\stuff)
                     //
                     // This will fail for
@@ -704,11 +704,12 @@ public:
     }
 
     // construct ConfigParameters from a ConfigValue, propagate the config Name, and parent pointer
+    // Note: a ConfigValue is a std::string, so we can parse it in place instead of copying the
+    // entire section text first--for the big reader/NDL subtrees that copy is not free.
     ConfigParameters(const ConfigValue& configValue)
         : ConfigParser(';', configValue.Name()), m_parent(configValue.Parent())
     {
-        std::string configString = configValue;
-        Parse(configString);
+        Parse(configValue);
     }
 
     // private:
@@ -973,9 +974,11 @@ public:
     {
         // find the value
         // TODO: unify with the Find() function below
+        // convert the key once, not once per level of the parent chain
+        const string key(name, name + wcslen(name));
         for (auto* dict = this; dict; dict = dict->m_parent)
         {
-            auto iter = dict->find(string(name, name + wcslen(name)));
+            auto iter = dict->find(key);
             if (iter != dict->end())
             {
                 if (iter->second == "default")
@@ -1011,10 +1014,8 @@ public:
         }
         else
         {
-            std::string rhs = iter->second;
-            rhs = this->ResolveVariables(rhs);
             std::string fullName = m_configName + ":" + name;
-            result = ConfigValue(rhs, fullName, this);
+            result = ConfigValue(this->ResolveVariables(iter->second), fullName, this);
         }
         return result;
     }
@@ -1111,6 +1112,14 @@ public:
     // returns: A copy of 'configString' with all the variables resolved.
     std::string ResolveVariables(const std::string& configString) const
     {
+        // Fast path: values without a variable reference or comment character resolve to
+        // themselves. This runs on every Find(), and most values are plain scalars, so we
+        // avoid the line split and per-line copies for them.
+        if (configString.find_first_of("$#") == std::string::npos)
+        {
+            return configString;
+        }
+
         std::string newConfigString;
         if (configString.find_first_of("\n") != std::string::npos)
         {
@@ -1230,8 +1239,7 @@ public:
         : ConfigParser(separator, configValue.Name())
     {
         m_repeatAsterisk = repeatAsterisk;
-        std::string configString = configValue;
-        Parse(configString);
+        Parse(configValue); // ConfigValue is a std::string--no need to copy it before parsing
     }
 
     // config aray from a string
@@ -103,6 +103,14 @@ public:
     {
         NOT_IMPLEMENTED;
     };
+    // GetWriteRecordInfo - for write mode with reordered/batched records: returns, for each
+    // parallel sequence of the current minibatch, the index of the record in the input script
+    // and its number of frames, so the caller can route each output to its original record.
+    // Readers that deliver one record at a time in script order do not implement this.
+    virtual bool GetWriteRecordInfo(std::vector<std::pair<size_t, size_t>>& /*recordInfo*/)
+    {
+        return false;
+    }
     virtual size_t GetNumParallelSequences() = 0;
     virtual int GetSentenceEndIdFromOutputLabel()
     {
@@ -202,6 +210,7 @@ class DataReader : public IDataReader<ElemType>, protected Plugin, public Script
 private:
     vector<wstring> m_ioNames;                          // TODO: why are these needed, why not loop over m_dataReaders?
     map<wstring, IDataReader<ElemType>*> m_dataReaders; // readers
+    bool m_parallelFetch;                               // fetch the child readers' streams on parallel threads (config 'parallelFetch'; multi-reader configs only)
 
     // Init - Reader Initialize for multiple data sets
     // config - [in] configuration parameters for the datareader
@@ -270,6 +279,7 @@ public:
     virtual bool GetMinibatch(std::map<std::wstring, Matrix<ElemType>*>& matrices);
     virtual bool GetMinibatch4SE(std::vector<shared_ptr<const msra::dbn::latticepair>>& latticeinput, vector<size_t>& uids, vector<size_t>& boundaries, vector<size_t>& extrauttmap);
     virtual bool GetHmmData(msra::asr::simplesenonehmm* hmm);
+    virtual bool GetWriteRecordInfo(std::vector<std::pair<size_t, size_t>>& recordInfo) override;
 
     size_t GetNumParallelSequences();
     int GetSentenceEndIdFromOutputLabel();
@@ -28,6 +28,13 @@
 #include "ScriptableObjects.h"
 #include <map>
 #include <string>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -81,6 +88,34 @@ class DataWriter : public IDataWriter<ElemType>, protected Plugin
 private:
     IDataWriter<ElemType>* m_dataWriter; // writer
 
+    // Ordered write-behind queue, enabled with asyncWriteDepth=N (N > 0) in the writer config.
+    // SaveData() then deep-copies the output block to host memory, tags it with its submission
+    // order and returns; a single background thread drains the queue in that order through the
+    // plugin's SaveData(), so compute overlaps the writing without any record reordering. When
+    // the queue holds asyncWriteDepth blocks, SaveData() stalls until the writer catches up.
+    // Only valid for writers that take Matrix<ElemType> pointers in the matrices map (HTKMLF,
+    // Kaldi and the sequence writers, i.e. everything the output actions write through); the
+    // BinaryWriter's raw-array sections must keep this off.
+    struct PendingWrite
+    {
+        size_t recordStart;
+        size_t numRecords;
+        size_t datasetSize;
+        size_t byteVariableSized;
+        std::vector<std::pair<std::wstring, std::unique_ptr<Matrix<ElemType>>>> matrices; // host-side deep copies
+    };
+    size_t m_asyncWriteDepth = 0; // 0 = synchronous (default)
+    std::thread m_writerThread;
+    std::mutex m_writeMutex;
+    std::condition_variable m_queueNonEmpty;
+    std::condition_variable m_queueNonFull;
+    std::deque<std::unique_ptr<PendingWrite>> m_writeQueue;
+    bool m_finishWriting = false;         // set at shutdown, after which the writer thread exits once the queue is empty
+    std::exception_ptr m_writerException; // first failure on the writer thread; rethrown by the next SaveData()
+
+    void WriterThreadProc();
+    void DrainWriteQueue(); // finish all queued writes and stop the writer thread
+
     // Init - Writer Initialize for multiple data sets
     // config - [in] configuration parameters for the datawriter
     // Sample format below for BinaryWriter:
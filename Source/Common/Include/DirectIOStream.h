@@ -0,0 +1,291 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// DirectIOStream.h -- sequential file reader that bypasses the OS page cache
+//
+#pragma once
+
+#include "Basics.h"
+#include <string>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <string.h>
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h> // for SetThreadAffinityMask()
+#include <io.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <share.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Reads a file strictly front to back, double-buffered, with the actual I/O issued from a
+// dedicated thread that stays one block ahead of the consumer. On Linux the file is opened
+// with O_DIRECT (falling back to a buffered fd plus POSIX_FADV_DONTNEED if the file system
+// refuses), so a one-shot pass over a corpus-sized file does not flush the page cache that
+// chunk re-reads depend on. On Windows we keep the cache but still get the read-ahead thread
+// and the sequential-scan hint.
+//
+// Seeking is supported (the pipeline restarts at the enclosing aligned block), but this class
+// is meant for passes that are sequential in the large; every seek stalls on a fresh read.
+class DirectIOStream
+{
+    static const size_t BlockSize = 4 * 1024 * 1024; // read granularity; also the read-ahead distance
+    static const size_t Alignment = 4096;            // covers sector size requirements of O_DIRECT
+
+    struct Block
+    {
+        char* data;      // aligned buffer of BlockSize bytes
+        long long start; // file offset of data[0]
+        size_t bytes;    // valid bytes in this block
+        bool ready;      // filled by the I/O thread, not yet fully consumed
+    };
+
+#ifdef _WIN32
+    int m_fd;
+#else
+    int m_fd;
+    bool m_direct; // fd was opened with O_DIRECT
+#endif
+    long long m_fileSize;
+
+    // pipeline state; all of it is protected by m_mutex
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    Block m_blocks[2];
+    size_t m_fetchSlot;        // slot the I/O thread fills next
+    long long m_fetchOffset;   // file offset the I/O thread reads next (always aligned)
+    unsigned int m_generation; // bumped by Seek() to invalidate in-flight reads
+    bool m_shutdown;
+    size_t m_curSlot;     // slot the consumer drains
+    size_t m_curConsumed; // bytes of m_blocks[m_curSlot] already consumed (or skipped after a seek)
+    long long m_pos;      // consumer's logical file position
+    std::thread m_ioThread;
+
+public:
+    // ioCpu: processor to pin the I/O thread to; -1 picks the last one, -2 leaves it unpinned
+    DirectIOStream(const std::wstring& path, int ioCpu = -1)
+    {
+#ifdef _WIN32
+        m_fd = _wsopen(path.c_str(), _O_RDONLY | _O_BINARY | _O_SEQUENTIAL, _SH_DENYWR);
+        if (m_fd < 0)
+            RuntimeError("DirectIOStream: error opening file '%ls': %s", path.c_str(), strerror(errno));
+        m_fileSize = _lseeki64(m_fd, 0, SEEK_END);
+#else
+        std::string mbpath(path.begin(), path.end()); // our pathnames are plain ASCII
+        m_direct = true;
+        m_fd = open(mbpath.c_str(), O_RDONLY | O_DIRECT);
+        if (m_fd < 0) // e.g. tmpfs and some network file systems do not support O_DIRECT
+        {
+            m_direct = false;
+            m_fd = open(mbpath.c_str(), O_RDONLY);
+        }
+        if (m_fd < 0)
+            RuntimeError("DirectIOStream: error opening file '%ls': %s", path.c_str(), strerror(errno));
+        if (!m_direct)
+            posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL); // OK if it fails
+        m_fileSize = lseek(m_fd, 0, SEEK_END);
+#endif
+        if (m_fileSize < 0)
+            RuntimeError("DirectIOStream: cannot determine size of '%ls': %s", path.c_str(), strerror(errno));
+
+        for (size_t i = 0; i < 2; i++)
+        {
+#ifdef _WIN32
+            m_blocks[i].data = (char*) _aligned_malloc(BlockSize, Alignment);
+            if (m_blocks[i].data == NULL)
+                RuntimeError("DirectIOStream: failed to allocate aligned I/O buffer");
+#else
+            void* p;
+            if (posix_memalign(&p, Alignment, BlockSize) != 0)
+                RuntimeError("DirectIOStream: failed to allocate aligned I/O buffer");
+            m_blocks[i].data = (char*) p;
+#endif
+            m_blocks[i].ready = false;
+        }
+        m_fetchSlot = 0;
+        m_fetchOffset = 0;
+        m_generation = 0;
+        m_shutdown = false;
+        m_curSlot = 0;
+        m_curConsumed = 0;
+        m_pos = 0;
+
+        m_ioThread = std::thread([this]() { IOThreadLoop(); });
+        SetIOThreadAffinity(ioCpu);
+    }
+
+    ~DirectIOStream()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_shutdown = true;
+        }
+        m_cv.notify_all();
+        m_ioThread.join();
+        for (size_t i = 0; i < 2; i++)
+        {
+#ifdef _WIN32
+            _aligned_free(m_blocks[i].data);
+#else
+            free(m_blocks[i].data);
+#endif
+        }
+#ifdef _WIN32
+        _close(m_fd);
+#else
+        close(m_fd);
+#endif
+    }
+
+    long long Size() const
+    {
+        return m_fileSize;
+    }
+
+    long long GetPosition()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_pos;
+    }
+
+    // read up to 'size' bytes; returns the number of bytes read, 0 at end of file
+    size_t Read(void* buffer, size_t size)
+    {
+        char* dst = (char*) buffer;
+        size_t total = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (total < size && m_pos < m_fileSize)
+        {
+            Block& b = m_blocks[m_curSlot];
+            m_cv.wait(lock, [&] { return b.ready; });
+            if (m_curConsumed >= b.bytes) // short read (file truncated underneath us)
+                break;
+            size_t chunk = std::min(size - total, b.bytes - m_curConsumed);
+            memcpy(dst + total, b.data + m_curConsumed, chunk);
+            total += chunk;
+            m_curConsumed += chunk;
+            m_pos += chunk;
+            if (m_curConsumed == b.bytes) // block drained: hand it back to the I/O thread
+                RetireCurrentBlock();
+        }
+        return total;
+    }
+
+    // reposition the stream; restarts the read-ahead pipeline at the enclosing aligned block
+    void Seek(long long offset)
+    {
+        if (offset < 0 || offset > m_fileSize)
+            RuntimeError("DirectIOStream: seek to offset %lld outside of file of size %lld", offset, m_fileSize);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (offset == m_pos)
+            return;
+        // within the block we are currently draining? then just move the cursor
+        Block& b = m_blocks[m_curSlot];
+        if (b.ready && offset >= b.start && offset < b.start + (long long) b.bytes)
+        {
+            m_curConsumed = (size_t) (offset - b.start);
+            m_pos = offset;
+            return;
+        }
+        m_generation++; // invalidates whatever the I/O thread is reading right now
+        m_blocks[0].ready = false;
+        m_blocks[1].ready = false;
+        m_fetchOffset = offset - offset % (long long) BlockSize;
+        m_fetchSlot = 0;
+        m_curSlot = 0;
+        m_curConsumed = (size_t) (offset - m_fetchOffset); // skip the head of the first block
+        m_pos = offset;
+        lock.unlock();
+        m_cv.notify_all();
+    }
+
+private:
+    void RetireCurrentBlock() // called under m_mutex with the current block fully consumed
+    {
+        Block& b = m_blocks[m_curSlot];
+        b.ready = false;
+#ifndef _WIN32
+        if (!m_direct) // buffered fallback: evict what we just consumed so it cannot pollute the cache
+            posix_fadvise(m_fd, b.start, (off_t) b.bytes, POSIX_FADV_DONTNEED); // OK if it fails
+#endif
+        m_curSlot = 1 - m_curSlot;
+        m_curConsumed = 0;
+        m_cv.notify_all();
+    }
+
+    void IOThreadLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            m_cv.wait(lock, [&] { return m_shutdown || (!m_blocks[m_fetchSlot].ready && m_fetchOffset < m_fileSize); });
+            if (m_shutdown)
+                return;
+            size_t slot = m_fetchSlot;
+            long long offset = m_fetchOffset;
+            unsigned int generation = m_generation;
+            lock.unlock();
+#ifdef _WIN32
+            _lseeki64(m_fd, offset, SEEK_SET);
+            int n = _read(m_fd, m_blocks[slot].data, (unsigned int) BlockSize);
+#else
+            // aligned offset, aligned buffer, aligned length: valid under O_DIRECT; the kernel
+            // returns the actual byte count for the partial block at the end of the file
+            ssize_t n = pread(m_fd, m_blocks[slot].data, BlockSize, (off_t) offset);
+#endif
+            lock.lock();
+            if (generation != m_generation) // a Seek() happened while we were reading: discard
+                continue;
+            if (n < 0)
+                RuntimeError("DirectIOStream: read failure at offset %lld: %s", offset, strerror(errno));
+            m_blocks[slot].start = offset;
+            m_blocks[slot].bytes = (size_t) n;
+            m_blocks[slot].ready = true;
+            m_fetchOffset = offset + (long long) BlockSize; // not +n: O_DIRECT offsets must stay aligned
+            m_fetchSlot = 1 - m_fetchSlot;
+            m_cv.notify_all();
+        }
+    }
+
+    void SetIOThreadAffinity(int ioCpu)
+    {
+        if (ioCpu == -2)
+            return;
+#ifdef _WIN32
+        int numCpus = std::thread::hardware_concurrency();
+        if (numCpus <= 0)
+            return;
+        if (ioCpu < 0 || ioCpu >= numCpus)
+            ioCpu = numCpus - 1;
+        SetThreadAffinityMask((HANDLE) m_ioThread.native_handle(), 1ull << ioCpu); // OK if it fails
+#elif defined(__linux__)
+        int numCpus = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        if (numCpus <= 0)
+            return;
+        if (ioCpu < 0 || ioCpu >= numCpus)
+            ioCpu = numCpus - 1;
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(ioCpu, &cpuSet);
+        pthread_setaffinity_np(m_ioThread.native_handle(), sizeof(cpuSet), &cpuSet); // OK if it fails
+#else
+        ioCpu; // no affinity support on this platform
+#endif
+    }
+};
+
+} } }
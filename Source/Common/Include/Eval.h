@@ -49,6 +49,33 @@ public:
     virtual void StartEvaluateMinibatchLoop(const std::wstring& outputNodeName) = 0;
     virtual void Evaluate(std::map<std::wstring, std::vector<ElemType>*>& inputs, std::map<std::wstring, std::vector<ElemType>*>& outputs) = 0;
     virtual void ResetState() = 0;
+
+    // latency-deadline scheduling: when the evaluator is configured with latencyScheduling,
+    // Evaluate() is treated as batch work that runs in column sub-slices, and
+    // EvaluateOnline() submits an interactive request that takes the device at the next
+    // slice boundary. Online waits are recorded and their P99 is reported against the
+    // onlineLatencyBudgetMs budget. Without that configuration the two calls are identical.
+    virtual void EvaluateOnline(std::map<std::wstring, std::vector<ElemType>*>& inputs, std::map<std::wstring, std::vector<ElemType>*>& outputs) = 0;
+
+    // streamed low-latency evaluation: the caller binds its own (optionally pinned) input and
+    // output buffers to nodes once, then calls EvaluateStream() once per request. This skips
+    // the reader/writer plumbing and per-call buffer copies of Evaluate(); the compiled network
+    // and its evaluation order are kept warm across calls. ResetState() marks the next call as
+    // the start of a new utterance (relevant for models with delay nodes).
+    virtual void StartEvaluateStream(const std::wstring& outputNodeName) = 0;
+    virtual void BindInputBuffer(const std::wstring& nodeName, ElemType* buffer, size_t maxSamples) = 0;
+    virtual void BindOutputBuffer(const std::wstring& nodeName, ElemType* buffer, size_t maxSamples) = 0;
+    virtual void EvaluateStream(size_t numSamples) = 0;
+
+    // recurrent-state sessions: one evaluator can serve several interleaved streams without
+    // re-evaluating context frames. SaveRecurrentState() snapshots the hidden activations that
+    // the model's delay nodes carry across calls and returns a handle for them;
+    // RestoreRecurrentState() loads a snapshot back and marks the next Evaluate()/
+    // EvaluateStream() call as a continuation of that stream. Start a brand-new stream with
+    // ResetState() as before (not with a restore). ReleaseRecurrentState() frees a snapshot.
+    virtual size_t SaveRecurrentState() = 0;
+    virtual void RestoreRecurrentState(size_t stateId) = 0;
+    virtual void ReleaseRecurrentState(size_t stateId) = 0;
 };
 
 // GetEval - get a evaluator type from the DLL
@@ -102,5 +129,19 @@ public:
     virtual void Evaluate(std::map<std::wstring, std::vector<ElemType>*>& inputs, std::map<std::wstring, std::vector<ElemType>*>& outputs);
     virtual void Init(const std::string& config);
     virtual void ResetState();
+
+    // EvaluateOnline - interactive-priority variant of Evaluate(), see IEvaluateModel
+    virtual void EvaluateOnline(std::map<std::wstring, std::vector<ElemType>*>& inputs, std::map<std::wstring, std::vector<ElemType>*>& outputs);
+
+    // streamed low-latency evaluation, see IEvaluateModel
+    virtual void StartEvaluateStream(const std::wstring& outputNodeName);
+    virtual void BindInputBuffer(const std::wstring& nodeName, ElemType* buffer, size_t maxSamples);
+    virtual void BindOutputBuffer(const std::wstring& nodeName, ElemType* buffer, size_t maxSamples);
+    virtual void EvaluateStream(size_t numSamples);
+
+    // recurrent-state sessions, see IEvaluateModel
+    virtual size_t SaveRecurrentState();
+    virtual void RestoreRecurrentState(size_t stateId);
+    virtual void ReleaseRecurrentState(size_t stateId);
 };
 } } }
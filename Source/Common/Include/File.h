@@ -318,6 +318,39 @@ public:
         return array;
     }
 
+    // -----------------------------------------------------------------------
+    // high-throughput text output of floating-point data
+    // -----------------------------------------------------------------------
+
+    // Write the shortest decimal representation of 'value' that parses back to the exact
+    // same value (Grisu2, see File.cpp) into 'buffer', without a 0-terminator, and return
+    // the number of characters written. 'buffer' must have room for at least 32 characters.
+    // Several times faster than fprintf("%g")/ostream insertion, which bottleneck bulk
+    // text dumps on per-value formatting.
+    static size_t FormatFloatText(char* buffer, double value);
+    static size_t FormatFloatText(char* buffer, float value);
+
+    // Append column-major matrix data to 'buffer' as text, one line per column with
+    // space-separated elements--the row layout of the 'write' command's output files.
+    // Callers reuse 'buffer' across minibatches and write it out in one block, replacing
+    // millions of per-value stdio calls by one formatting pass and one large write.
+    template <class ElemType>
+    static void FormatTextRows(std::string& buffer, const ElemType* data, size_t numRows, size_t numCols)
+    {
+        buffer.clear();
+        char scratch[32];
+        for (size_t j = 0; j < numCols; j++)
+        {
+            for (size_t i = 0; i < numRows; i++)
+            {
+                size_t len = FormatFloatText(scratch, *data++);
+                scratch[len] = ' ';
+                buffer.append(scratch, len + 1);
+            }
+            buffer += '\n';
+        }
+    }
+
     operator FILE*() const
     {
         return m_file;
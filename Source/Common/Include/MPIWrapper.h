@@ -295,6 +295,45 @@ public:
         }
     }
 
+    // non-blocking in-place allreduce; completion is checked with TestRequest() or WaitRequest().
+    // The buffer must stay alive and untouched until the request has completed.
+    template <class ElemType>
+    void AllReduceAsync(ElemType *pData, size_t nData, MPI_Request *request)
+    {
+        *request = MPI_REQUEST_NULL;
+        if ((NumNodesInUse() > 1) && (Communicator() != MPI_COMM_NULL))
+        {
+            MPI_Iallreduce(MPI_IN_PLACE, pData, (int) nData, GetDataType(pData), MPI_SUM, Communicator(), request) || MpiFail("AllReduceAsync: MPI_Iallreduce");
+        }
+    }
+
+    // gather equally-sized contributions from all ranks; receiveData must hold
+    // numSendElements * NumNodesInUse() elements, ordered by rank
+    template <class ElemType>
+    void AllGather(const ElemType *sendData, size_t numSendElements, ElemType *receiveData)
+    {
+        if ((NumNodesInUse() > 1) && (Communicator() != MPI_COMM_NULL))
+        {
+            MPI_Allgather(const_cast<ElemType *>(sendData), (int) numSendElements, GetDataType(receiveData),
+                          receiveData, (int) numSendElements, GetDataType(receiveData), Communicator()) ||
+                MpiFail("AllGather: MPI_Allgather");
+        }
+    }
+
+    // returns true once the request has completed (a null request counts as completed)
+    bool TestRequest(MPI_Request *request)
+    {
+        int completed = 0;
+        MPI_Test(request, &completed, MPI_STATUS_IGNORE) || MpiFail("TestRequest: MPI_Test");
+        return completed != 0;
+    }
+
+    // block until the request has completed
+    void WaitRequest(MPI_Request *request)
+    {
+        MPI_Wait(request, MPI_STATUS_IGNORE) || MpiFail("WaitRequest: MPI_Wait");
+    }
+
     template <class ElemType>
     void Bcast(ElemType *pData, size_t nData, size_t srcRank)
     {
@@ -304,6 +343,13 @@ public:
         }
     }
 
+    // broadcast of a vector, e.g. a flattened set of weight matrices
+    template <typename VECTORLIKEOBJECT>
+    void Bcast(VECTORLIKEOBJECT &data, size_t srcRank)
+    {
+        Bcast(data.data(), data.size(), srcRank);
+    }
+
     // wait for all ranks to reach here
     void WaitAll()
     {
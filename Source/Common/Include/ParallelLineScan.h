@@ -0,0 +1,100 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// ParallelLineScan.h -- multi-threaded map-reduce over the lines of a large text file
+//
+#pragma once
+
+#include "Basics.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <future>
+#include <thread>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Process the lines of a text file as a map-reduce: the file is split into roughly equal byte
+// shards (one per worker), each worker scans the lines whose first byte falls inside its shard
+// into its own State -- so the scan itself needs no locking -- and the per-worker states are then
+// folded together in shard order.
+//
+// State must be default-constructible. 'mapLine' is called as mapLine(state, line) for every line
+// of the worker's shard; 'reduceStates' as reduceStates(target, source) once per additional
+// worker. Shards are read in binary mode, so on Windows a '\r' may remain at the end of each line;
+// mapLine must tolerate (strip) it. numWorkers = 0 means one worker per hardware thread.
+//
+// Intended for corpus-scale single-pass statistics (vocabulary counts, corpus indexing and the
+// like) where a single-threaded getline() loop is the bottleneck.
+template <class State, class MapFn, class ReduceFn>
+State ParallelLineMapReduce(const std::string& path, const MapFn& mapLine, const ReduceFn& reduceStates, size_t numWorkers = 0)
+{
+    if (numWorkers == 0)
+    {
+        numWorkers = std::thread::hardware_concurrency();
+        if (numWorkers == 0)
+            numWorkers = 1;
+    }
+
+    std::ifstream sizeProbe(path.c_str(), std::ios::binary | std::ios::ate);
+    if (!sizeProbe)
+        RuntimeError("ParallelLineMapReduce: cannot read %s", path.c_str());
+    const long long fileSize = (long long) sizeProbe.tellg();
+    sizeProbe.close();
+
+    // no point in more workers than bytes; also covers the empty file
+    if ((long long) numWorkers > fileSize)
+        numWorkers = (size_t) (fileSize > 0 ? fileSize : 1);
+
+    auto processShard = [&path, &mapLine](long long begin, long long end) -> State
+    {
+        State state;
+        std::ifstream f(path.c_str(), std::ios::binary);
+        if (!f)
+            RuntimeError("ParallelLineMapReduce: cannot read %s", path.c_str());
+
+        if (begin > 0)
+        {
+            // A line straddling 'begin' belongs to the previous shard. Look at the byte just
+            // before the shard: only if it ends a line does a new line start exactly at 'begin';
+            // otherwise skip forward to the next line start.
+            f.seekg(begin - 1);
+            char prev = 0;
+            f.get(prev);
+            if (prev != '\n')
+            {
+                std::string straddler;
+                std::getline(f, straddler);
+            }
+        }
+
+        std::string line;
+        long long pos = (long long) f.tellg(); // start offset of the next line; -1 once at EOF
+        while (pos >= 0 && pos < end && std::getline(f, line))
+        {
+            mapLine(state, line);
+            pos = (long long) f.tellg();
+        }
+        return state;
+    };
+
+    // map: one async worker per shard
+    std::vector<std::future<State>> workers;
+    for (size_t i = 1; i < numWorkers; i++)
+    {
+        long long begin = fileSize * (long long) i / (long long) numWorkers;
+        long long end = fileSize * (long long) (i + 1) / (long long) numWorkers;
+        workers.push_back(std::async(std::launch::async, processShard, begin, end));
+    }
+    State result = processShard(0, fileSize / (long long) numWorkers); // first shard on the calling thread
+
+    // reduce in shard order
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        State shardState = workers[i].get();
+        reduceStates(result, shardState);
+    }
+    return result;
+}
+} } }
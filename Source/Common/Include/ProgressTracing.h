@@ -4,10 +4,193 @@
 //
 #pragma once
 
+#include "Basics.h"
 #include "TimerUtility.h"
+#include "fileutil.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
+// ---------------------------------------------------------------------------
+// BinaryProgressTracing -- low-overhead binary trace channel
+//
+// The printf-based tracing below formats and writes on the training thread; at high trace rates
+// (numMBsToShowResult lowered for fine-grained monitoring) the formatting and console I/O stall
+// minibatches. When a trace file is configured (top-level config parameter 'binaryTraceFile'),
+// trace points instead append a fixed-size binary record to a lock-free single-producer/
+// single-consumer ring, which a background thread flushes to the file; the only work left on the
+// training thread is filling in one 32-byte struct. If the ring ever fills up, records are
+// dropped and counted rather than ever blocking the producer. The file starts with an 8-byte
+// magic and then holds packed Record structs; the "dumpBinaryTrace" command converts it back to
+// the textual format. Note that enabling the binary channel redirects the PROGRESS/EVALERR
+// console lines into the file, so it is not meant for jobs monitored by the cluster tools.
+// ---------------------------------------------------------------------------
+
+/*static*/ class BinaryProgressTracing
+{
+public:
+    enum RecordKind : unsigned int
+    {
+        kindProgress = 1,  // values[0] = global progress in percent
+        kindTrainLoss = 2, // values[0] = training criterion per sample, in percent
+        kindMinibatch = 3, // values[0..3] = samples seen, loss/sample, eval err/sample, samples/second
+    };
+
+#pragma pack(push, 1)
+    struct Record // fixed-size by design, so records can be appended and scanned without any parsing
+    {
+        float seconds;          // wall-clock seconds since tracing was enabled
+        unsigned int kind;      // RecordKind
+        unsigned int epoch;     // 1-based epoch number, 0 if not applicable
+        unsigned int minibatch; // minibatch number within the epoch, 0 if not applicable
+        float values[4];        // payload, see RecordKind
+    };
+#pragma pack(pop)
+    static_assert(sizeof(Record) == 32, "binary trace record is expected to be fixed 32 bytes");
+
+private:
+    static const size_t ringSize = 1 << 16; // records; 2 MB, several minutes of per-minibatch tracing
+
+    FILE* m_file;
+    std::vector<Record> m_ring;
+    std::atomic<size_t> m_head; // total number of records produced; slot = m_head % ringSize
+    std::atomic<size_t> m_tail; // total number of records flushed
+    std::atomic<unsigned long long> m_numDropped;
+    std::atomic<bool> m_stop;
+    std::thread m_flusher;
+    Timer m_timer;
+
+    BinaryProgressTracing()
+        : m_file(nullptr), m_head(0), m_tail(0), m_numDropped(0), m_stop(false)
+    {
+    }
+    ~BinaryProgressTracing()
+    {
+        if (!m_file)
+            return;
+        m_stop.store(true, std::memory_order_release);
+        m_flusher.join(); // flushes what is left in the ring before exiting
+        fclose(m_file);
+        unsigned long long numDropped = m_numDropped.load();
+        if (numDropped > 0)
+            fprintf(stderr, "BinaryProgressTracing: WARNING: %llu trace records were dropped (ring was full).\n", numDropped);
+    }
+
+    static BinaryProgressTracing& GetStaticInstance()
+    {
+        static BinaryProgressTracing us;
+        return us;
+    } // wrap static state in an accessor, so we won't need a CPP file
+
+    static const char* Magic()
+    {
+        return "CNTKTRC1";
+    } // first 8 bytes of the trace file
+
+    // background thread: drain the ring into the file, then sleep until there is more
+    void FlushLoop()
+    {
+        std::vector<Record> buffer;
+        for (;;)
+        {
+            size_t head = m_head.load(std::memory_order_acquire);
+            size_t tail = m_tail.load(std::memory_order_relaxed); // only this thread writes m_tail
+            if (tail == head)
+            {
+                if (m_stop.load(std::memory_order_acquire))
+                    return;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+            buffer.clear();
+            for (; tail != head; tail++)
+                buffer.push_back(m_ring[tail % ringSize]);
+            m_tail.store(tail, std::memory_order_release); // frees the slots for the producer
+            fwrite(buffer.data(), sizeof(Record), buffer.size(), m_file);
+            fflush(m_file);
+        }
+    }
+
+public:
+    static bool IsEnabled()
+    {
+        return GetStaticInstance().m_file != nullptr;
+    }
+
+    // open the trace file and start the flusher thread; called once at startup (main node only)
+    static void Enable(const std::wstring& path)
+    {
+        auto& us = GetStaticInstance();
+        if (us.m_file) // already enabled
+            return;
+        us.m_ring.resize(ringSize);
+        us.m_file = fopenOrDie(path, L"wb");
+        fwrite(Magic(), 1, 8, us.m_file);
+        us.m_timer.Start();
+        us.m_flusher = std::thread(&BinaryProgressTracing::FlushLoop, &us);
+    }
+
+    // append one record; wait-free for the producer (drops the record if the ring is full)
+    static void Emit(RecordKind kind, unsigned int epoch, unsigned int minibatch,
+                     float v0 = 0, float v1 = 0, float v2 = 0, float v3 = 0)
+    {
+        auto& us = GetStaticInstance();
+        if (!us.m_file)
+            return;
+        size_t head = us.m_head.load(std::memory_order_relaxed); // only this thread writes m_head
+        if (head - us.m_tail.load(std::memory_order_acquire) >= ringSize)
+        {
+            us.m_numDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Record& r = us.m_ring[head % ringSize];
+        r.seconds = (float) us.m_timer.ElapsedSeconds();
+        r.kind = kind;
+        r.epoch = epoch;
+        r.minibatch = minibatch;
+        r.values[0] = v0;
+        r.values[1] = v1;
+        r.values[2] = v2;
+        r.values[3] = v3;
+        us.m_head.store(head + 1, std::memory_order_release); // publish
+    }
+
+    // convert a trace file back into the textual format (the converter behind "dumpBinaryTrace")
+    static void ConvertToText(FILE* fin, FILE* fout)
+    {
+        char magic[8];
+        if (fread(magic, 1, sizeof(magic), fin) != sizeof(magic) || memcmp(magic, Magic(), sizeof(magic)) != 0)
+            RuntimeError("ConvertToText: not a CNTK binary trace file.");
+        Record r;
+        while (fread(&r, sizeof(r), 1, fin) == 1)
+        {
+            switch (r.kind)
+            {
+            case kindProgress:
+                fprintf(fout, "PROGRESS: %.2f%%\n", r.values[0]);
+                break;
+            case kindTrainLoss:
+                fprintf(fout, "EVALERR: %.7f%%\n", r.values[0]);
+                break;
+            case kindMinibatch:
+                fprintf(fout, "%10.3fs: Epoch[%2d]-Minibatch[%4d]: SamplesSeen = %d; TrainLossPerSample = %.8g; EvalErrPerSample = %.8g; SamplesPerSecond = %.1f\n",
+                        r.seconds, (int) r.epoch, (int) r.minibatch, (int) r.values[0], r.values[1], r.values[2], r.values[3]);
+                break;
+            default:
+                RuntimeError("ConvertToText: unknown trace record kind %d (file written by a newer version?).", (int) r.kind);
+            }
+        }
+    }
+};
+
 // ---------------------------------------------------------------------------
 // ProgressTracing -- static helper class for logging a progress indicator
 //
@@ -86,7 +269,10 @@ public:
         {
             double epochProg = ((100.0f * (double) (us.m_currentStepOffset + epochNumber)) / (double) us.m_totalNumberOfSteps);
             mbProg = (mbProg * 100.0f) / (double) us.m_totalNumberOfSteps;
-            printf("PROGRESS: %.2f%%\n", epochProg + mbProg);
+            if (BinaryProgressTracing::IsEnabled())
+                BinaryProgressTracing::Emit(BinaryProgressTracing::kindProgress, (unsigned int) (us.m_currentStepOffset + epochNumber) + 1, 0, (float) (epochProg + mbProg));
+            else
+                printf("PROGRESS: %.2f%%\n", epochProg + mbProg);
             us.m_progressTracingTimer.Restart();
         }
         return needToPrint;
@@ -103,7 +289,92 @@ public:
             return;
         }
 
-        printf("EVALERR: %.7f%%\n", err);
+        if (BinaryProgressTracing::IsEnabled())
+            BinaryProgressTracing::Emit(BinaryProgressTracing::kindTrainLoss, 0, 0, (float) err);
+        else
+            printf("EVALERR: %.7f%%\n", err);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// StartupProfiling -- phase attribution for process startup time
+//
+// Records how long the well-known startup phases take (config parsing, reader plugin load and
+// Init, network construction, validation, matrix allocation, first minibatch) and emits them as
+// one machine-parseable line when the first minibatch of the first epoch has been read, e.g.
+//     CNTKStartupProfile: total=42.123;configParse=0.31;networkBuild=12.45;...
+// so startup regressions per job class can be tracked by scraping logs at scale. Phases nest;
+// an enclosing phase includes the time of the phases inside it, and repeated phases accumulate
+// under the same name. After the summary is emitted once, all further calls are no-ops, so the
+// hooks cost nothing for the rest of the run.
+// ---------------------------------------------------------------------------
+
+/*static*/ class StartupProfiling
+{
+    struct OpenPhase
+    {
+        const char* name;
+        long long startUs;
+    };
+
+    bool m_done;            // summary emitted; all further recording is a no-op
+    long long m_processUs;  // time of first use, as a stand-in for process start
+    std::vector<OpenPhase> m_open;
+    std::vector<std::pair<std::string, double>> m_phases; // accumulated (name, seconds), in order of first Begin
+
+    StartupProfiling()
+        : m_done(false)
+    {
+        m_processUs = Timer::CurrentTimeMicroseconds();
+    }
+
+    static StartupProfiling& GetStaticInstance()
+    {
+        static StartupProfiling us;
+        return us;
+    } // wrap static state in an accessor, so we won't need a CPP file
+
+public:
+    // begin a named phase; 'name' must be a literal (it is kept, not copied, until EndPhase)
+    static void BeginPhase(const char* name)
+    {
+        auto& us = GetStaticInstance();
+        if (us.m_done)
+            return;
+        us.m_open.push_back(OpenPhase{name, Timer::CurrentTimeMicroseconds()});
+    }
+
+    static void EndPhase()
+    {
+        auto& us = GetStaticInstance();
+        if (us.m_done || us.m_open.empty())
+            return;
+        const auto& open = us.m_open.back();
+        double seconds = (Timer::CurrentTimeMicroseconds() - open.startUs) / 1e6;
+        auto iter = std::find_if(us.m_phases.begin(), us.m_phases.end(),
+                                 [&open](const std::pair<std::string, double>& phase)
+                                 {
+                                     return phase.first == open.name;
+                                 });
+        if (iter != us.m_phases.end())
+            iter->second += seconds;
+        else
+            us.m_phases.push_back(std::make_pair(std::string(open.name), seconds));
+        us.m_open.pop_back();
+    }
+
+    // print the one-line summary and disable further recording (called at the first minibatch of epoch 1)
+    static void EmitSummary()
+    {
+        auto& us = GetStaticInstance();
+        if (us.m_done)
+            return;
+        us.m_done = true;
+        fprintf(stderr, "CNTKStartupProfile: total=%.3f", (Timer::CurrentTimeMicroseconds() - us.m_processUs) / 1e6);
+        for (const auto& phase : us.m_phases)
+            fprintf(stderr, ";%s=%.3f", phase.first.c_str(), phase.second);
+        fprintf(stderr, "\n");
+        fflush(stderr);
     }
 };
 } } }
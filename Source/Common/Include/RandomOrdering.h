@@ -30,26 +30,78 @@ class RandomOrdering // note: NOT thread-safe at all
     const static size_t randomizeDisable = 0;
 
     typedef unsigned int INDEXTYPE; // don't use size_t, as this saves HUGE amounts of RAM
-    std::vector<INDEXTYPE> map;     // [t] -> t' indices in randomized order
+    std::vector<INDEXTYPE> map;     // [t] -> t' indices in randomized order (not used in on-the-fly mode)
+    size_t len;                     // number of elements in the ordering
     size_t currentseed;             // seed for current sequence
     size_t randomizationrange;      // t - randomizationrange/2 <= t' < t + randomizationrange/2 (we support this to enable swapping)
                                     // special values (randomizeDisable)
+    bool onthefly;                  // if true then indices come from a seeded block-local permutation evaluated on demand,
+                                    // with no materialized map; constant memory for arbitrarily large corpora
     void Invalidate()
     {
         currentseed = (size_t) -1;
     }
 
+    // 64-bit mixing function used as the Feistel round function (SplitMix64 finalizer)
+    static size_t RoundHash(size_t x, size_t seed, int round)
+    {
+        size_t h = x + seed * 0x9E3779B97F4A7C15ULL + ((size_t) round + 1) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 30;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 27;
+        h *= 0x94D049BB133111EBULL;
+        h ^= h >> 31;
+        return h;
+    }
+
+    // evaluate a pseudo-random permutation of [0, size) at position idx, in O(1) memory
+    // This runs a 4-round Feistel network over the smallest even-bit-width domain covering
+    // 'size', cycle-walking results that fall outside [0, size) back through the network.
+    // The domain is less than 4 * size, so the walk terminates after a few steps on average.
+    static size_t PseudoRandomPermutation(size_t idx, size_t size, size_t seed)
+    {
+        if (size <= 1)
+            return idx;
+        unsigned int halfbits = 1; // bits per Feistel half: smallest such that the domain covers 'size'
+        while (((size_t) 1 << (2 * halfbits)) < size)
+            halfbits++;
+        const size_t halfmask = ((size_t) 1 << halfbits) - 1;
+        size_t x = idx;
+        do
+        {
+            size_t left = x >> halfbits;
+            size_t right = x & halfmask;
+            for (int round = 0; round < 4; round++)
+            {
+                const size_t newright = left ^ (RoundHash(right, seed, round) & halfmask);
+                left = right;
+                right = newright;
+            }
+            x = (left << halfbits) | right;
+        } while (x >= size);
+        return x;
+    }
+
 public:
     RandomOrdering()
     {
         Invalidate();
         randomizationrange = randomizeDisable;
+        len = 0;
+        onthefly = false;
     }
 
-    void Resize(size_t len, size_t p_randomizationrange)
+    // 'p_onthefly': evaluate the ordering on demand instead of materializing the map; use this for
+    // corpora too large to afford 4 bytes per sample. The window condition below still holds, with
+    // the randomization done within disjoint blocks of half the window size.
+    void Resize(size_t p_len, size_t p_randomizationrange, bool p_onthefly = false)
     {
         randomizationrange = p_randomizationrange;
-        if (len > 0)
+        len = p_len;
+        onthefly = p_onthefly;
+        if (onthefly)
+            map.clear();
+        else if (len > 0)
             map.resize(len);
         Invalidate();
     }
@@ -58,16 +110,22 @@ public:
     std::pair<size_t, size_t> Bounds(size_t ts, size_t te) const
     {
         size_t tbegin = max(ts, randomizationrange / 2) - randomizationrange / 2;
-        size_t tend = min(te + randomizationrange / 2, map.size());
+        size_t tend = min(te + randomizationrange / 2, len);
         return std::make_pair<size_t, size_t>(std::move(tbegin), move(tend));
     }
 
-    // this returns the map directly (read-only) and will lazily initialize it for a given seed
-    const std::vector<INDEXTYPE>& operator()(size_t seed) // throw()
+    // this prepares the ordering for a given seed and returns it (read-only, accessed through operator[])
+    // In mapped mode the sequence is lazily recached; in on-the-fly mode there is nothing to cache.
+    const RandomOrdering& operator()(size_t seed) // throw()
     {
         // if wrong seed then lazily recache the sequence
         if (seed != currentseed && randomizationrange != randomizeDisable)
         {
+            if (onthefly)
+            {
+                currentseed = seed;
+                return *this;
+            }
             // test for numeric overflow
             if (map.size() - 1 != (INDEXTYPE)(map.size() - 1))
                 RuntimeError("RandomOrdering: INDEXTYPE has too few bits for this corpus");
@@ -121,7 +179,25 @@ public:
             fprintf(stderr, "RandomOrdering: recached sequence for seed %d: %d, %d, ...\n", (int) seed, (int) map[0], (int) map[1]);
             currentseed = seed;
         }
-        return map; // caller can now access it through operator[]
+        return *this; // caller can now access the ordering through operator[]
+    }
+
+    // [t] -> t' in randomized order
+    // In on-the-fly mode each disjoint block of half the randomization window is permuted
+    // independently by a seeded Feistel permutation, so |t - t'| < randomizationrange / 2 and
+    // the window condition of the mapped mode is preserved exactly.
+    size_t operator[](size_t t) const
+    {
+        if (!onthefly)
+            return map[t];
+        if (randomizationrange == randomizeDisable)
+            return t;
+        const size_t blocksize = max(randomizationrange / 2, (size_t) 1);
+        const size_t blockbegin = (t / blocksize) * blocksize;
+        const size_t thisblocksize = min(blocksize, len - blockbegin);
+        // give every block its own permutation by folding the block index into the seed
+        const size_t blockseed = currentseed + (t / blocksize) * 0x2545F4914F6CDD1DULL;
+        return blockbegin + PseudoRandomPermutation(t - blockbegin, thisblocksize, blockseed);
     }
 
     size_t CurrentSeed() const
@@ -519,6 +519,11 @@ class ConfigRecord : public Object, public IConfigRecord // all configuration ar
     // change to ContextInsensitiveMap<ConfigValuePtr>
     std::map<std::wstring, ConfigValuePtr> members;
     IConfigRecordPtr parentScope; // we look up the chain
+    // Memoized parent-chain lookups. Generated scripts nest scopes deeply (one per macro application),
+    // so without this every identifier access walks the whole chain, making lookup cost scale with
+    // nesting depth. Entries are only kept for ids not defined locally and are dropped if the id is
+    // later Add()ed here; map nodes have stable addresses, so the cached pointers stay valid.
+    mutable std::map<std::wstring, const ConfigValuePtr *> parentLookupCache;
     ConfigRecord()
     {
     } // forbidden (private) to instantiate without a scope
@@ -532,10 +537,12 @@ public:
     void Add(const std::wstring &id, const function<void(const std::wstring &)> & /*failfn*/, const ConfigValuePtr &value)
     {
         members[id] = value;
+        parentLookupCache.erase(id); // the local entry now shadows any cached parent match
     }
     void Add(const std::wstring &id, const function<void(const std::wstring &)> & /*failfn*/, ConfigValuePtr &&value)
     {
         members[id] = move(value);
+        parentLookupCache.erase(id);
     } // use this for unresolved ConfigPtrs
     // TODO: Add() does not yet correctly handle the failfn. It is meant to flag the location of the variable identifier
 
@@ -545,26 +552,30 @@ public:
     // Any unresolved value is resolved at this time, as it is being consumed. Only after resolving a ConfigValuePtr, it can be copied.
     const ConfigValuePtr & /*IConfigRecord::*/ operator[](const std::wstring &id) const // e.g. confRec[L"name"]
     {
-        const auto memberIter = members.find(id);
-        if (memberIter != members.end())
-            return memberIter->second.ResolveValue(); // resolve upon access
-        if (!parentScope)                             // not found: if at top scope, we fail
+        const auto *valp = Find(id); // resolves upon access; shares the parent-lookup memoization
+        if (valp)
+            return *valp;
+        if (!parentScope) // not found: if at top scope, we fail
             failfn(L"required parameter '" + id + L"' not found");
         // The failfn will report the location where the dictionary itself was formed.
         // This is because this function is meant to be used by C++ code.
         // When we look up a name by a BrainScript ".FIELD" expression, we will use Find() so we can report the error for the offending FIELD itself.
-        return (*parentScope)[id]; // have parent: look it up there
+        return (*parentScope)[id]; // have parent: walk up so the failure is reported at the top scope, as before
     }
     const ConfigValuePtr * /*IConfigRecord::*/ Find(const std::wstring &id) const // returns nullptr if not found
     {
         auto memberIter = members.find(id);
-        if (memberIter == members.end())
-            if (parentScope)
-                return parentScope->Find(id);
-            else
-                return nullptr;
-        else
+        if (memberIter != members.end())
             return &memberIter->second.ResolveValue();
+        if (!parentScope)
+            return nullptr;
+        auto cacheIter = parentLookupCache.find(id);
+        if (cacheIter != parentLookupCache.end())
+            return cacheIter->second;
+        const auto *valp = parentScope->Find(id);
+        if (valp) // (misses are not cached, as the id may legitimately be Add()ed to an enclosing scope later)
+            parentLookupCache[id] = valp;
+        return valp;
     }
     // get member ids; use this when you intend to consume all record entries and do not know the names
     // Note that unlike Find() and operator[], which return parent matches, this only returns entries in this record.
@@ -133,11 +133,13 @@ public:
         m_distanceToNearestEnd.assign(m_numTimeSteps, PTRDIFF_MAX);
         m_timeStepHasGap.assign(m_numTimeSteps, false);
         m_columnsValidityMask.Resize(0, 0); // invalidate
+        m_validColumnIndices.clear();       // invalidate
         // reset state
         m_numFramesDeclared = 0;
         m_numGapFrames = 0;
         m_sequences.clear();
         m_writable = true;
+        m_uniformFrameMode = false;
     }
 
     // -------------------------------------------------------------------
@@ -171,6 +173,12 @@ public:
 
     const Matrix<char>& GetColumnsValidityMask(DEVICEID_TYPE deviceId) const;
 
+    // return the column indices of all valid (non-gap) columns, in column order
+    // This is the host-side companion of GetColumnsValidityMask(). It feeds
+    // Matrix::AssignGatheredColumnsOf()/ScatterGatheredColumnsOf(), which pack gap columns
+    // out of a minibatch before a compute-heavy operation and spread the result back.
+    const std::vector<size_t>& GetValidColumnIndices() const;
+
     // compare whether two layouts are the same
     bool operator==(const MBLayout &other) const
     {
@@ -259,6 +267,13 @@ public:
     // This function provides an efficient short-cut implementation of AddSequence(t, t, 0, 1) for every sample t.
     void InitAsFrameMode(size_t numSamples)
     {
+        // Fast path: in frame mode the layout depends on nothing but the sample count, so if the
+        // previous minibatch was frame mode with the same count, it is bit-identical and can be
+        // reused as-is (including the cached validity mask). Readers call this every minibatch
+        // with a constant size, so a full epoch rebuilds the layout only once.
+        if (m_uniformFrameMode && m_numParallelSequences == numSamples && m_numTimeSteps == 1)
+            return;
+
         Init(numSamples, 1);
 
         // create sequences array
@@ -281,6 +296,7 @@ public:
         m_distanceToNearestStart[0] = 0;
         m_distanceToNearestEnd[0] = 0;
 
+        m_uniformFrameMode = true;
         Lock();
     }
 
@@ -301,6 +317,59 @@ public:
         LogicError("FindSequence: Requested sequence (id %u) not found.", (unsigned int) seqId);
     }
 
+    // -------------------------------------------------------------------
+    // serialization (compact wire format)
+    // -------------------------------------------------------------------
+
+    // Append this layout to a flat 64-bit element buffer: the dimensions, followed by one span
+    // record {seqId, s, tBegin, tEnd} per sequence (gap records included, so a round trip is
+    // exact). This is run-length by construction--O(#sequences) rather than per-column--so layout
+    // metadata stays negligible next to the minibatch data it describes when exchanged across
+    // ranks or written to capture files.
+    void SerializeTo(std::vector<long long> &buffer) const
+    {
+        buffer.push_back((long long) m_numParallelSequences);
+        buffer.push_back((long long) m_numTimeSteps);
+        buffer.push_back((long long) m_sequences.size());
+        for (const auto &seq : m_sequences)
+        {
+            buffer.push_back((long long) seq.seqId); // GAP_SEQUENCE_ID survives the round trip (-1)
+            buffer.push_back((long long) seq.s);
+            buffer.push_back((long long) seq.tBegin);
+            buffer.push_back((long long) seq.tEnd);
+        }
+    }
+
+    // number of buffer elements SerializeTo() appends for this layout
+    size_t SerializedSize() const
+    {
+        return 3 + 4 * m_sequences.size();
+    }
+
+    // Rebuild this layout from a buffer written by SerializeTo(). Returns the number of elements
+    // consumed, so several layouts can be packed back to back in one buffer.
+    size_t DeserializeFrom(const long long *buffer, size_t size)
+    {
+        if (size < 3)
+            LogicError("DeserializeFrom: buffer too small for an MBLayout header.");
+        Init((size_t) buffer[0], (size_t) buffer[1]);
+        size_t numSequences = (size_t) buffer[2];
+        size_t consumed = 3;
+        if (size - consumed < 4 * numSequences)
+            LogicError("DeserializeFrom: buffer too small for %d sequence records.", (int) numSequences);
+        for (size_t i = 0; i < numSequences; i++)
+        {
+            SequenceInfo seq;
+            seq.seqId = (UniqueSequenceId) buffer[consumed];
+            seq.s = (size_t) buffer[consumed + 1];
+            seq.tBegin = (ptrdiff_t) buffer[consumed + 2];
+            seq.tEnd = (size_t) buffer[consumed + 3];
+            AddSequence(seq); // the SequenceInfo overload replays gap records and assigned ids verbatim
+            consumed += 4;
+        }
+        return consumed;
+    }
+
     // -------------------------------------------------------------------
     // inquire about gaps or boundaries
     // -------------------------------------------------------------------
@@ -399,11 +468,19 @@ private:
     // and 0 indicates invalid (aka MinibatchPackingFlags::NoInput)
     mutable Matrix<char> m_columnsValidityMask;
 
+    // Cached column indices of all valid (non-gap) columns, lazily built like the mask above
+    mutable std::vector<size_t> m_validColumnIndices;
+
     // A boolean flag indicating whether the MBLayout can be further modified
     // When it's value is false, no set operations are allowed on the MBLayout.
     // Meant to guard in lazy creation of m_columnsValidityMask.
     mutable bool m_writable;
 
+    // true if this layout was built by InitAsFrameMode() and not touched since.
+    // Such layouts are fully determined by the sample count, which lets InitAsFrameMode()
+    // skip the rebuild when called again with the same count.
+    bool m_uniformFrameMode;
+
 public:
 
     // special accessor for sequence training  --TODO: must be replaced by a different mechanism
@@ -707,6 +784,33 @@ inline const Matrix<char> &MBLayout::GetColumnsValidityMask(DEVICEID_TYPE device
     return m_columnsValidityMask;
 }
 
+// return the column indices of all valid (non-gap) columns, which is lazily computed here upon first call
+inline const std::vector<size_t> &MBLayout::GetValidColumnIndices() const
+{
+    CheckIsValid();
+    // lazily compute the index list
+    if (m_validColumnIndices.empty())
+    {
+        Lock();
+
+        size_t nT = GetNumTimeSteps();
+        size_t nS = GetNumParallelSequences();
+
+        m_validColumnIndices.reserve(GetActualNumSamples());
+        for (size_t t = 0; t < nT; t++)
+        {
+            FrameRange fr(nullptr, t);
+            for (size_t s = 0; s < nS; s++)
+            {
+                if (!IsGap(fr.Sequence(s)))
+                    m_validColumnIndices.push_back((t * nS) + s);
+            }
+        }
+        assert(m_validColumnIndices.size() == GetActualNumSamples()); // sanity check
+    }
+    return m_validColumnIndices;
+}
+
 // class for defining an iteration over a sequence, forward and backward
 // One day, we may also have nested structures. For those, FrameRangeIterations will be able to be instantiated from FrameRange objects to loop over their nested dimension.
 class FrameRangeIteration
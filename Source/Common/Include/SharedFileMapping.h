@@ -0,0 +1,138 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// SharedFileMapping.h -- read-only shared memory mapping of a whole file
+//
+#pragma once
+
+#include "Basics.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// A read-only mapping of an entire file into the address space. The mapping is shared, i.e.
+// backed by the file's page-cache pages rather than by private copies, so every process on the
+// box that maps the same file references the same physical pages. Within one process, Open()
+// pools the mappings by file name, so repeated opens of the same file share one view as well.
+//
+// The view must never be written through (the pages are mapped read-only); consumers that point
+// long-lived data structures into it must keep the returned shared_ptr alive for as long as the
+// pointers are dereferenced.
+class SharedFileMapping
+{
+public:
+    // map 'fileName' read-only; fails with RuntimeError if the file cannot be opened or mapped
+    static std::shared_ptr<SharedFileMapping> Open(const std::wstring& fileName)
+    {
+        static std::mutex s_openMappingsMutex;
+        static std::map<std::wstring, std::weak_ptr<SharedFileMapping>> s_openMappings;
+        std::lock_guard<std::mutex> lock(s_openMappingsMutex);
+        auto iter = s_openMappings.find(fileName);
+        if (iter != s_openMappings.end())
+        {
+            auto mapping = iter->second.lock();
+            if (mapping) // (an expired entry means all previous users released it; map it anew)
+                return mapping;
+        }
+        std::shared_ptr<SharedFileMapping> mapping(new SharedFileMapping(fileName));
+        s_openMappings[fileName] = mapping;
+        return mapping;
+    }
+
+    const char* Data() const
+    {
+        return (const char*) m_view;
+    }
+    size_t Size() const
+    {
+        return m_size;
+    }
+
+    ~SharedFileMapping()
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_view);
+        CloseHandle((HANDLE) m_hndMapped);
+        CloseHandle((HANDLE) m_hndFile);
+#else
+        munmap(m_view, m_size);
+#endif
+    }
+
+private:
+    SharedFileMapping(const std::wstring& fileName)
+    {
+#ifdef _WIN32
+        HANDLE hndFile = CreateFileW(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (hndFile == INVALID_HANDLE_VALUE)
+            RuntimeError("SharedFileMapping: error opening file '%ls': %d", fileName.c_str(), (int) GetLastError());
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(hndFile, &size))
+        {
+            CloseHandle(hndFile);
+            RuntimeError("SharedFileMapping: error determining the size of '%ls': %d", fileName.c_str(), (int) GetLastError());
+        }
+        HANDLE hndMapped = CreateFileMapping(hndFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (hndMapped == NULL)
+        {
+            CloseHandle(hndFile);
+            RuntimeError("SharedFileMapping: error creating file mapping for '%ls': %d", fileName.c_str(), (int) GetLastError());
+        }
+        m_view = MapViewOfFile(hndMapped, FILE_MAP_READ, 0, 0, 0);
+        if (m_view == NULL)
+        {
+            CloseHandle(hndMapped);
+            CloseHandle(hndFile);
+            RuntimeError("SharedFileMapping: error mapping view of '%ls': %d", fileName.c_str(), (int) GetLastError());
+        }
+        m_hndFile = hndFile;
+        m_hndMapped = hndMapped;
+        m_size = (size_t) size.QuadPart;
+#else
+        int fd = open(msra::strfun::utf8(fileName).c_str(), O_RDONLY);
+        if (fd < 0)
+            RuntimeError("SharedFileMapping: error opening file '%ls': %s", fileName.c_str(), strerror(errno));
+        struct stat64 fileInfo;
+        if (fstat64(fd, &fileInfo) < 0)
+        {
+            close(fd);
+            RuntimeError("SharedFileMapping: error determining the size of '%ls': %s", fileName.c_str(), strerror(errno));
+        }
+        m_size = (size_t) fileInfo.st_size;
+        m_view = mmap(NULL, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); // the mapping keeps the file alive
+        if (m_view == MAP_FAILED)
+            RuntimeError("SharedFileMapping: error mapping file '%ls': %s", fileName.c_str(), strerror(errno));
+#endif
+    }
+
+    // not copyable: the instance owns the view
+    SharedFileMapping(const SharedFileMapping&) = delete;
+    SharedFileMapping& operator=(const SharedFileMapping&) = delete;
+
+private:
+    void* m_view;
+    size_t m_size;
+#ifdef _WIN32
+    void* m_hndFile;
+    void* m_hndMapped;
+#endif
+};
+} } }
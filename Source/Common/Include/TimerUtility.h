@@ -26,6 +26,9 @@ public:
         return ElapsedMicroseconds() / static_cast<double>(MICRO_PER_SEC);
     }
 
+    // current absolute time on the same clock, in microseconds; for timestamping events
+    static long long CurrentTimeMicroseconds();
+
 private:
     long long ElapsedMicroseconds();
     long long GetStamp();
@@ -41,6 +41,19 @@
 FILE* fopenOrDie(const std::string& pathname, const char* mode);
 FILE* fopenOrDie(const std::wstring& pathname, const wchar_t* mode);
 
+// ----------------------------------------------------------------------------
+// fopenStreamOrDie(): open a file read-only for a one-shot sequential pass.
+// Where supported (glibc), the returned FILE* is backed by a DirectIOStream,
+// i.e. reads bypass the OS page cache and are issued ahead of time from a
+// dedicated affinitized I/O thread, so streaming a corpus-sized file once
+// does not evict cached chunks that will be re-read later. Elsewhere this
+// degrades to fopenOrDie() with the sequential-access hint. Seeking works
+// but restarts the read-ahead; use for streams that are sequential in the
+// large. Close with fclose() (or auto_file_ptr) as usual.
+// ----------------------------------------------------------------------------
+
+FILE* fopenStreamOrDie(const std::wstring& pathname);
+
 #ifndef __unix__
 // ----------------------------------------------------------------------------
 // fsetmode(): set mode to binary or text
@@ -226,6 +239,10 @@ CHAR* fgetline(FILE* f, CHAR(&buf)[n])
 }
 std::string fgetline(FILE* f);
 std::wstring fgetlinew(FILE* f);
+// assign-in-place versions of the string readers below: the scratch space comes
+// from a reused-buffer registry, so steady-state calls perform no heap allocation
+void fgetline(FILE* f, std::string& s);
+void fgetlinew(FILE* f, std::wstring& s);
 void fgetline(FILE* f, std::string& s, std::vector<char>& buf);
 void fgetline(FILE* f, std::wstring& s, std::vector<char>& buf);
 void fgetline(FILE* f, std::vector<char>& buf);
@@ -247,6 +264,8 @@ const char* fgetstring(const HANDLE f, char(&buf)[n])
 const wchar_t* fgetstring(FILE* f, wchar_t* buf, int size);
 std::wstring fgetwstring(FILE* f);
 std::string fgetstring(FILE* f);
+void fgetstring(FILE* f, std::string& res);
+void fgetwstring(FILE* f, std::wstring& res);
 
 const char* fgettoken(FILE* f, char* buf, int size);
 template <size_t n>
@@ -257,6 +276,8 @@ const char* fgettoken(FILE* f, char(&buf)[n])
 std::string fgettoken(FILE* f);
 const wchar_t* fgettoken(FILE* f, wchar_t* buf, int size);
 std::wstring fgetwtoken(FILE* f);
+void fgettoken(FILE* f, std::string& res);
+void fgetwtoken(FILE* f, std::wstring& res);
 
 int fskipNewline(FILE* f, bool skip = true);
 int fskipwNewline(FILE* f, bool skip = true);
@@ -22,6 +22,7 @@
 #include <string>
 #include <unordered_map>
 #include <algorithm> // for find()
+#include <mutex>     // for archive read lock (background prefetch)
 #include "simplesenonehmm.h"
 #include "Matrix.h"
 
@@ -1213,6 +1214,7 @@ class archive
 
     mutable size_t currentarchiveindex;               // which archive is open
     mutable auto_file_ptr f;                          // cached archive file handle of currentarchiveindex
+    mutable std::mutex readlock;                      // serializes getlattice(): the file handle and lazy symmap init above are shared, and chunk readahead calls us from background threads
     std::unordered_map<std::wstring, latticeref> toc; // [key] -> (file, offset)  --table of content (.toc file)
 public:
     // construct = open the archive
@@ -1322,6 +1324,9 @@ public:
     void getlattice(const std::wstring& key, lattice& L,
                     size_t expectedframes = SIZE_MAX /*if unknown*/) const
     {
+        // Serialize access: we share one file handle across all lattices of an archive, and the
+        // chunk readahead of the minibatch source calls this concurrently from background threads.
+        std::lock_guard<std::mutex> lock(readlock);
         auto iter = toc.find(key);
         if (iter == toc.end())
             LogicError("getlattice: requested lattice for non-existent key; haslattice() should have been used to check availability");
@@ -0,0 +1,127 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// logsumexp.h -- vectorized log-sum-exp (batched logadd), shared between the lattice
+// forward/backward code and the CRF functions in CPUMatrix
+//
+
+#pragma once
+
+#ifdef _WIN32
+#include <intrin.h> // for intrinsics
+#endif
+#ifdef __unix__
+#include <x86intrin.h>
+#endif
+#include <cmath>
+#include <cstddef>
+
+namespace msra { namespace math {
+
+// ===========================================================================
+// logsumexp() -- compute log (sum_k exp (x[k])) over a buffer of log-domain
+// values in one go. This is the batched form of the scalar logadd() chain:
+// one SIMD max pass and one SIMD exp/accumulate pass replace n-1 dependent
+// exp()/log() library calls, with a single log() left at the end.
+//
+// The buffer must be non-empty. Values may be LOGZERO-like (~ -1e30) but not
+// -infinity; entries far below the maximum simply flush to zero in the sum.
+// Results can differ from a scalar logadd() chain in the last bits since the
+// sum is reassociated (and not truncated at the 53rd bit like logaddratio()).
+// ===========================================================================
+
+// exp() of both lanes of a double vector, for arguments <= 0 as they arise in
+// log-sum-exp (x - max). Standard Cephes-style evaluation: reduce x = n ln 2 + r,
+// approximate exp (r) by a Pade' ratio, and scale by 2^n through the exponent
+// bits. Accurate to ~1 ulp over the reduced range; arguments below -708 (where
+// exp() underflows the normal range) are clamped, which is harmless here since
+// the lane for the maximum always contributes exactly 1.
+static inline __m128d logsumexp_exppd(__m128d x)
+{
+    x = _mm_max_pd(x, _mm_set1_pd(-708.0));
+    // n = round (x * log2 (e))
+    const __m128d log2e = _mm_set1_pd(1.4426950408889634073599);
+    __m128i n = _mm_cvtpd_epi32(_mm_mul_pd(x, log2e));
+    __m128d nd = _mm_cvtepi32_pd(n);
+    // r = x - n ln 2, with ln 2 split in two for accuracy
+    const __m128d c1 = _mm_set1_pd(6.93145751953125E-1);
+    const __m128d c2 = _mm_set1_pd(1.42860682030941723212E-6);
+    x = _mm_sub_pd(x, _mm_mul_pd(nd, c1));
+    x = _mm_sub_pd(x, _mm_mul_pd(nd, c2));
+    // exp (r) = 1 + 2 r P(r^2) / (Q(r^2) - r P(r^2))
+    const __m128d p0 = _mm_set1_pd(1.26177193074810590878E-4);
+    const __m128d p1 = _mm_set1_pd(3.02994407707441961300E-2);
+    const __m128d p2 = _mm_set1_pd(9.99999999999999999910E-1);
+    const __m128d q0 = _mm_set1_pd(3.00198505138664455042E-6);
+    const __m128d q1 = _mm_set1_pd(2.52448340349684104192E-3);
+    const __m128d q2 = _mm_set1_pd(2.27265548208155028766E-1);
+    const __m128d q3 = _mm_set1_pd(2.00000000000000000005E0);
+    __m128d rr = _mm_mul_pd(x, x);
+    __m128d pr = _mm_mul_pd(x, _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(p0, rr), p1), rr), p2));
+    __m128d qr = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(q0, rr), q1), rr), q2), rr), q3);
+    __m128d e = _mm_add_pd(_mm_set1_pd(1.0), _mm_mul_pd(_mm_set1_pd(2.0), _mm_div_pd(pr, _mm_sub_pd(qr, pr))));
+    // scale by 2^n: build the power of two directly in the exponent field
+    __m128i pow2 = _mm_slli_epi64(_mm_unpacklo_epi32(_mm_add_epi32(n, _mm_set1_epi32(1023)), _mm_setzero_si128()), 52);
+    return _mm_mul_pd(e, _mm_castsi128_pd(pow2));
+}
+
+static inline double logsumexp(const double *x, size_t n)
+{
+    // max pass
+    size_t i = 0;
+    double mx = x[0];
+    if (n >= 2)
+    {
+        __m128d vmax = _mm_loadu_pd(x);
+        for (i = 2; i + 1 < n; i += 2)
+            vmax = _mm_max_pd(vmax, _mm_loadu_pd(x + i));
+        mx = _mm_cvtsd_f64(_mm_max_sd(vmax, _mm_unpackhi_pd(vmax, vmax)));
+    }
+    for (; i < n; i++)
+        if (x[i] > mx)
+            mx = x[i];
+    // accumulate sum_k exp (x[k] - max)
+    const __m128d vmx = _mm_set1_pd(mx);
+    __m128d vsum = _mm_setzero_pd();
+    for (i = 0; i + 1 < n; i += 2)
+        vsum = _mm_add_pd(vsum, logsumexp_exppd(_mm_sub_pd(_mm_loadu_pd(x + i), vmx)));
+    double sum = _mm_cvtsd_f64(vsum) + _mm_cvtsd_f64(_mm_unpackhi_pd(vsum, vsum));
+    for (; i < n; i++)
+        sum += exp(x[i] - mx);
+    return mx + log(sum);
+}
+
+// float version; the accumulation still runs in double like the scalar LogAdd chains it replaces
+static inline double logsumexp(const float *x, size_t n)
+{
+    // max pass
+    size_t i = 0;
+    float mx = x[0];
+    if (n >= 4)
+    {
+        __m128 vmax = _mm_loadu_ps(x);
+        for (i = 4; i + 3 < n; i += 4)
+            vmax = _mm_max_ps(vmax, _mm_loadu_ps(x + i));
+        vmax = _mm_max_ps(vmax, _mm_movehl_ps(vmax, vmax));
+        vmax = _mm_max_ss(vmax, _mm_shuffle_ps(vmax, vmax, 1));
+        mx = _mm_cvtss_f32(vmax);
+    }
+    for (; i < n; i++)
+        if (x[i] > mx)
+            mx = x[i];
+    // accumulate sum_k exp (x[k] - max), two lanes at a time widened to double
+    const __m128d vmx = _mm_set1_pd((double) mx);
+    __m128d vsum = _mm_setzero_pd();
+    for (i = 0; i + 1 < n; i += 2)
+    {
+        __m128d xd = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *) (x + i))));
+        vsum = _mm_add_pd(vsum, logsumexp_exppd(_mm_sub_pd(xd, vmx)));
+    }
+    double sum = _mm_cvtsd_f64(vsum) + _mm_cvtsd_f64(_mm_unpackhi_pd(vsum, vsum));
+    for (; i < n; i++)
+        sum += exp((double) x[i] - (double) mx);
+    return (double) mx + log(sum);
+}
+};
+};
@@ -0,0 +1,109 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// RegionProfiler.cpp -- scoped region markers with per-thread event buffers and chrome://tracing output
+//
+
+#include "RegionProfiler.h"
+#include "TimerUtility.h"
+#include <mutex>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+struct ProfilerEvent
+{
+    const char* name; // static storage, from the PROFILE_REGION() literal
+    long long beginUs;
+    long long endUs;
+};
+
+struct ProfilerEventBuffer
+{
+    static const size_t bufferSize = 1 << 16; // newest events overwrite the oldest beyond this
+    ProfilerEvent events[bufferSize];
+    size_t numRecorded; // total ever recorded; events[numRecorded % bufferSize] is the next slot
+    unsigned long threadOrdinal; // small per-thread id for the trace output, in registration order
+};
+
+static const char* GetRegionProfilePathFromEnv()
+{
+    return getenv("CNTK_REGION_PROFILE");
+}
+bool RegionProfiler::s_enabled = (GetRegionProfilePathFromEnv() != nullptr);
+
+static std::mutex s_regionProfileMutex;                          // guards the buffer registry
+static std::vector<ProfilerEventBuffer*> s_regionProfileBuffers; // one buffer per thread that has recorded
+
+#ifdef _WIN32
+static __declspec(thread) ProfilerEventBuffer* t_regionProfileBuffer = nullptr;
+#else
+static __thread ProfilerEventBuffer* t_regionProfileBuffer = nullptr;
+#endif
+
+long long RegionProfiler::TimeStampMicroseconds()
+{
+    return Timer::CurrentTimeMicroseconds();
+}
+
+void RegionProfiler::Record(const char* name, long long beginUs, long long endUs)
+{
+    ProfilerEventBuffer* buffer = t_regionProfileBuffer;
+    if (buffer == nullptr) // first region on this thread: create and register its buffer
+    {
+        buffer = new ProfilerEventBuffer(); // never freed; the exit dump reads it
+        buffer->numRecorded = 0;
+        std::lock_guard<std::mutex> lock(s_regionProfileMutex);
+        if (s_regionProfileBuffers.empty())
+            atexit(Dump);
+        buffer->threadOrdinal = (unsigned long) s_regionProfileBuffers.size();
+        s_regionProfileBuffers.push_back(buffer);
+        t_regionProfileBuffer = buffer;
+    }
+    ProfilerEvent& event = buffer->events[buffer->numRecorded % ProfilerEventBuffer::bufferSize];
+    event.name = name;
+    event.beginUs = beginUs;
+    event.endUs = endUs;
+    buffer->numRecorded++;
+}
+
+// registered with atexit(); writes all threads' events as chrome://tracing "complete" events
+// (threads may still be running; an event raced with here is merely written half-updated)
+void RegionProfiler::Dump()
+{
+    const char* path = GetRegionProfilePathFromEnv();
+    if (path == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(s_regionProfileMutex);
+    FILE* f = fopen(path, "w");
+    if (f == nullptr)
+    {
+        fprintf(stderr, "RegionProfiler: cannot write trace file %s\n", path);
+        return;
+    }
+
+    size_t numEvents = 0;
+    fprintf(f, "[");
+    for (const auto* buffer : s_regionProfileBuffers)
+    {
+        size_t numKept = std::min(buffer->numRecorded, (size_t) ProfilerEventBuffer::bufferSize);
+        for (size_t i = 0; i < numKept; i++)
+        {
+            const ProfilerEvent& event = buffer->events[i];
+            fprintf(f, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%lld,\"dur\":%lld}",
+                    numEvents == 0 ? "" : ",", event.name, buffer->threadOrdinal,
+                    event.beginUs, event.endUs - event.beginUs);
+            numEvents++;
+        }
+    }
+    fprintf(f, "\n]\n");
+    fclose(f);
+    fprintf(stderr, "RegionProfiler: wrote %d events from %d threads to %s\n",
+            (int) numEvents, (int) s_regionProfileBuffers.size(), path);
+}
+} } }
@@ -69,4 +69,18 @@ long long Timer::ElapsedMicroseconds()
     return diff / MICRO_PER_NANO;
 #endif
 }
+
+long long Timer::CurrentTimeMicroseconds()
+{
+#ifdef WIN32
+    assert(s_setFreq == TRUE);
+    LARGE_INTEGER li;
+    QueryPerformanceCounter(&li);
+    return (li.QuadPart * MICRO_PER_SEC) / s_ticksPerSecond.QuadPart;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec * (long long) MICRO_PER_SEC + ts.tv_nsec / MICRO_PER_NANO;
+#endif
+}
 } } }
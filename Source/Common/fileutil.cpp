@@ -36,6 +36,8 @@
 #include <limits.h>
 #include <memory>
 #include <cwctype>
+#include "ConcStack.h"       // for the scratch buffer registry used by the string readers
+#include "DirectIOStream.h"  // for fopenStreamOrDie()
 #ifndef UNDER_CE // some headers don't exist under winCE - the appropriate definitions seem to be in stdlib.h
 #if defined(_WIN32) || defined(__CYGWIN__)
 #include <fcntl.h> // for _O_BINARY/TEXT - not needed for wince
@@ -257,6 +259,70 @@ FILE* fopenOrDie(const wstring& pathname, const wchar_t* mode)
     return f;
 }
 
+// ----------------------------------------------------------------------------
+// fopenStreamOrDie(): open a file for a one-shot sequential pass that bypasses
+// the page cache (see fileutil.h). On glibc we wrap a DirectIOStream into a
+// FILE* via fopencookie() so that the freadOrDie()/fsetpos() machinery works
+// unchanged on top of it.
+// ----------------------------------------------------------------------------
+
+#ifdef __GLIBC__
+
+static ssize_t directStreamRead(void* cookie, char* buf, size_t size)
+{
+    return (ssize_t) ((Microsoft::MSR::CNTK::DirectIOStream*) cookie)->Read(buf, size);
+}
+
+static int directStreamSeek(void* cookie, off64_t* offset, int whence)
+{
+    auto* stream = (Microsoft::MSR::CNTK::DirectIOStream*) cookie;
+    long long target;
+    if (whence == SEEK_SET)
+        target = *offset;
+    else if (whence == SEEK_CUR)
+        target = stream->GetPosition() + *offset;
+    else if (whence == SEEK_END)
+        target = stream->Size() + *offset;
+    else
+        return -1;
+    if (target < 0 || target > stream->Size())
+        return -1;
+    stream->Seek(target);
+    *offset = target;
+    return 0;
+}
+
+static int directStreamClose(void* cookie)
+{
+    delete (Microsoft::MSR::CNTK::DirectIOStream*) cookie;
+    return 0;
+}
+
+FILE* fopenStreamOrDie(const wstring& pathname)
+{
+    auto* stream = new Microsoft::MSR::CNTK::DirectIOStream(pathname);
+    cookie_io_functions_t fns = {directStreamRead, NULL, directStreamSeek, directStreamClose};
+    FILE* f = fopencookie(stream, "rb", fns);
+    if (f == NULL)
+    {
+        delete stream;
+        RuntimeError("error opening file '%ls' for streaming: %s", pathname.c_str(), strerror(errno));
+    }
+    // keep the stdio-side buffer small: the read-ahead lives in the stream itself, and a large
+    // stdio buffer would just add a second copy of the data
+    setvbuf(f, NULL, _IOFBF, 65536); // OK if it fails
+    return f;
+}
+
+#else // no fopencookie(): fall back to a plain buffered handle with the sequential hint
+
+FILE* fopenStreamOrDie(const wstring& pathname)
+{
+    return fopenOrDie(pathname, L"rbS");
+}
+
+#endif
+
 // ----------------------------------------------------------------------------
 // set mode to binary or text (pass 'b' or 't')
 // ----------------------------------------------------------------------------
@@ -776,18 +842,77 @@ CHAR* fgetline(FILE* f, CHAR* buf, int size)
     return buf;
 }
 
+// ----------------------------------------------------------------------------
+// borrowedbuffer: reusable scratch buffers for the string-returning readers
+// The functions below used to allocate a fresh scratch vector (1 MB for line
+// reads) on every call; readers call them once per corpus line or token, and
+// the resulting malloc traffic turns into lock contention when several reader
+// threads parse scripts concurrently. Instead we borrow a buffer from a
+// process-wide conc_stack and return it on scope exit, so steady-state
+// reading does not touch the heap.
+// ----------------------------------------------------------------------------
+
+template <class CHAR>
+class borrowedbuffer
+{
+public:
+    borrowedbuffer()
+        : m_buf(registry().pop_or_create([]
+                                         {
+                                             return std::vector<CHAR>(1000000); // enough? // KIT: increased to 1M to be safe
+                                         }))
+    {
+    }
+    ~borrowedbuffer()
+    {
+        registry().push(std::move(m_buf));
+    }
+    CHAR* data()
+    {
+        return m_buf.data();
+    }
+    int size() const
+    {
+        return (int) m_buf.size();
+    }
+
+private:
+    static Microsoft::MSR::CNTK::conc_stack<std::vector<CHAR>>& registry()
+    {
+        static Microsoft::MSR::CNTK::conc_stack<std::vector<CHAR>> buffers; // buffers live for the process lifetime; high-water mark = #concurrent readers
+        return buffers;
+    }
+    std::vector<CHAR> m_buf;
+};
+
 // STL string version
 std::string fgetline(FILE* f)
 {
-    vector<char> buf(1000000);
-    return fgetline(f, &buf[0], (int) buf.size());
+    std::string s;
+    fgetline(f, s);
+    return s;
 }
 
 // STL string version
 std::wstring fgetlinew(FILE* f)
 {
-    vector<wchar_t> buf(1000000);
-    return fgetline(f, &buf[0], (int) buf.size());
+    std::wstring s;
+    fgetlinew(f, s);
+    return s;
+}
+
+// assign-in-place versions: with a warm scratch registry and a target string at
+// its steady-state capacity these perform no heap allocation at all
+void fgetline(FILE* f, std::string& s)
+{
+    borrowedbuffer<char> buf;
+    s.assign(fgetline(f, buf.data(), buf.size()));
+}
+
+void fgetlinew(FILE* f, std::wstring& s)
+{
+    borrowedbuffer<wchar_t> buf;
+    s.assign(fgetline(f, buf.data(), buf.size()));
 }
 
 // STL string version avoiding most memory allocations
@@ -842,22 +967,22 @@ const char* fgetstring(FILE* f, __out_z_cap(size) char* buf, int size)
     return buf;
 }
 
-// read a 0-terminated wstring
+// read a 0-terminated string
 string fgetstring(FILE* f)
 {
     string res;
-    for (;;)
-    {
-        char c = (char) fgetc(f);
-        if (c == EOF)
-            RuntimeError("error reading string or missing 0: %s", strerror(errno));
-        if (c == 0)
-            break;
-        res.push_back(c);
-    }
+    fgetstring(f, res);
     return res;
 }
 
+// assign-in-place version
+void fgetstring(FILE* f, string& res)
+{
+    borrowedbuffer<char> buf;
+    fgetstring(f, buf.data(), buf.size());
+    res.assign(buf.data());
+}
+
 // read a 0-terminated string
 const wchar_t* fgetstring(FILE* f, __out_z_cap(size) wchar_t* buf, int size)
 {
@@ -881,13 +1006,23 @@ const wchar_t* fgetstring(FILE* f, __out_z_cap(size) wchar_t* buf, int size)
     return buf;
 }
 
-#if (_MSC_VER < 1800)
 // read a 0-terminated wstring
 wstring fgetwstring(FILE* f)
 {
-    // TODO: we should redefine this to write UTF-16 (which matters on GCC which defines wchar_t as 32 bit)
     wstring res;
-    for (;;)
+    fgetwstring(f, res);
+    return res;
+}
+
+#if (_MSC_VER < 1800)
+// assign-in-place version
+void fgetwstring(FILE* f, wstring& res)
+{
+    // TODO: we should redefine this to write UTF-16 (which matters on GCC which defines wchar_t as 32 bit)
+    borrowedbuffer<wchar_t> buf;
+    wchar_t* p = buf.data();
+    int i;
+    for (i = 0;; i++)
     {
         //
         // there is a known vc++ runtime bug: Microsoft Connect 768113
@@ -906,27 +1041,22 @@ wstring fgetwstring(FILE* f)
             RuntimeError("error reading string or missing 0: %s", strerror(errno));
         if (c == 0)
             break;
-        res.push_back((wchar_t) c);
+        if (i >= buf.size() - 1)
+            RuntimeError("input line too long (max. %d wchar_tacters allowed)", buf.size() - 1);
+        p[i] = (wchar_t) c;
     }
-    return res;
+    p[i] = 0;
+    res.assign(p);
 }
 
 #else
-// read a 0-terminated wstring
-wstring fgetwstring(FILE* f)
+// assign-in-place version
+void fgetwstring(FILE* f, wstring& res)
 {
     // TODO: we should redefine this to write UTF-16 (which matters on GCC which defines wchar_t as 32 bit)
-    wstring res;
-    for (;;)
-    {
-        wint_t c = fgetwc(f);
-        if (c == WEOF)
-            RuntimeError("error reading string or missing 0: %s", strerror(errno));
-        if (c == 0)
-            break;
-        res.push_back((wchar_t) c);
-    }
-    return res;
+    borrowedbuffer<wchar_t> buf;
+    fgetstring(f, buf.data(), buf.size());
+    res.assign(buf.data());
 }
 #endif
 
@@ -1079,8 +1209,17 @@ const char* fgettoken(FILE* f, __out_z_cap(size) char* buf, int size)
 
 string fgettoken(FILE* f)
 {
-    char buf[80];
-    return fgettoken(f, buf, sizeof(buf) / sizeof(*buf));
+    string res;
+    fgettoken(f, res);
+    return res;
+}
+
+// assign-in-place version
+void fgettoken(FILE* f, string& res)
+{
+    borrowedbuffer<char> buf;
+    fgettoken(f, buf.data(), buf.size());
+    res.assign(buf.data());
 }
 
 // read a space-terminated token
@@ -1115,8 +1254,17 @@ const wchar_t* fgettoken(FILE* f, __out_z_cap(size) wchar_t* buf, int size)
 
 wstring fgetwtoken(FILE* f)
 {
-    wchar_t buf[80];
-    return fgettoken(f, buf, sizeof(buf) / sizeof(*buf));
+    wstring res;
+    fgetwtoken(f, res);
+    return res;
+}
+
+// assign-in-place version
+void fgetwtoken(FILE* f, wstring& res)
+{
+    borrowedbuffer<wchar_t> buf;
+    fgettoken(f, buf.data(), buf.size());
+    res.assign(buf.data());
 }
 
 template <>
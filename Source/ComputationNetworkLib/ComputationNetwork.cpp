@@ -19,10 +19,14 @@
 #include "EvaluationNodes.h"
 #include "SpecialPurposeNodes.h"
 #include "MPIWrapper.h" // TODO: does not belong here
+#include "SharedFileMapping.h"
 #include <string>
 #include <vector>
 #include <list>
 #include <set>
+#include <thread>
+#include <atomic>
+#include <mutex>
 
 using namespace std;
 
@@ -33,17 +37,33 @@ namespace Microsoft { namespace MSR { namespace CNTK {
 // -----------------------------------------------------------------------
 
 template <>
-vector<shared_ptr<Matrix<float>>>& MatrixPool::GetReleasedMatrices<float>()
+std::map<MatrixPool::BucketKey, vector<shared_ptr<Matrix<float>>>>& MatrixPool::GetReleasedMatrices<float>()
 {
     return m_releasedFloatMatrices;
 }
 
 template <>
-vector<shared_ptr<Matrix<double>>>& MatrixPool::GetReleasedMatrices<double>()
+std::map<MatrixPool::BucketKey, vector<shared_ptr<Matrix<double>>>>& MatrixPool::GetReleasedMatrices<double>()
 {
     return m_releasedDoubleMatrices;
 }
 
+template <>
+std::map<const void*, MatrixPool::Attribution<float>>& MatrixPool::GetAttributions<float>()
+{
+    return m_floatAttributions;
+}
+
+template <>
+std::map<const void*, MatrixPool::Attribution<double>>& MatrixPool::GetAttributions<double>()
+{
+    return m_doubleAttributions;
+}
+
+// process-wide model cache for CreateFromFile(), see EnableModelCache()
+bool ComputationNetwork::s_modelCacheEnabled = false;
+std::map<std::wstring, ComputationNetworkPtr> ComputationNetwork::s_modelCache;
+
 // -----------------------------------------------------------------------
 // construction
 // -----------------------------------------------------------------------
@@ -66,6 +86,7 @@ void ComputationNetwork::ClearNetwork()
         iter.second->DetachInputs();
 
     m_nameToNodeMap.clear();
+    m_mergedNodeAliases.clear();
 
     m_pMBLayout->Init(1, 0);
 }
@@ -82,7 +103,8 @@ void ComputationNetwork::SaveEdited(const wstring& fileName, const FileOptions f
     Save(fileName, fileFormat);
 }
 
-void ComputationNetwork::Save(const wstring& fileName, const FileOptions fileFormat) const
+void ComputationNetwork::Save(const wstring& fileName, const FileOptions fileFormat,
+                              const std::map<std::wstring, ComputationNodeBasePtr>* nodeOverrides) const
 {
     VerifyIsCompiled("Save");
     // In case of parallel training only the main node should we saving the model to prevent
@@ -93,13 +115,14 @@ void ComputationNetwork::Save(const wstring& fileName, const FileOptions fileFor
         // Saving into temporary file and then renaming it to the requested fileName
         // This is a standard trick to avoid havign corrupted model files if process dies during writing
         wstring tmpFileName = fileName + L".tmp";
-        SaveToFileImpl(tmpFileName, fileFormat);
+        SaveToFileImpl(tmpFileName, fileFormat, nodeOverrides);
         renameOrDie(tmpFileName, fileName);
     }
 }
 
 // TODO: how does the file distinguish float vs double nodes?
-void ComputationNetwork::SaveToFileImpl(const wstring& fileName, const FileOptions fileFormat) const
+void ComputationNetwork::SaveToFileImpl(const wstring& fileName, const FileOptions fileFormat,
+                                        const std::map<std::wstring, ComputationNodeBasePtr>* nodeOverrides) const
 {
     File fstream(fileName, fileFormat | FileOptions::fileOptionsWrite);
     fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCN");
@@ -111,12 +134,26 @@ void ComputationNetwork::SaveToFileImpl(const wstring& fileName, const FileOptio
 
     fstream << (size_t) m_nameToNodeMap.size();
 
+    // For binary files we remember each node's extent in the file, to be appended as an offset table
+    // below. The table lets Read() skip over the big value matrices and load them lazily on demand.
+    bool writeNodeValueExtents = fstream.CanSeek() && !fstream.IsTextBased();
+    std::vector<std::pair<std::wstring, std::pair<uint64_t, uint64_t>>> nodeValueExtents;
+
     // put all node info first
     fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BNodeList");
     for (auto nodeIter = m_nameToNodeMap.begin(); nodeIter != m_nameToNodeMap.end(); nodeIter++)
     {
         ComputationNodeBasePtr nodePtr = nodeIter->second;
+        if (nodeOverrides)
+        {
+            auto overrideIter = nodeOverrides->find(nodeIter->first);
+            if (overrideIter != nodeOverrides->end())
+                nodePtr = overrideIter->second;
+        }
+        uint64_t beginOffset = writeNodeValueExtents ? fstream.GetPosition() : 0;
         nodePtr->Save(fstream);
+        if (writeNodeValueExtents)
+            nodeValueExtents.push_back(make_pair(nodePtr->NodeName(), make_pair(beginOffset, fstream.GetPosition())));
     }
 
     fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ENodeList");
@@ -185,14 +222,79 @@ void ComputationNetwork::SaveToFileImpl(const wstring& fileName, const FileOptio
 
     fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECN");
 
+    // Append the node-value offset table after the regular model data, followed by a fixed-width
+    // trailer holding the table's own offset. Readers that do not know about the table (or cannot
+    // seek) stop at ECN and never see it, so the format stays backwards-compatible.
+    if (writeNodeValueExtents)
+    {
+        uint64_t tableOffset = fstream.GetPosition();
+        fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BNodeValueExtents");
+        fstream << (size_t) nodeValueExtents.size();
+        for (const auto& extent : nodeValueExtents)
+            fstream << extent.first << extent.second.first << extent.second.second;
+        fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ENodeValueExtents");
+        fstream << tableOffset;
+    }
+
     fstream.Flush();
 }
 
+// locate and read back the node-value offset table appended by SaveToFileImpl(), if present
+// The read position is restored before returning. Returns false for text files, unseekable
+// streams, and older model files that do not carry a table.
+/*static*/ bool ComputationNetwork::TryReadNodeValueExtents(File& fstream, std::map<std::wstring, std::pair<uint64_t, uint64_t>>& nodeValueExtents)
+{
+    if (!fstream.CanSeek() || fstream.IsTextBased())
+        return false;
+
+    uint64_t savedPosition = fstream.GetPosition();
+    bool found = false;
+    try
+    {
+        size_t fileSize = fstream.Size();
+        if (fileSize >= sizeof(uint64_t))
+        {
+            fstream.SetPosition(fileSize - sizeof(uint64_t));
+            uint64_t tableOffset;
+            fstream >> tableOffset;
+            // in older files the trailing bytes are just model data; the range check and the marker
+            // probe below weed those out
+            if (tableOffset < fileSize - sizeof(uint64_t))
+            {
+                fstream.SetPosition(tableOffset);
+                if (fstream.TryGetMarker(FileMarker::fileMarkerBeginSection, L"BNodeValueExtents"))
+                {
+                    size_t numNodes;
+                    fstream >> numNodes;
+                    for (size_t i = 0; i < numNodes; i++)
+                    {
+                        wstring nodeName;
+                        uint64_t beginOffset, endOffset;
+                        fstream >> nodeName >> beginOffset >> endOffset;
+                        nodeValueExtents[nodeName] = make_pair(beginOffset, endOffset);
+                    }
+                    fstream.GetMarker(FileMarker::fileMarkerEndSection, L"ENodeValueExtents");
+                    found = true;
+                }
+            }
+        }
+    }
+    catch (...) // a failed probe on an old file is not an error; fall back to sequential loading
+    {
+        nodeValueExtents.clear();
+        found = false;
+    }
+    fstream.SetPosition(savedPosition);
+    return found;
+}
+
 // load the section of nodes that contain persistable parameters
 // This is used for reloading a model without recreating it, e.g. during training.
 // TODO: Why not just reload it? Because SGD::Train() holds pointers to the parameters directly? That should be fixed.
 template <class ElemType>
-void ComputationNetwork::ReadPersistableParameters(File& fstream, bool create)
+void ComputationNetwork::ReadPersistableParameters(File& fstream, bool create,
+                                                   const std::map<std::wstring, std::pair<uint64_t, uint64_t>>* nodeValueExtents /*= nullptr*/,
+                                                   const std::wstring& fileName /*= std::wstring()*/)
 {
     fstream.GetMarker(FileMarker::fileMarkerBeginSection, L"BCN");
 
@@ -220,7 +322,19 @@ void ComputationNetwork::ReadPersistableParameters(File& fstream, bool create)
         else // reloading existing
             node = GetNodeFromName(nodeName);
 
-        node->Load(fstream, modelVersion);
+        // with an offset table, nodes holding a large value matrix may skip it and materialize it later
+        bool deferred = false;
+        if (create && nodeValueExtents != nullptr)
+        {
+            auto extent = nodeValueExtents->find(nodeName);
+            if (extent != nodeValueExtents->end())
+            {
+                node->LoadValueDeferred(fstream, modelVersion, fileName, extent->second.second);
+                deferred = true;
+            }
+        }
+        if (!deferred)
+            node->Load(fstream, modelVersion);
 
         if (create) // loaded from scratch
             AddNodeToNet(node);
@@ -234,13 +348,22 @@ void ComputationNetwork::ReadPersistableParameters(File& fstream, bool create)
 // deserialize the model
 // This does not post-process the model (CompileNetwork()). Use Load() instead.
 template <class ElemType>
-void ComputationNetwork::Read(const wstring& fileName, const FileOptions fileFormat, const bool /*bAllowNoCriterionNode --unused*/, ComputationNetwork* anotherNetwork)
+void ComputationNetwork::Read(const wstring& fileName, const FileOptions fileFormat, const bool /*bAllowNoCriterionNode --unused*/, ComputationNetwork* anotherNetwork,
+                              bool deferValueLoading /*= false*/)
 {
     ClearNetwork();
 
     File fstream(fileName, fileFormat | FileOptions::fileOptionsRead);
 
-    ReadPersistableParameters<ElemType>(fstream, true);
+    // If the file carries an offset table, skip the learnable parameters' values here. With
+    // deferValueLoading, StartEvaluateMinibatchLoop() materializes just the ones the evaluated
+    // sub-network needs; otherwise all of them are read back in at the end of this function,
+    // several at a time over independent file handles.
+    std::map<std::wstring, std::pair<uint64_t, uint64_t>> nodeValueExtents;
+    bool haveNodeValueExtents = TryReadNodeValueExtents(fstream, nodeValueExtents);
+    m_deferredValueLoading = deferValueLoading && haveNodeValueExtents;
+
+    ReadPersistableParameters<ElemType>(fstream, true, haveNodeValueExtents ? &nodeValueExtents : nullptr, fileName);
 
     size_t numNodes = m_nameToNodeMap.size();
 
@@ -361,6 +484,61 @@ void ComputationNetwork::Read(const wstring& fileName, const FileOptions fileFor
     fstream.GetMarker(FileMarker::fileMarkerEndSection, L"ERootNodes");
 
     fstream.GetMarker(FileMarker::fileMarkerEndSection, L"ECN");
+
+    // regular (non-deferred) load: read the weight matrices we skipped above back in, in parallel
+    if (haveNodeValueExtents && !m_deferredValueLoading)
+        MaterializeAllDeferredValues();
+}
+
+// Read in all pending deferred node values, several nodes at a time. Each call to
+// MaterializeDeferredValue() opens its own file handle and reads only its node's extent, so the
+// workers issue independent reads at independent offsets. On striped storage that runs several
+// stripes concurrently, where a single sequential reader drains one stripe at a time.
+void ComputationNetwork::MaterializeAllDeferredValues()
+{
+    std::vector<ComputationNodeBasePtr> nodes;
+    for (const auto& iter : m_nameToNodeMap)
+        nodes.push_back(iter.second);
+
+    size_t numWorkers = std::min<size_t>(8, nodes.size()); // enough to keep several stripes busy without thrashing a single spindle
+    std::atomic<size_t> nextNode(0);
+    std::exception_ptr firstException;
+    std::mutex exceptionLock;
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < numWorkers; t++)
+    {
+        workers.emplace_back([&]()
+                             {
+                                 try
+                                 {
+                                     for (size_t i = nextNode++; i < nodes.size(); i = nextNode++)
+                                         nodes[i]->MaterializeDeferredValue(); // no-op for nodes without a pending value
+                                 }
+                                 catch (...)
+                                 {
+                                     std::lock_guard<std::mutex> lock(exceptionLock);
+                                     if (!firstException)
+                                         firstException = std::current_exception();
+                                 }
+                             });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    if (firstException)
+        std::rethrow_exception(firstException);
+}
+
+// see the declaration for what this does; here we only open the mapping and remember it, the
+// still-deferred values pick it up when StartEvaluateMinibatchLoop() materializes them
+void ComputationNetwork::EnableSharedWeightMapping(const std::wstring& modelFileName)
+{
+    if (!m_deferredValueLoading) // values were read eagerly (no offset table, or deferValueLoading=false); nothing left to map
+    {
+        fprintf(stderr, "WARNING: EnableSharedWeightMapping: '%ls' was loaded eagerly (older model format without an offset table?); the weights remain private copies.\n",
+                modelFileName.c_str());
+        return;
+    }
+    m_sharedWeightMapping = SharedFileMapping::Open(modelFileName);
 }
 
 // -----------------------------------------------------------------------
@@ -1024,16 +1202,16 @@ void ComputationNetwork::PerformSVDecomposition(const map<wstring, float>& SVDCo
 }
 
 template void ComputationNetwork::InitLearnableParameters<float>(const ComputationNodeBasePtr& node, const bool uniformInit, const unsigned long randomSeed, const float initValueScale, bool initOnCPUOnly);
-template void ComputationNetwork::Read<float>(const wstring& fileName, const FileOptions fileFormat, const bool bAllowNoCriterionNode, ComputationNetwork* anotherNetwork);
-template void ComputationNetwork::ReadPersistableParameters<float>(File& fstream, bool create);
+template void ComputationNetwork::Read<float>(const wstring& fileName, const FileOptions fileFormat, const bool bAllowNoCriterionNode, ComputationNetwork* anotherNetwork, bool deferValueLoading);
+template void ComputationNetwork::ReadPersistableParameters<float>(File& fstream, bool create, const std::map<std::wstring, std::pair<uint64_t, uint64_t>>* nodeValueExtents, const std::wstring& fileName);
 template void ComputationNetwork::PerformSVDecomposition<float>(const map<wstring, float>& SVDConfig, size_t alignedsize);
 template /*static*/ void ComputationNetwork::SetDropoutRate<float>(ComputationNetworkPtr net, const ComputationNodeBasePtr& criterionNode, const double dropoutRate, double& prevDropoutRate, unsigned long& dropOutSeed);
 template void ComputationNetwork::SetSeqParam<float>(ComputationNetworkPtr net, const ComputationNodeBasePtr criterionNode, const double& hsmoothingWeight, const double& frameDropThresh, const bool& doreferencealign,
                                                      const double& amf, const double& lmf, const double& wp, const double& bMMIfactor, const bool& sMBR);
 
 template void ComputationNetwork::InitLearnableParameters<double>(const ComputationNodeBasePtr& node, const bool uniformInit, const unsigned long randomSeed, const double initValueScale, bool initOnCPUOnly);
-template void ComputationNetwork::Read<double>(const wstring& fileName, const FileOptions fileFormat, const bool bAllowNoCriterionNode, ComputationNetwork* anotherNetwork);
-template void ComputationNetwork::ReadPersistableParameters<double>(File& fstream, bool create);
+template void ComputationNetwork::Read<double>(const wstring& fileName, const FileOptions fileFormat, const bool bAllowNoCriterionNode, ComputationNetwork* anotherNetwork, bool deferValueLoading);
+template void ComputationNetwork::ReadPersistableParameters<double>(File& fstream, bool create, const std::map<std::wstring, std::pair<uint64_t, uint64_t>>* nodeValueExtents, const std::wstring& fileName);
 template void ComputationNetwork::PerformSVDecomposition<double>(const map<wstring, float>& SVDConfig, size_t alignedsize);
 template /*static*/ void ComputationNetwork::SetDropoutRate<double>(ComputationNetworkPtr net, const ComputationNodeBasePtr& criterionNode, const double dropoutRate, double& prevDropoutRate, unsigned long& dropOutSeed);
 template void ComputationNetwork::SetSeqParam<double>(ComputationNetworkPtr net, const ComputationNodeBasePtr criterionNode, const double& hsmoothingWeight, const double& frameDropThresh, const bool& doreferencealign,
@@ -20,6 +20,7 @@
 #include <vector>
 #include <algorithm>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <stdlib.h>
 #include <iostream>
@@ -45,6 +46,16 @@ public:
     ComputationNetwork()
         : m_randomSeedOffset(0),
           m_isCompiled(false),
+          m_deferredValueLoading(false),
+          m_parallelForwardPropWorkers(0),
+          m_nodeTimingEnabled(false),
+          m_graphOptimizationsEnabled(false),
+          m_dynamicRangeSampleInterval(0),
+          m_dynamicRangeMinibatchCount(0),
+          m_dynamicRangeSampleThisMB(false),
+          m_autoPlacementProfilingMinibatches(0),
+          m_autoPlacementPhase(0),
+          m_autoPlacementMinibatchCount(0),
           m_pMBLayout(make_shared<MBLayout>())
     {
     }
@@ -78,7 +89,9 @@ public:
     // -----------------------------------------------------------------------
 
     template <class ElemType>
-    void ReadPersistableParameters(File& fstream, bool create);
+    void ReadPersistableParameters(File& fstream, bool create,
+                                   const std::map<std::wstring, std::pair<uint64_t, uint64_t>>* nodeValueExtents = nullptr,
+                                   const std::wstring& fileName = std::wstring());
     // reload node content only, e.g. used by SGD::Train() when going back to an older model that had better training objective
     template <class ElemType>
     void RereadPersistableParameters(const std::wstring& fileName)
@@ -88,14 +101,20 @@ public:
     }
     // design BUGBUG: binary files do not know whether they are float or double.
     // TODO: modify file format to know this; then eliminate the <ElemType> dependency (and in some future, allow nodes to be different)
+    // 'deferValueLoading': if the model file carries a node-value offset table (written by SaveToFileImpl()
+    // for binary files), do not read the learnable parameters' value matrices here; they are materialized
+    // on demand in StartEvaluateMinibatchLoop() for the sub-network that is actually evaluated. Meant for
+    // evaluation-only consumers (EvalDll); training should load eagerly since it touches all parameters.
     template <class ElemType>
     void Read(const std::wstring& fileName, const FileOptions fileFormat = FileOptions::fileOptionsBinary,
-              const bool bAllowNoCriterionNode = false, ComputationNetwork* anotherNetwork = nullptr);
+              const bool bAllowNoCriterionNode = false, ComputationNetwork* anotherNetwork = nullptr,
+              bool deferValueLoading = false);
     template <class ElemType>
     void Load(const std::wstring& fileName, const FileOptions fileFormat = FileOptions::fileOptionsBinary,
-              const bool bAllowNoCriterionNode = false, ComputationNetwork* anotherNetwork = nullptr)
+              const bool bAllowNoCriterionNode = false, ComputationNetwork* anotherNetwork = nullptr,
+              bool deferValueLoading = false)
     {
-        Read<ElemType>(fileName, fileFormat, bAllowNoCriterionNode, anotherNetwork);
+        Read<ElemType>(fileName, fileFormat, bAllowNoCriterionNode, anotherNetwork, deferValueLoading);
         // perform all further post-processing, caching, etc.
         CompileNetwork();
     }
@@ -104,19 +123,58 @@ public:
     template <class ElemType>
     static ComputationNetworkPtr CreateFromFile(DEVICEID_TYPE deviceId, const std::wstring& fileName,
                                                 const FileOptions fileFormat = FileOptions::fileOptionsBinary,
-                                                const bool bAllowNoCriterionNode = false, ComputationNetwork* anotherNetwork = nullptr)
+                                                const bool bAllowNoCriterionNode = false, ComputationNetwork* anotherNetwork = nullptr,
+                                                bool deferValueLoading = false)
     {
+        // opt-in process-wide cache (daemon mode): hand out the already-loaded network instead of
+        // re-reading the model file. Only read-only actions (eval, cv, write) load through this
+        // path, so sharing one instance across successive jobs is safe.
+        std::wstring cacheKey;
+        if (s_modelCacheEnabled)
+        {
+            cacheKey = fileName + L"@" + std::to_wstring((int) deviceId);
+            auto iter = s_modelCache.find(cacheKey);
+            if (iter != s_modelCache.end())
+            {
+                fprintf(stderr, "CreateFromFile: reusing warm model '%ls'\n", fileName.c_str());
+                return iter->second;
+            }
+        }
+
         auto net = make_shared<ComputationNetwork>(deviceId);
-        net->Load<ElemType>(fileName, FileOptions::fileOptionsBinary, bAllowNoCriterionNode, anotherNetwork);
+        net->Load<ElemType>(fileName, FileOptions::fileOptionsBinary, bAllowNoCriterionNode, anotherNetwork, deferValueLoading);
+
+        if (s_modelCacheEnabled)
+            s_modelCache[cacheKey] = net;
         return net;
     }
 
-    void Save(const std::wstring& fileName, const FileOptions fileFormat = FileOptions::fileOptionsBinary) const;
+    // enable/disable the CreateFromFile() model cache; disabling drops all cached models
+    static void EnableModelCache(bool enable)
+    {
+        s_modelCacheEnabled = enable;
+        if (!enable)
+            s_modelCache.clear();
+    }
+
+    // 'nodeOverrides': optional detached copies (same name, made with Duplicate()) to be written in place
+    // of the live nodes, so that a background thread can save a consistent snapshot while training
+    // continues to update the originals
+    void Save(const std::wstring& fileName, const FileOptions fileFormat = FileOptions::fileOptionsBinary,
+              const std::map<std::wstring, ComputationNodeBasePtr>* nodeOverrides = nullptr) const;
     void SaveEdited(const std::wstring& fileName, const FileOptions fileFormat = FileOptions::fileOptionsBinary);
 
 private:
 
-    void SaveToFileImpl(const std::wstring& fileName, const FileOptions fileFormat) const;
+    void SaveToFileImpl(const std::wstring& fileName, const FileOptions fileFormat,
+                        const std::map<std::wstring, ComputationNodeBasePtr>* nodeOverrides) const;
+
+    // try to locate and read the node-value offset table that SaveToFileImpl() appends to binary model
+    // files; returns false (leaving the read position untouched) for older files that do not carry one
+    static bool TryReadNodeValueExtents(File& fstream, std::map<std::wstring, std::pair<uint64_t, uint64_t>>& nodeValueExtents);
+
+    // read in all pending deferred node values, several nodes at a time over independent file handles
+    void MaterializeAllDeferredValues();
 
 public:
 
@@ -127,9 +185,89 @@ public:
     // main entry point for forward prop
     void ForwardProp(const ComputationNodeBasePtr rootNode);
 
+    // Evaluate independent subgraphs concurrently during ForwardProp(), using up to 'numWorkers'
+    // threads (0 disables). Effective on CPU only: on GPU devices evaluation stays sequential, since
+    // all matrix operations share a single compute stream. Must not be combined with node-value
+    // sharing (g_shareNodeValueMatrices), which assumes strictly sequential execution.
+    void EnableParallelForwardProp(size_t numWorkers)
+    {
+        m_parallelForwardPropWorkers = numWorkers;
+    }
+
+    // Back the learnable parameters' values with a read-only shared mapping of the model file, so
+    // that every scoring process on the box that maps the same model shares one set of physical
+    // pages for the weights. Requires a model loaded with deferValueLoading (i.e. one that carries
+    // a node-value offset table): the pending values are materialized as views into the mapping
+    // once StartEvaluateMinibatchLoop() runs. CPU evaluation only; mapped parameters must never
+    // be updated.
+    void EnableSharedWeightMapping(const std::wstring& modelFileName);
+
+    // Collect per-node execution times during ForwardProp()/Backprop(). Cheap enough to leave on
+    // during training: wall-clock timestamps plus, on GPU, CUDA events (no sync is forced).
+    void EnableNodeTiming(bool enable)
+    {
+        m_nodeTimingEnabled = enable;
+        EnableMatrixOpAccounting(enable); // the timing hooks also snapshot the Math layer's FLOP/byte counters
+    }
+
+    // Graph optimizations run during CompileNetwork(): merging of structurally identical
+    // subtrees (common-subexpression elimination) and fusion of elementwise operation chains
+    // (FuseElementwiseChains()). Off by default and opted into with graphOptimizations=true by
+    // the read-only actions (eval, cv, write) and EvalDll: a rewritten graph that gets re-saved
+    // would persist its FusedMultiplyAdd nodes, which older builds cannot load, so the passes
+    // stay away from anything that writes models. Names of merged-away nodes remain resolvable
+    // through GetNodeFromName() (they alias the surviving node that computes the same value).
+    void EnableGraphOptimizations(bool enable)
+    {
+        m_graphOptimizationsEnabled = enable;
+        if (enable && IsCompiled()) // the passes run during compilation; redo it on an already-loaded model
+        {
+            InvalidateCompiledNetwork();
+            CompileNetwork();
+        }
+    }
+
+    // print the times collected since the last call as a hot-node report (sorted by total time,
+    // with a per-operation rollup including model-based FLOP/byte counts and achieved rates for
+    // roofline analysis), then reset the counters
+    void ReportNodeTiming();
+
+    // Collect log2-bucketed histograms of each node's value and gradient magnitudes, accumulated
+    // on-device by one small kernel on every sampleEveryNMinibatches-th minibatch. This is the
+    // dynamic-range data needed to pick quantization/reduced-precision ranges per node without
+    // dumping whole matrices to the host. 0 disables (the default).
+    void EnableDynamicRangeTracking(size_t sampleEveryNMinibatches)
+    {
+        m_dynamicRangeSampleInterval = sampleEveryNMinibatches;
+        m_dynamicRangeMinibatchCount = 0;
+    }
+
+    // print the per-node dynamic-range report from the histograms collected since the last call
+    // (zero fraction and the magnitude range covering ~100% resp. 99.99% of the non-zero mass),
+    // then reset the histograms
+    void ReportDynamicRange();
+
+    // Profile-guided CPU/GPU placement of individual nodes: run the first numProfilingMinibatches
+    // minibatches as compiled, then move small non-loop nodes to the CPU for the same number of
+    // minibatches, keep each move that measured faster (including its transfer cost, which lands
+    // in the timings of the node and its consumers), and revert the rest. 0 disables (default).
+    // The caller must invoke UpdateAutoDevicePlacement() once after every trained minibatch.
+    void EnableAutoDevicePlacement(size_t numProfilingMinibatches)
+    {
+        m_autoPlacementProfilingMinibatches = numProfilingMinibatches;
+        m_autoPlacementPhase = 0;
+        m_autoPlacementMinibatchCount = 0;
+    }
+    void UpdateAutoDevicePlacement();
+
     // main entry point for backprop
     void Backprop(const ComputationNodeBasePtr rootNode);
 
+    // version that invokes a callback for every node whose gradient has become final, in backprop
+    // order; used to overlap per-layer gradient processing (e.g. data-parallel aggregation of the
+    // learnable parameters' gradients) with the remainder of the backward pass
+    void Backprop(const ComputationNodeBasePtr rootNode, const std::function<void(const ComputationNodeBasePtr&)>& nodeGradientReadyCallback);
+
     template <class NODESET> // version that takes multiple nodes
     void ForwardProp(const NODESET& nodes)
     {
@@ -144,6 +282,9 @@ public:
     void StartEvaluateMinibatchLoop(const ComputationNodeBasePtr& rootNode) // (ugly name; meant to be unique so we can rename if needed)
     {
         VerifyIsCompiled("StartEvaluateMinibatchLoop");
+        if (m_deferredValueLoading) // weights were skipped in Read(); only the ones this sub-network uses are ever read in
+            for (auto& node : GetEvalOrder(rootNode))
+                node->MaterializeDeferredValue(m_sharedWeightMapping); // (a null mapping reads private copies)
         ResetEvalTimeStamps(); // invalidate all m_value fields  --TODO: redundant (called over again for every root node). Make this private and only call for sets of nodes.
     }
     template <class NODESET>
@@ -175,6 +316,10 @@ private:
 
 private:
     void DetermineSetOfAllRoots();
+    size_t EliminateCommonSubexpressions();   // see EnableGraphOptimizations(); returns the number of nodes merged away
+    size_t FuseElementwiseChains();           // see EnableGraphOptimizations(); returns the number of node pairs fused
+    size_t FuseTimesBiasActivationChains();   // see EnableGraphOptimizations(); returns the number of layer chains fused (CPU only)
+    size_t FuseSumActivationChains();         // see EnableGraphOptimizations(); returns the number of Plus/activation pairs fused
     void CollectInputAndLearnableParameters(const ComputationNodeBasePtr& rootNode);
     bool IsCompiled() const
     {
@@ -185,6 +330,14 @@ private:
 public:
     void AllocateAllMatrices(const std::vector<ComputationNodeBasePtr>& evalRootNodes, const std::vector<ComputationNodeBasePtr>& outValueRootNodes, ComputationNodeBasePtr trainRootNode);
 
+    void PlanPipelinePartition(const size_t numStages); // report how the model would split into pipeline stages (report only; see the implementation)
+
+    // print which nodes the pooled device memory went to, plus the actual free memory (see MatrixPool)
+    void PrintAllocationReport()
+    {
+        m_matrixPool.PrintAllocationReport();
+    }
+
 private:
     void ReleaseMatricesAfterEvalForChildren(ComputationNodeBasePtr n, std::unordered_map<ComputationNodeBasePtr, int>& parentCount);
     void AllocateGradientMatricesForInputs(ComputationNodeBasePtr parentNode);
@@ -332,6 +485,8 @@ public:
     void CopyInputs(const std::wstring fromName, std::wstring toName);
     void RenameNode(const std::wstring& nodeNameOrig, const std::wstring& nodeNameNew);
     void RenameNode(ComputationNodeBasePtr node, const std::wstring& newNodeName);
+    template <class ElemType>
+    void ShareLearnableParametersFrom(const ComputationNetworkPtr& fromNet); // reference fromNet's weight matrices instead of own copies (read-only use only)
     void DeleteNode(const std::wstring& nodeName);
     void ChangeNode(wstring nodeName, ComputationNodeBasePtr newNode);
     void ReplaceLeafNode(wstring oldNodeName, ComputationNodeBasePtr newNode);
@@ -360,6 +515,12 @@ public:
             return iter->second;
         }
 
+        // names merged away by the graph-optimization passes resolve to the surviving node
+        // that computes the same value
+        auto alias = m_mergedNodeAliases.find(name);
+        if (alias != m_mergedNodeAliases.end())
+            return alias->second;
+
         if (anotherNetwork != nullptr)
             return anotherNetwork->GetNodeFromName(name);
 
@@ -787,6 +948,12 @@ protected:
         virtual void RequestMatricesBeforeBackprop(MatrixPool& matrixPool);
         virtual void ReleaseMatricesAfterBackprop(MatrixPool& matrixPool);
         virtual bool IsOutputOlderThanInputs() const override;
+        // the loop executes as one unit, so range sampling fans out to the member nodes afterwards
+        virtual void SampleDynamicRange(bool forward) override
+        {
+            for (auto& node : m_nestedNodes)
+                node->SampleDynamicRange(forward);
+        }
 
     public:
         // std::vector<ComputationNodeBasePtr> m_nestedNodes;               // all nodes involved in this loop, in evaluation order
@@ -800,6 +967,11 @@ protected:
         {
             SetNodeName(L"Loop_" + m_sourceNode->NodeName());
         }
+
+    private:
+        const std::vector<FrameRange>& FrameRangePlan(size_t numTimeSteps);
+        std::vector<FrameRange> m_frameRangePlan; // [t] cached FrameRange for time step t; see FrameRangePlan()
+        MBLayoutPtr m_framePlanLayout;            // the layout object the plan was built against
     };
 
     // -----------------------------------------------------------------------
@@ -847,6 +1019,44 @@ protected:
         virtual void RequestMatricesBeforeBackprop(MatrixPool& matrixPool);
         virtual void ReleaseMatricesAfterBackprop(MatrixPool& matrixPool);
 
+        // optional callback invoked during Backprop() after each nested node has been processed,
+        // i.e. once the gradients of that node (and, for a SEQ loop, of all nodes inside the loop)
+        // have received their final contribution
+        void SetNodeGradientReadyCallback(const std::function<void(const ComputationNodeBasePtr&)>& callback)
+        {
+            m_nodeGradientReadyCallback = callback;
+        }
+
+        // number of worker threads for ForwardProp(); 0 or 1 = traverse sequentially (the default)
+        // When >1, independent nested nodes execute concurrently on worker threads, with SEQ loops
+        // kept as serialized islands. See ForwardPropParallel() for the constraints.
+        void SetParallelForwardPropWorkers(size_t numWorkers)
+        {
+            m_parallelForwardPropWorkers = numWorkers;
+        }
+
+        // bracket each nested node's execution with BeginTiming()/EndTiming()
+        // SEQ loops are timed as one unit (their flow-control node carries the counters).
+        void SetNodeTimingEnabled(bool enable)
+        {
+            m_timeNodes = enable;
+        }
+
+        // sample each nested node's value/gradient magnitudes into its histogram after executing it
+        // (set per minibatch; see ComputationNetwork::EnableDynamicRangeTracking())
+        void SetDynamicRangeSamplingEnabled(bool enable)
+        {
+            m_sampleDynamicRange = enable;
+        }
+
+    private:
+        void ForwardPropParallel(const FrameRange& fr);
+
+        std::function<void(const ComputationNodeBasePtr&)> m_nodeGradientReadyCallback;
+        size_t m_parallelForwardPropWorkers = 0;
+        bool m_timeNodes = false;
+        bool m_sampleDynamicRange = false;
+
     public:
         // this special constructor constructs the top-level network node
         // There is currently no other constructor for inner nested PAR-traversed sub-networks, but there will be.
@@ -875,6 +1085,11 @@ protected:
     // main node holder
     std::map<const std::wstring, ComputationNodeBasePtr, nocase_compare> m_nameToNodeMap; // [name] -> node; this is the main container that holds this networks' nodes
 
+    // names merged away by the graph-optimization passes, mapped to the surviving node that
+    // computes the same value; GetNodeFromName() falls back to this so by-name accesses
+    // (MEL edits, DumpNodeInfo) keep working on an optimized graph
+    std::map<const std::wstring, ComputationNodeBasePtr, nocase_compare> m_mergedNodeAliases;
+
     // node groups
     // These are specified by the user by means of tags or explicitly listing the node groups.
     std::vector<ComputationNodeBasePtr> m_features;
@@ -907,6 +1122,25 @@ private:
     // cache for evaluation ordering:
     bool m_isCompiled; // CompileNetwork has been called
 
+    bool m_deferredValueLoading; // Read() skipped the learnable parameters' values; StartEvaluateMinibatchLoop() materializes them on demand
+    std::shared_ptr<SharedFileMapping> m_sharedWeightMapping; // see EnableSharedWeightMapping()
+
+    size_t m_parallelForwardPropWorkers; // see EnableParallelForwardProp()
+    bool m_nodeTimingEnabled;            // see EnableNodeTiming()
+    bool m_graphOptimizationsEnabled;    // see EnableGraphOptimizations()
+
+    // dynamic-range histogram sampling, see EnableDynamicRangeTracking()
+    size_t m_dynamicRangeSampleInterval;  // sample every Nth minibatch (0 = disabled)
+    size_t m_dynamicRangeMinibatchCount;  // minibatches seen since tracking was enabled
+    bool m_dynamicRangeSampleThisMB;      // decision taken at ForwardProp() entry; Backprop() reuses it
+
+    // profile-guided device placement, see EnableAutoDevicePlacement()
+    size_t m_autoPlacementProfilingMinibatches;                     // minibatches per profiling phase (0 = disabled)
+    size_t m_autoPlacementPhase;                                    // 0 = baseline, 1 = CPU trial, 2 = done
+    size_t m_autoPlacementMinibatchCount;                           // minibatches seen in the current phase
+    std::vector<ComputationNodeBasePtr> m_autoPlacementCandidates;  // nodes moved to CPU for the trial phase
+    std::map<ComputationNodeBasePtr, double> m_autoPlacementBaselineCost; // [candidate] per-minibatch seconds in the baseline phase
+
     // cached network iterations
     std::map<const ComputationNodeBasePtr, std::list<ComputationNodeBasePtr>> m_evalOrders; // [out node] flat depth-first traversal starting from out node
     std::map<const ComputationNodeBasePtr, ComputationNodeBasePtr> m_nestedNetworks;        // [out node] network rewritten as recursive traveral, potentially optimized; execution plan
@@ -919,6 +1153,10 @@ private:
     // pool for matrices that can be shared across nodes
     // TODO: does this apply to anything else besides temporary node-internal intermediate results? What, for example?
     MatrixPool m_matrixPool;
+
+    // process-wide model cache for CreateFromFile(), see EnableModelCache()
+    static bool s_modelCacheEnabled;
+    static std::map<std::wstring, ComputationNetworkPtr> s_modelCache; // [model path + device] -> loaded network
 };
 typedef ComputationNetwork::ComputationNetworkPtr ComputationNetworkPtr;
 
@@ -100,6 +100,29 @@ void ComputationNetwork::CopyInputs(const std::wstring fromName, std::wstring to
     CopyNode(*this, fromName, toName, CopyNodeFlags::copyNodeChildren);
 }
 
+// ShareLearnableParametersFrom - make every LearnableParameter in this network reference the
+// same-named node's value matrix in 'fromNet' instead of its own copy
+// Both networks must have been created from the same model. Used by EvalDll's network pool,
+// where several instances of one network evaluate concurrently on different threads: the
+// weights are read-only during forward propagation, so N instances can share one copy.
+template <class ElemType>
+void ComputationNetwork::ShareLearnableParametersFrom(const ComputationNetworkPtr& fromNet)
+{
+    for (auto& iter : m_nameToNodeMap)
+    {
+        auto node = dynamic_pointer_cast<LearnableParameter<ElemType>>(iter.second);
+        if (!node)
+            continue;
+        auto fromNode = dynamic_pointer_cast<LearnableParameter<ElemType>>(fromNet->GetNodeFromName(iter.first)); // throws if missing
+        if (!fromNode)
+            LogicError("ShareLearnableParametersFrom: node %ls is not a LearnableParameter in the source network.", iter.first.c_str());
+        node->ShareValueFrom(*fromNode); // verifies matching dimensions
+    }
+}
+
+template void ComputationNetwork::ShareLearnableParametersFrom<float>(const ComputationNetworkPtr& fromNet);
+template void ComputationNetwork::ShareLearnableParametersFrom<double>(const ComputationNetworkPtr& fromNet);
+
 // RenameNode - Rename a node to another name
 // nodeNameOrig - original node name
 // nodeNameNew - new node name
@@ -10,12 +10,18 @@
 #include "ComputationNetwork.h"
 #include "RecurrentNodes.h"
 #include "InputAndParamNodes.h"
+#include "LinearAlgebraNodes.h"
+#include "NonlinearityNodes.h"
+#include "ProgressTracing.h"
 #include <string>
 #include <vector>
 #include <list>
 #include <set>
 #include <algorithm>
 #include <map>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace std;
 
@@ -39,8 +45,25 @@ void ComputationNetwork::ForwardProp(const ComputationNodeBasePtr rootNode)
 {
     VerifyIsCompiled("ForwardProp");
 
+    auto nestedNetwork = GetNestedNetwork(rootNode);
+
+    // optionally evaluate independent subgraphs concurrently (CPU only; on GPU all matrix
+    // operations are issued to a single compute stream, so there is nothing to overlap)
+    auto parTraversalNetwork = dynamic_pointer_cast<PARTraversalFlowControlNode>(nestedNetwork);
+    // decide whether this forward pass gets its dynamic-range histograms sampled; the matching
+    // backward pass (if any) reuses the decision so value and gradient statistics stay paired
+    if (m_dynamicRangeSampleInterval > 0)
+        m_dynamicRangeSampleThisMB = (m_dynamicRangeMinibatchCount++ % m_dynamicRangeSampleInterval == 0);
+
+    if (parTraversalNetwork)
+    {
+        parTraversalNetwork->SetParallelForwardPropWorkers((m_deviceId == CPUDEVICE) ? m_parallelForwardPropWorkers : 0);
+        parTraversalNetwork->SetNodeTimingEnabled(m_nodeTimingEnabled);
+        parTraversalNetwork->SetDynamicRangeSamplingEnabled(m_dynamicRangeSampleInterval > 0 && m_dynamicRangeSampleThisMB);
+    }
+
     // traverse all nodes in the pre-determined evaluation order
-    GetNestedNetwork(rootNode)->ForwardProp(FrameRange(nullptr));
+    nestedNetwork->ForwardProp(FrameRange(nullptr));
 }
 
 // set the gradient matrix of a node to an 1x1 matrix containing 1.0
@@ -65,6 +88,13 @@ static bool SetGradientToScalarOne(ComputationNodeBasePtr nodep)
 //  - ForwardProp() for the training criterion (which will reuse computation results from the previous step)
 //  - Backprop() for the training criterion
 void ComputationNetwork::Backprop(const ComputationNodeBasePtr rootNode) // training criterion to compute the gradients for
+{
+    Backprop(rootNode, nullptr);
+}
+
+// version that reports back every node whose gradient has become final, so that e.g. data-parallel
+// gradient aggregation can already start while the remainder of the backward pass is still running
+void ComputationNetwork::Backprop(const ComputationNodeBasePtr rootNode, const std::function<void(const ComputationNodeBasePtr&)>& nodeGradientReadyCallback)
 {
     // reset all gradients to zero (actually, internally, this is lazy, but we don't care here)
     ZeroGradients(rootNode);
@@ -74,7 +104,382 @@ void ComputationNetwork::Backprop(const ComputationNodeBasePtr rootNode) // trai
         LogicError("Backprop: Training criterion is neither ComputationNode<float> nor ComputationNode<double>.");
 
     // backpropagate through the network
-    GetNestedNetwork(rootNode)->Backprop(FrameRange(nullptr), true, true);
+    auto nestedNetwork = GetNestedNetwork(rootNode);
+    auto parTraversalNetwork = dynamic_pointer_cast<PARTraversalFlowControlNode>(nestedNetwork);
+    if (parTraversalNetwork)
+    {
+        parTraversalNetwork->SetNodeGradientReadyCallback(nodeGradientReadyCallback);
+        parTraversalNetwork->SetNodeTimingEnabled(m_nodeTimingEnabled);
+        parTraversalNetwork->SetDynamicRangeSamplingEnabled(m_dynamicRangeSampleInterval > 0 && m_dynamicRangeSampleThisMB);
+    }
+    nestedNetwork->Backprop(FrameRange(nullptr), true, true);
+    if (parTraversalNetwork)
+        parTraversalNetwork->SetNodeGradientReadyCallback(nullptr);
+}
+
+// dump the per-node timing accumulated since the last call (see EnableNodeTiming()), then reset it
+// Nodes are sorted by total wall-clock time; device time is measured with CUDA events and hence
+// covers the actual kernel execution even though our GPU launches are asynchronous. Nodes inside
+// a recurrent loop are timed as one unit under the loop's "Loop_*" node.
+void ComputationNetwork::ReportNodeTiming()
+{
+    // gather all nodes that have been timed: regular nodes plus the SEQ loop nodes
+    std::vector<ComputationNodeBasePtr> timedNodes;
+    for (const auto& iter : m_nameToNodeMap)
+        if (iter.second->GetTiming(true).count > 0 || iter.second->GetTiming(false).count > 0)
+            timedNodes.push_back(iter.second);
+    for (const auto& seqNode : m_allSEQNodes)
+        if (seqNode->GetTiming(true).count > 0 || seqNode->GetTiming(false).count > 0)
+            timedNodes.push_back(seqNode);
+
+    if (timedNodes.empty()) // timing not enabled, or nothing ran
+        return;
+
+    auto totalSeconds = [](const ComputationNodeBasePtr& node)
+    {
+        return node->GetTiming(true).wallSeconds + node->GetTiming(false).wallSeconds;
+    };
+    std::sort(timedNodes.begin(), timedNodes.end(), [&](const ComputationNodeBasePtr& a, const ComputationNodeBasePtr& b)
+              {
+                  return totalSeconds(a) > totalSeconds(b);
+              });
+
+    fprintf(stderr, "\nNode timing (sorted by total wall-clock time; device time from CUDA events; GFLOP/GB are model estimates from operand shapes):\n");
+    fprintf(stderr, "%-40s %-20s %10s %12s %12s %12s %12s %10s %10s\n", "node", "operation", "count", "fwd wall(s)", "bwd wall(s)", "fwd dev(s)", "bwd dev(s)", "GFLOP", "GB");
+    struct OpRollup
+    {
+        size_t count = 0;
+        double seconds = 0;     // total wall-clock seconds
+        double busySeconds = 0; // max(wall, device) per node; the honest denominator for achieved rates
+        double flops = 0;
+        double bytes = 0;
+    };
+    std::map<std::wstring, OpRollup> perOperation;
+    for (const auto& node : timedNodes)
+    {
+        auto& fwd = node->GetTiming(true);
+        auto& bwd = node->GetTiming(false);
+        double flops = fwd.flops + bwd.flops;
+        double bytes = fwd.mathBytes + bwd.mathBytes;
+        fprintf(stderr, "%-40ls %-20ls %10d %12.3f %12.3f %12.3f %12.3f %10.2f %10.2f\n",
+                node->NodeName().c_str(), node->OperationName().c_str(), (int) fwd.count,
+                fwd.wallSeconds, bwd.wallSeconds, fwd.deviceTimer.TotalSeconds(), bwd.deviceTimer.TotalSeconds(),
+                flops / 1e9, bytes / 1e9);
+        auto& opEntry = perOperation[node->OperationName()];
+        opEntry.count += fwd.count;
+        opEntry.seconds += totalSeconds(node);
+        opEntry.busySeconds += std::max(totalSeconds(node), fwd.deviceTimer.TotalSeconds() + bwd.deviceTimer.TotalSeconds());
+        opEntry.flops += flops;
+        opEntry.bytes += bytes;
+    }
+
+    // roofline rollup: achieved rates and arithmetic intensity per operation class, to be read
+    // against the device's peak GFLOP/s and GB/s (which we do not know here)
+    fprintf(stderr, "\nPer-operation rollup (rates over max(wall, device) time):\n");
+    fprintf(stderr, "%-40s %10s %12s %10s %10s %10s %10s %10s\n", "operation", "count", "wall(s)", "GFLOP", "GB", "GFLOP/s", "GB/s", "FLOP/B");
+    OpRollup total;
+    for (const auto& opEntry : perOperation)
+    {
+        const OpRollup& r = opEntry.second;
+        fprintf(stderr, "%-40ls %10d %12.3f %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+                opEntry.first.c_str(), (int) r.count, r.seconds, r.flops / 1e9, r.bytes / 1e9,
+                r.busySeconds > 0 ? r.flops / 1e9 / r.busySeconds : 0.0,
+                r.busySeconds > 0 ? r.bytes / 1e9 / r.busySeconds : 0.0,
+                r.bytes > 0 ? r.flops / r.bytes : 0.0);
+        total.seconds += r.seconds;
+        total.busySeconds += r.busySeconds;
+        total.flops += r.flops;
+        total.bytes += r.bytes;
+    }
+    if (total.busySeconds > 0)
+        fprintf(stderr, "Roofline summary: %.2f GFLOP and %.2f GB in %.3f busy seconds -> %.2f GFLOP/s, %.2f GB/s, intensity %.2f FLOP/B\n",
+                total.flops / 1e9, total.bytes / 1e9, total.busySeconds,
+                total.flops / 1e9 / total.busySeconds, total.bytes / 1e9 / total.busySeconds,
+                total.bytes > 0 ? total.flops / total.bytes : 0.0);
+    fprintf(stderr, "\n");
+
+    // start the next reporting interval from zero
+    for (const auto& node : timedNodes)
+        node->ResetTiming();
+}
+
+// format one magnitude histogram as a report cell: zero fraction, the full magnitude range of the
+// non-zero samples, and the tighter range left after trimming 0.005% of the mass off each tail
+// (robust against stray outliers). Ranges are printed as power-of-two intervals.
+static std::string DescribeDynamicRangeHistogram(const std::vector<double>& counts)
+{
+    double numZero = counts[0]; // exact zeros and magnitudes below the lowest bucket
+    double numNonZero = 0;
+    int minBucket = -1, maxBucket = -1;
+    for (int b = 1; b < (int) counts.size(); b++)
+        if (counts[b] > 0)
+        {
+            numNonZero += counts[b];
+            if (minBucket < 0)
+                minBucket = b;
+            maxBucket = b;
+        }
+    if (numZero + numNonZero == 0)
+        return "(empty)";
+    if (numNonZero == 0)
+        return "100.00% zero";
+
+    double tailMass = 5e-5 * numNonZero;
+    int lo = minBucket, hi = maxBucket;
+    for (double trimmed = 0; lo < hi && trimmed + counts[lo] <= tailMass; lo++)
+        trimmed += counts[lo];
+    for (double trimmed = 0; hi > lo && trimmed + counts[hi] <= tailMass; hi--)
+        trimmed += counts[hi];
+
+    // lower edge of bucket b is 2^(minExponent + b - 1); the printed upper bound is exclusive
+    auto lowerExponent = [](int b) { return ComputationNodeBase::c_dynamicRangeMinExponent + b - 1; };
+    return msra::strfun::strprintf("%6.2f%% zero, 2^%d..2^%d (99.99%%: 2^%d..2^%d)",
+                                   100.0 * numZero / (numZero + numNonZero),
+                                   lowerExponent(minBucket), lowerExponent(maxBucket) + 1,
+                                   lowerExponent(lo), lowerExponent(hi) + 1);
+}
+
+// dump the dynamic-range report from the histograms collected since the last call (see
+// EnableDynamicRangeTracking()), then reset them. The 99.99% ranges are what a per-node
+// quantization or reduced-precision decision should be read off: e.g. a node whose ranges sit
+// inside 2^-14..2^16 fits fp16 normals without any scaling.
+void ComputationNetwork::ReportDynamicRange()
+{
+    bool printedHeader = false;
+    for (const auto& node : GetEvalOrder(nullptr)) // report in evaluation order, inputs first
+    {
+        std::vector<double> valueCounts, gradientCounts;
+        bool hasValue = node->GetDynamicRangeHistogram(true /*forward*/, valueCounts);
+        bool hasGradient = node->GetDynamicRangeHistogram(false /*forward*/, gradientCounts);
+        if (!hasValue && !hasGradient)
+            continue;
+        if (!printedHeader)
+        {
+            fprintf(stderr, "\nDynamic range of node values and gradients (magnitude intervals; fp16 normals cover 2^-14..2^16, subnormals reach down to 2^-24):\n");
+            fprintf(stderr, "%-40s %-20s %-52s %-52s\n", "node", "operation", "value", "gradient");
+            printedHeader = true;
+        }
+        fprintf(stderr, "%-40ls %-20ls %-52s %-52s\n",
+                node->NodeName().c_str(), node->OperationName().c_str(),
+                hasValue ? DescribeDynamicRangeHistogram(valueCounts).c_str() : "(not sampled)",
+                hasGradient ? DescribeDynamicRangeHistogram(gradientCounts).c_str() : "(not sampled)");
+        node->ResetDynamicRange(); // start the next reporting interval from zero
+    }
+    if (printedHeader)
+        fprintf(stderr, "\n");
+}
+
+// helper for UpdateAutoDevicePlacement(): move a node's computation to the given device
+template <class ElemType>
+static bool PinNodeToDevice(const ComputationNodeBasePtr& nodep, DEVICEID_TYPE deviceId)
+{
+    auto node = dynamic_pointer_cast<ComputationNode<ElemType>>(nodep);
+    if (!node)
+        return false;
+    node->PinToDevice(deviceId);
+    return true;
+}
+
+// profile-guided CPU/GPU placement, see EnableAutoDevicePlacement()
+// To be called once after every trained minibatch. Phase 0 measures the network as compiled;
+// at the phase boundary, small nodes outside recurrent loops are moved to the CPU; phase 1
+// measures again with the moves in place; then every move whose measured cost (the node plus its
+// immediate consumers, which is where cross-device transfer time shows up) did not improve is
+// reverted. Candidates are scored jointly, so a move can be kept or reverted on account of a
+// neighboring one--acceptable for the cheap front-end nodes this is aimed at.
+void ComputationNetwork::UpdateAutoDevicePlacement()
+{
+    if (m_autoPlacementProfilingMinibatches == 0 || m_autoPlacementPhase > 1)
+        return; // disabled, or placement already decided
+    if (m_deviceId == CPUDEVICE)
+    {
+        m_autoPlacementPhase = 2; // pure CPU network: nothing to place
+        return;
+    }
+
+    m_autoPlacementMinibatchCount++;
+    if (m_autoPlacementMinibatchCount < m_autoPlacementProfilingMinibatches)
+        return;
+    m_autoPlacementMinibatchCount = 0;
+
+    // per-candidate cost: own time plus that of its immediate consumers, per minibatch
+    auto measureCost = [&](const ComputationNodeBasePtr& candidate) -> double
+    {
+        double seconds = candidate->GetTiming(true).wallSeconds + candidate->GetTiming(false).wallSeconds;
+        for (const auto& iter : m_nameToNodeMap)
+            for (size_t i = 0; i < iter.second->GetNumInputs(); i++)
+                if (iter.second->GetInputs()[i] == candidate)
+                    seconds += iter.second->GetTiming(true).wallSeconds + iter.second->GetTiming(false).wallSeconds;
+        return seconds / m_autoPlacementProfilingMinibatches;
+    };
+
+    if (m_autoPlacementPhase == 0) // baseline phase over: select candidates and move them to CPU
+    {
+        const size_t maxRows = 1024; // only nodes with small per-sample output are worth considering
+        for (const auto& node : GetEvalOrder(nullptr))
+        {
+            if (node->IsLeaf() || node->IsPartOfLoop()) // inputs/parameters stay put; loop bodies run many times per minibatch
+                continue;
+            if (node->GetSampleMatrixNumRows() > maxRows)
+                continue;
+            if (node->GetTiming(true).count == 0) // never ran (or timing not enabled)
+                continue;
+            m_autoPlacementCandidates.push_back(node);
+        }
+        if (m_autoPlacementCandidates.empty())
+        {
+            m_autoPlacementPhase = 2;
+            return;
+        }
+        for (const auto& candidate : m_autoPlacementCandidates)
+            m_autoPlacementBaselineCost[candidate] = measureCost(candidate);
+        for (const auto& candidate : m_autoPlacementCandidates)
+            if (!PinNodeToDevice<float>(candidate, CPUDEVICE) && !PinNodeToDevice<double>(candidate, CPUDEVICE))
+                LogicError("UpdateAutoDevicePlacement: node %ls is neither ComputationNode<float> nor ComputationNode<double>.", candidate->NodeName().c_str());
+        for (const auto& iter : m_nameToNodeMap)
+            iter.second->ResetTiming();
+        m_autoPlacementPhase = 1;
+    }
+    else // trial phase over: keep the moves that won, revert the rest
+    {
+        size_t numKept = 0;
+        for (const auto& candidate : m_autoPlacementCandidates)
+        {
+            double baselineCost = m_autoPlacementBaselineCost[candidate];
+            double trialCost = measureCost(candidate);
+            if (trialCost <= baselineCost)
+            {
+                numKept++;
+                fprintf(stderr, "UpdateAutoDevicePlacement: pinning %ls %ls operation to the CPU (%.3f ms/minibatch vs. %.3f on GPU)\n",
+                        candidate->NodeName().c_str(), candidate->OperationName().c_str(), trialCost * 1000.0, baselineCost * 1000.0);
+            }
+            else if (!PinNodeToDevice<float>(candidate, m_deviceId) && !PinNodeToDevice<double>(candidate, m_deviceId))
+                LogicError("UpdateAutoDevicePlacement: node %ls is neither ComputationNode<float> nor ComputationNode<double>.", candidate->NodeName().c_str());
+        }
+        fprintf(stderr, "UpdateAutoDevicePlacement: %d of %d candidate nodes pinned to the CPU\n",
+                (int) numKept, (int) m_autoPlacementCandidates.size());
+        for (const auto& iter : m_nameToNodeMap)
+            iter.second->ResetTiming();
+        m_autoPlacementCandidates.clear();
+        m_autoPlacementBaselineCost.clear();
+        m_autoPlacementPhase = 2;
+    }
+}
+
+// PlanPipelinePartition() -- report how the model would best be split into pipeline stages
+// For models that exceed one device's memory, the plan is to place contiguous ranges of the
+// evaluation order onto different devices and pipeline micro-batches through the stages, with
+// staged transfers (GPUDataTransferer) at the boundaries. Actually running a stage per GPU is
+// currently blocked by EnforceOneGPUOnly() (one GPU per process until the late-locking bug is
+// fixed), so for now this method only computes and reports the partition, as a sizing aid:
+// stages are balanced by resident elements (full size for parameters and other static nodes,
+// per-sample size for minibatch-carrying ones), and each cut is placed at the narrowest
+// activation boundary near the balance point, since the cut width is what a pipeline would
+// transfer per sample between devices. Boundaries inside recurrent loops are not considered
+// (a loop body must stay on one device; its nodes are consecutive in the evaluation order).
+void ComputationNetwork::PlanPipelinePartition(const size_t numStages)
+{
+    VerifyIsCompiled("PlanPipelinePartition");
+    if (numStages < 2)
+        InvalidArgument("PlanPipelinePartition: the number of stages must be at least 2.");
+
+    const auto& evalOrder = GetEvalOrder(nullptr);
+    std::vector<ComputationNodeBasePtr> order(evalOrder.begin(), evalOrder.end());
+    if (order.size() < numStages)
+        InvalidArgument("PlanPipelinePartition: the network has fewer nodes (%d) than requested stages (%d).", (int) order.size(), (int) numStages);
+
+    // per-node resident elements, and each node's position in the evaluation order
+    std::vector<double> cost(order.size());
+    std::map<ComputationNodeBasePtr, size_t> position;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        cost[i] = (double) order[i]->GetSampleLayout().GetNumElements();
+        position[order[i]] = i;
+    }
+
+    // the last position at which each node's value is still consumed
+    std::vector<size_t> lastUse(order.size());
+    for (size_t i = 0; i < order.size(); i++)
+        lastUse[i] = i;
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        auto consumer = position.find(iter.second);
+        if (consumer == position.end()) // not reachable from any root
+            continue;
+        for (size_t i = 0; i < iter.second->GetNumInputs(); i++)
+        {
+            auto producer = position.find(iter.second->Input(i));
+            if (producer != position.end())
+                lastUse[producer->second] = max(lastUse[producer->second], consumer->second);
+        }
+    }
+
+    // width of each potential cut b (between positions b-1 and b): per-sample elements of all
+    // values produced before the boundary and still consumed at or after it
+    // (built as a difference array over the boundary range each value is live across)
+    std::vector<double> cutWidth(order.size() + 1, 0);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        if (!order[i]->HasMBLayout()) // parameters are not transferred per minibatch
+            continue;
+        cutWidth[i + 1] += cost[i];
+        cutWidth[lastUse[i] + 1] -= cost[i];
+    }
+    for (size_t b = 1; b < cutWidth.size(); b++)
+        cutWidth[b] += cutWidth[b - 1];
+
+    // choose the cuts: for each stage boundary, search near the balance point for the narrowest cut
+    std::vector<double> cumulative(order.size());
+    double totalCost = 0;
+    for (size_t i = 0; i < order.size(); i++)
+        cumulative[i] = (totalCost += cost[i]);
+
+    std::vector<size_t> cuts; // stage s covers positions [cuts[s-1], cuts[s])
+    size_t searchBegin = 1;
+    for (size_t s = 1; s < numStages; s++)
+    {
+        double target = totalCost * s / numStages;
+        double window = totalCost / numStages / 4;
+        size_t bestNarrow = 0; // narrowest legal cut within the window
+        size_t bestAny = 0;    // legal cut closest to the balance point, as fallback
+        for (size_t b = searchBegin; b < order.size(); b++)
+        {
+            if (order[b - 1]->IsPartOfLoop() && order[b]->IsPartOfLoop())
+                continue; // never cut through a recurrent loop
+            if (bestAny == 0 || fabs(cumulative[b - 1] - target) < fabs(cumulative[bestAny - 1] - target))
+                bestAny = b;
+            if (fabs(cumulative[b - 1] - target) <= window &&
+                (bestNarrow == 0 || cutWidth[b] < cutWidth[bestNarrow]))
+                bestNarrow = b;
+            if (cumulative[b - 1] > target + window)
+                break;
+        }
+        if (bestAny == 0)
+            RuntimeError("PlanPipelinePartition: no legal cut found for stage %d (recurrent loop spans the remainder of the network?).", (int) s);
+        cuts.push_back(bestNarrow != 0 ? bestNarrow : bestAny);
+        searchBegin = cuts.back() + 1;
+    }
+
+    // report the plan
+    fprintf(stderr, "\nPlanPipelinePartition: plan for %d pipeline stages over %d nodes (report only; multi-GPU execution not yet enabled, see EnforceOneGPUOnly()):\n",
+            (int) numStages, (int) order.size());
+    size_t begin = 0;
+    for (size_t s = 0; s < numStages; s++)
+    {
+        size_t end = (s == numStages - 1) ? order.size() : cuts[s];
+        double staticElements = 0, activationElements = 0;
+        for (size_t i = begin; i < end; i++)
+            (order[i]->HasMBLayout() ? activationElements : staticElements) += cost[i];
+        fprintf(stderr, "  stage %d: nodes %d..%d (%ls .. %ls), %.1f M static elements, %.1f k activation elements/sample\n",
+                (int) s, (int) begin, (int) (end - 1),
+                order[begin]->NodeName().c_str(), order[end - 1]->NodeName().c_str(),
+                staticElements / 1e6, activationElements / 1e3);
+        if (end < order.size())
+            fprintf(stderr, "  cut after %ls %ls operation: %.1f k elements/sample cross the boundary\n",
+                    order[end - 1]->NodeName().c_str(), order[end - 1]->OperationName().c_str(), cutWidth[end] / 1e3);
+        begin = end;
+    }
+    fprintf(stderr, "\n");
 }
 
 void ComputationNetwork::FormNestedNetwork(const ComputationNodeBasePtr& rootNode)
@@ -127,6 +532,9 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
 }
 /*virtual*/ void ComputationNetwork::PARTraversalFlowControlNode::ForwardProp(const FrameRange& fr) /*override*/
 {
+    if (m_parallelForwardPropWorkers > 1)
+        return ForwardPropParallel(fr);
+
     for (auto& node : m_nestedNodes)
     {
         if (node->IsOutputOlderThanInputs())
@@ -135,15 +543,169 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
             if (recInfo)
                 assert(recInfo->m_sourceNode->GetMBLayout() == node->GetMBLayout());
 
+            // if any input parameter still has its update in flight on the side stream, fence
+            // this node's kernels behind it (no-op unless overlapped updates are enabled)
+            if (recInfo)
+                for (auto& nodeInsideLoop : recInfo->m_nestedNodes)
+                    nodeInsideLoop->FenceOnPendingInputUpdates();
+            else
+                node->FenceOnPendingInputUpdates();
+
+            if (m_timeNodes)
+                node->BeginTiming(true /*forward*/);
+
             node->BeginForwardProp();
             node->ForwardProp(fr.WithLayout(node->GetMBLayout()));
             node->EndForwardProp();
 
+            if (m_timeNodes)
+                node->EndTiming(true /*forward*/);
+
+            if (m_sampleDynamicRange)
+                node->SampleDynamicRange(true /*forward*/);
+
             node->BumpEvalTimeStamp();
         }
     }
 }
 
+// dependency-scheduled variant of ForwardProp(): executes nested nodes as soon as all of their
+// inputs are ready, so independent branches of the network (e.g. the heads of a multi-task model)
+// overlap on worker threads. SEQ loops remain serialized islands, scheduled as one unit each.
+// Requires that nodes do not share value matrices (the memory-sharing machinery assumes strictly
+// sequential execution); callers enforce this via ComputationNetwork::EnableParallelForwardProp().
+void ComputationNetwork::PARTraversalFlowControlNode::ForwardPropParallel(const FrameRange& fr)
+{
+    const size_t numTasks = m_nestedNodes.size();
+
+    // map each node to the task that produces its value (nodes inside a loop map to the loop's sentinel)
+    std::map<ComputationNodeBasePtr, size_t> producerTask;
+    for (size_t i = 0; i < numTasks; i++)
+    {
+        auto recInfo = dynamic_pointer_cast<SEQTraversalFlowControlNode>(m_nestedNodes[i]);
+        if (recInfo)
+            for (auto& nodeInsideLoop : recInfo->m_nestedNodes)
+                producerTask[nodeInsideLoop] = i;
+        else
+            producerTask[m_nestedNodes[i]] = i;
+    }
+
+    // build the dependency graph over tasks; inputs without a producer task (features, parameters)
+    // are ready from the start and impose no edge
+    std::vector<size_t> numPendingInputs(numTasks, 0);
+    std::vector<std::vector<size_t>> consumers(numTasks);
+    for (size_t i = 0; i < numTasks; i++)
+    {
+        auto addInputEdges = [&](const ComputationNodeBasePtr& node)
+        {
+            for (auto& input : node->GetInputs())
+            {
+                auto producer = producerTask.find(input);
+                if (producer != producerTask.end() && producer->second != i)
+                {
+                    consumers[producer->second].push_back(i);
+                    numPendingInputs[i]++;
+                }
+            }
+        };
+        auto recInfo = dynamic_pointer_cast<SEQTraversalFlowControlNode>(m_nestedNodes[i]);
+        if (recInfo)
+            for (auto& nodeInsideLoop : recInfo->m_nestedNodes)
+                addInputEdges(nodeInsideLoop);
+        else
+            addInputEdges(m_nestedNodes[i]);
+    }
+
+    std::mutex scheduleMutex;
+    std::condition_variable readyCondition;
+    std::vector<size_t> readyTasks;
+    for (size_t i = 0; i < numTasks; i++)
+        if (numPendingInputs[i] == 0)
+            readyTasks.push_back(i);
+    size_t numCompletedTasks = 0;
+    size_t numBusyWorkers = 0;
+    std::exception_ptr workerException;
+
+    auto worker = [&]()
+    {
+        std::unique_lock<std::mutex> lock(scheduleMutex);
+        for (;;)
+        {
+            // run until a task is available, a sibling failed, or no further task can become ready
+            readyCondition.wait(lock, [&] { return !readyTasks.empty() || workerException || numBusyWorkers == 0; });
+            if (readyTasks.empty() || workerException)
+            {
+                readyCondition.notify_all();
+                return;
+            }
+            size_t task = readyTasks.back();
+            readyTasks.pop_back();
+            numBusyWorkers++;
+
+            auto& node = m_nestedNodes[task];
+            // the timestamp check and bump happen under the lock; all producers have completed
+            // (and bumped) before this task became ready, so the check is race-free
+            bool mustEvaluate = node->IsOutputOlderThanInputs();
+            if (mustEvaluate)
+            {
+                lock.unlock();
+                try
+                {
+                    auto recInfo = dynamic_pointer_cast<SEQTraversalFlowControlNode>(node);
+                    if (recInfo)
+                        assert(recInfo->m_sourceNode->GetMBLayout() == node->GetMBLayout());
+
+                    if (m_timeNodes) // (parallel mode is CPU-only, so this only accumulates wall-clock time)
+                        node->BeginTiming(true /*forward*/);
+
+                    node->BeginForwardProp();
+                    node->ForwardProp(fr.WithLayout(node->GetMBLayout()));
+                    node->EndForwardProp();
+
+                    if (m_timeNodes)
+                        node->EndTiming(true /*forward*/);
+
+                    if (m_sampleDynamicRange)
+                        node->SampleDynamicRange(true /*forward*/);
+                }
+                catch (...)
+                {
+                    lock.lock();
+                    numBusyWorkers--;
+                    if (!workerException)
+                        workerException = std::current_exception();
+                    readyCondition.notify_all();
+                    return;
+                }
+                lock.lock();
+                node->BumpEvalTimeStamp();
+            }
+
+            numBusyWorkers--;
+            numCompletedTasks++;
+            for (size_t consumer : consumers[task])
+                if (--numPendingInputs[consumer] == 0)
+                    readyTasks.push_back(consumer);
+            readyCondition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workerThreads;
+    size_t numWorkers = std::min(m_parallelForwardPropWorkers, numTasks);
+    for (size_t i = 1; i < numWorkers; i++) // the calling thread is worker 0
+        workerThreads.push_back(std::thread(worker));
+    worker();
+    for (auto& thread : workerThreads)
+        thread.join();
+
+    if (workerException)
+        std::rethrow_exception(workerException);
+
+    if (numCompletedTasks != numTasks)
+        LogicError("ForwardPropParallel: only %d of %d tasks completed; the dependency graph must be cyclic.",
+                   (int) numCompletedTasks, (int) numTasks);
+}
+
 /*virtual*/ void ComputationNetwork::PARTraversalFlowControlNode::Backprop(const FrameRange& fr, bool childrenInThisLoop, bool childrenInOuterLoop) /*override*/
 {
     childrenInThisLoop, childrenInOuterLoop; // TODO: think through what these mean when coming from PAR mode
@@ -152,9 +714,35 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
     {
         auto& node = *pnode;
 
+        if (m_timeNodes)
+            node->BeginTiming(false /*forward*/);
+
         node->BeginBackprop();
         node->Backprop(fr.WithLayout(node->GetMBLayout()), true /*childrenInThisLoop*/, true /*childrenInOuterLoop*/);
         node->EndBackprop();
+
+        if (m_timeNodes)
+            node->EndTiming(false /*forward*/);
+
+        // we iterate backwards over the evaluation order, so the node's own gradient is final here
+        if (m_sampleDynamicRange)
+            node->SampleDynamicRange(false /*forward*/);
+
+        // Since we iterate backwards over the evaluation order, all consumers of 'node' have
+        // already backpropagated into it, i.e. its gradient is final at this point.
+        if (m_nodeGradientReadyCallback)
+        {
+            // for a SEQ loop report the nodes inside the loop; their gradients are all final
+            // once the unrolled loop has been backpropagated through
+            auto recInfo = dynamic_pointer_cast<SEQTraversalFlowControlNode>(node);
+            if (recInfo)
+            {
+                for (auto& nodeInsideLoop : recInfo->m_nestedNodes)
+                    m_nodeGradientReadyCallback(nodeInsideLoop);
+            }
+            else
+                m_nodeGradientReadyCallback(node);
+        }
     }
 }
 /*virtual*/ void ComputationNetwork::PARTraversalFlowControlNode::RequestMatricesBeforeForwardProp(MatrixPool& matrixPool) /*override*/
@@ -201,6 +789,25 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
 // This evaluates all nodes in this FlowControlNode in SEQ mode: process the loop frame by frame in a nested loop.
 // This is where the time axis changes.
 // TODO: Once we do nested loops, then the FrameRange argument to this will refer to the outer loop.
+// return the cached per-time-step FrameRange plan of this loop, covering time steps 0..numTimeSteps-1
+// FrameRange construction and iterator stepping are pure bookkeeping that is identical for every
+// minibatch evaluated against the same layout object; building the ranges once and reusing them
+// keeps that work out of the per-frame loop. The plan is rebuilt when the layout object changes
+// (e.g. after revalidation re-links layouts) and extended when a longer minibatch arrives;
+// shorter minibatches use a prefix of it.
+const std::vector<FrameRange>& ComputationNetwork::SEQTraversalFlowControlNode::FrameRangePlan(size_t numTimeSteps)
+{
+    const auto& pMBLayout = GetMBLayout();
+    if (m_framePlanLayout != pMBLayout) // layout object changed: start over
+    {
+        m_frameRangePlan.clear();
+        m_framePlanLayout = pMBLayout;
+    }
+    for (size_t t = m_frameRangePlan.size(); t < numTimeSteps; t++) // extend to cover numTimeSteps steps
+        m_frameRangePlan.push_back(FrameRange(pMBLayout, t));
+    return m_frameRangePlan;
+}
+
 /*virtual*/ void ComputationNetwork::SEQTraversalFlowControlNode::ForwardProp(const FrameRange&) /*override*/
 {
     // get layout associated with this loop
@@ -210,9 +817,11 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
     // for every time step run through all nodes in this particular loop (treat the loop like a little ComputationNetwork)
     // Note: Currently, this is limited to linear-time loops. But nothing stops the iteration below to, e.g., be a 2D iteration over an image
     // if we implement an according FrameRangeIteration.
-    FrameRangeIteration range(GetMBLayout(), m_steppingDirection);
-    for (auto t = range.begin(); t != range.end(); t++)
+    size_t T = GetMBLayout()->GetNumTimeSteps();
+    const auto& plan = FrameRangePlan(T); // cached FrameRanges, replacing a FrameRangeIteration here
+    for (size_t i = 0; i < T; i++)
     {
+        const FrameRange& t = plan[m_steppingDirection > 0 ? i : T - 1 - i];
         for (auto& node : m_nestedNodes)
         {
             node->ForwardProp(t);
@@ -239,10 +848,11 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
 {
     childrenInThisLoop, childrenInOuterLoop;    // TODO: think through what these mean when coming from PAR mode
     const auto& recurrentNodes = m_nestedNodes; // BUGBUG: -ForForward?? Does this mean we can remove non-ForForward?
-    auto pMBLayout = recurrentNodes[0]->GetMBLayout();
-    FrameRangeIteration range(pMBLayout, m_steppingDirection);
-    for (auto t = range.rbegin(); t != range.rend(); t++) // note: reverse iteration
+    size_t T = recurrentNodes[0]->GetMBLayout()->GetNumTimeSteps();
+    const auto& plan = FrameRangePlan(T); // cached FrameRanges, replacing a FrameRangeIteration here
+    for (size_t i = 0; i < T; i++) // note: reverse iteration w.r.t. the stepping direction
     {
+        const FrameRange& t = plan[m_steppingDirection > 0 ? T - 1 - i : i];
         for (auto nodeIter2 = recurrentNodes.rbegin(); nodeIter2 != recurrentNodes.rend(); ++nodeIter2)
         {
             auto& node2 = *nodeIter2;
@@ -375,6 +985,11 @@ void ComputationNetwork::InvalidateCompiledNetwork()
     m_nestedNetworks.clear();
     m_inputValues.clear();
     m_learnableParameters.clear();
+
+    // a structural edit may change what a node's Validate() depends on in ways the cached input
+    // signatures cannot see (e.g. a node's own configuration), so drop them and revalidate fully
+    for (auto& iter : m_nameToNodeMap)
+        iter.second->m_validationSignatureValid = false;
 }
 
 // verify that network has undergone CompileNetwork()
@@ -394,6 +1009,8 @@ void ComputationNetwork::CompileNetwork()
 {
     fprintf(stderr, "\nPost-processing network...\n");
 
+    StartupProfiling::BeginPhase("networkValidation");
+
     // all steps below have to be repeated for all root nodes (=nodes without parents and PreComputeNodes)
     DetermineSetOfAllRoots();
 
@@ -428,13 +1045,39 @@ void ComputationNetwork::CompileNetwork()
     for (auto& node : m_allRoots)
         ValidateSubNetwork(node);
 
-    // STEP: Optimize the network.
-    // :)
+    // STEP: Optimize the network: merge structurally identical subtrees ("common subexpressions").
+    // NDL macro expansion duplicates entire chains per layer, so this can remove a sizeable fraction of nodes.
+    if (m_graphOptimizationsEnabled)
+    {
+        size_t numMerged = EliminateCommonSubexpressions();
+        if (numMerged > 0)
+            fprintf(stderr, "Merged %d duplicate node(s).\n", (int) numMerged);
+        size_t numFused = FuseElementwiseChains();
+        if (numFused > 0)
+            fprintf(stderr, "Fused %d ElementTimes/Plus pair(s) into FusedMultiplyAdd operations.\n", (int) numFused);
+        size_t numFusedLayers = FuseTimesBiasActivationChains();
+        if (numFusedLayers > 0)
+            fprintf(stderr, "Fused %d Times/Plus/activation chain(s) into FusedTimesBiasActivation operations.\n", (int) numFusedLayers);
+        size_t numFusedSums = FuseSumActivationChains();
+        if (numFusedSums > 0)
+            fprintf(stderr, "Fused %d Plus/activation pair(s) into FusedSumActivation operations.\n", (int) numFusedSums);
+        if (numMerged + numFused + numFusedLayers + numFusedSums > 0)
+        {
+            fprintf(stderr, "Re-running post-processing on the optimized graph.\n");
+            // the traversal orders and nested structures formed above still reference the removed
+            // nodes, so redo the compilation steps; the second pass finds nothing left to change
+            InvalidateCompiledNetwork();
+            StartupProfiling::EndPhase(); // the recursive call below opens its own phase
+            CompileNetwork();
+            return;
+        }
+    }
 
     // STEP: Some final details.
     ResetEvalTimeStamps(); // invalidate all m_value fields. Really belongs into StartEvaluateMinibatchLoop()
 
     fprintf(stderr, "\nPost-processing network complete.\n");
+    StartupProfiling::EndPhase();
     m_isCompiled = true;
 }
 
@@ -488,14 +1131,490 @@ void ComputationNetwork::DetermineSetOfAllRoots()
     set_union(unreferencedNodes.begin(), unreferencedNodes.end(), allKnownRoots.begin(), allKnownRoots.end(), inserter(m_allRoots, m_allRoots.end()));
 }
 
+// -----------------------------------------------------------------------
+// graph optimization
+// -----------------------------------------------------------------------
+
+// Is this an operation that EliminateCommonSubexpressions() may merge?
+// Deterministic, configuration-free operations only: anything with private state (random seeds,
+// time offsets, running statistics) or constructor parameters that input identity cannot see
+// (slice bounds, reshape targets, convolution geometry) must stay out of this list.
+static bool IsMergeableOperation(const wstring& operationName)
+{
+    static const set<wstring> mergeableOps =
+    {
+        OperationNameOf(PlusNode), OperationNameOf(MinusNode), OperationNameOf(NegateNode),
+        OperationNameOf(TimesNode), OperationNameOf(TransposeTimesNode), OperationNameOf(ElementTimesNode),
+        OperationNameOf(DiagTimesNode), OperationNameOf(KhatriRaoProductNode),
+        OperationNameOf(SumElementsNode), OperationNameOf(SumColumnElementsNode),
+        OperationNameOf(SigmoidNode), OperationNameOf(TanhNode), OperationNameOf(RectifiedLinearNode),
+        OperationNameOf(LogNode), OperationNameOf(ExpNode), OperationNameOf(CosineNode),
+        OperationNameOf(SoftmaxNode), OperationNameOf(LogSoftmaxNode), OperationNameOf(HardmaxNode)
+    };
+    return mergeableOps.find(operationName) != mergeableOps.end();
+}
+
+// do two LearnableParameters hold the same constant? (only called for non-updatable parameters)
+static bool AreConstantParametersEqual(const ComputationNodeBasePtr& a, const ComputationNodeBasePtr& b)
+{
+    auto af = dynamic_pointer_cast<ComputationNode<float>>(a);
+    auto bf = dynamic_pointer_cast<ComputationNode<float>>(b);
+    if (af && bf)
+        return !af->Value().IsEmpty() && !bf->Value().IsEmpty() && Matrix<float>::AreEqual(af->Value(), bf->Value(), 0);
+    auto ad = dynamic_pointer_cast<ComputationNode<double>>(a);
+    auto bd = dynamic_pointer_cast<ComputationNode<double>>(b);
+    if (ad && bd)
+        return !ad->Value().IsEmpty() && !bd->Value().IsEmpty() && Matrix<double>::AreEqual(ad->Value(), bd->Value(), 0);
+    return false;
+}
+
+// merge structurally identical subtrees (common-subexpression elimination)
+// Processing the global evaluation order children-first, two nodes merge when they perform the
+// same mergeable operation on the same (already canonicalized) inputs; non-updatable
+// LearnableParameters additionally merge by value, which is what lets the duplicate chains that
+// NDL macro expansion creates collapse bottom-up. Roots and node-group members (features, labels,
+// criteria, evaluation, output nodes) always survive, since configs refer to them by name.
+// Constant-only subexpressions need no explicit folding beyond this: once merged, the evaluation
+// timestamp mechanism computes them exactly once per minibatch loop.
+// Returns the number of nodes merged away. Caller must recompile, since cached traversal orders
+// still reference the removed nodes.
+size_t ComputationNetwork::EliminateCommonSubexpressions()
+{
+    // nodes that must keep their identity
+    set<ComputationNodeBasePtr> mustKeep(m_allRoots.begin(), m_allRoots.end());
+    for (auto groupIter : GetAllNodeGroups())
+        mustKeep.insert(groupIter->begin(), groupIter->end());
+
+    map<ComputationNodeBasePtr, ComputationNodeBasePtr> replacements;   // duplicate -> representative
+    map<wstring, ComputationNodeBasePtr> seenOps;                       // operation signature -> representative
+    vector<ComputationNodeBasePtr> seenConstants;                       // non-updatable LearnableParameters (compared by value)
+
+    for (auto& node : GetEvalOrder(nullptr)) // global order: children before parents
+    {
+        // canonicalize the inputs first; children precede parents, so their replacements are known
+        for (size_t i = 0; i < node->GetNumInputs(); i++)
+        {
+            auto repl = replacements.find(node->Input(i));
+            if (repl != replacements.end())
+                node->SetInput(i, repl->second);
+        }
+
+        if (mustKeep.find(node) != mustKeep.end())
+            continue;
+
+        if (node->OperationName() == OperationNameOf(LearnableParameter) && !node->IsParameterUpdateRequired() &&
+            !m_deferredValueLoading) // with deferred loading the values to compare are not in memory yet
+        {
+            auto match = find_if(seenConstants.begin(), seenConstants.end(),
+                                 [&](const ComputationNodeBasePtr& seen) { return AreConstantParametersEqual(seen, node); });
+            if (match != seenConstants.end())
+                replacements[node] = *match;
+            else
+                seenConstants.push_back(node);
+        }
+        else if (IsMergeableOperation(node->OperationName()))
+        {
+            // signature = operation plus the identity of its (canonicalized) inputs
+            wstring signature = node->OperationName();
+            for (size_t i = 0; i < node->GetNumInputs(); i++)
+                signature += msra::strfun::wstrprintf(L" %p", node->Input(i).get());
+
+            auto seen = seenOps.find(signature);
+            if (seen != seenOps.end())
+                replacements[node] = seen->second;
+            else
+                seenOps[signature] = node;
+        }
+    }
+
+    // safety net: inside recurrent loops the traversal order is not strictly children-first, so
+    // re-point any references the ordered sweep missed before the duplicates are cut loose
+    if (!replacements.empty())
+    {
+        for (auto& iter : m_nameToNodeMap)
+        {
+            auto node = iter.second;
+            for (size_t i = 0; i < node->GetNumInputs(); i++)
+            {
+                auto repl = replacements.find(node->Input(i));
+                if (repl != replacements.end())
+                    node->SetInput(i, repl->second);
+            }
+        }
+    }
+
+    // remove the duplicates; their parents have all been re-pointed at the representatives above.
+    // The merged names stay resolvable: they alias the representative, which computes the same value.
+    for (auto& alias : m_mergedNodeAliases) // aliases from an earlier pass may point at a node merged now
+    {
+        auto repl = replacements.find(alias.second);
+        if (repl != replacements.end())
+            alias.second = repl->second;
+    }
+    for (auto& repl : replacements)
+    {
+        auto duplicate = repl.first;
+        duplicate->DetachInputs(); // break potential circular references, as in DeleteNode()
+        m_nameToNodeMap.erase(duplicate->NodeName());
+        m_mergedNodeAliases[duplicate->NodeName()] = repl.second;
+    }
+    return replacements.size();
+}
+
+// helper for FuseElementwiseChains(): create a FusedMultiplyAddNode of the same
+// element type and device as an exemplar node, or nullptr if the type does not match
+template <class ElemType>
+static ComputationNodeBasePtr NewFusedMultiplyAddNode(const ComputationNodeBasePtr& exemplar, const wstring& name)
+{
+    if (!dynamic_pointer_cast<ComputationNode<ElemType>>(exemplar))
+        return nullptr;
+    return make_shared<FusedMultiplyAddNode<ElemType>>(exemplar->GetDeviceId(), name);
+}
+
+// fuse elementwise operation chains into composite nodes
+// Currently this recognizes one pattern: a Plus with an ElementTimes as one summand, where the
+// ElementTimes result is used nowhere else. The pair becomes a single FusedMultiplyAddNode, which
+// evaluates a .* b + c in one tensor-kernel launch instead of two and drops the intermediate
+// product buffer. Since ElementTimes broadcasts, this also covers scalar, row, and column scaling
+// ('Scale' is an alias of ElementTimes). Nodes that must keep their identity (roots and node-group
+// members, same rule as EliminateCommonSubexpressions()) and nodes inside recurrent loops are left
+// alone; the latter because fusion would have to prove that both halves live in the same loop.
+// Returns the number of pairs fused. Caller must recompile, since cached traversal orders still
+// reference the replaced nodes.
+size_t ComputationNetwork::FuseElementwiseChains()
+{
+    // nodes that must keep their identity
+    set<ComputationNodeBasePtr> mustKeep(m_allRoots.begin(), m_allRoots.end());
+    for (auto groupIter : GetAllNodeGroups())
+        mustKeep.insert(groupIter->begin(), groupIter->end());
+
+    // count consumers, so that we only fuse an ElementTimes whose product is used once
+    map<ComputationNodeBasePtr, size_t> useCount;
+    for (const auto& iter : m_nameToNodeMap)
+        for (size_t i = 0; i < iter.second->GetNumInputs(); i++)
+            useCount[iter.second->Input(i)]++;
+
+    map<ComputationNodeBasePtr, ComputationNodeBasePtr> replacements;                   // Plus node -> fused node
+    vector<pair<ComputationNodeBasePtr, ComputationNodeBasePtr>> fusedPairs;            // (Plus, ElementTimes) pairs to remove
+    for (auto& node : GetEvalOrder(nullptr)) // global order: children before parents
+    {
+        if (node->OperationName() != OperationNameOf(PlusNode) ||
+            mustKeep.find(node) != mustKeep.end() || node->IsPartOfLoop())
+            continue;
+
+        // find the summand that is a single-use ElementTimes
+        size_t which;
+        for (which = 0; which < 2; which++)
+        {
+            const auto& et = node->Input(which);
+            if (et->OperationName() == OperationNameOf(ElementTimesNode) && useCount[et] == 1 &&
+                mustKeep.find(et) == mustKeep.end() && !et->IsPartOfLoop())
+                break;
+        }
+        if (which == 2)
+            continue;
+        const auto& et = node->Input(which);
+
+        // create the fused node (inputs: factor1, factor2, addend)
+        wstring name = node->NodeName() + L".fused";
+        while (m_nameToNodeMap.find(name) != m_nameToNodeMap.end()) // avoid name clashes
+            name += L"_";
+        auto fused = NewFusedMultiplyAddNode<float>(node, name);
+        if (!fused)
+            fused = NewFusedMultiplyAddNode<double>(node, name);
+        if (!fused)
+            LogicError("FuseElementwiseChains: %ls %ls operation has unexpected element type.", node->NodeName().c_str(), node->OperationName().c_str());
+        fused->AttachInputs(vector<ComputationNodeBasePtr>{et->Input(0), et->Input(1), node->Input(1 - which)});
+        AddNodeToNet(fused);
+        replacements[node] = fused;
+        fusedPairs.push_back(make_pair(node, et));
+    }
+
+    // re-point all consumers of the replaced Plus nodes at the fused nodes
+    if (!replacements.empty())
+    {
+        for (auto& iter : m_nameToNodeMap)
+        {
+            auto node = iter.second;
+            for (size_t i = 0; i < node->GetNumInputs(); i++)
+            {
+                auto repl = replacements.find(node->Input(i));
+                if (repl != replacements.end())
+                    node->SetInput(i, repl->second);
+            }
+        }
+    }
+
+    // remove the replaced pairs; nothing references them anymore. The Plus name stays resolvable
+    // as an alias of the fused node, which computes the same value; the ElementTimes name cannot
+    // (no surviving node materializes the intermediate product).
+    for (auto& alias : m_mergedNodeAliases) // aliases from an earlier pass may point at a Plus fused now
+    {
+        auto repl = replacements.find(alias.second);
+        if (repl != replacements.end())
+            alias.second = repl->second;
+    }
+    for (auto& pair : fusedPairs)
+    {
+        pair.first->DetachInputs(); // break potential circular references, as in DeleteNode()
+        pair.second->DetachInputs();
+        m_nameToNodeMap.erase(pair.first->NodeName());
+        m_nameToNodeMap.erase(pair.second->NodeName());
+        m_mergedNodeAliases[pair.first->NodeName()] = replacements[pair.first];
+        m_mergedNodeAliases.erase(pair.second->NodeName()); // in case an earlier alias used that name
+    }
+    return fusedPairs.size();
+}
+
+// helper for FuseTimesBiasActivationChains(): create a FusedTimesBiasActivationNode of the
+// same element type and device as an exemplar node, or nullptr if the type does not match
+template <class ElemType>
+static ComputationNodeBasePtr NewFusedTimesBiasActivationNode(const ComputationNodeBasePtr& exemplar, const wstring& name, ElementWiseOperator activation)
+{
+    if (!dynamic_pointer_cast<ComputationNode<ElemType>>(exemplar))
+        return nullptr;
+    return make_shared<FusedTimesBiasActivationNode<ElemType>>(exemplar->GetDeviceId(), name, activation);
+}
+
+// fuse fully-connected layers into single fused GEMM + bias + activation nodes
+// This recognizes Sigmoid/Tanh/RectifiedLinear(Plus(Times(W, x), bias)) where W and bias carry
+// no minibatch data, bias is a column vector, and the Plus and Times results are used nowhere
+// else. The chain becomes one FusedTimesBiasActivationNode, which runs the GEMM and applies
+// bias and activation while the output tile is still cache resident
+// (Matrix::MultiplyAddBiasAndApply()), instead of three separate passes over the minibatch
+// output. CPU networks only -- the fused kernel exists for the dense CPU path -- and the same
+// identity rules as the other passes: roots, node-group members and loop members are left alone.
+// Returns the number of chains fused. Caller must recompile.
+size_t ComputationNetwork::FuseTimesBiasActivationChains()
+{
+    if (GetDeviceId() != CPUDEVICE)
+        return 0;
+
+    // nodes that must keep their identity
+    set<ComputationNodeBasePtr> mustKeep(m_allRoots.begin(), m_allRoots.end());
+    for (auto groupIter : GetAllNodeGroups())
+        mustKeep.insert(groupIter->begin(), groupIter->end());
+
+    // count consumers, so that we only fuse intermediates whose value is used once
+    map<ComputationNodeBasePtr, size_t> useCount;
+    for (const auto& iter : m_nameToNodeMap)
+        for (size_t i = 0; i < iter.second->GetNumInputs(); i++)
+            useCount[iter.second->Input(i)]++;
+
+    map<ComputationNodeBasePtr, ComputationNodeBasePtr> replacements;        // activation node -> fused node
+    vector<vector<ComputationNodeBasePtr>> fusedChains;                      // (activation, Plus, Times) triples to remove
+    for (auto& node : GetEvalOrder(nullptr))
+    {
+        ElementWiseOperator activation;
+        if (node->OperationName() == OperationNameOf(SigmoidNode))
+            activation = ElementWiseOperator::opSigmoid;
+        else if (node->OperationName() == OperationNameOf(TanhNode))
+            activation = ElementWiseOperator::opTanh;
+        else if (node->OperationName() == OperationNameOf(RectifiedLinearNode))
+            activation = ElementWiseOperator::opLinearRectifier;
+        else
+            continue;
+        if (mustKeep.find(node) != mustKeep.end() || node->IsPartOfLoop() || !node->HasMBLayout())
+            continue;
+
+        // the input must be a single-use Plus of a single-use Times and a column-vector bias
+        const auto& plus = node->Input(0);
+        if (plus->OperationName() != OperationNameOf(PlusNode) || useCount[plus] != 1 ||
+            mustKeep.find(plus) != mustKeep.end() || plus->IsPartOfLoop())
+            continue;
+        size_t which;
+        for (which = 0; which < 2; which++)
+        {
+            const auto& times = plus->Input(which);
+            if (times->OperationName() == OperationNameOf(TimesNode) && useCount[times] == 1 &&
+                mustKeep.find(times) == mustKeep.end() && !times->IsPartOfLoop())
+                break;
+        }
+        if (which == 2)
+            continue;
+        const auto& times = plus->Input(which);
+        const auto& bias = plus->Input(1 - which);
+        if (bias->HasMBLayout() || bias->GetAsMatrixNumCols() != 1 ||
+            bias->GetAsMatrixNumRows() != node->GetSampleMatrixNumRows())
+            continue;
+        // the GEMM semantics require the standard Times shape: weight without, input with MB data
+        if (times->Input(0)->HasMBLayout() || !times->Input(1)->HasMBLayout())
+            continue;
+
+        // create the fused node (inputs: W, x, bias)
+        wstring name = node->NodeName() + L".fused";
+        while (m_nameToNodeMap.find(name) != m_nameToNodeMap.end()) // avoid name clashes
+            name += L"_";
+        auto fused = NewFusedTimesBiasActivationNode<float>(node, name, activation);
+        if (!fused)
+            fused = NewFusedTimesBiasActivationNode<double>(node, name, activation);
+        if (!fused)
+            LogicError("FuseTimesBiasActivationChains: %ls %ls operation has unexpected element type.", node->NodeName().c_str(), node->OperationName().c_str());
+        fused->AttachInputs(vector<ComputationNodeBasePtr>{times->Input(0), times->Input(1), bias});
+        AddNodeToNet(fused);
+        replacements[node] = fused;
+        fusedChains.push_back(vector<ComputationNodeBasePtr>{node, plus, times});
+    }
+
+    // re-point all consumers of the replaced activation nodes at the fused nodes
+    if (!replacements.empty())
+    {
+        for (auto& iter : m_nameToNodeMap)
+        {
+            auto node = iter.second;
+            for (size_t i = 0; i < node->GetNumInputs(); i++)
+            {
+                auto repl = replacements.find(node->Input(i));
+                if (repl != replacements.end())
+                    node->SetInput(i, repl->second);
+            }
+        }
+    }
+
+    // remove the replaced chains; the activation name stays resolvable as an alias of the fused
+    // node, which computes the same value, while the Plus and Times names cannot (no surviving
+    // node materializes the intermediates)
+    for (auto& alias : m_mergedNodeAliases) // aliases from an earlier pass may point at a node fused now
+    {
+        auto repl = replacements.find(alias.second);
+        if (repl != replacements.end())
+            alias.second = repl->second;
+    }
+    for (auto& chain : fusedChains)
+    {
+        for (auto& member : chain)
+        {
+            member->DetachInputs(); // break potential circular references, as in DeleteNode()
+            m_nameToNodeMap.erase(member->NodeName());
+            m_mergedNodeAliases.erase(member->NodeName()); // in case an earlier alias used that name
+        }
+        m_mergedNodeAliases[chain[0]->NodeName()] = replacements[chain[0]];
+    }
+    return fusedChains.size();
+}
+
+// helper for FuseSumActivationChains(): create a FusedSumActivationNode of the same
+// element type and device as an exemplar node, or nullptr if the type does not match
+template <class ElemType>
+static ComputationNodeBasePtr NewFusedSumActivationNode(const ComputationNodeBasePtr& exemplar, const wstring& name, ElementWiseOperator activation)
+{
+    if (!dynamic_pointer_cast<ComputationNode<ElemType>>(exemplar))
+        return nullptr;
+    return make_shared<FusedSumActivationNode<ElemType>>(exemplar->GetDeviceId(), name, activation);
+}
+
+// fuse Plus -> Sigmoid/Tanh/RectifiedLinear chains into single FusedSumActivationNodes
+// The fused node executes sum and activation as one fused tensor opcode (one kernel launch
+// on GPU, one cache pass on CPU, see TensorView's lazy chains), so it applies on every
+// device. Runs after FuseTimesBiasActivationChains(), which gets first pick at the chains
+// that also include the GEMM; what that pass leaves behind (non-Times summands, GPU
+// networks) is picked up here. The sum must be used by the activation only, and the usual
+// identity rules apply: roots, node-group members and loop members are left alone.
+// Returns the number of chains fused. Caller must recompile.
+size_t ComputationNetwork::FuseSumActivationChains()
+{
+    // nodes that must keep their identity
+    set<ComputationNodeBasePtr> mustKeep(m_allRoots.begin(), m_allRoots.end());
+    for (auto groupIter : GetAllNodeGroups())
+        mustKeep.insert(groupIter->begin(), groupIter->end());
+
+    // count consumers, so that we only fuse a Plus whose sum is used once
+    map<ComputationNodeBasePtr, size_t> useCount;
+    for (const auto& iter : m_nameToNodeMap)
+        for (size_t i = 0; i < iter.second->GetNumInputs(); i++)
+            useCount[iter.second->Input(i)]++;
+
+    map<ComputationNodeBasePtr, ComputationNodeBasePtr> replacements;        // activation node -> fused node
+    vector<pair<ComputationNodeBasePtr, ComputationNodeBasePtr>> fusedPairs; // (activation, Plus) pairs to remove
+    for (auto& node : GetEvalOrder(nullptr))
+    {
+        ElementWiseOperator activation;
+        if (node->OperationName() == OperationNameOf(SigmoidNode))
+            activation = ElementWiseOperator::opSigmoid;
+        else if (node->OperationName() == OperationNameOf(TanhNode))
+            activation = ElementWiseOperator::opTanh;
+        else if (node->OperationName() == OperationNameOf(RectifiedLinearNode))
+            activation = ElementWiseOperator::opLinearRectifier;
+        else
+            continue;
+        if (mustKeep.find(node) != mustKeep.end() || node->IsPartOfLoop())
+            continue;
+
+        // the input must be a Plus whose sum is consumed by this activation only
+        const auto& plus = node->Input(0);
+        if (plus->OperationName() != OperationNameOf(PlusNode) || useCount[plus] != 1 ||
+            mustKeep.find(plus) != mustKeep.end() || plus->IsPartOfLoop())
+            continue;
+
+        // create the fused node (inputs: summand1, summand2)
+        wstring name = node->NodeName() + L".fused";
+        while (m_nameToNodeMap.find(name) != m_nameToNodeMap.end()) // avoid name clashes
+            name += L"_";
+        auto fused = NewFusedSumActivationNode<float>(node, name, activation);
+        if (!fused)
+            fused = NewFusedSumActivationNode<double>(node, name, activation);
+        if (!fused)
+            LogicError("FuseSumActivationChains: %ls %ls operation has unexpected element type.", node->NodeName().c_str(), node->OperationName().c_str());
+        fused->AttachInputs(vector<ComputationNodeBasePtr>{plus->Input(0), plus->Input(1)});
+        AddNodeToNet(fused);
+        replacements[node] = fused;
+        fusedPairs.push_back(make_pair(node, plus));
+    }
+
+    // re-point all consumers of the replaced activation nodes at the fused nodes
+    if (!replacements.empty())
+    {
+        for (auto& iter : m_nameToNodeMap)
+        {
+            auto node = iter.second;
+            for (size_t i = 0; i < node->GetNumInputs(); i++)
+            {
+                auto repl = replacements.find(node->Input(i));
+                if (repl != replacements.end())
+                    node->SetInput(i, repl->second);
+            }
+        }
+    }
+
+    // remove the replaced pairs; the activation name stays resolvable as an alias of the
+    // fused node, which computes the same value, while the Plus name cannot (no surviving
+    // node materializes the bare sum)
+    for (auto& alias : m_mergedNodeAliases) // aliases from an earlier pass may point at a node fused now
+    {
+        auto repl = replacements.find(alias.second);
+        if (repl != replacements.end())
+            alias.second = repl->second;
+    }
+    for (auto& pair : fusedPairs)
+    {
+        pair.first->DetachInputs(); // break potential circular references, as in DeleteNode()
+        pair.second->DetachInputs();
+        m_nameToNodeMap.erase(pair.first->NodeName());
+        m_nameToNodeMap.erase(pair.second->NodeName());
+        m_mergedNodeAliases[pair.first->NodeName()] = replacements[pair.first];
+        m_mergedNodeAliases.erase(pair.second->NodeName()); // in case an earlier alias used that name
+    }
+    return fusedPairs.size();
+}
+
 // -----------------------------------------------------------------------
 // validation
 // -----------------------------------------------------------------------
 
+// helper to discover dimension changes
+static pair<TensorShape, bool> GetDims(const ComputationNodeBasePtr& node)
+{
+    return make_pair(node->GetSampleLayout(), node->HasMBLayout());
+}
+
 // validate sub-network needed to evalute a specific output node
 // This calls Validate() on every node in evaluation order (allowing to propagate things forwards through the net).
 // This is called lazily but once only per node until next ClearCache().
 // This also sets up MBLayout links.
+// Validation is incremental: each node remembers the input signature (dimensions, layout flags,
+// gradient flags) it was last validated against, and only nodes whose signature no longer matches,
+// plus everything that transitively consumes them, are re-validated. Repeated calls (one per root,
+// and again whenever dimensions may have changed) thus cost O(affected chain), not O(graph).
 void ComputationNetwork::ValidateSubNetwork(const ComputationNodeBasePtr& rootNode)
 {
     // reset to a well-defined MBLayout (any meaningful layout should do here)
@@ -512,10 +1631,63 @@ void ComputationNetwork::ValidateSubNetwork(const ComputationNodeBasePtr& rootNo
     // Nodes validated on partial input (i.e. some children not yet validated) will be revisited.
     const auto& nodes = GetEvalOrder(rootNode);
 
+    // does a node's cached validation signature still describe its current inputs?
+    auto signatureMatches = [](const ComputationNodeBasePtr& node)
+    {
+        if (!node->m_validationSignatureValid)
+            return false;
+        const auto& inputs = node->GetInputs();
+        if (node->m_validationInputDims.size() != inputs.size())
+            return false;
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            if (node->m_validationInputDims[i] != GetDims(inputs[i]) ||
+                node->m_validationInputNeedsGradients[i] != (bool) inputs[i]->m_needsGradient)
+                return false;
+        }
+        return true;
+    };
+
+    // determine the set of nodes that actually need (re-)validation: those whose signature no
+    // longer matches, plus everything that transitively consumes them. Dimension changes only
+    // propagate downstream, but delay edges point backwards in the evaluation order, so iterate
+    // to a fixed point (converges after one extra sweep per nested loop at most).
+    std::set<ComputationNodeBasePtr> dirtyNodes;
+    bool addedDirty = true;
+    while (addedDirty)
+    {
+        addedDirty = false;
+        for (auto& node : nodes)
+        {
+            if (dirtyNodes.find(node) != dirtyNodes.end())
+                continue;
+            bool dirty = !signatureMatches(node);
+            for (auto& input : node->GetInputs())
+                dirty |= (dirtyNodes.find(input) != dirtyNodes.end());
+            if (dirty)
+            {
+                dirtyNodes.insert(node);
+                addedDirty = true;
+            }
+        }
+    }
+
+    if (dirtyNodes.empty()) // all validation results still hold; nothing to do
+    {
+        fprintf(stderr, "\nValidating for node %ls: all %d nodes are up to date.\n", rootNode->NodeName().c_str(), (int) nodes.size());
+        return;
+    }
+
+    // nodes that are up to date count as visited, with stable dimensions; the rest start over
+    std::list<ComputationNodeBasePtr> dirtyList; // (in evaluation order)
     for (auto& node : nodes)
     {
-        node->m_visited = false;
-        node->m_needsGradient = node->IsParameterUpdateRequired(); // these get propagated upwards in the following
+        node->m_visited = (dirtyNodes.find(node) == dirtyNodes.end());
+        if (!node->m_visited)
+        {
+            node->m_needsGradient = node->IsParameterUpdateRequired(); // these get propagated upwards in the following
+            dirtyList.push_back(node);
+        }
     }
 
     // loop and validate until we are done
@@ -525,18 +1697,32 @@ void ComputationNetwork::ValidateSubNetwork(const ComputationNodeBasePtr& rootNo
     //  - validate (final)              // final means consistency checks
     //    Fail if any change during this stage.
     size_t pass = 0;
-    size_t toValidate = nodes.size();
+    size_t toValidate = dirtyList.size();
     while (toValidate > 0)
     {
         pass++;
         fprintf(stderr, "\n\nValidating for node %ls. %d nodes to process in pass %d.\n", rootNode->NodeName().c_str(), (int) toValidate, (int) pass);
-        ValidateNodes(nodes, false /*isFinalValidationPass*/, toValidate);
+        ValidateNodes(dirtyList, false /*isFinalValidationPass*/, toValidate);
     }
     fprintf(stderr, "\n\nValidating for node %ls, final verification.\n", rootNode->NodeName().c_str());
-    ValidateNodes(nodes, true /*isFinalValidationPass*/, toValidate);
+    ValidateNodes(dirtyList, true /*isFinalValidationPass*/, toValidate);
     if (toValidate != 0)
         LogicError("ValidateSubNetwork: ValidateNodes(true) unexpectedly returned with work left to do.");
 
+    // remember the input signatures the nodes were just validated against, so that the next call
+    // can skip everything that does not change in the meantime
+    for (auto& node : dirtyList)
+    {
+        node->m_validationInputDims.clear();
+        node->m_validationInputNeedsGradients.clear();
+        for (auto& input : node->GetInputs())
+        {
+            node->m_validationInputDims.push_back(GetDims(input));
+            node->m_validationInputNeedsGradients.push_back(input->m_needsGradient);
+        }
+        node->m_validationSignatureValid = true;
+    }
+
     // propagate some info to SEQTraversalFlowControlNode
     // TODO: In the future we should validate not on the flat list but the PARTraversalFlowControlNode structure. Then this will be unnecessary.
     for (auto& recInfo : m_allSEQNodes)
@@ -570,12 +1756,6 @@ void ComputationNetwork::ValidateSubNetwork(const ComputationNodeBasePtr& rootNo
     }
 }
 
-// helper to discover dimension changes
-static pair<TensorShape, bool> GetDims(const ComputationNodeBasePtr& node)
-{
-    return make_pair(node->GetSampleLayout(), node->HasMBLayout());
-}
-
 void ComputationNetwork::ValidateNodes(list<ComputationNodeBasePtr> nodes, bool isFinalValidationPass, size_t& todo)
 {
     todo = 0; // returns how many nodes are to be redone
@@ -705,6 +1885,8 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
     // Allocate memory for forward/backward computation
     fprintf(stderr, "\n\nAllocating matrices for forward and/or backward propagation.\n");
 
+    StartupProfiling::BeginPhase("matrixAllocation");
+
     VerifyIsCompiled("AllocateAllMatrices");
 
     // Due to special topology, if a node is solely induced by parameters, its function value should not be shared
@@ -773,6 +1955,10 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
     {
         nodeIter->SetOutputNeededDuringBackprop(outputValueNeededDuringBackProp[nodeIter]);
 
+        // clear any in-place decision from a previous allocation pass; it is re-derived below
+        nodeIter->SetForwardPropInPlace(false);
+        nodeIter->SetValueConsumedInPlace(false);
+
         if (nodeIter->IsPartOfLoop())
         {
             // TODO: use FormNestedNetwork() here to avoid completedEvaluate[] check
@@ -790,6 +1976,21 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
         }
         else
         {
+            // In-place optimization: let an eligible elementwise node overwrite its input's buffer
+            // instead of allocating its own. Safe only if we are the input's sole consumer, the
+            // input's value is dead once our forward pass ran, and both buffers are pool-managed.
+            if (nodeIter->SupportsForwardPropInPlace() && nodeIter->isValueSharable() &&
+                !nodeIter->IsPartOfLoop() && nodeIter->GetNumInputs() == 1)
+            {
+                ComputationNodeBasePtr inputNode = nodeIter->GetInputs()[0];
+                if (!inputNode->IsPartOfLoop() && inputNode->isValueSharable() &&
+                    !inputNode->IsOutputNeededDuringBackprop() && // also false if value sharing is globally off
+                    parentsMap[inputNode].size() == 1)
+                {
+                    nodeIter->SetForwardPropInPlace(true);
+                    inputNode->SetValueConsumedInPlace(true);
+                }
+            }
             nodeIter->RequestMatricesBeforeForwardProp(m_matrixPool);
             // we only release matrices for the children since the root node's informatioin will be used and should not be shared
             // with others
@@ -834,6 +2035,8 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
             }
         }
     }
+
+    StartupProfiling::EndPhase();
 }
 
 void ComputationNetwork::ReleaseMatricesAfterEvalForChildren(ComputationNodeBasePtr n, std::unordered_map<ComputationNodeBasePtr, int>& parentCount)
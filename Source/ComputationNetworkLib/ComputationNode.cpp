@@ -9,6 +9,7 @@
 #include "InputAndParamNodes.h"
 #include "ComputationNetworkBuilder.h" // TODO: We should only pull in NewComputationNodeFromConfig(). Nodes should not know about network at large.
 #include "TensorShape.h"
+#include "MatrixQuantizerImpl.h" // for MatrixComputeStreamEvent (parameter-update fences)
 
 #ifndef let
 #define let const auto
@@ -179,6 +180,37 @@ void ComputationNode<ElemType>::ValidateInferInputDimsFrom(const TensorShape& ot
     fprintf(stderr, "Tensor shape of %ls %ls operation was inferred as [%s].\n", NodeName().c_str(), OperationName().c_str(), string(m_sampleLayout).c_str());
 }
 
+// -----------------------------------------------------------------------
+// overlapped parameter update (see SetParameterUpdateFence())
+// -----------------------------------------------------------------------
+
+// Before this node's forward kernels are issued, make the compute stream wait for any input
+// parameter whose update is still in flight on the side stream. The wait is asynchronous, so
+// forward kernels of nodes whose parameters are already up to date keep overlapping the
+// remaining updates.
+void ComputationNodeBase::FenceOnPendingInputUpdates()
+{
+    for (auto& input : m_inputs)
+    {
+        if (input->m_parameterUpdateFence)
+        {
+            input->m_parameterUpdateFence->SynchronizeComputeStreamWithEvent();
+            input->m_parameterUpdateFence.reset();
+        }
+    }
+}
+
+// Host-blocking drain of this node's own pending update; called before host-side reads of the
+// parameter (checkpointing, model averaging) that do not go through the forward pass.
+void ComputationNodeBase::CompletePendingParameterUpdate()
+{
+    if (m_parameterUpdateFence)
+    {
+        m_parameterUpdateFence->SynchronizeEvent();
+        m_parameterUpdateFence.reset();
+    }
+}
+
 // -----------------------------------------------------------------------
 // tensor helpers
 // -----------------------------------------------------------------------
@@ -264,6 +296,19 @@ template <>
 std::map<size_t, std::map<size_t, FloatMatrix*>> ComputationNode<float>::s_constOnes{};
 template <>
 std::map<size_t, std::map<size_t, DoubleMatrix*>> ComputationNode<double>::s_constOnes{};
+template <>
+std::mutex ComputationNode<float>::s_constOnesMutex{};
+template <>
+std::mutex ComputationNode<double>::s_constOnesMutex{};
+
+template <>
+ArenaMemAllocator* ComputationNode<float>::s_scratchArena = nullptr;
+template <>
+ArenaMemAllocator* ComputationNode<double>::s_scratchArena = nullptr;
+template <>
+std::mutex ComputationNode<float>::s_scratchMutex{};
+template <>
+std::mutex ComputationNode<double>::s_scratchMutex{};
 
 template class ComputationNode<float>;
 template class ComputationNode<double>;
@@ -6,6 +6,9 @@
 
 #include "Basics.h"
 #include "Matrix.h"
+#include "CudaEventTimer.h"
+#include "TimerUtility.h"
+#include "MemAllocator.h"
 #include "TensorView.h"
 #include "ScriptableObjects.h"
 #include "Sequences.h"
@@ -22,6 +25,7 @@
 #include <algorithm>
 #include <assert.h>
 #include <atomic>
+#include <mutex>
 
 #define DEFAULT_HIDDEN_ACTIVATION 0.1
 
@@ -53,6 +57,9 @@ enum CopyNodeFlags // flags to be passed to the CopyTo() function
     copyNodeChildrenCrossNetwork = 4, // allow a cross network child copy
 };
 
+class MatrixComputeStreamEvent; // (MatrixQuantizerImpl.h; only referenced through pointers here)
+class SharedFileMapping;        // (SharedFileMapping.h; only referenced through pointers here)
+
 #pragma region base computation class
 
 // =======================================================================
@@ -142,7 +149,7 @@ struct ComputationNetworkOwnedNodeState
     friend class ComputationNetwork;
 
     ComputationNetworkOwnedNodeState()
-        : m_needsGradient(false), m_valueSharable(true)
+        : m_needsGradient(false), m_valueSharable(true), m_validationSignatureValid(false)
     {
         PurgeStateForFormingRecurrentLoops();
         m_isPartOfLoop = false;
@@ -153,6 +160,7 @@ struct ComputationNetworkOwnedNodeState
         // TODO: is that really all we copy? (this is a result of refactoring, so it seems yes indeed). Should we at least ClearCache()?
         other.m_isPartOfLoop = m_isPartOfLoop;
         other.m_needsGradient = m_needsGradient;
+        other.m_validationSignatureValid = false; // the copy must be validated against its own inputs
     }
 
     bool IsPartOfLoop() const { return m_isPartOfLoop; }
@@ -168,6 +176,14 @@ protected:                // TODO: should be fully encapsulated here
     bool m_valueSharable; // a flag is needed for memory share.
                           // If it is false (e.g., learnableParameters/InputValue and those nodes are solely induced by learnableParameters),
                           // it will never be released to memory pool
+
+    // cached validation signature: the dimensions, layout flags, and gradient flags of this node's
+    // inputs as of the last successful validation. As long as these still match, the node's last
+    // Validate() result holds and re-validation can be skipped (see ComputationNetwork::ValidateSubNetwork()).
+    bool m_validationSignatureValid;
+    std::vector<std::pair<TensorShape, bool>> m_validationInputDims; // (sample layout, has MB layout) per input
+    std::vector<bool> m_validationInputNeedsGradients;
+
 private:
 
     bool m_isPartOfLoop; // true if this loop is part of a recurrent loop
@@ -265,7 +281,7 @@ public:
     // -----------------------------------------------------------------------
 
     ComputationNodeBase(DEVICEID_TYPE deviceId, const wstring& name)
-        : m_deviceId(deviceId), m_outputNeededDuringBackprop(true), m_parameterUpdateRequired(false), m_gradientInitialized(false), m_nodeName(name == L"" ? CreateUniqNodeName() : name)
+        : m_deviceId(deviceId), m_outputNeededDuringBackprop(true), m_forwardPropInPlace(false), m_valueConsumedInPlace(false), m_parameterUpdateRequired(false), m_gradientInitialized(false), m_nodeName(name == L"" ? CreateUniqNodeName() : name)
     {
     }
     virtual ~ComputationNodeBase()
@@ -301,6 +317,27 @@ public:
         // base class has nothing to load
     }
 
+    // Load() variant used when the model file carries a node-value offset table (see ComputationNetwork::SaveToFileImpl()).
+    // Nodes that persist a large payload (LearnableParameter) override this to skip the payload and remember where it
+    // lives in the file instead; 'valueEndOffset' is the file position right after this node's record. All other nodes
+    // just load normally.
+    virtual void LoadValueDeferred(File& fstream, size_t modelVersion, const std::wstring& /*fileName*/, uint64_t /*valueEndOffset*/)
+    {
+        Load(fstream, modelVersion);
+    }
+
+    // read back a value whose loading was skipped by LoadValueDeferred(); no-op for nodes without one
+    virtual void MaterializeDeferredValue()
+    {
+    }
+
+    // variant that backs the value with a read-only shared mapping of the model file where the
+    // node supports it (LearnableParameter on the CPU); the default just reads a private copy
+    virtual void MaterializeDeferredValue(const std::shared_ptr<SharedFileMapping>& /*mapping*/)
+    {
+        MaterializeDeferredValue();
+    }
+
     virtual void Save(File& fstream) const
     {
         fstream << OperationName() << NodeName();
@@ -589,6 +626,14 @@ public:
     void SetParameterUpdateRequired(bool f) { m_parameterUpdateRequired = f; }
     bool IsParameterUpdateRequired() const { return m_parameterUpdateRequired; }
 
+    // Overlapped parameter update: when SGD issues this node's update on a side stream, it parks
+    // the update-completion event here; the next forward pass makes the compute stream wait on the
+    // events of a node's inputs before issuing that node's kernels (see
+    // PARTraversalFlowControlNode::ForwardProp()). Only ever set on LearnableParameter leaves.
+    void SetParameterUpdateFence(const std::shared_ptr<MatrixComputeStreamEvent>& fence) { m_parameterUpdateFence = fence; }
+    void FenceOnPendingInputUpdates();   // compute stream waits on inputs' pending update events (asynchronous)
+    void CompletePendingParameterUpdate(); // host waits for this node's own pending update, if any
+
     // return true if the node's value should be computed before the normal training. e.g., mean and invStd of input features.
     virtual bool /*IComputationNode::*/ RequiresPreCompute() const { return false; }
 
@@ -701,6 +746,91 @@ public:
     void SetOutputNeededDuringBackprop(bool f) { m_outputNeededDuringBackprop = f; }
     bool IsOutputNeededDuringBackprop() const { return !g_shareNodeValueMatrices || m_outputNeededDuringBackprop; }
 
+    // Can this node compute its output in place, overwriting its input's value buffer?
+    // Only meaningful for one-input elementwise ops whose backprop does not read the input value.
+    // Base-class version makes the conservative assumption that it cannot. Override if it can.
+    // The actual decision is made by the memory planner in AllocateAllMatrices(), which also
+    // verifies that nobody else consumes the input.
+    virtual bool SupportsForwardPropInPlace() const { return false; }
+
+    void SetForwardPropInPlace(bool f) { m_forwardPropInPlace = f; }
+    bool IsForwardPropInPlace() const { return m_forwardPropInPlace; }
+
+    // set on the input node whose buffer an in-place consumer takes over, so that the input
+    // does not release the (now shared) buffer to the pool on its own
+    void SetValueConsumedInPlace(bool f) { m_valueConsumedInPlace = f; }
+    bool IsValueConsumedInPlace() const { return m_valueConsumedInPlace; }
+
+    // -----------------------------------------------------------------------
+    // per-node timing (see ComputationNetwork::ReportNodeTiming())
+    // -----------------------------------------------------------------------
+
+    // accumulated execution times of one direction (forward or backprop)
+    // Wall-clock time covers the host-side cost of issuing the operations; on GPU devices the
+    // device-side time is additionally measured with CUDA events, so that asynchronously launched
+    // kernels are attributed to the node that issued them rather than to whoever syncs next.
+    struct NodeTiming
+    {
+        size_t count = 0;          // number of executions
+        double wallSeconds = 0;    // total host-side wall-clock seconds
+        double flops = 0;          // model-based FLOP estimate of the Matrix ops issued (see EnableMatrixOpAccounting())
+        double mathBytes = 0;      // model-based bytes-touched estimate of those same ops
+        double flopsAtBegin = 0, bytesAtBegin = 0; // (counter snapshot taken by BeginTiming())
+        Timer wallTimer;           // (running timer of the current execution)
+        CudaEventTimer deviceTimer; // total GPU-stream seconds (stays 0 on CPU devices)
+        void Reset()
+        {
+            count = 0;
+            wallSeconds = 0;
+            flops = 0;
+            mathBytes = 0;
+            deviceTimer.Reset();
+        }
+    };
+
+    // bracket one ForwardProp() or Backprop() execution of this node
+    // Only called when timing has been enabled on the network; see ComputationNetwork::EnableNodeTiming().
+    void BeginTiming(bool forward)
+    {
+        auto& timing = forward ? m_forwardTiming : m_backpropTiming;
+        ReadMatrixOpCounters(timing.flopsAtBegin, timing.bytesAtBegin);
+        timing.deviceTimer.Begin(m_deviceId);
+        timing.wallTimer.Start();
+    }
+    void EndTiming(bool forward)
+    {
+        auto& timing = forward ? m_forwardTiming : m_backpropTiming;
+        timing.wallTimer.Stop();
+        timing.deviceTimer.End();
+        timing.wallSeconds += timing.wallTimer.ElapsedSeconds();
+        double flopsNow, bytesNow; // attribute the Matrix ops issued since BeginTiming() to this node
+        ReadMatrixOpCounters(flopsNow, bytesNow);
+        timing.flops += flopsNow - timing.flopsAtBegin;
+        timing.mathBytes += bytesNow - timing.bytesAtBegin;
+        timing.count++;
+    }
+    NodeTiming& GetTiming(bool forward) { return forward ? m_forwardTiming : m_backpropTiming; }
+    void ResetTiming()
+    {
+        m_forwardTiming.Reset();
+        m_backpropTiming.Reset();
+    }
+
+    // -----------------------------------------------------------------------
+    // dynamic-range sampling (see ComputationNetwork::ReportDynamicRange())
+    // -----------------------------------------------------------------------
+
+    // log2-bucketed histograms of the magnitudes of Value() resp. Gradient(), accumulated after
+    // sampled ForwardProp()/Backprop() executions; the data needed to judge whether a node fits a
+    // reduced-precision format. Implemented by ComputationNode<ElemType>; the default no-op covers
+    // flow-control nodes, which carry no matrices of their own.
+    static const int c_dynamicRangeNumBuckets = 64;   // bucket 0 = zeros/underflows, buckets 1..63 = one power of two each
+    static const int c_dynamicRangeMinExponent = -48; // bucket 1 starts at 2^-48; the top bucket catches |x| >= 2^14
+    virtual void SampleDynamicRange(bool /*forward*/) {}
+    // copy the accumulated histogram counts to the host; returns false if nothing has been sampled
+    virtual bool GetDynamicRangeHistogram(bool /*forward*/, std::vector<double>& /*counts*/) const { return false; }
+    virtual void ResetDynamicRange() {}
+
     // -----------------------------------------------------------------------
     // helpers for network traversal
     // -----------------------------------------------------------------------
@@ -835,6 +965,15 @@ protected:
     bool m_parameterUpdateRequired;    // update parameters? Only used for LearnableParameters.    --TODO: Should we make this a member of LearnableParameters actually? And require a type cast? Currently it is read out for all leaves.
     bool m_gradientInitialized;        // indicates whether the gradient matrix has been resized and initialized to 0
     bool m_outputNeededDuringBackprop; // indicates whether the output value of the node is needed during backprop
+    bool m_forwardPropInPlace;         // true if the memory planner decided this node overwrites its input's value buffer
+    bool m_valueConsumedInPlace;       // true if an in-place consumer took over this node's value buffer
+
+    // pending side-stream update of this parameter; see SetParameterUpdateFence()
+    std::shared_ptr<MatrixComputeStreamEvent> m_parameterUpdateFence;
+
+    // per-node execution times; only updated while timing is enabled (see BeginTiming())
+    NodeTiming m_forwardTiming;
+    NodeTiming m_backpropTiming;
 };
 typedef ComputationNodeBase::ComputationNodeBasePtr ComputationNodeBasePtr;
 
@@ -1360,14 +1499,18 @@ public:
     // request matrices needed to do node function value evaluation
     virtual void RequestMatricesBeforeForwardProp(MatrixPool& matrixPool) override
     {
-        RequestMatrixFromPool(m_value, matrixPool);
+        if (IsForwardPropInPlace())
+            m_value = Input(0)->m_value; // the planner determined that we may overwrite our input's buffer
+        else
+            RequestMatrixFromPool(m_value, matrixPool);
     }
 
     // release temp matrices that are only used by forward computation
     // don't release matrices that need to be used in the gradient computation
     virtual void ReleaseMatricesAfterForwardProp(MatrixPool& matrixPool) override
     {
-        if (!IsOutputNeededDuringBackprop() && (m_value->GetMatrixType() != SPARSE) && isValueSharable())
+        // if an in-place consumer took over our buffer, it is no longer ours to release; the consumer releases it
+        if (!IsOutputNeededDuringBackprop() && (m_value->GetMatrixType() != SPARSE) && isValueSharable() && !IsValueConsumedInPlace())
             ReleaseMatrixToPool(m_value, matrixPool);
     }
 
@@ -1412,6 +1555,21 @@ public:
         CreateMatrixIfNull(m_value);
     }
 
+    // move this node's computation to the given device, e.g. to pin a cheap pre-processing node
+    // to the CPU while the rest of the network runs on GPU (see
+    // ComputationNetwork::EnableAutoDevicePlacement()). Inputs and consumers that live on another
+    // device are bridged by the automatic cross-device transfer built into Matrix.
+    void PinToDevice(DEVICEID_TYPE deviceId)
+    {
+        if (m_deviceId == deviceId)
+            return;
+        m_deviceId = deviceId;
+        if (m_value)
+            m_value->TransferFromDeviceToDevice(m_value->GetDeviceId(), deviceId, true);
+        if (m_gradient)
+            m_gradient->TransferFromDeviceToDevice(m_gradient->GetDeviceId(), deviceId, true);
+    }
+
 protected:
 
     // this function is used to create matrices for those needed before matrix pool is available
@@ -1427,7 +1585,7 @@ protected:
     {
         if (matrixPtr == nullptr)
         {
-            matrixPtr = matrixPool.Request<ElemType>(m_deviceId);
+            matrixPtr = matrixPool.Request<ElemType>(m_deviceId, 0, NodeName()); // named, so allocation reports can attribute the bytes
         }
     }
 
@@ -1520,13 +1678,55 @@ public:
         }
     }
 
-    // NOTE: we should reimplement this to be thread-safe and use a larger than requested initialized memory block
+    // -----------------------------------------------------------------------
+    // dynamic-range sampling (see ComputationNodeBase and ComputationNetwork::ReportDynamicRange())
+    // -----------------------------------------------------------------------
+
+    virtual void SampleDynamicRange(bool forward) override
+    {
+        const auto& source = forward ? m_value : m_gradient;
+        if (!source || source->GetNumElements() == 0)
+            return;
+        auto& histogram = forward ? m_valueRangeHistogram : m_gradientRangeHistogram;
+        if (!histogram)
+        {
+            histogram = make_shared<Matrix<ElemType>>((size_t) c_dynamicRangeNumBuckets, 1, source->GetDeviceId());
+            histogram->SetValue(0);
+        }
+        else if (histogram->GetDeviceId() != source->GetDeviceId()) // the node may have changed devices (e.g. auto placement)
+            histogram->TransferFromDeviceToDevice(histogram->GetDeviceId(), source->GetDeviceId(), true);
+        source->AccumulateAbsLogHistogram(c_dynamicRangeMinExponent, *histogram);
+    }
+
+    virtual bool GetDynamicRangeHistogram(bool forward, std::vector<double>& counts) const override
+    {
+        const auto& histogram = forward ? m_valueRangeHistogram : m_gradientRangeHistogram;
+        if (!histogram)
+            return false;
+        Matrix<ElemType> hostCounts(*histogram, CPUDEVICE); // one small D2H copy at reporting time only
+        counts.resize(c_dynamicRangeNumBuckets);
+        for (int b = 0; b < c_dynamicRangeNumBuckets; b++)
+            counts[b] = (double) hostCounts(b, 0);
+        return true;
+    }
+
+    virtual void ResetDynamicRange() override
+    {
+        if (m_valueRangeHistogram)
+            m_valueRangeHistogram->SetValue(0);
+        if (m_gradientRangeHistogram)
+            m_gradientRangeHistogram->SetValue(0);
+    }
+
+    // NOTE: we should reimplement this to use a larger than requested initialized memory block
     // we can then just wrap that memory block in a matrix of the correct dimensions since it will be const no one can change it
     // should only need one memory block per device
-    // Thread-safety could be achieved by changing this to a shared_ptr.
     // When using the TensorView interface, one could instead just use a 1x1 matrix with a view that broadcasts its columns (stride 0).
+    // The process-wide map is guarded by a mutex: this is called from forward paths, which may
+    // run on worker threads (parallel forward prop, the concurrent eval network pool).
     static const Matrix<ElemType>& ConstOnes(const size_t rows, const size_t cols, const DEVICEID_TYPE deviceId)
     {
+        std::lock_guard<std::mutex> lock(s_constOnesMutex);
         if (s_constOnes.find(rows) == s_constOnes.end() ||
             s_constOnes[rows].find(cols) == s_constOnes[rows].end()) // not found
         {
@@ -1541,6 +1741,27 @@ public:
         return *m;
     }
 
+    // Per-minibatch scratch space: carve short-lived CPU-side scratch out of a shared arena instead
+    // of hitting the allocator inside ForwardProp()/BackpropTo(). The training loop reclaims the
+    // whole arena in O(1) at the end of every minibatch (see SGD::TrainOneEpoch), so scratch
+    // obtained here must not be kept across minibatches. Guarded by a mutex like ConstOnes(),
+    // since forward paths may run on worker threads.
+    static ElemType* RequestScratchSpace(size_t numElements)
+    {
+        std::lock_guard<std::mutex> lock(s_scratchMutex);
+        if (s_scratchArena == nullptr)
+            s_scratchArena = new ArenaMemAllocator((1 << 20) * sizeof(ElemType)); // initial size; grows to the high-water mark of a minibatch
+        return (ElemType*) s_scratchArena->Malloc(numElements * sizeof(ElemType));
+    }
+
+    // O(1) wholesale reclamation of all scratch space handed out since the last call
+    static void ResetScratchSpace()
+    {
+        std::lock_guard<std::mutex> lock(s_scratchMutex);
+        if (s_scratchArena != nullptr)
+            s_scratchArena->Reset();
+    }
+
     // -----------------------------------------------------------------------
     // data members
     // -----------------------------------------------------------------------
@@ -1549,7 +1770,13 @@ protected:
 
     shared_ptr<Matrix<ElemType>> m_value, m_gradient;
 
+    // accumulated magnitude histograms, allocated lazily on first sample (see SampleDynamicRange())
+    shared_ptr<Matrix<ElemType>> m_valueRangeHistogram, m_gradientRangeHistogram;
+
     static std::map<size_t, std::map<size_t, Matrix<ElemType>*>> s_constOnes;
+    static std::mutex s_constOnesMutex;       // guards s_constOnes; see ConstOnes()
+    static ArenaMemAllocator* s_scratchArena; // backing store for RequestScratchSpace()
+    static std::mutex s_scratchMutex;         // guards s_scratchArena; see RequestScratchSpace()
 };
 
 // convenience wrapper for ComputationNode::New()
@@ -1735,6 +1962,7 @@ protected:
     using Base::InputUsedInComputingInputNodesGradients;                                                                                                 \
     using Base::InvalidateMissingGradientColumns;                                                                                                        \
     using Base::InvalidateMissingValueColumns;                                                                                                           \
+    using Base::IsForwardPropInPlace;                                                                                                                    \
     using Base::IsLeaf;                                                                                                                                  \
     using Base::IsOutputOlderThanInputs;                                                                                                                 \
     using Base::LinkToMBLayout;                                                                                                                          \
@@ -56,11 +56,21 @@ public:
     virtual void /*ComputationNodeNonLooping::*/ ForwardPropNonLooping() override
     {
         FrameRange fr(Input(0)->GetMBLayout());
-        Input(0)->ValueFor(fr).VectorMax(*m_maxIndexes0, *m_maxValues, true);
-        Input(1)->ValueFor(fr).VectorMax(*m_maxIndexes1, *m_maxValues, true, m_topK);
-        MaskMissingColumnsToZero(*m_maxIndexes0, Input(0)->GetMBLayout(), fr);
-        MaskMissingColumnsToZero(*m_maxIndexes1, Input(1)->GetMBLayout(), fr);
-        Value().AssignNumOfDiff(*m_maxIndexes0, *m_maxIndexes1, m_topK > 1);
+        // fused path: count the errors in a single pass over the two value matrices, without
+        // materializing the intermediate index/value matrices. The fused kernel cannot skip gap
+        // columns, so minibatches with gaps fall back to the VectorMax() route below.
+        if (!Input(0)->HasMBLayout() || !Input(0)->GetMBLayout()->HasGaps(fr))
+        {
+            Value().AssignTopKError(Input(0)->ValueFor(fr), Input(1)->ValueFor(fr), m_topK);
+        }
+        else
+        {
+            Input(0)->ValueFor(fr).VectorMax(*m_maxIndexes0, *m_maxValues, true);
+            Input(1)->ValueFor(fr).VectorMax(*m_maxIndexes1, *m_maxValues, true, m_topK);
+            MaskMissingColumnsToZero(*m_maxIndexes0, Input(0)->GetMBLayout(), fr);
+            MaskMissingColumnsToZero(*m_maxIndexes1, Input(1)->GetMBLayout(), fr);
+            Value().AssignNumOfDiff(*m_maxIndexes0, *m_maxIndexes1, m_topK > 1);
+        }
 #if NANCHECK
         Value().HasNan("ErrorPrediction");
 #endif
@@ -9,6 +9,7 @@
 #include "ScriptableObjects.h"
 #include "Matrix.h"
 #include "File.h" // for LoadMatrixFromTextFile()
+#include "SharedFileMapping.h"
 
 #include <unordered_set>
 #include <map>
@@ -119,6 +120,110 @@ public:
         VerifyDataSize(Value());      // sanity check
     }
 
+    // deferred-load variant: reads everything except the value matrix, and remembers where the value
+    // lives in the file instead. The matrix is read in by MaterializeDeferredValue() on first use, so
+    // consumers that evaluate a sub-network (e.g. through EvalDll) never pay for weights they don't touch.
+    virtual void LoadValueDeferred(File& fstream, size_t modelVersion, const std::wstring& fileName, uint64_t valueEndOffset) override
+    {
+        Base::Load(fstream, modelVersion);
+
+        size_t rows, cols;
+        fstream >> m_parameterUpdateRequired;
+        fstream >> rows >> cols;
+
+        if (rows != 0) // legacy file format: load eagerly (these files predate the offset table anyway)
+        {
+            TensorShape sampleLayout(rows, cols);
+            LoadValue(fstream);
+            SetDims(sampleLayout, false);
+            VerifyDataSize(Value());
+            return;
+        }
+
+        TensorShape sampleLayout;
+        sampleLayout.Load(fstream, /*acceptLegacyFormat=*/true);
+        if (cols > 1) // in some legacy format, last tensor dimension was split off as an explicit column dimension
+            sampleLayout.AppendInPlace(sampleLayout.GetRank(), cols);
+
+        // skip over the value; it remains unallocated until MaterializeDeferredValue()
+        m_deferredValueFileName = fileName;
+        m_deferredValueOffset = fstream.GetPosition();
+        m_valueDeferred = true;
+        fstream.SetPosition(valueEndOffset);
+
+        CreateMatrixIfNull(m_value);
+        SetDims(sampleLayout, false);
+    }
+
+    virtual void MaterializeDeferredValue() override
+    {
+        if (!m_valueDeferred)
+            return;
+
+        File fstream(m_deferredValueFileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead);
+        fstream.SetPosition(m_deferredValueOffset);
+
+        TensorShape sampleLayout = GetSampleLayout(); // LoadValue() overwrites the layout with the matrix' 2D shape
+        LoadValue(fstream);
+        SetDims(sampleLayout, false);
+        VerifyDataSize(Value()); // sanity check
+        m_valueDeferred = false;
+    }
+
+    // materialize the deferred value as a view into a read-only shared mapping of the model file,
+    // instead of reading a private copy. Every process on the box that maps the same model then
+    // references one set of physical pages for the weights. Only valid on the CPU, and only for
+    // evaluation: the pages cannot be written to, and a parameter update through a mapped value
+    // would fault. Anything the mapping cannot serve (GPU device, sparse value, legacy format)
+    // falls back to the private-copy path above.
+    virtual void MaterializeDeferredValue(const std::shared_ptr<SharedFileMapping>& mapping) override
+    {
+        if (!m_valueDeferred)
+            return;
+        if (!mapping || m_deviceId != CPUDEVICE)
+            return MaterializeDeferredValue();
+
+        // parse the matrix header to locate the raw element array inside the file
+        File fstream(m_deferredValueFileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead);
+        fstream.SetPosition(m_deferredValueOffset);
+        fstream.GetMarker(fileMarkerBeginSection, std::wstring(L"BMAT"));
+        size_t elsize;
+        fstream >> elsize;
+        if (sizeof(ElemType) != elsize)
+            RuntimeError("MaterializeDeferredValue: element size of %ls does not match the template argument", NodeName().c_str());
+        std::wstring matrixName;
+        size_t numRows, numCols;
+        int format;
+        fstream >> matrixName >> format >> numRows >> numCols;
+        if ((format & ~(matrixFormatDense + matrixFormatColMajor)) != 0) // only dense column-major payloads are a flat array
+            return MaterializeDeferredValue();
+        size_t dataOffset = (size_t) fstream.GetPosition();
+        if (dataOffset + numRows * numCols * sizeof(ElemType) > mapping->Size())
+            RuntimeError("MaterializeDeferredValue: value of %ls extends past the end of the mapped model file", NodeName().c_str());
+
+        TensorShape sampleLayout = GetSampleLayout(); // SetValue() below overwrites the layout with the matrix' 2D shape
+        // (casting away the view's const-ness is safe: the flag below makes the matrix a
+        // non-owning view, and an evaluation-only parameter is never written through it)
+        m_value->SetValue(numRows, numCols, CPUDEVICE, (ElemType*) (mapping->Data() + dataOffset), matrixFlagDontOwnBuffer);
+        SetDims(sampleLayout, false);
+        VerifyDataSize(Value()); // sanity check
+        m_valueMapping = mapping; // the mapping must outlive the value that points into it
+        m_valueDeferred = false;
+    }
+
+    // adopt another instance's value matrix in place of our own copy
+    // Used when several networks loaded from the same model file evaluate concurrently (see
+    // EvalDll's network pool): the clones then reference a single read-only copy of the weights.
+    // A pending deferred load is left with 'other'; since the matrix object is shared, it is
+    // filled in for all instances once the owner materializes it.
+    void ShareValueFrom(const LearnableParameter<ElemType>& other)
+    {
+        if (GetSampleLayout().GetDims() != other.GetSampleLayout().GetDims())
+            LogicError("ShareValueFrom: %ls and %ls have different dimensions.", NodeName().c_str(), other.NodeName().c_str());
+        m_value = other.m_value;
+        m_valueDeferred = false;
+    }
+
     // initialize with random numbers
     void InitRandom(const bool uniformInit,
                     const unsigned long randomSeed,
@@ -208,6 +313,13 @@ public:
 
         PrintNodeValuesToFile(printValues, fstream);
     }
+
+private:
+    // deferred value loading (see LoadValueDeferred())
+    std::wstring m_deferredValueFileName;
+    uint64_t m_deferredValueOffset = 0;
+    bool m_valueDeferred = false;
+    std::shared_ptr<SharedFileMapping> m_valueMapping; // keeps the shared mapping alive while m_value points into it
 };
 
 // -----------------------------------------------------------------------
@@ -427,6 +539,11 @@ public:
             Matrix<ElemType> sliceInput1Value = Input(1)->MaskedValueFor(t);
             Matrix<ElemType> sliceOutputGrad = MaskedGradientFor(t);
 
+            // if the input is sparse (e.g. one-hot words), accumulate the embedding gradient in block-column
+            // sparse format, so that only the columns looked up in this minibatch are stored and updated
+            if (sliceInput1Value.GetMatrixType() == SPARSE && Input(0)->Gradient().GetMatrixType() == DENSE && sliceOutputGrad.GetMatrixType() == DENSE)
+                Input(0)->Gradient().SwitchToMatrixType(SPARSE, MatrixFormat::matrixFormatSparseBlockCol, false);
+
             BackpropToLeft(sliceInput1Value, Input(0)->GradientAsMatrix(), sliceOutputGrad);
         }
         else if (inputIndex == 1) // right derivative (input)
@@ -505,6 +622,20 @@ public:
         SetDims(TensorShape(Input(0)->GetAsMatrixNumRows() * wordsInEachSample), true);
     }
 
+    virtual void AllocateGradientMatricesForInputs(MatrixPool& matrixPool) override
+    {
+        // this is a special handling case. We need to allocate sparse matrix directly instead of from pool.
+        if (Input(0)->NeedGradient() && Input(1)->Value().GetMatrixType() == SPARSE)
+        {
+            Input(0)->CreateGradientMatrixIfNull();
+            Input(0)->Gradient().SwitchToMatrixType(SPARSE, MatrixFormat::matrixFormatSparseBlockCol, false);
+        }
+
+        // we need to call base allocation at end since we will need to allocate special ones first
+        // so that the default allocator will not allocate it again.
+        Base::AllocateGradientMatricesForInputs(matrixPool);
+    }
+
     bool UnitTest()
     {
         try
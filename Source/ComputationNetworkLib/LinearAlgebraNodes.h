@@ -236,6 +236,46 @@ public:
 #if DUMPOUTPUT
         Input(0)->ValueAsMatrix().Print("TimesNode - Input0");
 #endif
+        // quantized inference: when enabled (eval only) and the left operand is a learnable parameter,
+        // quantize it once to 8-bit precision and run the product through the fixed-point kernel
+        if (IsQuantizedInference() && !m_transpose &&
+            Input(0)->OperationName() == L"LearnableParameter" &&
+            m_deviceId == CPUDEVICE &&
+            sliceInput1Value.GetMatrixType() == DENSE && sliceOutputValue.GetMatrixType() == DENSE)
+        {
+            if (!m_quantizedWeightsT)
+            {
+                m_quantizedWeightsT = make_shared<Matrix<short>>(CPUDEVICE);
+                m_quantizedRowScales = make_shared<Matrix<ElemType>>(CPUDEVICE);
+                Input(0)->ValueAsMatrix().QuantizeForInference(*m_quantizedWeightsT, *m_quantizedRowScales);
+            }
+            Matrix<ElemType>::MultiplyQuantized(*m_quantizedWeightsT, *m_quantizedRowScales, sliceInput1Value, sliceOutputValue);
+            return;
+        }
+        // prepacked weights: when enabled (eval only) and the left operand is a large learnable
+        // parameter, pack it once into the BLAS' internal blocked GEMM layout and multiply through
+        // the packed copy, so the BLAS does not repack the same weight matrix on every call
+        if (UsePrepackedWeights() &&
+            Input(0)->OperationName() == L"LearnableParameter" &&
+            m_deviceId == CPUDEVICE &&
+            sliceInput1Value.GetMatrixType() == DENSE && sliceOutputValue.GetMatrixType() == DENSE)
+        {
+            const Matrix<ElemType>& weights = Input(0)->ValueAsMatrix();
+            if (!m_triedPackingWeights)
+            {
+                m_triedPackingWeights = true;
+                // packing duplicates the weight matrix, so only pay that for matrices large enough
+                // that the per-call repacking inside the BLAS actually dominates
+                const size_t packingThresholdElements = 1 << 20; // 4 MB of floats
+                if (weights.GetNumElements() >= packingThresholdElements)
+                    m_packedWeights = weights.PackForMultiply(m_transpose); // (null when the BLAS cannot pack)
+            }
+            if (m_packedWeights)
+            {
+                Matrix<ElemType>::MultiplyPacked(m_packedWeights, weights.GetNumRows(), weights.GetNumCols(), m_transpose, sliceInput1Value, sliceOutputValue);
+                return;
+            }
+        }
         // BUGBUG: This uses correct Matrix dimensions when multiplying with a non-minibatch only by luck. To be fixed when we allow to apply TimesNode to a subset of tensor dimensions.
         sliceOutputValue.AssignProductOf(Input(0)->ValueAsMatrix(), m_transpose, sliceInput1Value, false);
 #if NANCHECK
@@ -300,6 +340,15 @@ public:
         // so that the default allocator will not allocate it again.
         Base::AllocateGradientMatricesForInputs(matrixPool);
     }
+
+private:
+    // cached 8-bit version of the weight matrix, built on first ForwardProp() when quantized inference is enabled
+    shared_ptr<Matrix<short>> m_quantizedWeightsT;
+    shared_ptr<Matrix<ElemType>> m_quantizedRowScales;
+
+    // BLAS-packed copy of the weight matrix, built on first ForwardProp() when prepacked weights are enabled
+    shared_ptr<ElemType> m_packedWeights;
+    bool m_triedPackingWeights = false;
 };
 
 // -----------------------------------------------------------------------
@@ -410,6 +459,242 @@ public:
 template class ElementTimesNode<float>;
 template class ElementTimesNode<double>;
 
+// -----------------------------------------------------------------------
+// FusedMultiplyAddNode (factor1, factor2, addend)
+// computes factor1 .* factor2 + addend in a single tensor operation, with the
+// same broadcasting rules as ElementTimes and Plus. This node is not meant to
+// be written in network descriptions; it is created by the graph optimizer
+// when it collapses an ElementTimes that feeds a Plus into one kernel
+// (ComputationNetwork::FuseElementwiseChains()).
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class FusedMultiplyAddNode : public ComputationNode<ElemType>, public NumInputs<3>
+{
+    typedef ComputationNode<ElemType> Base;
+    UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName()
+    {
+        return L"FusedMultiplyAdd";
+    }
+
+public:
+    DeclareConstructorFromConfigWithNumInputs(FusedMultiplyAddNode);
+    FusedMultiplyAddNode(DEVICEID_TYPE deviceId, const wstring& name)
+        : Base(deviceId, name)
+    {
+    }
+
+    virtual void /*IComputationNode::*/ BeginForwardProp() override
+    {
+        Base::BeginForwardProp();
+        // we switch result to dense as a work-around because ColumnSlice doesn't support all the sparse formats
+        Value().SwitchToMatrixType(MatrixType::DENSE, MatrixFormat::matrixFormatDense, false);
+    }
+
+    virtual void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
+    {
+        size_t rank = DetermineElementwiseTensorRank();
+        auto result = ValueTensorFor(rank, fr);
+        auto input0 = Input(0)->ValueTensorFor(rank, fr.AllowBroadcast());
+        auto input1 = Input(1)->ValueTensorFor(rank, fr.AllowBroadcast());
+        auto input2 = Input(2)->ValueTensorFor(rank, fr.AllowBroadcast());
+        result.AssignMultiplyAndAddOf(input0, input1, input2);
+    }
+
+    virtual void /*ComputationNode::*/ BackpropTo(const size_t inputIndex, const FrameRange& fr) override
+    {
+        size_t rank = DetermineElementwiseTensorRank();
+        auto gradient = GradientTensorFor(rank, fr);
+        auto inputGradient = Input(inputIndex)->GradientTensorFor(rank, fr.AllowBroadcast());
+
+        // if reduction then mask the respective input(s) (zero out the gaps)
+        if (Input(inputIndex)->ReducesInTimeWrt(shared_from_this()))
+            MaskMissingGradientColumnsToZero(fr);
+
+        if (inputIndex < 2) // factor: gradient of the product term, same as ElementTimesNode
+        {
+            auto otherInputValue = Input(1 - inputIndex)->ValueTensorFor(rank, fr.AllowBroadcast());
+            if (Input(inputIndex)->ReducesInTimeWrt(Input(1 - inputIndex)))
+                Input(1 - inputIndex)->MaskMissingValueColumnsToZero(fr);
+            inputGradient.AddElementwiseProductOf(gradient, otherInputValue);
+        }
+        else // addend: plain pass-through, same as PlusNode
+            inputGradient.AddCopyOf(gradient);
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override
+    {
+        // The FusedMultiplyAddNode does not require its output value for computing
+        // the gradients of its input nodes
+        return false;
+    }
+
+    virtual bool InputUsedInComputingInputNodesGradients(size_t childIndex) const override
+    {
+        // the factors need each other's value; the addend's gradient is a plain copy
+        return childIndex < 2;
+    }
+
+    virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        InferMBLayoutFromInputsForStandardCase();
+
+        if (isFinalValidationPass)
+            for (size_t i = 1; i < GetNumInputs(); i++)
+                if (Input(i)->HasMBLayout() && Input(0)->HasMBLayout() && Input(i)->GetMBLayout() != Input(0)->GetMBLayout())
+                    LogicError("MB layouts in the %ls %ls operation do not match.", NodeName().c_str(), OperationName().c_str());
+
+        // result has tensor shape with dimensions being the max over all three inputs.
+        // This is ValidateBinaryZip's broadcasting rule extended to three operands
+        // (there is no n-ary counterpart in ComputationNodeBase). Dimension inference
+        // is not needed here since the optimizer only fuses fully validated subgraphs.
+        SmallVector<size_t> dims = GetInputSampleLayout(0).GetDims();
+        for (size_t i = 1; i < GetNumInputs(); i++)
+        {
+            let shape = GetInputSampleLayout(i);
+            if (shape.GetRank() > dims.size())
+                dims.resize(shape.GetRank(), 1); // pad with ones
+            for (size_t k = 0; k < shape.GetRank(); k++)
+            {
+                size_t dim = shape[k];
+                if (dims[k] == 1)  // accumulated shape is broadcasting?
+                    dims[k] = dim; // then use dimension we broadcast to
+                else if (dim == 1) // if [i] is broadcasting
+                    ;              // dims is already correct
+                else if (isFinalValidationPass && dim != dims[k]) // no broadcasting: they must match
+                    InvalidArgument("%ls %ls operation: Input dimensions [%s] and [%s] are not compatible.",
+                                    NodeName().c_str(), OperationName().c_str(), string(TensorShape(dims)).c_str(), string(shape).c_str());
+            }
+        }
+
+        SetDims(TensorShape(dims), HasMBLayout());
+    }
+};
+
+template class FusedMultiplyAddNode<float>;
+template class FusedMultiplyAddNode<double>;
+
+// -----------------------------------------------------------------------
+// FusedSumActivationNode (summand1, summand2)
+// Computes activation(summand1 + summand2) in a single traversal of the operands.
+// Created by the graph optimizer (ComputationNetwork::FuseSumActivationChains(), see
+// EnableGraphOptimizations()) when it collapses a Plus -> Sigmoid/Tanh/RectifiedLinear
+// chain; there is no BrainScript/NDL syntax for it. The forward pass records the sum
+// through TensorView's lazy chain and folds the activation into it, so the whole node
+// executes as one fused opcode (e.g. opSigmoidOfSum) -- one kernel launch on GPU, one
+// cache pass over the operands on CPU. The gradient is defined (activation derivative
+// from the output value, the sum passes it through), so fused networks stay trainable.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class FusedSumActivationNode : public ComputationNode<ElemType>, public NumInputs<2>
+{
+    typedef ComputationNode<ElemType> Base;
+    UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName()
+    {
+        return L"FusedSumActivation";
+    }
+
+public:
+    DeclareConstructorFromConfigWithNumInputs(FusedSumActivationNode);
+    FusedSumActivationNode(DEVICEID_TYPE deviceId, const wstring& name, ElementWiseOperator activation = ElementWiseOperator::opSigmoid)
+        : Base(deviceId, name), m_activation(activation)
+    {
+    }
+
+    virtual void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<FusedSumActivationNode<ElemType>>(nodeP);
+            node->m_activation = m_activation;
+        }
+    }
+
+    virtual void Save(File& fstream) const override
+    {
+        Base::Save(fstream);
+        fstream << (int) m_activation;
+    }
+
+    virtual void Load(File& fstream, size_t modelVersion) override
+    {
+        Base::Load(fstream, modelVersion);
+        int activation;
+        fstream >> activation;
+        m_activation = (ElementWiseOperator) activation;
+    }
+
+    virtual void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
+    {
+        size_t rank = DetermineElementwiseTensorRank();
+        auto result = ValueTensorFor(rank, fr);
+        auto input0 = Input(0)->ValueTensorFor(rank, fr.AllowBroadcast());
+        auto input1 = Input(1)->ValueTensorFor(rank, fr.AllowBroadcast());
+        // record the sum lazily, fold the activation into the record, run the chain as one op
+        result.DeferBinaryOpOf(input0, input1, 1.0f, ElementWiseOperator::opSum);
+        result.DeferUnaryOp(m_activation);
+        result.Materialize();
+    }
+
+    virtual void /*ComputationNode::*/ BackpropTo(const size_t inputIndex, const FrameRange& fr) override
+    {
+        size_t rank = DetermineElementwiseTensorRank();
+        auto gradient = GradientTensorFor(rank, fr);
+        auto inputGradient = Input(inputIndex)->GradientTensorFor(rank, fr.AllowBroadcast());
+
+        // if reduction then mask the respective input (zero out the gaps)
+        if (Input(inputIndex)->ReducesInTimeWrt(shared_from_this()))
+            MaskMissingGradientColumnsToZero(fr);
+
+        // the sum passes the gradient through unchanged; the activation derivative is
+        // computed from the output value, exactly as in the unfused activation node
+        auto outputValue = ValueTensorFor(rank, fr);
+        inputGradient.DoBinaryOpOf(1.0f, gradient, outputValue, 1.0f, BackwardOp());
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override
+    {
+        return true; // the activation derivative is computed from the output
+    }
+
+    virtual bool InputUsedInComputingInputNodesGradients(size_t /*childIndex*/) const override
+    {
+        return false;
+    }
+
+    virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
+    {
+        ValidateBinaryZip(isFinalValidationPass, true /*allowBroadcast*/);
+    }
+
+private:
+    // gradient opcode matching m_activation, the same one the unfused node would use
+    ElementWiseOperator BackwardOp() const
+    {
+        switch (m_activation)
+        {
+        case ElementWiseOperator::opSigmoid:
+            return ElementWiseOperator::opElementwiseProductWithSigmoidDerivativeFromOutput;
+        case ElementWiseOperator::opTanh:
+            return ElementWiseOperator::opElementwiseProductWithTanhDerivativeFromOutput;
+        case ElementWiseOperator::opLinearRectifier:
+            return ElementWiseOperator::opElementwiseProductWithLinearRectifierDerivativeFromOutput;
+        default:
+            LogicError("%ls %ls operation has an unexpected activation opcode (%d).", NodeName().c_str(), OperationName().c_str(), (int) m_activation);
+        }
+    }
+
+    ElementWiseOperator m_activation; // opSigmoid, opTanh, or opLinearRectifier
+};
+
+template class FusedSumActivationNode<float>;
+template class FusedSumActivationNode<double>;
+
 // -----------------------------------------------------------------------
 // DiagTimesNode (vector representing the diagonal of a square matrix, data)
 // -----------------------------------------------------------------------
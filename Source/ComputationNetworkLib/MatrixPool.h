@@ -8,31 +8,110 @@
 #include <string>
 #include <stdexcept>
 #include <vector>
+#include <map>
+#include <utility>
+#include <atomic>
 #include <algorithm>
 #include <stdlib.h>
 
 #include "Basics.h"
 #include "Matrix.h"
+#include "GPUWatcher.h" // for the actual free-memory numbers in PrintAllocationReport()
 #include "ComputationNode.h"
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
 class MatrixPool
 {
-    vector<shared_ptr<Matrix<float>>> m_releasedFloatMatrices;
-    vector<shared_ptr<Matrix<double>>> m_releasedDoubleMatrices;
+    // Released matrices are bucketed by device id and by element count rounded up to the next
+    // power of two, so that a request is satisfied from the smallest released buffer that fits
+    // rather than from whatever happened to be released last. Handing a large activation buffer
+    // to a node that needs a tiny one forces a Resize and the re-allocation churn we pool to avoid.
+    typedef std::pair<DEVICEID_TYPE, size_t> BucketKey; // (device id, bucketed element count)
+
+    std::map<BucketKey, vector<shared_ptr<Matrix<float>>>> m_releasedFloatMatrices;
+    std::map<BucketKey, vector<shared_ptr<Matrix<double>>>> m_releasedDoubleMatrices;
+
+    // Access is guarded by a spin lock rather than a mutex: the critical sections are a handful
+    // of pointer operations, and parallel evaluation paths hit the pool from several threads.
+    mutable std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
+
+    class SpinLockGuard
+    {
+        std::atomic_flag& m_flag;
+
+    public:
+        SpinLockGuard(std::atomic_flag& flag)
+            : m_flag(flag)
+        {
+            while (m_flag.test_and_set(std::memory_order_acquire))
+                ;
+        }
+        ~SpinLockGuard()
+        {
+            m_flag.clear(std::memory_order_release);
+        }
+    };
+
+    static size_t BucketOf(size_t numElements)
+    {
+        size_t bucket = 1;
+        while (bucket < numElements)
+            bucket <<= 1;
+        return bucket;
+    }
 
     template <class ElemType>
-    vector<shared_ptr<Matrix<ElemType>>>& GetReleasedMatrices();
+    std::map<BucketKey, vector<shared_ptr<Matrix<ElemType>>>>& GetReleasedMatrices();
+
+    // Allocation diagnostics: every matrix handed out is remembered together with the node
+    // that requested it (as weak_ptrs, so the pool keeps nothing alive), which lets
+    // PrintAllocationReport() attribute live device bytes to nodes when memory blows up.
+    template <class ElemType>
+    struct Attribution
+    {
+        std::wstring owner; // name of the node the matrix was (last) handed to
+        std::weak_ptr<Matrix<ElemType>> matrix;
+    };
+
+    std::map<const void*, Attribution<float>> m_floatAttributions; // key: address of the matrix object
+    std::map<const void*, Attribution<double>> m_doubleAttributions;
+    size_t m_minFreeDeviceBytes = (size_t) -1; // low-water mark of free device memory, sampled at every report
+
+    template <class ElemType>
+    std::map<const void*, Attribution<ElemType>>& GetAttributions();
+
+    // accumulate the current buffer bytes of every live attributed matrix into bytesPerOwner,
+    // dropping entries whose matrix is gone; also reports the device the matrices live on
+    template <class ElemType>
+    void TallyAttributions(std::map<std::wstring, size_t>& bytesPerOwner, DEVICEID_TYPE& deviceId)
+    {
+        auto& attributions = GetAttributions<ElemType>();
+        for (auto iter = attributions.begin(); iter != attributions.end();)
+        {
+            auto matrixPtr = iter->second.matrix.lock();
+            if (!matrixPtr)
+            {
+                iter = attributions.erase(iter);
+                continue;
+            }
+            bytesPerOwner[iter->second.owner] += matrixPtr->BufferSize();
+            if (matrixPtr->GetDeviceId() >= 0)
+                deviceId = matrixPtr->GetDeviceId();
+            ++iter;
+        }
+    }
 
 public:
     // release here means the matrix can be put back and shared by others
     template <class ElemType>
     void Release(shared_ptr<Matrix<ElemType>> freeMatrix)
     {
-        vector<shared_ptr<Matrix<ElemType>>>& releasedMatrices = GetReleasedMatrices<ElemType>();
         if (freeMatrix == nullptr || freeMatrix->GetMatrixType() == SPARSE)
             RuntimeError("MatrixPool::Release: freeMatrix should not be null or sparse.");
+
+        SpinLockGuard lock(m_lock);
+        auto& releasedMatrices = GetReleasedMatrices<ElemType>()[BucketKey(freeMatrix->GetDeviceId(), BucketOf(freeMatrix->GetNumElements()))];
 #ifdef _DEBUG
         for (int i = 0; i < releasedMatrices.size(); i++)
         {
@@ -44,25 +123,82 @@ public:
         releasedMatrices.push_back(freeMatrix);
     }
 
+    // request a matrix for the given device; numElements is a hint of the size the caller will
+    // Resize() it to (0 if unknown), used to pick the smallest released buffer that fits;
+    // 'owner' (typically the requesting node's name) is recorded for allocation diagnostics
     template <class ElemType>
-    shared_ptr<Matrix<ElemType>> Request(DEVICEID_TYPE deviceId)
+    shared_ptr<Matrix<ElemType>> Request(DEVICEID_TYPE deviceId, size_t numElements = 0, const std::wstring& owner = std::wstring())
     {
-        vector<shared_ptr<Matrix<ElemType>>>& releasedMatrices = GetReleasedMatrices<ElemType>();
         shared_ptr<Matrix<ElemType>> matrixPtr;
-        if (releasedMatrices.empty())
-        {
-            matrixPtr = make_shared<Matrix<ElemType>>(deviceId);
-        }
-        else
         {
-            matrixPtr = releasedMatrices.back();
-            releasedMatrices.pop_back();
+            SpinLockGuard lock(m_lock);
+            auto& buckets = GetReleasedMatrices<ElemType>();
+            // walk the buckets for this device from the smallest one that can hold the request upward
+            auto iter = buckets.lower_bound(BucketKey(deviceId, BucketOf(numElements)));
+            for (; iter != buckets.end() && iter->first.first == deviceId; ++iter)
+            {
+                if (!iter->second.empty())
+                {
+                    matrixPtr = iter->second.back();
+                    iter->second.pop_back();
+                    break;
+                }
+            }
         }
 
+        if (!matrixPtr)
+            matrixPtr = make_shared<Matrix<ElemType>>(deviceId);
+
         if (!matrixPtr) // this can't really happen
             LogicError("MatrixPool::Request: failed to get a valid matrix.");
 
+        if (!owner.empty())
+        {
+            SpinLockGuard lock(m_lock);
+            auto& attribution = GetAttributions<ElemType>()[matrixPtr.get()]; // a re-requested matrix moves to its new owner
+            attribution.owner = owner;
+            attribution.matrix = matrixPtr;
+        }
+
         return matrixPtr;
     }
+
+    // print the live buffer bytes attributed to each requesting node (largest consumers
+    // first) plus the device's actual free memory per GPUWatcher, and track the free-memory
+    // low-water mark across calls. Called per epoch and when an allocation fails, so memory
+    // blowups can be pinned to a node instead of bisecting the network definition.
+    void PrintAllocationReport(size_t maxNodesToPrint = 20)
+    {
+        std::map<std::wstring, size_t> bytesPerOwner;
+        DEVICEID_TYPE deviceId = CPUDEVICE;
+        {
+            SpinLockGuard lock(m_lock);
+            TallyAttributions<float>(bytesPerOwner, deviceId);
+            TallyAttributions<double>(bytesPerOwner, deviceId);
+        }
+
+        std::vector<std::pair<size_t, std::wstring>> ranked;
+        size_t totalBytes = 0;
+        for (const auto& iter : bytesPerOwner)
+        {
+            ranked.push_back(std::make_pair(iter.second, iter.first));
+            totalBytes += iter.second;
+        }
+        std::sort(ranked.begin(), ranked.end(), std::greater<std::pair<size_t, std::wstring>>());
+
+        fprintf(stderr, "MatrixPool: %.1f MB in %lu pooled matrices; top consumers:\n",
+                totalBytes / 1048576.0, (unsigned long) bytesPerOwner.size());
+        for (size_t i = 0; i < ranked.size() && i < maxNodesToPrint; i++)
+            fprintf(stderr, "\t%10.1f MB  %ls\n", ranked[i].first / 1048576.0, ranked[i].second.c_str());
+
+        if (deviceId >= 0)
+        {
+            size_t freeBytes = GPUWatcher::GetFreeMemoryOnCUDADevice(deviceId);
+            if (freeBytes < m_minFreeDeviceBytes)
+                m_minFreeDeviceBytes = freeBytes;
+            fprintf(stderr, "MatrixPool: %.1f MB free on device %d (low-water mark %.1f MB)\n",
+                    freeBytes / 1048576.0, (int) deviceId, m_minFreeDeviceBytes / 1048576.0);
+        }
+    }
 };
 } } }
@@ -76,6 +76,12 @@ public:
     {
         return !gradientFromOutput;
     }
+    virtual bool SupportsForwardPropInPlace() const override
+    {
+        // The op is elementwise with matching input/output layout, so overwriting the input is fine
+        // as long as backprop reads the output rather than the input (which rules out e.g. Cos()).
+        return gradientFromOutput;
+    }
 };
 
 #define UnaryElementWiseWithOpCodeNodeBaseMembers UsingComputationNodeMembersBoilerplate;
@@ -120,6 +126,114 @@ DeclareUnaryElementWiseWithOpCodeNode(Cosine, Cosine, ElementwiseProductWithCosD
 
 #pragma pop_macro("DeclareUnaryTensorOp")
 
+// -----------------------------------------------------------------------
+// FusedTimesBiasActivationNode (W, x, bias)
+// computes f(W * x + bias) -- matrix product, per-row bias broadcast and elementwise
+// activation -- in one fused kernel pass over the output (Matrix::MultiplyAddBiasAndApply())
+// instead of three separate sweeps over the minibatch output. Like FusedMultiplyAddNode,
+// this node is not meant to be written in network descriptions; it is created by the graph
+// optimizer when it collapses a Times -> Plus -> Sigmoid/Tanh/RectifiedLinear chain
+// (ComputationNetwork::FuseTimesBiasActivationChains()). The fused kernel exists for the
+// dense CPU path only, and the node is evaluation-only: the optimizer runs in the read-only
+// actions, and no gradient is defined.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class FusedTimesBiasActivationNode : public ComputationNode<ElemType>, public NumInputs<3>
+{
+    typedef ComputationNode<ElemType> Base;
+    UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName()
+    {
+        return L"FusedTimesBiasActivation";
+    }
+
+public:
+    DeclareConstructorFromConfigWithNumInputs(FusedTimesBiasActivationNode);
+    FusedTimesBiasActivationNode(DEVICEID_TYPE deviceId, const wstring& name, ElementWiseOperator activation = ElementWiseOperator::opCopy)
+        : Base(deviceId, name), m_activation(activation)
+    {
+    }
+
+    virtual void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<FusedTimesBiasActivationNode<ElemType>>(nodeP);
+            node->m_activation = m_activation;
+        }
+    }
+
+    virtual void Save(File& fstream) const override
+    {
+        Base::Save(fstream);
+        fstream << (int) m_activation;
+    }
+
+    virtual void Load(File& fstream, size_t modelVersion) override
+    {
+        Base::Load(fstream, modelVersion);
+        int activation;
+        fstream >> activation;
+        m_activation = (ElementWiseOperator) activation;
+    }
+
+    virtual void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
+    {
+        // right operand and output can have MB layout, while the weight and the bias cannot
+        auto sliceInput1Value = Input(1)->ValueFor(fr);
+        auto sliceOutputValue = ValueFor(fr);
+        Matrix<ElemType>::MultiplyAddBiasAndApply((ElemType) 1, Input(0)->ValueAsMatrix(), false, sliceInput1Value, false,
+                                                  (ElemType) 0, sliceOutputValue, Input(2)->ValueAsMatrix(), m_activation);
+    }
+
+    virtual void /*ComputationNode::*/ BackpropTo(const size_t /*inputIndex*/, const FrameRange& /*fr*/) override
+    {
+        LogicError("%ls %ls operation is created by the graph optimizer for evaluation only; no gradient is defined.",
+                   NodeName().c_str(), OperationName().c_str());
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override
+    {
+        return false;
+    }
+    virtual bool InputUsedInComputingInputNodesGradients(size_t /*childIndex*/) const override
+    {
+        return false;
+    }
+
+    virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        InferMBLayoutFromInputsForStandardCase();
+
+        // dimensions work like Times (W: [m x k], x: [k] per sample) plus an [m x 1] bias;
+        // dimension inference is not needed here since the optimizer only fuses fully
+        // validated subgraphs
+        size_t rows0 = Input(0)->GetAsMatrixNumRows(), cols0 = Input(0)->GetAsMatrixNumCols();
+        if (isFinalValidationPass)
+        {
+            if (Input(0)->HasMBLayout() || !Input(1)->HasMBLayout() || Input(2)->HasMBLayout())
+                InvalidArgument("%ls %ls operation requires a weight and a bias without minibatch data and an input with it.",
+                                NodeName().c_str(), OperationName().c_str());
+            if (cols0 != Input(1)->GetSampleMatrixNumRows())
+                InvalidArgument("The inner matrix dimension in the %ls %ls operation does not match (%d vs. %d).",
+                                NodeName().c_str(), OperationName().c_str(), (int) Input(1)->GetSampleMatrixNumRows(), (int) cols0);
+            if (Input(2)->GetAsMatrixNumRows() != rows0 || Input(2)->GetAsMatrixNumCols() != 1)
+                InvalidArgument("The bias of the %ls %ls operation must be a column vector with as many rows as the weight (%d).",
+                                NodeName().c_str(), OperationName().c_str(), (int) rows0);
+        }
+        SetDims(TensorShape(rows0), true);
+    }
+
+private:
+    ElementWiseOperator m_activation; // opCopy, opSigmoid, opTanh or opLinearRectifier
+};
+
+template class FusedTimesBiasActivationNode<float>;
+template class FusedTimesBiasActivationNode<double>;
+
 // -----------------------------------------------------------------------
 // SoftmaxNodeBase (input) -- shared base of Softmax and LogSoftmax
 // -----------------------------------------------------------------------
@@ -83,7 +83,7 @@ protected:
 //  - ranges of neighbor frames as a secondary tensor dimension (i.e. can be used to implement a rolling window)
 //  - full support/efficiency of non-recurrent use (in which case the range can be from negative to positive, e.g. a symmetric rolling window)
 //  - denoting which tensor dimension to loop over (this may not be completed, but I will plant a seed)
-//  - support for Yongqiang�s sub-minibatching with truncated BPTT (export/import state)
+//  - support for Yongqiang�s sub-minibatching with truncated BPTT (export/import state)
 //  - more efficient storage of carried-over state (only store the needed frames, not a full copy of the previous MB as currently; which will on the other hand also allow windows that reach back beyond a minibatch)
 // -----------------------------------------------------------------------
 
@@ -248,16 +248,21 @@ public:
     {
         // In truncated BPTT, we carry over left-to-right state across minibatches.
         // It is kept in m_delayedValue, m_delayedActivationMBLayout.
-        // This could be optimized as follows:
-        //  - only keep the required number of frames (m_timeStep)
-        //  - we don't need to keep anything in full-sequence mode
-        //  - we don't need to keep anything if all sequences are closed (sentence end)
-        //    This condition includes full-sequence mode.
-        // TODO: Can we optimize this and only copy if there is a sequence spanning across the end of the MB? And add a check to BeginForwardProp() to make sure we got one if there is a boundary at the start?
-        m_delayedValue = Input(0)->Value();
-        if (!m_delayedActivationMBLayout)
-            m_delayedActivationMBLayout = make_shared<MBLayout>();
-        m_delayedActivationMBLayout->CopyFrom(m_pMBLayout);
+        // The history is only ever consulted for sequences that cross a minibatch edge, so if
+        // every sequence is fully contained in this minibatch (full-sequence mode, or truncated
+        // BPTT with all sentences closed), there is nothing to carry over and we skip the copy.
+        // That copy is a full activation-matrix copy per delay node per minibatch, which is pure
+        // overhead for LM-style training where sequences never span minibatches.
+        // This could be optimized further by only keeping the required number of frames (m_timeStep).
+        if (m_pMBLayout->HasSequenceBeyondEnd() || m_pMBLayout->HasSequenceBeyondBegin())
+        {
+            m_delayedValue = Input(0)->Value();
+            if (!m_delayedActivationMBLayout)
+                m_delayedActivationMBLayout = make_shared<MBLayout>();
+            m_delayedActivationMBLayout->CopyFrom(m_pMBLayout);
+        }
+        // (when skipping, m_delayedValue/m_delayedActivationMBLayout are left as a consistent
+        // pair from the last minibatch that actually had a crossing sequence, or empty)
 
         Base::EndForwardProp();
     }
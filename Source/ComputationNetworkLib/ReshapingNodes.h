@@ -156,8 +156,18 @@ public:
         SetDims(sampleLayout, HasMBLayout());
     }
 
+    virtual bool SupportsForwardPropInPlace() const override
+    {
+        // a reshape only reinterprets the tensor dimensions; the underlying matrix geometry
+        // is unchanged, so the value can alias the input's buffer outright (the memory
+        // planner decides when that is safe)
+        return true;
+    }
+
     virtual void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
     {
+        if (IsForwardPropInPlace()) // value aliases the input's buffer; nothing to copy
+            return;
         ValueFor(fr).SetValue(Input(0)->ValueFor(fr));
     }
 
@@ -324,8 +334,18 @@ public:
         return false;
     }
 
+    virtual bool SupportsForwardPropInPlace() const override
+    {
+        // Only the degenerate full-height slice is a pure view over the input. A proper row
+        // range is strided over the column-major storage (one block per column), which the
+        // packed Matrix cannot alias, so it must be copied out.
+        return m_startIndex == 0 && m_sliceHeight == Input(0)->GetSampleMatrixNumRows();
+    }
+
     virtual void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
     {
+        if (IsForwardPropInPlace()) // full-height slice aliasing the input's buffer; nothing to copy
+            return;
         ValueFor(fr).AssignRowSliceValuesOf(Input(0)->ValueFor(fr), m_startIndex, m_sliceHeight);
     }
 
@@ -583,6 +603,191 @@ private:
 template class RowRepeatNode<float>;
 template class RowRepeatNode<double>;
 
+// -----------------------------------------------------------------------
+// RowGatherNode (input, indices) -- select arbitrary rows of the input
+// The second input holds row indices into the first (stored as ElemType); unlike RowSlice,
+// the selected rows need not be contiguous, and the indices may change with every minibatch
+// (e.g. sampled candidate classes, or attention positions when the index input carries an
+// MBLayout and thus per-frame indices). The index input receives no gradient; the data
+// input's gradient is formed by scatter-add, so repeated indices accumulate correctly.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class RowGatherNode : public ComputationNode<ElemType>, public NumInputs<2>
+{
+    typedef ComputationNode<ElemType> Base;
+    UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName()
+    {
+        return L"RowGather";
+    }
+
+public:
+    RowGatherNode(DEVICEID_TYPE deviceId, const wstring& name)
+        : Base(deviceId, name)
+    {
+    }
+    RowGatherNode(const ScriptableObjects::IConfigRecordPtr configp)
+        : RowGatherNode(configp->Get(L"deviceId"), L"<placeholder>")
+    {
+        AttachInputs(configp, this->GetExpectedNumInputs());
+    }
+
+    virtual void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
+    {
+        ValueFor(fr).AssignRowGatherOf(IndicesFor(fr), Input(0)->ValueFor(fr));
+    }
+
+    virtual void /*ComputationNode::*/ BackpropTo(const size_t inputIndex, const FrameRange& fr) override
+    {
+        if (inputIndex == 0) // the index input (1) is not differentiable
+            Input(0)->GradientFor(fr).AddRowScatterOf(IndicesFor(fr), GradientFor(fr));
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override
+    {
+        return false;
+    }
+
+    virtual bool InputUsedInComputingInputNodesGradients(size_t childIndex) const override
+    {
+        return childIndex == 1; // the indices are needed to route the gradient back
+    }
+
+    virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        InferMBLayoutFromInputsForStandardCase();
+
+        if (isFinalValidationPass && !Input(0)->GetSampleLayout().IsColumnVector() && !Input(0)->GetSampleLayout().IsVectorStoredAsImage() /*legacy*/)
+            RuntimeError("%ls %ls operation: Input must be a vector, tensor shape [%s] not allowed.", NodeName().c_str(), OperationName().c_str(), string(Input(0)->GetSampleLayout()).c_str());
+        if (isFinalValidationPass && !Input(1)->GetSampleLayout().IsColumnVector())
+            RuntimeError("%ls %ls operation: the index input must be a column vector of row indices.", NodeName().c_str(), OperationName().c_str());
+
+        SetDims(TensorShape(Input(1)->GetSampleMatrixNumRows()), HasMBLayout());
+    }
+
+private:
+    // the index input's minibatch view: sliced like the data when it carries an MBLayout
+    // (per-frame indices), the whole (single-column) matrix when it does not
+    Matrix<ElemType> IndicesFor(const FrameRange& fr)
+    {
+        if (Input(1)->HasMBLayout())
+            return Input(1)->ValueFor(fr);
+        else
+            return Input(1)->Value().ColumnSlice(0, Input(1)->Value().GetNumCols());
+    }
+};
+
+template class RowGatherNode<float>;
+template class RowGatherNode<double>;
+
+// -----------------------------------------------------------------------
+// RowScatterNode (input, indices) -- distribute the input's rows into a taller output
+// The inverse of RowGather: row i of the input lands in row indices(i) of the output, whose
+// height is given by the numRows parameter; untouched rows are zero, and repeated indices
+// accumulate. Backward gathers the output gradient's rows back, so the pair gives exactly
+// transposed data movement without the sparse selection-matrix multiply it replaces.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class RowScatterNode : public ComputationNode<ElemType>, public NumInputs<2>
+{
+    typedef ComputationNode<ElemType> Base;
+    UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName()
+    {
+        return L"RowScatter";
+    }
+
+public:
+    RowScatterNode(DEVICEID_TYPE deviceId, const wstring& name, size_t numRows = 0)
+        : Base(deviceId, name),
+          m_numTargetRows(numRows)
+    {
+    }
+    RowScatterNode(const ScriptableObjects::IConfigRecordPtr configp)
+        : RowScatterNode(configp->Get(L"deviceId"), L"<placeholder>", configp->Get(L"numRows"))
+    {
+        AttachInputs(configp, this->GetExpectedNumInputs());
+    }
+
+    virtual void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<RowScatterNode<ElemType>>(nodeP);
+            node->m_numTargetRows = m_numTargetRows;
+        }
+    }
+
+    virtual void Save(File& fstream) const override
+    {
+        Base::Save(fstream);
+        fstream << m_numTargetRows;
+    }
+
+    virtual void Load(File& fstream, size_t modelVersion) override
+    {
+        Base::Load(fstream, modelVersion);
+        fstream >> m_numTargetRows;
+    }
+
+    virtual void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
+    {
+        auto result = ValueFor(fr);
+        result.SetValue(0); // rows that no index points to stay zero
+        result.AddRowScatterOf(IndicesFor(fr), Input(0)->ValueFor(fr));
+    }
+
+    virtual void /*ComputationNode::*/ BackpropTo(const size_t inputIndex, const FrameRange& fr) override
+    {
+        if (inputIndex == 0) // the index input (1) is not differentiable
+            Input(0)->GradientFor(fr).AddWithRowGatherOf(IndicesFor(fr), GradientFor(fr));
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override
+    {
+        return false;
+    }
+
+    virtual bool InputUsedInComputingInputNodesGradients(size_t childIndex) const override
+    {
+        return childIndex == 1; // the indices are needed to route the gradient back
+    }
+
+    virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        InferMBLayoutFromInputsForStandardCase();
+
+        if (isFinalValidationPass && !Input(0)->GetSampleLayout().IsColumnVector() && !Input(0)->GetSampleLayout().IsVectorStoredAsImage() /*legacy*/)
+            RuntimeError("%ls %ls operation: Input must be a vector, tensor shape [%s] not allowed.", NodeName().c_str(), OperationName().c_str(), string(Input(0)->GetSampleLayout()).c_str());
+        if (isFinalValidationPass && Input(1)->GetSampleMatrixNumRows() != Input(0)->GetSampleMatrixNumRows())
+            RuntimeError("%ls %ls operation: the index input must hold one row index per input row.", NodeName().c_str(), OperationName().c_str());
+        if (isFinalValidationPass && m_numTargetRows == 0)
+            RuntimeError("%ls %ls operation: numRows must be specified.", NodeName().c_str(), OperationName().c_str());
+
+        SetDims(TensorShape(m_numTargetRows), HasMBLayout());
+    }
+
+private:
+    // see RowGatherNode::IndicesFor()
+    Matrix<ElemType> IndicesFor(const FrameRange& fr)
+    {
+        if (Input(1)->HasMBLayout())
+            return Input(1)->ValueFor(fr);
+        else
+            return Input(1)->Value().ColumnSlice(0, Input(1)->Value().GetNumCols());
+    }
+
+    size_t m_numTargetRows;
+};
+
+template class RowScatterNode<float>;
+template class RowScatterNode<double>;
+
 // -----------------------------------------------------------------------
 // DiagonalNode -- extract diagonal elements of a square matrix into a row vector
 // -----------------------------------------------------------------------
@@ -637,9 +842,13 @@ public:
 
         // BUGBUG: This should use the memshare mechanism.
         // TODO: use tensor lib, then this will be easy, no memsharing needed
-        Matrix<ElemType> diag(gradientValues.GetNumRows(), gradientValues.GetNumCols(), gradientValues.GetDeviceId());
-        diag = gradientValues;
-        diag.Resize(gradientValues.GetNumCols(), 1);
+        size_t dim = gradientValues.GetNumCols();
+        bool useScratch = (gradientValues.GetDeviceId() == CPUDEVICE); // the scratch arena is CPU-side
+        Matrix<ElemType> diag = useScratch
+                                    ? Matrix<ElemType>(gradientValues.GetNumRows(), dim, Base::RequestScratchSpace(dim), matrixFlagDontOwnBuffer, CPUDEVICE)
+                                    : Matrix<ElemType>(gradientValues.GetNumRows(), dim, gradientValues.GetDeviceId());
+        diag.SetValue(gradientValues); // dimensions already match, so this does not reallocate
+        diag.Resize(dim, 1);
 
         inputGradientValues.SetValue(0);
         // BUGBUG: Must *add* to gradient!
@@ -138,14 +138,17 @@ public:
         // left input is scalar
         if (inputIndex == 0) // left derivative
         {
+            if (HasIndexedLabels())
+                LogicError("CrossEntropyWithSoftmaxNode: gradient w.r.t. index-valued labels is not defined.");
 #if DUMPOUTPUT
-            *m_logSoftmaxOfRight.Print("CrossEntropyWithSoftmax Partial-logSoftmaxOfRight");
             Gradient().Print("CrossEntropyWithSoftmax Partial-gradientValues");
             Input(0)->GradientFor(fr).Print("CrossEntropyWithSoftmaxNode Partial-Left-in");
 #endif
 
+            // gradient += -Gradient() * logsoftmax(right), with the log-softmax reconstructed
+            // from the per-column statistics saved in the forward pass
             auto gradient = Input(0)->GradientFor(fr);
-            Matrix<ElemType>::Multiply1x1AndWeightedAdd(-1.0f, Gradient() /*1x1*/, *m_logSoftmaxOfRight, 1.0f, gradient);
+            Matrix<ElemType>::AddScaledLogSoftmax((ElemType) -1, Gradient() /*1x1*/, Input(1)->ValueFor(fr), *m_softmaxStats, gradient);
 #if DUMPOUTPUT
             Input(0)->GradientFor(fr).Print("CrossEntropyWithSoftmaxNode Partial-Left-out");
 #endif
@@ -154,14 +157,17 @@ public:
         else if (inputIndex == 1) // right derivative
         {
 #if DUMPOUTPUT
-            *m_softmaxOfRight.Print("CrossEntropyWithSoftmax Partial-softmaxOfRight");
             Input(0)->ValueFor(fr).Print("CrossEntropyWithSoftmax Partial-inputFunctionValues");
             Gradient().Print("CrossEntropyWithSoftmax Partial-gradientValues");
             Input(1)->GradientFor(fr).Print("CrossEntropyWithSoftmaxNode Partial-Right-in");
 #endif
 
+            // gradient += Gradient() * (softmax(right) - labels), in one pass
             auto gradient = Input(1)->GradientFor(fr);
-            Matrix<ElemType>::AddScaledDifference(Gradient(), *m_softmaxOfRight, Input(0)->ValueFor(fr), gradient);
+            if (HasIndexedLabels())
+                Matrix<ElemType>::AddScaledIndexedSoftmaxDifference(Gradient(), Input(1)->ValueFor(fr), *m_softmaxStats, *m_maskedLabelIndexes, gradient);
+            else // the validity mask makes the kernel skip gap columns, like the indexed variant does via its -1 indices
+                Matrix<ElemType>::AddScaledSoftmaxDifference(Gradient(), Input(1)->ValueFor(fr), *m_softmaxStats, Input(0)->ValueFor(fr), gradient, ColumnsValidityMaskPtr());
 #if DUMPOUTPUT
             Input(1)->GradientFor(fr).Print("CrossEntropyWithSoftmaxNode Partial-Right");
 #endif
@@ -178,23 +184,32 @@ public:
 
     virtual void UpdateFunctionMBSize() override
     {
-        m_logSoftmaxOfRight->Resize(Input(1)->Value());
-        m_softmaxOfRight->Resize(*m_logSoftmaxOfRight);
+        m_softmaxStats->Resize(2, Input(1)->Value().GetNumCols());
     }
 
     virtual void /*ComputationNodeNonLooping::*/ ForwardPropNonLooping() override // -sum(left_i * log(softmax_i(right)))
     {
         FrameRange fr(Input(0)->GetMBLayout());
-        // first compute the softmax (column-wise)
-        // Note that we need both log and non-log for gradient computation.
-        m_logSoftmaxOfRight->AssignLogSoftmaxOf(Input(1)->ValueFor(fr), true);
-        m_softmaxOfRight->SetValue(*m_logSoftmaxOfRight);
-        m_softmaxOfRight->InplaceExp();
-        // flatten all gaps to zero, such that gaps will contribute zero to the sum
-        MaskMissingColumnsToZero(*m_logSoftmaxOfRight, Input(1)->GetMBLayout(), fr);
-        // reduce over all frames
-        Value().AssignInnerProductOfMatrices(Input(0)->MaskedValueFor(fr), *m_logSoftmaxOfRight);
-        Value() *= -1;
+        // compute softmax and criterion in a single fused pass; instead of materializing the full
+        // [dim x cols] log-softmax, only the per-column max and log partition function are kept
+        // (in m_softmaxStats), from which the backward pass reconstructs the softmax on the fly.
+        // gap columns drop out of the sum because their labels are masked to zero.
+        if (HasIndexedLabels())
+        {
+            // gap columns cannot be zero-masked here, since 0 is a valid class index; instead the
+            // index row is copied and gaps are flagged as -1, which the indexed kernels skip
+            m_maskedLabelIndexes->SetValue(Input(0)->ValueFor(fr));
+            if (Input(0)->HasMBLayout())
+                MaskMissingColumnsTo(*m_maskedLabelIndexes, Input(0)->GetMBLayout(), fr, (ElemType) -1);
+            Value().AssignIndexedCrossEntropyWithSoftmaxOf(*m_maskedLabelIndexes, Input(1)->ValueFor(fr), *m_softmaxStats);
+        }
+        else
+        {
+            // instead of zero-masking the label matrix (a full write pass over it), hand the
+            // layout's per-column validity mask to the kernel, which skips gap columns during
+            // the reduction itself
+            Value().AssignCrossEntropyWithSoftmaxOf(Input(0)->ValueFor(fr), Input(1)->ValueFor(fr), *m_softmaxStats, ColumnsValidityMaskPtr());
+        }
 #if NANCHECK
         Value().HasNan("CrossEntropyWithSoftmax");
 #endif
@@ -205,7 +220,19 @@ public:
 
     virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
     {
-        ValidateBinaryReduce(isFinalValidationPass);
+        if (HasIndexedLabels())
+        {
+            // index-label mode: dimensions intentionally differ, so skip the elementwise
+            // compatibility check of ValidateBinaryReduce and only verify the layouts match
+            Base::Validate(isFinalValidationPass);
+            m_pMBLayout = nullptr; // this node does not hold mini-batch data
+            if (isFinalValidationPass &&
+                !(Input(0)->GetMBLayout() == Input(1)->GetMBLayout() || !Input(0)->HasMBLayout() || !Input(1)->HasMBLayout()))
+                LogicError("The MB layout in the %ls %ls operation does not match.", NodeName().c_str(), OperationName().c_str());
+            SetDims(TensorShape(1), false);
+        }
+        else
+            ValidateBinaryReduce(isFinalValidationPass);
     }
 
     virtual void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
@@ -214,8 +241,8 @@ public:
         if (flags & CopyNodeFlags::copyNodeValue)
         {
             auto node = dynamic_pointer_cast<CrossEntropyWithSoftmaxNode<ElemType>>(nodeP);
-            *node->m_logSoftmaxOfRight = *m_logSoftmaxOfRight;
-            *node->m_softmaxOfRight = *m_softmaxOfRight;
+            *node->m_softmaxStats = *m_softmaxStats;
+            *node->m_maskedLabelIndexes = *m_maskedLabelIndexes;
         }
     }
 
@@ -223,13 +250,34 @@ public:
     virtual void RequestMatricesBeforeForwardProp(MatrixPool& matrixPool)
     {
         Base::RequestMatricesBeforeForwardProp(matrixPool);
-        RequestMatrixFromPool(m_logSoftmaxOfRight, matrixPool);
-        RequestMatrixFromPool(m_softmaxOfRight, matrixPool);
+        RequestMatrixFromPool(m_softmaxStats, matrixPool);
+        RequestMatrixFromPool(m_maskedLabelIndexes, matrixPool);
     }
 
 protected:
-    shared_ptr<Matrix<ElemType>> m_logSoftmaxOfRight;
-    shared_ptr<Matrix<ElemType>> m_softmaxOfRight;
+    // index-label mode: a 1-row label input against a multi-row prediction input means each
+    // label column holds the class index (not a one-hot vector), so readers can skip the
+    // dense one-hot expansion entirely
+    bool HasIndexedLabels() const
+    {
+        return Input(0)->GetSampleMatrixNumRows() == 1 && Input(1)->GetSampleMatrixNumRows() > 1;
+    }
+
+    // the layout's per-column validity mask, for the kernels to skip gap columns in place of
+    // a zero-masking write pass; null when the minibatch has no gaps
+    const Matrix<char>* ColumnsValidityMaskPtr() const
+    {
+        const MBLayoutPtr& pMBLayout = Input(0)->GetMBLayout();
+        if (!pMBLayout || !pMBLayout->HasGaps())
+            return nullptr;
+        return &pMBLayout->GetColumnsValidityMask(Input(1)->Value().GetDeviceId());
+    }
+
+    // per-column (max, log partition function) of the input, saved by the fused forward pass
+    // for reconstructing softmax values in the backward pass
+    shared_ptr<Matrix<ElemType>> m_softmaxStats;
+    // index-label mode only: copy of the label-index row with gap columns set to -1
+    shared_ptr<Matrix<ElemType>> m_maskedLabelIndexes;
 };
 
 template class CrossEntropyWithSoftmaxNode<float>;
@@ -733,7 +781,10 @@ public:
           m_softMax(deviceId),
           m_grdToSoftMaxInput(deviceId),
           m_clsLogSoftmax(deviceId),
-          m_clsSoftmax(deviceId)
+          m_clsSoftmax(deviceId),
+          m_obsGroup(deviceId),
+          m_scoresGroup(deviceId),
+          m_grdGroup(deviceId)
     {
     }
 
@@ -746,53 +797,66 @@ public:
 
         ComputeSoftMaxPartial();
 
-        Matrix<ElemType> grd_t;
-        Matrix<ElemType> grd_to_wgt_t;
+        const size_t hdSize = Input(INPUTDATA)->GetSampleMatrixNumRows();
 
-        const size_t nT = Input(LABELDATA)->GetNumTimeSteps();
-        const size_t nS = Input(LABELDATA)->GetNumParallelSequences();
-        size_t sz = 0; // iterate over the packed concatenated class-conditioned prob vectors
-        for (size_t s = 0; s < nS; s++)
-            for (size_t t = 0; t < nT; t++)
-            {
-                FrameRange fr = FrameRange(Input(LABELDATA)->GetMBLayout(), t).Sequence(s);
+        // iterate over the token groups built in the forward pass, so that the gradient GEMMs of
+        // all tokens sharing a class are batched into one GEMM per class
+        for (const auto& iter : m_classGroups)
+        {
+            const ClassGroup& group = iter.second;
+            const size_t nbr_wrd = group.nbr_wrd;
+            const size_t nbr_tok = group.tokens.size();
 
-                if (Input(LABELDATA)->GetMBLayout()->IsGap(fr)) // skip gaps
-                    continue;
+            if (inputIndex == 3)
+            {
+                // class posterior gradient is per token and cheap; no batching needed
+                for (size_t j = 0; j < nbr_tok; j++)
+                {
+                    FrameRange fr = FrameRange(Input(LABELDATA)->GetMBLayout(), group.tokens[j].t).Sequence(group.tokens[j].s);
+                    Matrix<ElemType> grd_t = Input(CLASSPROBINDATA)->GradientFor(fr);
+                    grd_t.SetValue(DataWithMBLayoutFor(m_clsSoftmax, fr, Input(CLASSPROBINDATA)->GetMBLayout()));
+                    ComputeCEPartialToSoftmaxInputs(grd_t, Gradient(), iter.first);
+                }
+                continue;
+            }
 
-                Matrix<ElemType> lbl_t = Input(LABELDATA)->ValueFor(fr);
-                size_t c_t = (size_t) lbl_t(1, 0);
-                size_t lft_bnd = (size_t) lbl_t(2, 0); // index of first word belonging to current word token's class
-                size_t rgt_bnd = (size_t) lbl_t(3, 0); // and end of that range
-                size_t nbr_wrd = (rgt_bnd - lft_bnd);  // number of words in the class
+            Matrix<ElemType> weightForClass = Input(EMBEDDINGMATRIX)->ValueAsMatrix().ColumnSlice(group.lft_bnd, nbr_wrd);
 
-                // compute prb - 1 and prb
-                Matrix<ElemType> weightForClass = Input(EMBEDDINGMATRIX)->ValueAsMatrix().ColumnSlice(lft_bnd, nbr_wrd);
-                Matrix<ElemType> obs = Input(INPUTDATA)->ValueFor(fr); // hidden activation vector for current word token
-                Matrix<ElemType> grd_to_soft_max_input = m_grdToSoftMaxInput.ColumnSlice(sz, nbr_wrd);
-                Matrix<ElemType> grd_to_cls_prob = DataWithMBLayoutFor(m_clsLogSoftmax, fr, Input(CLASSPROBINDATA)->GetMBLayout());
+            // gather the tokens' gradients w.r.t. the softmax input into one [nbr_wrd x nbr_tok]
+            // matrix (each token's slice of the packed buffer is contiguous, so it can be viewed
+            // as a column via Reshape)
+            m_grdGroup.Resize(nbr_wrd, nbr_tok);
+            for (size_t j = 0; j < nbr_tok; j++)
+            {
+                Matrix<ElemType> grd_to_soft_max_input = m_grdToSoftMaxInput.ColumnSlice(group.tokens[j].sz, nbr_wrd);
+                grd_to_soft_max_input.Reshape(nbr_wrd, 1);
+                m_grdGroup.ColumnSlice(j, 1).SetValue(grd_to_soft_max_input);
+            }
 
-                switch (inputIndex)
+            if (inputIndex == 1)
+            {
+                // gradient to input: one GEMM for the whole class, then scatter-add the columns
+                m_scoresGroup.AssignProductOf(weightForClass, false, m_grdGroup, false); // -> hdSize x nbr_tok
+                for (size_t j = 0; j < nbr_tok; j++)
                 {
-                case 1:
-                    // gradient to input
-                    grd_t = Input(INPUTDATA)->GradientFor(fr);
-                    Matrix<ElemType>::MultiplyAndAdd(weightForClass, false, grd_to_soft_max_input, true, grd_t);
-                    break;
-                case 2:
-                    // gradient to input weight
-                    grd_to_wgt_t = Input(EMBEDDINGMATRIX)->GradientAsMatrix().ColumnSlice(lft_bnd, nbr_wrd);
-                    Matrix<ElemType>::MultiplyAndAdd(obs, false, grd_to_soft_max_input, false, grd_to_wgt_t);
-                    break;
-                case 3:
-                    grd_t = Input(CLASSPROBINDATA)->GradientFor(fr);
-                    grd_t.SetValue(DataWithMBLayoutFor(m_clsSoftmax, fr, Input(CLASSPROBINDATA)->GetMBLayout()));
-                    ComputeCEPartialToSoftmaxInputs(grd_t, Gradient(), c_t);
-                    break;
+                    FrameRange fr = FrameRange(Input(LABELDATA)->GetMBLayout(), group.tokens[j].t).Sequence(group.tokens[j].s);
+                    Matrix<ElemType> grd_t = Input(INPUTDATA)->GradientFor(fr);
+                    Matrix<ElemType>::ScaleAndAdd((ElemType) 1, m_scoresGroup.ColumnSlice(j, 1), grd_t);
                 }
-
-                sz += nbr_wrd;
             }
+            else // inputIndex == 2
+            {
+                // gradient to input weight: all tokens' outer products accumulate in one GEMM
+                m_obsGroup.Resize(hdSize, nbr_tok);
+                for (size_t j = 0; j < nbr_tok; j++)
+                {
+                    FrameRange fr = FrameRange(Input(LABELDATA)->GetMBLayout(), group.tokens[j].t).Sequence(group.tokens[j].s);
+                    m_obsGroup.ColumnSlice(j, 1).SetValue(Input(INPUTDATA)->ValueFor(fr));
+                }
+                Matrix<ElemType> grd_to_wgt_t = Input(EMBEDDINGMATRIX)->GradientAsMatrix().ColumnSlice(group.lft_bnd, nbr_wrd);
+                Matrix<ElemType>::MultiplyAndAdd(m_obsGroup, false, m_grdGroup, true, grd_to_wgt_t);
+            }
+        }
     }
 
     virtual bool OutputUsedInComputingInputNodesGradients() const override
@@ -870,10 +934,11 @@ public:
         m_clsSoftmax.AssignExpOf(m_clsLogSoftmax); // non-log
 
         // create a large workspace to contain all class-conditioned probs concatenated
-        // 'sz' is the offset into that vector. We will iterate over these vectors at a few places. Always use this same boilerplate code.
-        // TODO: should we pull this iteration into an iterator, to reduce the code dup?
+        // 'sz' is the offset into that vector. While computing the offsets, group the tokens by
+        // class id, so that all tokens sharing a class can be processed with one GEMM below.
         const size_t nT = Input(LABELDATA)->GetNumTimeSteps();
         const size_t nS = Input(LABELDATA)->GetNumParallelSequences();
+        m_classGroups.clear();
         size_t sz = 0;
         for (size_t s = 0; s < nS; s++)
             for (size_t t = 0; t < nT; t++)
@@ -883,11 +948,25 @@ public:
                     continue;
 
                 const Matrix<ElemType>& lbl_t = Input(LABELDATA)->ValueFor(fr);
-                size_t lft_bnd = (size_t) lbl_t(2, 0);
-                size_t rgt_bnd = (size_t) lbl_t(3, 0);
-                size_t nbr_wrd = (rgt_bnd - lft_bnd); // number of words in the class
+                size_t y_t = (size_t) lbl_t(0, 0);     // current word token index
+                size_t c_t = (size_t) lbl_t(1, 0);     // current word token's class index
+                size_t lft_bnd = (size_t) lbl_t(2, 0); // index of first word belonging to current word token's class
+                size_t rgt_bnd = (size_t) lbl_t(3, 0); // and end of that range
+                size_t nbr_wrd = (rgt_bnd - lft_bnd);  // number of words in the class
                 if (nbr_wrd == 0)
                     LogicError("ClassBasedCrossEntropyWithSoftmax (ForwardPropNonLooping()): Encountered a class of size 0. This sample seems to lack an NoInput flag.");
+                if (y_t < lft_bnd || y_t >= rgt_bnd)
+                    LogicError("ClassBasedCrossEntropyWithSoftmax (ForwardPropNonLooping()): Word index out of bounds of class-member index range (word not a class member).");
+
+                ClassGroup& group = m_classGroups[c_t];
+                if (group.tokens.empty())
+                {
+                    group.lft_bnd = lft_bnd;
+                    group.nbr_wrd = nbr_wrd;
+                }
+                else if (group.lft_bnd != lft_bnd || group.nbr_wrd != nbr_wrd)
+                    LogicError("ClassBasedCrossEntropyWithSoftmax (ForwardPropNonLooping()): Tokens of the same class have inconsistent class-member index ranges.");
+                group.tokens.push_back(ClassToken{s, t, sz, y_t});
 
                 sz += nbr_wrd;
             }
@@ -897,58 +976,59 @@ public:
         m_softMax.Resize(1, sz);
         m_logSoftmax.Resize(1, sz);
 
-        // accumulate objective
-        functionValues.SetValue(0);
-        sz = 0; // iterate over the packed concatenated class-conditioned prob vectors
-        for (size_t s = 0; s < nS; s++)
-            for (size_t t = 0; t < nT; t++)
-            {
-                FrameRange fr = FrameRange(Input(LABELDATA)->GetMBLayout(), t).Sequence(s);
-                if (Input(LABELDATA)->GetMBLayout()->IsGap(fr)) // skip gaps
-                    continue;
-
-                const Matrix<ElemType>& lbl_t = Input(LABELDATA)->ValueFor(fr);
-                size_t y_t = (size_t) lbl_t(0, 0);     // current word token index
-                size_t c_t = (size_t) lbl_t(1, 0);     // current word token's class index
-                size_t lft_bnd = (size_t) lbl_t(2, 0); // index of first word belonging to current word token's class
-                size_t rgt_bnd = (size_t) lbl_t(3, 0); // and end of that range
-                size_t nbr_wrd = (rgt_bnd - lft_bnd);  // number of words in the class
-
-                // now get views of various arrays that correspond to the index range of words belonging to this class
+        // compute all class-conditional distributions, one class at a time: gather the hidden
+        // activations of the class's tokens, run a single [nbr_wrd x hdSize] x [hdSize x nbr_tok]
+        // GEMM and a single column-wise log softmax over the whole group, and scatter the columns
+        // back into the packed buffer (one token's vector is contiguous there, so a column can be
+        // viewed as a row slice via Reshape)
+        for (auto& iter : m_classGroups)
+        {
+            const ClassGroup& group = iter.second;
+            const size_t nbr_wrd = group.nbr_wrd;
+            const size_t nbr_tok = group.tokens.size();
 
-                // get hidden vectors for the words in this class
-                Matrix<ElemType> weightForClass = Input(EMBEDDINGMATRIX)->ValueAsMatrix().ColumnSlice(lft_bnd, nbr_wrd); // [hdSize x nbr_wrd]
+            Matrix<ElemType> weightForClass = Input(EMBEDDINGMATRIX)->ValueAsMatrix().ColumnSlice(group.lft_bnd, nbr_wrd); // [hdSize x nbr_wrd]
 
-                // buffer to hold the class-conditional distribution
-                Matrix<ElemType> softMax_t = m_softMax.ColumnSlice(sz, nbr_wrd); // TODO: declare these outside of the loop to avoid the malloc
-                Matrix<ElemType> logSoftMax_t = m_logSoftmax.ColumnSlice(sz, nbr_wrd);
+            m_obsGroup.Resize(hdSize, nbr_tok);
+            for (size_t j = 0; j < nbr_tok; j++)
+            {
+                FrameRange fr = FrameRange(Input(LABELDATA)->GetMBLayout(), group.tokens[j].t).Sequence(group.tokens[j].s);
+                m_obsGroup.ColumnSlice(j, 1).SetValue(Input(INPUTDATA)->ValueFor(fr));
+            }
 
-                Matrix<ElemType> obs = Input(INPUTDATA)->ValueFor(fr); // hidden activation vector for current word token
+            m_scoresGroup.AssignProductOf(weightForClass, true, m_obsGroup, false); // -> nbr_wrd x nbr_tok
+            m_scoresGroup.InplaceLogSoftmax(true);                                  // log softmax(W' x_t), all tokens at once
 
-                // multiply hidden activation with weight matrix (the slice of the weight matrix for the range of class members)
-                // TODO: can we use 'true' here instead? Above transposition hack won't work with row slices. 'obs' not used elsewhere
-                obs.Reshape(1, hdSize);                                                                                // transpose it (make it a column vector)
-                logSoftMax_t.AssignProductOf(obs /*(1 x hdSize)*/, false, weightForClass /*hdSize x nbr_wrd*/, false); // -> 1 x nbr_word
+            for (size_t j = 0; j < nbr_tok; j++)
+            {
+                Matrix<ElemType> logSoftMax_t = m_logSoftmax.ColumnSlice(group.tokens[j].sz, nbr_wrd);
+                Matrix<ElemType> scores_t = m_scoresGroup.ColumnSlice(j, 1);
+                scores_t.Reshape(1, nbr_wrd); // contiguous, so a column doubles as a row vector
+                logSoftMax_t.SetValue(scores_t);
+            }
+        }
 
-                // log softmax(W x_t)
-                logSoftMax_t.InplaceLogSoftmax(false);
+        // non-log version, in one pass over the whole packed buffer
+        m_softMax.SetValue(m_logSoftmax);
+        m_softMax.InplaceExp();
 
-                // and non-log version
-                softMax_t.SetValue(logSoftMax_t);
-                softMax_t.InplaceExp();
-                // we now have a column vector of class-conditional probabilities over the class members
+        // accumulate objective
+        functionValues.SetValue(0);
+        for (const auto& iter : m_classGroups)
+        {
+            const ClassGroup& group = iter.second;
+            for (size_t j = 0; j < group.tokens.size(); j++)
+            {
+                const ClassToken& tok = group.tokens[j];
 
-                // add  the word's class-conditional log posterior
-                if (y_t < lft_bnd || y_t >= rgt_bnd)
-                    LogicError("ClassBasedCrossEntropyWithSoftmax (ForwardPropNonLooping()): Word index out of bounds of class-member index range (word not a class member).");
-                size_t idx_in_class = y_t - lft_bnd;
-                Matrix<ElemType>::AddElementToElement(logSoftMax_t, 0, idx_in_class, functionValues, 0, 0); // (1x1)
+                // add the word's class-conditional log posterior
+                size_t idx_in_class = tok.y_t - group.lft_bnd;
+                Matrix<ElemType>::AddElementToElement(m_logSoftmax, 0, tok.sz + idx_in_class, functionValues, 0, 0); // (1x1)
 
                 // add the class log posterior probability
-                Matrix<ElemType>::AddElementToElement(m_clsLogSoftmax, c_t, t, functionValues, 0, 0); // (1x1)
-
-                sz += nbr_wrd;
+                Matrix<ElemType>::AddElementToElement(m_clsLogSoftmax, iter.first, tok.t, functionValues, 0, 0); // (1x1)
             }
+        }
 
         functionValues *= (-1);
 
@@ -993,6 +1073,29 @@ protected:
 
     size_t m_nbrCls;
     size_t m_totalNbrWords;
+
+    // one word token of the minibatch, as grouped by class id
+    struct ClassToken
+    {
+        size_t s, t; // location within the minibatch layout
+        size_t sz;   // offset of the token's class-conditional vector in the packed buffers
+        size_t y_t;  // word index
+    };
+    // the tokens of one class and the class's member-word index range
+    struct ClassGroup
+    {
+        size_t lft_bnd;
+        size_t nbr_wrd;
+        std::vector<ClassToken> tokens;
+    };
+    // tokens grouped by class id, rebuilt each forward pass; processing a whole group at a time
+    // turns the per-token GEMMs into one GEMM per distinct class
+    std::map<size_t, ClassGroup> m_classGroups;
+
+    // workspaces for the grouped computation
+    Matrix<ElemType> m_obsGroup;    // gathered hidden activations [hdSize x nbr_tok]
+    Matrix<ElemType> m_scoresGroup; // per-class GEMM output
+    Matrix<ElemType> m_grdGroup;    // gathered gradients w.r.t. the softmax input [nbr_wrd x nbr_tok]
 };
 
 template class ClassBasedCrossEntropyWithSoftmaxNode<float>;
@@ -1125,29 +1228,36 @@ public:
         // this implementation only supports one sentence per minibatch
 
         int nObs = lbls.GetNumCols();
+        int nLab = lbls.GetNumRows();
 
         // change to other values so can support multiple sentences in each minibatch
         assert(iStep == 1);
-        ForwardCompute(alpha, lbls, pos_scores, pair_scores);
-        BackwardCompute(alpha, beta, functionValues, lbls, pos_scores, pair_scores, iStep);
-        PostProbCompute(postprob, alpha, beta);
+
+        // the label scans below touch every element, so pull the (small) label and transition
+        // matrices to the host once instead of fetching element by element through the device
+        ElemType* lblsHost = lbls.CopyToArray();
+        ElemType* pairScoresHost = pair_scores.CopyToArray();
 
         firstLbl = -1;
-        for (int ik = 0; ik < lbls.GetNumRows(); ik++)
-            if (lbls(ik, 0) != 0)
+        for (int ik = 0; ik < nLab; ik++)
+            if (lblsHost[ik] != 0)
             {
                 firstLbl = ik;
                 break;
             }
 
         lastLbl = -1;
-        for (int ik = 0; ik < lbls.GetNumRows(); ik++)
-            if (lbls(ik, nObs - 1) != 0)
+        for (int ik = 0; ik < nLab; ik++)
+            if (lblsHost[ik + (nObs - 1) * nLab] != 0)
             {
                 lastLbl = ik;
                 break;
             }
 
+        ForwardCompute(alpha, pos_scores, pair_scores, firstLbl);
+        BackwardCompute(alpha, beta, functionValues, lbls, pos_scores, pair_scores, iStep);
+        PostProbCompute(postprob, alpha, beta);
+
         functionValues.AssignInnerProductOfMatrices(lbls, pos_scores);
 
         Matrix<ElemType> a = alpha.ColumnSlice(nObs - 1, 1);
@@ -1159,21 +1269,24 @@ public:
         for (int t = 0; t < nObs - 1; t++)
         {
             int i = -1;
-            for (int ik = 0; ik < lbls.GetNumRows(); ik++)
-                if (lbls(ik, t) != 0)
+            for (int ik = 0; ik < nLab; ik++)
+                if (lblsHost[ik + t * nLab] != 0)
                 {
                     i = ik;
                     break;
                 }
             int j = -1;
-            for (int ik = 0; ik < lbls.GetNumRows(); ik++)
-                if (lbls(ik, t + 1) != 0)
+            for (int ik = 0; ik < nLab; ik++)
+                if (lblsHost[ik + (t + 1) * nLab] != 0)
                 {
                     j = ik;
                     break;
                 }
-            tscore += pair_scores(j, i);
+            tscore += pairScoresHost[j + i * nLab]; // pair_scores(j, i)
         }
+        delete[] lblsHost;
+        delete[] pairScoresHost;
+
         tscore += functionValues.Get00Element(); // correct path score
         tscore -= fAlpha;                        // reduced by the scores from all paths
         functionValues.SetValue(tscore);
@@ -1181,42 +1294,14 @@ public:
         functionValues *= (-1);
     }
 
-    // compute forward backward algorithm
+    // compute forward algorithm; the recursion runs inside the matrix library so that, like
+    // the backward and gradient computations, it dispatches to the device the inputs live on
     static void ForwardCompute(Matrix<ElemType>& alpha,
-                               const Matrix<ElemType>& lbls,
-                               const Matrix<ElemType>& pos_scores, const Matrix<ElemType>& pair_scores)
+                               const Matrix<ElemType>& pos_scores, const Matrix<ElemType>& pair_scores,
+                               const int startLbl)
     {
         // to-do, shift more than 1 to support muliple sentences per minibatch
-        int iNumPos = lbls.GetNumCols();
-        int iNumLab = lbls.GetNumRows();
-
-        int firstLbl = -1;
-        for (int ik = 0; ik < lbls.GetNumRows(); ik++)
-            if (lbls(ik, 0) != 0)
-            {
-                firstLbl = ik;
-                break;
-            }
-
-        // need to have
-        alpha.Resize(iNumLab, iNumPos);
-
-        for (int t = 0; t < iNumPos; t++)
-        {
-            for (int k = 0; k < iNumLab; k++)
-            {
-                ElemType fTmp = (ElemType) LZERO;
-                for (int j = 0; j < iNumLab; j++)
-                {
-                    ElemType fAlpha = (j == firstLbl) ? (ElemType) 0.0 : (ElemType) LZERO;
-                    if (t > 0)
-                        fAlpha = alpha(j, t - 1);
-                    fTmp = alpha.LogAdd(fTmp, fAlpha + pair_scores(k, j));
-                }
-                fTmp += pos_scores(k, t); // include position dependent score
-                alpha(k, t) = fTmp;
-            }
-        }
+        Matrix<ElemType>::RCRFForwardCompute(alpha, pos_scores, pair_scores, startLbl);
     }
 
     // compute backward algorithm
@@ -1481,6 +1566,7 @@ public:
           m_dropoutRate(0)
     {
         m_randomSeed = (unsigned long) CreateUniqId();
+        m_evalRandomSeed = m_randomSeed;
     }
 
     virtual void /*ComputationNode::*/ BackpropTo(const size_t inputIndex, const FrameRange& fr) override
@@ -1489,7 +1575,7 @@ public:
         Matrix<ElemType> sliceOutputGrad = GradientFor(fr);
 
         if (m_dropoutRate > 0)
-            sliceInput0Grad.AddElementProductOf(sliceOutputGrad, DataFor(*m_maskOfDropout, fr));
+            sliceInput0Grad.AddDropoutGradientOf(sliceOutputGrad, (ElemType) m_dropoutRate, (ElemType)(1.0 / (1.0 - m_dropoutRate)) /*pre-scaled*/, m_evalRandomSeed, DropoutOffsetFor(fr));
         else
             sliceInput0Grad += sliceOutputGrad;
     }
@@ -1509,12 +1595,13 @@ public:
         return false;
     }
 
-    virtual void UpdateFunctionMBSize() override
+    virtual void /*IComputationNode::*/ BeginForwardProp() override
     {
-        Base::UpdateFunctionMBSize();
-        // resize temporaries to their proper size
-        if (m_dropoutRate > 0)
-            m_maskOfDropout->Resize(Input(0)->Value());
+        Base::BeginForwardProp();
+        // draw a fresh mask seed once per minibatch; ForwardProp() and BackpropTo() regenerate
+        // the identical mask from (m_evalRandomSeed, element index), so no mask is materialized
+        m_evalRandomSeed = m_randomSeed;
+        m_randomSeed += 1073807359; // 1073807359 is a very large prime number to avoid collision with other dropout nodes
     }
 
     virtual void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
@@ -1523,18 +1610,9 @@ public:
         Matrix<ElemType> sliceOutputValue = ValueFor(fr);
 
         if (m_dropoutRate > 0)
-        {
-            // determine drop-out mask for this minibatch
-            auto sliceMask = DataFor(*m_maskOfDropout, fr);
-            sliceMask.SetUniformRandomMask((ElemType) m_dropoutRate, (ElemType)(1.0 / (1.0 - m_dropoutRate)) /*pre-scaled*/, m_randomSeed);
-            m_randomSeed += 1073807359; // 1073807359 is a very large prime number to avoid collision with other dropout nodes
-            // apply dropout mask
-            sliceOutputValue.AssignElementProductOf(sliceMask, sliceInput0Value);
-        }
+            sliceOutputValue.AssignDropoutOf(sliceInput0Value, (ElemType) m_dropoutRate, (ElemType)(1.0 / (1.0 - m_dropoutRate)) /*pre-scaled*/, m_evalRandomSeed, DropoutOffsetFor(fr));
         else
-        {
             sliceOutputValue.SetValue(sliceInput0Value);
-        }
     }
 
     virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
@@ -1553,6 +1631,7 @@ public:
     void SetRandomSeed(const unsigned long val)
     {
         m_randomSeed = (unsigned long) val;
+        m_evalRandomSeed = m_randomSeed;
     }
 
     virtual void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
@@ -1563,28 +1642,21 @@ public:
             auto node = dynamic_pointer_cast<DropoutNode<ElemType>>(nodeP);
             node->m_dropoutRate = m_dropoutRate;
             node->m_randomSeed = m_randomSeed;
-            node->m_maskOfDropout = m_maskOfDropout;
+            node->m_evalRandomSeed = m_evalRandomSeed;
         }
     }
-    // request matrices needed to do node function value evaluation
-    virtual void RequestMatricesBeforeForwardProp(MatrixPool& matrixPool)
-    {
-        Base::RequestMatricesBeforeForwardProp(matrixPool);
-        RequestMatrixFromPool(m_maskOfDropout, matrixPool);
-    }
 
-    // release gradient and temp matrices that no longer needed after all the children's gradients are computed.
-    virtual void ReleaseMatricesAfterBackprop(MatrixPool& matrixPool)
+private:
+    // the index of a slice's first element within the full minibatch matrix; passed to the Math
+    // layer so per-frame slices draw from the same element stream as a whole-minibatch call
+    size_t DropoutOffsetFor(const FrameRange& fr) const
     {
-        Base::ReleaseMatricesAfterBackprop(matrixPool);
-        ReleaseMatrixToPool(m_maskOfDropout, matrixPool);
+        return fr.IsAllFrames() ? 0 : fr.t() * GetMBLayout()->GetNumParallelSequences() * GetSampleMatrixNumRows();
     }
 
-private:
     double m_dropoutRate;
-    unsigned long m_randomSeed;
-
-    shared_ptr<Matrix<ElemType>> m_maskOfDropout;
+    unsigned long m_randomSeed;               // base seed, advanced once per minibatch in BeginForwardProp()
+    unsigned long long m_evalRandomSeed;      // seed the current minibatch's mask is drawn from
 };
 
 template class DropoutNode<float>;
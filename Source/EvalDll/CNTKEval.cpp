@@ -54,6 +54,12 @@ void CNTKEval<ElemType>::Init(const std::string& config)
     }
     size_t nThreads = m_config("numCPUThreads", "1");
     CPUMatrix<ElemType>::SetNumThreads(nThreads);
+    if (m_config(L"calibrateCPUParallelism", true))
+        CPUMatrix<ElemType>::CalibrateParallelism(); // no-op when running single-threaded
+    if (m_config(L"quantizedInference", false))
+        SetQuantizedInference(true); // 8-bit weight matrices in Times nodes; CPU eval only
+    if (m_config(L"prepackedWeights", false))
+        SetPrepackedWeights(true); // persistently BLAS-packed weight matrices in Times nodes; CPU eval only, MKL builds
 
     g_shareNodeValueMatrices = m_config(L"shareNodeValueMatrices", false);
 }
@@ -64,6 +70,11 @@ template <class ElemType>
 void CNTKEval<ElemType>::Destroy()
 {
     // cleanup everything
+    m_batcher.reset();
+    m_cascade.reset();
+    m_netPool.reset();
+    m_scheduler.reset(); // prints its final latency report
+
     m_net.reset();
     delete m_reader;
     delete m_writer;
@@ -77,7 +88,88 @@ void CNTKEval<ElemType>::LoadModel(const std::wstring& modelFileName)
 {
     DEVICEID_TYPE deviceId = DeviceFromConfig(m_config);
     fprintf(stderr, "DeviceID=%d\n", (int) deviceId);
-    m_net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, modelFileName);
+    // Load the weight matrices lazily when the model file supports it: StartEvaluateMinibatchLoop()
+    // then only reads in the weights of the sub-network that is actually evaluated.
+    bool deferValueLoading = m_config(L"deferValueLoading", true);
+
+    // optionally back the weights with a read-only shared mapping of the model file, so all
+    // scoring processes on the box share one set of physical pages for them; CPU only, and it
+    // rides on the deferred-loading path (the pending values become views into the mapping)
+    bool mapSharedWeights = m_config(L"mapSharedWeights", false);
+    if (mapSharedWeights)
+    {
+        if (deviceId != CPUDEVICE)
+            RuntimeError("mapSharedWeights is only supported for CPU evaluation.");
+        deferValueLoading = true;
+    }
+
+    m_net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, modelFileName, FileOptions::fileOptionsBinary,
+                                                         false /*bAllowNoCriterionNode*/, nullptr /*anotherNetwork*/, deferValueLoading);
+    if (mapSharedWeights)
+        m_net->EnableSharedWeightMapping(modelFileName);
+
+    // optionally run the graph-optimization passes (common-subexpression elimination and
+    // elementwise-chain fusion); safe here since EvalDll never re-saves the rewritten graph
+    bool graphOptimizations = m_config(L"graphOptimizations", false);
+    if (graphOptimizations)
+        m_net->EnableGraphOptimizations(true);
+
+    // optionally evaluate independent subgraphs (e.g. the heads of a multi-task model) on
+    // concurrent worker threads; CPU only, and incompatible with shareNodeValueMatrices
+    size_t parallelForwardProp = m_config(L"parallelForwardProp", (size_t) 0);
+    if (parallelForwardProp > 1)
+    {
+        if (m_config(L"shareNodeValueMatrices", false))
+            RuntimeError("parallelForwardProp cannot be used together with shareNodeValueMatrices.");
+        m_net->EnableParallelForwardProp(parallelForwardProp);
+    }
+
+    // batched server mode: route concurrent Evaluate() calls through one shared batcher that
+    // waits up to batchDeadlineMs for more requests and scores them as one wide minibatch
+    if (m_config(L"batchedEvaluation", false))
+    {
+        size_t batchDeadlineMs = m_config(L"batchDeadlineMs", (size_t) 2);
+        size_t maxBatchedRequests = m_config(L"maxBatchedRequests", (size_t) 128);
+        m_batcher.reset(new EvalRequestBatcher<ElemType>(m_net, batchDeadlineMs, maxBatchedRequests));
+    }
+
+    // cascade mode: a small companion model scores every frame first, and the network loaded
+    // above is only consulted for frames whose max posterior falls below the threshold
+    std::wstring cascadeModelPath = m_config(L"cascadeModelPath", L"");
+    if (!cascadeModelPath.empty())
+    {
+        if (m_batcher != nullptr)
+            RuntimeError("cascadeModelPath cannot be used together with batchedEvaluation.");
+        double cascadeConfidenceThreshold = m_config(L"cascadeConfidenceThreshold", 0.9);
+        auto smallNet = ComputationNetwork::CreateFromFile<ElemType>(deviceId, cascadeModelPath, FileOptions::fileOptionsBinary,
+                                                                     false /*bAllowNoCriterionNode*/, nullptr /*anotherNetwork*/, deferValueLoading);
+        if (graphOptimizations)
+            smallNet->EnableGraphOptimizations(true);
+        m_cascade.reset(new EvalCascade<ElemType>(smallNet, m_net, cascadeConfidenceThreshold));
+    }
+
+    // pooled mode: keep N instances of the network, all referencing one read-only copy of the
+    // weights, and let concurrent Evaluate() calls from different threads run in parallel
+    size_t evalNetworkInstances = m_config(L"evalNetworkInstances", (size_t) 1);
+    if (evalNetworkInstances > 1)
+    {
+        if (m_batcher != nullptr || m_cascade != nullptr)
+            RuntimeError("evalNetworkInstances cannot be used together with batchedEvaluation or cascadeModelPath.");
+        m_netPool.reset(new EvalNetworkPool<ElemType>(m_net, modelFileName, deviceId, evalNetworkInstances));
+    }
+
+    // latency-scheduled mode: batch and interactive traffic share this instance. Evaluate()
+    // becomes batch-class work that runs in column sub-slices of batchSliceFrames frames,
+    // yielding the device to any EvaluateOnline() caller between slices; online waits are
+    // recorded and reported against onlineLatencyBudgetMs
+    if (m_config(L"latencyScheduling", false))
+    {
+        if (m_batcher != nullptr || m_cascade != nullptr || m_netPool != nullptr)
+            RuntimeError("latencyScheduling cannot be used together with batchedEvaluation, cascadeModelPath, or evalNetworkInstances.");
+        size_t batchSliceFrames = m_config(L"batchSliceFrames", (size_t) 256);
+        size_t onlineLatencyBudgetMs = m_config(L"onlineLatencyBudgetMs", (size_t) 5);
+        m_scheduler.reset(new EvalLatencyScheduler<ElemType>(m_net, batchSliceFrames, onlineLatencyBudgetMs));
+    }
 }
 
 // GetNodeDimensions - Get the node dimensions of the specified nodes
@@ -134,6 +226,11 @@ void CNTKEval<ElemType>::GetNodeDimensions(std::map<std::wstring, size_t>& dimen
 template <class ElemType>
 void CNTKEval<ElemType>::StartEvaluateMinibatchLoop(const std::wstring& outputNodeName)
 {
+    if (m_netPool != nullptr) // pooled mode prepares all instances (the first one loads the weights)
+    {
+        m_netPool->StartEvaluateMinibatchLoop(outputNodeName);
+        return;
+    }
     m_net->StartEvaluateMinibatchLoop(m_net->GetNodeFromName(outputNodeName));
 }
 
@@ -143,7 +240,38 @@ void CNTKEval<ElemType>::StartEvaluateMinibatchLoop(const std::wstring& outputNo
 template <class ElemType>
 void CNTKEval<ElemType>::Evaluate(std::map<std::wstring, std::vector<ElemType>*>& inputs, std::map<std::wstring, std::vector<ElemType>*>& outputs)
 {
+    // in batched server mode, this call blocks until the batcher has scored our utterance
+    // together with whatever other requests arrived within the deadline
+    if (m_batcher != nullptr)
+    {
+        m_batcher->Evaluate(inputs, outputs);
+        return;
+    }
+
+    // in cascade mode, only low-confidence frames reach the full network
+    if (m_cascade != nullptr)
+    {
+        m_cascade->Evaluate(inputs, outputs);
+        return;
+    }
+
+    // in latency-scheduled mode, this is batch-class work: it runs in column sub-slices
+    // and yields the device to interactive EvaluateOnline() calls between slices
+    if (m_scheduler != nullptr)
+    {
+        m_scheduler->Evaluate(inputs, outputs, false /*online*/);
+        return;
+    }
+
     size_t minibatchSize = m_config(L"minibatchSize", (size_t) 10240);
+
+    // in pooled mode, this call runs on whichever network instance is free, concurrently
+    // with Evaluate() calls of other threads (blocks while all instances are busy)
+    if (m_netPool != nullptr)
+    {
+        m_netPool->Evaluate(inputs, outputs, minibatchSize);
+        return;
+    }
     // get the evaluation names from the output string
     vector<wstring> outNodeNames;
 
@@ -175,11 +303,203 @@ void CNTKEval<ElemType>::Evaluate(std::map<std::wstring, std::vector<ElemType>*>
     eval.WriteOutput(*m_reader, minibatchSize, *m_writer, outNodeNames);
 }
 
+// EvaluateOnline - evaluate an interactive request with priority over batch work
+// In latency-scheduled mode this takes the device from any in-progress Evaluate() at its
+// next slice boundary, and the wait is recorded against the configured budget; without the
+// scheduler it is identical to Evaluate().
+template <class ElemType>
+void CNTKEval<ElemType>::EvaluateOnline(std::map<std::wstring, std::vector<ElemType>*>& inputs, std::map<std::wstring, std::vector<ElemType>*>& outputs)
+{
+    if (m_scheduler != nullptr)
+        m_scheduler->Evaluate(inputs, outputs, true /*online*/);
+    else
+        Evaluate(inputs, outputs);
+}
+
+// StartEvaluateStream - prepare the network for EvaluateStream() calls
+// outputNodeName - name of node that will be evaluated
+// The evaluation order and node matrices are set up once here, so the per-call work of
+// EvaluateStream() is limited to binding the minibatch layout and running ForwardProp().
+template <class ElemType>
+void CNTKEval<ElemType>::StartEvaluateStream(const std::wstring& outputNodeName)
+{
+    if (m_net == nullptr)
+        RuntimeError("StartEvaluateStream: no model loaded.");
+
+    m_boundInputs.clear();
+    m_boundOutputs.clear();
+    m_streamInputNodes.clear();
+    m_streamOutputNodes.assign(1, m_net->GetNodeFromName(outputNodeName));
+
+    m_net->AllocateAllMatrices({}, m_streamOutputNodes, nullptr);
+    m_net->StartEvaluateMinibatchLoop(m_streamOutputNodes[0]);
+    m_streamSequenceBegun = false;
+}
+
+// BindInputBuffer - bind a caller-owned buffer as the data source of an input node
+// buffer - must hold maxSamples columns of the node's sample dimension and stay valid until
+//          the binding is replaced by another StartEvaluateStream() or the evaluator is destroyed
+// On CPU devices the buffer is wrapped by the input node's Matrix in place (no copy); on GPU
+// devices each EvaluateStream() performs one host-to-device transfer from it (pinned memory
+// makes that transfer asynchronous-capable and faster).
+template <class ElemType>
+void CNTKEval<ElemType>::BindInputBuffer(const std::wstring& nodeName, ElemType* buffer, size_t maxSamples)
+{
+    if (m_streamOutputNodes.empty())
+        RuntimeError("BindInputBuffer: StartEvaluateStream() must be called first.");
+    if (buffer == nullptr || maxSamples == 0)
+        InvalidArgument("BindInputBuffer: a non-empty buffer must be provided for node '%ls'.", nodeName.c_str());
+
+    BoundBuffer bound;
+    bound.node = dynamic_pointer_cast<ComputationNode<ElemType>>(m_net->GetNodeFromName(nodeName));
+    bound.buffer = buffer;
+    bound.maxSamples = maxSamples;
+    m_boundInputs.push_back(bound);
+    m_streamInputNodes.push_back(bound.node);
+}
+
+// BindOutputBuffer - bind a caller-owned buffer as the destination of an output node
+// buffer - must hold maxSamples columns of the node's sample dimension; results are copied
+//          into it by each EvaluateStream() call
+template <class ElemType>
+void CNTKEval<ElemType>::BindOutputBuffer(const std::wstring& nodeName, ElemType* buffer, size_t maxSamples)
+{
+    if (m_streamOutputNodes.empty())
+        RuntimeError("BindOutputBuffer: StartEvaluateStream() must be called first.");
+    if (buffer == nullptr || maxSamples == 0)
+        InvalidArgument("BindOutputBuffer: a non-empty buffer must be provided for node '%ls'.", nodeName.c_str());
+
+    BoundBuffer bound;
+    bound.node = dynamic_pointer_cast<ComputationNode<ElemType>>(m_net->GetNodeFromName(nodeName));
+    bound.buffer = buffer;
+    bound.maxSamples = maxSamples;
+    m_boundOutputs.push_back(bound);
+}
+
+// EvaluateStream - evaluate numSamples frames from the bound input buffers into the bound output buffers
+// Unlike Evaluate(), no reader/writer objects and no intermediate std::vector copies are
+// involved; all frames form one parallel sequence that continues across calls until ResetState().
+template <class ElemType>
+void CNTKEval<ElemType>::EvaluateStream(size_t numSamples)
+{
+    if (m_streamOutputNodes.empty())
+        RuntimeError("EvaluateStream: StartEvaluateStream() must be called first.");
+    if (m_boundInputs.empty())
+        RuntimeError("EvaluateStream: no input buffers have been bound.");
+
+    // hand the caller's buffers to the input nodes
+    for (auto& bound : m_boundInputs)
+    {
+        if (numSamples > bound.maxSamples)
+            InvalidArgument("EvaluateStream: %lu samples requested but only %lu are bound for node '%ls'.",
+                            numSamples, bound.maxSamples, bound.node->NodeName().c_str());
+        size_t rows = bound.node->GetSampleMatrixNumRows();
+        const int deviceId = bound.node->Value().GetDeviceId();
+        // the CPU wraps the buffer in place (zero copy); a GPU device needs one host-to-device transfer
+        bound.node->Value().SetValue(rows, numSamples, deviceId, bound.buffer,
+                                     deviceId < 0 ? matrixFlagDontOwnBuffer : matrixFlagNormal);
+        bound.node->NotifyFunctionValuesMBSizeModified();
+    }
+
+    // set up the minibatch layout: one sequence, continued from the previous call unless ResetState() was called
+    auto pMBLayout = m_net->GetMBLayoutPtr();
+    pMBLayout->Init(1, numSamples);
+    if (!m_streamSequenceBegun) // new utterance: sequence starts at frame [0]
+    {
+        // the fake end one frame past the minibatch mirrors EvalReader::CopyMBLayoutTo()
+        pMBLayout->AddSequence(0, 0, 0, numSamples + 1);
+        m_streamSequenceBegun = true;
+    }
+    else // continuation of the utterance of the previous call
+        pMBLayout->AddSequence(0, 0, -1, numSamples + 1);
+
+    ComputationNetwork::BumpEvalTimeStamp(m_streamInputNodes);
+
+    // run the network and copy the results into the bound output buffers
+    for (auto& outputNode : m_streamOutputNodes)
+        m_net->ForwardProp(outputNode);
+
+    for (auto& bound : m_boundOutputs)
+    {
+        if (numSamples > bound.maxSamples)
+            InvalidArgument("EvaluateStream: %lu samples requested but only %lu are bound for node '%ls'.",
+                            numSamples, bound.maxSamples, bound.node->NodeName().c_str());
+        // the capacity always suffices (checked above), so CopyToArray() will not reallocate
+        ElemType* arrayCopyTo = bound.buffer;
+        size_t capacity = bound.maxSamples * bound.node->GetSampleMatrixNumRows();
+        bound.node->Value().CopyToArray(arrayCopyTo, capacity);
+    }
+}
+
+// SaveRecurrentState - snapshot the recurrent state carried by the model's delay nodes
+// The final hidden activations of the Evaluate()/EvaluateStream() calls so far (what the
+// PastValue/FutureValue nodes would feed into the next call) are retained under the returned
+// handle, using the same IStatefulNode export path that sub-minibatching uses during training.
+// The evaluator's own carried state is left untouched, so the current stream simply continues.
+template <class ElemType>
+size_t CNTKEval<ElemType>::SaveRecurrentState()
+{
+    if (m_net == nullptr)
+        RuntimeError("SaveRecurrentState: no model loaded.");
+    if (m_batcher != nullptr || m_cascade != nullptr || m_netPool != nullptr || m_scheduler != nullptr)
+        RuntimeError("SaveRecurrentState: not supported in batched, cascaded, pooled, or latency-scheduled evaluation mode.");
+
+    std::map<std::wstring, NodeStatePtr> states;
+    for (auto& nodeIter : m_net->GetAllNodes())
+    {
+        shared_ptr<IStatefulNode> pStatefulNode = dynamic_pointer_cast<IStatefulNode>(nodeIter);
+        if (pStatefulNode != nullptr)
+            states[nodeIter->NodeName()] = pStatefulNode->ExportState();
+    }
+
+    size_t stateId = m_nextStateId++;
+    m_savedStates[stateId] = std::move(states);
+    return stateId;
+}
+
+// RestoreRecurrentState - make a saved snapshot the current recurrent state
+// The next Evaluate()/EvaluateStream() call continues the restored stream: its delay nodes
+// read the snapshotted activations instead of the default initial value, so overlapping
+// windows or interleaved streams need not re-evaluate their context frames. Do not call
+// ResetState() in between (that starts a fresh utterance and discards the carried state).
+// The snapshot stays valid and can be restored again.
+template <class ElemType>
+void CNTKEval<ElemType>::RestoreRecurrentState(size_t stateId)
+{
+    auto found = m_savedStates.find(stateId);
+    if (found == m_savedStates.end())
+        InvalidArgument("RestoreRecurrentState: unknown state handle %lu.", stateId);
+
+    for (auto& nameAndState : found->second)
+    {
+        // a null state means nothing crossed the minibatch boundary when it was saved
+        // (e.g. the utterance had already ended); there is nothing to import then
+        if (nameAndState.second == nullptr)
+            continue;
+        auto pStatefulNode = dynamic_pointer_cast<IStatefulNode>(m_net->GetNodeFromName(nameAndState.first));
+        pStatefulNode->ImportState(nameAndState.second);
+    }
+
+    m_streamSequenceBegun = true; // the next EvaluateStream() call continues, not begins, a sequence
+    // (the Evaluate() path continues automatically: m_start is unchanged since the save)
+}
+
+// ReleaseRecurrentState - free a snapshot taken by SaveRecurrentState()
+template <class ElemType>
+void CNTKEval<ElemType>::ReleaseRecurrentState(size_t stateId)
+{
+    auto found = m_savedStates.find(stateId);
+    if (found == m_savedStates.end())
+        InvalidArgument("ReleaseRecurrentState: unknown state handle %lu.", stateId);
+    m_savedStates.erase(found);
+}
+
 // ResetState - Reset the cell state when we get start of an utterance
 template <class ElemType>
 void CNTKEval<ElemType>::ResetState()
 {
     m_start = 1 - m_start;
+    m_streamSequenceBegun = false; // the next EvaluateStream() call starts a new utterance
 }
 
 // instantiate all the combinations we expect to be used
@@ -13,6 +13,10 @@
 #include "Eval.h"
 #include "EvalReader.h"
 #include "EvalWriter.h"
+#include "EvalRequestBatcher.h"
+#include "EvalCascade.h"
+#include "EvalNetworkPool.h"
+#include "EvalLatencyScheduler.h"
 
 #include "ComputationNetwork.h"
 
@@ -29,10 +33,39 @@ class CNTKEval : public IEvaluateModel<ElemType>
     std::map<std::wstring, size_t> m_dimensions;
     size_t m_start;
 
+    // streamed low-latency evaluation (see StartEvaluateStream())
+    struct BoundBuffer
+    {
+        ComputationNodePtr node;
+        ElemType* buffer;  // caller-owned; stays valid until the binding is replaced
+        size_t maxSamples; // capacity of 'buffer' in samples (columns)
+    };
+    std::vector<BoundBuffer> m_boundInputs;
+    std::vector<BoundBuffer> m_boundOutputs;
+    std::vector<ComputationNodeBasePtr> m_streamInputNodes; // base-class view of the bound input nodes, for BumpEvalTimeStamp()
+    std::vector<ComputationNodeBasePtr> m_streamOutputNodes;
+    bool m_streamSequenceBegun; // false until the first EvaluateStream() of an utterance
+
+    // batched server mode: aggregates concurrent Evaluate() calls into one wide minibatch
+    std::unique_ptr<EvalRequestBatcher<ElemType>> m_batcher;
+
+    // cascade mode: a small network answers high-confidence frames, the full one the rest
+    std::unique_ptr<EvalCascade<ElemType>> m_cascade;
+
+    // pooled mode: N network instances sharing one weight copy, for concurrent Evaluate() calls
+    std::unique_ptr<EvalNetworkPool<ElemType>> m_netPool;
+
+    // latency-scheduled mode: batch work yields to interactive requests between column slices
+    std::unique_ptr<EvalLatencyScheduler<ElemType>> m_scheduler;
+
+    // recurrent-state sessions (see SaveRecurrentState()): per-delay-node states by handle
+    std::map<size_t, std::map<std::wstring, NodeStatePtr>> m_savedStates;
+    size_t m_nextStateId;
+
 public:
     // constructor
     CNTKEval()
-        : m_reader(nullptr), m_net(nullptr)
+        : m_reader(nullptr), m_net(nullptr), m_streamSequenceBegun(false), m_nextStateId(1)
     {
     }
 
@@ -57,5 +90,19 @@ public:
     virtual void Init(const std::string& config);
     virtual void Destroy();
     virtual void ResetState();
+
+    // EvaluateOnline - interactive-priority variant of Evaluate(), see IEvaluateModel
+    virtual void EvaluateOnline(std::map<std::wstring, std::vector<ElemType>*>& inputs, std::map<std::wstring, std::vector<ElemType>*>& outputs);
+
+    // streamed low-latency evaluation, see IEvaluateModel
+    virtual void StartEvaluateStream(const std::wstring& outputNodeName);
+    virtual void BindInputBuffer(const std::wstring& nodeName, ElemType* buffer, size_t maxSamples);
+    virtual void BindOutputBuffer(const std::wstring& nodeName, ElemType* buffer, size_t maxSamples);
+    virtual void EvaluateStream(size_t numSamples);
+
+    // recurrent-state sessions, see IEvaluateModel
+    virtual size_t SaveRecurrentState();
+    virtual void RestoreRecurrentState(size_t stateId);
+    virtual void ReleaseRecurrentState(size_t stateId);
 };
 } } }
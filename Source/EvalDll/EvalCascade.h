@@ -0,0 +1,214 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// EvalCascade.h - two-stage early-exit evaluation: a small network first, the full network only for low-confidence frames
+//
+#pragma once
+
+#include <map>
+#include <vector>
+#include <string>
+#include <cmath>
+
+#include "ComputationNetwork.h"
+#include "ComputationNode.h"
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// EvalCascade - confidence-gated two-stage scoring for EvalDll
+// Most frames are easy: a small network classifies them just like the full one would.
+// This class evaluates a small network over the whole minibatch first, computes the
+// max posterior of every output column (softmax-normalizing the column, so the output
+// may be logits, log likelihoods or log posteriors), and re-evaluates only the columns
+// whose confidence falls below a threshold: the survivors are compacted into a narrow
+// minibatch, run through the full network, and their result columns are scattered back
+// over the small network's answers.
+// Both networks must take the same input names and produce the same output dimension.
+// Note: frame-level gating treats columns as independent, so the cascade is for
+// feed-forward (frame-mode) networks only; recurrent state would not survive the
+// column compaction.
+template <class ElemType>
+class EvalCascade
+{
+    typedef shared_ptr<ComputationNode<ElemType>> ComputationNodePtr;
+
+    // a node we feed or read, resolved once on the first call
+    struct BoundNode
+    {
+        std::wstring name;
+        ComputationNodePtr node;
+        size_t rows;
+    };
+
+    ComputationNetworkPtr m_smallNet;
+    ComputationNetworkPtr m_fullNet;
+    const double m_logThreshold; // log of the minimum max-posterior at which the small network's answer is accepted
+
+    std::vector<BoundNode> m_smallInputs, m_fullInputs; // same names, resolved per network
+    BoundNode m_smallOutput, m_fullOutput;
+    std::vector<ComputationNodeBasePtr> m_smallInputBases, m_fullInputBases; // for BumpEvalTimeStamp()
+
+    std::vector<ElemType> m_result;     // small-net output of the whole minibatch, patched with full-net columns
+    std::vector<ElemType> m_confidence; // per-column max log posterior of the small net
+    std::vector<ElemType> m_packed;     // gather/scatter staging buffer for the survivor columns
+    std::vector<size_t> m_survivors;    // column indexes that go to the full network
+
+    unsigned long long m_numFrames, m_numEscalated; // lifetime statistics
+
+public:
+    EvalCascade(ComputationNetworkPtr smallNet, ComputationNetworkPtr fullNet, double threshold)
+        : m_smallNet(smallNet), m_fullNet(fullNet), m_logThreshold(log(max(threshold, 1e-30))), m_numFrames(0), m_numEscalated(0)
+    {
+    }
+
+    ~EvalCascade()
+    {
+        if (m_numFrames > 0)
+            fprintf(stderr, "EvalCascade: %llu of %llu frames (%.1f%%) were escalated to the full network\n",
+                    m_numEscalated, m_numFrames, 100.0 * m_numEscalated / m_numFrames);
+    }
+
+    // Evaluate - score one utterance through the cascade
+    // inputs/outputs use the same conventions as IEvaluateModel::Evaluate(); 'outputs'
+    // must name exactly one output node, present in both networks.
+    void Evaluate(std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                  std::map<std::wstring, std::vector<ElemType>*>& outputs)
+    {
+        if (m_smallInputs.empty())
+            BindNodes(inputs, outputs);
+
+        // all inputs must agree on the frame count
+        size_t numFrames = 0;
+        for (const auto& bound : m_smallInputs)
+        {
+            auto iter = inputs.find(bound.name);
+            if (iter == inputs.end())
+                InvalidArgument("EvalCascade: missing data for input node '%ls'.", bound.name.c_str());
+            size_t n = iter->second->size() / bound.rows;
+            if (n == 0 || n * bound.rows != iter->second->size())
+                InvalidArgument("EvalCascade: data for input node '%ls' is not a non-empty multiple of its dimension %lu.", bound.name.c_str(), bound.rows);
+            if (numFrames == 0)
+                numFrames = n;
+            else if (n != numFrames)
+                InvalidArgument("EvalCascade: frame count of input node '%ls' (%lu) does not match that of previous entries (%lu).", bound.name.c_str(), n, numFrames);
+        }
+
+        // stage 1: the small network scores every frame
+        ForwardProp(m_smallNet, m_smallInputs, m_smallInputBases, m_smallOutput, inputs, numFrames, nullptr);
+
+        const size_t rows = m_smallOutput.rows;
+        m_result.resize(rows * numFrames);
+        ElemType* resultPtr = m_result.data();
+        size_t resultCapacity = m_result.size();
+        m_smallOutput.node->Value().CopyToArray(resultPtr, resultCapacity);
+
+        // confidence = max posterior per column, from a softmax-normalized copy of the output
+        Matrix<ElemType> posteriors(m_smallOutput.node->Value().GetDeviceId());
+        posteriors.SetValue(m_smallOutput.node->Value());
+        posteriors.InplaceLogSoftmax(true /*isColWise*/);
+        Matrix<ElemType> maxIndexes(posteriors.GetDeviceId()), maxValues(posteriors.GetDeviceId());
+        posteriors.VectorMax(maxIndexes, maxValues, true /*isColWise*/);
+        m_confidence.resize(numFrames);
+        ElemType* confidencePtr = m_confidence.data();
+        size_t confidenceCapacity = m_confidence.size();
+        maxValues.CopyToArray(confidencePtr, confidenceCapacity);
+
+        m_survivors.clear();
+        for (size_t t = 0; t < numFrames; t++)
+            if (m_confidence[t] < (ElemType) m_logThreshold)
+                m_survivors.push_back(t);
+        m_numFrames += numFrames;
+        m_numEscalated += m_survivors.size();
+
+        // stage 2: compact the low-confidence columns into a narrow minibatch for the full network
+        if (!m_survivors.empty())
+        {
+            ForwardProp(m_fullNet, m_fullInputs, m_fullInputBases, m_fullOutput, inputs, m_survivors.size(), &m_survivors);
+
+            m_packed.resize(rows * m_survivors.size());
+            ElemType* packedPtr = m_packed.data();
+            size_t packedCapacity = m_packed.size();
+            m_fullOutput.node->Value().CopyToArray(packedPtr, packedCapacity);
+            foreach_index (s, m_survivors) // scatter the full network's columns over the small network's answers
+                memcpy(&m_result[m_survivors[s] * rows], &m_packed[s * rows], rows * sizeof(ElemType));
+        }
+
+        std::vector<ElemType>& data = *outputs.begin()->second;
+        data = m_result;
+    }
+
+private:
+    // resolve the input/output node names in both networks and prepare them for evaluation
+    void BindNodes(const std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                   const std::map<std::wstring, std::vector<ElemType>*>& outputs)
+    {
+        if (outputs.size() != 1)
+            InvalidArgument("EvalCascade: exactly one output node must be requested, got %lu.", outputs.size());
+
+        for (const auto& iter : inputs)
+        {
+            m_smallInputs.push_back(Bind(m_smallNet, iter.first));
+            m_fullInputs.push_back(Bind(m_fullNet, iter.first));
+            if (m_smallInputs.back().rows != m_fullInputs.back().rows)
+                InvalidArgument("EvalCascade: input node '%ls' has dimension %lu in the cascade network but %lu in the full network.",
+                                iter.first.c_str(), m_smallInputs.back().rows, m_fullInputs.back().rows);
+            m_smallInputBases.push_back(m_smallInputs.back().node);
+            m_fullInputBases.push_back(m_fullInputs.back().node);
+        }
+        m_smallOutput = Bind(m_smallNet, outputs.begin()->first);
+        m_fullOutput = Bind(m_fullNet, outputs.begin()->first);
+        if (m_smallOutput.rows != m_fullOutput.rows)
+            InvalidArgument("EvalCascade: output node '%ls' has dimension %lu in the cascade network but %lu in the full network.",
+                            m_smallOutput.name.c_str(), m_smallOutput.rows, m_fullOutput.rows);
+
+        std::vector<ComputationNodeBasePtr> smallOutputs(1, m_smallOutput.node), fullOutputs(1, m_fullOutput.node);
+        m_smallNet->AllocateAllMatrices({}, smallOutputs, nullptr);
+        m_smallNet->StartEvaluateMinibatchLoop(smallOutputs);
+        m_fullNet->AllocateAllMatrices({}, fullOutputs, nullptr);
+        m_fullNet->StartEvaluateMinibatchLoop(fullOutputs);
+    }
+
+    BoundNode Bind(const ComputationNetworkPtr& net, const std::wstring& name)
+    {
+        BoundNode bound;
+        bound.name = name;
+        bound.node = dynamic_pointer_cast<ComputationNode<ElemType>>(net->GetNodeFromName(name));
+        bound.rows = bound.node->GetSampleMatrixNumRows();
+        return bound;
+    }
+
+    // feed 'numCols' frames of the caller's input data into 'net' and run one forward pass;
+    // if 'survivors' is given, only those columns are gathered (in that order)
+    void ForwardProp(const ComputationNetworkPtr& net,
+                     const std::vector<BoundNode>& boundInputs, const std::vector<ComputationNodeBasePtr>& inputBases,
+                     const BoundNode& boundOutput,
+                     const std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                     size_t numCols, const std::vector<size_t>* survivors)
+    {
+        for (const auto& bound : boundInputs)
+        {
+            const std::vector<ElemType>& data = *inputs.find(bound.name)->second;
+            const ElemType* source = data.data();
+            if (survivors != nullptr) // gather the survivor columns into a contiguous block
+            {
+                m_packed.resize(bound.rows * numCols);
+                foreach_index (s, *survivors)
+                    memcpy(&m_packed[s * bound.rows], &data[(*survivors)[s] * bound.rows], bound.rows * sizeof(ElemType));
+                source = m_packed.data();
+            }
+            bound.node->Value().SetValue(bound.rows, numCols, bound.node->Value().GetDeviceId(), const_cast<ElemType*>(source));
+            bound.node->NotifyFunctionValuesMBSizeModified();
+        }
+
+        // frame-mode layout: every column is its own sequence of length 1
+        auto pMBLayout = net->GetMBLayoutPtr();
+        pMBLayout->Init(numCols, 1);
+        for (size_t s = 0; s < numCols; s++)
+            pMBLayout->AddSequence(NEW_SEQUENCE_ID, s, 0, 1);
+
+        ComputationNetwork::BumpEvalTimeStamp(inputBases);
+        net->ForwardProp(static_pointer_cast<ComputationNodeBase>(boundOutput.node));
+    }
+};
+} } }
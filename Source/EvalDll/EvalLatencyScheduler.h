@@ -0,0 +1,301 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// EvalLatencyScheduler.h - two-queue scheduler for mixed batch/online scoring on one device
+//
+#pragma once
+
+#include <map>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+
+#include "ComputationNetwork.h"
+#include "ComputationNode.h"
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// EvalLatencyScheduler - latency-deadline scheduling for EvalDll
+// When batch rescoring and interactive traffic share one evaluator, a wide batch minibatch
+// occupies the device for tens of milliseconds--longer than an interactive caller's entire
+// latency budget. This class gives each traffic class its own queue: batch requests are
+// split into column sub-slices of at most 'sliceFrames' frames each, and the device is
+// handed over between slices, so an online request never waits longer than one slice.
+// Online requests have strict priority--a batch request may only take the device while no
+// online caller is queued. Every online wait is recorded, and the observed P50/P95/P99
+// together with the number of requests that exceeded the configured budget is reported
+// every 1000 online requests (and once more on shutdown), so the slice width can be tuned
+// against the budget.
+// Frame-mode scoring only: the slicing treats columns as independent frames, so recurrent
+// state would not survive it (the same restriction as the cascade mode).
+template <class ElemType>
+class EvalLatencyScheduler
+{
+    typedef shared_ptr<ComputationNode<ElemType>> ComputationNodePtr;
+
+    // a node we feed or read, resolved once on the first request
+    struct BoundNode
+    {
+        std::wstring name;
+        ComputationNodePtr node;
+        size_t rows;
+    };
+
+    ComputationNetworkPtr m_net;
+    const size_t m_sliceFrames; // batch requests are evaluated at most this many columns at a time
+    const double m_budgetMs;    // online waits beyond this count as budget misses in the report
+
+    std::mutex m_mutex;
+    std::condition_variable m_handover; // signals that the network became free
+    bool m_netBusy;                     // a request (or batch slice) is inside ForwardProp()
+    size_t m_onlineWaiting;             // online requests queued for the network right now
+
+    std::vector<BoundNode> m_inputNodes; // resolved from the first request's node names
+    std::vector<BoundNode> m_outputNodes;
+    std::vector<ComputationNodeBasePtr> m_inputNodeBases; // for BumpEvalTimeStamp()
+
+    // instrumentation, guarded by m_mutex; the counters cover the current report window
+    std::vector<double> m_waitSamples; // online wait times in ms, sorted by Report()
+    size_t m_numOnline;                // lifetime count, for the report cadence
+    size_t m_numBudgetMisses;
+    size_t m_numSlices;
+
+    static const size_t c_reportInterval = 1000; // report every this many online requests
+
+public:
+    EvalLatencyScheduler(ComputationNetworkPtr net, size_t sliceFrames, size_t budgetMs)
+        : m_net(net),
+          m_sliceFrames(max((size_t) 1, sliceFrames)),
+          m_budgetMs((double) budgetMs),
+          m_netBusy(false),
+          m_onlineWaiting(0),
+          m_numOnline(0),
+          m_numBudgetMisses(0),
+          m_numSlices(0)
+    {
+    }
+
+    ~EvalLatencyScheduler()
+    {
+        Report(); // flush the last partial window
+    }
+
+    // Evaluate - score one request
+    // inputs/outputs use the same conventions as IEvaluateModel::Evaluate().
+    // online - interactive request: takes the network at the next slice boundary, and its
+    //          wait is recorded against the budget. Otherwise the request is batch work:
+    //          it is evaluated slice by slice and yields in between.
+    void Evaluate(std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                  std::map<std::wstring, std::vector<ElemType>*>& outputs,
+                  bool online)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_inputNodes.empty())
+            BindNodes(inputs, outputs);
+        size_t numFrames = DetermineFrameCount(inputs, outputs);
+
+        // size the outputs up front so every slice can scatter its columns directly into place
+        for (const auto& bound : m_outputNodes)
+            outputs.find(bound.name)->second->resize(bound.rows * numFrames);
+
+        if (online)
+            EvaluateOnline(lock, inputs, outputs, numFrames);
+        else
+            EvaluateSliced(lock, inputs, outputs, numFrames);
+    }
+
+private:
+    // evaluate an interactive request in one piece, with priority over batch slices
+    void EvaluateOnline(std::unique_lock<std::mutex>& lock,
+                        std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                        std::map<std::wstring, std::vector<ElemType>*>& outputs,
+                        size_t numFrames)
+    {
+        auto arrived = std::chrono::steady_clock::now();
+        m_onlineWaiting++; // batch requests may not take the network while this is non-zero
+        m_handover.wait(lock, [this] { return !m_netBusy; });
+        m_onlineWaiting--;
+        m_netBusy = true;
+
+        double waitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - arrived).count();
+        m_waitSamples.push_back(waitMs);
+        if (waitMs > m_budgetMs)
+            m_numBudgetMisses++;
+        if (++m_numOnline % c_reportInterval == 0)
+            Report();
+
+        lock.unlock();
+        try
+        {
+            RunSlice(inputs, outputs, 0, numFrames);
+        }
+        catch (...)
+        {
+            ReleaseNetwork(lock);
+            throw;
+        }
+        ReleaseNetwork(lock);
+    }
+
+    // evaluate a batch request one column sub-slice at a time, yielding in between
+    void EvaluateSliced(std::unique_lock<std::mutex>& lock,
+                        std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                        std::map<std::wstring, std::vector<ElemType>*>& outputs,
+                        size_t numFrames)
+    {
+        for (size_t start = 0; start < numFrames; start += m_sliceFrames)
+        {
+            size_t sliceFrames = min(m_sliceFrames, numFrames - start);
+
+            // online callers go first: we may only run while none is queued
+            m_handover.wait(lock, [this] { return !m_netBusy && m_onlineWaiting == 0; });
+            m_netBusy = true;
+            m_numSlices++;
+
+            lock.unlock();
+            try
+            {
+                RunSlice(inputs, outputs, start, sliceFrames);
+            }
+            catch (...)
+            {
+                ReleaseNetwork(lock);
+                throw;
+            }
+            ReleaseNetwork(lock); // hand the network over before queueing for the next slice
+        }
+    }
+
+    // re-acquire the lock, mark the network free, and wake whoever queues for it
+    void ReleaseNetwork(std::unique_lock<std::mutex>& lock)
+    {
+        lock.lock();
+        m_netBusy = false;
+        m_handover.notify_all();
+    }
+
+    // evaluate columns [start, start + sliceFrames) of the request; called without the lock,
+    // with the network marked busy
+    void RunSlice(std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                  std::map<std::wstring, std::vector<ElemType>*>& outputs,
+                  size_t start, size_t sliceFrames)
+    {
+        // feed the slice; frame-mode data is column-major, so the slice is one contiguous
+        // block of the caller's buffer--a column slice that the CPU wraps in place (no copy),
+        // while a GPU device needs one host-to-device transfer per slice
+        for (const auto& bound : m_inputNodes)
+        {
+            const std::vector<ElemType>& data = *inputs.find(bound.name)->second;
+            const int deviceId = bound.node->Value().GetDeviceId();
+            bound.node->Value().SetValue(bound.rows, sliceFrames, deviceId,
+                                         const_cast<ElemType*>(&data[start * bound.rows]),
+                                         deviceId < 0 ? matrixFlagDontOwnBuffer : matrixFlagNormal);
+            bound.node->NotifyFunctionValuesMBSizeModified();
+        }
+
+        // frame-mode layout: every column is its own sequence of length 1
+        auto pMBLayout = m_net->GetMBLayoutPtr();
+        pMBLayout->Init(sliceFrames, 1);
+        for (size_t s = 0; s < sliceFrames; s++)
+            pMBLayout->AddSequence(NEW_SEQUENCE_ID, s, 0, 1);
+
+        ComputationNetwork::BumpEvalTimeStamp(m_inputNodeBases);
+
+        for (const auto& bound : m_outputNodes)
+            m_net->ForwardProp(static_pointer_cast<ComputationNodeBase>(bound.node));
+
+        // scatter the result columns into their place in the caller's output vectors
+        for (const auto& bound : m_outputNodes)
+        {
+            std::vector<ElemType>& data = *outputs.find(bound.name)->second;
+            // the capacity matches the slice exactly, so CopyToArray() will not reallocate
+            ElemType* sliceData = &data[start * bound.rows];
+            size_t capacity = bound.rows * sliceFrames;
+            bound.node->Value().CopyToArray(sliceData, capacity);
+        }
+    }
+
+    // resolve node names to nodes once, from the first request
+    void BindNodes(const std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                   const std::map<std::wstring, std::vector<ElemType>*>& outputs)
+    {
+        for (const auto& iter : inputs)
+        {
+            BoundNode bound;
+            bound.name = iter.first;
+            bound.node = dynamic_pointer_cast<ComputationNode<ElemType>>(m_net->GetNodeFromName(iter.first));
+            bound.rows = bound.node->GetSampleMatrixNumRows();
+            m_inputNodes.push_back(bound);
+            m_inputNodeBases.push_back(bound.node);
+        }
+        std::vector<ComputationNodeBasePtr> outputNodes;
+        for (const auto& iter : outputs)
+        {
+            BoundNode bound;
+            bound.name = iter.first;
+            bound.node = dynamic_pointer_cast<ComputationNode<ElemType>>(m_net->GetNodeFromName(iter.first));
+            bound.rows = bound.node->GetSampleMatrixNumRows();
+            m_outputNodes.push_back(bound);
+            outputNodes.push_back(bound.node);
+        }
+
+        m_net->AllocateAllMatrices({}, outputNodes, nullptr);
+        m_net->StartEvaluateMinibatchLoop(outputNodes);
+    }
+
+    // determine and validate the frame count of the request against the bound nodes
+    size_t DetermineFrameCount(const std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                               const std::map<std::wstring, std::vector<ElemType>*>& outputs) const
+    {
+        size_t numFrames = 0;
+        for (const auto& bound : m_inputNodes)
+        {
+            auto iter = inputs.find(bound.name);
+            if (iter == inputs.end())
+                InvalidArgument("EvalLatencyScheduler: request is missing data for input node '%ls'.", bound.name.c_str());
+            size_t n = iter->second->size() / bound.rows;
+            if (n == 0 || n * bound.rows != iter->second->size())
+                InvalidArgument("EvalLatencyScheduler: data for input node '%ls' is not a non-empty multiple of its dimension %lu.", bound.name.c_str(), bound.rows);
+            if (numFrames == 0)
+                numFrames = n;
+            else if (n != numFrames)
+                InvalidArgument("EvalLatencyScheduler: frame count of input node '%ls' (%lu) does not match that of previous entries (%lu).", bound.name.c_str(), n, numFrames);
+        }
+        for (const auto& bound : m_outputNodes)
+        {
+            if (outputs.find(bound.name) == outputs.end())
+                InvalidArgument("EvalLatencyScheduler: request is missing a vector for output node '%ls'.", bound.name.c_str());
+        }
+        return numFrames;
+    }
+
+    // print the online wait-time distribution of the current window; called with m_mutex held
+    // (or from the destructor, when no caller can be active anymore)
+    void Report()
+    {
+        if (m_waitSamples.empty())
+            return;
+        std::sort(m_waitSamples.begin(), m_waitSamples.end());
+        double sum = 0;
+        for (double w : m_waitSamples)
+            sum += w;
+        size_t n = m_waitSamples.size();
+        fprintf(stderr, "EvalLatencyScheduler: %lu online requests: wait mean %.3f ms, P50 %.3f, P95 %.3f, P99 %.3f, max %.3f; %lu exceeded the %.0f ms budget; %lu batch slices ran\n",
+                n, sum / n, Percentile(0.50), Percentile(0.95), Percentile(0.99), m_waitSamples.back(),
+                m_numBudgetMisses, m_budgetMs, m_numSlices);
+        m_waitSamples.clear();
+        m_numBudgetMisses = 0;
+        m_numSlices = 0;
+    }
+
+    // percentile of the (already sorted) wait samples
+    double Percentile(double q) const
+    {
+        return m_waitSamples[(size_t)(q * (m_waitSamples.size() - 1))];
+    }
+};
+} } }
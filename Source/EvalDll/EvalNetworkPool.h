@@ -0,0 +1,157 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// EvalNetworkPool.h - dispatches concurrent Evaluate() calls to a pool of network instances
+//
+#pragma once
+
+#include <map>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+#include "ComputationNetwork.h"
+#include "EvalReader.h"
+#include "EvalWriter.h"
+#include "SimpleOutputWriter.h"
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// EvalNetworkPool - thread-parallel evaluation for EvalDll
+// A single network instance serializes Evaluate() calls: each call owns the node value
+// matrices for the duration of its forward pass, so on a many-core evaluation server most
+// cores sit idle. This class keeps N instances of the same network, each with its own node
+// value matrices but all referencing one shared read-only copy of the learnable parameters
+// (see ComputationNetwork::ShareLearnableParametersFrom()), and hands each incoming
+// Evaluate() call to a free instance, blocking when all N are busy.
+template <class ElemType>
+class EvalNetworkPool
+{
+    // one network instance plus its private reader/writer shims
+    struct Instance
+    {
+        ComputationNetworkPtr net;
+        std::unique_ptr<EvalReader<ElemType>> reader;
+        std::unique_ptr<EvalWriter<ElemType>> writer;
+        std::map<std::wstring, size_t> inputDimensions;
+        std::map<std::wstring, size_t> outputDimensions;
+        bool busy = false;
+    };
+
+    std::vector<Instance> m_instances;
+    std::mutex m_mutex;
+    std::condition_variable m_freed; // signals waiters that an instance has been released
+
+public:
+    // Creates the pool. 'primaryNet' becomes instance 0 and owns the weights; the other
+    // numInstances-1 are loaded from 'modelFileName' with value loading deferred (so the
+    // weights are not read again where the file format allows it) and then re-pointed at
+    // the primary's weight matrices.
+    EvalNetworkPool(ComputationNetworkPtr primaryNet, const std::wstring& modelFileName,
+                    DEVICEID_TYPE deviceId, size_t numInstances)
+    {
+        if (numInstances < 2)
+            InvalidArgument("EvalNetworkPool: at least 2 network instances are required.");
+
+        m_instances.resize(numInstances);
+        m_instances[0].net = primaryNet;
+        for (size_t i = 1; i < numInstances; i++)
+        {
+            auto net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, modelFileName, FileOptions::fileOptionsBinary,
+                                                                    false /*bAllowNoCriterionNode*/, nullptr /*anotherNetwork*/,
+                                                                    true /*deferValueLoading*/);
+            net->template ShareLearnableParametersFrom<ElemType>(primaryNet);
+            m_instances[i].net = net;
+        }
+    }
+
+    // StartEvaluateMinibatchLoop - prepare all instances for Evaluate() calls
+    // The primary instance goes first, since it is the one that materializes any deferred
+    // weights into the shared matrices.
+    void StartEvaluateMinibatchLoop(const std::wstring& outputNodeName)
+    {
+        for (auto& instance : m_instances)
+            instance.net->StartEvaluateMinibatchLoop(instance.net->GetNodeFromName(outputNodeName));
+    }
+
+    // Evaluate - score one request on a free instance, blocking while all are busy
+    // inputs/outputs use the same conventions as IEvaluateModel::Evaluate().
+    void Evaluate(std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                  std::map<std::wstring, std::vector<ElemType>*>& outputs,
+                  size_t minibatchSize)
+    {
+        Instance* instance;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            for (;;)
+            {
+                instance = FindFreeInstance();
+                if (instance != nullptr)
+                    break;
+                m_freed.wait(lock);
+            }
+            instance->busy = true;
+        }
+
+        // evaluate outside the lock; other threads use other instances concurrently
+        std::exception_ptr error;
+        try
+        {
+            EvaluateOnInstance(*instance, inputs, outputs, minibatchSize);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            instance->busy = false;
+        }
+        m_freed.notify_one();
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    Instance* FindFreeInstance() // caller must hold m_mutex
+    {
+        for (auto& instance : m_instances)
+            if (!instance.busy)
+                return &instance;
+        return nullptr;
+    }
+
+    // same evaluation path as the single-instance CNTKEval::Evaluate(), but against this
+    // instance's private network and reader/writer shims
+    void EvaluateOnInstance(Instance& instance,
+                            std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                            std::map<std::wstring, std::vector<ElemType>*>& outputs,
+                            size_t minibatchSize)
+    {
+        ConfigParameters config;
+        if (instance.reader == nullptr)
+        {
+            instance.reader.reset(new EvalReader<ElemType>(config));
+            const auto& outputNodes = instance.net->OutputNodes();
+            for (const auto& node : instance.net->InputNodes(outputNodes[0]))
+                instance.inputDimensions[node->NodeName()] = node->GetSampleMatrixNumRows();
+            for (const auto& node : outputNodes)
+                instance.outputDimensions[node->NodeName()] = node->GetSampleMatrixNumRows();
+        }
+        instance.reader->SetData(&inputs, &instance.inputDimensions);
+        instance.reader->SetBoundary(0);
+
+        if (instance.writer == nullptr)
+            instance.writer.reset(new EvalWriter<ElemType>(config));
+        instance.writer->SetData(&outputs, &instance.outputDimensions);
+
+        std::vector<std::wstring> outNodeNames;
+        SimpleOutputWriter<ElemType> eval(instance.net);
+        eval.WriteOutput(*instance.reader, minibatchSize, *instance.writer, outNodeNames);
+    }
+};
+} } }
@@ -0,0 +1,244 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// EvalRequestBatcher.h - aggregates concurrent Evaluate() requests into one wide minibatch
+//
+#pragma once
+
+#include <map>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
+
+#include "ComputationNetwork.h"
+#include "ComputationNode.h"
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// EvalRequestBatcher - batched server mode for EvalDll
+// Many concurrent callers each scoring a single utterance would otherwise run one
+// ForwardProp() of minibatch width 1 each, leaving most of the device idle. This class
+// queues incoming requests for up to a configurable deadline, packs whatever arrived into
+// one minibatch of parallel sequences (one MBLayout sequence per request, gaps padded),
+// runs a single ForwardProp(), and scatters the result columns back to the callers.
+// The first caller to arrive becomes the leader that waits out the deadline and evaluates;
+// all other callers block until their results are filled in.
+template <class ElemType>
+class EvalRequestBatcher
+{
+    typedef shared_ptr<ComputationNode<ElemType>> ComputationNodePtr;
+
+    // one pending Evaluate() call
+    struct Request
+    {
+        std::map<std::wstring, std::vector<ElemType>*>* inputs;
+        std::map<std::wstring, std::vector<ElemType>*>* outputs;
+        size_t numFrames;          // frames in this utterance
+        bool done;                 // set by the leader once outputs are filled in
+        std::exception_ptr error;  // set instead of 'done' data when the batch failed
+    };
+
+    // a node we pack into or scatter from, resolved once on the first batch
+    struct BoundNode
+    {
+        std::wstring name;
+        ComputationNodePtr node;
+        size_t rows;
+    };
+
+    ComputationNetworkPtr m_net;
+    const std::chrono::microseconds m_deadline; // how long the leader waits for more requests
+    const size_t m_maxRequests;                 // evaluate immediately once this many are queued
+
+    std::mutex m_mutex;
+    std::condition_variable m_arrived;   // signals the leader that the batch is full
+    std::condition_variable m_completed; // signals followers that their request is done
+    std::vector<Request*> m_pending;
+    bool m_netBusy; // a leader is currently inside ForwardProp()
+
+    std::vector<BoundNode> m_inputNodes;  // resolved from the first request's node names
+    std::vector<BoundNode> m_outputNodes;
+    std::vector<ComputationNodeBasePtr> m_inputNodeBases; // for BumpEvalTimeStamp()
+    std::vector<ElemType> m_packed;       // reused gather/scatter staging buffer
+
+public:
+    EvalRequestBatcher(ComputationNetworkPtr net, size_t deadlineMs, size_t maxRequests)
+        : m_net(net),
+          m_deadline(1000 * deadlineMs),
+          m_maxRequests(max((size_t) 1, maxRequests)),
+          m_netBusy(false)
+    {
+    }
+
+    // Evaluate - queue one utterance and block until its outputs have been filled in
+    // inputs/outputs use the same conventions as IEvaluateModel::Evaluate().
+    void Evaluate(std::map<std::wstring, std::vector<ElemType>*>& inputs,
+                  std::map<std::wstring, std::vector<ElemType>*>& outputs)
+    {
+        Request request;
+        request.inputs = &inputs;
+        request.outputs = &outputs;
+        request.numFrames = 0; // determined by the leader, which knows the node dimensions
+        request.done = false;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_pending.push_back(&request);
+        if (m_pending.size() == 1)
+        {
+            // we are the leader: wait out the deadline for more requests to arrive
+            m_arrived.wait_for(lock, m_deadline, [this] { return m_pending.size() >= m_maxRequests; });
+
+            // wait for a previous leader to vacate the network
+            while (m_netBusy)
+                m_completed.wait(lock);
+
+            std::vector<Request*> batch;
+            batch.swap(m_pending);
+            m_netBusy = true;
+            lock.unlock(); // new requests may queue up behind a new leader while we evaluate
+
+            try
+            {
+                RunBatch(batch);
+            }
+            catch (...)
+            {
+                for (Request* r : batch)
+                    r->error = std::current_exception();
+            }
+
+            lock.lock();
+            for (Request* r : batch)
+                r->done = true;
+            m_netBusy = false;
+            m_completed.notify_all();
+        }
+        else
+        {
+            if (m_pending.size() >= m_maxRequests)
+                m_arrived.notify_one(); // batch is full: wake the leader before its deadline
+            m_completed.wait(lock, [&request] { return request.done; });
+        }
+
+        if (request.error)
+            std::rethrow_exception(request.error);
+    }
+
+private:
+    // resolve node names to nodes once, from the shape of the first request
+    void BindNodes(const Request& request)
+    {
+        for (const auto& iter : *request.inputs)
+        {
+            BoundNode bound;
+            bound.name = iter.first;
+            bound.node = dynamic_pointer_cast<ComputationNode<ElemType>>(m_net->GetNodeFromName(iter.first));
+            bound.rows = bound.node->GetSampleMatrixNumRows();
+            m_inputNodes.push_back(bound);
+            m_inputNodeBases.push_back(bound.node);
+        }
+        std::vector<ComputationNodeBasePtr> outputNodes;
+        for (const auto& iter : *request.outputs)
+        {
+            BoundNode bound;
+            bound.name = iter.first;
+            bound.node = dynamic_pointer_cast<ComputationNode<ElemType>>(m_net->GetNodeFromName(iter.first));
+            bound.rows = bound.node->GetSampleMatrixNumRows();
+            m_outputNodes.push_back(bound);
+            outputNodes.push_back(bound.node);
+        }
+
+        m_net->AllocateAllMatrices({}, outputNodes, nullptr);
+        m_net->StartEvaluateMinibatchLoop(outputNodes);
+    }
+
+    // determine and validate the frame count of each request
+    void DetermineFrameCounts(const std::vector<Request*>& batch)
+    {
+        for (Request* r : batch)
+        {
+            for (const auto& bound : m_inputNodes)
+            {
+                auto iter = r->inputs->find(bound.name);
+                if (iter == r->inputs->end())
+                    InvalidArgument("EvalRequestBatcher: request is missing data for input node '%ls'.", bound.name.c_str());
+                size_t numFrames = iter->second->size() / bound.rows;
+                if (numFrames == 0 || numFrames * bound.rows != iter->second->size())
+                    InvalidArgument("EvalRequestBatcher: data for input node '%ls' is not a multiple of its dimension %lu.", bound.name.c_str(), bound.rows);
+                if (r->numFrames == 0)
+                    r->numFrames = numFrames;
+                else if (r->numFrames != numFrames)
+                    InvalidArgument("EvalRequestBatcher: frame count of input node '%ls' (%lu) does not match that of previous entries (%lu).", bound.name.c_str(), numFrames, r->numFrames);
+            }
+            for (const auto& bound : m_outputNodes)
+            {
+                if (r->outputs->find(bound.name) == r->outputs->end())
+                    InvalidArgument("EvalRequestBatcher: request is missing a vector for output node '%ls'.", bound.name.c_str());
+            }
+        }
+    }
+
+    // pack all requests into one minibatch, run one ForwardProp(), scatter the results
+    void RunBatch(const std::vector<Request*>& batch)
+    {
+        if (m_inputNodes.empty())
+            BindNodes(*batch[0]);
+        DetermineFrameCounts(batch);
+
+        const size_t numSeqs = batch.size();
+        size_t maxNumFrames = 0;
+        for (const Request* r : batch)
+            maxNumFrames = max(maxNumFrames, r->numFrames);
+
+        // lay out one parallel sequence per request; shorter ones are followed by gap columns
+        auto pMBLayout = m_net->GetMBLayoutPtr();
+        pMBLayout->Init(numSeqs, maxNumFrames);
+        for (size_t s = 0; s < numSeqs; s++)
+        {
+            pMBLayout->AddSequence(NEW_SEQUENCE_ID, s, 0, batch[s]->numFrames);
+            if (batch[s]->numFrames < maxNumFrames)
+                pMBLayout->AddGap(s, batch[s]->numFrames, maxNumFrames);
+        }
+
+        // gather the input data; column of frame t of sequence s is t * numSeqs + s
+        for (const auto& bound : m_inputNodes)
+        {
+            m_packed.assign(bound.rows * numSeqs * maxNumFrames, 0);
+            for (size_t s = 0; s < numSeqs; s++)
+            {
+                const std::vector<ElemType>& data = *batch[s]->inputs->find(bound.name)->second;
+                for (size_t t = 0; t < batch[s]->numFrames; t++)
+                    memcpy(&m_packed[(t * numSeqs + s) * bound.rows], &data[t * bound.rows], bound.rows * sizeof(ElemType));
+            }
+            bound.node->Value().SetValue(bound.rows, numSeqs * maxNumFrames, bound.node->Value().GetDeviceId(), m_packed.data());
+            bound.node->NotifyFunctionValuesMBSizeModified();
+        }
+
+        ComputationNetwork::BumpEvalTimeStamp(m_inputNodeBases);
+
+        // one forward pass for the entire batch
+        for (const auto& bound : m_outputNodes)
+            m_net->ForwardProp(static_pointer_cast<ComputationNodeBase>(bound.node));
+
+        // scatter the result columns back to the individual callers
+        for (const auto& bound : m_outputNodes)
+        {
+            m_packed.resize(bound.rows * numSeqs * maxNumFrames);
+            ElemType* arrayCopyTo = m_packed.data();
+            size_t capacity = m_packed.size();
+            bound.node->Value().CopyToArray(arrayCopyTo, capacity);
+            for (size_t s = 0; s < numSeqs; s++)
+            {
+                std::vector<ElemType>& data = *batch[s]->outputs->find(bound.name)->second;
+                data.resize(bound.rows * batch[s]->numFrames);
+                for (size_t t = 0; t < batch[s]->numFrames; t++)
+                    memcpy(&data[t * bound.rows], &m_packed[(t * numSeqs + s) * bound.rows], bound.rows * sizeof(ElemType));
+            }
+        }
+    }
+};
+} } }
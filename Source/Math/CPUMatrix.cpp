@@ -10,7 +10,9 @@
 #include "File.h"
 
 #include "CPUMatrix.h"
+#include "CPUMatrixAvxKernels.h"
 #include "TensorOps.h"
+#include "HalfConverter.h"
 #include <assert.h>
 #include <stdexcept>
 #include <omp.h>
@@ -21,14 +23,24 @@
 #include <thread>
 #include <iostream>
 #include <algorithm>
+#include <mutex>
+#include <unordered_set>
+#include <map>
+#include <functional>
+#include <emmintrin.h> // SSE2 integer multiply-add, for the quantized inference product
+#include "logsumexp.h" // batched logadd, for the CRF functions
 #ifdef _WIN32
 #define NOMINMAX
 #include "Windows.h"
+#include "numahelpers.h" // for NUMA-aware allocation of large matrix buffers
 #else
 #ifndef max
 #define max(a, b) (((a) > (b)) ? (a) : (b))
 #endif
 #include <cfloat>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h> // for madvise() (huge-page backing of large matrix buffers)
 #endif
 
 #ifdef LEAKDETECT
@@ -49,6 +61,9 @@
 #else
 // requires MKL 10.0 and above
 #include <mkl.h>
+#if defined(INTEL_MKL_VERSION) && INTEL_MKL_VERSION >= 110300
+#define HAVE_MKL_PACKED_GEMM // cblas_sgemm_alloc/_pack/_compute: persistently packed GEMM operands
+#endif
 #endif
 
 #ifndef USE_MKL // MKL has one additional parameter for different matrix order
@@ -107,6 +122,154 @@ enum class MatrixOpSide : char
 };
 #pragma endregion Helpful Enum Definitions
 
+// Entering an OpenMP parallel region costs a fork/join barrier on every call; for the small
+// matrices inside recurrent loops that overhead exceeds the loop body itself. The elementwise
+// loops below therefore carry an if() clause that keeps them on the calling thread until the
+// total element count reaches this threshold. Tunable via SetElementwiseParallelThreshold(),
+// or measured on the actual machine by CalibrateParallelism().
+static long s_elementwiseParallelThreshold = 16384;
+
+// Between going parallel at all and being large enough to feed every core, there is a middle
+// range where a few threads amortize the fork/join cost but 32 threads doing ~100 elements
+// each are slower than one. Loops below that pick their team size via ElementwiseThreadTeam()
+// use a small team in that range and the full team above s_elementwiseFullTeamThreshold.
+// The default equals the parallel threshold, i.e. full team right away; CalibrateParallelism()
+// measures the actual crossover.
+static long s_elementwiseFullTeamThreshold = 16384;
+static int s_elementwiseSmallTeamThreads = 4;
+
+static inline int ElementwiseThreadTeam(long n)
+{
+#ifdef _OPENMP
+    int maxThreads = omp_get_max_threads();
+    if (n < s_elementwiseFullTeamThreshold && s_elementwiseSmallTeamThreads < maxThreads)
+        return s_elementwiseSmallTeamThreads;
+    return maxThreads;
+#else
+    UNUSED(n);
+    return 1;
+#endif
+}
+
+// OpenMP team size for a flat elementwise pass over n elements, 1 meaning stay on the
+// calling thread; hands the parallelization decision of the thresholds above to the AVX
+// kernels (CPUMatrixAvxKernels.h), which live in a separate translation unit. The kernels
+// themselves are only reachable when CpuSupportsAvx2Fma() said so at run time; the scalar
+// loops below each call site remain the fallback for every other machine.
+static inline int ElementwiseThreads(long n)
+{
+    return n >= s_elementwiseParallelThreshold ? ElementwiseThreadTeam(n) : 1;
+}
+
+// -----------------------------------------------------------------------
+// fixed-row-count kernels for the standard layer widths
+// -----------------------------------------------------------------------
+// Production layer widths cluster on a few powers of two. The kernels below take
+// the row count as a template parameter, so for those widths the per-column inner
+// loop has a compile-time trip count and the compiler vectorizes it fully, with no
+// remainder loop and no stride bookkeeping. A parameter of 0 means the row count is
+// only known at run time (the generic fallback); DISPATCH_ON_FIXED_ROW_COUNT()
+// performs the runtime selection. The matrices are assumed dense with column
+// stride == row count, which holds for the whole-matrix operations that use this.
+
+// invoke kernel<ElemType, rows>(args...), with rows a compile-time constant when
+// the runtime row count matches one of the standard layer widths
+#define DISPATCH_ON_FIXED_ROW_COUNT(m, kernel, ...)        \
+    switch (m)                                             \
+    {                                                      \
+    case 256:  kernel<ElemType, 256>(__VA_ARGS__); break;  \
+    case 512:  kernel<ElemType, 512>(__VA_ARGS__); break;  \
+    case 1024: kernel<ElemType, 1024>(__VA_ARGS__); break; \
+    case 2048: kernel<ElemType, 2048>(__VA_ARGS__); break; \
+    default:   kernel<ElemType, 0>(__VA_ARGS__); break;    \
+    }
+
+// c[:,j] += alpha * a  for a column vector a (bias add)
+template <class ElemType, long fixedRows>
+static void ColumnwiseScaleAndAddColumnVector(long m, long n, ElemType alpha, const ElemType* a, ElemType* c)
+{
+    const long rows = fixedRows != 0 ? fixedRows : m;
+#pragma omp parallel for if (rows * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(rows * n))
+    for (long j = 0; j < n; j++)
+    {
+        ElemType* pc = c + j * rows;
+        for (long i = 0; i < rows; i++)
+            pc[i] += alpha * a[i];
+    }
+}
+
+template <class ElemType, long fixedRows>
+static void ColumnwiseSigmoid(long m, long n, const ElemType* a, ElemType* us)
+{
+    const long rows = fixedRows != 0 ? fixedRows : m;
+#pragma omp parallel for if (rows * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(rows * n))
+    for (long j = 0; j < n; j++)
+    {
+        const ElemType* pa = a + j * rows;
+        ElemType* pus = us + j * rows;
+        for (long i = 0; i < rows; i++)
+        {
+            if (pa[i] >= 0)
+                pus[i] = 1 / (1 + exp(-pa[i]));
+            else
+            {
+                ElemType v = exp(pa[i]);
+                pus[i] = v / (1 + v);
+            }
+        }
+    }
+}
+
+template <class ElemType, long fixedRows>
+static void ColumnwiseSigmoidDerivative(long m, long n, const ElemType* a, ElemType* us)
+{
+    const long rows = fixedRows != 0 ? fixedRows : m;
+#pragma omp parallel for if (rows * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(rows * n))
+    for (long j = 0; j < n; j++)
+    {
+        const ElemType* pa = a + j * rows;
+        ElemType* pus = us + j * rows;
+        for (long i = 0; i < rows; i++)
+        {
+            ElemType v = pa[i];
+            pus[i] = v * (1 - v);
+        }
+    }
+}
+
+template <class ElemType, long fixedRows>
+static void ColumnwiseLinearRectifierDerivative(long m, long n, const ElemType* a, ElemType* us)
+{
+    const long rows = fixedRows != 0 ? fixedRows : m;
+#pragma omp parallel for if (rows * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(rows * n))
+    for (long j = 0; j < n; j++)
+    {
+        const ElemType* pa = a + j * rows;
+        ElemType* pus = us + j * rows;
+        for (long i = 0; i < rows; i++)
+            pus[i] = pa[i] > 0.0f ? 1.0f : 0.0f;
+    }
+}
+
+// Fixed-order parallel sum for determinism mode (see IsDeterministicComputation()): the
+// chunk layout depends only on the element count, not on the number of OpenMP threads,
+// and the per-chunk partials are combined in index order, so the result is bitwise-
+// identical across runs and thread counts. rangeSum(begin, end) sums one chunk.
+template <typename AccumType, typename RangeSumFn>
+static AccumType SumInFixedOrder(long n, const RangeSumFn& rangeSum)
+{
+    const long chunkSize = 16384;
+    long numChunks = (n + chunkSize - 1) / chunkSize;
+    std::vector<AccumType> partials(numChunks, 0);
+#pragma omp parallel for schedule(static) if (n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(n))
+    for (long c = 0; c < numChunks; c++)
+        partials[c] = rangeSum(c * chunkSize, min(n, (c + 1) * chunkSize));
+    AccumType sum = 0;
+    for (long c = 0; c < numChunks; c++)
+        sum += partials[c];
+    return sum;
+}
+
 #pragma region Constructors and Destructor
 
 //should only be used by constructors.
@@ -151,6 +314,91 @@ static ElemType* NewArray(size_t n)
     return p;
 }
 
+// NUMA-aware placement of large matrix buffers (see SetNumaAllocationPolicy())
+// The parallelized elementwise loops stream these buffers, and on multi-socket machines
+// streaming from a remote node is substantially slower than from the local one.
+#ifdef _WIN32
+static NumaAllocationPolicy s_numaAllocationPolicy = NumaAllocationPolicy::none;
+static std::mutex s_numaAllocationsLock;
+static std::unordered_set<void*> s_numaAllocations;         // buffers from numa::malloc(), which must go back to numa::free()
+static const size_t numaAllocationThreshold = 1024 * 1024;  // below this, placement does not matter (and numa::malloc() rounds up to 1 MB anyway)
+#else
+static bool s_useHugePageAllocations = false;               // see SetUseHugePages()
+static const size_t hugePageSize = 2 * 1024 * 1024;         // x64 large-page size; buffers at least this big are eligible
+#endif
+
+// allocate the matrix's own buffer (m_pArray); always free through FreeArray()
+// All buffers come back CPU_MATRIX_BUFFER_ALIGNMENT-aligned and zero-initialized. Large buffers
+// honor the NUMA allocation policy (Windows) or, when enabled, get 2 MB-aligned and advised for
+// transparent-huge-page backing (Linux), which cuts TLB misses for multi-GB parameter sets.
+// Arrays handed out to callers (CopyToArray()) do not come through here, since callers free
+// those with delete[].
+template <class ElemType>
+static ElemType* AllocateArray(size_t n)
+{
+    size_t bytes = n * sizeof(ElemType);
+    if (bytes == 0)
+        bytes = 1; // hand out a valid pointer for empty matrices, like new[]
+#ifdef _WIN32
+    if (s_numaAllocationPolicy != NumaAllocationPolicy::none && bytes >= numaAllocationThreshold)
+    {
+        std::lock_guard<std::mutex> lock(s_numaAllocationsLock);
+        if (s_numaAllocationPolicy == NumaAllocationPolicy::interleave)
+        {
+            // round-robin the target node; overridenode() is a global, hence the lock
+            static size_t nextNode = 0;
+            msra::numa::overridenode((int) (nextNode++ % msra::numa::getnumnodes()));
+        }
+        void* p = msra::numa::malloc(bytes, CPU_MATRIX_BUFFER_ALIGNMENT);
+        msra::numa::overridenode(-1);
+        if (p != nullptr) // (the memory comes zero-initialized, like new[])
+        {
+            s_numaAllocations.insert(p);
+            return (ElemType*) p;
+        }
+    }
+    void* p = _aligned_malloc(bytes, CPU_MATRIX_BUFFER_ALIGNMENT);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    memset(p, 0, bytes);
+    return (ElemType*) p;
+#else
+    bool wantHugePages = s_useHugePageAllocations && bytes >= hugePageSize;
+    // 2 MB-align eligible buffers so that the whole range can be backed by huge pages
+    size_t alignment = wantHugePages ? hugePageSize : CPU_MATRIX_BUFFER_ALIGNMENT;
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, bytes) != 0)
+        throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if (wantHugePages)
+        madvise(p, bytes, MADV_HUGEPAGE); // best effort; regular 4K pages if THP is unavailable
+#endif
+    // zero-initialize like new[]; this also faults the pages in while the madvise is in effect
+    memset(p, 0, bytes);
+    return (ElemType*) p;
+#endif
+}
+
+// free a buffer that was allocated through AllocateArray()
+template <class ElemType>
+static void FreeArray(ElemType* p)
+{
+#ifdef _WIN32
+    if (p != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(s_numaAllocationsLock);
+        if (s_numaAllocations.erase(p) > 0)
+        {
+            msra::numa::free(p);
+            return;
+        }
+    }
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
 template <class ElemType>
 CPUMatrix<ElemType>::CPUMatrix(const size_t numRows, const size_t numCols)
 {
@@ -161,7 +409,7 @@ CPUMatrix<ElemType>::CPUMatrix(const size_t numRows, const size_t numCols)
     m_elemSizeAllocated = GetNumElements();
 
     if (m_elemSizeAllocated != 0)
-        m_pArray = NewArray<ElemType>(m_elemSizeAllocated);
+        m_pArray = AllocateArray<ElemType>(m_elemSizeAllocated);
 }
 
 template <class ElemType>
@@ -215,7 +463,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::operator=(CPUMatrix<ElemType>&& moveFr
     if (this != &moveFrom)
     {
         if (OwnBuffer() && m_pArray != nullptr)
-            delete[] m_pArray; // always delete the data pointer since we will use the pointer from moveFrom
+            FreeArray(m_pArray); // always delete the data pointer since we will use the pointer from moveFrom
 
         m_computeDevice = moveFrom.m_computeDevice;
         m_numRows = moveFrom.m_numRows;
@@ -242,7 +490,7 @@ void CPUMatrix<ElemType>::Clear()
 {
     if (m_pArray != nullptr && OwnBuffer())
     {
-        delete[] m_pArray;
+        FreeArray(m_pArray);
         m_pArray = nullptr;
         m_elemSizeAllocated = 0;
     }
@@ -329,25 +577,12 @@ void CPUMatrix<ElemType>::CopyColumnsStrided(const CPUMatrix<ElemType>& fromMatr
 
     long n = (long) numCols, m = (long) m_numRows;
 
-    auto& us = *this;
-
-#pragma omp parallel for
+    // the elements of a column are contiguous, so each column is one bulk copy; only the
+    // columns themselves are strided
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
-        // four-way unrolling
-        for (size_t i = 0; i < (m & ~3); i += 4)
-        {
-            us(i, j * destNumColsStride) = fromMatrix(i, j * srcNumColsStride);
-            us(i + 1, j * destNumColsStride) = fromMatrix(i + 1, j * srcNumColsStride);
-            us(i + 2, j * destNumColsStride) = fromMatrix(i + 2, j * srcNumColsStride);
-            us(i + 3, j * destNumColsStride) = fromMatrix(i + 3, j * srcNumColsStride);
-        }
-
-        // handle remaining
-        for (size_t i = m & ~3; i < m; i++)
-        {
-            us(i, j * destNumColsStride) = fromMatrix(i, j * srcNumColsStride);
-        }
+        memcpy(m_pArray + (j * destNumColsStride) * m, fromMatrix.m_pArray + (j * srcNumColsStride) * m, m * sizeof(ElemType));
     }
 }
 
@@ -368,7 +603,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignToRowSliceValuesOf(const CPUMatr
 
     auto& us = *this;
 
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -401,7 +636,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignRowSliceValuesOf(const CPUMatrix
     long n = (long) a.GetNumCols(); // note: OpenMP requires loop indices to be long, not size_t
     long k = (long) a.GetNumRows();
 
-#pragma omp parallel for
+#pragma omp parallel for if (n * (long) numRows >= s_elementwiseParallelThreshold)
     for (long j = 0; j < n; j++)
     {
         // memory copy might be faster?
@@ -445,7 +680,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddToRowSliceValuesOf(const CPUMatrix<
 
     auto& us = *this;
 
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -486,7 +721,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddWithRowSliceValuesOf(const CPUMatri
 
     auto& us = *this;
 
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -507,6 +742,121 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddWithRowSliceValuesOf(const CPUMatri
     return *this;
 }
 
+// gather/scatter by a row-index matrix
+// 'idx' holds row indices into the larger matrix, stored as ElemType. It has either a single
+// column (the same indices apply to every minibatch column) or one column per minibatch
+// column (per-frame indices). Unlike RowSlice, the selected rows need not be contiguous.
+
+// checks that every element of idx is a valid row index into a matrix with numRows rows
+template <class ElemType>
+static void VerifyRowIndices(const CPUMatrix<ElemType>& idx, const size_t numRows, const char* caller)
+{
+    foreach_coord (i, j, idx)
+    {
+        if (idx(i, j) < 0 || (size_t) idx(i, j) >= numRows)
+            InvalidArgument("%s: index (%ld) out of range [0, %ld).", caller, (long) idx(i, j), (long) numRows);
+    }
+}
+
+// us(i,j) = a(idx(i, j or 0), j)
+template <class ElemType>
+CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignRowGatherOf(const CPUMatrix<ElemType>& idx, const CPUMatrix<ElemType>& a)
+{
+    if (idx.IsEmpty() || a.IsEmpty())
+        LogicError("AssignRowGatherOf: input matrix is empty.");
+
+    if (idx.GetNumCols() != 1 && idx.GetNumCols() != a.GetNumCols())
+        LogicError("AssignRowGatherOf: idx must have 1 column or as many as a.");
+
+    VerifyRowIndices(idx, a.GetNumRows(), "AssignRowGatherOf"); // checked up front; the copy loop below runs in parallel
+
+    Resize(idx.GetNumRows(), a.GetNumCols());
+
+    long n = (long) GetNumCols(), m = (long) GetNumRows();
+    bool sharedIdx = (idx.GetNumCols() == 1); // one index column shared by all minibatch columns
+
+    auto& us = *this;
+
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        long idxCol = sharedIdx ? 0 : j;
+        for (long i = 0; i < m; i++)
+            us(i, j) = a((size_t) idx(i, idxCol), j);
+    }
+
+    return *this;
+}
+
+// us(i,j) += a(idx(i, j or 0), j)
+template <class ElemType>
+CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddWithRowGatherOf(const CPUMatrix<ElemType>& idx, const CPUMatrix<ElemType>& a)
+{
+    if (idx.IsEmpty() || a.IsEmpty())
+        LogicError("AddWithRowGatherOf: input matrix is empty.");
+
+    if (GetNumRows() != idx.GetNumRows())
+        LogicError("AddWithRowGatherOf: GetNumRows() != idx.GetNumRows().");
+
+    if (a.GetNumCols() != GetNumCols())
+        LogicError("AddWithRowGatherOf: columns does not match.");
+
+    if (idx.GetNumCols() != 1 && idx.GetNumCols() != a.GetNumCols())
+        LogicError("AddWithRowGatherOf: idx must have 1 column or as many as a.");
+
+    VerifyRowIndices(idx, a.GetNumRows(), "AddWithRowGatherOf");
+
+    long n = (long) GetNumCols(), m = (long) GetNumRows();
+    bool sharedIdx = (idx.GetNumCols() == 1);
+
+    auto& us = *this;
+
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        long idxCol = sharedIdx ? 0 : j;
+        for (long i = 0; i < m; i++)
+            us(i, j) += a((size_t) idx(i, idxCol), j);
+    }
+
+    return *this;
+}
+
+// us(idx(i, j or 0), j) += a(i,j); repeated indices within a column accumulate
+template <class ElemType>
+CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddRowScatterOf(const CPUMatrix<ElemType>& idx, const CPUMatrix<ElemType>& a)
+{
+    if (idx.IsEmpty() || a.IsEmpty())
+        LogicError("AddRowScatterOf: input matrix is empty.");
+
+    if (idx.GetNumRows() != a.GetNumRows())
+        LogicError("AddRowScatterOf: idx.GetNumRows() != a.GetNumRows().");
+
+    if (a.GetNumCols() != GetNumCols())
+        LogicError("AddRowScatterOf: columns does not match.");
+
+    if (idx.GetNumCols() != 1 && idx.GetNumCols() != a.GetNumCols())
+        LogicError("AddRowScatterOf: idx must have 1 column or as many as a.");
+
+    VerifyRowIndices(idx, GetNumRows(), "AddRowScatterOf");
+
+    long n = (long) GetNumCols(), m = (long) a.GetNumRows();
+    bool sharedIdx = (idx.GetNumCols() == 1);
+
+    auto& us = *this;
+
+    // parallel over columns: each column's scatter is serial, so repeated indices do not race
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        long idxCol = sharedIdx ? 0 : j;
+        for (long i = 0; i < m; i++)
+            us((size_t) idx(i, idxCol), j) += a(i, j);
+    }
+
+    return *this;
+}
+
 template <class ElemType>
 CPUMatrix<ElemType> CPUMatrix<ElemType>::Diagonal() const
 {
@@ -592,7 +942,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddToRowRepeatValuesOf(const CPUMatrix
 
     auto& us = *this;
 
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -619,6 +969,249 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddToRowRepeatValuesOf(const CPUMatrix
     return *this;
 }
 
+// pack the columns listed in columnIndices contiguously into [this] ([this] column j = a column columnIndices[j])
+// used to compact gap columns out of a minibatch before compute-heavy operations
+template <class ElemType>
+CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignGatheredColumnsOf(const CPUMatrix<ElemType>& a, const std::vector<size_t>& columnIndices)
+{
+    if (a.IsEmpty())
+        LogicError("AssignGatheredColumnsOf: input matrix a is empty.");
+
+    for (size_t j = 0; j < columnIndices.size(); j++)
+        if (columnIndices[j] >= a.GetNumCols())
+            InvalidArgument("AssignGatheredColumnsOf: column index %d out of range.", (int) columnIndices[j]);
+
+    long m = (long) a.GetNumRows(), n = (long) columnIndices.size();
+
+    Resize(m, n);
+
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        memcpy(m_pArray + j * m, a.m_pArray + columnIndices[j] * m, m * sizeof(ElemType));
+    }
+
+    return *this;
+}
+
+// inverse of AssignGatheredColumnsOf: spread the packed columns back out ([this] column columnIndices[j] = packed column j)
+// columns of [this] not listed in columnIndices are left untouched
+template <class ElemType>
+CPUMatrix<ElemType>& CPUMatrix<ElemType>::ScatterGatheredColumnsOf(const CPUMatrix<ElemType>& packed, const std::vector<size_t>& columnIndices)
+{
+    if (packed.IsEmpty())
+        LogicError("ScatterGatheredColumnsOf: input matrix packed is empty.");
+
+    if (packed.GetNumRows() != GetNumRows())
+        LogicError("ScatterGatheredColumnsOf: packed and [this] must have the same number of rows.");
+
+    if (packed.GetNumCols() != columnIndices.size())
+        LogicError("ScatterGatheredColumnsOf: packed must have one column per entry of columnIndices.");
+
+    for (size_t j = 0; j < columnIndices.size(); j++)
+        if (columnIndices[j] >= GetNumCols())
+            InvalidArgument("ScatterGatheredColumnsOf: column index %d out of range.", (int) columnIndices[j]);
+
+    long m = (long) GetNumRows(), n = (long) columnIndices.size();
+
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        memcpy(m_pArray + columnIndices[j] * m, packed.m_pArray + j * m, m * sizeof(ElemType));
+    }
+
+    return *this;
+}
+
+// -----------------------------------------------------------------------
+// quantized inference product (see IsQuantizedInference() in CommonMatrix.h)
+//
+// Inference products against constant weight matrices can run in 8-bit integer
+// precision: the weights are quantized once per matrix with one scale per output
+// row, each input column is quantized on the fly with its own scale, and the
+// integer inner products are re-scaled to float on output. The quantized values
+// are stored as int16 (8-bit precision in 16-bit storage) so the inner loop can
+// use the SSE2 16-bit multiply-add: with |q| <= 127 each product pair fits 16129,
+// and an int32 accumulator is safe for over 100k summands.
+// -----------------------------------------------------------------------
+
+// quantize [this] (outdim x indim) into qweightsT, TRANSPOSED (indim x outdim) so that each
+// output row's weights are contiguous in memory, with one scale per output row
+template <class ElemType>
+void CPUMatrix<ElemType>::QuantizeTransposedRowwise(CPUMatrix<short>& qweightsT, CPUMatrix<ElemType>& rowScales) const
+{
+    if (IsEmpty())
+        LogicError("QuantizeTransposedRowwise: Matrix is empty.");
+
+    const long m = (long) GetNumRows(); // outputs
+    const long k = (long) GetNumCols(); // inputs
+    qweightsT.Resize(k, m);
+    rowScales.Resize(m, 1);
+
+    short* q = qweightsT.BufferPointer();
+#pragma omp parallel for
+    for (long i = 0; i < m; i++)
+    {
+        ElemType maxabs = 0;
+        for (long j = 0; j < k; j++)
+        {
+            const ElemType v = (ElemType) fabs(m_pArray[j * m + i]);
+            if (v > maxabs)
+                maxabs = v;
+        }
+        const ElemType scale = maxabs / 127;
+        rowScales(i, 0) = scale;
+        const ElemType invscale = scale > 0 ? 1 / scale : 0;
+        for (long j = 0; j < k; j++)
+        {
+            const ElemType v = m_pArray[j * m + i] * invscale;
+            q[i * k + j] = (short) (v > 0 ? v + (ElemType) 0.5 : v - (ElemType) 0.5); // round to nearest, in [-127, 127]
+        }
+    }
+}
+
+// output = W * input, where qweightsT/rowScales came from W.QuantizeTransposedRowwise()
+template <class ElemType>
+void CPUMatrix<ElemType>::MultiplyQuantized(const CPUMatrix<short>& qweightsT, const CPUMatrix<ElemType>& rowScales, const CPUMatrix<ElemType>& input, CPUMatrix<ElemType>& output)
+{
+    const long k = (long) qweightsT.GetNumRows(); // inputs
+    const long m = (long) qweightsT.GetNumCols(); // outputs
+    const long n = (long) input.GetNumCols();
+    if ((long) input.GetNumRows() != k)
+        LogicError("MultiplyQuantized: input rows do not match the quantized weight matrix.");
+    if ((long) rowScales.GetNumRows() != m || rowScales.GetNumCols() != 1)
+        LogicError("MultiplyQuantized: rowScales do not match the quantized weight matrix.");
+
+    output.Resize(m, n); // (no-op when output is an already correctly-sized view)
+
+    const short* q = qweightsT.BufferPointer();
+    const ElemType* x = input.BufferPointer();
+    ElemType* y = output.BufferPointer();
+
+#pragma omp parallel
+    {
+        std::vector<short> qcol(((size_t) k + 7) & ~7, 0); // one quantized input column, zero-padded to a multiple of 8
+#pragma omp for
+        for (long j = 0; j < n; j++)
+        {
+            // quantize this input column on the fly, one scale per column
+            const ElemType* xcol = x + j * k;
+            ElemType maxabs = 0;
+            for (long t = 0; t < k; t++)
+            {
+                const ElemType v = (ElemType) fabs(xcol[t]);
+                if (v > maxabs)
+                    maxabs = v;
+            }
+            const ElemType colScale = maxabs / 127;
+            const ElemType invscale = colScale > 0 ? 1 / colScale : 0;
+            for (long t = 0; t < k; t++)
+            {
+                const ElemType v = xcol[t] * invscale;
+                qcol[t] = (short) (v > 0 ? v + (ElemType) 0.5 : v - (ElemType) 0.5);
+            }
+
+            // integer inner products against the contiguous weight rows
+            for (long i = 0; i < m; i++)
+            {
+                const short* wrow = q + i * k;
+                __m128i acc = _mm_setzero_si128();
+                long t = 0;
+                for (; t + 8 <= k; t += 8)
+                {
+                    const __m128i w8 = _mm_loadu_si128((const __m128i*) (wrow + t));
+                    const __m128i x8 = _mm_loadu_si128((const __m128i*) (qcol.data() + t));
+                    acc = _mm_add_epi32(acc, _mm_madd_epi16(w8, x8));
+                }
+                int accbuf[4];
+                _mm_storeu_si128((__m128i*) accbuf, acc);
+                int sum = accbuf[0] + accbuf[1] + accbuf[2] + accbuf[3];
+                for (; t < k; t++) // tail
+                    sum += wrow[t] * qcol[t];
+                y[j * m + i] = rowScales(i, 0) * colScale * sum;
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+// persistently packed GEMM operands (see UsePrepackedWeights() in CommonMatrix.h)
+//
+// cblas_?gemm repacks both operands into a blocked, cache-friendly internal
+// layout on every call. For a weight matrix that is multiplied thousands of
+// times unchanged, PackForMultiply() performs that packing once up front, and
+// MultiplyPackedAndAdd() multiplies through the packed copy with the per-call
+// repacking of the weight side already done. The buffer layout is private to
+// the BLAS, so it is allocated with cblas_sgemm_alloc() and must be released
+// through ReleasePackedMultiply(); alpha = 1 is baked in at pack time. Only
+// MKL 11.3+ has this interface, and only in single precision (the double
+// variant postdates the MKL versions this tree supports); everywhere else
+// PackForMultiply() returns nullptr and callers use the regular product.
+// -----------------------------------------------------------------------
+
+// pack op(a) for repeated use as the left-hand side of a product
+template <class ElemType>
+ElemType* CPUMatrix<ElemType>::PackForMultiply(const CPUMatrix<ElemType>& a, const bool transposeA)
+{
+#ifdef HAVE_MKL_PACKED_GEMM
+    if (sizeof(ElemType) == sizeof(float) && !a.IsEmpty())
+    {
+        int m = (int) (transposeA ? a.GetNumCols() : a.GetNumRows());
+        int k = (int) (transposeA ? a.GetNumRows() : a.GetNumCols());
+        int lda = (int) a.GetNumRows();
+        // (n does not affect the packed size or layout of the A operand, so any value will do)
+        float* packed = cblas_sgemm_alloc(CblasAMatrix, m, /*n=*/1, k);
+        if (packed == nullptr)
+            return nullptr;
+        cblas_sgemm_pack(CblasColMajor, CblasAMatrix, transposeA ? CblasTrans : CblasNoTrans, m, /*n=*/1, k,
+                         1.0f, reinterpret_cast<const float*>(a.m_pArray), lda, packed);
+        return reinterpret_cast<ElemType*>(packed);
+    }
+#else
+    UNUSED(a);
+    UNUSED(transposeA);
+#endif
+    return nullptr;
+}
+
+// c = op(a) * b, where packedA came from PackForMultiply(a, transposeA) and aRows/aCols are a's dimensions
+template <class ElemType>
+void CPUMatrix<ElemType>::MultiplyPackedAndAdd(const ElemType* packedA, const size_t aRows, const size_t aCols, const bool transposeA, const CPUMatrix<ElemType>& b, CPUMatrix<ElemType>& c)
+{
+#ifdef HAVE_MKL_PACKED_GEMM
+    const int m = (int) (transposeA ? aCols : aRows);
+    const int k = (int) (transposeA ? aRows : aCols);
+    const int n = (int) b.GetNumCols();
+    if ((int) b.GetNumRows() != k)
+        InvalidArgument("MultiplyPackedAndAdd: The inner dimensions of a and b must match.");
+
+    c.Resize(m, n); // (no-op when c is an already correctly-sized view)
+
+    cblas_sgemm_compute(CblasColMajor, (MKL_INT) CblasPacked, (MKL_INT) CblasNoTrans, m, n, k,
+                        reinterpret_cast<const float*>(packedA), m, reinterpret_cast<const float*>(b.m_pArray), k,
+                        0.0f, reinterpret_cast<float*>(c.m_pArray), m);
+#else
+    UNUSED(packedA);
+    UNUSED(aRows);
+    UNUSED(aCols);
+    UNUSED(transposeA);
+    UNUSED(b);
+    UNUSED(c);
+    LogicError("MultiplyPackedAndAdd: no packed-GEMM interface available; PackForMultiply() should have returned nullptr.");
+#endif
+}
+
+template <class ElemType>
+void CPUMatrix<ElemType>::ReleasePackedMultiply(ElemType* packedA)
+{
+#ifdef HAVE_MKL_PACKED_GEMM
+    if (packedA != nullptr)
+        cblas_sgemm_free(reinterpret_cast<float*>(packedA));
+#else
+    UNUSED(packedA); // (never non-null without the packed-GEMM interface)
+#endif
+}
+
 template <class ElemType>
 CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignPositiveAndShiftedNegSample(const CPUMatrix<ElemType>& a, const size_t posNumber, const size_t negNumber, const size_t shiftNumber)
 {
@@ -662,23 +1255,29 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignTransposeOf(const CPUMatrix<Elem
     Resize(a.GetNumCols(), a.GetNumRows());
     long n = (long) a.GetNumCols(), m = (long) a.GetNumRows();
 
-    auto& us = *this;
+    const ElemType* pa = a.m_pArray;
+    ElemType* pus = m_pArray;
+
+    // cache-blocked transpose: process square tiles so that the tile's source columns and
+    // destination columns both stay cache-resident; a straight element loop streams through one
+    // of the two matrices with stride m (or n) and thrashes the cache for large matrices.
+    // Tiles are distributed over the OpenMP threads.
+    const long blockSize = 32;
+    long numBlocksI = (m + blockSize - 1) / blockSize;
+    long numBlocksJ = (n + blockSize - 1) / blockSize;
+    long numBlocks = numBlocksI * numBlocksJ;
 
 #pragma omp parallel for
-    for (long j = 0; j < n; j++)
+    for (long b = 0; b < numBlocks; b++)
     {
-        // four-way unrolling
-        for (long i = 0; i < (m & ~3); i += 4)
+        long i0 = (b % numBlocksI) * blockSize, i1 = std::min(i0 + blockSize, m);
+        long j0 = (b / numBlocksI) * blockSize, j1 = std::min(j0 + blockSize, n);
+        for (long j = j0; j < j1; j++)
         {
-            us(j, i) = a(i, j);
-            us(j, i + 1) = a(i + 1, j);
-            us(j, i + 2) = a(i + 2, j);
-            us(j, i + 3) = a(i + 3, j);
-        }
-        // handle remaining stuffs
-        for (long i = m & ~3; i < m; i++)
-        {
-            us(j, i) = a(i, j);
+            for (long i = i0; i < i1; i++)
+            {
+                pus[j + i * n] = pa[i + j * m];
+            }
         }
     }
 
@@ -701,7 +1300,7 @@ void CPUMatrix<ElemType>::SetValue(const ElemType v)
         // 2-way thread parallelism is sufficient for the memory bound
         // operation of just setting the values of an array.
         const unsigned SETVALUE_NUM_THREADS = 2;
-#pragma omp parallel for num_threads(SETVALUE_NUM_THREADS)
+#pragma omp parallel for num_threads(SETVALUE_NUM_THREADS) if ((long) m >= s_elementwiseParallelThreshold)
         // four-way unrolling
         for (long i = 0; i < (m & ~3); i += 4)
         {
@@ -726,7 +1325,7 @@ void CPUMatrix<ElemType>::MaskColumnsValue(const CPUMatrix<char>& columnsMask, E
 
     auto& us = *this;
     long n = (long) GetNumCols(), m = (long) GetNumRows();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         if (columnsMask(0, j) == 1)
@@ -759,7 +1358,7 @@ void CPUMatrix<ElemType>::SetColumn(const ElemType* colPointer, size_t j)
 
     auto& us = *this;
     long m = (long) GetNumRows();
-#pragma omp parallel for
+#pragma omp parallel for if ((long) m >= s_elementwiseParallelThreshold)
     // four-way unrolling
     for (long i = 0; i < (m & ~3); i += 4)
     {
@@ -783,7 +1382,7 @@ void CPUMatrix<ElemType>::SetColumn(const ElemType val, size_t j)
 
     auto& us = *this;
     long m = (long) GetNumRows();
-#pragma omp parallel for
+#pragma omp parallel for if ((long) m >= s_elementwiseParallelThreshold)
     // four-way unrolling
     for (long i = 0; i < (m & ~3); i += 4)
     {
@@ -808,7 +1407,7 @@ void CPUMatrix<ElemType>::SetColumn(const CPUMatrix<ElemType>& valMat, size_t j)
 
     auto& us = *this;
     long m = (long) GetNumRows();
-#pragma omp parallel for
+#pragma omp parallel for if ((long) m >= s_elementwiseParallelThreshold)
     // four-way unrolling
     for (long i = 0; i < (m & ~3); i += 4)
     {
@@ -846,9 +1445,9 @@ void CPUMatrix<ElemType>::SetValue(const size_t numRows, const size_t numCols, E
     // if it's externally managed, then populate the structure
     if (matrixFlags & matrixFlagDontOwnBuffer)
     {
-        // free previous array allocation if any before overwriting
-        if (m_pArray != nullptr)
-            delete[] m_pArray;
+        // free previous array allocation if any before overwriting (but never a buffer we don't own)
+        if (OwnBuffer() && m_pArray != nullptr)
+            FreeArray(m_pArray);
 
         m_pArray = pArray;
         m_numRows = numRows;
@@ -916,7 +1515,7 @@ void CPUMatrix<ElemType>::SetDiagonalValue(const ElemType v)
 
     auto& us = *this;
     long m = (long) GetNumRows();
-#pragma omp parallel for
+#pragma omp parallel for if ((long) m >= s_elementwiseParallelThreshold)
     // four-way unrolling
     for (long i = 0; i < (m & ~3); i += 4)
     {
@@ -955,7 +1554,7 @@ void CPUMatrix<ElemType>::SetDiagonalValue(const CPUMatrix<ElemType>& vector)
         long m = (long) GetNumRows();
         if (vector.GetNumRows() == 1) // row vector
         {
-#pragma omp parallel for
+#pragma omp parallel for if ((long) m >= s_elementwiseParallelThreshold)
             // four-way unrolling
             for (long i = 0; i < (m & ~3); i += 4)
             {
@@ -972,7 +1571,7 @@ void CPUMatrix<ElemType>::SetDiagonalValue(const CPUMatrix<ElemType>& vector)
         }
         else
         {
-#pragma omp parallel for
+#pragma omp parallel for if ((long) m >= s_elementwiseParallelThreshold)
             // four-way unrolling
             for (long i = 0; i < (m & ~3); i += 4)
             {
@@ -1123,6 +1722,62 @@ void CPUMatrix<ElemType>::SetUniformRandomMask(const ElemType maskRate, const El
     }
 }
 
+// counter-based RNG for the fused dropout kernels: a stateless splitmix64-style mix of
+// (seed, element index). Forward and backward can regenerate the identical mask from the
+// counter alone, so no mask matrix ever needs to be materialized. Returns a uniform in [0, 1).
+static inline double DropoutUniform(unsigned long long seed, unsigned long long index)
+{
+    unsigned long long x = seed + (index + 1) * 0x9E3779B97F4A7C15ULL;
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return (x >> 11) * (1.0 / 9007199254740992.0); // top 53 bits
+}
+
+// fused dropout: this = (uniform <= dropoutRate) ? 0 : a * scaleValue, with the mask drawn
+// from DropoutUniform(randomSeed, offset + i) instead of a materialized mask matrix
+template <class ElemType>
+CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignDropoutOf(const CPUMatrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset)
+{
+    if (a.IsEmpty())
+        LogicError("AssignDropoutOf: Matrix a is empty.");
+
+    Resize(a.GetNumRows(), a.GetNumCols());
+
+    const ElemType* pa = a.m_pArray;
+    ElemType* pc = m_pArray;
+    long m = (long) GetNumElements();
+#pragma omp parallel for if (m >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m))
+    for (long i = 0; i < m; i++)
+        pc[i] = DropoutUniform(randomSeed, offset + i) <= dropoutRate ? 0 : pa[i] * scaleValue;
+    return *this;
+}
+
+// fused dropout gradient: this += a * scaleValue wherever the regenerated mask kept the element
+// Must be called with the same (randomSeed, offset) as the forward AssignDropoutOf() call.
+template <class ElemType>
+CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddDropoutGradientOf(const CPUMatrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset)
+{
+    if (a.IsEmpty())
+        LogicError("AddDropoutGradientOf: Matrix a is empty.");
+
+    if (!(GetNumRows() == a.GetNumRows() && GetNumCols() == a.GetNumCols()))
+        InvalidArgument("AddDropoutGradientOf: Matrices must be the same size.");
+
+    const ElemType* pa = a.m_pArray;
+    ElemType* pc = m_pArray;
+    long m = (long) GetNumElements();
+#pragma omp parallel for if (m >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m))
+    for (long i = 0; i < m; i++)
+    {
+        if (DropoutUniform(randomSeed, offset + i) > dropoutRate)
+            pc[i] += pa[i] * scaleValue;
+    }
+    return *this;
+}
+
 template <class ElemType>
 ElemType CPUMatrix<ElemType>::Adagrad(CPUMatrix<ElemType>& gradients, const bool needAveMultiplier)
 {
@@ -1187,6 +1842,67 @@ ElemType CPUMatrix<ElemType>::Adagrad(CPUMatrix<ElemType>& gradients, const bool
         return 1;
 }
 
+// fused form of Adagrad() + the weight step: accumulator update, reciprocal-sqrt scaling
+// and the parameter write happen in one pass over the data, instead of a separate
+// ScaleAndAdd pass over gradient and weights. Without the average multiplier (whose
+// global sum serializes the loop above) the rows are independent, so this can also
+// run parallel and with multiplications instead of per-element divisions, which the
+// vectorizer turns into packed rsqrt/mul sequences.
+template <class ElemType>
+void CPUMatrix<ElemType>::AdagradUpdate(CPUMatrix<ElemType>& gradients, CPUMatrix<ElemType>& functionValues, const ElemType learnRatePerSample)
+{
+    if (IsEmpty() || gradients.GetNumCols() != GetNumCols() || gradients.GetNumRows() != GetNumRows())
+    {
+        Resize(gradients.GetNumRows(), gradients.GetNumCols());
+        SetValue(0.0);
+    }
+
+    assert(GetNumRows() == gradients.GetNumRows() && GetNumCols() == gradients.GetNumCols());
+
+    ElemType* a = m_pArray;
+    ElemType* d_v = gradients.m_pArray;
+    ElemType* val = functionValues.m_pArray;
+    long n = (long) GetNumElements();
+
+    const ElemType floor = 1e-16f;
+#pragma omp parallel for
+    for (long i = 0; i < (n & ~3); i += 4) // four-way unrolling
+    {
+        ElemType s0 = a[i] + d_v[i] * d_v[i];
+        ElemType s1 = a[i + 1] + d_v[i + 1] * d_v[i + 1];
+        ElemType s2 = a[i + 2] + d_v[i + 2] * d_v[i + 2];
+        ElemType s3 = a[i + 3] + d_v[i + 3] * d_v[i + 3];
+
+        a[i] = s0;
+        a[i + 1] = s1;
+        a[i + 2] = s2;
+        a[i + 3] = s3;
+
+        ElemType w0 = 1 / sqrt(s0 + floor);
+        ElemType w1 = 1 / sqrt(s1 + floor);
+        ElemType w2 = 1 / sqrt(s2 + floor);
+        ElemType w3 = 1 / sqrt(s3 + floor);
+
+        d_v[i] *= w0; // keep the scaled gradient visible, as the unfused path does
+        d_v[i + 1] *= w1;
+        d_v[i + 2] *= w2;
+        d_v[i + 3] *= w3;
+
+        val[i] -= learnRatePerSample * d_v[i];
+        val[i + 1] -= learnRatePerSample * d_v[i + 1];
+        val[i + 2] -= learnRatePerSample * d_v[i + 2];
+        val[i + 3] -= learnRatePerSample * d_v[i + 3];
+    }
+
+    // get the last few elements if any
+    for (long i = n & ~3; i < n; i++)
+    {
+        a[i] += d_v[i] * d_v[i];
+        d_v[i] *= 1 / sqrt(a[i] + floor);
+        val[i] -= learnRatePerSample * d_v[i];
+    }
+}
+
 template <class ElemType>
 void CPUMatrix<ElemType>::FSAdagrad(CPUMatrix<ElemType>& gradients,
                                     CPUMatrix<ElemType>& functionValues,
@@ -1367,11 +2083,11 @@ void CPUMatrix<ElemType>::Resize(const size_t numRows, const size_t numCols, boo
         {
             if (!OwnBuffer())
                 LogicError("Resize: Resizing an matrix you don't own is not supported.");
-            pArray = NewArray<ElemType>(numElements);
+            pArray = AllocateArray<ElemType>(numElements);
         }
         // success: update the object
         if (OwnBuffer())
-            delete[] m_pArray;
+            FreeArray(m_pArray);
         else
             assert(pArray == nullptr); // (if !OwnBuffer we can still resize to 0)
         m_pArray = pArray;
@@ -1430,6 +2146,22 @@ void CPUMatrix<ElemType>::CopySection(size_t /*numRows*/, size_t /*numCols*/, El
     RuntimeError("Not implemented.");
 }
 
+// export the matrix as a packed half-precision (IEEE binary16) array; caller allocates GetNumElements() entries
+// We store half but compute float: this is the lossy half of an fp16 storage round trip.
+template <class ElemType>
+void CPUMatrix<ElemType>::CopyToFloat16Array(unsigned short* halfArray) const
+{
+    HalfConverter<ElemType>::ToHalfBuffer(m_pArray, GetNumElements(), halfArray);
+}
+
+// set the matrix from a packed half-precision array (the exact inverse of CopyToFloat16Array's encoding)
+template <class ElemType>
+void CPUMatrix<ElemType>::SetValueFromFloat16Array(const size_t numRows, const size_t numCols, const unsigned short* halfArray)
+{
+    Resize(numRows, numCols);
+    HalfConverter<ElemType>::FromHalfBuffer(halfArray, GetNumElements(), m_pArray);
+}
+
 template <class ElemType>
 inline size_t CPUMatrix<ElemType>::LocateColumn(const size_t col) const
 {
@@ -1473,7 +2205,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignSumOf(const ElemType alpha, cons
         Resize(a.GetNumRows(), a.GetNumCols());
 
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -1572,8 +2304,15 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignDifferenceOf(const ElemType alph
     if (this != &a)
         Resize(a.GetNumRows(), a.GetNumCols());
 
+    if (CpuSupportsAvx2Fma())
+    {
+        long N = (long) GetNumElements();
+        AssignScalarDifferenceOfAvx(us.m_pArray, alpha, a.m_pArray, true /*alpha - a*/, N, ElementwiseThreads(N));
+        return *this;
+    }
+
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -1601,8 +2340,15 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignDifferenceOf(const CPUMatrix<Ele
     if (this != &a)
         Resize(a.GetNumRows(), a.GetNumCols());
 
+    if (CpuSupportsAvx2Fma())
+    {
+        long N = (long) GetNumElements();
+        AssignScalarDifferenceOfAvx(us.m_pArray, alpha, a.m_pArray, false /*a - alpha*/, N, ElementwiseThreads(N));
+        return *this;
+    }
+
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -1791,8 +2537,15 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignElementProductOf(const CPUMatrix
     if (this != &a)
         Resize(a.GetNumRows(), a.GetNumCols());
 
+    if (CpuSupportsAvx2Fma())
+    {
+        long N = (long) GetNumElements();
+        AssignElementProductOfAvx(us.m_pArray, a.m_pArray, b.m_pArray, N, ElementwiseThreads(N));
+        return *this;
+    }
+
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -1828,8 +2581,15 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddElementProductOf(const CPUMatrix<El
 
     auto& us = *this;
 
+    if (CpuSupportsAvx2Fma())
+    {
+        long N = (long) GetNumElements();
+        AddElementProductOfAvx(us.m_pArray, a.m_pArray, b.m_pArray, N, ElementwiseThreads(N));
+        return *this;
+    }
+
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -1896,7 +2656,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::ColumnElementMultiplyWith(const CPUMat
     auto& us = *this;
 
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -1930,7 +2690,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::RowElementMultiplyWith(const CPUMatrix
     auto& us = *this;
 
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         ElemType v = a(0, j);
@@ -1965,7 +2725,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::RowElementDivideBy(const CPUMatrix<Ele
     auto& us = *this;
 
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         ElemType v = a(0, j);
@@ -2006,7 +2766,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::ColumnElementDivideBy(const CPUMatrix<
     long m = (long) GetNumRows(), n = (long) GetNumCols();
 
     ElemType smallValue = EPS_IN_INVERSE;
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         for (long i = 0; i < m; i++)
@@ -2074,18 +2834,18 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignSigmoidOf(const CPUMatrix<ElemTy
     if (this != &a)
         Resize(a.GetNumRows(), a.GetNumCols());
 
-#pragma omp parallel for
-    foreach_coord (i, j, us)
+    // single precision goes through the AVX2 kernel when the CPU has it (the double path
+    // has no polynomial exp, see CPUMatrixAvxKernels.h)
+    if (CpuSupportsAvx2Fma() && sizeof(ElemType) == sizeof(float))
     {
-        if (a(i, j) >= 0)
-            us(i, j) = 1 / (1 + exp(-a(i, j)));
-        else
-        {
-            ElemType v = exp(a(i, j));
-            us(i, j) = v / (1 + v);
-        }
+        long N = (long) GetNumElements();
+        AssignSigmoidOfAvx(reinterpret_cast<float*>(us.m_pArray), reinterpret_cast<const float*>(a.m_pArray), N, ElementwiseThreads(N));
+        return *this;
     }
 
+    long m = (long) GetNumRows(), n = (long) GetNumCols();
+    DISPATCH_ON_FIXED_ROW_COUNT(m, ColumnwiseSigmoid, m, n, a.m_pArray, us.m_pArray);
+
     return *this;
 }
 
@@ -2106,23 +2866,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignLinearRectifierDerivativeOf(cons
         Resize(a.GetNumRows(), a.GetNumCols());
 
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
-    for (long j = 0; j < n; j++)
-    {
-        // four-way unrolling
-        for (long i = 0; i < (m & ~3); i += 4)
-        {
-            us(i, j) = a(i, j) > 0.0f ? 1.0f : 0.0f;
-            us(i + 1, j) = a(i + 1, j) > 0.0f ? 1.0f : 0.0f;
-            us(i + 2, j) = a(i + 2, j) > 0.0f ? 1.0f : 0.0f;
-            us(i + 3, j) = a(i + 3, j) > 0.0f ? 1.0f : 0.0f;
-        }
-        // handle remaining stuffs
-        for (long i = m & ~3; i < m; i++)
-        {
-            us(i, j) = a(i, j) > 0.0f ? 1.0f : 0.0f;
-        }
-    }
+    DISPATCH_ON_FIXED_ROW_COUNT(m, ColumnwiseLinearRectifierDerivative, m, n, a.m_pArray, us.m_pArray);
 
     return *this;
 }
@@ -2144,31 +2888,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignSigmoidDerivativeOf(const CPUMat
         Resize(a.GetNumRows(), a.GetNumCols());
 
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
-    for (long j = 0; j < n; j++)
-    {
-        // four-way unrolling
-        for (long i = 0; i < (m & ~3); i += 4)
-        {
-            ElemType v = a(i, j);
-            us(i, j) = v * (1 - v);
-
-            ElemType v1 = a(i + 1, j);
-            us(i + 1, j) = v1 * (1 - v1);
-
-            ElemType v2 = a(i + 2, j);
-            us(i + 2, j) = v2 * (1 - v2);
-
-            ElemType v3 = a(i + 3, j);
-            us(i + 3, j) = v3 * (1 - v3);
-        }
-        // handle remaining stuffs
-        for (long i = m & ~3; i < m; i++)
-        {
-            ElemType v = a(i, j);
-            us(i, j) = v * (1 - v);
-        }
-    }
+    DISPATCH_ON_FIXED_ROW_COUNT(m, ColumnwiseSigmoidDerivative, m, n, a.m_pArray, us.m_pArray);
 
     return *this;
 }
@@ -2190,8 +2910,16 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignTanhOf(const CPUMatrix<ElemType>
     if (this != &a)
         Resize(a.GetNumRows(), a.GetNumCols());
 
+    // single precision only, as for AssignSigmoidOf() above
+    if (CpuSupportsAvx2Fma() && sizeof(ElemType) == sizeof(float))
+    {
+        long N = (long) GetNumElements();
+        AssignTanhOfAvx(reinterpret_cast<float*>(us.m_pArray), reinterpret_cast<const float*>(a.m_pArray), N, ElementwiseThreads(N));
+        return *this;
+    }
+
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -2269,6 +2997,119 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignLogSoftmaxOf(const CPUMatrix<Ele
     return *this;
 }
 
+//[this]=-sum(labels .* logsoftmax(predictions)), fused into a single pass over the predictions
+// softmaxStats is resized to 2 x cols; row 0 receives the per-column max and row 1 the per-column
+// log partition function, from which the backward pass reconstructs softmax and log-softmax values
+// on the fly instead of keeping full-size copies of them around
+template <class ElemType>
+CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignCrossEntropyWithSoftmaxOf(const CPUMatrix<ElemType>& labels, const CPUMatrix<ElemType>& predictions, CPUMatrix<ElemType>& softmaxStats, const CPUMatrix<char>* columnsValidityMask /*= nullptr*/)
+{
+    if (labels.IsEmpty() || predictions.IsEmpty())
+        LogicError("AssignCrossEntropyWithSoftmaxOf: Matrix is empty.");
+
+    if (labels.GetNumRows() != predictions.GetNumRows() || labels.GetNumCols() != predictions.GetNumCols())
+        InvalidArgument("AssignCrossEntropyWithSoftmaxOf: labels and predictions must have same dimension.");
+
+    if (columnsValidityMask != nullptr && columnsValidityMask->GetNumCols() != predictions.GetNumCols())
+        InvalidArgument("AssignCrossEntropyWithSoftmaxOf: predictions and column mask must have equal number of columns.");
+
+    const long m = (long) predictions.GetNumRows();
+    const long n = (long) predictions.GetNumCols();
+    softmaxStats.Resize(2, n);
+
+    ElemType total = 0;
+#pragma omp parallel for reduction(+ : total) if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        // gap column: contributes nothing; the stats are never used for a real gradient, but
+        // keep them defined so downstream arithmetic stays finite
+        if (columnsValidityMask != nullptr && (*columnsValidityMask)(0, j) == 0)
+        {
+            softmaxStats(0, j) = 0;
+            softmaxStats(1, j) = 0;
+            continue;
+        }
+
+        const ElemType* pred = predictions.m_pArray + j * m;
+        const ElemType* lbl = labels.m_pArray + j * m;
+
+        // we need to extract max before applying exp to avoid overflow
+        ElemType maxV = pred[0];
+        for (long i = 1; i < m; i++)
+            maxV = max(maxV, pred[i]);
+
+        ElemType sum = 0;
+        for (long i = 0; i < m; i++)
+            sum += exp(pred[i] - maxV);
+        ElemType logZ = log(sum);
+
+        softmaxStats(0, j) = maxV;
+        softmaxStats(1, j) = logZ;
+
+        // zero label entries contribute exactly zero, so columns whose labels were masked
+        // to zero (gaps) drop out of the criterion without a separate masking pass
+        ElemType colSum = 0;
+        for (long i = 0; i < m; i++)
+        {
+            if (lbl[i] != 0)
+                colSum += lbl[i] * (pred[i] - maxV - logZ);
+        }
+        total += colSum;
+    }
+
+    Resize(1, 1);
+    (*this)(0, 0) = -total;
+
+    return *this;
+}
+
+// same as AssignCrossEntropyWithSoftmaxOf, but with labels given as class indexes: labelIndexes is
+// a 1 x cols matrix whose entry j holds the label class of column j (a negative index marks a gap
+// column and drops it from the criterion). This avoids materializing a [numClasses x cols] one-hot
+// label matrix, which dominates memory and bandwidth for large output layers.
+template <class ElemType>
+CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignIndexedCrossEntropyWithSoftmaxOf(const CPUMatrix<ElemType>& labelIndexes, const CPUMatrix<ElemType>& predictions, CPUMatrix<ElemType>& softmaxStats)
+{
+    if (labelIndexes.IsEmpty() || predictions.IsEmpty())
+        LogicError("AssignIndexedCrossEntropyWithSoftmaxOf: Matrix is empty.");
+
+    if (labelIndexes.GetNumRows() != 1 || labelIndexes.GetNumCols() != predictions.GetNumCols())
+        InvalidArgument("AssignIndexedCrossEntropyWithSoftmaxOf: labelIndexes must be a 1 x cols matrix.");
+
+    const long m = (long) predictions.GetNumRows();
+    const long n = (long) predictions.GetNumCols();
+    softmaxStats.Resize(2, n);
+
+    ElemType total = 0;
+#pragma omp parallel for reduction(+ : total) if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        const ElemType* pred = predictions.m_pArray + j * m;
+
+        // we need to extract max before applying exp to avoid overflow
+        ElemType maxV = pred[0];
+        for (long i = 1; i < m; i++)
+            maxV = max(maxV, pred[i]);
+
+        ElemType sum = 0;
+        for (long i = 0; i < m; i++)
+            sum += exp(pred[i] - maxV);
+        ElemType logZ = log(sum);
+
+        softmaxStats(0, j) = maxV;
+        softmaxStats(1, j) = logZ;
+
+        const long idx = (long) labelIndexes(0, j);
+        if (idx >= 0 && idx < m) // negative index = gap column, contributes nothing
+            total += pred[idx] - maxV - logZ;
+    }
+
+    Resize(1, 1);
+    (*this)(0, 0) = -total;
+
+    return *this;
+}
+
 //[this]=hardmax([this])
 //the max element is 1 else is 0
 template <class ElemType>
@@ -2353,7 +3194,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignSqrtOf(const CPUMatrix<ElemType>
         Resize(a.GetNumRows(), a.GetNumCols());
 
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -2391,8 +3232,16 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignExpOf(const CPUMatrix<ElemType>&
     if (this != &a)
         Resize(a.GetNumRows(), a.GetNumCols());
 
+    // single precision only, as for AssignSigmoidOf() above
+    if (CpuSupportsAvx2Fma() && sizeof(ElemType) == sizeof(float))
+    {
+        long N = (long) GetNumElements();
+        AssignExpOfAvx(reinterpret_cast<float*>(us.m_pArray), reinterpret_cast<const float*>(a.m_pArray), N, ElementwiseThreads(N));
+        return *this;
+    }
+
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -2431,7 +3280,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignAbsOf(const CPUMatrix<ElemType>&
         Resize(a.GetNumRows(), a.GetNumCols());
 
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -2582,7 +3431,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::InplaceTruncateBottom(const ElemType t
     auto& us = *this;
 
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -2618,11 +3467,19 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::InplaceTruncate(const ElemType thresho
         LogicError("InplaceTruncate: Matrix is empty.");
 
     auto& us = *this;
+
+    if (CpuSupportsAvx2Fma())
+    {
+        long N = (long) GetNumElements();
+        InplaceTruncateAvx(us.m_pArray, threshold, N, ElementwiseThreads(N));
+        return *this;
+    }
+
     ElemType locThresholdPos = abs(threshold);
     ElemType locTHresholdNeg = -locThresholdPos;
 
     long m = (long) GetNumRows(), n = (long) GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
     for (long j = 0; j < n; j++)
     {
         // four-way unrolling
@@ -2670,7 +3527,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::InplaceSoftThreshold(const ElemType th
 
     long m = (long) GetNumElements();
 
-#pragma omp parallel for
+#pragma omp parallel for if ((long) m >= s_elementwiseParallelThreshold)
     for (long i = 0; i < (m & ~3); i += 4) // four-way unrolling
     {
         if (m_pArray[i] > threshold)
@@ -2825,6 +3682,36 @@ ElemType CPUMatrix<ElemType>::SumOfAbsElements() const
     }
 }
 
+// accumulate a log2-bucketed histogram of the element magnitudes into 'histogram' (numBuckets x 1).
+// Bucket 0 counts exact zeros and magnitudes below 2^minExponent; bucket b (b >= 1) counts
+// magnitudes in [2^(minExponent+b-1), 2^(minExponent+b)), with the top bucket absorbing everything
+// above the covered range. Used to collect dynamic-range statistics for reduced-precision studies.
+template <class ElemType>
+void CPUMatrix<ElemType>::AccumulateAbsLogHistogram(int minExponent, CPUMatrix<ElemType>& histogram) const
+{
+    if (IsEmpty() || histogram.IsEmpty())
+        LogicError("AccumulateAbsLogHistogram: Matrix is empty.");
+
+    const int numBuckets = (int) histogram.GetNumElements();
+    ElemType* counts = histogram.m_pArray;
+    const ElemType* p = m_pArray;
+    const size_t n = GetNumElements();
+    for (size_t i = 0; i < n; i++)
+    {
+        int bucket = 0; // zeros and underflows
+        if (p[i] != 0)
+        {
+            int e = ilogb(fabs((double) p[i])); // floor(log2(|x|))
+            bucket = e - minExponent + 1;
+            if (bucket < 0)
+                bucket = 0;
+            else if (bucket > numBuckets - 1)
+                bucket = numBuckets - 1;
+        }
+        counts[bucket] += 1;
+    }
+}
+
 //sum of all elements
 template <class ElemType>
 ElemType CPUMatrix<ElemType>::SumOfElements() const
@@ -2835,8 +3722,23 @@ ElemType CPUMatrix<ElemType>::SumOfElements() const
     ElemType sum = 0;
     long m = (long) GetNumElements(); // note: OpenMP requires loop indices to be long, not size_t
 
+    if (IsDeterministicComputation())
+    {
+        const ElemType* p = m_pArray;
+        return SumInFixedOrder<ElemType>(m, [p](long b, long e)
+                                         {
+                                             ElemType s = 0;
+                                             long e4 = b + ((e - b) & ~3);
+                                             for (long i = b; i < e4; i += 4)
+                                                 s += p[i] + p[i + 1] + p[i + 2] + p[i + 3];
+                                             for (long i = e4; i < e; i++)
+                                                 s += p[i];
+                                             return s;
+                                         });
+    }
+
 //four-way unrolling
-#pragma omp parallel for reduction(+ : sum)
+#pragma omp parallel for reduction(+ : sum) if ((long) m >= s_elementwiseParallelThreshold)
     for (long i = 0; i < (m & ~3); i += 4)
     {
         sum += m_pArray[i] + m_pArray[i + 1] + m_pArray[i + 2] + m_pArray[i + 3];
@@ -3240,8 +4142,23 @@ ElemType CPUMatrix<ElemType>::FrobeniusNorm() const
 
     long m = (long) GetNumElements();
 
+    if (IsDeterministicComputation())
+    {
+        const ElemType* p = m_pArray;
+        return sqrt(SumInFixedOrder<ElemType>(m, [p](long b, long e)
+                                              {
+                                                  ElemType s = 0;
+                                                  long e4 = b + ((e - b) & ~3);
+                                                  for (long i = b; i < e4; i += 4)
+                                                      s += p[i] * p[i] + p[i + 1] * p[i + 1] + p[i + 2] * p[i + 2] + p[i + 3] * p[i + 3];
+                                                  for (long i = e4; i < e; i++)
+                                                      s += p[i] * p[i];
+                                                  return s;
+                                              }));
+    }
+
 //four-way unrolling
-#pragma omp parallel for reduction(+ : v)
+#pragma omp parallel for reduction(+ : v) if ((long) m >= s_elementwiseParallelThreshold)
     for (long i = 0; i < (m & ~3); i += 4)
     {
         v += m_pArray[i] * m_pArray[i] + m_pArray[i + 1] * m_pArray[i + 1] + m_pArray[i + 2] * m_pArray[i + 2] + m_pArray[i + 3] * m_pArray[i + 3];
@@ -3319,6 +4236,18 @@ ElemType CPUMatrix<ElemType>::MatrixNorm1() const
 
     auto& us = *this;
 
+    if (IsDeterministicComputation()) // dense storage is contiguous, so we can reduce over the flat array
+    {
+        const ElemType* p = m_pArray;
+        return SumInFixedOrder<ElemType>((long) GetNumElements(), [p](long b, long e)
+                                         {
+                                             ElemType s = 0;
+                                             for (long i = b; i < e; i++)
+                                                 s += abs(p[i]);
+                                             return s;
+                                         });
+    }
+
     ElemType sum = 0;
 #pragma omp parallel for reduction(+ : sum)
     foreach_coord (i, j, us)
@@ -3566,6 +4495,47 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignNumOfDiff(const CPUMatrix<ElemTy
     return *this;
 }
 
+// fused top-K classification error: counts the columns whose true class (the argmax of the labels
+// column) is not among the topK largest prediction scores. Unlike the VectorMax()/AssignNumOfDiff()
+// sequence, this needs no intermediate index/value matrices: per column we find the label argmax and
+// count the prediction scores strictly larger than the score at that index (i.e. ties are resolved
+// in the label's favor).
+template <class ElemType>
+CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignTopKError(const CPUMatrix<ElemType>& labels, const CPUMatrix<ElemType>& predictions, const int topK)
+{
+    if (labels.GetNumCols() != predictions.GetNumCols() || labels.GetNumRows() != predictions.GetNumRows())
+        InvalidArgument("AssignTopKError: labels and predictions must have the same dimensions.");
+
+    const long m = (long) labels.GetNumRows(), n = (long) labels.GetNumCols();
+
+    ElemType errors = 0;
+#pragma omp parallel for reduction(+ : errors) if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        const ElemType* labelCol = labels.m_pArray + j * m;
+        const ElemType* predCol = predictions.m_pArray + j * m;
+
+        long labelIdx = 0;
+        for (long i = 1; i < m; i++)
+        {
+            if (labelCol[i] > labelCol[labelIdx])
+                labelIdx = i;
+        }
+
+        const ElemType predAtLabel = predCol[labelIdx];
+        long numGreater = 0;
+        for (long i = 0; i < m && numGreater < topK; i++)
+            numGreater += (predCol[i] > predAtLabel);
+
+        errors += (numGreater >= topK);
+    }
+
+    Resize(1, 1); // result should be one element
+    (*this)(0, 0) = errors;
+
+    return *this;
+}
+
 #pragma endregion Member BLAS Functions
 
 #pragma region Other helper Functions
@@ -3927,43 +4897,305 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddAveragePoolingGradient(const CPUMat
     const long outputHeightTimesChannel = (long) (outputHeight * channels);
     const long windowSize = (long) (windowWidth * windowHeight);
 
-// IN_ELEM_ROWPOS(channel, row, col) = (channel + (row + col * inputHeight) * channels)
-// IN_ELEM_COLPOS = sample
+// IN_ELEM_ROWPOS(channel, row, col) = (channel + (row + col * inputHeight) * channels)
+// IN_ELEM_COLPOS = sample
+
+// OUT_ELEM_ROWPOS(channel, wrow, wcol) = (channel + (wrow + wcol * outputHeight) * channels)
+// OUT_ELEM_COLPOS = sample
+
+#pragma omp parallel for
+    for (long sample = 0; sample < batchSize; sample++)
+    {
+        for (long inputIndexWithinSample = 0; inputIndexWithinSample < inputSizePerSample; inputIndexWithinSample++)
+        {
+            const long y = inputIndexWithinSample / inputHeightTimesChannel;   // col in input
+            const long nXC = inputIndexWithinSample % inputHeightTimesChannel; // channel + row*chanels
+            const long x = nXC / (long) channels;                              // row in input
+            const long c = nXC % (long) channels;                              // channel
+
+            long startOutX = (long) max((ElemType)0, ceil((x - (ElemType) windowHeight + 1) / (ElemType) verticalSubsample));               // inclusive start
+            long endOutX = (long) ((x / verticalSubsample < outputHeight - 1) ? x / (long) verticalSubsample : outputHeight - 1); // inclusive end
+            long startOutY = (long) max((ElemType)0, ceil((y - (ElemType) windowWidth + 1) / (ElemType) horizontalSubsample));              // inclusive start
+            long endOutY = (long) ((y / horizontalSubsample < outputWidth - 1) ? y / horizontalSubsample : outputWidth - 1);      // inclusive end
+
+            for (long outY = startOutY; outY <= endOutY; outY++)
+            {
+                for (long outX = startOutX; outX <= endOutX; outX++)
+                {
+                    long outputIndex = outY * outputHeightTimesChannel + outX * (long) channels + c;
+                    (*this)(inputIndexWithinSample, sample) += outputGradientBatch(outputIndex, sample) / windowSize;
+                }
+            }
+        }
+    }
+
+    return *this;
+}
+
+// batch normalization of 'this' (D x N, one sample per column) into 'out', fused in one parallel
+// pass: per-dimension minibatch mean/variance by two-moment accumulation, then normalize, scale
+// and shift, updating the running statistics along the way. The statistics dimension S is taken
+// from 'scale' (S x 1): S == D normalizes per activation; S < D (spatial mode of the legacy
+// engine, channels fastest-varying) shares statistics across the rows {s, s+S, s+2S, ...}.
+// saveMean/saveInvStdDev (S x 1) receive the minibatch statistics for the backward pass.
+template <class ElemType>
+void CPUMatrix<ElemType>::BatchNormalizationForward(const CPUMatrix<ElemType>& scale, const CPUMatrix<ElemType>& bias,
+                                                    double expAvgFactor, double epsilon,
+                                                    CPUMatrix<ElemType>& runMean, CPUMatrix<ElemType>& runInvStdDev,
+                                                    CPUMatrix<ElemType>& out,
+                                                    CPUMatrix<ElemType>& saveMean, CPUMatrix<ElemType>& saveInvStdDev) const
+{
+    if (IsEmpty())
+        LogicError("BatchNormalizationForward: Matrix is empty.");
+
+    const long D = (long) GetNumRows();
+    const long N = (long) GetNumCols();
+    const long S = (long) scale.GetNumRows();
+    if (S == 0 || D % S != 0)
+        InvalidArgument("BatchNormalizationForward: the scale dimension must evenly divide the input dimension.");
+    assert(out.GetNumRows() == (size_t) D && out.GetNumCols() == (size_t) N);
+    assert(saveMean.GetNumRows() == (size_t) S && saveInvStdDev.GetNumRows() == (size_t) S);
+
+    const ElemType* x = m_pArray;
+    ElemType* y = out.m_pArray;
+    const double n = (double) N * (D / S); // number of samples each statistic is estimated from
+
+#pragma omp parallel for
+    for (long s = 0; s < S; s++)
+    {
+        double sum = 0, sqSum = 0;
+        for (long j = 0; j < N; j++)
+            for (long r = s; r < D; r += S)
+            {
+                double v = x[r + j * D];
+                sum += v;
+                sqSum += v * v;
+            }
+        double mean = sum / n;
+        double variance = sqSum / n - mean * mean;
+        if (variance < 0) // (numerical noise)
+            variance = 0;
+        double invStdDev = 1.0 / sqrt(variance + epsilon);
+
+        saveMean.m_pArray[s] = (ElemType) mean;
+        saveInvStdDev.m_pArray[s] = (ElemType) invStdDev;
+        runMean.m_pArray[s] = (ElemType) ((1 - expAvgFactor) * runMean.m_pArray[s] + expAvgFactor * mean);
+        runInvStdDev.m_pArray[s] = (ElemType) ((1 - expAvgFactor) * runInvStdDev.m_pArray[s] + expAvgFactor * invStdDev);
+
+        const double g = scale.m_pArray[s];
+        const double b = bias.m_pArray[s];
+        for (long j = 0; j < N; j++)
+            for (long r = s; r < D; r += S)
+            {
+                long idx = r + j * D;
+                y[idx] = (ElemType) (g * (x[idx] - mean) * invStdDev + b);
+            }
+    }
+}
+
+// inference-time counterpart of BatchNormalizationForward(): normalize with the running statistics
+template <class ElemType>
+void CPUMatrix<ElemType>::BatchNormalizationForwardInference(const CPUMatrix<ElemType>& scale, const CPUMatrix<ElemType>& bias,
+                                                             const CPUMatrix<ElemType>& runMean, const CPUMatrix<ElemType>& runInvStdDev,
+                                                             CPUMatrix<ElemType>& out) const
+{
+    if (IsEmpty())
+        LogicError("BatchNormalizationForwardInference: Matrix is empty.");
+
+    const long D = (long) GetNumRows();
+    const long N = (long) GetNumCols();
+    const long S = (long) scale.GetNumRows();
+    if (S == 0 || D % S != 0)
+        InvalidArgument("BatchNormalizationForwardInference: the scale dimension must evenly divide the input dimension.");
+
+    const ElemType* x = m_pArray;
+    ElemType* y = out.m_pArray;
+
+#pragma omp parallel for
+    for (long j = 0; j < N; j++)
+        for (long r = 0; r < D; r++)
+        {
+            long s = r % S;
+            long idx = r + j * D;
+            y[idx] = (ElemType) ((double) scale.m_pArray[s] * (x[idx] - runMean.m_pArray[s]) * runInvStdDev.m_pArray[s] + bias.m_pArray[s]);
+        }
+}
+
+// backward pass of BatchNormalizationForward() in one fused parallel pass over 'this' (the
+// incoming gradient, D x N): accumulates the input gradient into 'grad' and writes the scale and
+// bias gradients (both computed from the same sweep) into scaleGrad/biasGrad
+template <class ElemType>
+void CPUMatrix<ElemType>::BatchNormalizationBackward(const CPUMatrix<ElemType>& in, CPUMatrix<ElemType>& grad,
+                                                     const CPUMatrix<ElemType>& scale,
+                                                     const CPUMatrix<ElemType>& saveMean, const CPUMatrix<ElemType>& saveInvStdDev,
+                                                     CPUMatrix<ElemType>& scaleGrad, CPUMatrix<ElemType>& biasGrad) const
+{
+    if (IsEmpty())
+        LogicError("BatchNormalizationBackward: Matrix is empty.");
+
+    const long D = (long) GetNumRows();
+    const long N = (long) GetNumCols();
+    const long S = (long) scale.GetNumRows();
+    if (S == 0 || D % S != 0)
+        InvalidArgument("BatchNormalizationBackward: the scale dimension must evenly divide the input dimension.");
+    assert(in.GetNumRows() == (size_t) D && in.GetNumCols() == (size_t) N);
+    assert(grad.GetNumRows() == (size_t) D && grad.GetNumCols() == (size_t) N);
+
+    const ElemType* dy = m_pArray;
+    const ElemType* x = in.m_pArray;
+    ElemType* dx = grad.m_pArray;
+    const double n = (double) N * (D / S);
+
+#pragma omp parallel for
+    for (long s = 0; s < S; s++)
+    {
+        const double mean = saveMean.m_pArray[s];
+        const double invStdDev = saveInvStdDev.m_pArray[s];
+
+        double dBias = 0, dScale = 0;
+        for (long j = 0; j < N; j++)
+            for (long r = s; r < D; r += S)
+            {
+                long idx = r + j * D;
+                dBias += dy[idx];
+                dScale += dy[idx] * (x[idx] - mean) * invStdDev;
+            }
+        scaleGrad.m_pArray[s] = (ElemType) dScale;
+        biasGrad.m_pArray[s] = (ElemType) dBias;
+
+        const double g = scale.m_pArray[s];
+        for (long j = 0; j < N; j++)
+            for (long r = s; r < D; r += S)
+            {
+                long idx = r + j * D;
+                double xHat = (x[idx] - mean) * invStdDev;
+                dx[idx] += (ElemType) (g * invStdDev * (dy[idx] - (dBias + xHat * dScale) / n));
+            }
+    }
+}
+#pragma endregion Other Helper Functions
+
+#pragma region Static BLAS Functions
+
+// -----------------------------------------------------------------------
+// skinny-GEMM dispatch
+// -----------------------------------------------------------------------
+// For very narrow right-hand sides (online evaluation runs with minibatches of just a few frames)
+// the BLAS libraries leave much of the machine idle and a simple column-at-a-time kernel wins.
+// Which side wins depends on the CPU and the BLAS build, so instead of a fixed cutoff a small
+// dispatch table times both implementations the first few times each (m, k, n) shape occurs and
+// then routes all later calls of that shape to the faster one.
+
+// custom kernel for c = alpha * a * b + beta * c, untransposed col-major inputs, few columns in b:
+// accumulates c(:,j) += alpha * b(k,j) * a(:,k) over row blocks, so every array is walked sequentially
+template <class ElemType>
+static void SkinnyGemm(int m, int n, int k, ElemType alpha, const ElemType* a, int lda, const ElemType* b, int ldb, ElemType beta, ElemType* c, int ldc)
+{
+    const int blockSize = 256; // a row block of c stays cache-resident across the k accumulation sweeps
+    int numBlocks = (m + blockSize - 1) / blockSize;
+#pragma omp parallel for if ((long) m * k * n >= s_elementwiseParallelThreshold)
+    for (int block = 0; block < numBlocks; block++)
+    {
+        int i0 = block * blockSize;
+        int i1 = (i0 + blockSize < m) ? i0 + blockSize : m;
+        for (int j = 0; j < n; j++)
+        {
+            ElemType* cj = c + (size_t) j * ldc;
+            if (beta == 0)
+                for (int i = i0; i < i1; i++)
+                    cj[i] = 0;
+            else if (beta != 1)
+                for (int i = i0; i < i1; i++)
+                    cj[i] *= beta;
+            const ElemType* bj = b + (size_t) j * ldb;
+            for (int kk = 0; kk < k; kk++)
+            {
+                ElemType s = alpha * bj[kk];
+                if (s == 0)
+                    continue;
+                const ElemType* ak = a + (size_t) kk * lda;
+                for (int i = i0; i < i1; i++)
+                    cj[i] += s * ak[i];
+            }
+        }
+    }
+}
+
+enum class GemmRoute
+{
+    Measuring, // still timing both implementations
+    Custom,    // the skinny kernel won for this shape
+    Blas       // the BLAS library won for this shape
+};
+
+struct GemmDispatchEntry
+{
+    GemmRoute route = GemmRoute::Measuring;
+    int numSamples = 0;
+    double customSeconds = 0;
+    double blasSeconds = 0;
+};
+
+static const int c_skinnyGemmMaxCols = 8;           // only this narrow can the custom kernel win
+static const int c_gemmDispatchSamples = 3;         // timed calls per implementation before deciding
+static const size_t c_gemmDispatchMaxEntries = 256; // safety valve; shapes beyond this go to BLAS untimed
 
-// OUT_ELEM_ROWPOS(channel, wrow, wcol) = (channel + (wrow + wcol * outputHeight) * channels)
-// OUT_ELEM_COLPOS = sample
+static std::map<unsigned long long, GemmDispatchEntry> s_gemmDispatchTable; // keyed by shape; networks produce only a handful of distinct GEMM shapes
+static std::mutex s_gemmDispatchMutex;
 
-#pragma omp parallel for
-    for (long sample = 0; sample < batchSize; sample++)
-    {
-        for (long inputIndexWithinSample = 0; inputIndexWithinSample < inputSizePerSample; inputIndexWithinSample++)
-        {
-            const long y = inputIndexWithinSample / inputHeightTimesChannel;   // col in input
-            const long nXC = inputIndexWithinSample % inputHeightTimesChannel; // channel + row*chanels
-            const long x = nXC / (long) channels;                              // row in input
-            const long c = nXC % (long) channels;                              // channel
+// route a narrow untransposed GEMM either to the skinny kernel or to blasGemm, timing the first
+// few calls per shape to decide; returns false when the caller should invoke BLAS itself
+template <class ElemType>
+static bool TrySkinnyGemm(int m, int n, int k, ElemType alpha, const ElemType* a, int lda, const ElemType* b, int ldb, ElemType beta, ElemType* c, int ldc,
+                          const std::function<void()>& blasGemm)
+{
+    static const bool disabled = (getenv("CNTK_DISABLE_SKINNY_GEMM") != nullptr); // escape hatch
+    if (disabled || n > c_skinnyGemmMaxCols)
+        return false;
 
-            long startOutX = (long) max((ElemType)0, ceil((x - (ElemType) windowHeight + 1) / (ElemType) verticalSubsample));               // inclusive start
-            long endOutX = (long) ((x / verticalSubsample < outputHeight - 1) ? x / (long) verticalSubsample : outputHeight - 1); // inclusive end
-            long startOutY = (long) max((ElemType)0, ceil((y - (ElemType) windowWidth + 1) / (ElemType) horizontalSubsample));              // inclusive start
-            long endOutY = (long) ((y / horizontalSubsample < outputWidth - 1) ? y / horizontalSubsample : outputWidth - 1);      // inclusive end
+    unsigned long long key = ((unsigned long long) (unsigned) m << 36) ^ ((unsigned long long) (unsigned) k << 8) ^ (unsigned) n;
+    if (sizeof(ElemType) == sizeof(double))
+        key |= 1ull << 63;
 
-            for (long outY = startOutY; outY <= endOutY; outY++)
-            {
-                for (long outX = startOutX; outX <= endOutX; outX++)
-                {
-                    long outputIndex = outY * outputHeightTimesChannel + outX * (long) channels + c;
-                    (*this)(inputIndexWithinSample, sample) += outputGradientBatch(outputIndex, sample) / windowSize;
-                }
-            }
+    bool runCustom, measuring = false;
+    {
+        std::lock_guard<std::mutex> lock(s_gemmDispatchMutex);
+        if (s_gemmDispatchTable.size() >= c_gemmDispatchMaxEntries && s_gemmDispatchTable.find(key) == s_gemmDispatchTable.end())
+            return false;
+        auto& entry = s_gemmDispatchTable[key];
+        if (entry.route == GemmRoute::Blas)
+            return false;
+        runCustom = (entry.route == GemmRoute::Custom);
+        if (entry.route == GemmRoute::Measuring)
+        {
+            measuring = true;
+            runCustom = (entry.numSamples % 2 == 0); // alternate implementations while measuring
         }
     }
 
-    return *this;
-}
-#pragma endregion Other Helper Functions
+    if (!measuring)
+    {
+        SkinnyGemm(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+        return true;
+    }
 
-#pragma region Static BLAS Functions
+    auto start = std::chrono::high_resolution_clock::now();
+    if (runCustom)
+        SkinnyGemm(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+    else
+        blasGemm();
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    {
+        std::lock_guard<std::mutex> lock(s_gemmDispatchMutex);
+        auto& entry = s_gemmDispatchTable[key];
+        (runCustom ? entry.customSeconds : entry.blasSeconds) += seconds;
+        entry.numSamples++;
+        if (entry.route == GemmRoute::Measuring && entry.numSamples >= 2 * c_gemmDispatchSamples)
+            entry.route = (entry.customSeconds <= entry.blasSeconds) ? GemmRoute::Custom : GemmRoute::Blas;
+    }
+    return true;
+}
 
 /// <summary>Matrix-matrix multiply with col-major matrices (a and b may be transposed): c = alpha * op(a) * op(b) + beta*c</summary>
 /// <param name="alpha">Scalar</param>
@@ -4047,22 +5279,113 @@ void CPUMatrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const CPUMatrix
 
     ldc = (int) c.GetNumRows();
 
-    if (sizeof(ElemType) == sizeof(double))
+    auto blasGemm = [&]()
     {
+        if (sizeof(ElemType) == sizeof(double))
+        {
 #ifndef USE_MKL
-        dgemm(transA, transB, m, n, k, alpha, reinterpret_cast<double*>(a.m_pArray), lda, reinterpret_cast<double*>(b.m_pArray), ldb, beta, reinterpret_cast<double*>(c.m_pArray), ldc);
+            dgemm(transA, transB, m, n, k, alpha, reinterpret_cast<double*>(a.m_pArray), lda, reinterpret_cast<double*>(b.m_pArray), ldb, beta, reinterpret_cast<double*>(c.m_pArray), ldc);
 #else
-        cblas_dgemm((CBLAS_ORDER) BLAS_COLMAJOR mklTransA, mklTransB, m, n, k, alpha, reinterpret_cast<double*>(a.m_pArray), lda, reinterpret_cast<double*>(b.m_pArray), ldb, beta, reinterpret_cast<double*>(c.m_pArray), ldc);
+            cblas_dgemm((CBLAS_ORDER) BLAS_COLMAJOR mklTransA, mklTransB, m, n, k, alpha, reinterpret_cast<double*>(a.m_pArray), lda, reinterpret_cast<double*>(b.m_pArray), ldb, beta, reinterpret_cast<double*>(c.m_pArray), ldc);
 #endif
-    }
-    else
-    {
+        }
+        else
+        {
 #pragma warning(suppress : 4244)
 #ifndef USE_MKL
-        sgemm(BLAS_COLMAJOR transA, transB, m, n, k, alpha, reinterpret_cast<float*>(a.m_pArray), lda, reinterpret_cast<float*>(b.m_pArray), ldb, beta, reinterpret_cast<float*>(c.m_pArray), ldc);
+            sgemm(BLAS_COLMAJOR transA, transB, m, n, k, alpha, reinterpret_cast<float*>(a.m_pArray), lda, reinterpret_cast<float*>(b.m_pArray), ldb, beta, reinterpret_cast<float*>(c.m_pArray), ldc);
 #else
-        cblas_sgemm((CBLAS_ORDER) BLAS_COLMAJOR mklTransA, mklTransB, m, n, k, alpha, reinterpret_cast<float*>(a.m_pArray), lda, reinterpret_cast<float*>(b.m_pArray), ldb, beta, reinterpret_cast<float*>(c.m_pArray), ldc);
+            cblas_sgemm((CBLAS_ORDER) BLAS_COLMAJOR mklTransA, mklTransB, m, n, k, alpha, reinterpret_cast<float*>(a.m_pArray), lda, reinterpret_cast<float*>(b.m_pArray), ldb, beta, reinterpret_cast<float*>(c.m_pArray), ldc);
 #endif
+        }
+    };
+
+    // narrow right-hand sides may route to the custom skinny kernel (see the dispatch table above)
+    if (!transposeA && !transposeB && TrySkinnyGemm(m, n, k, alpha, a.m_pArray, lda, b.m_pArray, ldb, beta, c.m_pArray, ldc, std::function<void()>(blasGemm)))
+        return;
+
+    blasGemm();
+}
+
+/// <summary>Batched version of MultiplyAndWeightedAdd: c[i] = alpha * op(a[i]) * op(b[i]) + beta * c[i] for all i</summary>
+/// The products are independent, so they run in parallel across cores; each one is typically too
+/// small to make use of BLAS-internal threading on its own.
+template <class ElemType>
+void CPUMatrix<ElemType>::MultiplyAndWeightedAddBatched(ElemType alpha, const std::vector<const CPUMatrix<ElemType>*>& a, const bool transposeA,
+                                                        const std::vector<const CPUMatrix<ElemType>*>& b, const bool transposeB,
+                                                        ElemType beta, const std::vector<CPUMatrix<ElemType>*>& c)
+{
+    if (a.size() != b.size() || a.size() != c.size())
+        InvalidArgument("MultiplyAndWeightedAddBatched: a, b, and c must contain the same number of matrices.");
+    long count = (long) a.size();
+#pragma omp parallel for
+    for (long i = 0; i < count; i++)
+    {
+        MultiplyAndWeightedAdd(alpha, *a[i], transposeA, *b[i], transposeB, beta, *c[i]);
+    }
+}
+
+/// <summary>Fused matrix product, bias add and nonlinearity: c = f(alpha * op(a) * op(b) + beta * c + bias)</summary>
+/// The bias broadcast and the nonlinearity are applied column by column right after the GEMM,
+/// while the output is still cache resident, so they do not cost two further passes over the
+/// minibatch output the way a separate Plus node followed by a Sigmoid/Tanh node would.
+/// <param name="alpha">Scalar</param>
+/// <param name="a">Input matrix</param>
+/// <param name="transposeA">Whether matrix a is transposed</param>
+/// <param name="b">Input matrix</param>
+/// <param name="transposeB">Whether matrix b is transposed</param>
+/// <param name="beta">Scalar</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+/// <param name="bias">Column vector added to every column of the product</param>
+/// <param name="nonlinearity">One of opCopy, opSigmoid, opTanh or opLinearRectifier</param>
+template <class ElemType>
+void CPUMatrix<ElemType>::MultiplyAddBiasAndApply(ElemType alpha, const CPUMatrix<ElemType>& a, const bool transposeA, const CPUMatrix<ElemType>& b, const bool transposeB,
+                                                  ElemType beta, CPUMatrix<ElemType>& c, const CPUMatrix<ElemType>& bias, ElementWiseOperator nonlinearity)
+{
+    MultiplyAndWeightedAdd(alpha, a, transposeA, b, transposeB, beta, c);
+
+    if (bias.GetNumRows() != c.GetNumRows() || bias.GetNumCols() != 1)
+        InvalidArgument("MultiplyAddBiasAndApply: bias must be a column vector with as many rows as c.");
+
+    long m = (long) c.GetNumRows(), n = (long) c.GetNumCols();
+    const ElemType* pBias = bias.m_pArray;
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        ElemType* pc = c.m_pArray + j * m;
+        switch (nonlinearity)
+        {
+        case ElementWiseOperator::opCopy:
+            for (long i = 0; i < m; i++)
+                pc[i] += pBias[i];
+            break;
+        case ElementWiseOperator::opSigmoid:
+            for (long i = 0; i < m; i++)
+            {
+                ElemType v = pc[i] + pBias[i];
+                if (v >= 0)
+                    pc[i] = 1 / (1 + exp(-v));
+                else
+                {
+                    ElemType e = exp(v);
+                    pc[i] = e / (1 + e);
+                }
+            }
+            break;
+        case ElementWiseOperator::opTanh:
+            for (long i = 0; i < m; i++)
+                pc[i] = tanh(pc[i] + pBias[i]);
+            break;
+        case ElementWiseOperator::opLinearRectifier:
+            for (long i = 0; i < m; i++)
+            {
+                ElemType v = pc[i] + pBias[i];
+                pc[i] = v > 0 ? v : 0;
+            }
+            break;
+        default:
+            LogicError("MultiplyAddBiasAndApply: nonlinearity must be one of opCopy, opSigmoid, opTanh or opLinearRectifier.");
+        }
     }
 }
 
@@ -4195,6 +5518,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignNCEDerivative(const CPUMatrix<El
 {
     size_t sample_size = this->GetNumRows() / 2;
     size_t batch_size = this->GetNumCols();
+    const long dims = (long) b.GetNumRows();
     if (inputIndex == 1)
     {
 #pragma omp parallel for
@@ -4202,8 +5526,12 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignNCEDerivative(const CPUMatrix<El
             for (int sample_id = 0; sample_id < sample_size; sample_id++)
             {
                 int sample = (int) (*this)(2 * sample_id, instance_id);
-                for (int dim = 0; dim < b.GetNumRows(); dim++)
-                    c(dim, instance_id) -= b(dim, sample) * tmp(sample_id, instance_id);
+                // scaled column update over contiguous columns, so the loop vectorizes
+                ElemType weight = tmp(sample_id, instance_id);
+                const ElemType* pb = b.m_pArray + sample * dims;
+                ElemType* pc = c.m_pArray + instance_id * dims;
+                for (long dim = 0; dim < dims; dim++)
+                    pc[dim] -= pb[dim] * weight;
             }
     }
     else if (inputIndex == 2)
@@ -4218,8 +5546,13 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignNCEDerivative(const CPUMatrix<El
                 {
                     int sample = (int) (*this)(2 * sample_id, instance_id);
                     if (sample % i_blocks == ib)
-                        for (int dim = 0; dim < b.GetNumRows(); dim++)
-                            c(dim, sample) -= a(dim, instance_id) * tmp(sample_id, instance_id);
+                    {
+                        ElemType weight = tmp(sample_id, instance_id);
+                        const ElemType* pa = a.m_pArray + instance_id * dims;
+                        ElemType* pc = c.m_pArray + sample * dims;
+                        for (long dim = 0; dim < dims; dim++)
+                            pc[dim] -= pa[dim] * weight;
+                    }
                 }
     }
     else
@@ -4251,14 +5584,18 @@ void CPUMatrix<ElemType>::AssignNoiseContrastiveEstimation(const CPUMatrix<ElemT
     size_t batch_size = this->GetNumCols();
     size_t num_noise_samples = sample_size - 1;
     double log_num_noise_samples = std::log(num_noise_samples);
+    const long dims = (long) b.GetNumRows();
 #pragma omp parallel for reduction(+ : log_likelihood)
     for (int instance_id = 0; instance_id < batch_size; instance_id++)
         for (int sample_id = 0; sample_id < sample_size; sample_id++)
         {
             int sample = (int) (*this)(2 * sample_id, instance_id);
+            // both columns are contiguous, so this dot product vectorizes
+            const ElemType* pa = a.m_pArray + instance_id * dims;
+            const ElemType* pb = b.m_pArray + sample * dims;
             double score = bias(0, sample);
-            for (int dim = 0; dim < b.GetNumRows(); dim++)
-                score += a(dim, instance_id) * b(dim, sample);
+            for (long dim = 0; dim < dims; dim++)
+                score += (double) pa[dim] * pb[dim];
             double sample_prob = -(*this)(2 * sample_id + 1, instance_id);
             if (sample_id == 0)
                 sample_prob = -sample_prob;
@@ -4345,7 +5682,7 @@ void CPUMatrix<ElemType>::ScaleAndAdd(ElemType alpha, const CPUMatrix<ElemType>&
     {
         ElemType v = alpha * a(0, 0);
         long m = (long) c.GetNumRows(), n = (long) c.GetNumCols();
-#pragma omp parallel for
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
         for (long j = 0; j < n; j++)
         {
             // four-way unrolling
@@ -4363,38 +5700,14 @@ void CPUMatrix<ElemType>::ScaleAndAdd(ElemType alpha, const CPUMatrix<ElemType>&
             }
         }
     }
-    else if (a.GetNumCols() == 1) // col vector, add it to all columns
+    else if (a.GetNumCols() == 1) // col vector, add it to all columns (bias add)
     {
-        int m = (int) c.GetNumRows();
-        assert(m == (int) a.GetNumRows());
-        if (m != (int) a.GetNumRows())
+        long m = (long) c.GetNumRows(), n = (long) c.GetNumCols();
+        assert(m == (long) a.GetNumRows());
+        if (m != (long) a.GetNumRows())
             InvalidArgument("To add column vector, rows should match.");
 
-        if (sizeof(ElemType) == sizeof(double))
-        {
-#pragma omp parallel for
-            foreach_column (j, c)
-            {
-#ifndef USE_MKL
-                daxpy(m, alpha, reinterpret_cast<double*>(a.m_pArray), 1, reinterpret_cast<double*>(c.m_pArray + c.LocateColumn(j)), 1);
-#else
-                cblas_daxpy(m, alpha, reinterpret_cast<double*>(a.m_pArray), 1, reinterpret_cast<double*>(c.m_pArray + c.LocateColumn(j)), 1);
-#endif
-            }
-        }
-        else
-        {
-#pragma omp parallel for
-            foreach_column (j, c)
-            {
-#pragma warning(suppress : 4244)
-#ifndef USE_MKL
-                saxpy(m, alpha, reinterpret_cast<float*>(a.m_pArray), 1, reinterpret_cast<float*>(c.m_pArray + c.LocateColumn(j)), 1);
-#else
-                cblas_saxpy(m, alpha, reinterpret_cast<float*>(a.m_pArray), 1, reinterpret_cast<float*>(c.m_pArray + c.LocateColumn(j)), 1);
-#endif
-            }
-        }
+        DISPATCH_ON_FIXED_ROW_COUNT(m, ColumnwiseScaleAndAddColumnVector, m, n, alpha, a.m_pArray, c.m_pArray);
     }
     else // row vector, add it to all rows
     {
@@ -4453,7 +5766,7 @@ void CPUMatrix<ElemType>::AddScaledDifference(const ElemType alpha, const CPUMat
         LogicError("AddScaledDifference:  Input matrix a is empty.");
 
     long m = (long) c.GetNumElements();
-#pragma omp parallel for
+#pragma omp parallel for if ((long) m >= s_elementwiseParallelThreshold)
     // four-way unrolling
     for (long i = 0; i < (m & ~3); i += 4)
     {
@@ -4492,7 +5805,7 @@ void CPUMatrix<ElemType>::AssignScaledDifference(const ElemType alpha, const CPU
         c.Resize(a.GetNumRows(), a.GetNumCols());
 
     long m = (long) c.GetNumElements();
-#pragma omp parallel for
+#pragma omp parallel for if ((long) m >= s_elementwiseParallelThreshold)
     // four-way unrolling
     for (long i = 0; i < (m & ~3); i += 4)
     {
@@ -4573,6 +5886,125 @@ void CPUMatrix<ElemType>::AssignScaledDifference(const CPUMatrix<ElemType>& alph
 
     AssignScaledDifference(alpha(0, 0), a, b, c);
 }
+
+/// <summary> c += alpha * (softmax(predictions) - labels)</summary>
+/// the softmax is reconstructed column by column from the per-column max and log partition
+/// function saved by AssignCrossEntropyWithSoftmaxOf, rather than read from a full-size temporary
+/// <param name="alpha">1X1 matrix</param>
+/// <param name="predictions">Input matrix</param>
+/// <param name="softmaxStats">2 x cols matrix of per-column (max, log partition function)</param>
+/// <param name="labels">Input matrix</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+template <class ElemType>
+void CPUMatrix<ElemType>::AddScaledSoftmaxDifference(const CPUMatrix<ElemType>& alpha, const CPUMatrix<ElemType>& predictions, const CPUMatrix<ElemType>& softmaxStats, const CPUMatrix<ElemType>& labels, CPUMatrix<ElemType>& c, const CPUMatrix<char>* columnsValidityMask /*= nullptr*/)
+{
+    assert(alpha.GetNumElements() == 1);
+    if (!(alpha.GetNumElements() == 1))
+        InvalidArgument("AddScaledSoftmaxDifference:  alpha must be a 1X1 matrix.");
+
+    const long m = (long) predictions.GetNumRows();
+    const long n = (long) predictions.GetNumCols();
+
+    if (!(labels.GetNumRows() == m && labels.GetNumCols() == n && c.GetNumRows() == m && c.GetNumCols() == n))
+        InvalidArgument("AddScaledSoftmaxDifference:  predictions, labels, and c must have same dimension.");
+
+    if (!(softmaxStats.GetNumRows() == 2 && softmaxStats.GetNumCols() == n))
+        InvalidArgument("AddScaledSoftmaxDifference:  softmaxStats must be a 2 x cols matrix.");
+
+    if (columnsValidityMask != nullptr && columnsValidityMask->GetNumCols() != n)
+        InvalidArgument("AddScaledSoftmaxDifference:  c and column mask must have equal number of columns.");
+
+    const ElemType alphaV = alpha(0, 0);
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        if (columnsValidityMask != nullptr && (*columnsValidityMask)(0, j) == 0) // gap column--no gradient
+            continue;
+        const ElemType shift = softmaxStats(0, j) + softmaxStats(1, j); // max + log partition function
+        const ElemType* pred = predictions.m_pArray + j * m;
+        const ElemType* lbl = labels.m_pArray + j * m;
+        ElemType* pc = c.m_pArray + j * m;
+        for (long i = 0; i < m; i++)
+            pc[i] += alphaV * (exp(pred[i] - shift) - lbl[i]);
+    }
+}
+
+/// <summary> c += alpha * (softmax(predictions) - onehot(labelIndexes)), without the one-hot matrix</summary>
+/// index-label variant of AddScaledSoftmaxDifference: labelIndexes holds the label class per
+/// column, and columns with a negative index (gaps) are skipped entirely
+/// <param name="alpha">1X1 matrix</param>
+/// <param name="predictions">Input matrix</param>
+/// <param name="softmaxStats">2 x cols matrix of per-column (max, log partition function)</param>
+/// <param name="labelIndexes">1 x cols matrix of label classes</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+template <class ElemType>
+void CPUMatrix<ElemType>::AddScaledIndexedSoftmaxDifference(const CPUMatrix<ElemType>& alpha, const CPUMatrix<ElemType>& predictions, const CPUMatrix<ElemType>& softmaxStats, const CPUMatrix<ElemType>& labelIndexes, CPUMatrix<ElemType>& c)
+{
+    assert(alpha.GetNumElements() == 1);
+    if (!(alpha.GetNumElements() == 1))
+        InvalidArgument("AddScaledIndexedSoftmaxDifference:  alpha must be a 1X1 matrix.");
+
+    const long m = (long) predictions.GetNumRows();
+    const long n = (long) predictions.GetNumCols();
+
+    if (!(labelIndexes.GetNumRows() == 1 && labelIndexes.GetNumCols() == n && c.GetNumRows() == m && c.GetNumCols() == n))
+        InvalidArgument("AddScaledIndexedSoftmaxDifference:  labelIndexes must be 1 x cols and predictions and c must have same dimension.");
+
+    if (!(softmaxStats.GetNumRows() == 2 && softmaxStats.GetNumCols() == n))
+        InvalidArgument("AddScaledIndexedSoftmaxDifference:  softmaxStats must be a 2 x cols matrix.");
+
+    const ElemType alphaV = alpha(0, 0);
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        const long idx = (long) labelIndexes(0, j);
+        if (idx < 0 || idx >= m) // gap column--no gradient
+            continue;
+        const ElemType shift = softmaxStats(0, j) + softmaxStats(1, j); // max + log partition function
+        const ElemType* pred = predictions.m_pArray + j * m;
+        ElemType* pc = c.m_pArray + j * m;
+        for (long i = 0; i < m; i++)
+            pc[i] += alphaV * exp(pred[i] - shift);
+        pc[idx] -= alphaV;
+    }
+}
+
+/// <summary> c += alpha * weight * logsoftmax(predictions)</summary>
+/// the log-softmax is reconstructed column by column from the per-column max and log partition
+/// function saved by AssignCrossEntropyWithSoftmaxOf
+/// <param name="alpha">Scalar</param>
+/// <param name="weight">1X1 matrix</param>
+/// <param name="predictions">Input matrix</param>
+/// <param name="softmaxStats">2 x cols matrix of per-column (max, log partition function)</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+template <class ElemType>
+void CPUMatrix<ElemType>::AddScaledLogSoftmax(const ElemType alpha, const CPUMatrix<ElemType>& weight, const CPUMatrix<ElemType>& predictions, const CPUMatrix<ElemType>& softmaxStats, CPUMatrix<ElemType>& c)
+{
+    assert(weight.GetNumElements() == 1);
+    if (!(weight.GetNumElements() == 1))
+        InvalidArgument("AddScaledLogSoftmax:  weight must be a 1X1 matrix.");
+
+    const long m = (long) predictions.GetNumRows();
+    const long n = (long) predictions.GetNumCols();
+
+    if (!(c.GetNumRows() == m && c.GetNumCols() == n))
+        InvalidArgument("AddScaledLogSoftmax:  predictions and c must have same dimension.");
+
+    if (!(softmaxStats.GetNumRows() == 2 && softmaxStats.GetNumCols() == n))
+        InvalidArgument("AddScaledLogSoftmax:  softmaxStats must be a 2 x cols matrix.");
+
+    const ElemType scale = alpha * weight(0, 0);
+#pragma omp parallel for if (m * n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(m * n))
+    for (long j = 0; j < n; j++)
+    {
+        const ElemType shift = softmaxStats(0, j) + softmaxStats(1, j); // max + log partition function
+        const ElemType* pred = predictions.m_pArray + j * m;
+        ElemType* pc = c.m_pArray + j * m;
+        for (long i = 0; i < m; i++)
+            pc[i] += scale * (pred[i] - shift);
+    }
+}
+
 /// <summary>Matrix-scalar multiply with col-major matrices: c = alpha * a</summary>
 /// <param name="alpha">Scalar</param>
 /// <param name="a">Input matrix</param>
@@ -4590,7 +6022,7 @@ void CPUMatrix<ElemType>::Scale(ElemType alpha, const CPUMatrix<ElemType>& a, CP
     c.Resize(m, n);
 
     long size = (long) c.GetNumElements();
-#pragma omp parallel for
+#pragma omp parallel for if (size >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(size))
     // four-way unrolling
     for (long i = 0; i < (size & ~3); i += 4)
     {
@@ -5193,7 +6625,7 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignElementProductOfWithShift(const
 
     // long m = (long)GetNumRows(), n = (long)GetNumCols();  // a and b are of size (1,n)
     long n = (long) GetNumCols(); // a and b are of size (1,n)
-#pragma omp parallel for
+#pragma omp parallel for if (n >= s_elementwiseParallelThreshold) num_threads(ElementwiseThreadTeam(n))
     for (long j = 0; j < n; j++)
     {
         us(0, j) = a(0, j) * b(0, (j + shift) % n);
@@ -5212,10 +6644,41 @@ double LogAddD(double x, double y)
 template <class ElemType>
 ElemType CPUMatrix<ElemType>::LogAddSumOfElements() const
 {
-    ElemType fAlpha = (ElemType) LZERO;
-    for (int k = 0; k < GetNumElements(); k++)
-        fAlpha = (ElemType) LogAddD(fAlpha, m_pArray[k]);
-    return fAlpha;
+    if (GetNumElements() == 0)
+        return (ElemType) LZERO;
+    return (ElemType) msra::math::logsumexp(m_pArray, GetNumElements());
+}
+
+/// the forward recursion of the RCRF:
+/// alpha(k, t) = pos_scores(k, t) + logsum_j (alpha(j, t - 1) + pair_scores(k, j)),
+/// where the start label stands in for alpha(., -1)
+template <class ElemType>
+void CPUMatrix<ElemType>::RCRFForwardCompute(CPUMatrix<ElemType>& alpha,
+                                             const CPUMatrix<ElemType>& pos_scores,
+                                             const CPUMatrix<ElemType>& pair_scores,
+                                             const int startLbl)
+{
+    int iNumPos = (int) pos_scores.GetNumCols();
+    int iNumLab = (int) pos_scores.GetNumRows();
+
+    alpha.Resize(iNumLab, iNumPos);
+
+    for (int t = 0; t < iNumPos; t++)
+    {
+#pragma omp parallel for
+        for (int k = 0; k < iNumLab; k++)
+        {
+            std::vector<double> scores(iNumLab); // alpha(j, t - 1) + pair_scores(k, j) over j, batched
+            for (int j = 0; j < iNumLab; j++)
+            {
+                double fAlpha = (j == startLbl) ? 0.0 : (double) LZERO;
+                if (t > 0)
+                    fAlpha = (double) alpha(j, t - 1);
+                scores[j] = fAlpha + pair_scores(k, j);
+            }
+            alpha(k, t) = (ElemType) msra::math::logsumexp(scores.data(), iNumLab) + pos_scores(k, t);
+        }
+    }
 }
 
 template <class ElemType>
@@ -5255,32 +6718,23 @@ void CPUMatrix<ElemType>::_rcrfBackwardCompute(size_t t, size_t k, const CPUMatr
     size_t iNumLab = alpha.GetNumRows();
     size_t iNumPos = alpha.GetNumCols();
 
-    ElemType fSum;
-    ElemType fTmp = (ElemType) LZERO;
     if (t == iNumPos - 1)
     {
-        fSum = (ElemType) LZERO;
-        for (int j = 0; j < iNumLab; j++)
-        {
-            fSum = (ElemType) LogAddD(fSum, alpha(j, t));
-        }
-
-        fTmp = alpha(k, t) - fSum;
-        beta(k, t) = fTmp;
+        ElemType fSum = (ElemType) msra::math::logsumexp(&alpha(0, t), iNumLab); // (a column is contiguous)
+        beta(k, t) = alpha(k, t) - fSum;
     }
     else
     {
+        std::vector<double> scores(iNumLab); // alpha(m, t) + pair_scores(j, m) over m, batched
+        std::vector<double> terms(iNumLab);  // the logadd chain over j, batched
         for (int j = 0; j < iNumLab; j++)
         {
-            fSum = (ElemType) LZERO;
             for (int m = 0; m < iNumLab; m++)
-            {
-                fSum = (ElemType) LogAddD(fSum, alpha(m, t) + pair_scores(j, m));
-            }
-
-            fTmp = (ElemType) LogAddD(fTmp, beta(j, t + 1) + alpha(k, t) + pair_scores(j, k) - fSum);
+                scores[m] = (double) (alpha(m, t) + pair_scores(j, m));
+            double fSum = msra::math::logsumexp(scores.data(), iNumLab);
+            terms[j] = (double) (beta(j, t + 1) + alpha(k, t) + pair_scores(j, k)) - fSum;
         }
-        beta(k, t) = fTmp;
+        beta(k, t) = (ElemType) msra::math::logsumexp(terms.data(), iNumLab);
     }
 }
 
@@ -5370,6 +6824,7 @@ void CPUMatrix<ElemType>::_rcrfTransGrdCompute(size_t i,
 
     {
         ElemType fTmp = (ElemType) LZERO;
+        std::vector<double> scores(iNumLab); // fTmp2 + pair_scores(j, k) over k, batched
         for (int j = 0; j < iNumLab; j++)
         {
             if (tPos == 0)
@@ -5389,7 +6844,6 @@ void CPUMatrix<ElemType>::_rcrfTransGrdCompute(size_t i,
             }
             fTmp += pair_scores(j, i);
 
-            ElemType fSum = (ElemType) LZERO;
             for (int k = 0; k < iNumLab; k++)
             {
                 ElemType fTmp2;
@@ -5408,8 +6862,9 @@ void CPUMatrix<ElemType>::_rcrfTransGrdCompute(size_t i,
                 {
                     fTmp2 = a(k, 0);
                 }
-                fSum = (ElemType) LogAddD(fSum, fTmp2 + pair_scores(j, k));
+                scores[k] = (double) (fTmp2 + pair_scores(j, k));
             }
+            ElemType fSum = (ElemType) msra::math::logsumexp(scores.data(), iNumLab);
 
             fTmp -= fSum;
             fTmp += b(j, 0);
@@ -5486,6 +6941,139 @@ int CPUMatrix<ElemType>::SetNumThreads(int numThreads)
     return numThreads;
 }
 
+// note: this function does not depend on the <ElemType> parameter
+template <class ElemType>
+size_t CPUMatrix<ElemType>::SetElementwiseParallelThreshold(size_t numElements)
+{
+    size_t previous = (size_t) s_elementwiseParallelThreshold;
+    s_elementwiseParallelThreshold = (long) numElements;
+    return previous;
+}
+
+// note: this function does not depend on the <ElemType> parameter
+// Measures on the actual machine where parallel elementwise execution starts to pay off:
+// (1) the element count at which a parallel loop beats the serial one, and (2) the count at
+// which the full thread team beats a small one. The fixed defaults are right on some
+// machines and badly wrong on others (a 32-core box forking 32 threads for ~100 elements
+// each loses to a single thread); one measurement at startup replaces the guess. Costs a
+// few milliseconds, and is a no-op in single-threaded configurations.
+template <class ElemType>
+void CPUMatrix<ElemType>::CalibrateParallelism()
+{
+#ifdef _OPENMP
+    int maxThreads = omp_get_max_threads();
+    if (maxThreads <= 1)
+        return; // nothing to calibrate
+
+    const long maxSize = 1 << 20;
+    std::vector<float> x(maxSize, 1.0f), y(maxSize, 2.0f);
+
+    // best-of-5 time of one y += 0.5*x pass over n elements with the given team size (0 = serial)
+    auto timeOnePass = [&](long n, int numThreads) -> double
+    {
+        double best = 1e30;
+        for (int r = 0; r < 5; r++)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            if (numThreads == 0)
+            {
+                for (long i = 0; i < n; i++)
+                    y[i] += 0.5f * x[i];
+            }
+            else
+            {
+#pragma omp parallel for num_threads(numThreads)
+                for (long i = 0; i < n; i++)
+                    y[i] += 0.5f * x[i];
+            }
+            double elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            best = min(best, elapsed);
+        }
+        return best;
+    };
+
+    int smallTeam = s_elementwiseSmallTeamThreads < maxThreads ? s_elementwiseSmallTeamThreads : maxThreads;
+
+    // smallest size at which the small team beats serial execution; the 10% margin keeps
+    // loops with more per-element overhead than the measured one on the safe (serial) side
+    long parallelThreshold = maxSize;
+    for (long n = 1024; n <= maxSize; n *= 2)
+    {
+        if (timeOnePass(n, smallTeam) * 1.1 < timeOnePass(n, 0))
+        {
+            parallelThreshold = n;
+            break;
+        }
+    }
+
+    // smallest size at which the full team beats the small team
+    long fullTeamThreshold = maxSize;
+    for (long n = parallelThreshold; n <= maxSize; n *= 2)
+    {
+        if (timeOnePass(n, maxThreads) * 1.1 < timeOnePass(n, smallTeam))
+        {
+            fullTeamThreshold = n;
+            break;
+        }
+    }
+
+    s_elementwiseParallelThreshold = parallelThreshold;
+    s_elementwiseFullTeamThreshold = fullTeamThreshold;
+    fprintf(stderr, "CalibrateParallelism: going parallel (%d threads) at %ld elements, full team (%d threads) at %ld elements.\n",
+            smallTeam, parallelThreshold, maxThreads, fullTeamThreshold);
+#endif
+}
+
+// note: this function does not depend on the <ElemType> parameter
+template <class ElemType>
+void CPUMatrix<ElemType>::SetUseHugePages(bool useHugePages)
+{
+#ifndef _WIN32
+    s_useHugePageAllocations = useHugePages;
+#else
+    // Windows large pages require the SeLockMemoryPrivilege and a different allocation path
+    if (useHugePages)
+        fprintf(stderr, "WARNING: huge-page-backed matrix buffers are only implemented for Linux; ignoring\n");
+#endif
+}
+
+// note: this function does not depend on the <ElemType> parameter
+template <class ElemType>
+void CPUMatrix<ElemType>::SetNumaAllocationPolicy(NumaAllocationPolicy policy)
+{
+#ifdef _WIN32
+    s_numaAllocationPolicy = policy;
+#else
+    // the NUMA helpers are implemented on top of the Win32 NUMA API only
+    if (policy != NumaAllocationPolicy::none)
+        fprintf(stderr, "WARNING: NUMA-aware allocation is only implemented for Windows; ignoring the policy\n");
+#endif
+}
+
+// pin each OpenMP worker thread to a fixed processor, spread over the machine
+// Without this, worker threads migrate between sockets and keep streaming matrix buffers
+// from remote NUMA nodes; with SetNumaAllocationPolicy(), buffers stay local instead.
+// note: this function does not depend on the <ElemType> parameter
+template <class ElemType>
+void CPUMatrix<ElemType>::PinWorkerThreads()
+{
+#ifdef _OPENMP
+#pragma omp parallel
+    {
+        int core = omp_get_thread_num();
+#ifdef _WIN32
+        // note: this covers the first 64 logical processors; beyond that, processor groups would be needed
+        SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR) 1 << (core % 64));
+#else
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(core % CPU_SETSIZE, &cpuset);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+#endif
+    }
+#endif
+}
+
 // =======================================================================
 // TensorView support
 // =======================================================================
@@ -5801,4 +7389,20 @@ template void CPUMatrix<char>::SetValue(const char);
 template void CPUMatrix<char>::SetValue(const size_t numRows, const size_t numCols, char* pArray, size_t matrixFlags);
 template void CPUMatrix<char>::SetValue(CPUMatrix<char> const&);
 template void CPUMatrix<char>::Resize(const size_t numRows, const size_t numCols, bool growOnly);
+
+// We use Matrix<short> as the backing store for quantized inference weights (8-bit precision
+// in 16-bit storage, see MultiplyQuantized above); same drill as Matrix<char>
+template CPUMatrix<short>::CPUMatrix(const size_t numRows, const size_t numCols);
+template CPUMatrix<short>::CPUMatrix(const size_t numRows, const size_t numCols, short* pArray, const size_t matrixFlags);
+template CPUMatrix<short>::CPUMatrix();
+template CPUMatrix<short>::CPUMatrix(CPUMatrix<short> const&);
+template CPUMatrix<short>::CPUMatrix(CPUMatrix<short>&&);
+template size_t CPUMatrix<short>::LocateElement(size_t, size_t) const;
+template CPUMatrix<short>::~CPUMatrix();
+template CPUMatrix<short> CPUMatrix<short>::ColumnSlice(size_t startColumn, size_t numCols) const;
+template CPUMatrix<short>& CPUMatrix<short>::operator=(CPUMatrix<short>&&);
+template void CPUMatrix<short>::SetValue(const short);
+template void CPUMatrix<short>::SetValue(const size_t numRows, const size_t numCols, short* pArray, size_t matrixFlags);
+template void CPUMatrix<short>::SetValue(CPUMatrix<short> const&);
+template void CPUMatrix<short>::Resize(const size_t numRows, const size_t numCols, bool growOnly);
 } } }
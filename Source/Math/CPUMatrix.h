@@ -22,6 +22,14 @@ namespace Microsoft { namespace MSR { namespace CNTK {
 
 double logadd(double x, double y);
 
+// placement policy for large matrix buffers on multi-socket (NUMA) machines (see CPUMatrix::SetNumaAllocationPolicy())
+enum class NumaAllocationPolicy
+{
+    none,      // plain allocation, placement is up to the OS (default)
+    localize,  // place each large buffer on the NUMA node of the allocating thread
+    interleave // distribute large buffers round-robin across NUMA nodes
+};
+
 //To compy with BLAS libraries matrices are stored in ColMajor. However, by default C/C++/C# use RowMajor
 //convertion is need when passing data between CPUMatrix and C++ matrices
 template <class ElemType>
@@ -75,6 +83,7 @@ public:
     CPUMatrix<ElemType> Diagonal() const;
 
     ElemType Adagrad(CPUMatrix<ElemType>& gradients, const bool needAveMultiplier);
+    void AdagradUpdate(CPUMatrix<ElemType>& gradients, CPUMatrix<ElemType>& functionValues, const ElemType learnRatePerSample); // fused Adagrad + weight step
     void FSAdagrad(CPUMatrix<ElemType>& gradients, CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight, ElemType adaMul);
     ElemType RmsProp(CPUMatrix<ElemType>& gradients,
                      ElemType RMS_GAMMA,
@@ -89,6 +98,8 @@ public:
     ElemType* CopyToArray() const;                                                 // allocated by the callee but need to be deleted by the caller
     size_t CopyToArray(ElemType*& arrayCopyTo, size_t& currentArraySize) const;    // allocated by the callee but need to be deleted by the caller
     void CopySection(size_t numRows, size_t numCols, ElemType* dst, size_t colStride) const;
+    void CopyToFloat16Array(unsigned short* halfArray) const;                      // export as packed IEEE binary16; caller allocates GetNumElements() entries
+    void SetValueFromFloat16Array(const size_t numRows, const size_t numCols, const unsigned short* halfArray);
 
     inline ElemType& operator()(const size_t row, const size_t col)
     {
@@ -118,6 +129,11 @@ public:
     void SetUniformRandomValue(const ElemType low, const ElemType high, unsigned long seed = USE_TIME_BASED_SEED);
     void SetGaussianRandomValue(const ElemType mean, const ElemType sigma, unsigned long seed = USE_TIME_BASED_SEED);
     void SetUniformRandomMask(const ElemType maskRate, const ElemType scaleValue, unsigned long seed = USE_TIME_BASED_SEED);
+
+    // fused dropout: the mask is regenerated from (randomSeed, offset + element index) on the fly
+    // and never materialized; 'offset' is the slice's first element within the full minibatch matrix
+    CPUMatrix<ElemType>& AssignDropoutOf(const CPUMatrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset);
+    CPUMatrix<ElemType>& AddDropoutGradientOf(const CPUMatrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset);
     void AddGaussianRandomValue(const ElemType mean, const ElemType sigma, unsigned long seed = USE_TIME_BASED_SEED);
 
     CPUMatrix<ElemType> Transpose();
@@ -184,6 +200,8 @@ public:
 
     CPUMatrix<ElemType>& InplaceLogSoftmax(const bool isColWise);
     CPUMatrix<ElemType>& AssignLogSoftmaxOf(const CPUMatrix<ElemType>& a, const bool isColWise);
+    CPUMatrix<ElemType>& AssignCrossEntropyWithSoftmaxOf(const CPUMatrix<ElemType>& labels, const CPUMatrix<ElemType>& predictions, CPUMatrix<ElemType>& softmaxStats, const CPUMatrix<char>* columnsValidityMask = nullptr); // softmaxStats is resized to 2 x cols; masked-out columns (gaps) are skipped
+    CPUMatrix<ElemType>& AssignIndexedCrossEntropyWithSoftmaxOf(const CPUMatrix<ElemType>& labelIndexes, const CPUMatrix<ElemType>& predictions, CPUMatrix<ElemType>& softmaxStats); // labelIndexes is 1 x cols (negative = gap); softmaxStats is resized to 2 x cols
 
     CPUMatrix<ElemType>& InplaceHardmax(const bool isColWise);
     CPUMatrix<ElemType>& AssignHardmaxOf(const CPUMatrix<ElemType>& a, const bool isColWise);
@@ -223,6 +241,7 @@ public:
 
     ElemType SumOfAbsElements() const; // sum of all abs(elements)
     ElemType SumOfElements() const;    // sum of all elements
+    void AccumulateAbsLogHistogram(int minExponent, CPUMatrix<ElemType>& histogram) const;
     CPUMatrix<ElemType>& AssignSumOfElements(const CPUMatrix<ElemType>& a);
 
     bool IsEqualTo(const CPUMatrix<ElemType>& a, const ElemType threshold = 1e-8) const;
@@ -270,8 +289,23 @@ public:
 
     CPUMatrix<ElemType>& AssignToRowSliceValuesOf(const CPUMatrix<ElemType>& a, const size_t startIndex, const size_t numRows);
 
+    CPUMatrix<ElemType>& AssignRowGatherOf(const CPUMatrix<ElemType>& idx, const CPUMatrix<ElemType>& a);
+    CPUMatrix<ElemType>& AddWithRowGatherOf(const CPUMatrix<ElemType>& idx, const CPUMatrix<ElemType>& a);
+    CPUMatrix<ElemType>& AddRowScatterOf(const CPUMatrix<ElemType>& idx, const CPUMatrix<ElemType>& a);
+
     CPUMatrix<ElemType>& AssignRepeatOf(const CPUMatrix<ElemType>& a, const size_t numRowRepeats, const size_t numColRepeats);
     CPUMatrix<ElemType>& AddToRowRepeatValuesOf(const CPUMatrix<ElemType>& a, const size_t numRowRepeats);
+    CPUMatrix<ElemType>& AssignGatheredColumnsOf(const CPUMatrix<ElemType>& a, const std::vector<size_t>& columnIndices);
+    CPUMatrix<ElemType>& ScatterGatheredColumnsOf(const CPUMatrix<ElemType>& packed, const std::vector<size_t>& columnIndices);
+
+    // quantized inference (see IsQuantizedInference() in CommonMatrix.h)
+    void QuantizeTransposedRowwise(CPUMatrix<short>& qweightsT, CPUMatrix<ElemType>& rowScales) const;
+    static void MultiplyQuantized(const CPUMatrix<short>& qweightsT, const CPUMatrix<ElemType>& rowScales, const CPUMatrix<ElemType>& input, CPUMatrix<ElemType>& output);
+
+    // persistently packed GEMM operands (see UsePrepackedWeights() in CommonMatrix.h)
+    static ElemType* PackForMultiply(const CPUMatrix<ElemType>& a, const bool transposeA); // returns nullptr when the BLAS has no packed-GEMM interface
+    static void MultiplyPackedAndAdd(const ElemType* packedA, const size_t aRows, const size_t aCols, const bool transposeA, const CPUMatrix<ElemType>& b, CPUMatrix<ElemType>& c);
+    static void ReleasePackedMultiply(ElemType* packedA);
 
     CPUMatrix<ElemType>& AssignPositiveAndShiftedNegSample(const CPUMatrix<ElemType>& a, const size_t posNumber, const size_t negNumber, const size_t shiftNumber);
     CPUMatrix<ElemType>& AddFoldedPositiveAndShiftedNegSample(const CPUMatrix<ElemType>& a, const size_t posNumber, const size_t negNumber, const size_t shiftNumber);
@@ -280,6 +314,7 @@ public:
     void VectorMin(CPUMatrix<ElemType>& minIndexes, CPUMatrix<ElemType>& minValues, const bool isColWise) const;
 
     CPUMatrix<ElemType>& AssignNumOfDiff(const CPUMatrix<ElemType>& a, const CPUMatrix<ElemType>& b, bool searchInCol = false);
+    CPUMatrix<ElemType>& AssignTopKError(const CPUMatrix<ElemType>& labels, const CPUMatrix<ElemType>& predictions, const int topK);
 
     void Print(const char* matrixName, size_t rowStart, size_t rowEnd, size_t colStart, size_t colEnd) const;
     void Print(const char* matrixName = nullptr) const; // print whole matrix. can be expensive
@@ -301,6 +336,21 @@ public:
                                                 const size_t inputWidth, const size_t inputHeight, const size_t inputSizePerSample,
                                                 const size_t outputWidth, const size_t outputHeight, const size_t outputSizePerSample,
                                                 const size_t windowWidth, const size_t windowHeight, const size_t horizontalSubsample, const size_t verticalSubsample);
+    // fused batch normalization over the columns of 'this' (one sample per column); the statistics
+    // dimension is taken from 'scale' (== rows for per-activation, channels for spatial mode)
+    void BatchNormalizationForward(const CPUMatrix<ElemType>& scale, const CPUMatrix<ElemType>& bias,
+                                   double expAvgFactor, double epsilon,
+                                   CPUMatrix<ElemType>& runMean, CPUMatrix<ElemType>& runInvStdDev,
+                                   CPUMatrix<ElemType>& out,
+                                   CPUMatrix<ElemType>& saveMean, CPUMatrix<ElemType>& saveInvStdDev) const;
+    void BatchNormalizationForwardInference(const CPUMatrix<ElemType>& scale, const CPUMatrix<ElemType>& bias,
+                                            const CPUMatrix<ElemType>& runMean, const CPUMatrix<ElemType>& runInvStdDev,
+                                            CPUMatrix<ElemType>& out) const;
+    void BatchNormalizationBackward(const CPUMatrix<ElemType>& in, CPUMatrix<ElemType>& grad,
+                                    const CPUMatrix<ElemType>& scale,
+                                    const CPUMatrix<ElemType>& saveMean, const CPUMatrix<ElemType>& saveInvStdDev,
+                                    CPUMatrix<ElemType>& scaleGrad, CPUMatrix<ElemType>& biasGrad) const;
+
     CPUMatrix<ElemType>& AddMaxPoolingGradient(const CPUMatrix<ElemType>& outputGradientBatch, const CPUMatrix<ElemType>& inputBatch, const CPUMatrix<ElemType>& outputBatch,
                                                const size_t channels,
                                                const size_t inputWidth, const size_t inputHeight, const size_t inputSizePerSample,
@@ -319,10 +369,30 @@ public:
 public:
     static int SetNumThreads(int numThreads); // note: this does not depend on <ElemType>, i.e. you can call it on any <ElemType>
 
+    // element count below which elementwise operations run on the calling thread instead of
+    // opening an OpenMP parallel region; returns the previous threshold
+    static size_t SetElementwiseParallelThreshold(size_t numElements); // note: this does not depend on <ElemType> either
+
+    // measure the serial/small-team/full-team crossover sizes for elementwise loops on the
+    // actual machine and set the thresholds accordingly; call once at startup after SetNumThreads()
+    static void CalibrateParallelism(); // note: this does not depend on <ElemType> either
+
+    // choose how large matrix buffers are placed on multi-socket machines (Windows only; ignored elsewhere)
+    static void SetNumaAllocationPolicy(NumaAllocationPolicy policy); // note: this does not depend on <ElemType>
+
+    // opt large matrix buffers into 2 MB (transparent-huge-page) backing (Linux only; ignored elsewhere)
+    static void SetUseHugePages(bool useHugePages); // note: this does not depend on <ElemType>
+
+    // pin the OpenMP worker threads to fixed processors, so that the parallelized elementwise
+    // loops keep touching the same (local) memory across minibatches instead of migrating
+    static void PinWorkerThreads(); // note: this does not depend on <ElemType>
+
     // static BLAS functions
     static void SVD(const CPUMatrix<ElemType>& A, CPUMatrix<ElemType>& SIGMA, CPUMatrix<ElemType>& U, CPUMatrix<ElemType>& VT, CPUMatrix<ElemType>& W);
 
     static void MultiplyAndWeightedAdd(ElemType alpha, const CPUMatrix<ElemType>& a, const bool transposeA, const CPUMatrix<ElemType>& b, const bool transposeB, ElemType beta, CPUMatrix<ElemType>& c);
+    static void MultiplyAndWeightedAddBatched(ElemType alpha, const std::vector<const CPUMatrix<ElemType>*>& a, const bool transposeA, const std::vector<const CPUMatrix<ElemType>*>& b, const bool transposeB, ElemType beta, const std::vector<CPUMatrix<ElemType>*>& c);
+    static void MultiplyAddBiasAndApply(ElemType alpha, const CPUMatrix<ElemType>& a, const bool transposeA, const CPUMatrix<ElemType>& b, const bool transposeB, ElemType beta, CPUMatrix<ElemType>& c, const CPUMatrix<ElemType>& bias, ElementWiseOperator nonlinearity);
     static void MultiplyAndAdd(const CPUMatrix<ElemType>& a, const bool transposeA, const CPUMatrix<ElemType>& b, const bool transposeB, CPUMatrix<ElemType>& c);
     static void Multiply(const CPUMatrix<ElemType>& a, const bool transposeA, const CPUMatrix<ElemType>& b, const bool transposeB, CPUMatrix<ElemType>& c);
     static void Multiply(const CPUMatrix<ElemType>& a, const CPUMatrix<ElemType>& b, CPUMatrix<ElemType>& c);
@@ -333,6 +403,9 @@ public:
     static void AssignScaledDifference(const ElemType alpha, const CPUMatrix<ElemType>& a, const CPUMatrix<ElemType>& b, CPUMatrix<ElemType>& c);
     static void AddScaledDifference(const CPUMatrix<ElemType>& alpha, const CPUMatrix<ElemType>& a, const CPUMatrix<ElemType>& b, CPUMatrix<ElemType>& c);    // alpha must be 1X1
     static void AssignScaledDifference(const CPUMatrix<ElemType>& alpha, const CPUMatrix<ElemType>& a, const CPUMatrix<ElemType>& b, CPUMatrix<ElemType>& c); // alpha must be 1X1
+    static void AddScaledSoftmaxDifference(const CPUMatrix<ElemType>& alpha, const CPUMatrix<ElemType>& predictions, const CPUMatrix<ElemType>& softmaxStats, const CPUMatrix<ElemType>& labels, CPUMatrix<ElemType>& c, const CPUMatrix<char>* columnsValidityMask = nullptr); // alpha must be 1X1
+    static void AddScaledIndexedSoftmaxDifference(const CPUMatrix<ElemType>& alpha, const CPUMatrix<ElemType>& predictions, const CPUMatrix<ElemType>& softmaxStats, const CPUMatrix<ElemType>& labelIndexes, CPUMatrix<ElemType>& c); // alpha must be 1X1; labelIndexes is 1 x cols (negative = gap)
+    static void AddScaledLogSoftmax(const ElemType alpha, const CPUMatrix<ElemType>& weight, const CPUMatrix<ElemType>& predictions, const CPUMatrix<ElemType>& softmaxStats, CPUMatrix<ElemType>& c); // weight must be 1X1
 
     static void AddElementToElement(const CPUMatrix<ElemType>& a, const size_t ai, const size_t aj, CPUMatrix<ElemType>& c, const size_t ci, const size_t cj);
     // static void AddLogElementToElement(const CPUMatrix<ElemType>& a, const size_t ai, const size_t aj, CPUMatrix<ElemType>& c, const size_t ci, const size_t cj);
@@ -427,6 +500,11 @@ public:
 
 public:
     // for RCRF
+    static void RCRFForwardCompute(CPUMatrix<ElemType>& alpha,
+                                   const CPUMatrix<ElemType>& pos_scores,
+                                   const CPUMatrix<ElemType>& pair_scores,
+                                   const int startLbl);
+
     static void RCRFBackwardCompute(const CPUMatrix<ElemType>& alpha, CPUMatrix<ElemType>& beta,
                                     const CPUMatrix<ElemType>& lbls,
                                     const CPUMatrix<ElemType>& pair_scores);
@@ -0,0 +1,281 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// AVX2/FMA elementwise kernels, see CPUMatrixAvxKernels.h. This file is the only translation
+// unit built with the AVX2 ISA enabled (the Makefile appends -mavx2 -mfma for it; MSVC admits
+// the intrinsics without a flag), so no AVX instruction can leak into code that runs before
+// the CpuSupportsAvx2Fma() check. Do not add code here that executes unconditionally.
+//
+#include "stdafx.h"
+#include "CPUMatrixAvxKernels.h"
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// -----------------------------------------------------------------------
+// CPUID feature detection
+// -----------------------------------------------------------------------
+
+// Using the kernels needs three things: AVX2 and FMA in CPUID, and an OS that saves the
+// YMM half of the registers across context switches (OSXSAVE set and XCR0 reporting both
+// XMM and YMM state enabled -- without that, AVX executes but corrupts state on every
+// preemption).
+static bool DetermineAvx2FmaSupport()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuidex(info, 1, 0);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!fma || !osxsave || !avx)
+        return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) // XCR0 bits 1 and 2: XMM and YMM state enabled
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0; // EBX bit 5: AVX2
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, nullptr) < 7)
+        return false;
+    __cpuid_count(1, 0, eax, ebx, ecx, edx);
+    const bool fma = (ecx & (1 << 12)) != 0;
+    const bool osxsave = (ecx & (1 << 27)) != 0;
+    const bool avx = (ecx & (1 << 28)) != 0;
+    if (!fma || !osxsave || !avx)
+        return false;
+    unsigned int xlo, xhi;
+    __asm__ __volatile__("xgetbv" : "=a"(xlo), "=d"(xhi) : "c"(0));
+    if ((xlo & 0x6) != 0x6) // XCR0 bits 1 and 2: XMM and YMM state enabled
+        return false;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ebx & (1 << 5)) != 0; // EBX bit 5: AVX2
+#else
+    return false; // non-x86 target
+#endif
+}
+
+// integer-only, so safe to run before the feature check even in this AVX-enabled TU
+static const bool s_avx2FmaSupported = DetermineAvx2FmaSupport();
+
+bool CpuSupportsAvx2Fma()
+{
+    return s_avx2FmaSupported;
+}
+
+// -----------------------------------------------------------------------
+// vectorized exp (single precision)
+// -----------------------------------------------------------------------
+
+// exp(x) via range reduction exp(x) = 2^n * exp(g), |g| <= log(2)/2, with a degree-6
+// polynomial for exp(g) (Cephes coefficients, ~1 ulp over the reduced range). Inputs are
+// clamped to the finite range of float exp, so out-of-range arguments saturate instead of
+// producing inf/0 garbage in the 2^n reconstruction.
+static inline __m256 ExpPs(__m256 x)
+{
+    const __m256 expHi = _mm256_set1_ps(88.3762626647950f);
+    const __m256 expLo = _mm256_set1_ps(-88.3762626647949f);
+    const __m256 log2e = _mm256_set1_ps(1.44269504088896341f);
+    const __m256 ln2Hi = _mm256_set1_ps(0.693359375f);
+    const __m256 ln2Lo = _mm256_set1_ps(-2.12194440e-4f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    x = _mm256_min_ps(_mm256_max_ps(x, expLo), expHi);
+
+    // n = round(x / log(2)); g = x - n * log(2), with log(2) split in two for precision
+    __m256 n = _mm256_floor_ps(_mm256_fmadd_ps(x, log2e, _mm256_set1_ps(0.5f)));
+    x = _mm256_fnmadd_ps(n, ln2Hi, x);
+    x = _mm256_fnmadd_ps(n, ln2Lo, x);
+
+    __m256 z = _mm256_mul_ps(x, x);
+    __m256 y = _mm256_set1_ps(1.9875691500e-4f);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.3981999507e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(8.3334519073e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(4.1665795894e-2f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.6666665459e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(5.0000001201e-1f));
+    y = _mm256_fmadd_ps(y, z, _mm256_add_ps(x, one));
+
+    // reconstruct 2^n by building its exponent field directly
+    __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(0x7f)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(e));
+}
+
+// -----------------------------------------------------------------------
+// kernels
+// -----------------------------------------------------------------------
+
+void AssignElementProductOfAvx(float* us, const float* a, const float* b, long N, int numThreads)
+{
+    const long n = N & ~7;
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+    for (long i = 0; i < n; i += 8)
+        _mm256_storeu_ps(us + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    for (long i = n; i < N; i++)
+        us[i] = a[i] * b[i];
+}
+
+void AssignElementProductOfAvx(double* us, const double* a, const double* b, long N, int numThreads)
+{
+    const long n = N & ~3;
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+    for (long i = 0; i < n; i += 4)
+        _mm256_storeu_pd(us + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    for (long i = n; i < N; i++)
+        us[i] = a[i] * b[i];
+}
+
+void AddElementProductOfAvx(float* us, const float* a, const float* b, long N, int numThreads)
+{
+    const long n = N & ~7;
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+    for (long i = 0; i < n; i += 8)
+        _mm256_storeu_ps(us + i, _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), _mm256_loadu_ps(us + i)));
+    for (long i = n; i < N; i++)
+        us[i] += a[i] * b[i];
+}
+
+void AddElementProductOfAvx(double* us, const double* a, const double* b, long N, int numThreads)
+{
+    const long n = N & ~3;
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+    for (long i = 0; i < n; i += 4)
+        _mm256_storeu_pd(us + i, _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _mm256_loadu_pd(us + i)));
+    for (long i = n; i < N; i++)
+        us[i] += a[i] * b[i];
+}
+
+void AssignScalarDifferenceOfAvx(float* us, float alpha, const float* a, bool flipSign, long N, int numThreads)
+{
+    const long n = N & ~7;
+    const __m256 valpha = _mm256_set1_ps(alpha);
+    if (flipSign)
+    {
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+        for (long i = 0; i < n; i += 8)
+            _mm256_storeu_ps(us + i, _mm256_sub_ps(valpha, _mm256_loadu_ps(a + i)));
+    }
+    else
+    {
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+        for (long i = 0; i < n; i += 8)
+            _mm256_storeu_ps(us + i, _mm256_sub_ps(_mm256_loadu_ps(a + i), valpha));
+    }
+    for (long i = n; i < N; i++)
+        us[i] = flipSign ? alpha - a[i] : a[i] - alpha;
+}
+
+void AssignScalarDifferenceOfAvx(double* us, double alpha, const double* a, bool flipSign, long N, int numThreads)
+{
+    const long n = N & ~3;
+    const __m256d valpha = _mm256_set1_pd(alpha);
+    if (flipSign)
+    {
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+        for (long i = 0; i < n; i += 4)
+            _mm256_storeu_pd(us + i, _mm256_sub_pd(valpha, _mm256_loadu_pd(a + i)));
+    }
+    else
+    {
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+        for (long i = 0; i < n; i += 4)
+            _mm256_storeu_pd(us + i, _mm256_sub_pd(_mm256_loadu_pd(a + i), valpha));
+    }
+    for (long i = n; i < N; i++)
+        us[i] = flipSign ? alpha - a[i] : a[i] - alpha;
+}
+
+void InplaceTruncateAvx(float* us, float threshold, long N, int numThreads)
+{
+    const float pos = threshold < 0 ? -threshold : threshold;
+    const __m256 vpos = _mm256_set1_ps(pos);
+    const __m256 vneg = _mm256_set1_ps(-pos);
+    const long n = N & ~7;
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+    for (long i = 0; i < n; i += 8)
+        _mm256_storeu_ps(us + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(us + i), vneg), vpos));
+    for (long i = n; i < N; i++)
+        us[i] = us[i] > pos ? pos : (us[i] < -pos ? -pos : us[i]);
+}
+
+void InplaceTruncateAvx(double* us, double threshold, long N, int numThreads)
+{
+    const double pos = threshold < 0 ? -threshold : threshold;
+    const __m256d vpos = _mm256_set1_pd(pos);
+    const __m256d vneg = _mm256_set1_pd(-pos);
+    const long n = N & ~3;
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+    for (long i = 0; i < n; i += 4)
+        _mm256_storeu_pd(us + i, _mm256_min_pd(_mm256_max_pd(_mm256_loadu_pd(us + i), vneg), vpos));
+    for (long i = n; i < N; i++)
+        us[i] = us[i] > pos ? pos : (us[i] < -pos ? -pos : us[i]);
+}
+
+void AssignExpOfAvx(float* us, const float* a, long N, int numThreads)
+{
+    const long n = N & ~7;
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+    for (long i = 0; i < n; i += 8)
+        _mm256_storeu_ps(us + i, ExpPs(_mm256_loadu_ps(a + i)));
+    for (long i = n; i < N; i++)
+        us[i] = exp(a[i]);
+}
+
+void AssignSigmoidOfAvx(float* us, const float* a, long N, int numThreads)
+{
+    // numerically stable form: with e = exp(-|x|) in (0, 1], sigmoid(x) is 1/(1+e) for
+    // x >= 0 and e/(1+e) = 1 - 1/(1+e) for x < 0, so nothing ever overflows
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const long n = N & ~7;
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+    for (long i = 0; i < n; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(a + i);
+        __m256 e = ExpPs(_mm256_or_ps(_mm256_andnot_ps(signMask, x), signMask)); // exp(-|x|)
+        __m256 r = _mm256_div_ps(one, _mm256_add_ps(one, e));
+        __m256 negative = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ);
+        _mm256_storeu_ps(us + i, _mm256_blendv_ps(r, _mm256_sub_ps(one, r), negative));
+    }
+    for (long i = n; i < N; i++)
+    {
+        if (a[i] >= 0)
+            us[i] = 1 / (1 + exp(-a[i]));
+        else
+        {
+            float v = exp(a[i]);
+            us[i] = v / (1 + v);
+        }
+    }
+}
+
+void AssignTanhOfAvx(float* us, const float* a, long N, int numThreads)
+{
+    // tanh(x) = sign(x) * (1 - e) / (1 + e) with e = exp(-2|x|) in (0, 1]; e underflows to
+    // 0 for large |x|, giving exactly +/-1 with no overflow anywhere
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 minusTwo = _mm256_set1_ps(-2.0f);
+    const long n = N & ~7;
+#pragma omp parallel for if (numThreads > 1) num_threads(numThreads)
+    for (long i = 0; i < n; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(a + i);
+        __m256 e = ExpPs(_mm256_mul_ps(minusTwo, _mm256_andnot_ps(signMask, x))); // exp(-2|x|)
+        __m256 r = _mm256_div_ps(_mm256_sub_ps(one, e), _mm256_add_ps(one, e));
+        _mm256_storeu_ps(us + i, _mm256_or_ps(r, _mm256_and_ps(signMask, x))); // copy x's sign
+    }
+    for (long i = n; i < N; i++)
+        us[i] = tanh(a[i]);
+}
+
+} } }
@@ -0,0 +1,47 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#pragma once
+
+// AVX2/FMA kernels for the hot elementwise loops of CPUMatrix. The implementations live in
+// CPUMatrixAvxKernels.cpp, which is the only translation unit compiled with the AVX2 ISA
+// enabled; everything else keeps the SSE3 baseline, so one binary runs on every machine.
+// Callers must guard every call with CpuSupportsAvx2Fma(), which checks CPUID (and XGETBV,
+// i.e. whether the OS saves the YMM registers) once at first use.
+//
+// All kernels run one flat pass over the dense column-major buffer (column stride == row
+// count), which holds for the whole-matrix operations that use them. numThreads gives the
+// OpenMP team size to use, 1 meaning stay on the calling thread; the caller computes it
+// from the same thresholds as the scalar loops (see ElementwiseThreadTeam() in
+// CPUMatrix.cpp). The exp/sigmoid/tanh kernels exist in single precision only -- they are
+// built on a polynomial exp whose accuracy (~1 ulp) only makes sense against float; double
+// callers keep the libm loop.
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// true iff the CPU and OS support AVX2 and FMA; determined once, constant thereafter
+bool CpuSupportsAvx2Fma();
+
+// us[i] = a[i] * b[i]
+void AssignElementProductOfAvx(float* us, const float* a, const float* b, long N, int numThreads);
+void AssignElementProductOfAvx(double* us, const double* a, const double* b, long N, int numThreads);
+
+// us[i] += a[i] * b[i]
+void AddElementProductOfAvx(float* us, const float* a, const float* b, long N, int numThreads);
+void AddElementProductOfAvx(double* us, const double* a, const double* b, long N, int numThreads);
+
+// us[i] = alpha - a[i] (flipSign == true) or a[i] - alpha (flipSign == false)
+void AssignScalarDifferenceOfAvx(float* us, float alpha, const float* a, bool flipSign, long N, int numThreads);
+void AssignScalarDifferenceOfAvx(double* us, double alpha, const double* a, bool flipSign, long N, int numThreads);
+
+// us[i] = min(max(us[i], -|threshold|), |threshold|)  (gradient clipping)
+void InplaceTruncateAvx(float* us, float threshold, long N, int numThreads);
+void InplaceTruncateAvx(double* us, double threshold, long N, int numThreads);
+
+// us[i] = exp(a[i]) / sigmoid(a[i]) / tanh(a[i])  (single precision only, see above)
+void AssignExpOfAvx(float* us, const float* a, long N, int numThreads);
+void AssignSigmoidOfAvx(float* us, const float* a, long N, int numThreads);
+void AssignTanhOfAvx(float* us, const float* a, long N, int numThreads);
+
+} } }
@@ -118,6 +118,7 @@ void CPUSparseMatrix<ElemType>::ZeroInit()
         m_pArray = NULL;
         m_blockIds = NULL;
     }
+    m_blockDim = 0;
     m_nzValues = NULL;
 }
 
@@ -125,7 +126,7 @@ void CPUSparseMatrix<ElemType>::ZeroInit()
 template <class ElemType>
 void CPUSparseMatrix<ElemType>::CheckInit(const MatrixFormat format)
 {
-    if (format != MatrixFormat::matrixFormatSparseCSC && format != MatrixFormat::matrixFormatSparseCSR && format != MatrixFormat::matrixFormatSparseBlockCol && format != MatrixFormat::matrixFormatSparseBlockRow)
+    if (format != MatrixFormat::matrixFormatSparseCSC && format != MatrixFormat::matrixFormatSparseCSR && format != MatrixFormat::matrixFormatSparseBlockCol && format != MatrixFormat::matrixFormatSparseBlockRow && format != MatrixFormat::matrixFormatSparseBSR)
     {
         LogicError("CPUSparseMatrix:  unsupported sparse matrix format");
     }
@@ -192,6 +193,7 @@ CPUSparseMatrix<ElemType>::CPUSparseMatrix(CPUSparseMatrix<ElemType>&& moveFrom)
     m_blockSize = moveFrom.m_blockSize;
     m_blockIdShift = moveFrom.m_blockIdShift;
     m_blockIds = moveFrom.m_blockIds;
+    m_blockDim = moveFrom.m_blockDim;
 
     // release the pointer from the source object so that the destructor won't release it twice
     moveFrom.ZeroInit();
@@ -225,6 +227,7 @@ CPUSparseMatrix<ElemType>& CPUSparseMatrix<ElemType>::operator=(CPUSparseMatrix<
         m_blockSize = moveFrom.m_blockSize;
         m_blockIdShift = moveFrom.m_blockIdShift;
         m_blockIds = moveFrom.m_blockIds;
+        m_blockDim = moveFrom.m_blockDim;
 
         // release the pointer from the source object so that the destructor won't release it twice
         moveFrom.ZeroInit();
@@ -248,7 +251,7 @@ void CPUSparseMatrix<ElemType>::ReleaseMemory()
     {
         delete[] m_matrixName;
 
-        if (m_format == MatrixFormat::matrixFormatSparseCSC || m_format == MatrixFormat::matrixFormatSparseCSR)
+        if (m_format == MatrixFormat::matrixFormatSparseCSC || m_format == MatrixFormat::matrixFormatSparseCSR || m_format == MatrixFormat::matrixFormatSparseBSR)
         {
             delete[] m_pArray;
             m_pArray = nullptr;
@@ -529,6 +532,79 @@ void CPUSparseMatrix<ElemType>::SetMatrixFromCSCFormat(const CPUSPARSE_INDEX_TYP
     memcpy(NzValues(), h_Val, NzSize());
 }
 
+// convert a CSC matrix into this matrix in BSR (block-compressed sparse row) form
+// BSR stores square blockDim x blockDim blocks of the original matrix; every block containing at
+// least one non-zero is stored densely (column-major within the block), addressed CSR-style with
+// block-row pointers in m_compIndex and block-column ids in m_unCompIndex. For pruned weight
+// matrices this trades storing a few explicit zeros for contiguous, register-blockable access in
+// MultiplyAndWeightedAdd(). Convert once at model-load time; the format is read-only after that
+// (SetValue() and the training-side operations are not supported on it).
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::SetBlockSparseRowFromCSC(const CPUSparseMatrix<ElemType>& csc, const size_t blockDim)
+{
+    if (!OwnBuffer())
+        LogicError("Cannot modify since the buffer is managed externally.");
+    if (m_format != MatrixFormat::matrixFormatSparseBSR)
+        LogicError("SetBlockSparseRowFromCSC: target matrix must be constructed with matrixFormatSparseBSR.");
+    if (csc.GetFormat() != MatrixFormat::matrixFormatSparseCSC)
+        LogicError("SetBlockSparseRowFromCSC: source matrix must be in CSC format.");
+    if (blockDim < 1 || blockDim > 8) // the multiply kernel keeps one accumulator per block row in registers
+        InvalidArgument("SetBlockSparseRowFromCSC: block dimension must be 1..8, not %d.", (int) blockDim);
+    if (csc.IsEmpty())
+        LogicError("SetBlockSparseRowFromCSC: source matrix is empty.");
+
+    const size_t numBlockRows = (csc.GetNumRows() + blockDim - 1) / blockDim;
+    const size_t numBlockCols = (csc.GetNumCols() + blockDim - 1) / blockDim;
+
+    // pass 1: find the non-empty blocks
+    const CPUSPARSE_INDEX_TYPE empty = -1, occupied = -2;
+    std::vector<CPUSPARSE_INDEX_TYPE> blockPos(numBlockRows * numBlockCols, empty); // block coordinate -> index of stored block
+    for (size_t j = 0; j < csc.GetNumCols(); j++)
+        for (size_t p = csc.m_compIndex[j]; p < (size_t) csc.m_compIndex[j + 1]; p++)
+            blockPos[(csc.m_unCompIndex[p] / blockDim) * numBlockCols + j / blockDim] = occupied;
+
+    // lay the stored blocks out in block-row order and form the CSR-style block index
+    delete[] m_pArray; // non-NULL only when re-converting into the same object
+    delete[] m_unCompIndex;
+    delete[] m_compIndex;
+
+    m_compIndex = new CPUSPARSE_INDEX_TYPE[numBlockRows + 1];
+    size_t numBlocks = 0;
+    for (size_t ib = 0; ib < numBlockRows; ib++)
+    {
+        m_compIndex[ib] = (CPUSPARSE_INDEX_TYPE) numBlocks;
+        for (size_t jb = 0; jb < numBlockCols; jb++)
+            if (blockPos[ib * numBlockCols + jb] == occupied)
+                blockPos[ib * numBlockCols + jb] = (CPUSPARSE_INDEX_TYPE) numBlocks++;
+    }
+    m_compIndex[numBlockRows] = (CPUSPARSE_INDEX_TYPE) numBlocks;
+
+    m_unCompIndex = new CPUSPARSE_INDEX_TYPE[numBlocks];
+    for (size_t ib = 0; ib < numBlockRows; ib++)
+        for (size_t jb = 0; jb < numBlockCols; jb++)
+            if (blockPos[ib * numBlockCols + jb] != empty)
+                m_unCompIndex[blockPos[ib * numBlockCols + jb]] = (CPUSPARSE_INDEX_TYPE) jb;
+
+    // pass 2: scatter the non-zero values into their blocks (column-major within a block)
+    m_pArray = new ElemType[numBlocks * blockDim * blockDim]();
+    for (size_t j = 0; j < csc.GetNumCols(); j++)
+        for (size_t p = csc.m_compIndex[j]; p < (size_t) csc.m_compIndex[j + 1]; p++)
+        {
+            size_t i = csc.m_unCompIndex[p];
+            size_t pos = blockPos[(i / blockDim) * numBlockCols + j / blockDim];
+            m_pArray[pos * blockDim * blockDim + (j % blockDim) * blockDim + i % blockDim] = csc.m_pArray[p];
+        }
+
+    m_numRows = csc.GetNumRows();
+    m_numCols = csc.GetNumCols();
+    m_blockDim = blockDim;
+    m_blockSize = numBlocks;                 // number of stored blocks
+    m_nz = numBlocks * blockDim * blockDim;  // stored values, including the explicit zeros inside partially filled blocks
+    m_elemSizeAllocated = m_nz;
+    m_compIndexSize = numBlockRows + 1;
+    m_nzValues = m_pArray;
+}
+
 template <class ElemType>
 ElemType* CPUSparseMatrix<ElemType>::BufferPointer() const
 {
@@ -660,48 +736,268 @@ void CPUSparseMatrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const CPU
         }
     }
 
-    if (rhs.GetFormat() != matrixFormatSparseCSC)
-        NOT_IMPLEMENTED;
+    if (rhs.GetFormat() == matrixFormatSparseCSC)
+    {
+        if (!transposeA && !transposeB)
+        {
+            for (size_t j = 0; j < rhs.GetNumCols(); j++)
+            {
+                size_t start = rhs.m_compIndex[j]; // ColLocation
+                size_t end = rhs.m_compIndex[j + 1];
+                for (size_t p = start; p < end; p++)
+                {
+                    size_t i = rhs.m_unCompIndex[p]; // RowLocation
+                    ElemType val = rhs.m_pArray[p];
 
-    if (!transposeA && !transposeB)
+                    for (size_t h = 0; h < lhs.GetNumRows(); h++)
+                    {
+                        c(h, j) += alpha * lhs(h, i) * val;
+                    }
+                }
+            }
+        }
+        else if (!transposeA && transposeB)
+        {
+            for (size_t j = 0; j < rhs.GetNumCols(); j++)
+            {
+                size_t start = rhs.m_compIndex[j];
+                size_t end = rhs.m_compIndex[j + 1];
+
+                for (size_t p = start; p < end; p++)
+                {
+                    size_t i = rhs.m_unCompIndex[p];
+                    ElemType val = rhs.m_pArray[p];
+                    for (size_t h = 0; h < lhs.GetNumRows(); h++)
+                    {
+                        c(h, i) += alpha * lhs(h, j) * val;
+                    }
+                }
+            }
+        }
+        else if (transposeA && !transposeB)
+        {
+            for (size_t j = 0; j < rhs.GetNumCols(); j++)
+            {
+                size_t start = rhs.m_compIndex[j];
+                size_t end = rhs.m_compIndex[j + 1];
+                for (size_t p = start; p < end; p++)
+                {
+                    size_t i = rhs.m_unCompIndex[p];
+                    ElemType val = rhs.m_pArray[p];
+
+                    for (size_t h = 0; h < lhs.GetNumCols(); h++)
+                    {
+                        c(h, j) += alpha * lhs(i, h) * val;
+                    }
+                }
+            }
+        }
+        else // transposeA && transposeB
+        {
+            for (size_t j = 0; j < rhs.GetNumCols(); j++)
+            {
+                size_t start = rhs.m_compIndex[j];
+                size_t end = rhs.m_compIndex[j + 1];
+                for (size_t p = start; p < end; p++)
+                {
+                    size_t i = rhs.m_unCompIndex[p];
+                    ElemType val = rhs.m_pArray[p];
+
+                    for (size_t h = 0; h < lhs.GetNumCols(); h++)
+                    {
+                        c(h, i) += alpha * lhs(j, h) * val;
+                    }
+                }
+            }
+        }
+    }
+    else if (rhs.GetFormat() == matrixFormatSparseBlockCol)
     {
-        for (size_t j = 0; j < rhs.GetNumCols(); j++)
+        // block-column: each block is one dense non-zero column of rhs
+        for (size_t jb = 0; jb < rhs.m_blockSize; jb++)
         {
-            size_t start = rhs.m_compIndex[j]; // ColLocation
-            size_t end = rhs.m_compIndex[j + 1];
-            for (size_t p = start; p < end; p++)
+            size_t j = rhs.m_blockIds[jb] - rhs.m_blockIdShift;
+            size_t start = jb * rhs.GetNumRows();
+            for (size_t i = 0; i < rhs.GetNumRows(); i++)
             {
-                size_t i = rhs.m_unCompIndex[p]; // RowLocation
-                ElemType val = rhs.m_pArray[p];
+                ElemType val = rhs.m_pArray[start + i];
+                if (val == 0)
+                    continue;
 
-                for (size_t h = 0; h < lhs.GetNumRows(); h++)
+                if (!transposeA && !transposeB)
+                {
+                    for (size_t h = 0; h < lhs.GetNumRows(); h++)
+                        c(h, j) += alpha * lhs(h, i) * val;
+                }
+                else if (!transposeA && transposeB)
+                {
+                    for (size_t h = 0; h < lhs.GetNumRows(); h++)
+                        c(h, i) += alpha * lhs(h, j) * val;
+                }
+                else if (transposeA && !transposeB)
+                {
+                    for (size_t h = 0; h < lhs.GetNumCols(); h++)
+                        c(h, j) += alpha * lhs(i, h) * val;
+                }
+                else // transposeA && transposeB
                 {
-                    c(h, j) += alpha * lhs(h, i) * val;
+                    for (size_t h = 0; h < lhs.GetNumCols(); h++)
+                        c(h, i) += alpha * lhs(j, h) * val;
                 }
             }
         }
     }
-    else if (!transposeA && transposeB)
+    else
     {
-        for (size_t j = 0; j < rhs.GetNumCols(); j++)
+        NOT_IMPLEMENTED;
+    }
+}
+
+//c = alpha*op(lhs) * op(rhs) + beta*c, with the sparse matrix on the left
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const CPUSparseMatrix<ElemType>& lhs, const bool transposeA,
+                                                       const CPUMatrix<ElemType>& rhs, const bool transposeB, ElemType beta, CPUMatrix<ElemType>& c)
+{
+    if (lhs.IsEmpty() || rhs.IsEmpty())
+        LogicError("MultiplyAndWeightedAdd:  one of the input matrix is empty.");
+
+    int m = transposeA ? (int) lhs.GetNumCols() : (int) lhs.GetNumRows();
+    int k = transposeA ? (int) lhs.GetNumRows() : (int) lhs.GetNumCols();
+    int l = transposeB ? (int) rhs.GetNumCols() : (int) rhs.GetNumRows();
+    int n = transposeB ? (int) rhs.GetNumRows() : (int) rhs.GetNumCols();
+
+    assert(m > 0 && k > 0 && l > 0 && n > 0); // converting from size_t to int may cause overflow
+    assert(k == l);
+    if (k != l)
+    {
+        InvalidArgument("CPUSparseMatrix::MultiplyAndWeightedAdd: The inner dimensions of a and b must match.");
+    }
+
+    if (beta == 0)
+        c.Resize(m, n);
+    else
+        c.VerifySize(m, n); // Can't resize if beta != 0
+
+    if (beta == 0)
+    {
+        memset(c.GetArray(), 0, sizeof(ElemType) * c.GetNumElements());
+    }
+    else if (beta != 1)
+    {
+#pragma omp parallel for
+        foreach_coord (i, j, c)
         {
-            size_t start = rhs.m_compIndex[j];
-            size_t end = rhs.m_compIndex[j + 1];
+            c(i, j) = beta * c(i, j);
+        }
+    }
 
+    if (lhs.GetFormat() == matrixFormatSparseCSC)
+    {
+        for (size_t q = 0; q < lhs.GetNumCols(); q++)
+        {
+            size_t start = lhs.m_compIndex[q]; // ColLocation
+            size_t end = lhs.m_compIndex[q + 1];
             for (size_t p = start; p < end; p++)
             {
-                size_t i = rhs.m_unCompIndex[p];
-                ElemType val = rhs.m_pArray[p];
-                for (size_t h = 0; h < lhs.GetNumRows(); h++)
+                size_t r = lhs.m_unCompIndex[p]; // RowLocation
+                ElemType val = lhs.m_pArray[p];
+
+                if (!transposeA && !transposeB)
+                {
+                    for (size_t j = 0; j < (size_t) n; j++)
+                        c(r, j) += alpha * val * rhs(q, j);
+                }
+                else if (!transposeA && transposeB)
+                {
+                    for (size_t j = 0; j < (size_t) n; j++)
+                        c(r, j) += alpha * val * rhs(j, q);
+                }
+                else if (transposeA && !transposeB)
                 {
-                    c(h, i) += alpha * lhs(h, j) * val;
+                    for (size_t j = 0; j < (size_t) n; j++)
+                        c(q, j) += alpha * val * rhs(r, j);
+                }
+                else // transposeA && transposeB
+                {
+                    for (size_t j = 0; j < (size_t) n; j++)
+                        c(q, j) += alpha * val * rhs(j, r);
                 }
             }
         }
     }
-    else if (transposeA && !transposeB)
+    else if (lhs.GetFormat() == matrixFormatSparseBlockCol)
     {
-        NOT_IMPLEMENTED;
+        // block-column: each block is one dense non-zero column of lhs
+        for (size_t jb = 0; jb < lhs.m_blockSize; jb++)
+        {
+            size_t q = lhs.m_blockIds[jb] - lhs.m_blockIdShift;
+            size_t start = jb * lhs.GetNumRows();
+            for (size_t r = 0; r < lhs.GetNumRows(); r++)
+            {
+                ElemType val = lhs.m_pArray[start + r];
+                if (val == 0)
+                    continue;
+
+                if (!transposeA && !transposeB)
+                {
+                    for (size_t j = 0; j < (size_t) n; j++)
+                        c(r, j) += alpha * val * rhs(q, j);
+                }
+                else if (!transposeA && transposeB)
+                {
+                    for (size_t j = 0; j < (size_t) n; j++)
+                        c(r, j) += alpha * val * rhs(j, q);
+                }
+                else if (transposeA && !transposeB)
+                {
+                    for (size_t j = 0; j < (size_t) n; j++)
+                        c(q, j) += alpha * val * rhs(r, j);
+                }
+                else // transposeA && transposeB
+                {
+                    for (size_t j = 0; j < (size_t) n; j++)
+                        c(q, j) += alpha * val * rhs(j, r);
+                }
+            }
+        }
+    }
+    else if (lhs.GetFormat() == matrixFormatSparseBSR)
+    {
+        // block-compressed sparse row: dense blockDim x blockDim blocks addressed CSR-style by block
+        // row (see SetBlockSparseRowFromCSC()). This is the pruned-weight inference path, which only
+        // needs W * X; the training-side gradient products keep their CSC/block-column formats.
+        if (transposeA)
+            NOT_IMPLEMENTED;
+
+        const size_t blockDim = lhs.m_blockDim;
+        const long numBlockRows = (long) ((lhs.GetNumRows() + blockDim - 1) / blockDim);
+#pragma omp parallel for
+        for (long ib = 0; ib < numBlockRows; ib++) // block rows write disjoint rows of c, so they parallelize cleanly
+        {
+            const size_t r0 = ib * blockDim;
+            const size_t rn = min(blockDim, lhs.GetNumRows() - r0); // bottom-edge blocks may be partial
+            for (size_t j = 0; j < (size_t) n; j++)
+            {
+                // one running sum per row of the block row; with the small fixed bound the compiler
+                // keeps these in registers and vectorizes the inner loops
+                ElemType acc[8] = {0}; // 8 = largest blockDim admitted by SetBlockSparseRowFromCSC()
+                for (size_t p = lhs.m_compIndex[ib]; p < (size_t) lhs.m_compIndex[ib + 1]; p++)
+                {
+                    const ElemType* block = lhs.m_pArray + p * blockDim * blockDim;
+                    const size_t q0 = (size_t) lhs.m_unCompIndex[p] * blockDim;
+                    const size_t qn = min(blockDim, (size_t) k - q0); // right-edge blocks may be partial
+                    for (size_t q = 0; q < qn; q++)
+                    {
+                        ElemType x = transposeB ? rhs(j, q0 + q) : rhs(q0 + q, j);
+                        const ElemType* blockCol = block + q * blockDim; // column-major within the block
+                        for (size_t r = 0; r < blockDim; r++)
+                            acc[r] += blockCol[r] * x;
+                    }
+                }
+                for (size_t r = 0; r < rn; r++)
+                    c(r0 + r, j) += alpha * acc[r];
+            }
+        }
     }
     else
     {
@@ -738,7 +1034,42 @@ void CPUSparseMatrix<ElemType>::MultiplyAndAdd(ElemType alpha, const CPUMatrix<E
 
     if (!transposeA && !transposeB)
     {
-        NOT_IMPLEMENTED;
+        if (rhs.GetFormat() != matrixFormatSparseCSC)
+            NOT_IMPLEMENTED;
+
+        // allocate enough memory; every non-empty column of rhs produces one output block
+        c.SetFormat(matrixFormatSparseBlockCol);
+        c.Resize(m, n, m * min(n, rhs.m_nz), true, false);
+
+        for (size_t j = 0; j < rhs.GetNumCols(); j++)
+        { // j ranges over output columns
+            size_t start = rhs.m_compIndex[j];
+            size_t end = rhs.m_compIndex[j + 1];
+            if (start == end)
+                continue;
+
+            c.m_blockIds[c.m_blockSize] = j;
+            size_t pos = c.m_blockSize * lhs.GetNumRows();
+            c.m_blockSize++;
+            for (size_t h = 0; h < lhs.GetNumRows(); h++)
+                c.m_pArray[pos + h] = 0;
+
+            for (size_t p = start; p < end; p++)
+            {
+                size_t i = rhs.m_unCompIndex[p];
+                ElemType val = rhs.m_pArray[p];
+                for (size_t h = 0; h < lhs.GetNumRows(); h++)
+                { // h ranges over hidden layer
+                    c.m_pArray[pos + h] += alpha * lhs(h, i) * val;
+                }
+            }
+        }
+        c.m_nz = c.m_blockSize * m;
+
+        if (c.m_nz > c.GetSizeAllocated())
+        {
+            LogicError("sparse matrix out of range.");
+        }
     }
     else if (!transposeA && transposeB)
     {
@@ -797,11 +1128,96 @@ void CPUSparseMatrix<ElemType>::MultiplyAndAdd(ElemType alpha, const CPUMatrix<E
     }
     else if (transposeA && !transposeB)
     {
-        NOT_IMPLEMENTED;
+        if (rhs.GetFormat() != matrixFormatSparseCSC)
+            NOT_IMPLEMENTED;
+
+        // same as the (!transposeA, !transposeB) case with lhs read transposed
+        c.SetFormat(matrixFormatSparseBlockCol);
+        c.Resize(m, n, m * min(n, rhs.m_nz), true, false);
+
+        for (size_t j = 0; j < rhs.GetNumCols(); j++)
+        { // j ranges over output columns
+            size_t start = rhs.m_compIndex[j];
+            size_t end = rhs.m_compIndex[j + 1];
+            if (start == end)
+                continue;
+
+            c.m_blockIds[c.m_blockSize] = j;
+            size_t pos = c.m_blockSize * lhs.GetNumCols();
+            c.m_blockSize++;
+            for (size_t h = 0; h < lhs.GetNumCols(); h++)
+                c.m_pArray[pos + h] = 0;
+
+            for (size_t p = start; p < end; p++)
+            {
+                size_t i = rhs.m_unCompIndex[p];
+                ElemType val = rhs.m_pArray[p];
+                for (size_t h = 0; h < lhs.GetNumCols(); h++)
+                {
+                    c.m_pArray[pos + h] += alpha * lhs(i, h) * val;
+                }
+            }
+        }
+        c.m_nz = c.m_blockSize * m;
+
+        if (c.m_nz > c.GetSizeAllocated())
+        {
+            LogicError("sparse matrix out of range.");
+        }
     }
-    else
+    else // transposeA && transposeB
     {
-        NOT_IMPLEMENTED;
+        if (rhs.GetFormat() != matrixFormatSparseCSC)
+            NOT_IMPLEMENTED;
+
+        // same as the (!transposeA, transposeB) case with lhs read transposed
+        c.SetFormat(matrixFormatSparseBlockCol);
+        c.Resize(m, n, m * min(n, rhs.m_nz), true, false);
+
+        map<size_t, size_t> w2Id;
+        for (size_t j = 0; j < rhs.GetNumCols(); j++)
+        { // j ranges over batches
+            size_t start = rhs.m_compIndex[j];
+            size_t end = rhs.m_compIndex[j + 1];
+
+            for (size_t p = start; p < end; p++)
+            {
+                size_t i = rhs.m_unCompIndex[p]; // i ranges over words
+                ElemType val = rhs.m_pArray[p];
+
+                bool first = true;
+                if (w2Id.find(i) == w2Id.end())
+                {
+                    size_t id = w2Id.size();
+                    w2Id[i] = id;
+                    c.m_blockIds[c.m_blockSize] = i;
+                    c.m_blockSize++;
+                }
+                else
+                {
+                    first = false;
+                }
+                size_t pos = w2Id[i] * lhs.GetNumCols();
+                for (size_t h = 0; h < lhs.GetNumCols(); h++)
+                { // h range over hidden layer
+                    if (first == true)
+                    {
+                        c.m_pArray[pos] = alpha * lhs(j, h) * val;
+                    }
+                    else
+                    {
+                        c.m_pArray[pos] += alpha * lhs(j, h) * val;
+                    }
+                    pos++;
+                }
+            }
+        }
+        c.m_nz = c.m_blockSize * m;
+
+        if (c.m_nz > c.GetSizeAllocated())
+        {
+            LogicError("sparse matrix out of range.");
+        }
     }
 }
 
@@ -1349,4 +1765,18 @@ template CPUSparseMatrix<char>::~CPUSparseMatrix();
 template CPUSparseMatrix<char> CPUSparseMatrix<char>::ColumnSlice(size_t startColumn, size_t numCols) const;
 template CPUMatrix<char> CPUSparseMatrix<char>::CopyColumnSliceToDense(size_t startColumn, size_t numCols) const;
 template CPUSparseMatrix<char>& CPUSparseMatrix<char>::operator=(const CPUSparseMatrix<char>& deepCopyFrom);
+
+// We use Matrix<short> as the backing store for quantized inference weights; same drill as Matrix<char>
+template CPUSparseMatrix<short>::CPUSparseMatrix(const MatrixFormat format, const size_t numRows, const size_t numCols, const size_t size);
+template CPUSparseMatrix<short>::CPUSparseMatrix(MatrixFormat);
+template CPUSparseMatrix<short>::CPUSparseMatrix(CPUSparseMatrix<short> const&);
+template CPUSparseMatrix<short>::CPUSparseMatrix(CPUSparseMatrix<short>&&);
+template CPUSparseMatrix<short>& CPUSparseMatrix<short>::operator=(CPUSparseMatrix<short>&& moveFrom);
+template void CPUSparseMatrix<short>::SetValue(size_t, size_t, short);
+template short* CPUSparseMatrix<short>::BufferPointer() const;
+template void CPUSparseMatrix<short>::Reset(void);
+template CPUSparseMatrix<short>::~CPUSparseMatrix();
+template CPUSparseMatrix<short> CPUSparseMatrix<short>::ColumnSlice(size_t startColumn, size_t numCols) const;
+template CPUMatrix<short> CPUSparseMatrix<short>::CopyColumnSliceToDense(size_t startColumn, size_t numCols) const;
+template CPUSparseMatrix<short>& CPUSparseMatrix<short>::operator=(const CPUSparseMatrix<short>& deepCopyFrom);
 } } }
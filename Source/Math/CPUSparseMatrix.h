@@ -87,9 +87,16 @@ public:
     void SetMatrixFromCSCFormat(const CPUSPARSE_INDEX_TYPE* h_CSCCol, const CPUSPARSE_INDEX_TYPE* h_Row, const ElemType* h_Val,
                                 const size_t nz, const size_t numRows, const size_t numCols);
 
+    // convert a CSC matrix into this matrix in BSR form (see the implementation for the format description);
+    // for pruned weight matrices, do this once at model-load time
+    void SetBlockSparseRowFromCSC(const CPUSparseMatrix<ElemType>& csc, const size_t blockDim = 4);
+
     static void MultiplyAndWeightedAdd(ElemType alpha, const CPUMatrix<ElemType>& lhs, const bool transposeA,
                                        const CPUSparseMatrix<ElemType>& rhs, const bool transposeB, ElemType beta, CPUMatrix<ElemType>& c);
 
+    static void MultiplyAndWeightedAdd(ElemType alpha, const CPUSparseMatrix<ElemType>& lhs, const bool transposeA,
+                                       const CPUMatrix<ElemType>& rhs, const bool transposeB, ElemType beta, CPUMatrix<ElemType>& c);
+
     static void MultiplyAndAdd(ElemType alpha, const CPUMatrix<ElemType>& lhs, const bool transposeA,
                                const CPUSparseMatrix<ElemType>& rhs, const bool transposeB, CPUSparseMatrix<ElemType>& c);
 
@@ -144,6 +151,19 @@ public:
 
             return 0;
         }
+        else if (m_format == MatrixFormat::matrixFormatSparseBSR)
+        {
+            size_t ib = row / m_blockDim, jb = col / m_blockDim;
+            size_t start = m_compIndex[ib];
+            size_t end = m_compIndex[ib + 1];
+            for (size_t p = start; p < end; p++)
+            {
+                if ((size_t) m_unCompIndex[p] == jb)
+                    return m_pArray[p * m_blockDim * m_blockDim + (col % m_blockDim) * m_blockDim + row % m_blockDim];
+            }
+
+            return 0;
+        }
         else
         {
             NOT_IMPLEMENTED;
@@ -249,6 +269,8 @@ private:
     size_t m_blockSize;    // block size
     size_t* m_blockIds;    // block ids
     size_t m_blockIdShift; // used to get efficient slice, actual col = blockIds[j] - m_blockIdShift
+
+    size_t m_blockDim;     // BSR format: edge length of the square blocks (m_compIndex/m_unCompIndex are reused as block-row pointers/block-column ids)
 };
 
 typedef CPUSparseMatrix<float> CPUSingleSparseMatrix;
@@ -44,6 +44,26 @@ int CUDAPageLockedMemAllocator::GetDeviceId() const
 {
     return m_deviceID;
 }
+
+bool CUDAPageLockedMemAllocator::RegisterHostMemory(void* p, size_t size, int deviceId)
+{
+    cudaSetDevice(deviceId);
+
+    // Registration can fail for exotic mappings (or when the range is already registered);
+    // clear the sticky error so subsequent CUDA calls are not affected and let the caller fall back.
+    if (cudaHostRegister(p, size, cudaHostRegisterDefault) != cudaSuccess)
+    {
+        cudaGetLastError();
+        return false;
+    }
+    return true;
+}
+
+void CUDAPageLockedMemAllocator::UnregisterHostMemory(void* p, int deviceId)
+{
+    cudaSetDevice(deviceId);
+    cudaHostUnregister(p) || "UnregisterHostMemory in CUDAPageLockedMemAllocator failed";
+}
 #else
 // Dummy definitions when compiling for CPUONLY
 CUDAPageLockedMemAllocator::CUDAPageLockedMemAllocator(int)
@@ -63,5 +83,14 @@ void* CUDAPageLockedMemAllocator::Malloc(size_t)
 void CUDAPageLockedMemAllocator::Free(void*)
 {
 }
+
+bool CUDAPageLockedMemAllocator::RegisterHostMemory(void*, size_t, int)
+{
+    return false;
+}
+
+void CUDAPageLockedMemAllocator::UnregisterHostMemory(void*, int)
+{
+}
 #endif
 } } }
@@ -25,6 +25,11 @@ public:
     static void* Malloc(size_t size, int deviceId);
     static void Free(void* p, int deviceId);
 
+    // Pin existing host memory (e.g. a mapped file view) so device copies can DMA directly from it.
+    // Returns false if the range cannot be registered; callers fall back to pageable copies.
+    static bool RegisterHostMemory(void* p, size_t size, int deviceId);
+    static void UnregisterHostMemory(void* p, int deviceId);
+
 private:
     int m_deviceID;
 };
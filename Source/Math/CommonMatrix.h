@@ -25,6 +25,11 @@
 #define DEVICEID_AUTO (DEVICEID_TYPE) - 4             // device should be picked automatically
 #define AUTOPLACEMATRIX (DEVICEID_TYPE) 1000          // used in parameters only
 
+// alignment (in bytes) of every dense CPU matrix buffer the Math library allocates itself;
+// SIMD kernels may rely on this for aligned loads/stores of the buffer start. Note that views
+// (ColumnSlice()) and externally owned buffers (matrixFlagDontOwnBuffer) carry no such guarantee.
+#define CPU_MATRIX_BUFFER_ALIGNMENT 64
+
 #define EPS_IN_INVERSE 1e-30f    // 1e-37 is the only guaranteed precision
 #define EPS_IN_LOG 1e-37f        // 1e-37 is the only guaranteed precision
 #define LOG_OF_EPS_IN_LOG -85.1f // log(EPS_IN_LOG)
@@ -38,6 +43,27 @@
 
 MATH_API DEVICEID_TYPE EnforceOneGPUOnly(DEVICEID_TYPE requestedDeviceId);
 
+// determinism mode: trade some speed for bitwise-reproducible results across runs and
+// thread counts (fixed-order CPU reductions, no atomicAdd()-based accumulation in GPU
+// reductions, and random fills re-seeded from their seed argument on every call)
+MATH_API void SetDeterministicComputation(bool enable);
+MATH_API bool IsDeterministicComputation();
+
+// quantized inference mode: CPU inference products against constant weight matrices run in
+// 8-bit integer precision, with one scale per weight row and per-input column and a float
+// re-scale on the output (see CPUMatrix::MultiplyQuantized). Results are approximate and
+// gradients are not defined in this mode, so only evaluation front-ends may enable it.
+MATH_API void SetQuantizedInference(bool enable);
+MATH_API bool IsQuantizedInference();
+
+// prepacked weight mode: CPU inference products against constant weight matrices run through a
+// persistent copy of the weights in the BLAS' internal blocked GEMM layout (MKL only, see
+// CPUMatrix::PackForMultiply), removing the repacking the BLAS otherwise performs on every call
+// with the same matrix. Costs one extra copy of each packed weight matrix, and the copy does not
+// follow later updates of its source, so only evaluation front-ends may enable it.
+MATH_API void SetPrepackedWeights(bool enable);
+MATH_API bool UsePrepackedWeights();
+
 namespace Microsoft { namespace MSR { namespace CNTK {
 
 class MATH_API TracingGPUMemoryAllocator
@@ -58,6 +84,9 @@ public:
     template <typename AllocatedElemType>
     static void Free(int deviceId, AllocatedElemType* bufferPtr, bool ignoreCUDARetCode = false);
 
+    // report watermark and reuse counters of the stream-ordered device buffer pool (no-op without a GPU)
+    static void PrintPoolStatistics();
+
 private:
     template <typename AllocatedElemType>
     static AllocatedElemType* AllocateNoTrace(int deviceId, size_t numElements);
@@ -113,11 +142,16 @@ enum ElementWiseOperator
     opElementwiseProductWithLinearRectifierDerivativeFromOutput,
     opElementwiseProductWithLogDerivativeFromOutput,
     opElementwiseProductWithCosDerivative,
+    // fused binary+unary chains (produced by TensorView's deferred-op folding)
+    opSigmoidOfSum,
+    opTanhOfSum,
+    opLinearRectifierOfSum,
     // binary ops for indexing
     // opIndex,
     // ternary
     opCond /*a ? b : c*/,
-    opClip /*clip a within interval b..c*/
+    opClip /*clip a within interval b..c*/,
+    opMultiplyAndAdd /*a .* b + c; composite op of the elementwise fusion pass*/
     // Note: not all that's implemented in CNTK ComputationNodes has an opcode yet.
 };
 
@@ -160,12 +194,16 @@ enum ElementWiseOperator
     Macro(ElementwiseProductWithTanhDerivativeFromOutput);            \
     Macro(ElementwiseProductWithLinearRectifierDerivativeFromOutput); \
     Macro(ElementwiseProductWithLogDerivativeFromOutput);             \
-    Macro(ElementwiseProductWithCosDerivative); \
+    Macro(ElementwiseProductWithCosDerivative);                       \
+    Macro(SigmoidOfSum);                                              \
+    Macro(TanhOfSum);                                                 \
+    Macro(LinearRectifierOfSum); \
 //Macro(Index);
 
 #define ForAllTernaryOps(Macro) \
     Macro(Cond);                \
-    Macro(Clip);
+    Macro(Clip);                \
+    Macro(MultiplyAndAdd);
 
 // -----------------------------------------------------------------------
 // various enums to describe
@@ -195,6 +233,7 @@ enum MatrixFormat
     matrixFormatMask = matrixFormatRowMajor + matrixFormatSparse + matrixFormatCompressed, // mask that covers all the
     matrixFormatSparseBlockCol,                                                            // col block based sparse matrix
     matrixFormatSparseBlockRow,                                                            // row block based sparse matrix
+    matrixFormatSparseBSR,                                                                 // block-compressed sparse row (square register blocks); read-only CPU inference format
 };
 
 // common matrix flags for use on all matrices
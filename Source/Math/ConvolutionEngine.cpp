@@ -6,6 +6,7 @@
 #include "stdafx.h"
 #include "ConvolutionEngine.h"
 #include "CuDnnConvolutionEngine.h"
+#include "TimerUtility.h"
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -21,7 +22,9 @@ public:
 
 public:
     DefaultConvolutionEngine(DEVICEID_TYPE deviceId, size_t maxTempMemSizeInSamples)
-        : m_ones(deviceId), m_maxTempMemSizeInSamples(maxTempMemSizeInSamples)
+        : m_ones(deviceId), m_maxTempMemSizeInSamples(maxTempMemSizeInSamples),
+          m_tunedBatchSize(0), m_tuneNext(0), m_tuneBestTime(-1.0), m_bestSubBatchSize(0), m_fwdUsedSingleSubBatch(false),
+          m_im2colHasPadding(false)
     {
     }
 
@@ -65,6 +68,19 @@ public:
             out.Reshape(outT.c(), outputSizePerChannel * batchSize);
 
         size_t subBatchSize = min(batchSize, maxTempMemSizeInSamples);
+        // The sub-batch size trades workspace size against GEMM efficiency, and the best value
+        // depends on the actual layer shape. Time a few candidates within the memory cap on the
+        // first minibatches and stick with the winner. Only the dense im2col+GEMM path is tuned;
+        // the sparse paths have no choice to make.
+        bool tuning = false;
+        Timer tuneTimer;
+        if (!m_gpuSparseOpt && in.GetMatrixType() == MatrixType::DENSE)
+            subBatchSize = SelectSubBatchSize(batchSize, subBatchSize, tuning);
+        if (tuning)
+        {
+            in.Get00Element(); // wait for pending async work so we only time our own loop
+            tuneTimer.Start();
+        }
         size_t numSubBatches = (batchSize + subBatchSize - 1) / subBatchSize;
 
         for (size_t i = 0; i < numSubBatches; i++)
@@ -96,11 +112,12 @@ public:
             else
             {
                 inputSubBatch.SwitchToMatrixType(MatrixType::DENSE, MatrixFormat::matrixFormatDense, true);
-                workspace.AssignPackedConvolutionInput(inputSubBatch,
-                                                       inT.w(), inT.h(), inT.c(),
-                                                       outT.w(), outT.h(), outT.c(),
-                                                       filterT.w(), filterT.h(), convDesc.wStride(), convDesc.hStride(),
-                                                       convDesc.padding());
+                if (!TryUnrollInputOnCPU(inputSubBatch, workspace, inT, outT.w(), outT.h(), filterT, convDesc))
+                    workspace.AssignPackedConvolutionInput(inputSubBatch,
+                                                           inT.w(), inT.h(), inT.c(),
+                                                           outT.w(), outT.h(), outT.c(),
+                                                           filterT.w(), filterT.h(), convDesc.wStride(), convDesc.hStride(),
+                                                           convDesc.padding());
 
                 Mat outputSubBatch = out.ColumnSlice(outputSizePerChannel * startSampleId, outputSizePerChannel * smallBatchSize);
 
@@ -110,6 +127,16 @@ public:
             }
         }
 
+        if (tuning)
+        {
+            out.Get00Element(); // wait for the last GEMM before reading the clock
+            tuneTimer.Stop();
+            RecordTrialTime(subBatchSize, tuneTimer.ElapsedSeconds());
+        }
+        // BackwardFilter() may only reuse the packed input left in 'workspace' if it holds the
+        // entire batch, i.e. if this call ran as a single sub-batch.
+        m_fwdUsedSingleSubBatch = (numSubBatches == 1 && !m_gpuSparseOpt);
+
         out.Reshape(outT.c() * outputSizePerChannel, batchSize); // each sample becomes a column
 
         assert(outT.w() * outT.h() * outT.c() == out.GetNumRows());
@@ -199,7 +226,7 @@ public:
         size_t subBatchSize = min(batchSize, maxTempMemSizeInSamples);
         size_t numSubBatches = (batchSize + subBatchSize - 1) / subBatchSize;
 
-        if (numSubBatches == 1 && allowReuse && !m_gpuSparseOpt) // reuse packed input from evaluation step if it's not changed by either subbatch or recurrent steps.
+        if (numSubBatches == 1 && allowReuse && !m_gpuSparseOpt && m_fwdUsedSingleSubBatch) // reuse packed input from evaluation step if it's not changed by either subbatch or recurrent steps.
             // REVIEW alexeyk: the following makes an assumption that data in workspace was filled by Forward call and remained unchanged. Find way to enforce/verify that.
             Matrix<ElemType>::MultiplyAndAdd(srcGradTmp, false, workspace, true, filter);
         else
@@ -235,11 +262,12 @@ public:
                     workspace.Resize(packedInputRows, packedInputColsPerSample * smallBatchSize);
                     Matrix<ElemType> inputSubBatch = in.ColumnSlice(startSampleID, smallBatchSize);
                     inputSubBatch.SwitchToMatrixType(MatrixType::DENSE, inputSubBatch.GetFormat(), true);
-                    workspace.AssignPackedConvolutionInput(inputSubBatch,
-                                                           inT.w(), inT.h(), inT.c(),
-                                                           srcGradT.w(), srcGradT.h(), srcGradT.c(),
-                                                           filterT.w(), filterT.h(), convDesc.wStride(), convDesc.hStride(),
-                                                           convDesc.padding());
+                    if (!TryUnrollInputOnCPU(inputSubBatch, workspace, inT, srcGradT.w(), srcGradT.h(), filterT, convDesc))
+                        workspace.AssignPackedConvolutionInput(inputSubBatch,
+                                                               inT.w(), inT.h(), inT.c(),
+                                                               srcGradT.w(), srcGradT.h(), srcGradT.c(),
+                                                               filterT.w(), filterT.h(), convDesc.wStride(), convDesc.hStride(),
+                                                               convDesc.padding());
 
                     Matrix<ElemType>::MultiplyAndAdd(outputGradientSubBatch, false, workspace, true, filter);
                 }
@@ -283,37 +311,33 @@ public:
         Mat::MultiplyAndAdd(sg.Reshaped(biasT.c(), ccol), false, m_ones, false, biasGrad);
     }
 
+    // Batch normalization through the fused Matrix primitives: minibatch statistics, running
+    // statistics update, and normalize+scale+shift all happen in one pass over the data (one
+    // kernel on GPU, one OpenMP pass on CPU), instead of a chain of per-step matrix operations.
+    // The spatial case (one statistic per channel) needs no special handling here: this engine's
+    // layout keeps channels fastest-varying, so the per-channel statistics index is just
+    // row % channels, which the Matrix primitives derive from the scale vector's dimension.
     void NormalizeBatch(const Tensor4D& inT, const Mat& in, const Tensor4D& scaleBiasT, const Mat& scale, const Mat& bias,
                         bool spatial, double expAvgFactor, Mat& runMean, Mat& runInvStdDev, Mat& out, Mat& saveMean, Mat& saveInvStdDev) override
     {
         UNUSED(inT);
-        UNUSED(in);
+        assert(scale.GetNumRows() == (spatial ? scaleBiasT.c() : in.GetNumRows()));
+        assert(scale.GetNumCols() == 1);
         UNUSED(scaleBiasT);
-        UNUSED(scale);
-        UNUSED(bias);
-        UNUSED(out);
         UNUSED(spatial);
-        UNUSED(expAvgFactor);
-        UNUSED(runMean);
-        UNUSED(runInvStdDev);
-        UNUSED(saveMean);
-        UNUSED(saveInvStdDev);
-        RuntimeError("Not yet implemented.");
+        const double epsilon = 1e-5; // variance floor, matching the value the cuDNN engine effectively uses
+        in.BatchNormalizationForward(scale, bias, expAvgFactor, epsilon, runMean, runInvStdDev, out, saveMean, saveInvStdDev);
     }
 
     void NormalizeBatchInference(const Tensor4D& inT, const Mat& in, const Tensor4D& scaleBiasT, const Mat& scale, const Mat& bias,
                                  bool spatial, const Mat& runMean, const Mat& runInvStdDev, Mat& out) override
     {
         UNUSED(inT);
-        UNUSED(in);
+        assert(scale.GetNumRows() == (spatial ? scaleBiasT.c() : in.GetNumRows()));
+        assert(scale.GetNumCols() == 1);
         UNUSED(scaleBiasT);
-        UNUSED(scale);
-        UNUSED(bias);
-        UNUSED(out);
         UNUSED(spatial);
-        UNUSED(runMean);
-        UNUSED(runInvStdDev);
-        RuntimeError("Not yet implemented.");
+        in.BatchNormalizationForwardInference(scale, bias, runMean, runInvStdDev, out);
     }
 
     void BackwardNormalizeBatch(const Tensor4D& inT, const Mat& in, const Mat& srcGrad, Mat& grad,
@@ -321,17 +345,129 @@ public:
                                 Mat& scaleGrad, Mat& biasGrad) override
     {
         UNUSED(inT);
-        UNUSED(in);
-        UNUSED(srcGrad);
-        UNUSED(grad);
+        assert(scale.GetNumRows() == (spatial ? scaleBiasT.c() : in.GetNumRows()));
+        assert(scale.GetNumCols() == 1);
         UNUSED(scaleBiasT);
-        UNUSED(scale);
-        UNUSED(scaleGrad);
-        UNUSED(biasGrad);
         UNUSED(spatial);
-        UNUSED(saveMean);
-        UNUSED(saveInvStdDev);
-        RuntimeError("Not yet implemented.");
+        srcGrad.BatchNormalizationBackward(in, grad, scale, saveMean, saveInvStdDev, scaleGrad, biasGrad);
+    }
+
+private:
+    // TryUnrollInputOnCPU - offset-table im2col for the dense CPU path.
+    // AssignPackedConvolutionInput() re-derives the kernel positions every input element overlaps
+    // from scratch for every element of every minibatch, which is all integer division and
+    // branching. Since the mapping only depends on the layer geometry, we compute it once: for
+    // every output pixel, a table of source element indices (one per packed row, -1 for padding),
+    // laid out exactly like a packed column. The unroll itself then degenerates to a table-driven
+    // gather per packed column, parallelized over columns; destination and table are both walked
+    // sequentially (consecutive columns of one sample share table entries while they are still in
+    // cache), only the source access pattern is the layer's own overlap. Returns false when input
+    // or workspace is not CPU-dense, in which case the caller falls back to the generic method.
+    bool TryUnrollInputOnCPU(const Mat& inputSubBatch, Mat& workspace, const Tensor4D& inT, size_t outputWidth, size_t outputHeight,
+                             const Filter& filterT, const ConvDesc& convDesc)
+    {
+        if (inputSubBatch.GetDeviceId() != CPUDEVICE || workspace.GetDeviceId() != CPUDEVICE ||
+            inputSubBatch.GetMatrixType() != MatrixType::DENSE)
+            return false;
+
+        const size_t packedRows = filterT.w() * filterT.h() * inT.c();
+        const size_t packedColsPerSample = outputWidth * outputHeight;
+        const size_t inputDim = inT.w() * inT.h() * inT.c();
+        const size_t smallBatchSize = inputSubBatch.GetNumCols();
+
+        // (re)build the offset table if the geometry changed
+        std::vector<size_t> geometry = {inT.w(), inT.h(), inT.c(), outputWidth, outputHeight,
+                                        filterT.w(), filterT.h(), convDesc.wStride(), convDesc.hStride(), (size_t) convDesc.padding()};
+        if (geometry != m_im2colGeometry)
+        {
+            const long halfKernelWidth = (long) filterT.w() / 2;
+            const long halfKernelHeight = (long) filterT.h() / 2;
+            m_im2colOffsets.resize(packedRows * packedColsPerSample);
+            m_im2colHasPadding = false;
+            for (size_t wcol = 0; wcol < outputWidth; wcol++)
+                for (size_t wrow = 0; wrow < outputHeight; wrow++)
+                {
+                    int* column = m_im2colOffsets.data() + (wcol * outputHeight + wrow) * packedRows; // PACK_ELEM_COLPOS order
+                    for (size_t c = 0; c < inT.c(); c++)
+                        for (size_t posy = 0; posy < filterT.w(); posy++)
+                            for (size_t posx = 0; posx < filterT.h(); posx++)
+                            {
+                                // inverse of the mapping in AssignPackedConvolutionInput()
+                                long x = (long) (wrow * convDesc.hStride() + posx) - (convDesc.padding() ? halfKernelHeight : 0); // inputRow
+                                long y = (long) (wcol * convDesc.wStride() + posy) - (convDesc.padding() ? halfKernelWidth : 0);  // inputCol
+                                long packRow = (long) (c * filterT.w() * filterT.h() + posy * filterT.h() + posx);
+                                if (x >= 0 && x < (long) inT.h() && y >= 0 && y < (long) inT.w())
+                                    column[packRow] = (int) (c + (x + y * inT.h()) * inT.c()); // IN_ELEM_ROWPOS
+                                else
+                                {
+                                    column[packRow] = -1;
+                                    m_im2colHasPadding = true;
+                                }
+                            }
+                }
+            m_im2colGeometry = std::move(geometry);
+        }
+
+        workspace.SwitchToMatrixType(MatrixType::DENSE, MatrixFormat::matrixFormatDense, false);
+        workspace.Resize(packedRows, packedColsPerSample * smallBatchSize);
+        const ElemType* pin = inputSubBatch.BufferPointer();
+        ElemType* pout = workspace.BufferPointer();
+        const int* offsets = m_im2colOffsets.data();
+
+        const long numPackedCols = (long) (packedColsPerSample * smallBatchSize);
+#pragma omp parallel for // columns are independent; writes are contiguous per column
+        for (long col = 0; col < numPackedCols; col++)
+        {
+            const ElemType* src = pin + (col / (long) packedColsPerSample) * inputDim;
+            const int* ofs = offsets + (col % (long) packedColsPerSample) * packedRows;
+            ElemType* dst = pout + col * packedRows;
+            if (m_im2colHasPadding) // padding entries become 0 via a select, no branch in the loop body
+                for (long r = 0; r < (long) packedRows; r++)
+                    dst[r] = (ofs[r] >= 0) ? src[ofs[r]] : (ElemType) 0;
+            else
+                for (long r = 0; r < (long) packedRows; r++)
+                    dst[r] = src[ofs[r]];
+        }
+        return true;
+    }
+
+    // SelectSubBatchSize - auto-tuner for the sub-batch size of the dense im2col+GEMM path.
+    // The first few Forward() calls for a given batch size each run with a different candidate
+    // (powers-of-two fractions of the memory cap, largest first) and are timed; once all
+    // candidates have been tried, the fastest one is used from then on. The trials perform the
+    // regular computation, so tuning costs nothing beyond the synchronization for timing.
+    // batchSize       - number of samples in this minibatch
+    // maxSubBatchSize - largest sub-batch size the memory cap allows
+    // tuning          - [out] true if the returned size is a trial that should be timed
+    size_t SelectSubBatchSize(size_t batchSize, size_t maxSubBatchSize, bool& tuning)
+    {
+        if (batchSize != m_tunedBatchSize)
+        {
+            // (re)start tuning for this batch size
+            m_tunedBatchSize = batchSize;
+            m_tuneCandidates.clear();
+            for (size_t cand = maxSubBatchSize; cand > 0 && m_tuneCandidates.size() < 4; cand /= 2)
+                m_tuneCandidates.push_back(cand);
+            m_tuneNext = 0;
+            m_tuneBestTime = -1.0;
+            m_bestSubBatchSize = maxSubBatchSize;
+        }
+        if (m_tuneNext < m_tuneCandidates.size() && m_tuneCandidates.size() > 1)
+        {
+            tuning = true;
+            return m_tuneCandidates[m_tuneNext];
+        }
+        return m_bestSubBatchSize;
+    }
+
+    void RecordTrialTime(size_t subBatchSize, double seconds)
+    {
+        if (m_tuneBestTime < 0 || seconds < m_tuneBestTime)
+        {
+            m_tuneBestTime = seconds;
+            m_bestSubBatchSize = subBatchSize;
+        }
+        m_tuneNext++;
     }
 
 private:
@@ -339,6 +475,21 @@ private:
     Mat m_ones;
     bool m_gpuSparseOpt;
     bool m_gpuSparse1D;
+
+    // auto-tuner state for the im2col+GEMM sub-batch size (see SelectSubBatchSize)
+    size_t m_tunedBatchSize;
+    std::vector<size_t> m_tuneCandidates;
+    size_t m_tuneNext;
+    double m_tuneBestTime;
+    size_t m_bestSubBatchSize;
+    // whether the last Forward() packed the whole batch into the workspace in one go,
+    // which is what allows BackwardFilter() to reuse it
+    bool m_fwdUsedSingleSubBatch;
+
+    // per-output-pixel source offset table of the CPU im2col fast path (see TryUnrollInputOnCPU)
+    std::vector<int> m_im2colOffsets;
+    std::vector<size_t> m_im2colGeometry; // geometry the table was built for
+    bool m_im2colHasPadding;              // true if the table contains padding entries (-1)
 };
 
 template class ConvolutionEngine<float>;
@@ -8,6 +8,8 @@
 #include "GPUMatrix.h"
 #ifdef USE_CUDNN
 #include <cudnn.h>
+#include <map>
+#include <mutex>
 
 template <>
 const char* CudaErrString<cudnnStatus_t>(cudnnStatus_t x)
@@ -67,6 +69,9 @@ public:
 
     void setN(size_t newN) override
     {
+        // setN is called on every minibatch; skip the descriptor update when the batch size did not actually change.
+        if (newN == n())
+            return;
         ConvolutionTensor4D::setN(newN);
         CUDNN_CALL(cudnnSetTensor4dDescriptor(m_tensor, TENSOR_FORMAT, m_dataType,
                                               static_cast<int>(n()), static_cast<int>(c()), static_cast<int>(h()), static_cast<int>(w())));
@@ -223,6 +228,42 @@ const float Consts<float>::Zero = 0;
 template <>
 const double Consts<double>::Zero = 0;
 
+// Autotuned algorithm choices depend only on the tensor/filter/convolution geometry (and the workspace budget),
+// not on the engine instance, so networks with repeated layer shapes can share the auto-tuner results.
+// The cache is per-device: algorithm performance differs across GPU models.
+struct CuDnnAutotuneEntry
+{
+    CuDnnAutotuneEntry()
+    {
+        fwdAlgo.status = CUDNN_STATUS_NOT_INITIALIZED;
+        backDataAlgo.status = CUDNN_STATUS_NOT_INITIALIZED;
+        backFiltAlgo.status = CUDNN_STATUS_NOT_INITIALIZED;
+    }
+
+    cudnnConvolutionFwdAlgoPerf_t fwdAlgo;
+    cudnnConvolutionBwdDataAlgoPerf_t backDataAlgo;
+    cudnnConvolutionBwdFilterAlgoPerf_t backFiltAlgo;
+};
+
+static std::mutex s_autotuneCacheMutex;
+static std::map<DEVICEID_TYPE, std::map<std::string, CuDnnAutotuneEntry>> s_autotuneCache;
+
+// Builds the cache key from everything that can influence algorithm selection. Padding sizes are derived
+// from the filter dimensions (see CreateConvDescriptor) so the padding flag together with the filter
+// geometry fully determines the convolution descriptor.
+static std::string AutotuneKey(const CuDnnTensor4D& inT, const CuDnnFilter& filtT, const ConvolutionDescriptor& convDesc,
+                               const CuDnnTensor4D& outT, size_t elemSize, size_t maxTempMemSizeInSamples)
+{
+    char key[256];
+    sprintf(key, "%dx%dx%dx%d f%dx%dx%dx%d s%dx%d p%d o%dx%dx%dx%d e%d m%d",
+            (int) inT.w(), (int) inT.h(), (int) inT.c(), (int) inT.n(),
+            (int) filtT.w(), (int) filtT.h(), (int) filtT.c(), (int) filtT.k(),
+            (int) convDesc.wStride(), (int) convDesc.hStride(), convDesc.padding() ? 1 : 0,
+            (int) outT.w(), (int) outT.h(), (int) outT.c(), (int) outT.n(),
+            (int) elemSize, (int) maxTempMemSizeInSamples);
+    return key;
+}
+
 template <typename ElemType>
 class CuDnnConvolutionEngine : public ConvolutionEngine<ElemType>
 {
@@ -233,8 +274,8 @@ public:
     using typename Base::Filter;
     using typename Base::ConvDesc;
 
-    CuDnnConvolutionEngine(size_t maxTempMemSizeInSamples)
-        : m_maxTempMemSizeInSamples(maxTempMemSizeInSamples), m_cudnn(nullptr), m_curMBSize(0)
+    CuDnnConvolutionEngine(DEVICEID_TYPE deviceId, size_t maxTempMemSizeInSamples)
+        : m_deviceId(deviceId), m_maxTempMemSizeInSamples(maxTempMemSizeInSamples), m_cudnn(nullptr), m_curMBSize(0)
     {
         CUDNN_CALL(cudnnCreate(&m_cudnn));
         CUDNN_CALL(cudnnSetStream(m_cudnn, GetStream()));
@@ -447,68 +488,89 @@ private:
         // REVIEW alexeyk: is this a safe assumption? Can convolution configuration change in runtime?
         if (m_fwdAlgo.status == CUDNN_STATUS_SUCCESS && inT.n() == m_curMBSize && outT.n() == m_curMBSize)
             return;
-        const int MaxAlgoCount = 10;
-        int calgo = 0;
-        cudnnConvolutionFwdAlgoPerf_t algoPerf[MaxAlgoCount];
-        CUDNN_CALL(cudnnFindConvolutionForwardAlgorithm(m_cudnn, inT, filtT, convDesc, outT, MaxAlgoCount, &calgo, algoPerf));
-        assert(calgo > 0);
-        size_t maxMem = m_maxTempMemSizeInSamples == 0 ? (std::numeric_limits<size_t>::max)() : inT.w() * inT.h() * inT.c() * m_maxTempMemSizeInSamples * sizeof(ElemType);
-        auto res = std::find_if(algoPerf, algoPerf + calgo,
-                                [=](const cudnnConvolutionFwdAlgoPerf_t& cur)
-                                {
-                                    return cur.status == CUDNN_STATUS_SUCCESS && cur.memory <= maxMem;
-                                });
-        if (res == algoPerf + calgo)
-            RuntimeError("cuDNN could not find suitable algorithm for cudnnConvolutionForward.");
+        // Check whether another engine instance (e.g. a layer with identical geometry) already tuned this shape.
+        std::lock_guard<std::mutex> lock(s_autotuneCacheMutex);
+        CuDnnAutotuneEntry& entry = s_autotuneCache[m_deviceId][AutotuneKey(inT, filtT, convDesc, outT, sizeof(ElemType), m_maxTempMemSizeInSamples)];
+        if (entry.fwdAlgo.status != CUDNN_STATUS_SUCCESS)
+        {
+            const int MaxAlgoCount = 10;
+            int calgo = 0;
+            cudnnConvolutionFwdAlgoPerf_t algoPerf[MaxAlgoCount];
+            CUDNN_CALL(cudnnFindConvolutionForwardAlgorithm(m_cudnn, inT, filtT, convDesc, outT, MaxAlgoCount, &calgo, algoPerf));
+            assert(calgo > 0);
+            size_t maxMem = m_maxTempMemSizeInSamples == 0 ? (std::numeric_limits<size_t>::max)() : inT.w() * inT.h() * inT.c() * m_maxTempMemSizeInSamples * sizeof(ElemType);
+            auto res = std::find_if(algoPerf, algoPerf + calgo,
+                                    [=](const cudnnConvolutionFwdAlgoPerf_t& cur)
+                                    {
+                                        return cur.status == CUDNN_STATUS_SUCCESS && cur.memory <= maxMem;
+                                    });
+            if (res == algoPerf + calgo)
+                RuntimeError("cuDNN could not find suitable algorithm for cudnnConvolutionForward.");
+            entry.fwdAlgo = *res;
+        }
         m_curMBSize = inT.n();
-        m_fwdAlgo = *res;
+        m_fwdAlgo = entry.fwdAlgo;
     }
 
     void FindBestBackwardDataAlgo(const CuDnnFilter& filtT, const CuDnnTensor4D& srcGradT, const CuDnnConvolutionDescriptor& convDesc, const CuDnnTensor4D& gradT)
     {
         if (m_backDataAlgo.status == CUDNN_STATUS_SUCCESS && srcGradT.n() == m_curMBSize && gradT.n() == m_curMBSize)
             return;
-        const int MaxAlgoCount = 10;
-        int calgo = 0;
-        cudnnConvolutionBwdDataAlgoPerf_t algoPerf[MaxAlgoCount];
-        CUDNN_CALL(cudnnFindConvolutionBackwardDataAlgorithm(m_cudnn, filtT, srcGradT, convDesc, gradT, MaxAlgoCount, &calgo, algoPerf));
-        assert(calgo > 0);
-        size_t maxMem = m_maxTempMemSizeInSamples == 0 ? (std::numeric_limits<size_t>::max)() : gradT.w() * gradT.h() * gradT.c() * m_maxTempMemSizeInSamples * sizeof(ElemType);
-        auto res = std::find_if(algoPerf, algoPerf + calgo,
-                                [=](const cudnnConvolutionBwdDataAlgoPerf_t& cur)
-                                {
-                                    return cur.status == CUDNN_STATUS_SUCCESS && cur.memory <= maxMem;
-                                });
-        if (res == algoPerf + calgo)
-            RuntimeError("cuDNN could not find suitable algorithm for cudnnConvolutionBackwardData.");
+        std::lock_guard<std::mutex> lock(s_autotuneCacheMutex);
+        CuDnnAutotuneEntry& entry = s_autotuneCache[m_deviceId][AutotuneKey(gradT, filtT, convDesc, srcGradT, sizeof(ElemType), m_maxTempMemSizeInSamples)];
+        if (entry.backDataAlgo.status != CUDNN_STATUS_SUCCESS)
+        {
+            const int MaxAlgoCount = 10;
+            int calgo = 0;
+            cudnnConvolutionBwdDataAlgoPerf_t algoPerf[MaxAlgoCount];
+            CUDNN_CALL(cudnnFindConvolutionBackwardDataAlgorithm(m_cudnn, filtT, srcGradT, convDesc, gradT, MaxAlgoCount, &calgo, algoPerf));
+            assert(calgo > 0);
+            size_t maxMem = m_maxTempMemSizeInSamples == 0 ? (std::numeric_limits<size_t>::max)() : gradT.w() * gradT.h() * gradT.c() * m_maxTempMemSizeInSamples * sizeof(ElemType);
+            auto res = std::find_if(algoPerf, algoPerf + calgo,
+                                    [=](const cudnnConvolutionBwdDataAlgoPerf_t& cur)
+                                    {
+                                        return cur.status == CUDNN_STATUS_SUCCESS && cur.memory <= maxMem;
+                                    });
+            if (res == algoPerf + calgo)
+                RuntimeError("cuDNN could not find suitable algorithm for cudnnConvolutionBackwardData.");
+            entry.backDataAlgo = *res;
+        }
         m_curMBSize = srcGradT.n();
-        m_backDataAlgo = *res;
+        m_backDataAlgo = entry.backDataAlgo;
     }
 
     void FindBestBackwardFilterAlgo(const CuDnnTensor4D& inT, const CuDnnTensor4D& srcGradT, const CuDnnConvolutionDescriptor& convDesc, const CuDnnFilter& filtT)
     {
         if (m_backFiltAlgo.status == CUDNN_STATUS_SUCCESS && inT.n() == m_curMBSize && srcGradT.n() == m_curMBSize)
             return;
-        const int MaxAlgoCount = 10;
-        int calgo = 0;
-        cudnnConvolutionBwdFilterAlgoPerf_t algoPerf[MaxAlgoCount];
-        CUDNN_CALL(cudnnFindConvolutionBackwardFilterAlgorithm(m_cudnn, inT, srcGradT, convDesc, filtT, MaxAlgoCount, &calgo, algoPerf));
-        assert(calgo > 0);
-        size_t maxMem = m_maxTempMemSizeInSamples == 0 ? (std::numeric_limits<size_t>::max)() : inT.w() * inT.h() * inT.c() * m_maxTempMemSizeInSamples * sizeof(ElemType);
-        auto res = std::find_if(algoPerf, algoPerf + calgo,
-                                [=](const cudnnConvolutionBwdFilterAlgoPerf_t& cur)
-                                {
-                                    return cur.status == CUDNN_STATUS_SUCCESS && cur.memory <= maxMem;
-                                });
-        if (res == algoPerf + calgo)
-            RuntimeError("cuDNN could not find suitable algorithm for cudnnConvolutionBackwardFilter.");
+        std::lock_guard<std::mutex> lock(s_autotuneCacheMutex);
+        CuDnnAutotuneEntry& entry = s_autotuneCache[m_deviceId][AutotuneKey(inT, filtT, convDesc, srcGradT, sizeof(ElemType), m_maxTempMemSizeInSamples)];
+        if (entry.backFiltAlgo.status != CUDNN_STATUS_SUCCESS)
+        {
+            const int MaxAlgoCount = 10;
+            int calgo = 0;
+            cudnnConvolutionBwdFilterAlgoPerf_t algoPerf[MaxAlgoCount];
+            CUDNN_CALL(cudnnFindConvolutionBackwardFilterAlgorithm(m_cudnn, inT, srcGradT, convDesc, filtT, MaxAlgoCount, &calgo, algoPerf));
+            assert(calgo > 0);
+            size_t maxMem = m_maxTempMemSizeInSamples == 0 ? (std::numeric_limits<size_t>::max)() : inT.w() * inT.h() * inT.c() * m_maxTempMemSizeInSamples * sizeof(ElemType);
+            auto res = std::find_if(algoPerf, algoPerf + calgo,
+                                    [=](const cudnnConvolutionBwdFilterAlgoPerf_t& cur)
+                                    {
+                                        return cur.status == CUDNN_STATUS_SUCCESS && cur.memory <= maxMem;
+                                    });
+            if (res == algoPerf + calgo)
+                RuntimeError("cuDNN could not find suitable algorithm for cudnnConvolutionBackwardFilter.");
+            entry.backFiltAlgo = *res;
+        }
         m_curMBSize = inT.n();
-        m_backFiltAlgo = *res;
+        m_backFiltAlgo = entry.backFiltAlgo;
     }
 
 private:
     using C = Consts<ElemType>;
 
+    // Device this engine runs on, used to address the shared auto-tuner cache.
+    DEVICEID_TYPE m_deviceId;
     // REVIEW alexeyk: currently limit is set once in ctor though in CNTK it can be, theoretically, changed in runtime.
     size_t m_maxTempMemSizeInSamples;
     cudnnHandle_t m_cudnn;
@@ -629,9 +691,9 @@ typename CuDnnConvolutionEngineFactory<ElemType>::PoolDescPtr CuDnnConvolutionEn
 
 template <class ElemType>
 typename CuDnnConvolutionEngineFactory<ElemType>::ConvEnginePtr CuDnnConvolutionEngineFactory<ElemType>::CreateConvEngine(
-    DEVICEID_TYPE /*deviceId*/, size_t maxTempMemSizeInSamples)
+    DEVICEID_TYPE deviceId, size_t maxTempMemSizeInSamples)
 {
-    return std::make_unique<CuDnnConvolutionEngine<ElemType>>(maxTempMemSizeInSamples);
+    return std::make_unique<CuDnnConvolutionEngine<ElemType>>(deviceId, maxTempMemSizeInSamples);
 }
 
 template <class ElemType>
@@ -0,0 +1,61 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CudaEventTimer.h -- accumulate GPU compute time without forcing host syncs
+//
+#pragma once
+
+#ifdef _WIN32
+#ifdef MATH_EXPORTS
+#define MATH_API __declspec(dllexport)
+#else
+#define MATH_API __declspec(dllimport)
+#endif
+#else // no DLLs on Linux
+#define MATH_API
+#endif
+
+#include "CommonMatrix.h" // for DEVICEID_TYPE
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// -----------------------------------------------------------------------
+// CudaEventTimer -- measures time spent on the GPU compute stream
+//
+// Begin()/End() bracket a stretch of work by recording CUDA events on the
+// compute stream, so the measurement covers the asynchronously launched
+// kernels themselves, not just the host-side launch cost. The elapsed time
+// of a pair is harvested lazily on the next Begin() or when TotalSeconds()
+// is read; by then the events have normally long completed, so in steady
+// state no wait is incurred. On CPU devices all calls are no-ops (callers
+// measure wall-clock time there).
+// -----------------------------------------------------------------------
+class MATH_API CudaEventTimer
+{
+public:
+    CudaEventTimer()
+        : m_startEvent(nullptr), m_stopEvent(nullptr), m_deviceId(-1), m_pending(false), m_totalSeconds(0)
+    {
+    }
+    ~CudaEventTimer();
+
+    CudaEventTimer(const CudaEventTimer&) = delete;
+    CudaEventTimer& operator=(const CudaEventTimer&) = delete;
+
+    void Begin(DEVICEID_TYPE deviceId); // record start event (no-op for CPU devices)
+    void End();                         // record stop event
+    double TotalSeconds();              // accumulated seconds over all completed Begin/End pairs
+    void Reset();                       // forget accumulated time
+
+private:
+    void Harvest(); // fold a pending Begin/End pair into the total
+
+    void* m_startEvent; // cudaEvent_t; kept as void* so that CUDA types stay out of this header
+    void* m_stopEvent;
+    DEVICEID_TYPE m_deviceId;
+    bool m_pending;
+    double m_totalSeconds;
+};
+
+} } }
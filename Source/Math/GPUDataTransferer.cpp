@@ -2,6 +2,7 @@
 #include "Basics.h"
 #include "GPUDataTransferer.h"
 #include "GPUMatrix.h"
+#include "CUDAPageLockedMemAllocator.h"
 
 #pragma comment(lib, "cudart.lib")
 
@@ -136,7 +137,132 @@ void GPUDataTransferer<ElemType>::WaitForCopyCPUToGPUAsync()
     SyncEvent(m_assignCompleteEvent);
 }
 
+template <class ElemType>
+void GPUDataTransferer<ElemType>::CopyGPUToGPUAsync(ElemType* srcBuffer, int srcDeviceId, size_t numElements, ElemType* dstBuffer, int dstDeviceId)
+{
+    // enable direct peer access once per device pair if the hardware supports it; without it
+    // cudaMemcpyPeerAsync still works but stages through host memory
+    int canAccessPeer = false;
+    cudaDeviceCanAccessPeer(&canAccessPeer, dstDeviceId, srcDeviceId) || "cudaDeviceCanAccessPeer failed";
+    if (canAccessPeer)
+    {
+        PrepareDevice(dstDeviceId);
+        auto rc = cudaDeviceEnablePeerAccess(srcDeviceId, 0);
+        if (rc != cudaErrorPeerAccessAlreadyEnabled)
+            rc || "cudaDeviceEnablePeerAccess failed";
+    }
+
+    PrepareDevice(m_deviceId);
+    cudaMemcpyPeerAsync(dstBuffer, dstDeviceId, srcBuffer, srcDeviceId, numElements * sizeof(ElemType), m_fetchStream) || "cudaMemcpyPeerAsync failed";
+    cudaEventRecord(m_fetchCompleteEvent, m_fetchStream) || "cudaEventRecord failed";
+}
+
+template <class ElemType>
+void GPUDataTransferer<ElemType>::WaitForCopyGPUToGPUAsync()
+{
+    PrepareDevice(m_deviceId);
+
+    SyncEvent(m_fetchCompleteEvent);
+}
+
 //explicit
 template class GPUDataTransferer<float>;
 template class GPUDataTransferer<double>;
+
+template <class ElemType>
+PinnedMemoryRingBuffer<ElemType>::PinnedMemoryRingBuffer(int deviceId, size_t numSegments, size_t numElementsPerSegment)
+    : m_deviceId(deviceId), m_numSegments(numSegments), m_numElementsPerSegment(numElementsPerSegment), m_nextSegment(0)
+{
+    if (numSegments < 2)
+        InvalidArgument("PinnedMemoryRingBuffer: at least two segments are needed to overlap filling with uploading.");
+    if (numElementsPerSegment == 0)
+        InvalidArgument("PinnedMemoryRingBuffer: segment size must be non-zero.");
+
+    PrepareDevice(m_deviceId);
+    cudaStreamCreateWithFlags(&m_uploadStream, cudaStreamNonBlocking) || "cudaStreamCreateWithFlags failed";
+
+    m_segments.resize(numSegments);
+    m_uploadCompleteEvents.resize(numSegments);
+    for (size_t i = 0; i < numSegments; i++)
+    {
+        m_segments[i] = (ElemType*) CUDAPageLockedMemAllocator::Malloc(numElementsPerSegment * sizeof(ElemType), m_deviceId);
+        cudaEventCreateWithFlags(&m_uploadCompleteEvents[i], cudaEventDisableTiming) || "cudaEventCreateWithFlags failed";
+    }
+}
+
+template <class ElemType>
+PinnedMemoryRingBuffer<ElemType>::~PinnedMemoryRingBuffer()
+{
+    PrepareDevice(m_deviceId);
+    cudaStreamSynchronize(m_uploadStream); // drain in-flight uploads before freeing their source buffers
+    for (size_t i = 0; i < m_numSegments; i++)
+    {
+        cudaEventDestroy(m_uploadCompleteEvents[i]);
+        CUDAPageLockedMemAllocator::Free(m_segments[i], m_deviceId);
+    }
+    cudaStreamDestroy(m_uploadStream);
+}
+
+template <class ElemType>
+ElemType* PinnedMemoryRingBuffer<ElemType>::BeginWrite()
+{
+    PrepareDevice(m_deviceId);
+
+    // the segment is free once its previous upload has drained; a never-recorded event reports done
+    WaitForUpload(m_nextSegment);
+    return m_segments[m_nextSegment];
+}
+
+template <class ElemType>
+size_t PinnedMemoryRingBuffer<ElemType>::CommitWrite(size_t numElements, ElemType* gpuBuffer)
+{
+    if (numElements > m_numElementsPerSegment)
+        InvalidArgument("CommitWrite: %lu elements do not fit into a segment of %lu elements.", (unsigned long) numElements, (unsigned long) m_numElementsPerSegment);
+
+    PrepareDevice(m_deviceId);
+
+    size_t segment = m_nextSegment;
+    cudaMemcpyAsync(gpuBuffer, m_segments[segment], numElements * sizeof(ElemType), cudaMemcpyHostToDevice, m_uploadStream) || "cudaMemcpyAsync failed";
+    cudaEventRecord(m_uploadCompleteEvents[segment], m_uploadStream) || "cudaEventRecord failed";
+
+    m_nextSegment = (m_nextSegment + 1) % m_numSegments;
+    return segment;
+}
+
+template <class ElemType>
+void PinnedMemoryRingBuffer<ElemType>::WaitForUpload(size_t segment)
+{
+    if (segment >= m_numSegments)
+        InvalidArgument("WaitForUpload: segment index out of range.");
+
+    PrepareDevice(m_deviceId);
+
+    auto rc = cudaEventQuery(m_uploadCompleteEvents[segment]);
+    if (rc != cudaErrorNotReady)
+    {
+        // if the event is ready then no need to wait
+        rc || "cudaEventQuery failed";
+        return;
+    }
+    cudaEventSynchronize(m_uploadCompleteEvents[segment]) || "cudaEventSynchronize failed";
+}
+
+template <class ElemType>
+bool PinnedMemoryRingBuffer<ElemType>::IsUploadDone(size_t segment)
+{
+    if (segment >= m_numSegments)
+        InvalidArgument("IsUploadDone: segment index out of range.");
+
+    PrepareDevice(m_deviceId);
+
+    auto rc = cudaEventQuery(m_uploadCompleteEvents[segment]);
+    if (rc == cudaErrorNotReady)
+        return false;
+    rc || "cudaEventQuery failed";
+    return true;
+}
+
+//explicit
+template class PinnedMemoryRingBuffer<float>;
+template class PinnedMemoryRingBuffer<double>;
 } } }
@@ -25,6 +25,11 @@ public:
     void CopyCPUToGPUAsync(ElemType* cpuBuffer, size_t numElements, ElemType* gpuBuffer);
     void WaitForCopyCPUToGPUAsync();
 
+    // direct device-to-device copy between two GPUs over PCIe (peer access is enabled on first
+    // use when the hardware supports it; otherwise the runtime stages through host memory)
+    void CopyGPUToGPUAsync(ElemType* srcBuffer, int srcDeviceId, size_t numElements, ElemType* dstBuffer, int dstDeviceId);
+    void WaitForCopyGPUToGPUAsync();
+
 #ifndef CPUONLY
     static cudaStream_t GetFetchStream();
 #endif // !CPUONLY
@@ -45,4 +50,51 @@ private:
 
     int m_deviceId;
 };
+
+// ring of pinned host segments for continuous host-to-device streaming.
+// The producer fills the next free segment (BeginWrite blocks until that slot's previous upload
+// has drained), CommitWrite queues the upload on the ring's own stream, and the consumer fences
+// on the per-segment completion event--so filling segment k+1 overlaps uploading segment k.
+template <class ElemType>
+class PinnedMemoryRingBuffer
+{
+public:
+    PinnedMemoryRingBuffer(int deviceId, size_t numSegments, size_t numElementsPerSegment);
+    ~PinnedMemoryRingBuffer();
+
+    // Disallow copy and move construction and assignment
+    DISABLE_COPY_AND_MOVE(PinnedMemoryRingBuffer);
+
+    size_t NumSegments() const
+    {
+        return m_numSegments;
+    }
+    size_t NumElementsPerSegment() const
+    {
+        return m_numElementsPerSegment;
+    }
+
+    // producer: returns the next free pinned segment, blocking until its previous upload has completed
+    ElemType* BeginWrite();
+
+    // producer: queues the async upload of the first numElements of the segment returned by BeginWrite
+    // to gpuBuffer and advances the ring; returns the segment index the consumer can fence on
+    size_t CommitWrite(size_t numElements, ElemType* gpuBuffer);
+
+    // consumer: fence on the upload of the given segment
+    void WaitForUpload(size_t segment);
+    bool IsUploadDone(size_t segment); // non-blocking poll
+
+private:
+    int m_deviceId;
+    size_t m_numSegments;
+    size_t m_numElementsPerSegment;
+    size_t m_nextSegment; // next segment handed out by BeginWrite
+    std::vector<ElemType*> m_segments;
+
+#ifndef CPUONLY
+    cudaStream_t m_uploadStream;
+    std::vector<cudaEvent_t> m_uploadCompleteEvents;
+#endif // !CPUONLY
+};
 } } }
@@ -15,6 +15,7 @@
 #include "GPUSparseMatrix.h"
 #include "GPUTensor.h"
 #include "CommonMatrix.h"
+#include "CudaEventTimer.h"
 #define TENSOR_OPS_DECL __device__ __host__
 #include "TensorOps.h"
 #include "device_launch_parameters.h"
@@ -24,7 +25,11 @@
 #include <curand_kernel.h>
 #include "cublas_v2.h"
 #include <assert.h>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #pragma comment(lib, "cudart.lib") // instruct linker to reference these libs
 #pragma comment(lib, "cublas.lib")
@@ -67,6 +72,37 @@ cudaStream_t MATH_API GetStream()
     return t_stream;
 }
 
+// Pool of non-default streams, created lazily and reused across acquisitions (per device)
+static std::mutex s_streamPoolMutex;
+static std::map<int, std::vector<cudaStream_t>> s_streamPool; // [deviceId] -> available streams
+
+// AcquireStream - get a non-default stream from the per-device pool (creating one if none is available)
+cudaStream_t MATH_API AcquireStream(int deviceId)
+{
+    {
+        std::unique_lock<std::mutex> lock(s_streamPoolMutex);
+        auto& availableStreams = s_streamPool[deviceId];
+        if (!availableStreams.empty())
+        {
+            cudaStream_t stream = availableStreams.back();
+            availableStreams.pop_back();
+            return stream;
+        }
+    }
+
+    Microsoft::MSR::CNTK::PrepareDevice(deviceId);
+    cudaStream_t stream;
+    CUDA_CALL(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+    return stream;
+}
+
+// ReleaseStream - return a stream obtained from AcquireStream() to the pool for reuse
+void MATH_API ReleaseStream(int deviceId, cudaStream_t stream)
+{
+    std::unique_lock<std::mutex> lock(s_streamPoolMutex);
+    s_streamPool[deviceId].push_back(stream);
+}
+
 // Helper macro patterns for elemtwise methods
 #define DEF_ELEMWISE_INPLACE_FUNC(f)                                      \
     template <class ElemType>                                             \
@@ -108,6 +144,318 @@ const char* CudaErrString<curandStatus>(curandStatus)
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
+// -----------------------------------------------------------------------
+// CudaEventTimer (see CudaEventTimer.h)
+// -----------------------------------------------------------------------
+
+CudaEventTimer::~CudaEventTimer()
+{
+    if (m_startEvent != nullptr)
+    {
+        PrepareDevice(m_deviceId);
+        cudaEventDestroy((cudaEvent_t) m_startEvent); // ignore errors; may run during teardown
+        cudaEventDestroy((cudaEvent_t) m_stopEvent);
+    }
+}
+
+void CudaEventTimer::Begin(DEVICEID_TYPE deviceId)
+{
+    if (deviceId < 0) // CPU device: nothing runs on a GPU stream
+        return;
+    if (m_pending) // fold in the previous Begin/End pair; its events have long completed by now
+        Harvest();
+    if (m_startEvent == nullptr) // create the event pair lazily on first use
+    {
+        m_deviceId = deviceId;
+        PrepareDevice(m_deviceId);
+        cudaEvent_t startEvent, stopEvent;
+        CUDA_CALL(cudaEventCreate(&startEvent)); // note: timing events, hence no cudaEventDisableTiming
+        CUDA_CALL(cudaEventCreate(&stopEvent));
+        m_startEvent = startEvent;
+        m_stopEvent = stopEvent;
+    }
+    else if (deviceId != m_deviceId)
+        LogicError("CudaEventTimer: device changed between uses");
+    PrepareDevice(m_deviceId);
+    CUDA_CALL(cudaEventRecord((cudaEvent_t) m_startEvent, t_stream));
+}
+
+void CudaEventTimer::End()
+{
+    if (m_startEvent == nullptr) // Begin() was a no-op (CPU device)
+        return;
+    PrepareDevice(m_deviceId);
+    CUDA_CALL(cudaEventRecord((cudaEvent_t) m_stopEvent, t_stream));
+    m_pending = true;
+}
+
+void CudaEventTimer::Harvest()
+{
+    PrepareDevice(m_deviceId);
+    CUDA_CALL(cudaEventSynchronize((cudaEvent_t) m_stopEvent)); // in steady state this has already completed
+    float milliseconds = 0;
+    CUDA_CALL(cudaEventElapsedTime(&milliseconds, (cudaEvent_t) m_startEvent, (cudaEvent_t) m_stopEvent));
+    m_totalSeconds += milliseconds / 1000.0;
+    m_pending = false;
+}
+
+double CudaEventTimer::TotalSeconds()
+{
+    if (m_pending)
+        Harvest();
+    return m_totalSeconds;
+}
+
+void CudaEventTimer::Reset()
+{
+    if (m_pending)
+        Harvest();
+    m_totalSeconds = 0;
+}
+
+// Cache of small device buffers. Reductions, VectorMax and the like allocate and free tiny staging
+// buffers (a few elements) around each individual operation, and the cudaMalloc/cudaFree pairs for
+// them take a significant share of the step time; keep such buffers on a per-device free list
+// instead and hand them back out on the next request of the same size.
+static const size_t c_maxCachedBufferBytes = 4096;
+
+struct SmallDeviceBufferCache
+{
+    std::mutex mutex;
+    std::map<std::pair<int, size_t>, std::vector<void*>> availableBuffers; // [(deviceId, bytes)] -> free buffers
+    std::unordered_map<void*, std::pair<int, size_t>> outstandingBuffers;  // cache-managed allocations currently in use
+};
+
+static SmallDeviceBufferCache& GetSmallDeviceBufferCache()
+{
+    // intentionally leaked so that matrix destructors running during static destruction can still return buffers
+    static SmallDeviceBufferCache* cache = new SmallDeviceBufferCache();
+    return *cache;
+}
+
+static void* AllocateFromSmallBufferCache(int deviceId, size_t numBytes)
+{
+    auto& cache = GetSmallDeviceBufferCache();
+    void* p = nullptr;
+
+    std::unique_lock<std::mutex> lock(cache.mutex);
+    auto& availableBuffers = cache.availableBuffers[std::make_pair(deviceId, numBytes)];
+    if (!availableBuffers.empty())
+    {
+        p = availableBuffers.back();
+        availableBuffers.pop_back();
+    }
+    else
+    {
+        lock.unlock();
+        PrepareDevice(deviceId);
+        CUDA_CALL(cudaMalloc(&p, numBytes));
+        lock.lock();
+    }
+
+    cache.outstandingBuffers[p] = std::make_pair(deviceId, numBytes);
+    return p;
+}
+
+// returns true if the pointer came from the small-buffer cache and has been returned to it
+static bool TryReturnToSmallBufferCache(void* p)
+{
+    auto& cache = GetSmallDeviceBufferCache();
+
+    std::unique_lock<std::mutex> lock(cache.mutex);
+    auto iter = cache.outstandingBuffers.find(p);
+    if (iter == cache.outstandingBuffers.end())
+        return false;
+
+    cache.availableBuffers[iter->second].push_back(p);
+    cache.outstandingBuffers.erase(iter);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Stream-ordered pool for full-size matrix buffers. cudaMalloc and cudaFree both synchronize the
+// device, and the Resize() traffic caused by variable-length minibatches hits them on every step,
+// serializing the pipeline exactly where compute and transfers should overlap. Freed buffers are
+// therefore parked on per-device free lists, binned by size, with an event recorded on the
+// compute stream at free time; reusing a buffer makes the allocating stream wait on that event
+// (cudaStreamWaitEvent), so recycling stays ordered on the stream without any host-side
+// synchronization. This assumes the freed buffer's last use was issued on the compute stream,
+// which holds for the matrix operations. When the device runs out of memory, the pool is flushed
+// and the allocation retried, so pooling never turns a tight fit into a failure.
+// ---------------------------------------------------------------------------
+
+struct PooledDeviceBuffer
+{
+    void* p;
+    cudaEvent_t freedFence; // recorded on the freeing stream; the next user waits on this
+};
+
+struct DeviceBufferPool
+{
+    std::mutex mutex;
+    std::map<std::pair<int, size_t>, std::vector<PooledDeviceBuffer>> availableBuffers; // [(deviceId, binBytes)] -> free buffers
+    std::unordered_map<void*, std::pair<int, size_t>> outstandingBuffers;               // pool-managed allocations currently in use
+    std::map<int, std::vector<cudaEvent_t>> spareFences;                                // recycled fence events (events are device-bound)
+    // statistics, reported by PrintPoolStatistics()
+    size_t bytesInUse = 0;
+    size_t peakBytesInUse = 0;
+    size_t bytesCached = 0;
+    size_t numReuses = 0;
+    size_t numDeviceAllocations = 0;
+};
+
+static DeviceBufferPool& GetDeviceBufferPool()
+{
+    // intentionally leaked, same as the small-buffer cache above
+    static DeviceBufferPool* pool = new DeviceBufferPool();
+    return *pool;
+}
+
+// round a byte count up to its pool bin: powers of two, switching to linear 16 MB steps once the
+// power-of-two slack (up to 2x) would cost more memory than pooling across nearby sizes saves
+static size_t DeviceBufferPoolBin(size_t numBytes)
+{
+    const size_t linearBinThreshold = (size_t) 256 << 20;
+    const size_t linearBinStep = (size_t) 16 << 20;
+    if (numBytes > linearBinThreshold)
+        return (numBytes + linearBinStep - 1) / linearBinStep * linearBinStep;
+    size_t bin = 2 * c_maxCachedBufferBytes; // pool bins start right above the small-buffer cache
+    while (bin < numBytes)
+        bin *= 2;
+    return bin;
+}
+
+static void FlushDeviceBufferPool(int deviceId)
+{
+    auto& pool = GetDeviceBufferPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (auto& bin : pool.availableBuffers)
+    {
+        if (bin.first.first != deviceId)
+            continue;
+        for (auto& buffer : bin.second)
+        {
+            cudaEventSynchronize(buffer.freedFence); // pending uses must drain before the driver gets the pages back
+            cudaFree(buffer.p);
+            pool.spareFences[deviceId].push_back(buffer.freedFence);
+            pool.bytesCached -= bin.first.second;
+        }
+        bin.second.clear();
+    }
+}
+
+static void* AllocateFromDeviceBufferPool(int deviceId, size_t numBytes)
+{
+    auto& pool = GetDeviceBufferPool();
+    const size_t binBytes = DeviceBufferPoolBin(numBytes);
+    void* p = nullptr;
+
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    auto& availableBuffers = pool.availableBuffers[std::make_pair(deviceId, binBytes)];
+    if (!availableBuffers.empty())
+    {
+        PooledDeviceBuffer buffer = availableBuffers.back();
+        availableBuffers.pop_back();
+        pool.bytesCached -= binBytes;
+        pool.numReuses++;
+        lock.unlock();
+        // order the reuse behind the pending work of the previous owner, on the stream
+        PrepareDevice(deviceId);
+        CUDA_CALL(cudaStreamWaitEvent(GetStream(), buffer.freedFence, 0));
+        lock.lock();
+        pool.spareFences[deviceId].push_back(buffer.freedFence);
+        p = buffer.p;
+    }
+    else
+    {
+        pool.numDeviceAllocations++;
+        lock.unlock();
+        PrepareDevice(deviceId);
+        if (cudaMalloc(&p, binBytes) != cudaSuccess)
+        {
+            cudaGetLastError();              // clear the sticky error state; we handle this one
+            FlushDeviceBufferPool(deviceId); // out of memory: give everything cached back to the driver and retry
+            if (cudaMalloc(&p, binBytes) != cudaSuccess)
+            {
+                // even the flushed device cannot fit the bin-rounded size, which may be up to 2x
+                // the request: a tight fit must not fail because of the rounding, so retry with
+                // the exact byte count and hand the allocation out unpooled (not recorded in
+                // outstandingBuffers), so that freeing it returns the pages to the driver
+                // instead of caching them under a bin of the wrong size
+                cudaGetLastError();
+                CUDA_CALL(cudaMalloc(&p, numBytes));
+                return p;
+            }
+        }
+        lock.lock();
+    }
+
+    pool.outstandingBuffers[p] = std::make_pair(deviceId, binBytes);
+    pool.bytesInUse += binBytes;
+    if (pool.bytesInUse > pool.peakBytesInUse)
+        pool.peakBytesInUse = pool.bytesInUse;
+    return p;
+}
+
+// returns true if the pointer is pool-managed and has been recycled (or directly freed)
+static bool TryReturnToDeviceBufferPool(void* p, bool ignoreCUDARetCode)
+{
+    auto& pool = GetDeviceBufferPool();
+
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    auto iter = pool.outstandingBuffers.find(p);
+    if (iter == pool.outstandingBuffers.end())
+        return false;
+    const int deviceId = iter->second.first;
+    const size_t binBytes = iter->second.second;
+    pool.outstandingBuffers.erase(iter);
+    pool.bytesInUse -= binBytes;
+
+    cudaEvent_t fence = nullptr;
+    auto& spareFences = pool.spareFences[deviceId];
+    if (!spareFences.empty())
+    {
+        fence = spareFences.back();
+        spareFences.pop_back();
+    }
+    lock.unlock();
+
+    PrepareDevice(deviceId);
+    if (fence == nullptr && cudaEventCreateWithFlags(&fence, cudaEventDisableTiming) != cudaSuccess)
+        fence = nullptr;
+    if (fence == nullptr || cudaEventRecord(fence, GetStream()) != cudaSuccess)
+    {
+        // cannot fence the buffer (e.g. during process shutdown); hand it straight back to the driver
+        cudaGetLastError();
+        if (ignoreCUDARetCode)
+            cudaFree(p);
+        else
+            CUDA_CALL(cudaFree(p));
+        if (fence != nullptr)
+        {
+            lock.lock();
+            pool.spareFences[deviceId].push_back(fence);
+        }
+        return true;
+    }
+
+    lock.lock();
+    pool.availableBuffers[std::make_pair(deviceId, binBytes)].push_back(PooledDeviceBuffer{p, fence});
+    pool.bytesCached += binBytes;
+    return true;
+}
+
+void TracingGPUMemoryAllocator::PrintPoolStatistics()
+{
+    auto& pool = GetDeviceBufferPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (pool.numDeviceAllocations == 0 && pool.numReuses == 0)
+        return; // pool never used (e.g. CPU-only run)
+    fprintf(stderr, "GPU buffer pool: %d MB in use (peak %d MB), %d MB cached, %d reuses / %d device allocations\n",
+            (int) (pool.bytesInUse >> 20), (int) (pool.peakBytesInUse >> 20), (int) (pool.bytesCached >> 20),
+            (int) pool.numReuses, (int) pool.numDeviceAllocations);
+}
+
 template <typename AllocatedElemType>
 AllocatedElemType* TracingGPUMemoryAllocator::Allocate(int deviceId, size_t numRows, size_t numCols)
 {
@@ -141,11 +489,15 @@ AllocatedElemType* TracingGPUMemoryAllocator::Allocate(int deviceId, size_t numE
 template <typename AllocatedElemType>
 void TracingGPUMemoryAllocator::Free(int deviceId, AllocatedElemType* bufferPtr, bool ignoreCUDARetCode /*= false*/)
 {
-    PrepareDevice(deviceId);
-    if (ignoreCUDARetCode)
-        cudaFree((void*) bufferPtr);
-    else
-        CUDA_CALL(cudaFree((void*) bufferPtr));
+    // cache- and pool-managed buffers are recycled instead of hitting the synchronizing cudaFree
+    if (!TryReturnToSmallBufferCache((void*) bufferPtr) && !TryReturnToDeviceBufferPool((void*) bufferPtr, ignoreCUDARetCode))
+    {
+        PrepareDevice(deviceId);
+        if (ignoreCUDARetCode)
+            cudaFree((void*) bufferPtr);
+        else
+            CUDA_CALL(cudaFree((void*) bufferPtr));
+    }
 
     if (IsTraceEnabled())
     {
@@ -158,12 +510,11 @@ void TracingGPUMemoryAllocator::Free(int deviceId, AllocatedElemType* bufferPtr,
 template <typename AllocatedElemType>
 AllocatedElemType* TracingGPUMemoryAllocator::AllocateNoTrace(int deviceId, size_t numElements)
 {
-    AllocatedElemType* deviceBufferPtr;
+    size_t numBytes = sizeof(AllocatedElemType) * numElements;
+    if (numBytes <= c_maxCachedBufferBytes)
+        return (AllocatedElemType*) AllocateFromSmallBufferCache(deviceId, numBytes);
 
-    PrepareDevice(deviceId);
-    CUDA_CALL(cudaMalloc((void**) &deviceBufferPtr, sizeof(AllocatedElemType) * numElements));
-
-    return deviceBufferPtr;
+    return (AllocatedElemType*) AllocateFromDeviceBufferPool(deviceId, numBytes);
 }
 
 std::pair<size_t, size_t> TracingGPUMemoryAllocator::GetFreeAndTotalMemoryInMBs(int deviceId)
@@ -379,6 +730,41 @@ void GPUMatrix<ElemType>::CopySection(size_t numRows, size_t numCols, ElemType*
     CUBLAS_CALL(cublasGetMatrix((int) numRows, (int) numCols, sizeof(ElemType),
                                 m_pArray, (int) GetNumRows(), dst, (int) colStride));
 }
+
+// export the matrix into a packed half-precision (IEEE binary16) CPU array; caller allocates GetNumElements() entries
+// The conversion runs on the device, so only half-width data crosses the PCIe bus.
+template <class ElemType>
+void GPUMatrix<ElemType>::CopyToFloat16Array(unsigned short* halfArray) const
+{
+    size_t numElements = GetNumElements();
+    if (numElements == 0)
+        return;
+    PrepareDevice();
+    unsigned short* d_half = TracingGPUMemoryAllocator::Allocate<unsigned short>(m_computeDevice, numElements);
+    CUDA_LONG N = (CUDA_LONG) numElements;
+    int blocksPerGrid = (int) ceil(1.0 * N / GridDim::maxThreadsPerBlock);
+    _copyToFloat16<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(d_half, m_pArray, N);
+    CUDA_CALL(cudaMemcpy(halfArray, d_half, sizeof(unsigned short) * numElements, cudaMemcpyDeviceToHost));
+    TracingGPUMemoryAllocator::Free<unsigned short>(m_computeDevice, d_half);
+}
+
+// set the matrix from a packed half-precision CPU array (inverse of CopyToFloat16Array);
+// again only half-width data is transferred, the expansion to ElemType happens on the device
+template <class ElemType>
+void GPUMatrix<ElemType>::SetValueFromFloat16Array(const size_t numRows, const size_t numCols, const unsigned short* halfArray)
+{
+    Resize(numRows, numCols);
+    size_t numElements = GetNumElements();
+    if (numElements == 0)
+        return;
+    PrepareDevice();
+    unsigned short* d_half = TracingGPUMemoryAllocator::Allocate<unsigned short>(m_computeDevice, numElements);
+    CUDA_CALL(cudaMemcpy(d_half, halfArray, sizeof(unsigned short) * numElements, cudaMemcpyHostToDevice));
+    CUDA_LONG N = (CUDA_LONG) numElements;
+    int blocksPerGrid = (int) ceil(1.0 * N / GridDim::maxThreadsPerBlock);
+    _copyFromFloat16<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(m_pArray, d_half, N);
+    TracingGPUMemoryAllocator::Free<unsigned short>(m_computeDevice, d_half);
+}
 template <class ElemType>
 void GPUMatrix<ElemType>::ChangeDeviceTo(DEVICEID_TYPE to_id)
 {
@@ -861,6 +1247,105 @@ GPUMatrix<ElemType>& GPUMatrix<ElemType>::AddWithRowSliceValuesOf(const GPUMatri
     return *this;
 }
 
+// gather/scatter by a row-index matrix (see the kernels for the idx conventions)
+// Note: unlike the CPU side, indices are not range-checked here; an out-of-range index
+// corrupts device memory just like any other bad index passed to a kernel would.
+
+// us(i,j) = a(idx(i, j or 0), j)
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignRowGatherOf(const GPUMatrix<ElemType>& idx, const GPUMatrix<ElemType>& a)
+{
+    if (idx.IsEmpty() || a.IsEmpty())
+        LogicError("AssignRowGatherOf: input matrix is empty.");
+
+    if (idx.GetNumCols() != 1 && idx.GetNumCols() != a.GetNumCols())
+        LogicError("AssignRowGatherOf: idx must have 1 column or as many as a.");
+
+    Resize(idx.GetNumRows(), a.GetNumCols());
+
+    CUDA_LONG N = (CUDA_LONG) GetNumElements();
+    int blocksPerGrid = (int) ceil(1.0 * N / GridDim::maxThreadsPerBlock);
+    PrepareDevice();
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _assignRowGatherOf<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(m_pArray, idx.m_pArray, (CUDA_LONG) idx.GetNumCols(), a.m_pArray, N, (CUDA_LONG) GetNumRows(), (CUDA_LONG) a.GetNumRows());
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+
+    return *this;
+}
+
+// us(i,j) += a(idx(i, j or 0), j)
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AddWithRowGatherOf(const GPUMatrix<ElemType>& idx, const GPUMatrix<ElemType>& a)
+{
+    if (idx.IsEmpty() || a.IsEmpty())
+        LogicError("AddWithRowGatherOf: input matrix is empty.");
+
+    if (GetNumRows() != idx.GetNumRows())
+        LogicError("AddWithRowGatherOf: GetNumRows() != idx.GetNumRows().");
+
+    if (a.GetNumCols() != GetNumCols())
+        LogicError("AddWithRowGatherOf: columns does not match.");
+
+    if (idx.GetNumCols() != 1 && idx.GetNumCols() != a.GetNumCols())
+        LogicError("AddWithRowGatherOf: idx must have 1 column or as many as a.");
+
+    CUDA_LONG N = (CUDA_LONG) GetNumElements();
+    int blocksPerGrid = (int) ceil(1.0 * N / GridDim::maxThreadsPerBlock);
+    PrepareDevice();
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _addWithRowGatherOf<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(m_pArray, idx.m_pArray, (CUDA_LONG) idx.GetNumCols(), a.m_pArray, N, (CUDA_LONG) GetNumRows(), (CUDA_LONG) a.GetNumRows());
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+
+    return *this;
+}
+
+// us(idx(i, j or 0), j) += a(i,j); repeated indices accumulate (the kernel uses atomics)
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AddRowScatterOf(const GPUMatrix<ElemType>& idx, const GPUMatrix<ElemType>& a)
+{
+    if (idx.IsEmpty() || a.IsEmpty())
+        LogicError("AddRowScatterOf: input matrix is empty.");
+
+    if (idx.GetNumRows() != a.GetNumRows())
+        LogicError("AddRowScatterOf: idx.GetNumRows() != a.GetNumRows().");
+
+    if (a.GetNumCols() != GetNumCols())
+        LogicError("AddRowScatterOf: columns does not match.");
+
+    if (idx.GetNumCols() != 1 && idx.GetNumCols() != a.GetNumCols())
+        LogicError("AddRowScatterOf: idx must have 1 column or as many as a.");
+
+    CUDA_LONG N = (CUDA_LONG) a.GetNumElements();
+    int blocksPerGrid = (int) ceil(1.0 * N / GridDim::maxThreadsPerBlock);
+    PrepareDevice();
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _addRowScatterOf<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(m_pArray, idx.m_pArray, (CUDA_LONG) idx.GetNumCols(), a.m_pArray, N, (CUDA_LONG) GetNumRows(), (CUDA_LONG) a.GetNumRows());
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+
+    return *this;
+}
+
 template <class ElemType>
 GPUMatrix<ElemType> GPUMatrix<ElemType>::Diagonal() const
 {
@@ -967,6 +1452,91 @@ GPUMatrix<ElemType>& GPUMatrix<ElemType>::AddToRowRepeatValuesOf(const GPUMatrix
     return *this;
 }
 
+// pack the columns listed in columnIndices contiguously into [this] ([this] column j = a column columnIndices[j])
+// used to compact gap columns out of a minibatch before compute-heavy operations
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignGatheredColumnsOf(const GPUMatrix<ElemType>& a, const std::vector<size_t>& columnIndices)
+{
+    if (this == &a)
+        LogicError("AssignGatheredColumnsOf: a is the same as [this]. Does not support inplace gather.");
+
+    if (a.IsEmpty())
+        LogicError("AssignGatheredColumnsOf: Matrix a is empty.");
+
+    for (size_t j = 0; j < columnIndices.size(); j++)
+        if (columnIndices[j] >= a.GetNumCols())
+            InvalidArgument("AssignGatheredColumnsOf: column index %d out of range.", (int) columnIndices[j]);
+
+    Resize(a.GetNumRows(), columnIndices.size());
+    if (columnIndices.empty())
+        return *this;
+
+    PrepareDevice();
+    size_t* columnIndicesDevice = TracingGPUMemoryAllocator::Allocate<size_t>(m_computeDevice, columnIndices.size());
+    CUDA_CALL(cudaMemcpy(columnIndicesDevice, columnIndices.data(), columnIndices.size() * sizeof(size_t), cudaMemcpyHostToDevice));
+
+    CUDA_LONG N = (CUDA_LONG) GetNumElements();
+    int blocksPerGrid = (int) ceil(1.0 * N / GridDim::maxThreadsPerBlock);
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _gatherColumns<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(m_pArray, a.m_pArray, columnIndicesDevice, (CUDA_LONG) GetNumRows(), N);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+    TracingGPUMemoryAllocator::Free<size_t>(m_computeDevice, columnIndicesDevice);
+
+    return *this;
+}
+
+// inverse of AssignGatheredColumnsOf: spread the packed columns back out ([this] column columnIndices[j] = packed column j)
+// columns of [this] not listed in columnIndices are left untouched
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::ScatterGatheredColumnsOf(const GPUMatrix<ElemType>& packed, const std::vector<size_t>& columnIndices)
+{
+    if (this == &packed)
+        LogicError("ScatterGatheredColumnsOf: packed is the same as [this]. Does not support inplace scatter.");
+
+    if (packed.IsEmpty())
+        LogicError("ScatterGatheredColumnsOf: Matrix packed is empty.");
+
+    if (packed.GetNumRows() != GetNumRows())
+        LogicError("ScatterGatheredColumnsOf: packed and [this] must have the same number of rows.");
+
+    if (packed.GetNumCols() != columnIndices.size())
+        LogicError("ScatterGatheredColumnsOf: packed must have one column per entry of columnIndices.");
+
+    for (size_t j = 0; j < columnIndices.size(); j++)
+        if (columnIndices[j] >= GetNumCols())
+            InvalidArgument("ScatterGatheredColumnsOf: column index %d out of range.", (int) columnIndices[j]);
+
+    if (columnIndices.empty())
+        return *this;
+
+    PrepareDevice();
+    size_t* columnIndicesDevice = TracingGPUMemoryAllocator::Allocate<size_t>(m_computeDevice, columnIndices.size());
+    CUDA_CALL(cudaMemcpy(columnIndicesDevice, columnIndices.data(), columnIndices.size() * sizeof(size_t), cudaMemcpyHostToDevice));
+
+    CUDA_LONG N = (CUDA_LONG) packed.GetNumElements();
+    int blocksPerGrid = (int) ceil(1.0 * N / GridDim::maxThreadsPerBlock);
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _scatterColumns<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(m_pArray, packed.m_pArray, columnIndicesDevice, (CUDA_LONG) GetNumRows(), N);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+    TracingGPUMemoryAllocator::Free<size_t>(m_computeDevice, columnIndicesDevice);
+
+    return *this;
+}
+
 template <class ElemType>
 GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignPositiveAndShiftedNegSample(const GPUMatrix<ElemType>& a, const size_t posNumber, const size_t negNumber, const size_t shiftNumber)
 {
@@ -1338,22 +1908,18 @@ template <class ElemType>
 void GPUMatrix<ElemType>::SetUniformRandomValue(const ElemType low, const ElemType high, unsigned long seed)
 {
     PrepareDevice();
-    CreateCurandObject(seed, __FUNCTION__); // TODO call ResetCurandObject() instead?
+    curandGenerator_t gen = (curandGenerator_t) GetCurandGenerator(seed, __FUNCTION__);
 
-    cudaEvent_t done = nullptr;
-    CUDA_CALL(cudaEventCreate(&done));
+    // generation runs on the compute stream, so the rescale kernel below is ordered
+    // after it without a host-side event synchronization
     if (sizeof(ElemType) == sizeof(float))
     {
-        CURAND_CALL(curandGenerateUniform(((curandGenerator_t*) s_curandGenerator)[0], reinterpret_cast<float*>(m_pArray), GetNumElements()));
+        CURAND_CALL(curandGenerateUniform(gen, reinterpret_cast<float*>(m_pArray), GetNumElements()));
     }
     else
     {
-        CURAND_CALL(curandGenerateUniformDouble(((curandGenerator_t*) s_curandGenerator)[0], reinterpret_cast<double*>(m_pArray), GetNumElements()));
+        CURAND_CALL(curandGenerateUniformDouble(gen, reinterpret_cast<double*>(m_pArray), GetNumElements()));
     }
-    CUDA_CALL(cudaEventRecord(done));
-    CUDA_CALL(cudaEventSynchronize(done));
-    // CURAND_CALL(curandDestroyGenerator(gen));
-    CUDA_CALL(cudaEventDestroy(done));
 
     size_t N = GetNumElements();
     size_t blocksPerGrid = (size_t) ceil(N / (double) GridDim::maxThreadsPerBlock);
@@ -1373,17 +1939,16 @@ template <class ElemType>
 void GPUMatrix<ElemType>::SetGaussianRandomValue(const ElemType mean, const ElemType sigma, unsigned long seed)
 {
     PrepareDevice();
-    CreateCurandObject(seed, __FUNCTION__); // TODO call ResetCurandObject() instead?
+    curandGenerator_t gen = (curandGenerator_t) GetCurandGenerator(seed, __FUNCTION__);
 
     if (sizeof(ElemType) == sizeof(float))
     {
-        CURAND_CALL(curandGenerateNormal(((curandGenerator_t*) s_curandGenerator)[0], reinterpret_cast<float*>(m_pArray), GetNumElements(), (float) mean, (float) sigma));
+        CURAND_CALL(curandGenerateNormal(gen, reinterpret_cast<float*>(m_pArray), GetNumElements(), (float) mean, (float) sigma));
     }
     else
     {
-        CURAND_CALL(curandGenerateNormalDouble(((curandGenerator_t*) s_curandGenerator)[0], reinterpret_cast<double*>(m_pArray), GetNumElements(), (double) mean, (double) sigma));
+        CURAND_CALL(curandGenerateNormalDouble(gen, reinterpret_cast<double*>(m_pArray), GetNumElements(), (double) mean, (double) sigma));
     }
-    // CURAND_CALL(curandDestroyGenerator(gen));
 }
 
 //maskRate: percentage of values masked out (similar to dropout rate)
@@ -1392,22 +1957,18 @@ template <class ElemType>
 void GPUMatrix<ElemType>::SetUniformRandomMask(const ElemType maskRate, const ElemType scaleValue, unsigned long seed)
 {
     PrepareDevice();
-    CreateCurandObject(seed, __FUNCTION__); // TODO call ResetCurandObject() instead?
+    curandGenerator_t gen = (curandGenerator_t) GetCurandGenerator(seed, __FUNCTION__);
 
-    cudaEvent_t done = nullptr;
-    CUDA_CALL(cudaEventCreate(&done));
+    // generation runs on the compute stream, so the masking kernel below is ordered
+    // after it without a host-side event synchronization
     if (sizeof(ElemType) == sizeof(float))
     {
-        CURAND_CALL(curandGenerateUniform((((curandGenerator_t*) s_curandGenerator)[0]), reinterpret_cast<float*>(m_pArray), GetNumElements()));
+        CURAND_CALL(curandGenerateUniform(gen, reinterpret_cast<float*>(m_pArray), GetNumElements()));
     }
     else
     {
-        CURAND_CALL(curandGenerateUniformDouble((((curandGenerator_t*) s_curandGenerator)[0]), reinterpret_cast<double*>(m_pArray), GetNumElements()));
+        CURAND_CALL(curandGenerateUniformDouble(gen, reinterpret_cast<double*>(m_pArray), GetNumElements()));
     }
-    CUDA_CALL(cudaEventRecord(done));
-    CUDA_CALL(cudaEventSynchronize(done));
-    CUDA_CALL(cudaEventDestroy(done));
-    // CURAND_CALL(curandDestroyGenerator(gen));
 
     size_t N = GetNumElements();
     size_t blocksPerGrid = (size_t) ceil(N / (double) GridDim::maxThreadsPerBlock);
@@ -1422,6 +1983,60 @@ void GPUMatrix<ElemType>::SetUniformRandomMask(const ElemType maskRate, const El
         CUDA_CALL(cudaEventDestroy(done));
 }
 
+// fused dropout: this = (uniform <= dropoutRate) ? 0 : a * scaleValue, with the mask drawn
+// from the counter-based RNG _dropoutUniform(randomSeed, offset + index) instead of a
+// materialized mask matrix
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignDropoutOf(const GPUMatrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset)
+{
+    if (a.IsEmpty())
+        LogicError("AssignDropoutOf: Matrix a is empty.");
+
+    Resize(a.GetNumRows(), a.GetNumCols());
+
+    a.PrepareDevice();
+    CUDA_LONG N = (CUDA_LONG) GetNumElements();
+    int blocksPerGrid = (int) ceil(1.0 * N / GridDim::maxThreadsPerBlock);
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _assignDropoutOf<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(m_pArray, a.m_pArray, N, dropoutRate, scaleValue, randomSeed, (CUDA_LONG) offset);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+    return *this;
+}
+
+// fused dropout gradient: this += a * scaleValue wherever the regenerated mask kept the element
+// Must be called with the same (randomSeed, offset) as the forward AssignDropoutOf() call.
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AddDropoutGradientOf(const GPUMatrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset)
+{
+    if (a.IsEmpty())
+        LogicError("AddDropoutGradientOf: Matrix a is empty.");
+
+    if (!(GetNumRows() == a.GetNumRows() && GetNumCols() == a.GetNumCols()))
+        InvalidArgument("AddDropoutGradientOf: Matrices must be the same size.");
+
+    a.PrepareDevice();
+    CUDA_LONG N = (CUDA_LONG) GetNumElements();
+    int blocksPerGrid = (int) ceil(1.0 * N / GridDim::maxThreadsPerBlock);
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _addDropoutGradientOf<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(m_pArray, a.m_pArray, N, dropoutRate, scaleValue, randomSeed, (CUDA_LONG) offset);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+    return *this;
+}
+
 template <class ElemType>
 ElemType GPUMatrix<ElemType>::Adagrad(GPUMatrix<ElemType>& gradients, const bool needAveMultiplier)
 {
@@ -1444,7 +2059,7 @@ ElemType GPUMatrix<ElemType>::Adagrad(GPUMatrix<ElemType>& gradients, const bool
         multipliers = m_pArray + n; // temp memory used to store multipliers,
 
     int blocksPerGrid = (n + GridDim::maxThreadsPerBlock - 1) / GridDim::maxThreadsPerBlock;
-    _adagrad<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock>>>(m_pArray, gradients.m_pArray, n, multipliers);
+    _adagrad<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(m_pArray, gradients.m_pArray, n, multipliers);
 
     if (!needAveMultiplier)
         return 1;
@@ -1464,6 +2079,24 @@ ElemType GPUMatrix<ElemType>::Adagrad(GPUMatrix<ElemType>& gradients, const bool
     }
 }
 
+// fused form of Adagrad() + the weight step: one kernel updates the accumulator, scales
+// the gradient with rsqrt and writes the parameters, instead of a separate ScaleAndAdd
+// pass over gradient and weights. Only valid without the average multiplier, whose
+// global reduction inherently needs a second pass.
+template <class ElemType>
+void GPUMatrix<ElemType>::AdagradUpdate(GPUMatrix<ElemType>& gradients, GPUMatrix<ElemType>& functionValues, const ElemType learnRatePerSample)
+{
+    if (IsEmpty() || GetNumCols() < gradients.GetNumCols() || GetNumRows() != gradients.GetNumRows())
+    {
+        Resize(gradients.GetNumRows(), gradients.GetNumCols());
+        SetValue(0.0);
+    }
+
+    size_t n = gradients.GetNumElements();
+    int blocksPerGrid = (n + GridDim::maxThreadsPerBlock - 1) / GridDim::maxThreadsPerBlock;
+    _adagradUpdate<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(n, gradients.m_pArray, m_pArray, functionValues.m_pArray, learnRatePerSample);
+}
+
 template <class ElemType>
 void GPUMatrix<ElemType>::FSAdagrad(GPUMatrix<ElemType>& gradients,
                                     GPUMatrix<ElemType>& functionValues,
@@ -1484,8 +2117,8 @@ void GPUMatrix<ElemType>::FSAdagrad(GPUMatrix<ElemType>& gradients,
 
     size_t n = gradients.GetNumElements();
     int blocksPerGrid = (n + GridDim::maxThreadsPerBlock - 1) / GridDim::maxThreadsPerBlock;
-    _fsadagrad<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock>>>(n, gradients.m_pArray, m_pArray, m_pArray + n, functionValues.m_pArray,
-                                                                         learnRatePerSample, momentum, adaWeight, adaMul);
+    _fsadagrad<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(n, gradients.m_pArray, m_pArray, m_pArray + n, functionValues.m_pArray,
+                                                                                      learnRatePerSample, momentum, adaWeight, adaMul);
 }
 
 template <class ElemType>
@@ -1517,7 +2150,7 @@ ElemType GPUMatrix<ElemType>::RmsProp(GPUMatrix<ElemType>& gradients,
         ElemType* steps = m_pArray + 2 * n; // current step size
         // m_pArray+3*n is temp memory used to store multipliers, no need to initialize
 
-        _rmsprop_init<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock>>>(avars, signs, steps, gradients.m_pArray, n);
+        _rmsprop_init<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(avars, signs, steps, gradients.m_pArray, n);
     }
     assert(GetNumRows() == gradients.GetNumRows() && GetNumCols() == numColsNeeded);
 
@@ -1547,9 +2180,9 @@ ElemType GPUMatrix<ElemType>::RmsProp(GPUMatrix<ElemType>& gradients,
         CUDA_CALL(cudaMemcpy(upd_gpu, upd, sizeof(ElemType) * 27, cudaMemcpyHostToDevice));
     }
 
-    _rmsprop<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock>>>(avars, signs, steps, gradients.m_pArray, n,
-                                                                       RMS_GAMMA, RMS_WGT_INC, RMS_WGT_MAX, RMS_WGT_DEC, RMS_WGT_MIN,
-                                                                       floor, upd_gpu, multipliers);
+    _rmsprop<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(avars, signs, steps, gradients.m_pArray, n,
+                                                                                    RMS_GAMMA, RMS_WGT_INC, RMS_WGT_MAX, RMS_WGT_DEC, RMS_WGT_MIN,
+                                                                                    floor, upd_gpu, multipliers);
 
     if (!needAveMultiplier)
         return 1;
@@ -1635,6 +2268,18 @@ ElemType GPUMatrix<ElemType>::Get00Element() const
     CUDA_CALL(cudaMemcpy(&res, m_pArray, sizeof(ElemType), cudaMemcpyDeviceToHost));
     return res;
 }
+
+// read back a single element without transferring the whole buffer
+template <class ElemType>
+ElemType GPUMatrix<ElemType>::GetValue(const size_t row, const size_t col) const
+{
+    if (row >= m_numRows || col >= m_numCols)
+        InvalidArgument("GetValue: index out of range.");
+
+    ElemType res = 0;
+    CUDA_CALL(cudaMemcpy(&res, m_pArray + LocateElement(row, col), sizeof(ElemType), cudaMemcpyDeviceToHost));
+    return res;
+}
 #pragma endregion Basic Operators
 
 #pragma region Member BLAS Functions
@@ -2328,7 +2973,14 @@ GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignLogSoftmaxOf(const GPUMatrix<Ele
         cudaEvent_t done = nullptr;
         if (do_sync)
             CUDA_CALL(cudaEventCreate(&done));
-        _assignColumnwiseLogSoftmaxOf<<<N, 512, 0, t_stream>>>(a.m_pArray, m_pArray, N, M);
+        if (M <= 128) // narrow columns: one warp per column, several columns per block
+        {
+            int colsPerBlock = GridDim::maxThreadsPerBlock / 32;
+            int blocksPerGrid = (int) ceil(1.0 * N / colsPerBlock);
+            _assignColumnwiseLogSoftmaxOfNarrow<<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(a.m_pArray, m_pArray, N, M);
+        }
+        else
+            _assignColumnwiseLogSoftmaxOf<<<N, 512, 0, t_stream>>>(a.m_pArray, m_pArray, N, M);
         if (do_sync)
             CUDA_CALL(cudaEventRecord(done));
         if (do_sync)
@@ -2344,6 +2996,76 @@ GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignLogSoftmaxOf(const GPUMatrix<Ele
     return *this;
 }
 
+//[this]=-sum(labels .* logsoftmax(predictions)), fused into a single kernel
+// softmaxStats is resized to 2 x cols; row 0 receives the per-column max and row 1 the per-column
+// log partition function, from which the backward pass reconstructs softmax and log-softmax values
+// on the fly instead of keeping full-size copies of them around
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignCrossEntropyWithSoftmaxOf(const GPUMatrix<ElemType>& labels, const GPUMatrix<ElemType>& predictions, GPUMatrix<ElemType>& softmaxStats, const GPUMatrix<char>* columnsValidityMask /*= nullptr*/)
+{
+    if (labels.IsEmpty() || predictions.IsEmpty())
+        LogicError("AssignCrossEntropyWithSoftmaxOf: Matrix is empty.");
+
+    if (labels.GetNumRows() != predictions.GetNumRows() || labels.GetNumCols() != predictions.GetNumCols())
+        InvalidArgument("AssignCrossEntropyWithSoftmaxOf: labels and predictions must have same dimension.");
+
+    if (columnsValidityMask != nullptr && columnsValidityMask->GetNumCols() != predictions.GetNumCols())
+        InvalidArgument("AssignCrossEntropyWithSoftmaxOf: predictions and column mask must have equal number of columns.");
+
+    CUDA_LONG N = (CUDA_LONG) predictions.GetNumCols();
+    CUDA_LONG M = (CUDA_LONG) predictions.GetNumRows();
+    softmaxStats.Resize(2, N);
+    Resize(1, 1);
+    SetValue(0);
+
+    PrepareDevice();
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _assignCrossEntropyWithSoftmaxOf<ElemType><<<N, 512, 0, t_stream>>>(labels.m_pArray, predictions.m_pArray, softmaxStats.m_pArray, m_pArray, N, M,
+                                                                        columnsValidityMask != nullptr ? columnsValidityMask->m_pArray : nullptr);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+
+    return *this;
+}
+
+// index-label variant of AssignCrossEntropyWithSoftmaxOf: labelIndexes is 1 x cols and holds the
+// label class per column (negative = gap), so no dense one-hot label matrix is needed
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignIndexedCrossEntropyWithSoftmaxOf(const GPUMatrix<ElemType>& labelIndexes, const GPUMatrix<ElemType>& predictions, GPUMatrix<ElemType>& softmaxStats)
+{
+    if (labelIndexes.IsEmpty() || predictions.IsEmpty())
+        LogicError("AssignIndexedCrossEntropyWithSoftmaxOf: Matrix is empty.");
+
+    if (labelIndexes.GetNumRows() != 1 || labelIndexes.GetNumCols() != predictions.GetNumCols())
+        InvalidArgument("AssignIndexedCrossEntropyWithSoftmaxOf: labelIndexes must be a 1 x cols matrix.");
+
+    CUDA_LONG N = (CUDA_LONG) predictions.GetNumCols();
+    CUDA_LONG M = (CUDA_LONG) predictions.GetNumRows();
+    softmaxStats.Resize(2, N);
+    Resize(1, 1);
+    SetValue(0);
+
+    PrepareDevice();
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _assignIndexedCrossEntropyWithSoftmaxOf<ElemType><<<N, 512, 0, t_stream>>>(labelIndexes.m_pArray, predictions.m_pArray, softmaxStats.m_pArray, m_pArray, N, M);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+
+    return *this;
+}
+
 template <class ElemType>
 GPUMatrix<ElemType>& GPUMatrix<ElemType>::InplaceHardmax(const bool isColWise)
 {
@@ -2552,6 +3274,33 @@ ElemType GPUMatrix<ElemType>::SumOfAbsElements() const
     }
 }
 
+// accumulate a log2-bucketed histogram of the element magnitudes into 'histogram' (numBuckets x 1)
+// See CPUMatrix<ElemType>::AccumulateAbsLogHistogram() for the bucket semantics. The counts stay
+// on the device; one pass over the data, no host sync.
+template <class ElemType>
+void GPUMatrix<ElemType>::AccumulateAbsLogHistogram(int minExponent, GPUMatrix<ElemType>& histogram) const
+{
+    if (IsEmpty() || histogram.IsEmpty())
+        LogicError("AccumulateAbsLogHistogram: Matrix is empty.");
+    if (GetComputeDeviceId() != histogram.GetComputeDeviceId())
+        InvalidArgument("AccumulateAbsLogHistogram: matrix and histogram must be on the same GPU");
+
+    PrepareDevice();
+    const CUDA_LONG N = (CUDA_LONG) GetNumElements();
+    int blocksPerGrid = (int) ceil(1.0 * N / GridDim::maxThreadsPerBlock);
+
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _accumulateAbsLogHistogram<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(m_pArray, N, minExponent, (int) histogram.GetNumElements(), histogram.m_pArray);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+}
+
 template <class ElemType>
 ElemType GPUMatrix<ElemType>::SumOfElements() const
 {
@@ -2776,21 +3525,21 @@ void GPUMatrix<ElemType>::VectorNorm1(GPUMatrix<ElemType>& c, const bool isColWi
     PrepareDevice();
     c.ChangeDeviceTo(GetComputeDeviceId());
 
-    int blocksPerGrid = 0;
-    if (isColWise) // col-wise
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    if (isColWise) // col-wise: one warp per column, so loads stay coalesced
     {
         c.Resize(1, m);
-        blocksPerGrid = (int) ceil(1.0 * m / GridDim::maxThreadsPerBlock);
+        int colsPerBlock = GridDim::maxThreadsPerBlock / 32;
+        int blocksPerGrid = (int) ceil(1.0 * m / colsPerBlock);
+        _vectorNormColReduce<ElemType, 1><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(c.m_pArray, m_pArray, n, m);
     }
     else
     {
         c.Resize(n, 1);
-        blocksPerGrid = (int) ceil(1.0 * n / GridDim::maxThreadsPerBlock);
+        int blocksPerGrid = (int) ceil(1.0 * n / GridDim::maxThreadsPerBlock);
+        _vectorNorm1<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(c.m_pArray, m_pArray, n, m, isColWise);
     }
-
-    if (do_sync)
-        CUDA_CALL(cudaEventCreate(&done));
-    _vectorNorm1<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(c.m_pArray, m_pArray, n, m, isColWise);
     if (do_sync)
         CUDA_CALL(cudaEventRecord(done));
     if (do_sync)
@@ -2820,22 +3569,22 @@ void GPUMatrix<ElemType>::VectorNorm2(GPUMatrix<ElemType>& c, const bool isColWi
     PrepareDevice();
     c.ChangeDeviceTo(GetComputeDeviceId());
 
-    int blocksPerGrid = 0;
-    if (isColWise) // col-wise
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    if (isColWise) // col-wise: one warp per column, so loads stay coalesced
     {
         c.Resize(1, m);
-        blocksPerGrid = (int) ceil(1.0 * m / GridDim::maxThreadsPerBlock);
+        int colsPerBlock = GridDim::maxThreadsPerBlock / 32;
+        int blocksPerGrid = (int) ceil(1.0 * m / colsPerBlock);
+        _vectorNormColReduce<ElemType, 2><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(c.m_pArray, m_pArray, n, m);
     }
     else
     {
         c.Resize(n, 1);
         c.ChangeDeviceTo(GetComputeDeviceId());
-        blocksPerGrid = (int) ceil(1.0 * n / GridDim::maxThreadsPerBlock);
+        int blocksPerGrid = (int) ceil(1.0 * n / GridDim::maxThreadsPerBlock);
+        _vectorNorm2<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(c.m_pArray, m_pArray, n, m, isColWise);
     }
-
-    if (do_sync)
-        CUDA_CALL(cudaEventCreate(&done));
-    _vectorNorm2<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(c.m_pArray, m_pArray, n, m, isColWise);
     if (do_sync)
         CUDA_CALL(cudaEventRecord(done));
     if (do_sync)
@@ -3156,6 +3905,23 @@ void GPUMatrix<ElemType>::VectorMax(GPUMatrix<ElemType>& maxIndexes, GPUMatrix<E
     maxValues.Resize(topK, n);
     maxIndexes.Resize(topK, n);
 
+    // For small K (the beam-pruning case) a fused per-column selection kernel beats sorting:
+    // it reads the column K times and emits the compact [K x n] result in one launch, with no
+    // workspace, while the sort path below radix-sorts all m*n elements twice.
+    const int MaxFusedTopK = 64;
+    if (topK <= MaxFusedTopK)
+    {
+        int blocksPerGrid = n; // we'll have 1 block processing 1 column
+        _vectorTopKMaxReduce<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(us.m_pArray, maxIndexes.m_pArray, maxValues.m_pArray, m, topK);
+        if (do_sync)
+            CUDA_CALL(cudaEventRecord(done));
+        if (do_sync)
+            CUDA_CALL(cudaEventSynchronize(done));
+        if (do_sync)
+            CUDA_CALL(cudaEventDestroy(done));
+        return;
+    }
+
     // To sort matrix columns we use 2-pass _stable_ sort algorithm:
     // 1. Sort by values (descending) with corresponding row/col indexes.
     // 2. Sort by col indices (ascending) with corresponding values/row indices.
@@ -3296,6 +4062,32 @@ GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignNumOfDiff(const GPUMatrix<ElemTy
     return *this;
 }
 
+// fused top-K classification error (see CPUMatrix::AssignTopKError for the semantics)
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignTopKError(const GPUMatrix<ElemType>& labels, const GPUMatrix<ElemType>& predictions, const int topK)
+{
+    if (labels.GetNumCols() != predictions.GetNumCols() || labels.GetNumRows() != predictions.GetNumRows())
+        InvalidArgument("AssignTopKError: labels and predictions must have the same dimensions.");
+
+    Resize(1, 1); // result should be one element
+    SetValue(0);
+
+    PrepareDevice();
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    int blocksPerGrid = (int) ceil(1.0 * labels.GetNumCols() / GridDim::maxThreadsPerBlock);
+    _assignTopKError<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(labels.m_pArray, predictions.m_pArray, m_pArray,
+                                                                                            (CUDA_LONG) labels.GetNumRows(), (CUDA_LONG) labels.GetNumCols(), (CUDA_LONG) topK);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+    return *this;
+}
+
 #pragma endregion Member BLAS Functions
 
 #pragma region Other helper functions
@@ -3535,6 +4327,106 @@ GPUMatrix<ElemType>& GPUMatrix<ElemType>::AddAveragePoolingGradient(const GPUMat
     return *this;
 }
 
+// fused batch normalization of 'this' (D x N, one sample per column) into 'out': one kernel
+// computes the minibatch statistics, updates the running statistics, and writes the normalized
+// output. The statistics dimension S is taken from 'scale' (S x 1); see the CPUMatrix
+// counterpart for the layout semantics.
+template <class ElemType>
+void GPUMatrix<ElemType>::BatchNormalizationForward(const GPUMatrix<ElemType>& scale, const GPUMatrix<ElemType>& bias,
+                                                    double expAvgFactor, double epsilon,
+                                                    GPUMatrix<ElemType>& runMean, GPUMatrix<ElemType>& runInvStdDev,
+                                                    GPUMatrix<ElemType>& out,
+                                                    GPUMatrix<ElemType>& saveMean, GPUMatrix<ElemType>& saveInvStdDev) const
+{
+    if (IsEmpty())
+        LogicError("BatchNormalizationForward: Matrix is empty.");
+
+    const CUDA_LONG D = (CUDA_LONG) GetNumRows();
+    const CUDA_LONG N = (CUDA_LONG) GetNumCols();
+    const CUDA_LONG S = (CUDA_LONG) scale.GetNumRows();
+    if (S == 0 || D % S != 0)
+        InvalidArgument("BatchNormalizationForward: the scale dimension must evenly divide the input dimension.");
+
+    PrepareDevice();
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _batchNormalizationForward<ElemType><<<(unsigned int) S, 512, 0, t_stream>>>(m_pArray, out.m_pArray, scale.m_pArray, bias.m_pArray,
+                                                                                 D, N, S, (ElemType) expAvgFactor, (ElemType) epsilon,
+                                                                                 runMean.m_pArray, runInvStdDev.m_pArray,
+                                                                                 saveMean.m_pArray, saveInvStdDev.m_pArray);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+}
+
+// inference-time counterpart of BatchNormalizationForward(): normalize with the running statistics
+template <class ElemType>
+void GPUMatrix<ElemType>::BatchNormalizationForwardInference(const GPUMatrix<ElemType>& scale, const GPUMatrix<ElemType>& bias,
+                                                             const GPUMatrix<ElemType>& runMean, const GPUMatrix<ElemType>& runInvStdDev,
+                                                             GPUMatrix<ElemType>& out) const
+{
+    if (IsEmpty())
+        LogicError("BatchNormalizationForwardInference: Matrix is empty.");
+
+    const CUDA_LONG D = (CUDA_LONG) GetNumRows();
+    const CUDA_LONG numElements = (CUDA_LONG) GetNumElements();
+    const CUDA_LONG S = (CUDA_LONG) scale.GetNumRows();
+    if (S == 0 || D % S != 0)
+        InvalidArgument("BatchNormalizationForwardInference: the scale dimension must evenly divide the input dimension.");
+
+    PrepareDevice();
+    int blocksPerGrid = (int) ceil(1.0 * numElements / GridDim::maxThreadsPerBlock);
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _batchNormalizationForwardInference<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(m_pArray, out.m_pArray,
+                                                                                                              scale.m_pArray, bias.m_pArray,
+                                                                                                              runMean.m_pArray, runInvStdDev.m_pArray,
+                                                                                                              numElements, D, S);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+}
+
+// backward pass of BatchNormalizationForward() in a single kernel over 'this' (the incoming
+// gradient): accumulates the input gradient into 'grad' and writes the scale and bias gradients
+template <class ElemType>
+void GPUMatrix<ElemType>::BatchNormalizationBackward(const GPUMatrix<ElemType>& in, GPUMatrix<ElemType>& grad,
+                                                     const GPUMatrix<ElemType>& scale,
+                                                     const GPUMatrix<ElemType>& saveMean, const GPUMatrix<ElemType>& saveInvStdDev,
+                                                     GPUMatrix<ElemType>& scaleGrad, GPUMatrix<ElemType>& biasGrad) const
+{
+    if (IsEmpty())
+        LogicError("BatchNormalizationBackward: Matrix is empty.");
+
+    const CUDA_LONG D = (CUDA_LONG) GetNumRows();
+    const CUDA_LONG N = (CUDA_LONG) GetNumCols();
+    const CUDA_LONG S = (CUDA_LONG) scale.GetNumRows();
+    if (S == 0 || D % S != 0)
+        InvalidArgument("BatchNormalizationBackward: the scale dimension must evenly divide the input dimension.");
+
+    PrepareDevice();
+    cudaEvent_t done = nullptr;
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _batchNormalizationBackward<ElemType><<<(unsigned int) S, 512, 0, t_stream>>>(m_pArray, in.m_pArray, grad.m_pArray,
+                                                                                  scale.m_pArray, saveMean.m_pArray, saveInvStdDev.m_pArray,
+                                                                                  scaleGrad.m_pArray, biasGrad.m_pArray, D, N, S);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+}
+
 #pragma endregion Other helper functions
 
 #pragma region Static BLAS Functions
@@ -3547,6 +4439,15 @@ static cublasStatus_t cublas_gemm(cublasHandle_t handle, cublasOperation_t trans
 {
     return cublasDgemm(handle, transa, transb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
 }
+// float/double overloads of cublasSgemmBatched()/cublasDgemmBatched()
+static cublasStatus_t cublas_gemmBatched(cublasHandle_t handle, cublasOperation_t transa, cublasOperation_t transb, int m, int n, int k, const float* alpha, const float* Aarray[], int lda, const float* Barray[], int ldb, const float* beta, float* Carray[], int ldc, int batchCount)
+{
+    return cublasSgemmBatched(handle, transa, transb, m, n, k, alpha, Aarray, lda, Barray, ldb, beta, Carray, ldc, batchCount);
+}
+static cublasStatus_t cublas_gemmBatched(cublasHandle_t handle, cublasOperation_t transa, cublasOperation_t transb, int m, int n, int k, const double* alpha, const double* Aarray[], int lda, const double* Barray[], int ldb, const double* beta, double* Carray[], int ldc, int batchCount)
+{
+    return cublasDgemmBatched(handle, transa, transb, m, n, k, alpha, Aarray, lda, Barray, ldb, beta, Carray, ldc, batchCount);
+}
 static cublasStatus_t cublas_axpy(cublasHandle_t handle, int n, const float* alpha, const float* x, int incx, float* y, int incy)
 {
     return cublasSaxpy(handle, n, alpha, x, incx, y, incy);
@@ -3586,6 +4487,69 @@ void GPUMatrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const GPUMatrix
     c.m_numCols = n;
 }
 
+// batched version of MultiplyAndWeightedAdd: c[i] = alpha * op(a[i]) * op(b[i]) + beta * c[i] for all i, in one launch.
+// All a[i] must have identical dimensions, likewise all b[i] and all c[i] (a cuBLAS batched-GEMM requirement);
+// this is the common case for per-sequence and per-lattice products, where one small GEMM per call
+// leaves most of the GPU idle.
+template <class ElemType>
+void GPUMatrix<ElemType>::MultiplyAndWeightedAddBatched(ElemType alpha, const std::vector<const GPUMatrix<ElemType>*>& a, const bool transposeA,
+                                                        const std::vector<const GPUMatrix<ElemType>*>& b, const bool transposeB,
+                                                        ElemType beta, const std::vector<GPUMatrix<ElemType>*>& c)
+{
+    if (a.size() != b.size() || a.size() != c.size())
+        InvalidArgument("MultiplyAndWeightedAddBatched: a, b, and c must contain the same number of matrices.");
+    size_t count = a.size();
+    if (count == 0)
+        return;
+    if (count == 1) // nothing to batch
+        return MultiplyAndWeightedAdd(alpha, *a[0], transposeA, *b[0], transposeB, beta, *c[0]);
+
+    a[0]->PrepareDevice();
+    DEVICEID_TYPE deviceId = a[0]->GetComputeDeviceId();
+
+    cublasHandle_t cuHandle = GetCublasHandle(deviceId);
+    cublasOperation_t transA = transposeA ? CUBLAS_OP_T : CUBLAS_OP_N;
+    cublasOperation_t transB = transposeB ? CUBLAS_OP_T : CUBLAS_OP_N;
+    int m = int(transposeA ? a[0]->m_numCols : a[0]->m_numRows);
+    int n = int(transposeB ? b[0]->m_numRows : b[0]->m_numCols);
+    int k = int(transposeA ? a[0]->m_numRows : a[0]->m_numCols);
+    int l = int(transposeB ? b[0]->m_numCols : b[0]->m_numRows);
+
+    if (!(m > 0 && k > 0 && l > 0 && n > 0))
+        RuntimeError("!(m>0 && k>0 && l>0 && n>0)"); // converting from size_t to int may cause overflow
+    if (k != l)
+        RuntimeError("matrix dim mismatch in MultiplyAndWeightedAddBatched");
+
+    // gather the operand pointers; one host array laid out as [a0..][b0..][c0..]
+    std::vector<const ElemType*> hostPtrs(3 * count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (a[i]->GetComputeDeviceId() != deviceId || b[i]->GetComputeDeviceId() != deviceId || c[i]->GetComputeDeviceId() != deviceId)
+            InvalidArgument("MultiplyAndWeightedAddBatched: all matrices must be on the same GPU");
+        if (a[i]->m_numRows != a[0]->m_numRows || a[i]->m_numCols != a[0]->m_numCols ||
+            b[i]->m_numRows != b[0]->m_numRows || b[i]->m_numCols != b[0]->m_numCols)
+            InvalidArgument("MultiplyAndWeightedAddBatched: all products in a batch must have identical dimensions");
+        if (beta == 0)
+            c[i]->Resize(m, n);
+        else
+            c[i]->VerifySize(m, n); // Can't resize if beta != 0
+        hostPtrs[i] = a[i]->m_pArray;
+        hostPtrs[count + i] = b[i]->m_pArray;
+        hostPtrs[2 * count + i] = c[i]->m_pArray;
+    }
+
+    // cuBLAS wants the pointer arrays in device memory
+    ElemType** devPtrs = nullptr;
+    CUDA_CALL(cudaMalloc((void**) &devPtrs, hostPtrs.size() * sizeof(ElemType*)));
+    CUDA_CALL(cudaMemcpy(devPtrs, hostPtrs.data(), hostPtrs.size() * sizeof(ElemType*), cudaMemcpyHostToDevice));
+    cublasStatus_t st = cublas_gemmBatched(cuHandle, transA, transB, m, n, k, &alpha,
+                                           (const ElemType**) devPtrs, (int) a[0]->m_numRows,
+                                           (const ElemType**) (devPtrs + count), (int) b[0]->m_numRows,
+                                           &beta, devPtrs + 2 * count, (int) c[0]->m_numRows, (int) count);
+    CUDA_CALL(cudaFree(devPtrs)); // (synchronizes, so freeing before the error check is fine)
+    CUBLAS_CALL(st);
+}
+
 template <class ElemType>
 void GPUMatrix<ElemType>::Multiply1x1AndWeightedAdd(ElemType alpha, const GPUMatrix<ElemType>& a, const GPUMatrix<ElemType>& b, ElemType beta, GPUMatrix<ElemType>& c)
 {
@@ -3992,6 +4956,145 @@ void GPUMatrix<ElemType>::AddScaledDifference(const GPUMatrix<ElemType>& alpha,
     }
 }
 
+/// <summary> c += alpha * (softmax(predictions) - labels)</summary>
+/// the softmax is reconstructed from the per-column max and log partition function saved by
+/// AssignCrossEntropyWithSoftmaxOf, rather than read from a full-size temporary
+/// <param name="alpha">1X1 matrix</param>
+/// <param name="predictions">Input matrix</param>
+/// <param name="softmaxStats">2 x cols matrix of per-column (max, log partition function)</param>
+/// <param name="labels">Input matrix</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+template <class ElemType>
+void GPUMatrix<ElemType>::AddScaledSoftmaxDifference(const GPUMatrix<ElemType>& alpha, const GPUMatrix<ElemType>& predictions, const GPUMatrix<ElemType>& softmaxStats, const GPUMatrix<ElemType>& labels, GPUMatrix<ElemType>& c, const GPUMatrix<char>* columnsValidityMask /*= nullptr*/)
+{
+    assert(alpha.GetNumElements() == 1);
+    if (!(alpha.GetNumElements() == 1))
+        InvalidArgument("AddScaledSoftmaxDifference:  alpha must be a 1X1 matrix.");
+
+    if (columnsValidityMask != nullptr && columnsValidityMask->GetNumCols() != c.GetNumCols())
+        InvalidArgument("AddScaledSoftmaxDifference:  c and column mask must have equal number of columns.");
+
+    if (predictions.GetComputeDeviceId() != c.GetComputeDeviceId())
+        InvalidArgument("All matrices must be on the same GPU");
+
+    if (!(predictions.GetNumRows() == labels.GetNumRows() && predictions.GetNumRows() == c.GetNumRows() &&
+          predictions.GetNumCols() == labels.GetNumCols() && predictions.GetNumCols() == c.GetNumCols()))
+    {
+        InvalidArgument("AddScaledSoftmaxDifference:  predictions, labels, and c must have same dimension.");
+    }
+
+    if (!(softmaxStats.GetNumRows() == 2 && softmaxStats.GetNumCols() == predictions.GetNumCols()))
+        InvalidArgument("AddScaledSoftmaxDifference:  softmaxStats must be a 2 x cols matrix.");
+
+    if (predictions.IsEmpty())
+        LogicError("AddScaledSoftmaxDifference:  Input matrix predictions is empty.");
+
+    predictions.PrepareDevice();
+    cudaEvent_t done = nullptr;
+    CUDA_LONG n = (CUDA_LONG) predictions.GetNumElements();
+    CUDA_LONG M = (CUDA_LONG) predictions.GetNumRows();
+    int blocksPerGrid = (int) ceil(1.0 * n / GridDim::maxThreadsPerBlock);
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _addScaledSoftmaxDifference<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(alpha.m_pArray, predictions.m_pArray, softmaxStats.m_pArray, labels.m_pArray, c.m_pArray, n, M,
+                                                                                                       columnsValidityMask != nullptr ? columnsValidityMask->m_pArray : nullptr);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+}
+
+/// <summary> c += alpha * (softmax(predictions) - onehot(labelIndexes))</summary>
+/// index-label variant of AddScaledSoftmaxDifference: the one-hot subtraction is folded into the
+/// kernel, and gap columns (negative index) get no gradient
+/// <param name="alpha">1X1 matrix</param>
+/// <param name="predictions">Input matrix</param>
+/// <param name="softmaxStats">2 x cols matrix of per-column (max, log partition function)</param>
+/// <param name="labelIndexes">1 x cols matrix of label classes (negative = gap)</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+template <class ElemType>
+void GPUMatrix<ElemType>::AddScaledIndexedSoftmaxDifference(const GPUMatrix<ElemType>& alpha, const GPUMatrix<ElemType>& predictions, const GPUMatrix<ElemType>& softmaxStats, const GPUMatrix<ElemType>& labelIndexes, GPUMatrix<ElemType>& c)
+{
+    assert(alpha.GetNumElements() == 1);
+    if (!(alpha.GetNumElements() == 1))
+        InvalidArgument("AddScaledIndexedSoftmaxDifference:  alpha must be a 1X1 matrix.");
+
+    if (predictions.GetComputeDeviceId() != c.GetComputeDeviceId())
+        InvalidArgument("All matrices must be on the same GPU");
+
+    if (!(predictions.GetNumRows() == c.GetNumRows() && predictions.GetNumCols() == c.GetNumCols()))
+        InvalidArgument("AddScaledIndexedSoftmaxDifference:  predictions and c must have same dimension.");
+
+    if (!(labelIndexes.GetNumRows() == 1 && labelIndexes.GetNumCols() == predictions.GetNumCols()))
+        InvalidArgument("AddScaledIndexedSoftmaxDifference:  labelIndexes must be a 1 x cols matrix.");
+
+    if (!(softmaxStats.GetNumRows() == 2 && softmaxStats.GetNumCols() == predictions.GetNumCols()))
+        InvalidArgument("AddScaledIndexedSoftmaxDifference:  softmaxStats must be a 2 x cols matrix.");
+
+    if (predictions.IsEmpty())
+        LogicError("AddScaledIndexedSoftmaxDifference:  Input matrix predictions is empty.");
+
+    predictions.PrepareDevice();
+    cudaEvent_t done = nullptr;
+    CUDA_LONG n = (CUDA_LONG) predictions.GetNumElements();
+    CUDA_LONG M = (CUDA_LONG) predictions.GetNumRows();
+    int blocksPerGrid = (int) ceil(1.0 * n / GridDim::maxThreadsPerBlock);
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _addScaledIndexedSoftmaxDifference<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(alpha.m_pArray, predictions.m_pArray, softmaxStats.m_pArray, labelIndexes.m_pArray, c.m_pArray, n, M);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+}
+
+/// <summary> c += alpha * weight * logsoftmax(predictions)</summary>
+/// the log-softmax is reconstructed from the per-column max and log partition function saved by
+/// AssignCrossEntropyWithSoftmaxOf
+/// <param name="alpha">Scalar</param>
+/// <param name="weight">1X1 matrix</param>
+/// <param name="predictions">Input matrix</param>
+/// <param name="softmaxStats">2 x cols matrix of per-column (max, log partition function)</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+template <class ElemType>
+void GPUMatrix<ElemType>::AddScaledLogSoftmax(const ElemType alpha, const GPUMatrix<ElemType>& weight, const GPUMatrix<ElemType>& predictions, const GPUMatrix<ElemType>& softmaxStats, GPUMatrix<ElemType>& c)
+{
+    assert(weight.GetNumElements() == 1);
+    if (!(weight.GetNumElements() == 1))
+        InvalidArgument("AddScaledLogSoftmax:  weight must be a 1X1 matrix.");
+
+    if (predictions.GetComputeDeviceId() != c.GetComputeDeviceId())
+        InvalidArgument("All matrices must be on the same GPU");
+
+    if (!(predictions.GetNumRows() == c.GetNumRows() && predictions.GetNumCols() == c.GetNumCols()))
+        InvalidArgument("AddScaledLogSoftmax:  predictions and c must have same dimension.");
+
+    if (!(softmaxStats.GetNumRows() == 2 && softmaxStats.GetNumCols() == predictions.GetNumCols()))
+        InvalidArgument("AddScaledLogSoftmax:  softmaxStats must be a 2 x cols matrix.");
+
+    if (predictions.IsEmpty())
+        LogicError("AddScaledLogSoftmax:  Input matrix predictions is empty.");
+
+    predictions.PrepareDevice();
+    cudaEvent_t done = nullptr;
+    CUDA_LONG n = (CUDA_LONG) predictions.GetNumElements();
+    CUDA_LONG M = (CUDA_LONG) predictions.GetNumRows();
+    int blocksPerGrid = (int) ceil(1.0 * n / GridDim::maxThreadsPerBlock);
+    if (do_sync)
+        CUDA_CALL(cudaEventCreate(&done));
+    _addScaledLogSoftmax<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, 0, t_stream>>>(alpha, weight.m_pArray, predictions.m_pArray, softmaxStats.m_pArray, c.m_pArray, n, M);
+    if (do_sync)
+        CUDA_CALL(cudaEventRecord(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventSynchronize(done));
+    if (do_sync)
+        CUDA_CALL(cudaEventDestroy(done));
+}
+
 /// <summary> c = alpha * (a-b)</summary>
 /// if a, b, c  must have same dim
 /// <param name="alpha">Scalar</param>
@@ -4342,21 +5445,35 @@ bool GPUMatrix<ElemType>::HasElement(const GPUMatrix<ElemType>& a, const ElemTyp
     return bResult;
 }
 
+// return the slot of the current device in the generator pool
+template <class ElemType>
+static int CurandDeviceSlot()
+{
+    int deviceId = 0;
+    CUDA_CALL(cudaGetDevice(&deviceId));
+    if (deviceId >= GPUMatrix<ElemType>::MaxGpus)
+        LogicError("CurandDeviceSlot: Maximum GPU exceeded");
+    return deviceId;
+}
+
 template <class ElemType>
 void GPUMatrix<ElemType>::CreateCurandObject(unsigned long seed, const char* caller)
 {
     assert(caller != nullptr);
 
-    if (s_curandGenerator == NULL)
+    // generators are pooled per device (curand state lives on the device that was
+    // current at creation), so the setup cost is paid once per device, not per call
+    int deviceId = CurandDeviceSlot<ElemType>();
+    if (s_curandGenerators[deviceId] == NULL)
     {
         unsigned long long cudaSeed = (seed == USE_TIME_BASED_SEED) ? time(NULL) : seed;
-        fprintf(stderr, "%s (GPU): creating curand object with seed %llu, sizeof(ElemType)==%u\n",
-                caller, cudaSeed, sizeof(ElemType));
-        s_curandGenerator = new curandGenerator_t;
+        fprintf(stderr, "%s (GPU %d): creating curand object with seed %llu, sizeof(ElemType)==%u\n",
+                caller, deviceId, cudaSeed, sizeof(ElemType));
+        s_curandGenerators[deviceId] = new curandGenerator_t;
         // Create pseudo-random number generator
-        CURAND_CALL(curandCreateGenerator(&(((curandGenerator_t*) s_curandGenerator)[0]), CURAND_RNG_PSEUDO_XORWOW));
-        CURAND_CALL(curandSetPseudoRandomGeneratorSeed(((curandGenerator_t*) s_curandGenerator)[0], cudaSeed));
-        CURAND_CALL(curandSetGeneratorOrdering(((curandGenerator_t*) s_curandGenerator)[0], CURAND_ORDERING_PSEUDO_SEEDED));
+        CURAND_CALL(curandCreateGenerator(&(((curandGenerator_t*) s_curandGenerators[deviceId])[0]), CURAND_RNG_PSEUDO_XORWOW));
+        CURAND_CALL(curandSetPseudoRandomGeneratorSeed(((curandGenerator_t*) s_curandGenerators[deviceId])[0], cudaSeed));
+        CURAND_CALL(curandSetGeneratorOrdering(((curandGenerator_t*) s_curandGenerators[deviceId])[0], CURAND_ORDERING_PSEUDO_SEEDED));
     }
 }
 
@@ -4365,11 +5482,12 @@ void GPUMatrix<ElemType>::ResetCurandObject(unsigned long seed, const char* call
 {
     assert(caller != nullptr);
 
-    if (s_curandGenerator && (seed != USE_TIME_BASED_SEED))
+    int deviceId = CurandDeviceSlot<ElemType>();
+    if (s_curandGenerators[deviceId] && (seed != USE_TIME_BASED_SEED))
     {
         // Note: this might be slow.
-        CURAND_CALL(curandSetPseudoRandomGeneratorSeed(((curandGenerator_t*) s_curandGenerator)[0], seed));
-        CURAND_CALL(curandSetGeneratorOffset(((curandGenerator_t*) s_curandGenerator)[0], 0));
+        CURAND_CALL(curandSetPseudoRandomGeneratorSeed(((curandGenerator_t*) s_curandGenerators[deviceId])[0], seed));
+        CURAND_CALL(curandSetGeneratorOffset(((curandGenerator_t*) s_curandGenerators[deviceId])[0], 0));
     }
     else
     {
@@ -4377,6 +5495,21 @@ void GPUMatrix<ElemType>::ResetCurandObject(unsigned long seed, const char* call
     }
 }
 
+// fetch the current device's persistent generator (create or re-seed as the mode demands)
+// and associate it with the compute stream, so generation is ordered with our kernels
+// without host-side event synchronization
+template <class ElemType>
+void* GPUMatrix<ElemType>::GetCurandGenerator(unsigned long seed, const char* caller)
+{
+    if (IsDeterministicComputation())
+        ResetCurandObject(seed, caller); // honor the seed argument on every call, so the result depends only on it and not on call history
+    else
+        CreateCurandObject(seed, caller); // TODO call ResetCurandObject() instead?
+    curandGenerator_t gen = ((curandGenerator_t*) s_curandGenerators[CurandDeviceSlot<ElemType>()])[0];
+    CURAND_CALL(curandSetStream(gen, t_stream));
+    return (void*) gen;
+}
+
 template <class ElemType>
 GPUMatrix<ElemType> GPUMatrix<ElemType>::Ones(const size_t rows, const size_t cols, int deviceId)
 {
@@ -4717,6 +5850,34 @@ ElemType GPUMatrix<ElemType>::LogAddSumOfElements() const
     return h_sum;
 }
 
+// forward recursion of the RCRF; the counterpart of RCRFBackwardCompute below. One kernel
+// launch per time step carries the recursion, so alpha and the transition scores stay
+// device-resident across the whole sequence.
+template <class ElemType>
+void GPUMatrix<ElemType>::RCRFForwardCompute(GPUMatrix<ElemType>& alpha,
+                                             const GPUMatrix<ElemType>& pos_scores,
+                                             const GPUMatrix<ElemType>& pair_scores,
+                                             const int startLbl)
+{
+    if (pos_scores.IsEmpty() || pair_scores.IsEmpty())
+        LogicError("RCRFForwardCompute: one of the input matrices is empty.");
+
+    size_t iNumLab = pos_scores.GetNumRows();
+    size_t iNumPos = pos_scores.GetNumCols();
+
+    pos_scores.PrepareDevice();
+    alpha.Resize(iNumLab, iNumPos);
+
+    CUDA_LONG N = iNumLab;
+    int blocksPerGrid = (int) ceil(1.0 * N / GridDim::maxThreadsPerBlock);
+    size_t szMemSize = sizeof(ElemType) * iNumLab;
+    for (int t = 0; t < iNumPos; t++)
+    {
+        _rcrfForwardCompute<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock, szMemSize>>>(t, alpha.m_pArray, pos_scores.m_pArray,
+                                                                                                 pair_scores.m_pArray, iNumLab, startLbl);
+    }
+}
+
 template <class ElemType>
 void GPUMatrix<ElemType>::RCRFBackwardCompute(
     const GPUMatrix<ElemType>& alpha, GPUMatrix<ElemType>& beta,
@@ -4912,7 +6073,7 @@ template <class ElemType>
 cublasHandle_t GPUMatrix<ElemType>::s_cuHandle[GPUMatrix<ElemType>::MaxGpus] = {0};
 
 template <class ElemType>
-void* GPUMatrix<ElemType>::s_curandGenerator = NULL;
+void* GPUMatrix<ElemType>::s_curandGenerators[GPUMatrix<ElemType>::MaxGpus] = {0};
 
 // We use Matrix<char> as the backing store for QuantizedMatrix
 // Let's explicitly instantiate the methods we need for that purpose
@@ -4933,16 +6094,34 @@ template void GPUMatrix<char>::SetValue(const char);
 template void GPUMatrix<char>::SetValue(const size_t numRows, const size_t numCols, int deviceId, char* pArray, size_t matrixFlags);
 template void GPUMatrix<char>::SetValue(GPUMatrix<char> const&);
 
+// We use Matrix<short> as the backing store for quantized inference weights; same drill as Matrix<char>
+template GPUMatrix<short>::GPUMatrix(const size_t numRows, const size_t numCols, int deviceId);
+template GPUMatrix<short>::GPUMatrix(const size_t numRows, const size_t numCols, int deviceId, short* pArray, const size_t matrixFlags);
+template GPUMatrix<short>::GPUMatrix(const GPUMatrix<short>&);
+template GPUMatrix<short>::GPUMatrix(GPUMatrix<short>&&);
+template short* GPUMatrix<short>::CopyToArray() const;
+template void GPUMatrix<short>::ChangeDeviceTo(int);
+template void GPUMatrix<short>::Resize(size_t, size_t, bool);
+template GPUMatrix<short>::~GPUMatrix();
+template GPUMatrix<short> GPUMatrix<short>::ColumnSlice(size_t startColumn, size_t numCols) const;
+template GPUMatrix<short>& GPUMatrix<short>::operator=(GPUMatrix<short>&&);
+template GPUMatrix<short>::GPUMatrix(int);
+template void GPUMatrix<short>::SetValue(const short);
+template void GPUMatrix<short>::SetValue(const size_t numRows, const size_t numCols, int deviceId, short* pArray, size_t matrixFlags);
+template void GPUMatrix<short>::SetValue(GPUMatrix<short> const&);
+
 template int* TracingGPUMemoryAllocator::Allocate<int>(int, size_t);
 template size_t* TracingGPUMemoryAllocator::Allocate<size_t>(int, size_t);
 template long* TracingGPUMemoryAllocator::Allocate<long>(int, size_t);
 template char* TracingGPUMemoryAllocator::Allocate<char>(int, size_t);
+template unsigned short* TracingGPUMemoryAllocator::Allocate<unsigned short>(int, size_t);
 template float* TracingGPUMemoryAllocator::Allocate<float>(int, size_t);
 template double* TracingGPUMemoryAllocator::Allocate<double>(int, size_t);
 
 template void TracingGPUMemoryAllocator::Free<int>(int, int*, bool);
 template void TracingGPUMemoryAllocator::Free<size_t>(int, size_t*, bool);
 template void TracingGPUMemoryAllocator::Free<char>(int, char*, bool);
+template void TracingGPUMemoryAllocator::Free<unsigned short>(int, unsigned short*, bool);
 template void TracingGPUMemoryAllocator::Free<float>(int, float*, bool);
 template void TracingGPUMemoryAllocator::Free<double>(int, double*, bool);
 }
@@ -46,6 +46,13 @@ typedef struct CUstream_st* cudaStream_t;
 void MATH_API SetStream(cudaStream_t stream);
 cudaStream_t MATH_API GetStream();
 
+// Stream pool: acquire a non-default stream owned by the Math library (to be made current via
+// SetStream()), and return it when done. Streams are created lazily once per device and then
+// reused, so independent computations can be issued on separate streams without paying stream
+// creation cost in the steady state.
+cudaStream_t MATH_API AcquireStream(int deviceId);
+void MATH_API ReleaseStream(int deviceId, cudaStream_t stream);
+
 namespace Microsoft { namespace MSR { namespace CNTK {
 
 // -----------------------------------------------------------------------
@@ -114,7 +121,7 @@ public:
 
 private:
     static cublasHandle_t s_cuHandle[MaxGpus];
-    static void* s_curandGenerator;
+    static void* s_curandGenerators[MaxGpus]; // persistent per-device curand generators, created lazily like the cublas handles
 
 // Have to use disable the warning to avoid issues with __declspec(dllexport) on Windows (C4251).
 // Also, NVCC FE corresponding warning has to be disabled, see MathCUDA.vcxproj.
@@ -154,6 +161,8 @@ public:
     ElemType* CopyToArray() const;                                              // allocated by the callee but need to be deleted by the caller
     size_t CopyToArray(ElemType*& arrayCopyTo, size_t& currentArraySize) const; // allocated by the callee but need to be deleted by the caller
     void CopySection(size_t numRows, size_t numCols, ElemType* dst, size_t colStride) const;
+    void CopyToFloat16Array(unsigned short* halfArray) const;                   // export as packed IEEE binary16 into a CPU array; caller allocates GetNumElements() entries
+    void SetValueFromFloat16Array(const size_t numRows, const size_t numCols, const unsigned short* halfArray);
 
     void ChangeDeviceTo(DEVICEID_TYPE to_id);
 
@@ -176,6 +185,7 @@ public:
     }
 
     ElemType Adagrad(GPUMatrix<ElemType>& gradients, const bool needAveMultiplier);
+    void AdagradUpdate(GPUMatrix<ElemType>& gradients, GPUMatrix<ElemType>& functionValues, const ElemType learnRatePerSample); // fused Adagrad + weight step
     void FSAdagrad(GPUMatrix<ElemType>& gradients, GPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight, ElemType adaMul);
     ElemType RmsProp(GPUMatrix<ElemType>& gradients, ElemType RMS_GAMMA, ElemType RMS_WGT_INC, ElemType RMS_WGT_MAX, ElemType RMS_WGT_DEC, ElemType RMS_WGT_MIN, const bool needAveMultiplier);
 
@@ -191,6 +201,7 @@ public:
         LogicError("GPUMatrix doesn't support this");
     }
     ElemType Get00Element() const;
+    ElemType GetValue(const size_t row, const size_t col) const; // single-element readback; no full-buffer transfer
 
     void SetValue(const ElemType v);
     void SetValue(const ElemType* d_v); // d_v is pointer to the the value in GPU memory
@@ -208,6 +219,11 @@ public:
     void SetGaussianRandomValue(const ElemType mean, const ElemType sigma, unsigned long seed = USE_TIME_BASED_SEED);
     void SetUniformRandomMask(const ElemType maskRate, const ElemType scaleValue, unsigned long seed = USE_TIME_BASED_SEED);
 
+    // fused dropout: the mask is regenerated from (randomSeed, offset + element index) on the fly
+    // and never materialized; 'offset' is the slice's first element within the full minibatch matrix
+    GPUMatrix<ElemType>& AssignDropoutOf(const GPUMatrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset);
+    GPUMatrix<ElemType>& AddDropoutGradientOf(const GPUMatrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset);
+
     GPUMatrix<ElemType> Transpose() const;
     GPUMatrix<ElemType>& AssignTransposeOf(const GPUMatrix<ElemType>& a);
 
@@ -272,6 +288,8 @@ public:
 
     GPUMatrix<ElemType>& InplaceLogSoftmax(const bool isColWise);
     GPUMatrix<ElemType>& AssignLogSoftmaxOf(const GPUMatrix<ElemType>& a, const bool isColWise);
+    GPUMatrix<ElemType>& AssignCrossEntropyWithSoftmaxOf(const GPUMatrix<ElemType>& labels, const GPUMatrix<ElemType>& predictions, GPUMatrix<ElemType>& softmaxStats, const GPUMatrix<char>* columnsValidityMask = nullptr); // softmaxStats is resized to 2 x cols; masked-out columns (gaps) are skipped
+    GPUMatrix<ElemType>& AssignIndexedCrossEntropyWithSoftmaxOf(const GPUMatrix<ElemType>& labelIndexes, const GPUMatrix<ElemType>& predictions, GPUMatrix<ElemType>& softmaxStats); // labelIndexes is 1 x cols (negative = gap); softmaxStats is resized to 2 x cols
 
     GPUMatrix<ElemType>& InplaceHardmax(const bool isColWise);
     GPUMatrix<ElemType>& AssignHardmaxOf(const GPUMatrix<ElemType>& a, const bool isColWise);
@@ -310,6 +328,7 @@ public:
     DeviceBoundNumber<ElemType> Sum_AsDeviceBoundNum() const;
     ElemType SumOfAbsElements() const; // sum of all abs(elements)
     ElemType SumOfElements() const;    // sum of all elements
+    void AccumulateAbsLogHistogram(int minExponent, GPUMatrix<ElemType>& histogram) const;
     GPUMatrix<ElemType>& AssignSumOfElements(const GPUMatrix<ElemType>& a);
 
     ElemType Max() const;
@@ -347,8 +366,14 @@ public:
     GPUMatrix<ElemType>& AddWithRowSliceValuesOf(const GPUMatrix<ElemType>& a, const size_t startIndex, const size_t numRows);
     // GPUMatrix<ElemType>&  AssignRowStackValuesOf(const std::vector<const GPUMatrix<ElemType>*>& inputMatrices, const size_t sliceStartCol, const size_t sliceNumCols);
 
+    GPUMatrix<ElemType>& AssignRowGatherOf(const GPUMatrix<ElemType>& idx, const GPUMatrix<ElemType>& a);
+    GPUMatrix<ElemType>& AddWithRowGatherOf(const GPUMatrix<ElemType>& idx, const GPUMatrix<ElemType>& a);
+    GPUMatrix<ElemType>& AddRowScatterOf(const GPUMatrix<ElemType>& idx, const GPUMatrix<ElemType>& a);
+
     GPUMatrix<ElemType>& AssignRepeatOf(const GPUMatrix<ElemType>& a, const size_t numRowRepeats, const size_t numColRepeats);
     GPUMatrix<ElemType>& AddToRowRepeatValuesOf(const GPUMatrix<ElemType>& a, const size_t numRowRepeats);
+    GPUMatrix<ElemType>& AssignGatheredColumnsOf(const GPUMatrix<ElemType>& a, const std::vector<size_t>& columnIndices);
+    GPUMatrix<ElemType>& ScatterGatheredColumnsOf(const GPUMatrix<ElemType>& packed, const std::vector<size_t>& columnIndices);
 
     GPUMatrix<ElemType>& AssignPositiveAndShiftedNegSample(const GPUMatrix<ElemType>& a, const size_t posNumber, const size_t negNumber, const size_t shiftNumber);
     GPUMatrix<ElemType>& AddFoldedPositiveAndShiftedNegSample(const GPUMatrix<ElemType>& a, const size_t posNumber, const size_t negNumber, const size_t shiftNumber);
@@ -358,6 +383,7 @@ public:
     void VectorMin(GPUMatrix<ElemType>& minIndexes, GPUMatrix<ElemType>& minValues, const bool isColWise) const;
 
     GPUMatrix<ElemType>& AssignNumOfDiff(const GPUMatrix<ElemType>& a, const GPUMatrix<ElemType>& b, bool searchInCol = false);
+    GPUMatrix<ElemType>& AssignTopKError(const GPUMatrix<ElemType>& labels, const GPUMatrix<ElemType>& predictions, const int topK);
 
     GPUMatrix<ElemType>& AssignInnerProductOfMatrices(const GPUMatrix<ElemType>& a, const GPUMatrix<ElemType>& b);
 
@@ -387,6 +413,21 @@ public:
                                                 const size_t inputWidth, const size_t inputHeight, const size_t inputSizePerSample,
                                                 const size_t outputWidth, const size_t outputHeight, const size_t outputSizePerSample,
                                                 const size_t windowWidth, const size_t windowHeight, const size_t horizontalSubsample, const size_t verticalSubsample);
+    // fused batch normalization over the columns of 'this' (one sample per column); the statistics
+    // dimension is taken from 'scale' (== rows for per-activation, channels for spatial mode)
+    void BatchNormalizationForward(const GPUMatrix<ElemType>& scale, const GPUMatrix<ElemType>& bias,
+                                   double expAvgFactor, double epsilon,
+                                   GPUMatrix<ElemType>& runMean, GPUMatrix<ElemType>& runInvStdDev,
+                                   GPUMatrix<ElemType>& out,
+                                   GPUMatrix<ElemType>& saveMean, GPUMatrix<ElemType>& saveInvStdDev) const;
+    void BatchNormalizationForwardInference(const GPUMatrix<ElemType>& scale, const GPUMatrix<ElemType>& bias,
+                                            const GPUMatrix<ElemType>& runMean, const GPUMatrix<ElemType>& runInvStdDev,
+                                            GPUMatrix<ElemType>& out) const;
+    void BatchNormalizationBackward(const GPUMatrix<ElemType>& in, GPUMatrix<ElemType>& grad,
+                                    const GPUMatrix<ElemType>& scale,
+                                    const GPUMatrix<ElemType>& saveMean, const GPUMatrix<ElemType>& saveInvStdDev,
+                                    GPUMatrix<ElemType>& scaleGrad, GPUMatrix<ElemType>& biasGrad) const;
+
     GPUMatrix<ElemType>& AddMaxPoolingGradient(const GPUMatrix<ElemType>& outputGradientBatch, const GPUMatrix<ElemType>& inputBatch, const GPUMatrix<ElemType>& outputBatch,
                                                const size_t channels,
                                                const size_t inputWidth, const size_t inputHeight, const size_t inputSizePerSample,
@@ -405,6 +446,7 @@ public:
 public:
     // static BLAS functions
     static void MultiplyAndWeightedAdd(ElemType alpha, const GPUMatrix<ElemType>& a, const bool transposeA, const GPUMatrix<ElemType>& b, const bool transposeB, ElemType beta, GPUMatrix<ElemType>& c);
+    static void MultiplyAndWeightedAddBatched(ElemType alpha, const std::vector<const GPUMatrix<ElemType>*>& a, const bool transposeA, const std::vector<const GPUMatrix<ElemType>*>& b, const bool transposeB, ElemType beta, const std::vector<GPUMatrix<ElemType>*>& c);
     static void MultiplyAndAdd(const GPUMatrix<ElemType>& a, const bool transposeA, const GPUMatrix<ElemType>& b, const bool transposeB, GPUMatrix<ElemType>& c);
     static void Multiply(const GPUMatrix<ElemType>& a, const bool transposeA, const GPUMatrix<ElemType>& b, const bool transposeB, GPUMatrix<ElemType>& c);
     static void Multiply(const GPUMatrix<ElemType>& a, const GPUMatrix<ElemType>& b, GPUMatrix<ElemType>& c);
@@ -416,6 +458,9 @@ public:
     static void AssignScaledDifference(const ElemType alpha, const GPUMatrix<ElemType>& a, const GPUMatrix<ElemType>& b, GPUMatrix<ElemType>& c);
     static void AddScaledDifference(const GPUMatrix<ElemType>& alpha, const GPUMatrix<ElemType>& a, const GPUMatrix<ElemType>& b, GPUMatrix<ElemType>& c);
     static void AssignScaledDifference(const GPUMatrix<ElemType>& alpha, const GPUMatrix<ElemType>& a, const GPUMatrix<ElemType>& b, GPUMatrix<ElemType>& c);
+    static void AddScaledSoftmaxDifference(const GPUMatrix<ElemType>& alpha, const GPUMatrix<ElemType>& predictions, const GPUMatrix<ElemType>& softmaxStats, const GPUMatrix<ElemType>& labels, GPUMatrix<ElemType>& c, const GPUMatrix<char>* columnsValidityMask = nullptr); // alpha must be 1X1
+    static void AddScaledIndexedSoftmaxDifference(const GPUMatrix<ElemType>& alpha, const GPUMatrix<ElemType>& predictions, const GPUMatrix<ElemType>& softmaxStats, const GPUMatrix<ElemType>& labelIndexes, GPUMatrix<ElemType>& c); // alpha must be 1X1; labelIndexes is 1 x cols (negative = gap)
+    static void AddScaledLogSoftmax(const ElemType alpha, const GPUMatrix<ElemType>& weight, const GPUMatrix<ElemType>& predictions, const GPUMatrix<ElemType>& softmaxStats, GPUMatrix<ElemType>& c); // weight must be 1X1
 
     static void AddElementToElement(const GPUMatrix<ElemType>& a, const size_t ai, const size_t aj, GPUMatrix<ElemType>& c, const size_t ci, const size_t cj);
 
@@ -448,6 +493,7 @@ public:
 
     static void CreateCurandObject(unsigned long seed, const char* caller);
     static void ResetCurandObject(unsigned long seed, const char* caller);
+    static void* GetCurandGenerator(unsigned long seed, const char* caller); // current device's generator as an opaque curandGenerator_t, created/re-seeded as needed
     static GPUMatrix<ElemType> Ones(const size_t rows, const size_t cols, int deviceId);
     static GPUMatrix<ElemType> Zeros(const size_t rows, const size_t cols, int deviceId);
     static GPUMatrix<ElemType> Eye(const size_t rows, int deviceId);
@@ -469,6 +515,10 @@ public:
     GPUMatrix<ElemType>& AssignElementProductOfWithShift(const GPUMatrix<ElemType>& a, const GPUMatrix<ElemType>& b, const size_t shift);
 
 public:
+    static void RCRFForwardCompute(GPUMatrix<ElemType>& alpha,
+                                   const GPUMatrix<ElemType>& pos_scores,
+                                   const GPUMatrix<ElemType>& pair_scores,
+                                   const int startLbl);
     static void RCRFBackwardCompute(
         const GPUMatrix<ElemType>& alpha, GPUMatrix<ElemType>& beta,
         const GPUMatrix<ElemType>& lbls,
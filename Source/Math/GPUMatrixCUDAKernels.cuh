@@ -173,6 +173,197 @@ struct GridDim
 #define UNUSED_FUNCTION_ATTRIBUTE
 #endif
 
+// ===========================================================================
+// warp-level reduction primitives
+//
+// These replace the older one-block-per-column shared-memory trees. On sm_30+
+// partial values are exchanged directly between the registers of a warp with
+// shuffle instructions; on older devices we fall back to a volatile
+// shared-memory ladder. Column-wise consumers (softmax, norms, max) stride
+// down a column with one warp or one block, so global loads stay coalesced.
+// ===========================================================================
+
+static const int CUDA_WARP_SIZE = 32;
+
+#if __CUDA_ARCH__ >= 300
+// __shfl_xor() has no 'double' overload on the CUDA versions we build with
+static __inline__ __device__ float ShflXor(float val, int lanemask)
+{
+    return __shfl_xor(val, lanemask);
+}
+static __inline__ __device__ double ShflXor(double val, int lanemask)
+{
+    int hi = __shfl_xor(__double2hiint(val), lanemask);
+    int lo = __shfl_xor(__double2loint(val), lanemask);
+    return __hiloint2double(hi, lo);
+}
+static __inline__ __device__ int ShflXor(int val, int lanemask)
+{
+    return __shfl_xor(val, lanemask);
+}
+#endif
+
+// reduce 'val' over the calling warp; every lane returns the full result.
+// The warp must be fully active (no divergent early exit within the warp).
+template <class ElemType>
+static __inline__ __device__ ElemType WarpReduceSum(ElemType val)
+{
+#if __CUDA_ARCH__ >= 300
+    for (int lanemask = CUDA_WARP_SIZE / 2; lanemask > 0; lanemask >>= 1)
+        val += ShflXor(val, lanemask);
+#else
+    __shared__ volatile ElemType scratch[GridDim::maxThreadsPerBlock];
+    const int lane = threadIdx.x & (CUDA_WARP_SIZE - 1);
+    scratch[threadIdx.x] = val;
+    for (int delta = CUDA_WARP_SIZE / 2; delta > 0; delta >>= 1)
+    {
+        if (lane < delta)
+            scratch[threadIdx.x] = val = val + scratch[threadIdx.x + delta];
+    }
+    val = scratch[threadIdx.x - lane]; // broadcast lane 0's result to the whole warp
+#endif
+    return val;
+}
+
+template <class ElemType>
+static __inline__ __device__ ElemType WarpReduceMax(ElemType val)
+{
+#if __CUDA_ARCH__ >= 300
+    for (int lanemask = CUDA_WARP_SIZE / 2; lanemask > 0; lanemask >>= 1)
+        val = max(val, ShflXor(val, lanemask));
+#else
+    __shared__ volatile ElemType scratch[GridDim::maxThreadsPerBlock];
+    const int lane = threadIdx.x & (CUDA_WARP_SIZE - 1);
+    scratch[threadIdx.x] = val;
+    for (int delta = CUDA_WARP_SIZE / 2; delta > 0; delta >>= 1)
+    {
+        if (lane < delta)
+            scratch[threadIdx.x] = val = max(val, (ElemType) scratch[threadIdx.x + delta]);
+    }
+    val = scratch[threadIdx.x - lane];
+#endif
+    return val;
+}
+
+// reduce 'val' over the whole block; every thread returns the full result.
+// 'partials' must hold one element per warp (blockDim.x / CUDA_WARP_SIZE), and all
+// threads of the block must reach the call (it synchronizes internally).
+template <class ElemType>
+static __inline__ __device__ ElemType BlockReduceSum(ElemType val, ElemType* partials)
+{
+    const int lane = threadIdx.x & (CUDA_WARP_SIZE - 1);
+    const int warp = threadIdx.x / CUDA_WARP_SIZE;
+    const int numWarps = blockDim.x / CUDA_WARP_SIZE;
+
+    val = WarpReduceSum(val);
+    if (lane == 0)
+        partials[warp] = val;
+    __syncthreads();
+
+    if (warp == 0)
+    {
+        val = (lane < numWarps) ? partials[lane] : 0;
+        val = WarpReduceSum(val);
+        if (lane == 0)
+            partials[0] = val;
+    }
+    __syncthreads();
+
+    val = partials[0];
+    __syncthreads(); // so that the caller may reuse 'partials' right away
+    return val;
+}
+
+template <class ElemType>
+static __inline__ __device__ ElemType BlockReduceMax(ElemType val, ElemType* partials)
+{
+    const int lane = threadIdx.x & (CUDA_WARP_SIZE - 1);
+    const int warp = threadIdx.x / CUDA_WARP_SIZE;
+    const int numWarps = blockDim.x / CUDA_WARP_SIZE;
+
+    val = WarpReduceMax(val);
+    if (lane == 0)
+        partials[warp] = val;
+    __syncthreads();
+
+    if (warp == 0)
+    {
+        val = (lane < numWarps) ? partials[lane] : partials[0];
+        val = WarpReduceMax(val);
+        if (lane == 0)
+            partials[0] = val;
+    }
+    __syncthreads();
+
+    val = partials[0];
+    __syncthreads();
+    return val;
+}
+
+// block-wide arg-max (IsMax) or arg-min: reduces (val, idx) pairs in place; idx == -1
+// marks a lane that contributed nothing. 'partials'/'partialsInd' must hold one entry
+// per warp, and all threads of the block must reach the call. On return, thread 0
+// holds the block-wide result (the other threads' values are partial only).
+template <class ElemType, bool IsMax>
+static __inline__ __device__ void BlockReduceArgMaxMin(ElemType& val, int& idx, ElemType* partials, int* partialsInd)
+{
+    const int lane = threadIdx.x & (CUDA_WARP_SIZE - 1);
+    const int warp = threadIdx.x / CUDA_WARP_SIZE;
+    const int numWarps = blockDim.x / CUDA_WARP_SIZE;
+
+#if __CUDA_ARCH__ >= 300
+    for (int lanemask = CUDA_WARP_SIZE / 2; lanemask > 0; lanemask >>= 1)
+    {
+        ElemType otherVal = ShflXor(val, lanemask);
+        int otherIdx = ShflXor(idx, lanemask);
+        if (otherIdx != -1 && ((IsMax ? otherVal > val : otherVal < val) || idx == -1))
+        {
+            val = otherVal;
+            idx = otherIdx;
+        }
+    }
+#else
+    __shared__ volatile ElemType scratch[GridDim::maxThreadsPerBlock];
+    __shared__ volatile int scratchInd[GridDim::maxThreadsPerBlock];
+    scratch[threadIdx.x] = val;
+    scratchInd[threadIdx.x] = idx;
+    for (int delta = CUDA_WARP_SIZE / 2; delta > 0; delta >>= 1)
+    {
+        if (lane < delta)
+        {
+            ElemType otherVal = scratch[threadIdx.x + delta];
+            int otherIdx = scratchInd[threadIdx.x + delta];
+            if (otherIdx != -1 && ((IsMax ? otherVal > val : otherVal < val) || idx == -1))
+            {
+                scratch[threadIdx.x] = val = otherVal;
+                scratchInd[threadIdx.x] = idx = otherIdx;
+            }
+        }
+    }
+    val = scratch[threadIdx.x - lane];
+    idx = scratchInd[threadIdx.x - lane];
+#endif
+
+    if (lane == 0)
+    {
+        partials[warp] = val;
+        partialsInd[warp] = idx;
+    }
+    __syncthreads();
+
+    if (threadIdx.x == 0)
+    {
+        for (int w = 1; w < numWarps; w++)
+        {
+            if (partialsInd[w] != -1 && ((IsMax ? partials[w] > val : partials[w] < val) || idx == -1))
+            {
+                val = partials[w];
+                idx = partialsInd[w];
+            }
+        }
+    }
+}
+
 // ===========================================================================
 // CUDA kernels follow, lots of them
 // ===========================================================================
@@ -384,6 +575,26 @@ __global__ void _setValue(
     a[id] = d_v[0];
 };
 
+// pack values into IEEE binary16 bit patterns (round to nearest even); used for half-precision storage/transfer
+template <class ElemType>
+__global__ void _copyToFloat16(unsigned short* dest, const ElemType* src, const CUDA_LONG N)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+    dest[id] = __float2half_rn((float) src[id]);
+}
+
+// expand IEEE binary16 bit patterns back to full precision
+template <class ElemType>
+__global__ void _copyFromFloat16(ElemType* dest, const unsigned short* src, const CUDA_LONG N)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+    dest[id] = (ElemType) __half2float(src[id]);
+}
+
 template <class ElemType>
 __global__ void _copyColumnsStrided(ElemType* dest, ElemType* src, CUDA_LONG N, CUDA_LONG numRows, CUDA_LONG destNumColsStride, CUDA_LONG srcNumColsStride)
 {
@@ -451,6 +662,52 @@ __global__ void _addWithRowSliceValuesOf(ElemType* dest, ElemType* src, const CU
     dest[id] += src[IDX2C(row + startIndex, col, srcRows)];
 }
 
+// gather/scatter by a row-index matrix
+// 'idx' holds row indices into the larger matrix, stored as ElemType. It has either a single
+// column (the same indices apply to every minibatch column) or one column per minibatch
+// column (per-frame indices, idxCols == #cols); the kernels branch on idxCols for that.
+template <class ElemType>
+__global__ void _assignRowGatherOf(ElemType* dest, const ElemType* idx, const CUDA_LONG idxCols, const ElemType* src, const CUDA_LONG N, const CUDA_LONG destRows, const CUDA_LONG srcRows)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+
+    CUDA_LONG col = id / destRows;
+    CUDA_LONG row = id - (col * destRows);
+    CUDA_LONG srcRow = (CUDA_LONG) idx[IDX2C(row, idxCols == 1 ? 0 : col, destRows)];
+
+    dest[id] = src[IDX2C(srcRow, col, srcRows)];
+}
+
+template <class ElemType>
+__global__ void _addWithRowGatherOf(ElemType* dest, const ElemType* idx, const CUDA_LONG idxCols, const ElemType* src, const CUDA_LONG N, const CUDA_LONG destRows, const CUDA_LONG srcRows)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+
+    CUDA_LONG col = id / destRows;
+    CUDA_LONG row = id - (col * destRows);
+    CUDA_LONG srcRow = (CUDA_LONG) idx[IDX2C(row, idxCols == 1 ? 0 : col, destRows)];
+
+    dest[id] += src[IDX2C(srcRow, col, srcRows)];
+}
+
+template <class ElemType>
+__global__ void _addRowScatterOf(ElemType* dest, const ElemType* idx, const CUDA_LONG idxCols, const ElemType* src, const CUDA_LONG N, const CUDA_LONG destRows, const CUDA_LONG srcRows)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+
+    CUDA_LONG col = id / srcRows; // src is the small matrix here; rows are scattered into dest
+    CUDA_LONG row = id - (col * srcRows);
+    CUDA_LONG destRow = (CUDA_LONG) idx[IDX2C(row, idxCols == 1 ? 0 : col, srcRows)];
+
+    atomicAdd(&dest[IDX2C(destRow, col, destRows)], src[id]); // atomic: indices may repeat within a column
+}
+
 template <class ElemType>
 __global__ void _assignToDiagonalValuesOf(ElemType* dest, ElemType* src, const CUDA_LONG N, const CUDA_LONG srcCols)
 {
@@ -502,6 +759,36 @@ __global__ void _assignRepeatOf(ElemType* dest, ElemType* src, const CUDA_LONG N
     dest[id] = src[IDX2C(srcRow, srcCol, srcRows)];
 }
 
+// pack the columns listed in columnIndices contiguously into dest (dest column j = src column columnIndices[j])
+// used to compact gap columns out of a minibatch before compute-heavy operations
+template <class ElemType>
+__global__ void _gatherColumns(ElemType* dest, const ElemType* src, const size_t* columnIndices, const CUDA_LONG rows, const CUDA_LONG N)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+
+    CUDA_LONG col = id / rows;
+    CUDA_LONG row = id - (col * rows);
+
+    dest[id] = src[IDX2C(row, columnIndices[col], rows)];
+}
+
+// inverse of _gatherColumns: spread the packed columns of src back out (dest column columnIndices[j] = src column j)
+// columns of dest not listed in columnIndices are left untouched
+template <class ElemType>
+__global__ void _scatterColumns(ElemType* dest, const ElemType* src, const size_t* columnIndices, const CUDA_LONG rows, const CUDA_LONG N)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+
+    CUDA_LONG col = id / rows;
+    CUDA_LONG row = id - (col * rows);
+
+    dest[IDX2C(row, columnIndices[col], rows)] = src[id];
+}
+
 template <class ElemType>
 __global__ void _addToRowRepeatValuesOf(ElemType* dest, ElemType* src, const CUDA_LONG N, const CUDA_LONG srcRows, const CUDA_LONG srcCols, const CUDA_LONG destRows)
 {
@@ -838,7 +1125,7 @@ __global__ void _logSoftMaxColWise(
 //    }
 //}
 
-// each block processes one column. There must be 512 threads in a block
+// each block processes one column, reducing max and sum with the warp-shuffle primitives
 template <class ElemType>
 __global__ void _assignColumnwiseLogSoftmaxOf(
     const ElemType* a,
@@ -846,130 +1133,253 @@ __global__ void _assignColumnwiseLogSoftmaxOf(
     const CUDA_LONG m_numCols,
     const CUDA_LONG m_numRows)
 {
-    // We first find max per column
-    __shared__ ElemType colMax[1];
-    __shared__ ElemType partials[512];
-    colMax[0] = -10000000;
-    partials[threadIdx.x] = -10000000;
+    __shared__ ElemType partials[GridDim::maxWarpsPerBlock];
 
-    for (int i = threadIdx.x; i < m_numRows; i += 512)
+    // we first find max per column
+    ElemType colMax = -10000000;
+    for (CUDA_LONG i = threadIdx.x; i < m_numRows; i += blockDim.x)
+        colMax = max(colMax, a[IDX2C(i, blockIdx.x, m_numRows)]);
+    colMax = BlockReduceMax(colMax, partials);
+
+    // now the log of the sum of exponentials, writing the shifted values as we go
+    ElemType colSum = 0;
+    for (CUDA_LONG i = threadIdx.x; i < m_numRows; i += blockDim.x)
     {
-        partials[threadIdx.x] = max(partials[threadIdx.x], a[IDX2C(i, blockIdx.x, m_numRows)]);
+        ElemType tmp = a[IDX2C(i, blockIdx.x, m_numRows)] - colMax;
+        us[IDX2C(i, blockIdx.x, m_numRows)] = tmp;
+        colSum += (sizeof(ElemType) == sizeof(float)) ? expf(tmp) : exp(tmp);
     }
-    __syncthreads();
+    colSum = BlockReduceSum(colSum, partials);
+    colSum = (sizeof(ElemType) == sizeof(float)) ? logf(colSum) : log(colSum);
 
-    if (threadIdx.x < 256)
+    for (CUDA_LONG i = threadIdx.x; i < m_numRows; i += blockDim.x)
+        us[IDX2C(i, blockIdx.x, m_numRows)] -= colSum;
+}
+
+// variant of _assignColumnwiseLogSoftmaxOf for narrow columns: one warp per column, so
+// a block covers blockDim.x / CUDA_WARP_SIZE columns and reductions never leave the warp
+template <class ElemType>
+__global__ void _assignColumnwiseLogSoftmaxOfNarrow(
+    const ElemType* a,
+    ElemType* us,
+    const CUDA_LONG m_numCols,
+    const CUDA_LONG m_numRows)
+{
+    const int lane = threadIdx.x & (CUDA_WARP_SIZE - 1);
+    const CUDA_LONG col = blockIdx.x * (blockDim.x / CUDA_WARP_SIZE) + threadIdx.x / CUDA_WARP_SIZE;
+    if (col >= m_numCols)
+        return;
+
+    ElemType colMax = -10000000;
+    for (CUDA_LONG i = lane; i < m_numRows; i += CUDA_WARP_SIZE)
+        colMax = max(colMax, a[IDX2C(i, col, m_numRows)]);
+    colMax = WarpReduceMax(colMax);
+
+    ElemType colSum = 0;
+    for (CUDA_LONG i = lane; i < m_numRows; i += CUDA_WARP_SIZE)
     {
-        partials[threadIdx.x] = max(partials[threadIdx.x + 256], partials[threadIdx.x]);
+        ElemType tmp = a[IDX2C(i, col, m_numRows)] - colMax;
+        us[IDX2C(i, col, m_numRows)] = tmp;
+        colSum += (sizeof(ElemType) == sizeof(float)) ? expf(tmp) : exp(tmp);
     }
-    __syncthreads();
+    colSum = WarpReduceSum(colSum);
+    colSum = (sizeof(ElemType) == sizeof(float)) ? logf(colSum) : log(colSum);
 
-    if (threadIdx.x < 128)
+    for (CUDA_LONG i = lane; i < m_numRows; i += CUDA_WARP_SIZE)
+        us[IDX2C(i, col, m_numRows)] -= colSum;
+}
+
+// fused softmax + cross entropy forward: one block per column
+// writes the per-column max and log partition function into softmaxStats (2 x cols), so that the
+// backward pass can reconstruct the softmax without a full-size temporary, and accumulates
+// -sum(labels .* logsoftmax(predictions)) into crossEntropy (1x1, zero-initialized by the caller)
+template <class ElemType>
+__global__ void _assignCrossEntropyWithSoftmaxOf(
+    const ElemType* labels,
+    const ElemType* predictions,
+    ElemType* softmaxStats,
+    ElemType* crossEntropy,
+    const CUDA_LONG m_numCols,
+    const CUDA_LONG m_numRows,
+    const char* colsValidity) // per-column validity flags (may be NULL); 0 marks a gap column
+{
+    __shared__ ElemType partials[512];
+
+    // gap column: contributes nothing; the stats are never used for a real gradient, but
+    // keep them defined so downstream arithmetic stays finite
+    if (colsValidity != NULL && colsValidity[blockIdx.x] == 0)
     {
-        partials[threadIdx.x] = max(partials[threadIdx.x + 128], partials[threadIdx.x]);
+        if (threadIdx.x == 0)
+        {
+            softmaxStats[IDX2C(0, blockIdx.x, 2)] = 0;
+            softmaxStats[IDX2C(1, blockIdx.x, 2)] = 0;
+        }
+        return;
     }
-    __syncthreads();
 
-    if (threadIdx.x < 64)
+    // we need to extract max before applying exp to avoid overflow
+    partials[threadIdx.x] = -10000000;
+    for (int i = threadIdx.x; i < m_numRows; i += 512)
     {
-        partials[threadIdx.x] = max(partials[threadIdx.x + 64], partials[threadIdx.x]);
+        partials[threadIdx.x] = max(partials[threadIdx.x], predictions[IDX2C(i, blockIdx.x, m_numRows)]);
     }
     __syncthreads();
 
-    if (threadIdx.x < 32)
+    int nTotalThreads = blockDim.x;
+    while (nTotalThreads > 1)
     {
-        partials[threadIdx.x] = max(partials[threadIdx.x + 32], partials[threadIdx.x]);
+        int halfPoint = (nTotalThreads >> 1);
+
+        if (threadIdx.x < halfPoint)
+            partials[threadIdx.x] = max(partials[threadIdx.x], partials[threadIdx.x + halfPoint]);
+
+        __syncthreads();
+
+        nTotalThreads = (nTotalThreads >> 1);
     }
-    __syncthreads();
 
-    if (threadIdx.x < 16)
+    __shared__ ElemType colMax[1];
+    if (threadIdx.x == 0)
     {
-        partials[threadIdx.x] = max(partials[threadIdx.x + 16], partials[threadIdx.x]);
+        colMax[0] = partials[0];
     }
     __syncthreads();
 
-    if (threadIdx.x < 8)
+    // now the log partition function
+    partials[threadIdx.x] = 0;
+    for (int i = threadIdx.x; i < m_numRows; i += 512)
     {
-        partials[threadIdx.x] = max(partials[threadIdx.x + 8], partials[threadIdx.x]);
+        ElemType tmp = predictions[IDX2C(i, blockIdx.x, m_numRows)] - colMax[0];
+        partials[threadIdx.x] += (sizeof(ElemType) == sizeof(float)) ? expf(tmp) : exp(tmp);
     }
     __syncthreads();
 
-    if (threadIdx.x < 4)
+    nTotalThreads = blockDim.x;
+    while (nTotalThreads > 1)
     {
-        partials[threadIdx.x] = max(partials[threadIdx.x + 4], partials[threadIdx.x]);
+        int halfPoint = (nTotalThreads >> 1);
+
+        if (threadIdx.x < halfPoint)
+            partials[threadIdx.x] += partials[threadIdx.x + halfPoint];
+
+        __syncthreads();
+
+        nTotalThreads = (nTotalThreads >> 1);
     }
-    __syncthreads();
 
+    __shared__ ElemType colLogZ[1];
     if (threadIdx.x == 0)
     {
-        colMax[0] = max(max(partials[0], partials[1]), max(partials[2], partials[3]));
+        colLogZ[0] = (sizeof(ElemType) == sizeof(float)) ? logf(partials[0]) : log(partials[0]);
+        softmaxStats[IDX2C(0, blockIdx.x, 2)] = colMax[0];
+        softmaxStats[IDX2C(1, blockIdx.x, 2)] = colLogZ[0];
     }
-    partials[threadIdx.x] = 0.0f;
     __syncthreads();
 
-    // Now start finding sums
-    __shared__ ElemType colSum[1];
-    colSum[0] = 0.0f;
+    // now sum up the objective function; zero label entries (including columns whose labels
+    // were masked to zero for gaps) contribute nothing
+    partials[threadIdx.x] = 0;
     for (int i = threadIdx.x; i < m_numRows; i += 512)
     {
-        ElemType tmp = a[IDX2C(i, blockIdx.x, m_numRows)] - colMax[0];
-        us[IDX2C(i, blockIdx.x, m_numRows)] = tmp;
-        partials[threadIdx.x] += (sizeof(ElemType) == sizeof(float)) ? expf(tmp) : exp(tmp);
+        ElemType lbl = labels[IDX2C(i, blockIdx.x, m_numRows)];
+        if (lbl != 0)
+            partials[threadIdx.x] += lbl * (predictions[IDX2C(i, blockIdx.x, m_numRows)] - colMax[0] - colLogZ[0]);
     }
     __syncthreads();
 
-    if (threadIdx.x < 256)
+    nTotalThreads = blockDim.x;
+    while (nTotalThreads > 1)
     {
-        partials[threadIdx.x] += partials[threadIdx.x + 256];
+        int halfPoint = (nTotalThreads >> 1);
+
+        if (threadIdx.x < halfPoint)
+            partials[threadIdx.x] += partials[threadIdx.x + halfPoint];
+
+        __syncthreads();
+
+        nTotalThreads = (nTotalThreads >> 1);
     }
-    __syncthreads();
 
-    if (threadIdx.x < 128)
+    if (threadIdx.x == 0)
     {
-        partials[threadIdx.x] += partials[threadIdx.x + 128];
+        atomicAdd(crossEntropy, -partials[0]);
     }
-    __syncthreads();
+}
 
-    if (threadIdx.x < 64)
+// index-label variant of _assignCrossEntropyWithSoftmaxOf: one block per column; labelIndexes
+// holds the label class per column (negative = gap, which contributes nothing), so no one-hot
+// label matrix is ever read
+template <class ElemType>
+__global__ void _assignIndexedCrossEntropyWithSoftmaxOf(
+    const ElemType* labelIndexes,
+    const ElemType* predictions,
+    ElemType* softmaxStats,
+    ElemType* crossEntropy,
+    const CUDA_LONG m_numCols,
+    const CUDA_LONG m_numRows)
+{
+    __shared__ ElemType partials[512];
+
+    // we need to extract max before applying exp to avoid overflow
+    partials[threadIdx.x] = -10000000;
+    for (int i = threadIdx.x; i < m_numRows; i += 512)
     {
-        partials[threadIdx.x] += partials[threadIdx.x + 64];
+        partials[threadIdx.x] = max(partials[threadIdx.x], predictions[IDX2C(i, blockIdx.x, m_numRows)]);
     }
     __syncthreads();
 
-    if (threadIdx.x < 32)
+    int nTotalThreads = blockDim.x;
+    while (nTotalThreads > 1)
     {
-        partials[threadIdx.x] += partials[threadIdx.x + 32];
+        int halfPoint = (nTotalThreads >> 1);
+
+        if (threadIdx.x < halfPoint)
+            partials[threadIdx.x] = max(partials[threadIdx.x], partials[threadIdx.x + halfPoint]);
+
+        __syncthreads();
+
+        nTotalThreads = (nTotalThreads >> 1);
     }
-    __syncthreads();
 
-    if (threadIdx.x < 16)
+    __shared__ ElemType colMax[1];
+    if (threadIdx.x == 0)
     {
-        partials[threadIdx.x] += partials[threadIdx.x + 16];
+        colMax[0] = partials[0];
     }
     __syncthreads();
 
-    if (threadIdx.x < 8)
+    // now the log partition function
+    partials[threadIdx.x] = 0;
+    for (int i = threadIdx.x; i < m_numRows; i += 512)
     {
-        partials[threadIdx.x] += partials[threadIdx.x + 8];
+        ElemType tmp = predictions[IDX2C(i, blockIdx.x, m_numRows)] - colMax[0];
+        partials[threadIdx.x] += (sizeof(ElemType) == sizeof(float)) ? expf(tmp) : exp(tmp);
     }
     __syncthreads();
 
-    if (threadIdx.x < 4)
+    nTotalThreads = blockDim.x;
+    while (nTotalThreads > 1)
     {
-        partials[threadIdx.x] += partials[threadIdx.x + 4];
+        int halfPoint = (nTotalThreads >> 1);
+
+        if (threadIdx.x < halfPoint)
+            partials[threadIdx.x] += partials[threadIdx.x + halfPoint];
+
+        __syncthreads();
+
+        nTotalThreads = (nTotalThreads >> 1);
     }
-    __syncthreads();
 
+    // the criterion only touches the label row, so no reduction is needed for it
     if (threadIdx.x == 0)
     {
-        colSum[0] = partials[0] + partials[1] + partials[2] + partials[3];
-        colSum[0] = (sizeof(ElemType) == sizeof(float)) ? logf(colSum[0]) : log(colSum[0]);
-    }
-    __syncthreads();
+        ElemType colLogZ = (sizeof(ElemType) == sizeof(float)) ? logf(partials[0]) : log(partials[0]);
+        softmaxStats[IDX2C(0, blockIdx.x, 2)] = colMax[0];
+        softmaxStats[IDX2C(1, blockIdx.x, 2)] = colLogZ;
 
-    for (int i = threadIdx.x; i < m_numRows; i += 512)
-    {
-        us[IDX2C(i, blockIdx.x, m_numRows)] -= colSum[0];
+        int idx = (int) labelIndexes[blockIdx.x];
+        if (idx >= 0 && idx < m_numRows)
+            atomicAdd(crossEntropy, -(predictions[IDX2C(idx, blockIdx.x, m_numRows)] - colMax[0] - colLogZ));
     }
 }
 
@@ -1374,6 +1784,33 @@ __global__ void _adagrad(
         multipliers[id] = 1 / temp;
 }
 
+// fused Adagrad: accumulator update, rsqrt scaling and weight write in one pass
+// (the unfused _adagrad above needs a second ScaleAndAdd pass over grad and val)
+template <class ElemType>
+__global__ void _adagradUpdate(CUDA_LONG size, ElemType* grad, ElemType* smoothAda, ElemType* val, ElemType lr)
+{
+    const ElemType floor = 1e-16f;
+    CUDA_LONG idx = blockIdx.x * blockDim.x + threadIdx.x;
+    CUDA_LONG stride = blockDim.x * gridDim.x;
+    for (; idx < size; idx += stride)
+    {
+        ElemType g = grad[idx];
+        ElemType adaSqr = smoothAda[idx] + g * g;
+        smoothAda[idx] = adaSqr;
+        ElemType w;
+        if (sizeof(ElemType) == sizeof(double))
+        {
+            w = rsqrt(adaSqr + floor);
+        }
+        else
+        {
+            w = rsqrtf(adaSqr + floor);
+        }
+        grad[idx] = g * w; // keep the scaled gradient visible, as the unfused path does
+        val[idx] -= lr * g * w;
+    }
+}
+
 template <class ElemType>
 __global__ void _adagrad4BlockSparse(
     ElemType* a,          // dense
@@ -1503,38 +1940,275 @@ __global__ void _rmsprop(
     else
         steps[i] = max(steps[i] * RMS_WGT_DEC, RMS_WGT_MIN);
 
-    ElemType temp = steps[i] / sqrt(avars[i] + floor);
-    curr_grad[i] *= temp;
-    signs[i] = grad_sign;
+    ElemType temp = steps[i] / sqrt(avars[i] + floor);
+    curr_grad[i] *= temp;
+    signs[i] = grad_sign;
+
+    if (multipliers != nullptr)
+        multipliers[i] = temp;
+}
+
+template <class ElemType>
+__global__ void _rescaleToRange(
+    ElemType* a,
+    const CUDA_LONG N,
+    const ElemType low,
+    const ElemType high)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+    a[id] = a[id] * (high - low) + low;
+}
+
+template <class ElemType>
+__global__ void _setMaskAndScale(
+    ElemType* a,
+    const CUDA_LONG N,
+    const ElemType maskRate,
+    const ElemType scaleValue)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+    a[id] = a[id] <= maskRate ? 0 : scaleValue;
+}
+
+// counter-based RNG for the fused dropout kernels: a stateless splitmix64-style mix of
+// (seed, element index). Forward and backward regenerate the identical mask from the counter
+// alone, so no mask matrix is ever materialized. Returns a uniform in [0, 1).
+// Keep in sync with DropoutUniform() in CPUMatrix.cpp.
+__device__ __inline__ double _dropoutUniform(unsigned long long seed, unsigned long long index)
+{
+    unsigned long long x = seed + (index + 1) * 0x9E3779B97F4A7C15ULL;
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return (x >> 11) * (1.0 / 9007199254740992.0); // top 53 bits
+}
 
-    if (multipliers != nullptr)
-        multipliers[i] = temp;
+template <class ElemType>
+__global__ void _assignDropoutOf(
+    ElemType* c,
+    const ElemType* a,
+    const CUDA_LONG N,
+    const ElemType dropoutRate,
+    const ElemType scaleValue,
+    const unsigned long long randomSeed,
+    const CUDA_LONG offset)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+    c[id] = _dropoutUniform(randomSeed, offset + id) <= dropoutRate ? 0 : a[id] * scaleValue;
 }
 
 template <class ElemType>
-__global__ void _rescaleToRange(
-    ElemType* a,
+__global__ void _addDropoutGradientOf(
+    ElemType* c,
+    const ElemType* a,
     const CUDA_LONG N,
-    const ElemType low,
-    const ElemType high)
+    const ElemType dropoutRate,
+    const ElemType scaleValue,
+    const unsigned long long randomSeed,
+    const CUDA_LONG offset)
 {
     CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
     if (id >= N)
         return;
-    a[id] = a[id] * (high - low) + low;
+    if (_dropoutUniform(randomSeed, offset + id) > dropoutRate)
+        c[id] += a[id] * scaleValue;
 }
 
+// accumulate a log2-bucketed histogram of |a[i]| into 'histogram' (numBuckets counts):
+// bucket 0 holds zeros and magnitudes below 2^minExponent, bucket b (b >= 1) holds magnitudes in
+// [2^(minExponent+b-1), 2^(minExponent+b)), and the top bucket absorbs everything above the range
 template <class ElemType>
-__global__ void _setMaskAndScale(
-    ElemType* a,
+__global__ void _accumulateAbsLogHistogram(
+    const ElemType* a,
     const CUDA_LONG N,
-    const ElemType maskRate,
-    const ElemType scaleValue)
+    const int minExponent,
+    const int numBuckets,
+    ElemType* histogram)
 {
     CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
     if (id >= N)
         return;
-    a[id] = a[id] <= maskRate ? 0 : scaleValue;
+
+    ElemType v = a[id];
+    int bucket = 0; // zeros and underflows
+    if (v != 0)
+    {
+        int e = ilogb(fabs((double) v)); // floor(log2(|v|))
+        bucket = e - minExponent + 1;
+        if (bucket < 0)
+            bucket = 0;
+        else if (bucket > numBuckets - 1)
+            bucket = numBuckets - 1;
+    }
+    atomicAdd(&histogram[bucket], (ElemType) 1);
+}
+
+// fused batch-normalization forward: one block per statistic s computes the minibatch mean and
+// inverse standard deviation over its n = N * (D / S) elements (two-moment shared-memory
+// reduction), updates the running statistics, and writes the normalized+scaled+shifted output,
+// all in a single kernel. Statistic s covers rows {s, s+S, s+2S, ...} of the D x N input
+// (S == D: per-activation; S == #channels: spatial mode with channels fastest-varying).
+// Must be launched with 512 threads per block and S blocks.
+template <class ElemType>
+__global__ void _batchNormalizationForward(
+    const ElemType* x,
+    ElemType* y,
+    const ElemType* scale,
+    const ElemType* bias,
+    const CUDA_LONG D,
+    const CUDA_LONG N,
+    const CUDA_LONG S,
+    const ElemType expAvgFactor,
+    const ElemType epsilon,
+    ElemType* runMean,
+    ElemType* runInvStdDev,
+    ElemType* saveMean,
+    ElemType* saveInvStdDev)
+{
+    __shared__ ElemType sumShared[512];
+    __shared__ ElemType sqSumShared[512];
+    __shared__ ElemType meanShared, invStdDevShared;
+
+    const CUDA_LONG s = blockIdx.x;
+    const CUDA_LONG rowsPerStat = D / S;
+    const CUDA_LONG n = N * rowsPerStat;
+
+    ElemType sum = 0, sqSum = 0;
+    for (CUDA_LONG k = threadIdx.x; k < n; k += blockDim.x)
+    {
+        const CUDA_LONG idx = (s + (k % rowsPerStat) * S) + (k / rowsPerStat) * D;
+        ElemType v = x[idx];
+        sum += v;
+        sqSum += v * v;
+    }
+    sumShared[threadIdx.x] = sum;
+    sqSumShared[threadIdx.x] = sqSum;
+    __syncthreads();
+    for (int stride = blockDim.x / 2; stride > 0; stride >>= 1)
+    {
+        if (threadIdx.x < stride)
+        {
+            sumShared[threadIdx.x] += sumShared[threadIdx.x + stride];
+            sqSumShared[threadIdx.x] += sqSumShared[threadIdx.x + stride];
+        }
+        __syncthreads();
+    }
+    if (threadIdx.x == 0)
+    {
+        ElemType mean = sumShared[0] / n;
+        ElemType variance = sqSumShared[0] / n - mean * mean;
+        if (variance < 0) // (numerical noise)
+            variance = 0;
+        ElemType invStdDev = 1 / sqrt_(variance + epsilon);
+        saveMean[s] = mean;
+        saveInvStdDev[s] = invStdDev;
+        runMean[s] = (1 - expAvgFactor) * runMean[s] + expAvgFactor * mean;
+        runInvStdDev[s] = (1 - expAvgFactor) * runInvStdDev[s] + expAvgFactor * invStdDev;
+        meanShared = mean;
+        invStdDevShared = invStdDev;
+    }
+    __syncthreads();
+
+    const ElemType g = scale[s];
+    const ElemType b = bias[s];
+    const ElemType mean = meanShared;
+    const ElemType invStdDev = invStdDevShared;
+    for (CUDA_LONG k = threadIdx.x; k < n; k += blockDim.x)
+    {
+        const CUDA_LONG idx = (s + (k % rowsPerStat) * S) + (k / rowsPerStat) * D;
+        y[idx] = g * (x[idx] - mean) * invStdDev + b;
+    }
+}
+
+// inference-time batch normalization with the running statistics; plain elementwise kernel
+template <class ElemType>
+__global__ void _batchNormalizationForwardInference(
+    const ElemType* x,
+    ElemType* y,
+    const ElemType* scale,
+    const ElemType* bias,
+    const ElemType* runMean,
+    const ElemType* runInvStdDev,
+    const CUDA_LONG numElements,
+    const CUDA_LONG D,
+    const CUDA_LONG S)
+{
+    const CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= numElements)
+        return;
+    const CUDA_LONG s = (id % D) % S;
+    y[id] = scale[s] * (x[id] - runMean[s]) * runInvStdDev[s] + bias[s];
+}
+
+// fused batch-normalization backward: one block per statistic s reduces the bias and scale
+// gradients, then accumulates the input gradient, in a single kernel.
+// Must be launched with 512 threads per block and S blocks.
+template <class ElemType>
+__global__ void _batchNormalizationBackward(
+    const ElemType* dy, // incoming gradient
+    const ElemType* x,  // original input
+    ElemType* dx,       // input gradient (accumulated into)
+    const ElemType* scale,
+    const ElemType* saveMean,
+    const ElemType* saveInvStdDev,
+    ElemType* scaleGrad,
+    ElemType* biasGrad,
+    const CUDA_LONG D,
+    const CUDA_LONG N,
+    const CUDA_LONG S)
+{
+    __shared__ ElemType dBiasShared[512];
+    __shared__ ElemType dScaleShared[512];
+
+    const CUDA_LONG s = blockIdx.x;
+    const CUDA_LONG rowsPerStat = D / S;
+    const CUDA_LONG n = N * rowsPerStat;
+    const ElemType mean = saveMean[s];
+    const ElemType invStdDev = saveInvStdDev[s];
+
+    ElemType dBias = 0, dScale = 0;
+    for (CUDA_LONG k = threadIdx.x; k < n; k += blockDim.x)
+    {
+        const CUDA_LONG idx = (s + (k % rowsPerStat) * S) + (k / rowsPerStat) * D;
+        dBias += dy[idx];
+        dScale += dy[idx] * (x[idx] - mean) * invStdDev;
+    }
+    dBiasShared[threadIdx.x] = dBias;
+    dScaleShared[threadIdx.x] = dScale;
+    __syncthreads();
+    for (int stride = blockDim.x / 2; stride > 0; stride >>= 1)
+    {
+        if (threadIdx.x < stride)
+        {
+            dBiasShared[threadIdx.x] += dBiasShared[threadIdx.x + stride];
+            dScaleShared[threadIdx.x] += dScaleShared[threadIdx.x + stride];
+        }
+        __syncthreads();
+    }
+    if (threadIdx.x == 0)
+    {
+        biasGrad[s] = dBiasShared[0];
+        scaleGrad[s] = dScaleShared[0];
+    }
+    __syncthreads();
+
+    dBias = dBiasShared[0];
+    dScale = dScaleShared[0];
+    const ElemType g = scale[s];
+    for (CUDA_LONG k = threadIdx.x; k < n; k += blockDim.x)
+    {
+        const CUDA_LONG idx = (s + (k % rowsPerStat) * S) + (k / rowsPerStat) * D;
+        ElemType xHat = (x[idx] - mean) * invStdDev;
+        dx[idx] += g * invStdDev * (dy[idx] - (dBias + xHat * dScale) / n);
+    }
 }
 
 template <class ElemType>
@@ -1650,6 +2324,40 @@ __global__ void _vectorNorm2(
         c[id] = sqrt(sum);
 }
 
+// column-wise norms with one warp per column: the warp strides down the column so
+// global loads are coalesced, unlike the one-thread-per-column kernels above.
+// norm == 1 computes the 1-norm, norm == 2 the 2-norm.
+template <class ElemType, int norm>
+__global__ void _vectorNormColReduce(
+    ElemType* c,       // output, one value per column
+    const ElemType* a, // input
+    const CUDA_LONG n, // a.numRows
+    const CUDA_LONG m) // a.numCols
+{
+    const int lane = threadIdx.x & (CUDA_WARP_SIZE - 1);
+    const CUDA_LONG col = blockIdx.x * (blockDim.x / CUDA_WARP_SIZE) + threadIdx.x / CUDA_WARP_SIZE;
+    if (col >= m)
+        return;
+
+    ElemType sum = 0;
+    for (CUDA_LONG i = lane; i < n; i += CUDA_WARP_SIZE)
+    {
+        ElemType v = a[IDX2C(i, col, n)];
+        if (norm == 1)
+            sum += (sizeof(ElemType) == sizeof(float)) ? fabsf(v) : fabs(v);
+        else
+            sum += v * v;
+    }
+    sum = WarpReduceSum(sum);
+
+    if (lane == 0)
+    {
+        if (norm == 2)
+            sum = (sizeof(ElemType) == sizeof(float)) ? sqrtf(sum) : sqrt(sum);
+        c[col] = sum;
+    }
+}
+
 template <class ElemType>
 __global__ void _convertInd2ValsAdjustInd(
     ElemType* inds,
@@ -2191,7 +2899,8 @@ __global__ void _addSignOf(
     a[id] += (v == (ElemType) 0 ? (ElemType) 0 : (v > 0 ? (ElemType) 1 : (ElemType)(-1)));
 }
 
-// This function processes 1 column per block. this function needs 512 threads
+// This function processes 1 column per block, reducing (value, index) pairs with the
+// warp-shuffle primitives
 template <class ElemType, bool IsMax>
 __global__ void _vectorMaxMinReduce(
     const ElemType* us,
@@ -2200,120 +2909,92 @@ __global__ void _vectorMaxMinReduce(
     const CUDA_LONG numRows,
     const CUDA_LONG numCols)
 {
-    // we first find max per column
-    __shared__ ElemType partials[512];
-    __shared__ int partialsInd[512];
-    if (IsMax)
-    {
-        partials[threadIdx.x] = -10000000;
-    }
-    else
-    {
-        partials[threadIdx.x] = 10000000;
-    }
-    partialsInd[threadIdx.x] = -1;
-
-    for (int i = threadIdx.x; i < numRows; i += 512)
-    {
-        if ((IsMax ? (us[IDX2C(i, blockIdx.x, numRows)] > partials[threadIdx.x]) : (us[IDX2C(i, blockIdx.x, numRows)] < partials[threadIdx.x])) || (partialsInd[threadIdx.x] == -1))
-        {
-            partials[threadIdx.x] = us[IDX2C(i, blockIdx.x, numRows)];
-            partialsInd[threadIdx.x] = i;
-        }
-    }
-    __syncthreads();
+    __shared__ ElemType partials[GridDim::maxWarpsPerBlock];
+    __shared__ int partialsInd[GridDim::maxWarpsPerBlock];
 
-    if (threadIdx.x < 256)
-    {
-        if ((IsMax ? (partials[threadIdx.x + 256] > partials[threadIdx.x]) : (partials[threadIdx.x + 256] < partials[threadIdx.x])) || (partialsInd[threadIdx.x] == -1))
-        {
-            partials[threadIdx.x] = partials[threadIdx.x + 256];
-            partialsInd[threadIdx.x] = partialsInd[threadIdx.x + 256];
-        }
-    }
-    __syncthreads();
+    ElemType val = IsMax ? (ElemType) -10000000 : (ElemType) 10000000;
+    int ind = -1;
 
-    if (threadIdx.x < 128)
+    for (CUDA_LONG i = threadIdx.x; i < numRows; i += blockDim.x)
     {
-        if ((IsMax ? (partials[threadIdx.x + 128] > partials[threadIdx.x]) : (partials[threadIdx.x + 128] < partials[threadIdx.x])) || (partialsInd[threadIdx.x] == -1))
+        ElemType v = us[IDX2C(i, blockIdx.x, numRows)];
+        if ((IsMax ? v > val : v < val) || ind == -1)
         {
-            partials[threadIdx.x] = partials[threadIdx.x + 128];
-            partialsInd[threadIdx.x] = partialsInd[threadIdx.x + 128];
+            val = v;
+            ind = i;
         }
     }
-    __syncthreads();
 
-    if (threadIdx.x < 64)
-    {
-        if ((IsMax ? (partials[threadIdx.x + 64] > partials[threadIdx.x]) : (partials[threadIdx.x + 64] < partials[threadIdx.x])) || (partialsInd[threadIdx.x] == -1))
-        {
-            partials[threadIdx.x] = partials[threadIdx.x + 64];
-            partialsInd[threadIdx.x] = partialsInd[threadIdx.x + 64];
-        }
-    }
-    __syncthreads();
+    BlockReduceArgMaxMin<ElemType, IsMax>(val, ind, partials, partialsInd);
 
-    if (threadIdx.x < 32)
+    if (threadIdx.x == 0)
     {
-        if ((IsMax ? (partials[threadIdx.x + 32] > partials[threadIdx.x]) : (partials[threadIdx.x + 32] < partials[threadIdx.x])) || (partialsInd[threadIdx.x] == -1))
-        {
-            partials[threadIdx.x] = partials[threadIdx.x + 32];
-            partialsInd[threadIdx.x] = partialsInd[threadIdx.x + 32];
-        }
+        Values[blockIdx.x] = val;
+        Indexes[blockIdx.x] = ind;
     }
-    __syncthreads();
+}
 
-    if (threadIdx.x < 16)
-    {
-        if ((IsMax ? (partials[threadIdx.x + 16] > partials[threadIdx.x]) : (partials[threadIdx.x + 16] < partials[threadIdx.x])) || (partialsInd[threadIdx.x] == -1))
-        {
-            partials[threadIdx.x] = partials[threadIdx.x + 16];
-            partialsInd[threadIdx.x] = partialsInd[threadIdx.x + 16];
-        }
-    }
-    __syncthreads();
+// One block per column; emits the topK largest elements of each column in descending order
+// (ties broken by ascending row, matching the stable radix-sort path). Instead of keeping a mark
+// array over the input, each pass reduces over the elements strictly below the previously emitted
+// (value, row) pair in that total order, so the kernel needs no workspace at all.
+template <class ElemType>
+__global__ void _vectorTopKMaxReduce(
+    const ElemType* us,
+    ElemType* maxIndexes,
+    ElemType* maxValues,
+    const CUDA_LONG numRows,
+    const CUDA_LONG topK)
+{
+    __shared__ ElemType partials[GridDim::maxThreadsPerBlock];
+    __shared__ int partialsInd[GridDim::maxThreadsPerBlock];
+    __shared__ ElemType prevVal;
+    __shared__ int prevInd;
 
-    if (threadIdx.x < 8)
+    for (CUDA_LONG k = 0; k < topK; k++)
     {
-        if ((IsMax ? (partials[threadIdx.x + 8] > partials[threadIdx.x]) : (partials[threadIdx.x + 8] < partials[threadIdx.x])) || (partialsInd[threadIdx.x] == -1))
+        ElemType val = 0;
+        int ind = -1;
+        for (CUDA_LONG i = threadIdx.x; i < numRows; i += blockDim.x)
         {
-            partials[threadIdx.x] = partials[threadIdx.x + 8];
-            partialsInd[threadIdx.x] = partialsInd[threadIdx.x + 8];
+            ElemType v = us[IDX2C(i, blockIdx.x, numRows)];
+            if (k > 0 && (v > prevVal || (v == prevVal && (int) i <= prevInd)))
+                continue; // already emitted in an earlier pass
+            if (ind == -1 || v > val || (v == val && (int) i < ind))
+            {
+                val = v;
+                ind = i;
+            }
         }
-    }
-    __syncthreads();
 
-    if (threadIdx.x < 4)
-    {
-        if ((IsMax ? (partials[threadIdx.x + 4] > partials[threadIdx.x]) : (partials[threadIdx.x + 4] < partials[threadIdx.x])) || (partialsInd[threadIdx.x] == -1))
+        // block reduce; unlike BlockReduceArgMaxMin this prefers the smaller row on equal values,
+        // which the pass-exclusion predicate above relies on (blockDim.x must be a power of two)
+        partials[threadIdx.x] = val;
+        partialsInd[threadIdx.x] = ind;
+        __syncthreads();
+        for (int delta = blockDim.x / 2; delta > 0; delta >>= 1)
         {
-            partials[threadIdx.x] = partials[threadIdx.x + 4];
-            partialsInd[threadIdx.x] = partialsInd[threadIdx.x + 4];
+            if (threadIdx.x < delta)
+            {
+                ElemType otherVal = partials[threadIdx.x + delta];
+                int otherInd = partialsInd[threadIdx.x + delta];
+                if (otherInd != -1 && (ind == -1 || otherVal > val || (otherVal == val && otherInd < ind)))
+                {
+                    partials[threadIdx.x] = val = otherVal;
+                    partialsInd[threadIdx.x] = ind = otherInd;
+                }
+            }
+            __syncthreads();
         }
-    }
-    __syncthreads();
 
-    if (threadIdx.x == 0)
-    {
-        ElemType mx = partials[0];
-        int ind = partialsInd[0];
-        if ((IsMax ? (mx < partials[1]) : (mx > partials[1])) || (ind == -1))
-        {
-            mx = partials[1];
-            ind = partialsInd[1];
-        }
-        if ((IsMax ? (mx < partials[2]) : (mx > partials[2])) || (ind == -1))
-        {
-            mx = partials[2];
-            ind = partialsInd[2];
-        }
-        if ((IsMax ? (mx < partials[3]) : (mx > partials[3])) || (ind == -1))
+        if (threadIdx.x == 0)
         {
-            mx = partials[3];
-            ind = partialsInd[3];
+            maxValues[IDX2C(k, blockIdx.x, topK)] = val;
+            maxIndexes[IDX2C(k, blockIdx.x, topK)] = ind;
+            prevVal = val;
+            prevInd = ind;
         }
-        Values[blockIdx.x] = mx;
-        Indexes[blockIdx.x] = ind;
+        __syncthreads(); // prevVal/prevInd must be visible before the next pass starts
     }
 }
 
@@ -2565,6 +3246,77 @@ __global__ void _assignScaledDifference(
     c[id] = (a[id] - b[id]) * alpha[0];
 }
 
+// c += alpha * (softmax(predictions) - labels), with the softmax reconstructed element by element
+// from the per-column max and log partition function saved in softmaxStats (2 x cols)
+template <class ElemType>
+__global__ void _addScaledSoftmaxDifference(
+    const ElemType* alpha,
+    const ElemType* predictions,
+    const ElemType* softmaxStats,
+    const ElemType* labels,
+    ElemType* c,
+    const CUDA_LONG N,
+    const CUDA_LONG m_numRows,
+    const char* colsValidity) // per-column validity flags (may be NULL); 0 marks a gap column
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+    CUDA_LONG col = id / m_numRows;
+    if (colsValidity != NULL && colsValidity[col] == 0) // gap column--no gradient
+        return;
+    ElemType shift = softmaxStats[IDX2C(0, col, 2)] + softmaxStats[IDX2C(1, col, 2)]; // max + log partition function
+    ElemType tmp = predictions[id] - shift;
+    ElemType softmax = (sizeof(ElemType) == sizeof(float)) ? expf(tmp) : exp(tmp);
+    c[id] += alpha[0] * (softmax - labels[id]);
+}
+
+// c += alpha * (softmax(predictions) - onehot(labelIndexes)), without reading a one-hot matrix:
+// labelIndexes holds the label class per column, and gap columns (negative index) get no gradient
+template <class ElemType>
+__global__ void _addScaledIndexedSoftmaxDifference(
+    const ElemType* alpha,
+    const ElemType* predictions,
+    const ElemType* softmaxStats,
+    const ElemType* labelIndexes,
+    ElemType* c,
+    const CUDA_LONG N,
+    const CUDA_LONG m_numRows)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+    CUDA_LONG col = id / m_numRows;
+    CUDA_LONG row = id - col * m_numRows;
+    CUDA_LONG idx = (CUDA_LONG) labelIndexes[col];
+    if (idx < 0 || idx >= m_numRows) // gap column--no gradient
+        return;
+    ElemType shift = softmaxStats[IDX2C(0, col, 2)] + softmaxStats[IDX2C(1, col, 2)]; // max + log partition function
+    ElemType tmp = predictions[id] - shift;
+    ElemType softmax = (sizeof(ElemType) == sizeof(float)) ? expf(tmp) : exp(tmp);
+    c[id] += alpha[0] * (softmax - (row == idx ? 1 : 0));
+}
+
+// c += alpha * weight * logsoftmax(predictions), with the log-softmax reconstructed element by
+// element from the per-column max and log partition function saved in softmaxStats (2 x cols)
+template <class ElemType>
+__global__ void _addScaledLogSoftmax(
+    const ElemType alpha,
+    const ElemType* weight,
+    const ElemType* predictions,
+    const ElemType* softmaxStats,
+    ElemType* c,
+    const CUDA_LONG N,
+    const CUDA_LONG m_numRows)
+{
+    CUDA_LONG id = blockDim.x * blockIdx.x + threadIdx.x;
+    if (id >= N)
+        return;
+    CUDA_LONG col = id / m_numRows;
+    ElemType shift = softmaxStats[IDX2C(0, col, 2)] + softmaxStats[IDX2C(1, col, 2)]; // max + log partition function
+    c[id] += alpha * weight[0] * (predictions[id] - shift);
+}
+
 template <class ElemType>
 __global__ void _addElementToElement(
     const ElemType* a, CUDA_LONG indexA,
@@ -2679,6 +3431,41 @@ __syncthreads();
 c[id] = totalSum;
 }*/
 
+// fused top-K classification error (cf. CPUMatrix::AssignTopKError): one thread per column finds the
+// argmax of the labels column, counts the prediction scores strictly larger than the score at that
+// index, and atomically bumps the single error counter if at least topK of them exist
+template <class ElemType>
+__global__ void _assignTopKError(
+    const ElemType* labels,
+    const ElemType* predictions,
+    ElemType* errorCount,
+    const CUDA_LONG m, // row dim
+    const CUDA_LONG n, // col dim
+    const CUDA_LONG topK)
+{
+    CUDA_LONG j = blockDim.x * blockIdx.x + threadIdx.x;
+    if (j >= n)
+        return;
+
+    const ElemType* labelCol = labels + j * m;
+    const ElemType* predCol = predictions + j * m;
+
+    CUDA_LONG labelIdx = 0;
+    for (CUDA_LONG i = 1; i < m; i++)
+    {
+        if (labelCol[i] > labelCol[labelIdx])
+            labelIdx = i;
+    }
+
+    const ElemType predAtLabel = predCol[labelIdx];
+    CUDA_LONG numGreater = 0;
+    for (CUDA_LONG i = 0; i < m && numGreater < topK; i++)
+        numGreater += (predCol[i] > predAtLabel);
+
+    if (numGreater >= topK)
+        atomicAdd(errorCount, (ElemType) 1);
+}
+
 template <class ElemType>
 __global__ void _scaleArray(
     ElemType alpha,
@@ -2733,6 +3520,72 @@ __global__ void _sparseCSRElemMulDense(
     }
 }
 
+// fused sparse-to-dense conversion: dense = beta * dense + alpha * sparse (CSC format)
+// One block per column: the block first scales (or zeroes) its dense column, then scatters the
+// column's non-zeros into it, so the scale and the conversion need only a block-level barrier
+// instead of a separate full-matrix scaling kernel. The row indices within one CSC column are
+// distinct, hence threads of the scatter phase never collide and no atomics are needed.
+template <class ElemType>
+__global__ void _sparseCSCToDense(
+    const ElemType alpha,
+    const ElemType* nzValues,
+    const GPUSPARSE_INDEX_TYPE* rowIndex,
+    const GPUSPARSE_INDEX_TYPE* colCSCIndex,
+    const ElemType beta,
+    ElemType* dense,
+    const CUDA_LONG numRows)
+{
+    ElemType* column = dense + blockIdx.x * numRows;
+    if (beta == 0)
+    {
+        for (CUDA_LONG i = threadIdx.x; i < numRows; i += blockDim.x)
+            column[i] = 0;
+    }
+    else if (beta != 1)
+    {
+        for (CUDA_LONG i = threadIdx.x; i < numRows; i += blockDim.x)
+            column[i] *= beta;
+    }
+    __syncthreads();
+
+    const int start = colCSCIndex[blockIdx.x];
+    const int end = colCSCIndex[blockIdx.x + 1];
+    for (int _i = start + threadIdx.x; _i < end; _i += blockDim.x) // _i is index in nzValues and rowIndex
+        column[rowIndex[_i]] += alpha * nzValues[_i];
+}
+
+// same fusion for the CSR format: one block per row; the column indices within one CSR row
+// are distinct, so the scatter phase is again collision-free
+template <class ElemType>
+__global__ void _sparseCSRToDense(
+    const ElemType alpha,
+    const ElemType* nzValues,
+    const GPUSPARSE_INDEX_TYPE* rowCSRIndex,
+    const GPUSPARSE_INDEX_TYPE* colIndex,
+    const ElemType beta,
+    ElemType* dense,
+    const CUDA_LONG numRows,
+    const CUDA_LONG numCols)
+{
+    const CUDA_LONG row = blockIdx.x;
+    if (beta == 0)
+    {
+        for (CUDA_LONG j = threadIdx.x; j < numCols; j += blockDim.x)
+            dense[IDX2C(row, j, numRows)] = 0;
+    }
+    else if (beta != 1)
+    {
+        for (CUDA_LONG j = threadIdx.x; j < numCols; j += blockDim.x)
+            dense[IDX2C(row, j, numRows)] *= beta;
+    }
+    __syncthreads();
+
+    const int start = rowCSRIndex[row];
+    const int end = rowCSRIndex[row + 1];
+    for (int _i = start + threadIdx.x; _i < end; _i += blockDim.x) // _i is index in nzValues and colIndex
+        dense[IDX2C(row, colIndex[_i], numRows)] += alpha * nzValues[_i];
+}
+
 template <class ElemType>
 __global__ void _isValid(
     const GPUSPARSE_INDEX_TYPE* rowIndex,
@@ -4559,6 +5412,49 @@ __global__ void _minusOneAt(
         c[id] = c[id] - 1.0;
 }
 
+/// the kernel for the RCRF forward recursion, one time step per launch:
+/// alpha(id, t) = pos_scores(id, t) + logsum_j (alpha(j, t - 1) + pair_scores(id, j)),
+/// where the start label stands in for alpha(., -1)
+template <class ElemType>
+__global__ void _rcrfForwardCompute(
+    const size_t t, // time position
+    ElemType* galpha,
+    const ElemType* gpos_scores,
+    const ElemType* gpair_scores,
+    const size_t iNumLab, const int startLbl)
+{
+    int id = blockDim.x * blockIdx.x + threadIdx.x;
+
+    extern __shared__ double sh_alpha_and_beta[]; // intersting, has to use [], instead of *
+    // need bye size = iNumLab * sizeof(ElemType)
+
+    ElemType* alpha_t1 = (ElemType*) (sh_alpha_and_beta);
+    ElemType pair_scores[1024];
+
+    if (id < 0 || id >= iNumLab)
+        return;
+
+    // copy global memory to shared memory to save time
+    if (t > 0)
+        alpha_t1[id] = galpha[IDX2C(id, t - 1, iNumLab)];
+
+    __syncthreads();
+
+    for (int j = 0; j < iNumLab; j++)
+        pair_scores[j] = gpair_scores[IDX2C(id, j, iNumLab)];
+
+    ElemType fTmp = LZERO;
+    for (int j = 0; j < iNumLab; j++)
+    {
+        ElemType fAlpha = (j == startLbl) ? 0 : LZERO;
+        if (t > 0)
+            fAlpha = alpha_t1[j];
+        fTmp = logaddk(fTmp, fAlpha + pair_scores[j]);
+    }
+
+    galpha[IDX2C(id, t, iNumLab)] = fTmp + gpos_scores[IDX2C(id, t, iNumLab)];
+}
+
 // the kernel function for RCRF backward computation
 // assume a column slice of input and output
 template <class ElemType>
@@ -281,41 +281,40 @@ void GPUSparseMatrix<ElemType>::CopyToDenseMatrix(GPUMatrix<ElemType>& denseMatr
         return;
     }
 
-    PrepareDevice();
-    cusparseHandle_t cusparseHandle = 0;
-    CUSPARSE_CALL(cusparseCreate(&cusparseHandle));
-    cusparseMatDescr_t descr = 0;
-    CUSPARSE_CALL(cusparseCreateMatDescr(&descr));
-    cusparseSetMatType(descr, CUSPARSE_MATRIX_TYPE_GENERAL);
-    cusparseSetMatIndexBase(descr, CUSPARSE_INDEX_BASE_ZERO);
-
     denseMatrix.Resize(m_numRows, m_numCols);
+    CopyToDenseMatrix(denseMatrix, 1, 0);
+
+    denseMatrix.SetMatrixName(m_matrixName);
+}
 
+// fused conversion: denseMatrix = beta * denseMatrix + alpha * this, in one kernel pass
+// This is the building block for all sparse-to-dense crossings: plain conversion
+// (alpha = 1, beta = 0; the dense buffer may be uninitialized), convert+scale (beta = 0),
+// and convert+add-into (beta = 1). The scale is applied while scattering, so there is no
+// dense temporary and no separate scaling kernel over the full dense matrix--on models
+// that cross the sparse/dense boundary at every embedding layer, those used to double
+// the conversion's memory traffic. denseMatrix must already have this' dimensions.
+template <class ElemType>
+void GPUSparseMatrix<ElemType>::CopyToDenseMatrix(GPUMatrix<ElemType>& denseMatrix, const ElemType alpha, const ElemType beta) const
+{
+    if (denseMatrix.GetNumRows() != m_numRows || denseMatrix.GetNumCols() != m_numCols)
+        LogicError("CopyToDenseMatrix: dimension mismatch");
+    if (GetComputeDeviceId() != denseMatrix.GetComputeDeviceId())
+        RuntimeError("CopyToDenseMatrix: matrices must be on the same device");
+
+    PrepareDevice();
     cudaEvent_t done = nullptr;
     if (do_sync)
         CUDA_CALL(cudaEventCreate(&done));
-    CUSPARSE_CALL(cusparseSetStream(cusparseHandle, t_stream));
-    if (m_format == MatrixFormat::matrixFormatSparseCSR)
+    if (m_format == MatrixFormat::matrixFormatSparseCSC)
     {
-        if (sizeof(ElemType) == sizeof(float))
-        {
-            CUSPARSE_CALL(cusparseScsr2dense(cusparseHandle, int(m_numRows), int(m_numCols), descr, (float*) BufferPointer(), RowLocation(), ColLocation(), (float*) denseMatrix.BufferPointer(), int(m_numRows)));
-        }
-        else
-        {
-            CUSPARSE_CALL(cusparseDcsr2dense(cusparseHandle, int(m_numRows), int(m_numCols), descr, (double*) BufferPointer(), RowLocation(), ColLocation(), (double*) denseMatrix.BufferPointer(), int(m_numRows)));
-        }
+        _sparseCSCToDense<ElemType><<<(unsigned int) m_numCols, GridDim::maxThreadsPerBlock, 0, t_stream>>>(
+            alpha, BufferPointer(), RowLocation(), ColLocation(), beta, denseMatrix.BufferPointer(), (CUDA_LONG) m_numRows);
     }
-    else if (m_format == MatrixFormat::matrixFormatSparseCSC)
+    else if (m_format == MatrixFormat::matrixFormatSparseCSR)
     {
-        if (sizeof(ElemType) == sizeof(float))
-        {
-            CUSPARSE_CALL(cusparseScsc2dense(cusparseHandle, int(m_numRows), int(m_numCols), descr, (float*) BufferPointer(), RowLocation(), ColLocation(), (float*) denseMatrix.BufferPointer(), int(m_numRows)));
-        }
-        else
-        {
-            CUSPARSE_CALL(cusparseDcsc2dense(cusparseHandle, int(m_numRows), int(m_numCols), descr, (double*) BufferPointer(), RowLocation(), ColLocation(), (double*) denseMatrix.BufferPointer(), int(m_numRows)));
-        }
+        _sparseCSRToDense<ElemType><<<(unsigned int) m_numRows, GridDim::maxThreadsPerBlock, 0, t_stream>>>(
+            alpha, BufferPointer(), RowLocation(), ColLocation(), beta, denseMatrix.BufferPointer(), (CUDA_LONG) m_numRows, (CUDA_LONG) m_numCols);
     }
     else
     {
@@ -328,9 +327,6 @@ void GPUSparseMatrix<ElemType>::CopyToDenseMatrix(GPUMatrix<ElemType>& denseMatr
         CUDA_CALL(cudaEventSynchronize(done));
     if (do_sync)
         CUDA_CALL(cudaEventDestroy(done));
-    CUSPARSE_CALL(cusparseDestroy(cusparseHandle));
-
-    denseMatrix.SetMatrixName(m_matrixName);
 }
 
 template <class ElemType>
@@ -1854,7 +1850,7 @@ void GPUSparseMatrix<ElemType>::ScaleAndAdd(ElemType alpha, const GPUSparseMatri
 template <class ElemType>
 void GPUSparseMatrix<ElemType>::ScaleAndAdd(ElemType alpha, const GPUSparseMatrix<ElemType>& a, ElemType beta, const GPUMatrix<ElemType>& b, GPUMatrix<ElemType>& c)
 {
-    if (a.m_format != matrixFormatSparseCSR)
+    if (a.m_format != matrixFormatSparseCSR && a.m_format != matrixFormatSparseCSC)
         NOT_IMPLEMENTED;
 
     if (a.GetNumRows() != b.GetNumRows() || a.GetNumRows() != c.GetNumRows() || a.GetNumCols() != b.GetNumCols() || a.GetNumCols() != c.GetNumCols())
@@ -1862,24 +1858,12 @@ void GPUSparseMatrix<ElemType>::ScaleAndAdd(ElemType alpha, const GPUSparseMatri
     if (a.GetComputeDeviceId() != b.GetComputeDeviceId() || a.GetComputeDeviceId() != c.GetComputeDeviceId())
         RuntimeError("ScaleAndAdd: matrices must be on the same device");
     b.PrepareDevice();
-    // copy b to c
-    CUDA_CALL(cudaMemcpy(c.BufferPointer(), b.BufferPointer(), sizeof(ElemType) * b.GetNumElements(), cudaMemcpyDeviceToDevice));
-    if (beta != 1)
-    {
-        c *= beta;
-    }
-    cudaEvent_t done = nullptr;
-    if (do_sync)
-        CUDA_CALL(cudaEventCreate(&done));
-    CUDA_LONG M = (CUDA_LONG) a.GetNumRows();
-    int blocksPerGrid = (int) ceil(1.0 * M / GridDim::maxThreadsPerBlock);
-    _sparseCSRPlusDense<ElemType><<<blocksPerGrid, GridDim::maxThreadsPerBlock>>>(alpha, a.BufferPointer(), a.RowLocation(), a.ColLocation(), c.BufferPointer(), M);
-    if (do_sync)
-        CUDA_CALL(cudaEventRecord(done));
-    if (do_sync)
-        CUDA_CALL(cudaEventSynchronize(done));
-    if (do_sync)
-        CUDA_CALL(cudaEventDestroy(done));
+    // copy b to c unless accumulating in place (b and c are routinely the same matrix here)
+    if (c.BufferPointer() != b.BufferPointer())
+        CUDA_CALL(cudaMemcpy(c.BufferPointer(), b.BufferPointer(), sizeof(ElemType) * b.GetNumElements(), cudaMemcpyDeviceToDevice));
+    // the fused conversion kernel applies the beta scale while scattering alpha * a into c,
+    // replacing the former separate scale kernel plus add kernel
+    a.CopyToDenseMatrix(c, alpha, beta);
 }
 
 template <class ElemType>
@@ -2263,17 +2247,38 @@ GPUSparseMatrix<ElemType>& GPUSparseMatrix<ElemType>::AssignElementPowerOf(const
 template <class ElemType>
 GPUSparseMatrix<ElemType> GPUSparseMatrix<ElemType>::Transpose() const
 {
-    int m = (int) GetNumRows();
-    int n = (int) GetNumCols();
-    int nnz = (int) GetNumNZElements();
+    GPUSparseMatrix c(GetFormat(), GetComputeDeviceId());
+    c.AssignTransposeOf(*this);
+    return c;
+}
+
+// transposing conversion directly into [this]: the compressed formats are each other's
+// transpose, so one csr2csc pass into this' own (resized) buffers does the job with no
+// intermediate matrix--this is a per-minibatch operation on models with sparse inputs,
+// where the former construct-temporary-and-move pattern allocated on every call
+template <class ElemType>
+GPUSparseMatrix<ElemType>& GPUSparseMatrix<ElemType>::AssignTransposeOf(const GPUSparseMatrix<ElemType>& a)
+{
+    if (!OwnBuffer())
+        LogicError("Cannot modify since the buffer is managed externally.");
+
+    if (this == &a)
+        LogicError("AssignTransposeOf: a is the same as [this]. Does not support inplace transpose.");
+
+    if (a.IsEmpty())
+        LogicError("AssignTransposeOf: Matrix a is empty.");
+
+    int m = (int) a.GetNumRows();
+    int n = (int) a.GetNumCols();
+    int nnz = (int) a.GetNumNZElements();
     cusparseAction_t cpVals = CUSPARSE_ACTION_NUMERIC;
     cusparseIndexBase_t idxBase = CUSPARSE_INDEX_BASE_ZERO;
 
-    assert(GetFormat() & matrixFormatCompressed); // for now this only supports compressed formats
-    PrepareDevice();
-    GPUSparseMatrix c(GetFormat(), GetComputeDeviceId());
-    c.Resize(n, m, nnz, GetFormat(), true, false);
-    c.m_nz = nnz;
+    assert(a.GetFormat() & matrixFormatCompressed); // for now this only supports compressed formats
+    a.PrepareDevice();
+    ChangeDeviceTo(a.GetComputeDeviceId());
+    Resize(n, m, nnz, a.GetFormat(), true, false);
+    m_nz = nnz;
 
     cusparseHandle_t cusparseHandle = 0;
     CUSPARSE_CALL(cusparseCreate(&cusparseHandle));
@@ -2281,44 +2286,44 @@ GPUSparseMatrix<ElemType> GPUSparseMatrix<ElemType>::Transpose() const
     cudaEvent_t done = nullptr;
     if (do_sync)
         CUDA_CALL(cudaEventCreate(&done));
-    if (m_format == MatrixFormat::matrixFormatSparseCSR)
+    if (a.m_format == MatrixFormat::matrixFormatSparseCSR)
     {
         if (nnz > 0)
         {
             if (sizeof(ElemType) == sizeof(float))
             {
-                CUSPARSE_CALL(cusparseScsr2csc(cusparseHandle, m, n, nnz, reinterpret_cast<const float*>(this->BufferPointer()), this->RowLocation(), this->ColLocation(),
-                                               reinterpret_cast<float*>(c.BufferPointer()), c.ColLocation(), c.RowLocation(), cpVals, idxBase));
+                CUSPARSE_CALL(cusparseScsr2csc(cusparseHandle, m, n, nnz, reinterpret_cast<const float*>(a.BufferPointer()), a.RowLocation(), a.ColLocation(),
+                                               reinterpret_cast<float*>(this->BufferPointer()), this->ColLocation(), this->RowLocation(), cpVals, idxBase));
             }
             else
             {
-                CUSPARSE_CALL(cusparseDcsr2csc(cusparseHandle, m, n, nnz, reinterpret_cast<const double*>(this->BufferPointer()), this->RowLocation(), this->ColLocation(),
-                                               reinterpret_cast<double*>(c.BufferPointer()), c.ColLocation(), c.RowLocation(), cpVals, idxBase));
+                CUSPARSE_CALL(cusparseDcsr2csc(cusparseHandle, m, n, nnz, reinterpret_cast<const double*>(a.BufferPointer()), a.RowLocation(), a.ColLocation(),
+                                               reinterpret_cast<double*>(this->BufferPointer()), this->ColLocation(), this->RowLocation(), cpVals, idxBase));
             }
         }
         else
         {
-            CUDA_CALL(cudaMemset(c.BufferPointer(), 0, c.BufferSizeAllocated()));
+            CUDA_CALL(cudaMemset(this->BufferPointer(), 0, this->BufferSizeAllocated()));
         }
     }
-    else if (m_format == matrixFormatSparseCSC)
+    else if (a.m_format == matrixFormatSparseCSC)
     {
         if (nnz > 0)
         {
             if (sizeof(ElemType) == sizeof(float))
             {
-                CUSPARSE_CALL(cusparseScsr2csc(cusparseHandle, n, m, nnz, reinterpret_cast<const float*>(this->BufferPointer()), this->ColLocation(), this->RowLocation(),
-                                               reinterpret_cast<float*>(c.BufferPointer()), c.RowLocation(), c.ColLocation(), cpVals, idxBase));
+                CUSPARSE_CALL(cusparseScsr2csc(cusparseHandle, n, m, nnz, reinterpret_cast<const float*>(a.BufferPointer()), a.ColLocation(), a.RowLocation(),
+                                               reinterpret_cast<float*>(this->BufferPointer()), this->RowLocation(), this->ColLocation(), cpVals, idxBase));
             }
             else
             {
-                CUSPARSE_CALL(cusparseDcsr2csc(cusparseHandle, n, m, nnz, reinterpret_cast<const double*>(this->BufferPointer()), this->ColLocation(), this->RowLocation(),
-                                               reinterpret_cast<double*>(c.BufferPointer()), c.RowLocation(), c.ColLocation(), cpVals, idxBase));
+                CUSPARSE_CALL(cusparseDcsr2csc(cusparseHandle, n, m, nnz, reinterpret_cast<const double*>(a.BufferPointer()), a.ColLocation(), a.RowLocation(),
+                                               reinterpret_cast<double*>(this->BufferPointer()), this->RowLocation(), this->ColLocation(), cpVals, idxBase));
             }
         }
         else
         {
-            CUDA_CALL(cudaMemset(c.BufferPointer(), 0, c.BufferSizeAllocated()));
+            CUDA_CALL(cudaMemset(this->BufferPointer(), 0, this->BufferSizeAllocated()));
         }
     }
     else
@@ -2332,22 +2337,6 @@ GPUSparseMatrix<ElemType> GPUSparseMatrix<ElemType>::Transpose() const
     if (do_sync)
         CUDA_CALL(cudaEventDestroy(done));
     CUSPARSE_CALL(cusparseDestroy(cusparseHandle));
-    return c;
-}
-
-template <class ElemType>
-GPUSparseMatrix<ElemType>& GPUSparseMatrix<ElemType>::AssignTransposeOf(const GPUSparseMatrix<ElemType>& a)
-{
-    if (!OwnBuffer())
-        LogicError("Cannot modify since the buffer is managed externally.");
-
-    if (this == &a)
-        LogicError("AssignTransposeOf: a is the same as [this]. Does not support inplace transpose.");
-
-    if (a.IsEmpty())
-        LogicError("AssignTransposeOf: Matrix a is empty.");
-
-    *this = a.Transpose();
     return *this;
 }
 
@@ -2922,6 +2911,24 @@ template GPUSparseMatrix<char> GPUSparseMatrix<char>::ColumnSlice(size_t startCo
 template GPUMatrix<char> GPUSparseMatrix<char>::CopyColumnSliceToDense(size_t startColumn, size_t numCols) const;
 template GPUSparseMatrix<char>& GPUSparseMatrix<char>::operator=(GPUSparseMatrix<char>&& deepCopy);
 
+// We use Matrix<short> as the backing store for quantized inference weights; same drill as Matrix<char>
+template GPUSparseMatrix<short>::GPUSparseMatrix(const MatrixFormat matrixFormat, const DEVICEID_TYPE computeDevice);
+template GPUSparseMatrix<short>::GPUSparseMatrix(const size_t numRows, const size_t numCols, const size_t numNZ, const MatrixFormat matrixFormat, const DEVICEID_TYPE computeDevice);
+template GPUSparseMatrix<short>::GPUSparseMatrix(GPUSparseMatrix<short> const&);
+template GPUSparseMatrix<short>::GPUSparseMatrix(GPUSparseMatrix<short>&&);
+template void GPUSparseMatrix<short>::SetValue(CPUSparseMatrix<short> const&);
+template void GPUSparseMatrix<short>::SetValue(GPUSparseMatrix<short> const&);
+template void GPUSparseMatrix<short>::SetValue(GPUMatrix<short> const&);
+template void GPUSparseMatrix<short>::CopyToDenseMatrix(GPUMatrix<short>&) const;
+template void GPUSparseMatrix<short>::CopyToCPUSparseMatrix(CPUSparseMatrix<short>&) const;
+template void GPUSparseMatrix<short>::ChangeDeviceTo(int);
+template void GPUSparseMatrix<short>::Resize(const size_t numRows, const size_t numCols, const size_t numNZElemToReserve, const bool growOnly, bool keepExistingValues);
+template void GPUSparseMatrix<short>::Reset();
+template GPUSparseMatrix<short>::~GPUSparseMatrix();
+template GPUSparseMatrix<short> GPUSparseMatrix<short>::ColumnSlice(size_t startColumn, size_t numCols) const;
+template GPUMatrix<short> GPUSparseMatrix<short>::CopyColumnSliceToDense(size_t startColumn, size_t numCols) const;
+template GPUSparseMatrix<short>& GPUSparseMatrix<short>::operator=(GPUSparseMatrix<short>&& deepCopy);
+
 template <class ElemType>
 MATH_API File& operator>>(File& stream, GPUSparseMatrix<ElemType>& us)
 {
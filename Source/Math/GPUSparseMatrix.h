@@ -238,6 +238,7 @@ public:
 
     GPUMatrix<ElemType> CopyToDenseMatrix() const;
     void CopyToDenseMatrix(GPUMatrix<ElemType>& denseMatrix) const;
+    void CopyToDenseMatrix(GPUMatrix<ElemType>& denseMatrix, const ElemType alpha, const ElemType beta) const; // denseMatrix = beta * denseMatrix + alpha * this, fused into one kernel
     void CopyToCPUSparseMatrix(CPUSparseMatrix<ElemType>& cpuSparseMatrix) const;
     void ChangeDeviceTo(DEVICEID_TYPE toId);
 
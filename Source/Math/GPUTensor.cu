@@ -481,6 +481,29 @@ __global__ void _launchTensorOp(ElemType beta, FixedArray<ElemType*, N> pointers
         TensorOpElement<ElemType, N, M, K, false, K - 1>::Compute(id, beta, pointers, alpha, op, regularOpStrides, regularStrides, reducingOpDims, reducingStrides, 0, 0);
 }
 
+// flat specialization for the case that all operands are stored contiguously in the output's layout
+// Then the coordinate math of TensorOpElement cancels out entirely, and the linear thread id is the
+// element offset for every operand. This saves the div/mod chain and the stride registers, which is
+// measurable on small elementwise launches. Analogous to _launchUnaryTensorOp below, but for any arity.
+template <class ElemType, C_size_t N>
+__global__ void _launchTensorOpLinear(ElemType beta, FixedArray<ElemType*, N> pointers, ElemType alpha, ElementWiseOperator op, CUDA_LONG numElements)
+{
+    CUDA_LONG id = GridDim::GetLinearThreadId();
+    if (id >= numElements)
+        return;
+    for (C_size_t i = 0; i < N; i++) // N = a small constant, this will be unrolled
+        pointers[i] += id;
+    ElemType val = TensorOps<ElemType>::Compute(pointers, op);
+    // scale
+    val *= alpha;
+    // combine with previous value in target matrix, then write it out
+    auto* pout = pointers[pointers.size() - 1];
+    if (beta != 0)
+        val += beta * *pout;
+    // save
+    *pout = val;
+}
+
 template <class ElemType, C_size_t N, C_int K>
 static void LaunchTensorOp(ElemType beta, array<ElemType*, N> pointerVector, ElemType alpha, ElementWiseOperator op,
                            const SmallVector<size_t>& regularOpDims, const array<SmallVector<ptrdiff_t>, N>& regularStrideVectors)
@@ -499,13 +522,25 @@ static void LaunchTensorOp(ElemType beta, array<ElemType*, N> pointerVector, Ele
     FixedArray<C_unsigned_int, /*M=*/0> reducingOpDims; // empty reduction dimensions
     FixedMatrix<C_int, N, /*M=*/0> reducingStrides;
 
+    // check whether every operand's strides match the dense strides of the output's dimensions
+    // This is the dominant case (K == 1 for whole matrices after TensorShape has flattened the
+    // dimensions; K == 2 for contiguous slices of 2D tensors), and then we can use the flat kernel,
+    // which indexes all operands by the linear thread id directly.
+    bool denseLayout = true;
+    for (C_size_t i = 0; i < N && denseLayout; i++)
+        for (C_size_t k = 0; k < regularOpDims.size() && denseLayout; k++)
+            denseLayout = (regularStrideVectors[i][k] == (ptrdiff_t) regularOpStrideVector[k]);
+
     // launch the kernel
     CUDA_LONG NN = (CUDA_LONG) numElements; // linear space identifying each individual input element
     cudaEvent_t done = nullptr;
     if (do_sync)
         CUDA_CALL(cudaEventCreate(&done));
     GridDim grid(NN);
-    _launchTensorOp<ElemType, N, /*M=*/0, K><<<grid.m_blocksPerGrid, grid.m_threadsPerBlock, 0, t_stream>>>(beta, pointers, alpha, op, regularOpStrides, regularStrides, grid.m_N, reducingOpDims, reducingStrides);
+    if (denseLayout)
+        _launchTensorOpLinear<ElemType, N><<<grid.m_blocksPerGrid, grid.m_threadsPerBlock, 0, t_stream>>>(beta, pointers, alpha, op, grid.m_N);
+    else
+        _launchTensorOp<ElemType, N, /*M=*/0, K><<<grid.m_blocksPerGrid, grid.m_threadsPerBlock, 0, t_stream>>>(beta, pointers, alpha, op, regularOpStrides, regularStrides, grid.m_N, reducingOpDims, reducingStrides);
     if (do_sync)
         CUDA_CALL(cudaEventRecord(done));
     if (do_sync)
@@ -581,7 +616,9 @@ static void LaunchTensorOpWithReduction(ElemType beta, array<ElemType*, N> point
 
         // By how much do we underutilize?
         // We increase #blocks by that factor by breaking reduction into that many chunks.
-        let numReductionChunks = CeilDiv(props.multiProcessorCount, NN);
+        // In determinism mode we never split: cross-chunk accumulation goes through
+        // atomicAdd(), whose ordering is non-deterministic across runs.
+        let numReductionChunks = IsDeterministicComputation() ? 1 : CeilDiv(props.multiProcessorCount, NN);
 
         // NN may be too large for a single dimension
         let blockXOverBy = CeilDiv(NN, props.maxGridSize[0]);
@@ -0,0 +1,112 @@
+#pragma once
+#ifndef __HALF_CONVERTER_H__
+#define __HALF_CONVERTER_H__
+
+#include "Basics.h"
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// HalfConverter -- scalar and buffer conversion between ElemType and IEEE 754 binary16 ("half")
+// Half values are carried around as raw unsigned short bit patterns; we store half but always
+// compute in ElemType, so no half arithmetic is ever needed on the CPU.
+template <class ElemType>
+class HalfConverter
+{
+public:
+    typedef unsigned short HalfType;
+    static_assert(sizeof(HalfType) == 2, "Half word size != 2 bytes");
+
+    // convert one value to half, rounding to nearest even; out-of-range values become +/-inf
+    static HalfType ToHalf(ElemType v)
+    {
+        float f = (float) v;
+        unsigned int bits = *(unsigned int*) &f;
+        unsigned int sign = (bits >> 16) & 0x8000u;
+        int e = (int) ((bits >> 23) & 0xffu) - 127 + 15; // re-bias the exponent from float to half
+        unsigned int m = bits & 0x007fffffu;
+
+        if (e >= 0x1f) // too large for half: inf, or NaN if the input was NaN
+        {
+            if (((bits >> 23) & 0xffu) == 0xffu && m != 0)
+                return (HalfType)(sign | 0x7e00u);
+            return (HalfType)(sign | 0x7c00u);
+        }
+        else if (e <= 0) // half subnormal range, or underflow to signed zero
+        {
+            if (e < -10)
+                return (HalfType) sign;
+            m |= 0x00800000u; // make the hidden bit explicit
+            unsigned int shift = (unsigned int) (14 - e);
+            unsigned int half = m >> shift;
+            unsigned int rem = m & ((1u << shift) - 1);
+            unsigned int mid = 1u << (shift - 1);
+            if (rem > mid || (rem == mid && (half & 1))) // round to nearest even
+                half++;
+            return (HalfType)(sign | half);
+        }
+        else // normal case
+        {
+            unsigned int half = ((unsigned int) e << 10) | (m >> 13);
+            unsigned int rem = m & 0x1fffu;
+            if (rem > 0x1000u || (rem == 0x1000u && (half & 1))) // round to nearest even
+                half++; // a carry out of the mantissa bumps the exponent, which is still the right answer (up to inf)
+            return (HalfType)(sign | half);
+        }
+    }
+
+    // convert one half value back; exact, since every half is representable as a float
+    static ElemType FromHalf(HalfType h)
+    {
+        unsigned int sign = ((unsigned int) h & 0x8000u) << 16;
+        unsigned int e = ((unsigned int) h >> 10) & 0x1fu;
+        unsigned int m = (unsigned int) h & 0x3ffu;
+        unsigned int bits;
+
+        if (e == 0x1f) // inf or NaN
+            bits = sign | 0x7f800000u | (m << 13);
+        else if (e != 0) // normal case
+            bits = sign | ((e + 127 - 15) << 23) | (m << 13);
+        else if (m == 0) // signed zero
+            bits = sign;
+        else // half subnormal: renormalize, floats reach much further down
+        {
+            unsigned int exp = 127 - 15 + 1;
+            while ((m & 0x400u) == 0)
+            {
+                m <<= 1;
+                exp--;
+            }
+            m &= 0x3ffu; // drop the hidden bit again
+            bits = sign | (exp << 23) | (m << 13);
+        }
+
+        float f = *(float*) &bits;
+        return (ElemType) f;
+    }
+
+    // buffer conversions
+    static void ToHalfBuffer(const ElemType* src, size_t numElements, HalfType* dst)
+    {
+        long count = (long) numElements;
+#pragma omp parallel for
+        for (long i = 0; i < count; i++)
+        {
+            dst[i] = ToHalf(src[i]);
+        }
+    }
+
+    static void FromHalfBuffer(const HalfType* src, size_t numElements, ElemType* dst)
+    {
+        long count = (long) numElements;
+#pragma omp parallel for
+        for (long i = 0; i < count; i++)
+        {
+            dst[i] = FromHalf(src[i]);
+        }
+    }
+};
+}
+}
+}
+
+#endif // __HALF_CONVERTER_H__
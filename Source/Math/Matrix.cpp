@@ -13,6 +13,7 @@
 #include "GPUSparseMatrix.h"
 #include "File.h"
 #include <assert.h>
+#include <atomic>
 #include <math.h>
 #include "GPUWatcher.h" // bring in this class as well so that it gets exported from this DLL
 #ifndef CPUONLY
@@ -28,8 +29,22 @@
 #endif
 
 //before calling the following macro the current matrix location and matrix type on MatrixPointerToCheck must have been set correctly
+// sampling hook of the dispatch profiler (see CNTK_MATRIX_PROFILE further down) and hook of the
+// FLOP/byte accounting (see AccumulateMatrixOpModel() further down); expands to two flag checks
+// that are all the hot path pays, with the actual recording in function calls
+#define MATRIX_PROFILE_DISPATCH(MatrixPointerToCheck)                                                    \
+    if (s_matrixOpAccountingEnabled)                                                                     \
+        AccumulateMatrixOpModel((MatrixPointerToCheck)->GetNumRows(),                                    \
+                                (MatrixPointerToCheck)->GetNumCols(), sizeof(ElemType));                 \
+    if (s_matrixProfilePeriod != 0 && --t_matrixProfileCountdown <= 0)                                   \
+        RecordMatrixDispatchSample(__func__, (int) (MatrixPointerToCheck)->GetNumRows(),                 \
+                                   (int) (MatrixPointerToCheck)->GetNumCols(),                           \
+                                   (int) (MatrixPointerToCheck)->GetDeviceId(),                          \
+                                   (MatrixPointerToCheck)->GetMatrixType() == MatrixType::SPARSE);
+
 #define DISPATCH_MATRIX_ON_FLAG(MatrixPointerToCheck, MatrixPointerToSetFlag, CPUDense, GPUDense, CPUSparse, GPUSparse) \
     {                                                                                                                   \
+        MATRIX_PROFILE_DISPATCH(MatrixPointerToCheck);                                                                  \
         CurrentDataLocation curLocation = (MatrixPointerToCheck)->GetCurrentMatrixLocation();                           \
         if (curLocation == CurrentDataLocation::GPU || curLocation == CurrentDataLocation::BOTH)                        \
         {                                                                                                               \
@@ -70,6 +85,7 @@
 //before calling the following macro the current matrix location and matrix type on MatrixPointerToCheck must have been set correctly
 #define DISPATCH_MATRIX_ON_FLAG_USECPU_4BOTH(MatrixPointerToCheck, MatrixPointerToSetFlag, CPUDense, GPUDense, CPUSparse, GPUSparse) \
     {                                                                                                                                \
+        MATRIX_PROFILE_DISPATCH(MatrixPointerToCheck);                                                                               \
         CurrentDataLocation curLocation = (MatrixPointerToCheck)->GetCurrentMatrixLocation();                                        \
         if (curLocation == CurrentDataLocation::GPU)                                                                                 \
         {                                                                                                                            \
@@ -110,6 +126,7 @@
 //before calling the following macro the current matrix location and matrix type on MatrixPointerToCheck must have been set correctly
 #define DISPATCH_MATRIX_ON_FLAG_USEBOTH_4BOTH(MatrixPointerToCheck, MatrixPointerToSetFlag, CPUDense, GPUDense, CPUSparse, GPUSparse) \
     {                                                                                                                                 \
+        MATRIX_PROFILE_DISPATCH(MatrixPointerToCheck);                                                                                \
         CurrentDataLocation curLocation = (MatrixPointerToCheck)->GetCurrentMatrixLocation();                                         \
         if (curLocation == CurrentDataLocation::BOTH)                                                                                 \
         {                                                                                                                             \
@@ -190,8 +207,241 @@ DEVICEID_TYPE EnforceOneGPUOnly(DEVICEID_TYPE requestedDeviceId)
     return theGPUId;
 }
 
+// determinism mode (see CommonMatrix.h); consulted by the CPU reductions in CPUMatrix.cpp,
+// the GPU tensor-reduction launcher in GPUTensor.cu, and the curand-based random fills
+static bool s_deterministicComputation = false;
+void SetDeterministicComputation(bool enable)
+{
+    if (enable && !s_deterministicComputation)
+        fprintf(stderr, "SetDeterministicComputation: results will be bitwise-reproducible; expect some slowdown in reductions\n");
+    s_deterministicComputation = enable;
+}
+bool IsDeterministicComputation()
+{
+    return s_deterministicComputation;
+}
+
+// quantized inference mode (see CommonMatrix.h); consulted by the inference product in
+// TimesNodeBase, which caches an 8-bit copy of each constant weight matrix on first use
+static bool s_quantizedInference = false;
+void SetQuantizedInference(bool enable)
+{
+    if (enable && !s_quantizedInference)
+        fprintf(stderr, "SetQuantizedInference: CPU inference products against constant weights will use 8-bit integer arithmetic\n");
+    s_quantizedInference = enable;
+}
+bool IsQuantizedInference()
+{
+    return s_quantizedInference;
+}
+
+// prepacked weight mode (see CommonMatrix.h); consulted by the inference product in
+// TimesNodeBase, which packs each constant weight matrix once on first use
+static bool s_prepackedWeights = false;
+void SetPrepackedWeights(bool enable)
+{
+    if (enable && !s_prepackedWeights)
+        fprintf(stderr, "SetPrepackedWeights: CPU inference products against constant weights will use persistently packed GEMM operands\n");
+    s_prepackedWeights = enable;
+}
+bool UsePrepackedWeights()
+{
+    return s_prepackedWeights;
+}
+
 namespace Microsoft { namespace MSR { namespace CNTK {
 
+// process-wide counters of cross-device data movement (elements actually copied, not emptyTransfer calls);
+// ping-ponging matrices are hard to spot from per-matrix warnings alone, so these totals can be reported per epoch
+static std::atomic<unsigned long long> s_numCpuToGpuTransfers(0);
+static std::atomic<unsigned long long> s_numGpuToCpuTransfers(0);
+static std::atomic<unsigned long long> s_numCpuToGpuElements(0);
+static std::atomic<unsigned long long> s_numGpuToCpuElements(0);
+
+void ResetMatrixTransferStatistics()
+{
+    s_numCpuToGpuTransfers = 0;
+    s_numGpuToCpuTransfers = 0;
+    s_numCpuToGpuElements = 0;
+    s_numGpuToCpuElements = 0;
+}
+
+void ReportMatrixTransferStatistics(const char* caption)
+{
+    fprintf(stderr, "%s: %llu CPU-to-GPU transfers (%llu elements), %llu GPU-to-CPU transfers (%llu elements)\n",
+            caption,
+            (unsigned long long) s_numCpuToGpuTransfers, (unsigned long long) s_numCpuToGpuElements,
+            (unsigned long long) s_numGpuToCpuTransfers, (unsigned long long) s_numGpuToCpuElements);
+}
+
+static void CountTransfer(bool toGpu, size_t numElements)
+{
+    if (toGpu)
+    {
+        s_numCpuToGpuTransfers++;
+        s_numCpuToGpuElements += numElements;
+    }
+    else
+    {
+        s_numGpuToCpuTransfers++;
+        s_numGpuToCpuElements += numElements;
+    }
+}
+
+// -----------------------------------------------------------------------
+// sampled profiling of the dispatch hot path (environment variable CNTK_MATRIX_PROFILE=N)
+// -----------------------------------------------------------------------
+// Every Nth operation going through the DISPATCH macros (counted per thread) records the
+// dispatching method, the shape of the dispatched-on operand, its device, and dense/sparse into
+// a per-thread ring of the most recent samples; at process exit the rings are aggregated into a
+// histogram printed to stderr, e.g. to spot ops that unexpectedly run on the CPU or that hit a
+// dense kernel with sparse operands. Hot-path cost when disabled is one load and one predictable
+// branch; when enabled, a thread-local countdown decrement. Locks are only taken when a thread
+// records its very first sample (to register its ring) and in the exit dump.
+
+struct MatrixDispatchSample
+{
+    const char* operation; // name of the dispatching Matrix method (static storage, from __func__)
+    int rows, cols;        // shape of the operand the dispatch decision was made on
+    int deviceId;
+    bool sparse;
+};
+
+struct MatrixDispatchSampleRing
+{
+    static const size_t ringSize = 1 << 14; // newest samples overwrite the oldest beyond this
+    MatrixDispatchSample samples[ringSize];
+    size_t numRecorded; // total ever recorded; samples[numRecorded % ringSize] is the next slot
+};
+
+static long GetMatrixProfilePeriodFromEnv()
+{
+    const char* period = getenv("CNTK_MATRIX_PROFILE");
+    return (period != nullptr) ? atol(period) : 0;
+}
+static const long s_matrixProfilePeriod = GetMatrixProfilePeriodFromEnv(); // 0 = disabled
+
+static std::mutex s_matrixProfileMutex;                             // guards the ring registry
+static std::vector<MatrixDispatchSampleRing*> s_matrixProfileRings; // one ring per thread that has sampled
+
+#ifdef _WIN32
+static __declspec(thread) long t_matrixProfileCountdown = 0;
+static __declspec(thread) MatrixDispatchSampleRing* t_matrixProfileRing = nullptr;
+#else
+static __thread long t_matrixProfileCountdown = 0;
+static __thread MatrixDispatchSampleRing* t_matrixProfileRing = nullptr;
+#endif
+
+// registered with atexit(); aggregates all threads' rings into one histogram
+// (threads may still be running; a sample raced with here merely lands in the wrong bucket)
+static void DumpMatrixDispatchProfile()
+{
+    std::lock_guard<std::mutex> lock(s_matrixProfileMutex);
+    std::map<std::string, size_t> histogram;
+    size_t numSamples = 0;
+    for (const auto* ring : s_matrixProfileRings)
+    {
+        size_t numKept = min(ring->numRecorded, (size_t) MatrixDispatchSampleRing::ringSize);
+        for (size_t i = 0; i < numKept; i++)
+        {
+            const MatrixDispatchSample& sample = ring->samples[i];
+            char key[256];
+            sprintf(key, "%-40s %8d x %-8d device %3d  %s", sample.operation, sample.rows, sample.cols,
+                    sample.deviceId, sample.sparse ? "sparse" : "dense");
+            histogram[key]++;
+            numSamples++;
+        }
+    }
+    std::vector<std::pair<size_t, const std::string*>> sorted;
+    for (const auto& entry : histogram)
+        sorted.push_back(std::make_pair(entry.second, &entry.first));
+    std::sort(sorted.begin(), sorted.end(),
+              [](const std::pair<size_t, const std::string*>& a, const std::pair<size_t, const std::string*>& b)
+              {
+                  return a.first > b.first;
+              });
+    fprintf(stderr, "\nMatrix dispatch profile (1 in %ld operations sampled; %d samples kept):\n",
+            s_matrixProfilePeriod, (int) numSamples);
+    for (const auto& entry : sorted)
+        fprintf(stderr, "%10d  %s\n", (int) entry.first, entry.second->c_str());
+}
+
+// slow path of the sampling hook in the DISPATCH macros; called for every Nth dispatch per thread
+static void RecordMatrixDispatchSample(const char* operation, int rows, int cols, int deviceId, bool sparse)
+{
+    t_matrixProfileCountdown = s_matrixProfilePeriod; // restart the countdown
+    MatrixDispatchSampleRing* ring = t_matrixProfileRing;
+    if (ring == nullptr) // first sample on this thread: create and register its ring
+    {
+        ring = new MatrixDispatchSampleRing(); // never freed; the exit dump reads it
+        ring->numRecorded = 0;
+        std::lock_guard<std::mutex> lock(s_matrixProfileMutex);
+        if (s_matrixProfileRings.empty())
+            atexit(DumpMatrixDispatchProfile);
+        s_matrixProfileRings.push_back(ring);
+        t_matrixProfileRing = ring;
+    }
+    MatrixDispatchSample& sample = ring->samples[ring->numRecorded % MatrixDispatchSampleRing::ringSize];
+    sample.operation = operation;
+    sample.rows = rows;
+    sample.cols = cols;
+    sample.deviceId = deviceId;
+    sample.sparse = sparse;
+    ring->numRecorded++;
+}
+
+// -----------------------------------------------------------------------
+// model-based FLOP/byte accounting of Matrix operations (roofline counters)
+// -----------------------------------------------------------------------
+// When enabled, every operation going through the DISPATCH macros credits a model-based estimate
+// of floating-point operations and bytes touched to a pair of per-thread counters. The per-node
+// timing instrumentation snapshots the counters around each node execution and attributes the
+// difference to the node (see ComputationNode::BeginTiming()), from which ReportNodeTiming()
+// derives achieved GFLOP/s, GB/s, and arithmetic intensity per node and per operation class.
+// The generic model treats an operation as elementwise over the operand the dispatch decision
+// was made on (1 FLOP per element, one read and one write per element); matrix products, whose
+// cost is not a function of any single operand's shape, add an explicit 2*m*n*k credit on top
+// in MultiplyAndWeightedAdd(). These are estimates from operand shapes, not measurements --
+// sufficient to tell a bandwidth-bound node from a compute-bound one.
+
+static bool s_matrixOpAccountingEnabled = false;
+#ifdef _WIN32
+static __declspec(thread) double t_matrixOpFlops = 0;
+static __declspec(thread) double t_matrixOpBytes = 0;
+#else
+static __thread double t_matrixOpFlops = 0;
+static __thread double t_matrixOpBytes = 0;
+#endif
+
+void EnableMatrixOpAccounting(bool enable)
+{
+    s_matrixOpAccountingEnabled = enable;
+}
+
+void ReadMatrixOpCounters(double& flops, double& bytes)
+{
+    flops = t_matrixOpFlops;
+    bytes = t_matrixOpBytes;
+}
+
+// the generic elementwise model, invoked from the DISPATCH macros
+static inline void AccumulateMatrixOpModel(size_t rows, size_t cols, size_t elemSize)
+{
+    double numElements = (double) rows * (double) cols;
+    t_matrixOpFlops += numElements;
+    t_matrixOpBytes += 2 * numElements * (double) elemSize;
+}
+
+// explicit credit for operations the generic model misses (matrix products)
+static inline void AccumulateMatrixOpExtra(double flops, double bytes)
+{
+    if (s_matrixOpAccountingEnabled)
+    {
+        t_matrixOpFlops += flops;
+        t_matrixOpBytes += bytes;
+    }
+}
+
 #pragma region Constructors, destructors and other static matrix builders
 
 //This function will only initialize default bland matrix. The actual matrices need to allocated
@@ -739,6 +989,30 @@ void Matrix<ElemType>::CopySection(size_t numRows, size_t numCols, ElemType* dst
                             NOT_IMPLEMENTED);
 }
 
+// export the matrix as a packed half-precision (IEEE binary16) array; caller allocates GetNumElements() entries
+template <class ElemType>
+void Matrix<ElemType>::CopyToFloat16Array(unsigned short* halfArray) const
+{
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            nullptr,
+                            m_CPUMatrix->CopyToFloat16Array(halfArray),
+                            m_GPUMatrix->CopyToFloat16Array(halfArray),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
+// set the matrix from a packed half-precision array (inverse of CopyToFloat16Array)
+template <class ElemType>
+void Matrix<ElemType>::SetValueFromFloat16Array(const size_t numRows, const size_t numCols, const unsigned short* halfArray)
+{
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            this,
+                            m_CPUMatrix->SetValueFromFloat16Array(numRows, numCols, halfArray),
+                            m_GPUMatrix->SetValueFromFloat16Array(numRows, numCols, halfArray),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
 // BUGBUG: Some code checks before calling here whether one of the dimensions is 0.
 //         This function must handle that case properly, that is, preserving the non-zero dimension.
 template <class ElemType>
@@ -1022,24 +1296,26 @@ void Matrix<ElemType>::CopyElementsFromDenseToSparse(CPUMatrix<ElemType>& from,
 template <class ElemType>
 ElemType Matrix<ElemType>::Get00Element() const
 {
-    DISPATCH_MATRIX_ON_FLAG(this,
-                            nullptr,
-                            return m_CPUMatrix->Get00Element(),
-                            return m_GPUMatrix->Get00Element(),
-                            NOT_IMPLEMENTED,
-                            NOT_IMPLEMENTED);
+    // if a live host mirror exists (data location BOTH), serve the read locally instead of
+    // issuing a one-element device-to-host copy
+    DISPATCH_MATRIX_ON_FLAG_USECPU_4BOTH(this,
+                                         nullptr,
+                                         return m_CPUMatrix->Get00Element(),
+                                         return m_GPUMatrix->Get00Element(),
+                                         NOT_IMPLEMENTED,
+                                         NOT_IMPLEMENTED);
 }
 
 template <class ElemType>
 const ElemType Matrix<ElemType>::operator()(const size_t row, const size_t col) const
 {
+    // a const single-element read does not need the whole buffer on the CPU side; read back just that element
     DISPATCH_MATRIX_ON_FLAG_USECPU_4BOTH(this,
                                          nullptr,
                                          return m_CPUMatrix->operator()(row, col),
-                                         _transferFromDeviceToDevice(GetDeviceId(), CPUDEVICE, false);
-                                         return m_CPUMatrix->operator()(row, col),
-                                                NOT_IMPLEMENTED,
-                                                NOT_IMPLEMENTED);
+                                         return m_GPUMatrix->GetValue(row, col),
+                                         NOT_IMPLEMENTED,
+                                         NOT_IMPLEMENTED);
 }
 
 //WARNING: This function is very slow for GPUs since it requires copying values between CPUs and GPUs.
@@ -1051,6 +1327,7 @@ ElemType& Matrix<ElemType>::operator()(const size_t row, const size_t col)
 {
     DISPATCH_MATRIX_ON_FLAG_USECPU_4BOTH(this,
                                          nullptr,
+                                         SetDataLocation(CPU, DENSE); /*handing out a writable reference invalidates any device mirror (BOTH state)*/
                                          return m_CPUMatrix->operator()(row, col),
                                          _transferFromDeviceToDevice(GetDeviceId(), CPUDEVICE, false);
                                          SetDataLocation(CPU, DENSE); return m_CPUMatrix->operator()(row, col),
@@ -1377,17 +1654,25 @@ void Matrix<ElemType>::NormalGrad(Matrix<ElemType>& gradients,
                                   Matrix<ElemType>& functionValues,
                                   const ElemType learnRatePerSample,
                                   const ElemType momentum,
-                                  const bool useNesterovMomentum)
+                                  const bool useNesterovMomentum,
+                                  const ElemType gradientScale)
 {
     DecideAndMoveToRightDevice(*this, gradients, functionValues);
 
+    // The gradient only ever enters the update multiplied by the learning-rate coefficients, so a
+    // uniform scale (norm-based clipping) can ride those coefficients for free instead of an
+    // in-place rescaling pass over the gradient matrix. The sparse paths feed the raw gradient
+    // into the smoothed gradient, where a scale cannot be folded in.
+    if (gradientScale != 1 && (gradients.GetMatrixType() == MatrixType::SPARSE))
+        LogicError("NormalGrad: gradientScale is only supported for dense gradient matrices.");
+
     if (!useNesterovMomentum)
     {
         DISPATCH_MATRIX_ON_FLAG(&gradients,
                                 nullptr,
-                                ScaleAndAdd((1 - momentum) * learnRatePerSample, gradients, momentum, *this);
+                                ScaleAndAdd((1 - momentum) * learnRatePerSample * gradientScale, gradients, momentum, *this);
                                 functionValues -= *this,
-                                ScaleAndAdd((1 - momentum) * learnRatePerSample, gradients, momentum, *this);
+                                ScaleAndAdd((1 - momentum) * learnRatePerSample * gradientScale, gradients, momentum, *this);
                                 functionValues -= *this,
                                 if (momentum != 0) gradients.m_CPUSparseMatrix->NormalGrad(*m_CPUMatrix, momentum);
                                 ScaleAndAdd(-learnRatePerSample, gradients, functionValues),
@@ -1399,15 +1684,15 @@ void Matrix<ElemType>::NormalGrad(Matrix<ElemType>& gradients,
         DISPATCH_MATRIX_ON_FLAG(&gradients,
                                 nullptr,
                                 { /* CPU dense */
-                                  ScaleAndAdd((1 - momentum) * learnRatePerSample, gradients, momentum, *this);
+                                  ScaleAndAdd((1 - momentum) * learnRatePerSample * gradientScale, gradients, momentum, *this);
                                   ScaleAndAdd(-momentum, *this, functionValues);
-                                  ScaleAndAdd(-(1 - momentum) * learnRatePerSample, gradients, functionValues);
+                                  ScaleAndAdd(-(1 - momentum) * learnRatePerSample * gradientScale, gradients, functionValues);
                                   // w_t = w_{t-1} - momentum * v_ {t-1} - (1-momentum)*learnRatePerSampele*gardient,
                                 },
                                 { /* GPU dense */
-                                  ScaleAndAdd((1 - momentum) * learnRatePerSample, gradients, momentum, *this);
+                                  ScaleAndAdd((1 - momentum) * learnRatePerSample * gradientScale, gradients, momentum, *this);
                                   ScaleAndAdd(-momentum, *this, functionValues);
-                                  ScaleAndAdd(-(1 - momentum) * learnRatePerSample, gradients, functionValues);
+                                  ScaleAndAdd(-(1 - momentum) * learnRatePerSample * gradientScale, gradients, functionValues);
                                 },
                                 { /* CPU sparse */
                                   if (momentum != 0)
@@ -1450,6 +1735,23 @@ ElemType Matrix<ElemType>::Adagrad(Matrix<ElemType>& gradients, const bool needA
                             SetDataLocation(GPU));
 }
 
+// fused Adagrad + weight step in one pass; dense gradients only, and only without the
+// average multiplier (see SGD::UpdateWeightsS for the dispatch)
+template <class ElemType>
+void Matrix<ElemType>::AdagradUpdate(Matrix<ElemType>& gradients, Matrix<ElemType>& functionValues, const ElemType learnRatePerSample)
+{
+    DecideAndMoveToRightDevice(*this, gradients, functionValues);
+
+    DISPATCH_MATRIX_ON_FLAG(&gradients,
+                            &gradients,
+                            m_CPUMatrix->AdagradUpdate(*gradients.m_CPUMatrix, *functionValues.m_CPUMatrix, learnRatePerSample);
+                            SetDataLocation(CPU),
+                            m_GPUMatrix->AdagradUpdate(*gradients.m_GPUMatrix, *functionValues.m_GPUMatrix, learnRatePerSample);
+                            SetDataLocation(GPU),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
 template <class ElemType>
 void Matrix<ElemType>::FSAdagrad(size_t mbSize, Matrix<ElemType>& gradients, Matrix<ElemType>& functionValues, const ElemType learnRatePerSample, const ElemType momentum)
 {
@@ -1789,6 +2091,67 @@ Matrix<ElemType>& Matrix<ElemType>::AddWithRowSliceValuesOf(const Matrix<ElemTyp
     return *this;
 }
 
+// gather/scatter of rows by an index matrix
+// 'idx' holds row indices into the larger matrix, stored as ElemType; it has either a single
+// column (shared by all minibatch columns) or one column per minibatch column.
+
+// us(i,j) = a(idx(i, j or 0), j)
+template <class ElemType>
+Matrix<ElemType>& Matrix<ElemType>::AssignRowGatherOf(const Matrix<ElemType>& idx, const Matrix<ElemType>& a)
+{
+    DecideAndMoveToRightDevice(a, idx, *this);
+    SwitchToMatrixType(a.GetMatrixType(), a.GetFormat(), false);
+
+    DISPATCH_MATRIX_ON_FLAG(&a,
+                            this,
+                            m_CPUMatrix->AssignRowGatherOf(*idx.m_CPUMatrix, *a.m_CPUMatrix),
+                            m_GPUMatrix->AssignRowGatherOf(*idx.m_GPUMatrix, *a.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+
+    return *this;
+}
+
+// us(i,j) += a(idx(i, j or 0), j)
+template <class ElemType>
+Matrix<ElemType>& Matrix<ElemType>::AddWithRowGatherOf(const Matrix<ElemType>& idx, const Matrix<ElemType>& a)
+{
+    DecideAndMoveToRightDevice(*this, idx, a);
+
+    // WARNING: a and this must have same type
+    if (!(GetMatrixType() == a.GetMatrixType()))
+        NOT_IMPLEMENTED;
+
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            this,
+                            m_CPUMatrix->AddWithRowGatherOf(*idx.m_CPUMatrix, *a.m_CPUMatrix),
+                            m_GPUMatrix->AddWithRowGatherOf(*idx.m_GPUMatrix, *a.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+
+    return *this;
+}
+
+// us(idx(i, j or 0), j) += a(i,j); repeated indices accumulate
+template <class ElemType>
+Matrix<ElemType>& Matrix<ElemType>::AddRowScatterOf(const Matrix<ElemType>& idx, const Matrix<ElemType>& a)
+{
+    DecideAndMoveToRightDevice(*this, idx, a);
+
+    // WARNING: a and this must have same type
+    if (!(GetMatrixType() == a.GetMatrixType()))
+        NOT_IMPLEMENTED;
+
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            this,
+                            m_CPUMatrix->AddRowScatterOf(*idx.m_CPUMatrix, *a.m_CPUMatrix),
+                            m_GPUMatrix->AddRowScatterOf(*idx.m_GPUMatrix, *a.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+
+    return *this;
+}
+
 template <class ElemType>
 Matrix<ElemType>& Matrix<ElemType>::AssignRepeatOf(const Matrix<ElemType>& a, const size_t numRowRepeats, const size_t numColRepeats)
 {
@@ -1808,6 +2171,106 @@ Matrix<ElemType>& Matrix<ElemType>::AssignRepeatOf(const Matrix<ElemType>& a, co
     return *this;
 }
 
+// pack the columns listed in columnIndices contiguously into [this] ([this] column j = a column columnIndices[j])
+// Together with ScatterGatheredColumnsOf() and MBLayout::GetValidColumnIndices() this lets a caller
+// compact gap columns out of a minibatch, run a compute-heavy operation on the dense packed matrix,
+// and spread the result back, so the flops are spent on real frames only.
+template <class ElemType>
+Matrix<ElemType>& Matrix<ElemType>::AssignGatheredColumnsOf(const Matrix<ElemType>& a, const std::vector<size_t>& columnIndices)
+{
+    DecideAndMoveToRightDevice(*this, a);
+
+    // WARNING: a and this must have same type
+    if (!(GetMatrixType() == a.GetMatrixType()))
+        NOT_IMPLEMENTED;
+
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            this,
+                            m_CPUMatrix->AssignGatheredColumnsOf(*a.m_CPUMatrix, columnIndices),
+                            m_GPUMatrix->AssignGatheredColumnsOf(*a.m_GPUMatrix, columnIndices),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+
+    return *this;
+}
+
+// inverse of AssignGatheredColumnsOf: spread the packed columns back out ([this] column columnIndices[j] = packed column j)
+// columns of [this] not listed in columnIndices are left untouched
+template <class ElemType>
+Matrix<ElemType>& Matrix<ElemType>::ScatterGatheredColumnsOf(const Matrix<ElemType>& packed, const std::vector<size_t>& columnIndices)
+{
+    DecideAndMoveToRightDevice(*this, packed);
+
+    // WARNING: packed and this must have same type
+    if (!(GetMatrixType() == packed.GetMatrixType()))
+        NOT_IMPLEMENTED;
+
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            this,
+                            m_CPUMatrix->ScatterGatheredColumnsOf(*packed.m_CPUMatrix, columnIndices),
+                            m_GPUMatrix->ScatterGatheredColumnsOf(*packed.m_GPUMatrix, columnIndices),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+
+    return *this;
+}
+
+// quantize [this] (a weight matrix) for 8-bit inference: qweightsT receives the quantized weights
+// stored transposed, rowScales one scale per weight row. CPU dense only; see CPUMatrix for details.
+template <class ElemType>
+void Matrix<ElemType>::QuantizeForInference(Matrix<short>& qweightsT, Matrix<ElemType>& rowScales) const
+{
+    if (GetDeviceId() != CPUDEVICE || qweightsT.GetDeviceId() != CPUDEVICE || rowScales.GetDeviceId() != CPUDEVICE)
+        RuntimeError("QuantizeForInference: quantized inference is CPU-only.");
+    if (GetMatrixType() != MatrixType::DENSE)
+        NOT_IMPLEMENTED;
+
+    m_CPUMatrix->QuantizeTransposedRowwise(*qweightsT.m_CPUMatrix, *rowScales.m_CPUMatrix);
+}
+
+// output = weights * input where (qweightsT, rowScales) came from QuantizeForInference() on the weights
+template <class ElemType>
+void Matrix<ElemType>::MultiplyQuantized(const Matrix<short>& qweightsT, const Matrix<ElemType>& rowScales, const Matrix<ElemType>& input, Matrix<ElemType>& output)
+{
+    if (qweightsT.GetDeviceId() != CPUDEVICE || input.GetDeviceId() != CPUDEVICE || output.GetDeviceId() != CPUDEVICE)
+        RuntimeError("MultiplyQuantized: quantized inference is CPU-only.");
+    if (input.GetMatrixType() != MatrixType::DENSE || output.GetMatrixType() != MatrixType::DENSE)
+        NOT_IMPLEMENTED;
+
+    CPUMatrix<ElemType>::MultiplyQuantized(*qweightsT.m_CPUMatrix, *rowScales.m_CPUMatrix, *input.m_CPUMatrix, *output.m_CPUMatrix);
+}
+
+// pack this matrix once into the BLAS' internal blocked GEMM layout, for repeated products
+// through MultiplyPacked(); returns null when the BLAS has no packed-GEMM interface
+template <class ElemType>
+std::shared_ptr<ElemType> Matrix<ElemType>::PackForMultiply(bool transpose) const
+{
+    if (GetDeviceId() != CPUDEVICE)
+        RuntimeError("PackForMultiply: prepacked weights are CPU-only.");
+    if (GetMatrixType() != MatrixType::DENSE)
+        NOT_IMPLEMENTED;
+
+    ElemType* packed = CPUMatrix<ElemType>::PackForMultiply(*m_CPUMatrix, transpose);
+    if (packed == nullptr)
+        return nullptr;
+    return std::shared_ptr<ElemType>(packed, [](ElemType* p)
+                                     {
+                                         CPUMatrix<ElemType>::ReleasePackedMultiply(p);
+                                     });
+}
+
+// output = op(weights) * input where packedA came from PackForMultiply() on the (aRows x aCols) weights
+template <class ElemType>
+void Matrix<ElemType>::MultiplyPacked(const std::shared_ptr<ElemType>& packedA, size_t aRows, size_t aCols, bool transposeA, const Matrix<ElemType>& input, Matrix<ElemType>& output)
+{
+    if (input.GetDeviceId() != CPUDEVICE || output.GetDeviceId() != CPUDEVICE)
+        RuntimeError("MultiplyPacked: prepacked weights are CPU-only.");
+    if (input.GetMatrixType() != MatrixType::DENSE || output.GetMatrixType() != MatrixType::DENSE)
+        NOT_IMPLEMENTED;
+
+    CPUMatrix<ElemType>::MultiplyPackedAndAdd(packedA.get(), aRows, aCols, transposeA, *input.m_CPUMatrix, *output.m_CPUMatrix);
+}
+
 template <class ElemType>
 Matrix<ElemType>& Matrix<ElemType>::AddToRowRepeatValuesOf(const Matrix<ElemType>& a, const size_t numRepeats)
 {
@@ -2141,6 +2604,54 @@ Matrix<ElemType>& Matrix<ElemType>::AssignElementProductOf(const Matrix<ElemType
     return *this;
 }
 
+//[this]=dropout(a): zero each element with probability dropoutRate, scale survivors by scaleValue.
+//The mask is drawn from a counter-based RNG keyed on (randomSeed, offset + element index), so it
+//is never materialized; AddDropoutGradientOf() regenerates the identical mask in the backward pass.
+template <class ElemType>
+Matrix<ElemType>& Matrix<ElemType>::AssignDropoutOf(const Matrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset)
+{
+    if (a.IsEmpty())
+        LogicError("AssignDropoutOf: Matrix a is empty.");
+
+    DecideAndMoveToRightDevice(a, *this);
+    SwitchToMatrixType(a.GetMatrixType(), a.GetFormat(), false);
+
+    DISPATCH_MATRIX_ON_FLAG(&a,
+                            this,
+                            m_CPUMatrix->AssignDropoutOf(*a.m_CPUMatrix, dropoutRate, scaleValue, randomSeed, offset),
+                            m_GPUMatrix->AssignDropoutOf(*a.m_GPUMatrix, dropoutRate, scaleValue, randomSeed, offset),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+
+    return *this;
+}
+
+//[this]+=a .* scaleValue on the elements the dropout mask kept; must be called with the same
+//(randomSeed, offset) as the forward AssignDropoutOf() call so the regenerated mask matches
+template <class ElemType>
+Matrix<ElemType>& Matrix<ElemType>::AddDropoutGradientOf(const Matrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset)
+{
+    if (a.IsEmpty())
+        LogicError("AddDropoutGradientOf: Matrix a is empty.");
+
+    if (!(a.GetNumRows() == GetNumRows() && a.GetNumCols() == GetNumCols()))
+        InvalidArgument("The input matrix dimensions do not match [this].");
+
+    DecideAndMoveToRightDevice(*this, a);
+
+    if (!(a.GetMatrixType() == GetMatrixType()))
+        NOT_IMPLEMENTED;
+
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            nullptr,
+                            m_CPUMatrix->AddDropoutGradientOf(*a.m_CPUMatrix, dropoutRate, scaleValue, randomSeed, offset),
+                            m_GPUMatrix->AddDropoutGradientOf(*a.m_GPUMatrix, dropoutRate, scaleValue, randomSeed, offset),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+
+    return *this;
+}
+
 template <class ElemType>
 Matrix<ElemType>& Matrix<ElemType>::AddElementProductOf(const Matrix<ElemType>& a, const Matrix<ElemType>& b)
 {
@@ -2440,6 +2951,29 @@ Matrix<ElemType>& Matrix<ElemType>::AssignNumOfDiff(const Matrix<ElemType>& a, c
 
     return *this;
 }
+
+// fused top-K classification error: [this] becomes a 1 x 1 matrix holding the number of columns whose
+// true class (the argmax of the labels column) is not among the topK largest prediction scores.
+// Equivalent to the VectorMax()/AssignNumOfDiff() sequence but without the intermediate index/value matrices.
+template <class ElemType>
+Matrix<ElemType>& Matrix<ElemType>::AssignTopKError(const Matrix<ElemType>& labels, const Matrix<ElemType>& predictions, const int topK)
+{
+    DecideAndMoveToRightDevice(labels, predictions, *this);
+    // WARNING: labels and predictions must have same type
+    if (!(labels.GetMatrixType() == predictions.GetMatrixType()))
+        NOT_IMPLEMENTED;
+
+    SwitchToMatrixType(labels.GetMatrixType(), labels.GetFormat(), false);
+
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            this,
+                            m_CPUMatrix->AssignTopKError(*labels.m_CPUMatrix, *predictions.m_CPUMatrix, topK),
+                            m_GPUMatrix->AssignTopKError(*labels.m_GPUMatrix, *predictions.m_GPUMatrix, topK),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+
+    return *this;
+}
 //[this]=tanh([this]) element wise
 template <class ElemType>
 Matrix<ElemType>& Matrix<ElemType>::InplaceTanh()
@@ -2502,6 +3036,63 @@ Matrix<ElemType>& Matrix<ElemType>::AssignLogSoftmaxOf(const Matrix<ElemType>& a
     return *this;
 }
 
+//[this]=-sum(labels .* logsoftmax(predictions)), fused into a single pass over the predictions
+// softmaxStats is resized to 2 x cols and receives the per-column max and log partition function,
+// which AddScaledSoftmaxDifference and AddScaledLogSoftmax use in the backward pass to
+// reconstruct softmax values without a full-size temporary
+template <class ElemType>
+Matrix<ElemType>& Matrix<ElemType>::AssignCrossEntropyWithSoftmaxOf(const Matrix<ElemType>& labels, const Matrix<ElemType>& predictions, Matrix<ElemType>& softmaxStats, const Matrix<char>* columnsValidityMask /*= nullptr*/)
+{
+    if (labels.IsEmpty() || predictions.IsEmpty())
+        LogicError("AssignCrossEntropyWithSoftmaxOf: Matrix is empty.");
+
+    DecideAndMoveToRightDevice(labels, predictions, softmaxStats);
+    _transferToDevice(predictions.GetDeviceId());
+
+    if (columnsValidityMask != nullptr && columnsValidityMask->GetDeviceId() != predictions.GetDeviceId())
+        RuntimeError("AssignCrossEntropyWithSoftmaxOf: predictions and column mask must be on the same device");
+
+    if (!(labels.GetMatrixType() == predictions.GetMatrixType() && labels.GetMatrixType() == softmaxStats.GetMatrixType()))
+        NOT_IMPLEMENTED;
+
+    SwitchToMatrixType(predictions.GetMatrixType(), predictions.GetFormat(), false);
+
+    DISPATCH_MATRIX_ON_FLAG(&predictions,
+                            this,
+                            m_CPUMatrix->AssignCrossEntropyWithSoftmaxOf(*labels.m_CPUMatrix, *predictions.m_CPUMatrix, *softmaxStats.m_CPUMatrix, columnsValidityMask ? columnsValidityMask->m_CPUMatrix : nullptr),
+                            m_GPUMatrix->AssignCrossEntropyWithSoftmaxOf(*labels.m_GPUMatrix, *predictions.m_GPUMatrix, *softmaxStats.m_GPUMatrix, columnsValidityMask ? columnsValidityMask->m_GPUMatrix : nullptr),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+
+    return *this;
+}
+
+// index-label variant of AssignCrossEntropyWithSoftmaxOf: labelIndexes is 1 x cols and holds the
+// label class per column (negative = gap), avoiding the dense one-hot label matrix altogether
+template <class ElemType>
+Matrix<ElemType>& Matrix<ElemType>::AssignIndexedCrossEntropyWithSoftmaxOf(const Matrix<ElemType>& labelIndexes, const Matrix<ElemType>& predictions, Matrix<ElemType>& softmaxStats)
+{
+    if (labelIndexes.IsEmpty() || predictions.IsEmpty())
+        LogicError("AssignIndexedCrossEntropyWithSoftmaxOf: Matrix is empty.");
+
+    DecideAndMoveToRightDevice(labelIndexes, predictions, softmaxStats);
+    _transferToDevice(predictions.GetDeviceId());
+
+    if (!(labelIndexes.GetMatrixType() == predictions.GetMatrixType() && labelIndexes.GetMatrixType() == softmaxStats.GetMatrixType()))
+        NOT_IMPLEMENTED;
+
+    SwitchToMatrixType(predictions.GetMatrixType(), predictions.GetFormat(), false);
+
+    DISPATCH_MATRIX_ON_FLAG(&predictions,
+                            this,
+                            m_CPUMatrix->AssignIndexedCrossEntropyWithSoftmaxOf(*labelIndexes.m_CPUMatrix, *predictions.m_CPUMatrix, *softmaxStats.m_CPUMatrix),
+                            m_GPUMatrix->AssignIndexedCrossEntropyWithSoftmaxOf(*labelIndexes.m_GPUMatrix, *predictions.m_GPUMatrix, *softmaxStats.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+
+    return *this;
+}
+
 //[this]=softmax([this]) element wise
 template <class ElemType>
 Matrix<ElemType>& Matrix<ElemType>::InplaceHardmax(const bool isColWise)
@@ -3037,6 +3628,27 @@ ElemType Matrix<ElemType>::SumOfAbsElements() const
                             return m_GPUSparseMatrix->SumOfAbsElements());
 }
 
+// accumulate a log2-bucketed histogram of the element magnitudes into 'histogram' (numBuckets x 1)
+// Bucket 0 counts zeros and magnitudes below 2^minExponent; bucket b (b >= 1) counts magnitudes in
+// [2^(minExponent+b-1), 2^(minExponent+b)); the top bucket absorbs everything above the range. The
+// counts accumulate in place on the matrix's own device, so sampling a GPU-resident value costs one
+// small kernel and no device-to-host copy.
+template <class ElemType>
+void Matrix<ElemType>::AccumulateAbsLogHistogram(int minExponent, Matrix<ElemType>& histogram) const
+{
+    if (IsEmpty())
+        LogicError("AccumulateAbsLogHistogram: Matrix is empty.");
+    if (GetDeviceId() != histogram.GetDeviceId())
+        InvalidArgument("AccumulateAbsLogHistogram: matrix and histogram must live on the same device.");
+
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            &histogram,
+                            m_CPUMatrix->AccumulateAbsLogHistogram(minExponent, *histogram.m_CPUMatrix),
+                            m_GPUMatrix->AccumulateAbsLogHistogram(minExponent, *histogram.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
 //sum of all elements
 template <class ElemType>
 ElemType Matrix<ElemType>::LogAddSumOfElements() const
@@ -3557,6 +4169,9 @@ void Matrix<ElemType>::_transferToDevice(int to_id, bool ismoved, bool emptyTran
         RuntimeError("Cannot move externally owned matrices to the preferred device.");
 }
 
+// dense matrices up to this many elements keep a host mirror when uploaded to a GPU (see below)
+static const size_t c_maxElementsForHostMirror = 8;
+
 template <class ElemType>
 void Matrix<ElemType>::_transferFromDeviceToDevice(int from_id, int to_id, bool ismoved, bool emptyTransfer) const
 {
@@ -3607,6 +4222,7 @@ void Matrix<ElemType>::_transferFromDeviceToDevice(int from_id, int to_id, bool
             if (m_CPUSparseMatrix->GetNumElements() != 0 && !emptyTransfer)
             {
                 m_GPUSparseMatrix->SetValue(*m_CPUSparseMatrix);
+                CountTransfer(true /*toGpu*/, m_CPUSparseMatrix->NzCount());
             }
 
             if (ismoved)
@@ -3633,6 +4249,7 @@ void Matrix<ElemType>::_transferFromDeviceToDevice(int from_id, int to_id, bool
                 if (m_GPUSparseMatrix->GetNumElements() != 0 && !emptyTransfer)
                 {
                     m_GPUSparseMatrix->CopyToCPUSparseMatrix(*m_CPUSparseMatrix);
+                    CountTransfer(false /*toGpu*/, m_GPUSparseMatrix->NzCount());
                 }
 
                 if (ismoved)
@@ -3664,6 +4281,16 @@ void Matrix<ElemType>::_transferFromDeviceToDevice(int from_id, int to_id, bool
             if (m_CPUMatrix->GetNumElements() != 0 && !emptyTransfer)
             {
                 m_GPUMatrix = new GPUMatrix<ElemType>(m_CPUMatrix->GetNumRows(), m_CPUMatrix->GetNumCols(), to_id, m_CPUMatrix->GetArray(), matrixFlagNormal);
+                CountTransfer(true /*toGpu*/, m_CPUMatrix->GetNumElements());
+                // Tiny control matrices (clipping thresholds, the 1x1 alpha arguments of the
+                // AddScaledDifference family) are uploaded over and over and read back through
+                // Get00Element()/operator() just as often. Keep the host copy alive for these even
+                // if the caller asked for a move (data location BOTH): scalar reads are then served
+                // locally, and as long as the matrix is not written the next upload is a no-op.
+                // Writes collapse the BOTH state through the dispatch macros, so the mirror can
+                // never be read stale.
+                if (m_CPUMatrix->GetNumElements() <= c_maxElementsForHostMirror)
+                    ismoved = false;
             }
             else
             {
@@ -3695,6 +4322,7 @@ void Matrix<ElemType>::_transferFromDeviceToDevice(int from_id, int to_id, bool
                     ElemType* arr = m_GPUMatrix->CopyToArray(); // TODO: unnecessary allocation/copy; why not make this a vector that we move over as an rvalue ref?
                     m_CPUMatrix = new CPUMatrix<ElemType>(m_GPUMatrix->GetNumRows(), m_GPUMatrix->GetNumCols(), arr, matrixFlagNormal);
                     delete[] arr;
+                    CountTransfer(false /*toGpu*/, m_GPUMatrix->GetNumElements());
                 }
                 else
                 {
@@ -4002,6 +4630,75 @@ Matrix<ElemType>& Matrix<ElemType>::AddAveragePoolingGradient(const Matrix<ElemT
     return *this;
 }
 
+// fused batch normalization of 'this' (D x N, one sample per column) into 'out': minibatch
+// statistics, running-statistics update, and normalize+scale+shift in a single pass (one kernel
+// on GPU, one OpenMP pass on CPU). The statistics dimension is taken from 'scale' (S x 1):
+// S == D normalizes per activation, S < D shares statistics across the rows {s, s+S, ...}
+// (the spatial mode of the legacy convolution engine, whose layout keeps channels fastest).
+template <class ElemType>
+void Matrix<ElemType>::BatchNormalizationForward(const Matrix<ElemType>& scale, const Matrix<ElemType>& bias,
+                                                 double expAvgFactor, double epsilon,
+                                                 Matrix<ElemType>& runMean, Matrix<ElemType>& runInvStdDev,
+                                                 Matrix<ElemType>& out,
+                                                 Matrix<ElemType>& saveMean, Matrix<ElemType>& saveInvStdDev) const
+{
+    if (IsEmpty())
+        LogicError("BatchNormalizationForward: Matrix is empty.");
+
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            &out,
+                            m_CPUMatrix->BatchNormalizationForward(*scale.m_CPUMatrix, *bias.m_CPUMatrix, expAvgFactor, epsilon,
+                                                                   *runMean.m_CPUMatrix, *runInvStdDev.m_CPUMatrix,
+                                                                   *out.m_CPUMatrix, *saveMean.m_CPUMatrix, *saveInvStdDev.m_CPUMatrix),
+                            m_GPUMatrix->BatchNormalizationForward(*scale.m_GPUMatrix, *bias.m_GPUMatrix, expAvgFactor, epsilon,
+                                                                   *runMean.m_GPUMatrix, *runInvStdDev.m_GPUMatrix,
+                                                                   *out.m_GPUMatrix, *saveMean.m_GPUMatrix, *saveInvStdDev.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
+// inference-time counterpart of BatchNormalizationForward(): normalize with the running statistics
+template <class ElemType>
+void Matrix<ElemType>::BatchNormalizationForwardInference(const Matrix<ElemType>& scale, const Matrix<ElemType>& bias,
+                                                          const Matrix<ElemType>& runMean, const Matrix<ElemType>& runInvStdDev,
+                                                          Matrix<ElemType>& out) const
+{
+    if (IsEmpty())
+        LogicError("BatchNormalizationForwardInference: Matrix is empty.");
+
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            &out,
+                            m_CPUMatrix->BatchNormalizationForwardInference(*scale.m_CPUMatrix, *bias.m_CPUMatrix,
+                                                                            *runMean.m_CPUMatrix, *runInvStdDev.m_CPUMatrix, *out.m_CPUMatrix),
+                            m_GPUMatrix->BatchNormalizationForwardInference(*scale.m_GPUMatrix, *bias.m_GPUMatrix,
+                                                                            *runMean.m_GPUMatrix, *runInvStdDev.m_GPUMatrix, *out.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
+// backward pass of BatchNormalizationForward() over 'this' (the incoming gradient): accumulates
+// the input gradient into 'grad' and writes the scale and bias gradients, all in the same pass
+template <class ElemType>
+void Matrix<ElemType>::BatchNormalizationBackward(const Matrix<ElemType>& in, Matrix<ElemType>& grad,
+                                                  const Matrix<ElemType>& scale,
+                                                  const Matrix<ElemType>& saveMean, const Matrix<ElemType>& saveInvStdDev,
+                                                  Matrix<ElemType>& scaleGrad, Matrix<ElemType>& biasGrad) const
+{
+    if (IsEmpty())
+        LogicError("BatchNormalizationBackward: Matrix is empty.");
+
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            &grad,
+                            m_CPUMatrix->BatchNormalizationBackward(*in.m_CPUMatrix, *grad.m_CPUMatrix, *scale.m_CPUMatrix,
+                                                                    *saveMean.m_CPUMatrix, *saveInvStdDev.m_CPUMatrix,
+                                                                    *scaleGrad.m_CPUMatrix, *biasGrad.m_CPUMatrix),
+                            m_GPUMatrix->BatchNormalizationBackward(*in.m_GPUMatrix, *grad.m_GPUMatrix, *scale.m_GPUMatrix,
+                                                                    *saveMean.m_GPUMatrix, *saveInvStdDev.m_GPUMatrix,
+                                                                    *scaleGrad.m_GPUMatrix, *biasGrad.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
 #pragma endregion Other Helper Functions
 
 #pragma region Static BLAS Functions
@@ -4034,6 +4731,23 @@ void Matrix<ElemType>::SVD(const Matrix<ElemType>& A, Matrix<ElemType>& SIGMA, M
                             NOT_IMPLEMENTED);
 }
 
+/// <summary>Fused matrix product, bias add and nonlinearity: c = f(alpha * op(a) * op(b) + beta * c + bias)</summary>
+/// This is the dispatch surface for nodes that want to collapse a Times -> Plus -> Sigmoid/Tanh
+/// chain into one call on CPU; only the dense CPU path is fused, other combinations are not implemented.
+template <class ElemType>
+void Matrix<ElemType>::MultiplyAddBiasAndApply(ElemType alpha, const Matrix<ElemType>& a, const bool transposeA, const Matrix<ElemType>& b, const bool transposeB,
+                                               ElemType beta, Matrix<ElemType>& c, const Matrix<ElemType>& bias, ElementWiseOperator nonlinearity)
+{
+    DecideAndMoveToRightDevice(a, b, c);
+
+    if (c.GetDeviceId() >= 0 || a.GetMatrixType() != MatrixType::DENSE || b.GetMatrixType() != MatrixType::DENSE || bias.GetMatrixType() != MatrixType::DENSE)
+        NOT_IMPLEMENTED;
+
+    c.SwitchToMatrixType(MatrixType::DENSE, matrixFormatDense, false);
+    CPUMatrix<ElemType>::MultiplyAddBiasAndApply(alpha, *a.m_CPUMatrix, transposeA, *b.m_CPUMatrix, transposeB, beta, *c.m_CPUMatrix, *bias.m_CPUMatrix, nonlinearity);
+    c.SetDataLocation(CPU, DENSE);
+}
+
 /// <summary>Matrix-matrix multiply with col-major matrices (a and b may be transposed): c = alpha * op(a) * op(b) + beta*c</summary>
 /// <param name="alpha">Scalar</param>
 /// <param name="a">Input matrix</param>
@@ -4046,13 +4760,29 @@ template <class ElemType>
 void Matrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const Matrix<ElemType>& a, const bool transposeA, const Matrix<ElemType>& b, const bool transposeB,
                                               ElemType beta, Matrix<ElemType>& c)
 {
+    // roofline credit for the product itself; the generic dispatch model only sees one operand's shape
+    {
+        double m = (double) (transposeA ? a.GetNumCols() : a.GetNumRows());
+        double k = (double) (transposeA ? a.GetNumRows() : a.GetNumCols());
+        double n = (double) (transposeB ? b.GetNumRows() : b.GetNumCols());
+        AccumulateMatrixOpExtra(2 * m * n * k, (m * k + k * n + m * n) * sizeof(ElemType));
+    }
+
     DecideAndMoveToRightDevice(a, b, c);
 
     if (c.GetDeviceId() < 0) // CPU
     {
-        if (a.GetMatrixType() == MatrixType::SPARSE)
-            NOT_IMPLEMENTED;
-        if (b.GetMatrixType() == MatrixType::SPARSE)
+        if (a.GetMatrixType() == MatrixType::SPARSE) // Sparse*Dense -> Dense
+        {
+            if (b.GetMatrixType() == MatrixType::DENSE && c.GetMatrixType() == MatrixType::DENSE)
+            {
+                CPUSparseMatrix<ElemType>::MultiplyAndWeightedAdd(alpha, *a.m_CPUSparseMatrix, transposeA, *b.m_CPUMatrix, transposeB, beta, *c.m_CPUMatrix);
+                c.SetDataLocation(CPU, DENSE);
+            }
+            else
+                NOT_IMPLEMENTED;
+        }
+        else if (b.GetMatrixType() == MatrixType::SPARSE)
         {
             if (c.GetMatrixType() == MatrixType::DENSE)
             {
@@ -4149,6 +4879,77 @@ void Matrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const Matrix<ElemT
     }
 }
 
+/// <summary>Batched version of MultiplyAndWeightedAdd: c[i] = alpha * op(a[i]) * op(b[i]) + beta * c[i] for all i.
+/// All matrices in a batch must be dense, live on the same device, and have identical dimensions;
+/// anything else falls back to a loop over MultiplyAndWeightedAdd.</summary>
+template <class ElemType>
+void Matrix<ElemType>::MultiplyAndWeightedAddBatched(ElemType alpha, const std::vector<const Matrix<ElemType>*>& a, const bool transposeA,
+                                                     const std::vector<const Matrix<ElemType>*>& b, const bool transposeB,
+                                                     ElemType beta, const std::vector<Matrix<ElemType>*>& c)
+{
+    if (a.size() != b.size() || a.size() != c.size())
+        InvalidArgument("MultiplyAndWeightedAddBatched: a, b, and c must contain the same number of matrices.");
+    if (a.empty())
+        return;
+
+    // check whether the batch is eligible for the batched kernels: all dense, all on one device, uniform dimensions
+    bool canBatch = true;
+    for (size_t i = 0; i < a.size() && canBatch; i++)
+    {
+        canBatch = a[i]->GetMatrixType() == MatrixType::DENSE &&
+                   b[i]->GetMatrixType() == MatrixType::DENSE &&
+                   c[i]->GetMatrixType() == MatrixType::DENSE &&
+                   a[i]->GetDeviceId() == a[0]->GetDeviceId() &&
+                   b[i]->GetDeviceId() == a[0]->GetDeviceId() &&
+                   c[i]->GetDeviceId() == a[0]->GetDeviceId() &&
+                   a[i]->GetNumRows() == a[0]->GetNumRows() && a[i]->GetNumCols() == a[0]->GetNumCols() &&
+                   b[i]->GetNumRows() == b[0]->GetNumRows() && b[i]->GetNumCols() == b[0]->GetNumCols();
+    }
+    if (!canBatch)
+    {
+        for (size_t i = 0; i < a.size(); i++)
+            MultiplyAndWeightedAdd(alpha, *a[i], transposeA, *b[i], transposeB, beta, *c[i]);
+        return;
+    }
+
+    // roofline credit for the batched products (the loop above lets the single-matrix path credit itself)
+    {
+        double m = (double) (transposeA ? a[0]->GetNumCols() : a[0]->GetNumRows());
+        double k = (double) (transposeA ? a[0]->GetNumRows() : a[0]->GetNumCols());
+        double n = (double) (transposeB ? b[0]->GetNumRows() : b[0]->GetNumCols());
+        AccumulateMatrixOpExtra(a.size() * 2 * m * n * k, a.size() * (m * k + k * n + m * n) * sizeof(ElemType));
+    }
+
+    if (a[0]->GetDeviceId() < 0) // CPU
+    {
+        std::vector<const CPUMatrix<ElemType>*> aCPU(a.size()), bCPU(a.size());
+        std::vector<CPUMatrix<ElemType>*> cCPU(a.size());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            aCPU[i] = a[i]->m_CPUMatrix;
+            bCPU[i] = b[i]->m_CPUMatrix;
+            cCPU[i] = c[i]->m_CPUMatrix;
+        }
+        CPUMatrix<ElemType>::MultiplyAndWeightedAddBatched(alpha, aCPU, transposeA, bCPU, transposeB, beta, cCPU);
+        for (size_t i = 0; i < c.size(); i++)
+            c[i]->SetDataLocation(CPU, DENSE);
+    }
+    else // GPU
+    {
+        std::vector<const GPUMatrix<ElemType>*> aGPU(a.size()), bGPU(a.size());
+        std::vector<GPUMatrix<ElemType>*> cGPU(a.size());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            aGPU[i] = a[i]->m_GPUMatrix;
+            bGPU[i] = b[i]->m_GPUMatrix;
+            cGPU[i] = c[i]->m_GPUMatrix;
+        }
+        GPUMatrix<ElemType>::MultiplyAndWeightedAddBatched(alpha, aGPU, transposeA, bGPU, transposeB, beta, cGPU);
+        for (size_t i = 0; i < c.size(); i++)
+            c[i]->SetDataLocation(GPU, DENSE);
+    }
+}
+
 template <class ElemType>
 /*static*/ void Matrix<ElemType>::Multiply1x1AndWeightedAdd(ElemType alpha, const Matrix<ElemType>& a, const Matrix<ElemType>& b, ElemType beta, Matrix<ElemType>& c)
 {
@@ -4429,6 +5230,89 @@ void Matrix<ElemType>::AssignScaledDifference(const Matrix<ElemType>& alpha, con
                             NOT_IMPLEMENTED);
 }
 
+/// <summary> c += alpha * (softmax(predictions) - labels)</summary>
+/// the softmax is reconstructed from the per-column max and log partition function saved
+/// by AssignCrossEntropyWithSoftmaxOf, rather than read from a full-size temporary
+/// <param name="alpha">1X1 matrix</param>
+/// <param name="predictions">Input matrix</param>
+/// <param name="softmaxStats">2 x cols matrix of per-column (max, log partition function)</param>
+/// <param name="labels">Input matrix</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+template <class ElemType>
+void Matrix<ElemType>::AddScaledSoftmaxDifference(const Matrix<ElemType>& alpha, const Matrix<ElemType>& predictions, const Matrix<ElemType>& softmaxStats, const Matrix<ElemType>& labels, Matrix<ElemType>& c, const Matrix<char>* columnsValidityMask /*= nullptr*/)
+{
+    DecideAndMoveToRightDevice(c, predictions, labels);
+    alpha._transferToDevice(c.GetDeviceId());
+    softmaxStats._transferToDevice(c.GetDeviceId());
+
+    if (columnsValidityMask != nullptr && columnsValidityMask->GetDeviceId() != c.GetDeviceId())
+        RuntimeError("AddScaledSoftmaxDifference: c and column mask must be on the same device");
+
+    if (!(predictions.GetMatrixType() == labels.GetMatrixType() && predictions.GetMatrixType() == c.GetMatrixType() &&
+          predictions.GetMatrixType() == softmaxStats.GetMatrixType() && predictions.GetMatrixType() == alpha.GetMatrixType()))
+        NOT_IMPLEMENTED;
+
+    DISPATCH_MATRIX_ON_FLAG(&c,
+                            &c,
+                            CPUMatrix<ElemType>::AddScaledSoftmaxDifference(*alpha.m_CPUMatrix, *predictions.m_CPUMatrix, *softmaxStats.m_CPUMatrix, *labels.m_CPUMatrix, *c.m_CPUMatrix, columnsValidityMask ? columnsValidityMask->m_CPUMatrix : nullptr),
+                            GPUMatrix<ElemType>::AddScaledSoftmaxDifference(*alpha.m_GPUMatrix, *predictions.m_GPUMatrix, *softmaxStats.m_GPUMatrix, *labels.m_GPUMatrix, *c.m_GPUMatrix, columnsValidityMask ? columnsValidityMask->m_GPUMatrix : nullptr),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
+/// <summary> c += alpha * (softmax(predictions) - onehot(labelIndexes))</summary>
+/// index-label variant of AddScaledSoftmaxDifference: the one-hot subtraction is folded into the
+/// kernel, and gap columns (negative index) get no gradient
+/// <param name="alpha">1X1 matrix</param>
+/// <param name="predictions">Input matrix</param>
+/// <param name="softmaxStats">2 x cols matrix of per-column (max, log partition function)</param>
+/// <param name="labelIndexes">1 x cols matrix of label classes (negative = gap)</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+template <class ElemType>
+void Matrix<ElemType>::AddScaledIndexedSoftmaxDifference(const Matrix<ElemType>& alpha, const Matrix<ElemType>& predictions, const Matrix<ElemType>& softmaxStats, const Matrix<ElemType>& labelIndexes, Matrix<ElemType>& c)
+{
+    DecideAndMoveToRightDevice(c, predictions, labelIndexes);
+    alpha._transferToDevice(c.GetDeviceId());
+    softmaxStats._transferToDevice(c.GetDeviceId());
+
+    if (!(predictions.GetMatrixType() == labelIndexes.GetMatrixType() && predictions.GetMatrixType() == c.GetMatrixType() &&
+          predictions.GetMatrixType() == softmaxStats.GetMatrixType() && predictions.GetMatrixType() == alpha.GetMatrixType()))
+        NOT_IMPLEMENTED;
+
+    DISPATCH_MATRIX_ON_FLAG(&c,
+                            &c,
+                            CPUMatrix<ElemType>::AddScaledIndexedSoftmaxDifference(*alpha.m_CPUMatrix, *predictions.m_CPUMatrix, *softmaxStats.m_CPUMatrix, *labelIndexes.m_CPUMatrix, *c.m_CPUMatrix),
+                            GPUMatrix<ElemType>::AddScaledIndexedSoftmaxDifference(*alpha.m_GPUMatrix, *predictions.m_GPUMatrix, *softmaxStats.m_GPUMatrix, *labelIndexes.m_GPUMatrix, *c.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
+/// <summary> c += alpha * weight * logsoftmax(predictions)</summary>
+/// the log-softmax is reconstructed from the per-column max and log partition function saved
+/// by AssignCrossEntropyWithSoftmaxOf
+/// <param name="alpha">Scalar</param>
+/// <param name="weight">1X1 matrix</param>
+/// <param name="predictions">Input matrix</param>
+/// <param name="softmaxStats">2 x cols matrix of per-column (max, log partition function)</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+template <class ElemType>
+void Matrix<ElemType>::AddScaledLogSoftmax(const ElemType alpha, const Matrix<ElemType>& weight, const Matrix<ElemType>& predictions, const Matrix<ElemType>& softmaxStats, Matrix<ElemType>& c)
+{
+    DecideAndMoveToRightDevice(c, predictions, weight);
+    softmaxStats._transferToDevice(c.GetDeviceId());
+
+    if (!(predictions.GetMatrixType() == c.GetMatrixType() && predictions.GetMatrixType() == softmaxStats.GetMatrixType() &&
+          predictions.GetMatrixType() == weight.GetMatrixType()))
+        NOT_IMPLEMENTED;
+
+    DISPATCH_MATRIX_ON_FLAG(&c,
+                            &c,
+                            CPUMatrix<ElemType>::AddScaledLogSoftmax(alpha, *weight.m_CPUMatrix, *predictions.m_CPUMatrix, *softmaxStats.m_CPUMatrix, *c.m_CPUMatrix),
+                            GPUMatrix<ElemType>::AddScaledLogSoftmax(alpha, *weight.m_GPUMatrix, *predictions.m_GPUMatrix, *softmaxStats.m_GPUMatrix, *c.m_GPUMatrix),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
 //c[ci,cj] += a[ai,aj]
 template <class ElemType>
 void Matrix<ElemType>::AddElementToElement(const Matrix<ElemType>& a, const size_t ai, const size_t aj, Matrix<ElemType>& c, const size_t ci, const size_t cj)
@@ -4929,6 +5813,30 @@ Matrix<ElemType>& Matrix<ElemType>::AssignElementProductOfWithShift(const Matrix
     return *this;
 }
 
+template <class ElemType>
+void Matrix<ElemType>::RCRFForwardCompute(Matrix<ElemType>& alpha,
+                                          const Matrix<ElemType>& pos_scores, const Matrix<ElemType>& pair_scores,
+                                          const int startLbl)
+{
+    DecideAndMoveToRightDevice(pos_scores, alpha);
+    alpha._transferToDevice(pos_scores.GetDeviceId());
+
+    DISPATCH_MATRIX_ON_FLAG(&pos_scores,
+                            &alpha,
+                            CPUMatrix<ElemType>::RCRFForwardCompute(
+                                *alpha.m_CPUMatrix,
+                                *pos_scores.m_CPUMatrix,
+                                *pair_scores.m_CPUMatrix,
+                                startLbl),
+                            GPUMatrix<ElemType>::RCRFForwardCompute(
+                                *alpha.m_GPUMatrix,
+                                *pos_scores.m_GPUMatrix,
+                                *pair_scores.m_GPUMatrix,
+                                startLbl),
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED);
+}
+
 template <class ElemType>
 void Matrix<ElemType>::RCRFBackwardCompute(const Matrix<ElemType>& alpha, Matrix<ElemType>& beta,
                                            Matrix<ElemType>& functionValues, const Matrix<ElemType>& lbls,
@@ -5104,4 +6012,25 @@ template void Matrix<char>::SetValue(const char);
 template void Matrix<char>::SetValue(size_t numRows, const size_t numCols, int deviceId, char* pArray, size_t matrixFlags);
 template bool Matrix<char>::IsEmpty() const;
 template void Matrix<char>::Resize(const size_t numRows, const size_t numCols, const size_t numNZElemToReserve, bool growOnly);
+
+// We use Matrix<short> as the backing store for quantized inference weights (see
+// QuantizeForInference()/MultiplyQuantized()); same drill as Matrix<char>
+template Matrix<short>::Matrix(DEVICEID_TYPE);
+template Matrix<short>::Matrix(Matrix<short>&&);
+template Matrix<short>::Matrix(const size_t numRows, const size_t numCols, DEVICEID_TYPE deviceId, const MatrixType matrixType, const MatrixFormat matrixFormat);
+template Matrix<short>::Matrix(const size_t numRows, const size_t numCols, short* pArray, const size_t matrixFlags, DEVICEID_TYPE deviceId, const size_t nnz);
+template Matrix<short>::~Matrix();
+template Matrix<short>& Matrix<short>::operator=(Matrix<short>&& moveFrom);
+template Matrix<short>& Matrix<short>::operator=(const Matrix<short>& deepCopyFrom);
+template short* Matrix<short>::BufferPointer() const;
+template int Matrix<short>::GetDeviceId() const;
+template size_t Matrix<short>::GetNumElements() const;
+template Matrix<short> Matrix<short>::ColumnSlice(size_t startColumn, size_t numCols) const;
+template void Matrix<short>::_transferToDevice(int id_to, bool ismoved, bool emptyTransfer) const;
+template size_t Matrix<short>::GetNumRows() const;
+template size_t Matrix<short>::GetNumCols() const;
+template void Matrix<short>::SetValue(const short);
+template void Matrix<short>::SetValue(size_t numRows, const size_t numCols, int deviceId, short* pArray, size_t matrixFlags);
+template bool Matrix<short>::IsEmpty() const;
+template void Matrix<short>::Resize(const size_t numRows, const size_t numCols, const size_t numNZElemToReserve, bool growOnly);
 } } }
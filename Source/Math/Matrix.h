@@ -176,6 +176,10 @@ public:
     // REVIEW alexeyk: GPU version copies from device to host only, implement all versions (device <-> host).
     void CopySection(size_t numRows, size_t numCols, ElemType* dst, size_t colStride) const;
 
+    // half-precision (IEEE binary16) storage: store half, compute ElemType; dense matrices only
+    void CopyToFloat16Array(unsigned short* halfArray) const; // caller allocates GetNumElements() entries
+    void SetValueFromFloat16Array(const size_t numRows, const size_t numCols, const unsigned short* halfArray);
+
     Matrix<ElemType> ColumnSlice(size_t startColumn, size_t numCols) const;
 
     // difference between AssignColumnSlice and SetColumnSlice
@@ -194,8 +198,10 @@ public:
     void ShiftBy(int numShift);
 
     // TODO: all these scalars should be passed as doubles and cast down inside
-    void NormalGrad(Matrix<ElemType>& gradients, Matrix<ElemType>& functionValues, const ElemType learnRatePerSample, const ElemType momentum, const bool useNAG);
+    void NormalGrad(Matrix<ElemType>& gradients, Matrix<ElemType>& functionValues, const ElemType learnRatePerSample, const ElemType momentum, const bool useNAG,
+                    const ElemType gradientScale = 1); // gradientScale is folded into the update, so norm clipping needs no in-place rescaling pass (dense gradients only)
     ElemType Adagrad(Matrix<ElemType>& gradients, const bool needAveMultiplier);
+    void AdagradUpdate(Matrix<ElemType>& gradients, Matrix<ElemType>& functionValues, const ElemType learnRatePerSample); // fused Adagrad + weight step (dense only)
     void FSAdagrad(size_t mbSize, Matrix<ElemType>& gradients, Matrix<ElemType>& functionValues, const ElemType learnRatePerSample, const ElemType momentum);
     ElemType RmsProp(Matrix<ElemType>& gradients, ElemType RMS_GAMMA, ElemType RMS_WGT_INC, ElemType RMS_WGT_MAX, ElemType RMS_WGT_DEC, ElemType RMS_WGT_MIN, const bool needAveMultiplier);
 
@@ -267,6 +273,11 @@ public:
     void SetUniformRandomValue(const ElemType low, const ElemType high, unsigned long seed = USE_TIME_BASED_SEED);
     void SetGaussianRandomValue(const ElemType mean, const ElemType sigma, unsigned long seed = USE_TIME_BASED_SEED);
     void SetUniformRandomMask(const ElemType maskRate, const ElemType scaleValue, unsigned long seed = USE_TIME_BASED_SEED);
+
+    // fused dropout: the mask is regenerated from (randomSeed, offset + element index) on the fly
+    // and never materialized; 'offset' is the slice's first element within the full minibatch matrix
+    Matrix<ElemType>& AssignDropoutOf(const Matrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset);
+    Matrix<ElemType>& AddDropoutGradientOf(const Matrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset);
     void AddGaussianRandomValue(const ElemType mean, const ElemType sigma, unsigned long seed = USE_TIME_BASED_SEED);
     Matrix<ElemType>& AssignNoiseContrastiveEstimation(const Matrix<ElemType>& a, const Matrix<ElemType>& b, const Matrix<ElemType>& c, const Matrix<ElemType>& bias, Matrix<ElemType>& tmp);
 
@@ -339,6 +350,8 @@ public:
 
     Matrix<ElemType>& InplaceLogSoftmax(const bool isColWise);
     Matrix<ElemType>& AssignLogSoftmaxOf(const Matrix<ElemType>& a, const bool isColWise);
+    Matrix<ElemType>& AssignCrossEntropyWithSoftmaxOf(const Matrix<ElemType>& labels, const Matrix<ElemType>& predictions, Matrix<ElemType>& softmaxStats, const Matrix<char>* columnsValidityMask = nullptr); // softmaxStats is resized to 2 x cols; columns flagged 0 in the mask (gaps) are skipped
+    Matrix<ElemType>& AssignIndexedCrossEntropyWithSoftmaxOf(const Matrix<ElemType>& labelIndexes, const Matrix<ElemType>& predictions, Matrix<ElemType>& softmaxStats); // labelIndexes is 1 x cols (negative = gap); softmaxStats is resized to 2 x cols
 
     Matrix<ElemType>& InplaceHardmax(const bool isColWise);
     Matrix<ElemType>& AssignHardmaxOf(const Matrix<ElemType>& a, const bool isColWise);
@@ -380,6 +393,7 @@ public:
     DeviceBoundNumber<ElemType> Sum_AsDeviceBoundNum() const;
     ElemType SumOfAbsElements() const; // sum of all abs(elements)
     ElemType SumOfElements() const;    // sum of all elements
+    void AccumulateAbsLogHistogram(int minExponent, Matrix<ElemType>& histogram) const; // log2-bucketed histogram of element magnitudes, accumulated on the matrix's own device
     Matrix<ElemType>& AssignSumOfElements(const Matrix<ElemType>& a);
 
     ElemType LogAddSumOfElements() const;
@@ -390,8 +404,23 @@ public:
     Matrix<ElemType>& AddWithRowSliceValuesOf(const Matrix<ElemType>& a, const size_t startIndex, const size_t numRows);
     // Matrix<ElemType>&  AssignRowStackValuesOf(const std::vector<const Matrix<ElemType>*>& inputMatrices, const size_t sliceStartCol, const size_t sliceNumCols);
 
+    // gather/scatter of rows by an index matrix (dense only); idx has 1 column or as many as a
+    Matrix<ElemType>& AssignRowGatherOf(const Matrix<ElemType>& idx, const Matrix<ElemType>& a);
+    Matrix<ElemType>& AddWithRowGatherOf(const Matrix<ElemType>& idx, const Matrix<ElemType>& a);
+    Matrix<ElemType>& AddRowScatterOf(const Matrix<ElemType>& idx, const Matrix<ElemType>& a);
+
     Matrix<ElemType>& AssignRepeatOf(const Matrix<ElemType>& a, const size_t numRowRepeats, const size_t numColRepeats);
     Matrix<ElemType>& AddToRowRepeatValuesOf(const Matrix<ElemType>& a, const size_t numRepeats);
+    Matrix<ElemType>& AssignGatheredColumnsOf(const Matrix<ElemType>& a, const std::vector<size_t>& columnIndices);
+    Matrix<ElemType>& ScatterGatheredColumnsOf(const Matrix<ElemType>& packed, const std::vector<size_t>& columnIndices);
+
+    // quantized inference (CPU dense only, see IsQuantizedInference() in CommonMatrix.h)
+    void QuantizeForInference(Matrix<short>& qweightsT, Matrix<ElemType>& rowScales) const;
+    static void MultiplyQuantized(const Matrix<short>& qweightsT, const Matrix<ElemType>& rowScales, const Matrix<ElemType>& input, Matrix<ElemType>& output);
+
+    // persistently packed weight products (CPU dense only, see UsePrepackedWeights() in CommonMatrix.h)
+    std::shared_ptr<ElemType> PackForMultiply(bool transpose) const; // null when the BLAS has no packed-GEMM interface
+    static void MultiplyPacked(const std::shared_ptr<ElemType>& packedA, size_t aRows, size_t aCols, bool transposeA, const Matrix<ElemType>& input, Matrix<ElemType>& output);
 
     Matrix<ElemType>& AssignPositiveAndShiftedNegSample(const Matrix<ElemType>& a, const size_t posNumber, const size_t negNumber, const size_t shiftNumber);
     Matrix<ElemType>& AddFoldedPositiveAndShiftedNegSample(const Matrix<ElemType>& a, const size_t posNumber, const size_t negNumber, const size_t shiftNumber);
@@ -429,6 +458,7 @@ public:
     void VectorMin(Matrix<ElemType>& minIndexes, Matrix<ElemType>& minValues, const bool isColWise) const;
 
     Matrix<ElemType>& AssignNumOfDiff(const Matrix<ElemType>& a, const Matrix<ElemType>& b, bool searchInCol = false);
+    Matrix<ElemType>& AssignTopKError(const Matrix<ElemType>& labels, const Matrix<ElemType>& predictions, const int topK);
 
     Matrix<ElemType>& AssignInnerProductOfMatrices(const Matrix<ElemType>& a, const Matrix<ElemType>& b); // this method will resize(1,1) first
 
@@ -452,6 +482,21 @@ public:
                                              const size_t inputWidth, const size_t inputHeight, const size_t inputSizePerSample,
                                              const size_t outputWidth, const size_t outputHeight, const size_t outputSizePerSample,
                                              const size_t windowWidth, const size_t windowHeight, const size_t horizontalSubsample, const size_t verticalSubsample);
+    // fused batch normalization over the columns of 'this' (one sample per column); the statistics
+    // dimension is taken from 'scale' (== rows for per-activation, channels for spatial mode)
+    void BatchNormalizationForward(const Matrix<ElemType>& scale, const Matrix<ElemType>& bias,
+                                   double expAvgFactor, double epsilon,
+                                   Matrix<ElemType>& runMean, Matrix<ElemType>& runInvStdDev,
+                                   Matrix<ElemType>& out,
+                                   Matrix<ElemType>& saveMean, Matrix<ElemType>& saveInvStdDev) const;
+    void BatchNormalizationForwardInference(const Matrix<ElemType>& scale, const Matrix<ElemType>& bias,
+                                            const Matrix<ElemType>& runMean, const Matrix<ElemType>& runInvStdDev,
+                                            Matrix<ElemType>& out) const;
+    void BatchNormalizationBackward(const Matrix<ElemType>& in, Matrix<ElemType>& grad,
+                                    const Matrix<ElemType>& scale,
+                                    const Matrix<ElemType>& saveMean, const Matrix<ElemType>& saveInvStdDev,
+                                    Matrix<ElemType>& scaleGrad, Matrix<ElemType>& biasGrad) const;
+
     Matrix<ElemType>& AddMaxPoolingGradient(const Matrix<ElemType>& outputGradientBatch, const Matrix<ElemType>& inputBatch, const Matrix<ElemType>& outputBatch,
                                             const size_t channels,
                                             const size_t inputWidth, const size_t inputHeight, const size_t inputSizePerSample,
@@ -482,6 +527,8 @@ public:
     static void SVD(const Matrix<ElemType>& A, Matrix<ElemType>& SIGMA, Matrix<ElemType>& U, Matrix<ElemType>& VT, Matrix<ElemType>& W);
 
     static void MultiplyAndWeightedAdd(ElemType alpha, const Matrix<ElemType>& a, const bool transposeA, const Matrix<ElemType>& b, const bool transposeB, ElemType beta, Matrix<ElemType>& c); // SGEMM
+    static void MultiplyAndWeightedAddBatched(ElemType alpha, const std::vector<const Matrix<ElemType>*>& a, const bool transposeA, const std::vector<const Matrix<ElemType>*>& b, const bool transposeB, ElemType beta, const std::vector<Matrix<ElemType>*>& c); // many small independent GEMMs in one call
+    static void MultiplyAddBiasAndApply(ElemType alpha, const Matrix<ElemType>& a, const bool transposeA, const Matrix<ElemType>& b, const bool transposeB, ElemType beta, Matrix<ElemType>& c, const Matrix<ElemType>& bias, ElementWiseOperator nonlinearity); // fused GEMM + bias + nonlinearity (CPU dense only)
     static void MultiplyAndAdd(const Matrix<ElemType>& a, const bool transposeA, const Matrix<ElemType>& b, const bool transposeB, Matrix<ElemType>& c);
     static void Multiply(const Matrix<ElemType>& a, const bool transposeA, const Matrix<ElemType>& b, const bool transposeB, Matrix<ElemType>& c);
     static void Multiply(const Matrix<ElemType>& a, const Matrix<ElemType>& b, Matrix<ElemType>& c);
@@ -494,6 +541,9 @@ public:
     static void AssignScaledDifference(const ElemType alpha, const Matrix<ElemType>& a, const Matrix<ElemType>& b, Matrix<ElemType>& c);
     static void AddScaledDifference(const Matrix<ElemType>& alpha, const Matrix<ElemType>& a, const Matrix<ElemType>& b, Matrix<ElemType>& c); // c += alpha * (a - b)
     static void AssignScaledDifference(const Matrix<ElemType>& alpha, const Matrix<ElemType>& a, const Matrix<ElemType>& b, Matrix<ElemType>& c);
+    static void AddScaledSoftmaxDifference(const Matrix<ElemType>& alpha, const Matrix<ElemType>& predictions, const Matrix<ElemType>& softmaxStats, const Matrix<ElemType>& labels, Matrix<ElemType>& c, const Matrix<char>* columnsValidityMask = nullptr); // c += alpha * (softmax(predictions) - labels), alpha must be 1X1; masked-out columns (gaps) are skipped
+    static void AddScaledIndexedSoftmaxDifference(const Matrix<ElemType>& alpha, const Matrix<ElemType>& predictions, const Matrix<ElemType>& softmaxStats, const Matrix<ElemType>& labelIndexes, Matrix<ElemType>& c); // c += alpha * (softmax(predictions) - onehot(labelIndexes)), alpha must be 1X1
+    static void AddScaledLogSoftmax(const ElemType alpha, const Matrix<ElemType>& weight, const Matrix<ElemType>& predictions, const Matrix<ElemType>& softmaxStats, Matrix<ElemType>& c);              // c += alpha * weight * logsoftmax(predictions), weight must be 1X1
 
     static void AddElementToElement(const Matrix<ElemType>& a, const size_t ai, const size_t aj, Matrix<ElemType>& c, const size_t ci, const size_t cj);
     // static void AddLogElementToElement(const Matrix<ElemType>& a, const size_t ai, const size_t aj, Matrix<ElemType>& c, const size_t ci, const size_t cj);
@@ -539,6 +589,10 @@ public:
     Matrix<ElemType>& AssignElementProductOfWithShift(const Matrix<ElemType>& a, const Matrix<ElemType>& b, size_t shift);
 
 public:
+    static void RCRFForwardCompute(Matrix<ElemType>& alpha,
+                                   const Matrix<ElemType>& pos_scores, const Matrix<ElemType>& pair_scores,
+                                   const int startLbl); // the time 0 start symbol in the output layer
+
     static void RCRFBackwardCompute(const Matrix<ElemType>& alpha, Matrix<ElemType>& beta,
                                     Matrix<ElemType>& functionValues, const Matrix<ElemType>& lbls,
                                     const Matrix<ElemType>& pos_scores, const Matrix<ElemType>& pair_scores, const int shift);
@@ -577,4 +631,14 @@ File& operator<<(File& stream, const Matrix<ElemType>& M)
 
 typedef Matrix<float> SingleMatrix;
 typedef Matrix<double> DoubleMatrix;
+
+// process-wide statistics of cross-device matrix transfers, for finding accidental ping-pong in node implementations
+MATH_API void ResetMatrixTransferStatistics();
+MATH_API void ReportMatrixTransferStatistics(const char* caption);
+
+// model-based FLOP/byte accounting of Matrix operations for roofline analysis
+// The counters belong to the calling thread; the per-node timing instrumentation snapshots them
+// around each node execution (see ComputationNetwork::ReportNodeTiming() for the summary).
+MATH_API void EnableMatrixOpAccounting(bool enable);
+MATH_API void ReadMatrixOpCounters(double& flops, double& bytes);
 } } }
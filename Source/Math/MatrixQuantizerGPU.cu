@@ -339,6 +339,34 @@ void MatrixQuantizerGPU<ElemType>::WaitUnquantizeAsyncDone()
     SyncEvent(m_quantizeCompleteEvent);
 }
 
+// Pre-allocate the intermediate GPU QuantizedMatrix for the given shape and complete its async
+// zeroing right away, so the first quantization in training does not pay the allocation cost
+template <class ElemType>
+void MatrixQuantizerGPU<ElemType>::Prewarm(size_t numRows, size_t numCols, size_t nBits)
+{
+    PrepareDevice(this->GetDeviceId());
+
+    bool newlyAllocated = false;
+    GetTempGPUQuantizedMatrix(numRows, numCols, nBits, newlyAllocated);
+    if (newlyAllocated)
+    {
+        SyncStream(GetStream()); // the zeroing runs on the main stream; finish it here, off the training critical path
+    }
+}
+
+template <class ElemType>
+void MatrixQuantizerGPU<ElemType>::Reset()
+{
+    PrepareDevice(this->GetDeviceId());
+    this->Drain();
+
+    if (m_tempGPUQuantizedMatrix != nullptr)
+    {
+        delete m_tempGPUQuantizedMatrix;
+        m_tempGPUQuantizedMatrix = nullptr;
+    }
+}
+
 //explicit
 template class MatrixQuantizerGPU<float>;
 template class MatrixQuantizerGPU<double>;
@@ -364,6 +392,11 @@ void GPUMatrixComputeStreamEvent::SynchronizeEvent()
     cudaEventSynchronize(m_mainGPUComputeStreamCUDAEvent) || "cudaEventSynchronize failed";
 }
 
+void GPUMatrixComputeStreamEvent::SynchronizeComputeStreamWithEvent()
+{
+    cudaStreamWaitEvent(GetStream(), m_mainGPUComputeStreamCUDAEvent, 0 /*flags 'must be 0'*/) || "cudaStreamWaitEvent failed";
+}
+
 template <typename ElemType>
 void GPUMatrixComputeStreamEvent::SynchronizeQuantizationComputeStreamWithEvent()
 {
@@ -381,4 +414,26 @@ template void GPUMatrixComputeStreamEvent::SynchronizeQuantizationComputeStreamW
 template void GPUMatrixComputeStreamEvent::SynchronizeQuantizationComputeStreamWithEvent<double>();
 template void GPUMatrixComputeStreamEvent::SynchronizeDataTransferFetchStreamWithEvent<float>();
 template void GPUMatrixComputeStreamEvent::SynchronizeDataTransferFetchStreamWithEvent<double>();
+
+GPUMatrixComputeSideStreamSection::GPUMatrixComputeSideStreamSection(int deviceId)
+    : MatrixComputeSideStreamSection(deviceId)
+{
+    PrepareDevice(deviceId);
+    m_mainStream = GetStream();
+    m_sideStream = AcquireStream(deviceId);
+
+    // fence the side stream behind everything issued on the main stream so far
+    cudaEventCreateWithFlags(&m_mainStreamDoneEvent, cudaEventDisableTiming) || "cudaEventCreateWithFlags failed";
+    cudaEventRecord(m_mainStreamDoneEvent, m_mainStream) || "cudaEventRecord failed";
+    cudaStreamWaitEvent(m_sideStream, m_mainStreamDoneEvent, 0 /*flags 'must be 0'*/) || "cudaStreamWaitEvent failed";
+
+    SetStream(m_sideStream);
+}
+
+GPUMatrixComputeSideStreamSection::~GPUMatrixComputeSideStreamSection()
+{
+    SetStream(m_mainStream);
+    ReleaseStream(m_deviceId, m_sideStream);
+    cudaEventDestroy(m_mainStreamDoneEvent) || "cudaEventDestroy failed";
+}
 } } }
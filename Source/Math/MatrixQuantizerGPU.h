@@ -29,6 +29,9 @@ public:
     void UnquantizeAsync(QuantizedMatrix<ElemType>& inQMatrix, Matrix<ElemType>& outMatrix, bool add = false) override;
     void WaitUnquantizeAsyncDone() override;
 
+    void Prewarm(size_t numRows, size_t numCols, size_t nBits) override;
+    void Reset() override;
+
 private:
     // Helper function to get a temporary intermediate matrix on the GPU to store quantization results
     QuantizedMatrix<ElemType>& GetTempGPUQuantizedMatrix(size_t numRows, size_t numCols, size_t nBits, bool& newlyAllocated);
@@ -91,6 +94,8 @@ public:
 
     void SynchronizeEvent() override;
 
+    void SynchronizeComputeStreamWithEvent() override;
+
     template <typename ElemType>
     void SynchronizeQuantizationComputeStreamWithEvent();
 
@@ -102,4 +107,20 @@ private:
     cudaEvent_t m_mainGPUComputeStreamCUDAEvent;
 #endif
 };
+
+// Redirects the current thread's GPU matrix operations onto a pooled side stream for the
+// lifetime of the instance; see MatrixComputeSideStreamSection
+class MATH_API GPUMatrixComputeSideStreamSection : public MatrixComputeSideStreamSection
+{
+public:
+    GPUMatrixComputeSideStreamSection(int deviceId);
+    ~GPUMatrixComputeSideStreamSection();
+
+private:
+#ifndef CPUONLY
+    cudaStream_t m_mainStream;
+    cudaStream_t m_sideStream;
+    cudaEvent_t m_mainStreamDoneEvent;
+#endif
+};
 } } }
@@ -3,6 +3,8 @@
 #include "MatrixQuantizerImpl.h"
 #include "MatrixQuantizerCPU.h"
 #include "MatrixQuantizerGPU.h"
+#include <mutex>
+#include <vector>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -13,7 +15,9 @@ template <class ElemType>
     {
 #ifndef CPUONLY
         bool useDedicatedComputeStream = useAsync;
-        return new MatrixQuantizerGPU<ElemType>(deviceId, useDedicatedComputeStream);
+        MatrixQuantizerImpl<ElemType>* quantizer = new MatrixQuantizerGPU<ElemType>(deviceId, useDedicatedComputeStream);
+        quantizer->m_useAsync = useAsync;
+        return quantizer;
 #else
         useAsync;
         RuntimeError("CreateMatrixQuantizer: attempted to use GPU while compiled without GPU support");
@@ -21,10 +25,65 @@ template <class ElemType>
     }
     else
     {
-        return new MatrixQuantizerCPU<ElemType>();
+        MatrixQuantizerImpl<ElemType>* quantizer = new MatrixQuantizerCPU<ElemType>();
+        quantizer->m_useAsync = useAsync;
+        return quantizer;
     }
 }
 
+// Process-lifetime pool of recycled quantizer instances. Re-creating an aggregator (e.g. when a
+// later epoch or command re-initializes distributed training) draws from here, so the CUDA device
+// context, the quantizer streams/events, and the intermediate device buffers stay warm instead of
+// being torn down and re-established, which shows up as a warmup spike at the start of each epoch.
+static std::mutex s_quantizerPoolMutex;
+
+template <class ElemType>
+struct QuantizerPool
+{
+    struct Entry
+    {
+        int deviceId;
+        bool useAsync;
+        MatrixQuantizerImpl<ElemType>* quantizer;
+    };
+    static std::vector<Entry> s_entries;
+};
+template <class ElemType>
+std::vector<typename QuantizerPool<ElemType>::Entry> QuantizerPool<ElemType>::s_entries;
+
+template <class ElemType>
+/*static*/ MatrixQuantizerImpl<ElemType>* MatrixQuantizerImpl<ElemType>::CreatePersistent(int deviceId, bool useAsync)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_quantizerPoolMutex);
+        auto& pool = QuantizerPool<ElemType>::s_entries;
+        for (size_t i = 0; i < pool.size(); i++)
+        {
+            if ((pool[i].deviceId == deviceId) && (pool[i].useAsync == useAsync))
+            {
+                MatrixQuantizerImpl<ElemType>* quantizer = pool[i].quantizer;
+                pool.erase(pool.begin() + i);
+                return quantizer;
+            }
+        }
+    }
+
+    return Create(deviceId, useAsync);
+}
+
+template <class ElemType>
+/*static*/ void MatrixQuantizerImpl<ElemType>::Recycle(MatrixQuantizerImpl<ElemType>* quantizer)
+{
+    if (quantizer == nullptr)
+        return;
+
+    quantizer->Drain(); // the next owner must not inherit in-flight operations
+
+    std::lock_guard<std::mutex> lock(s_quantizerPoolMutex);
+    typename QuantizerPool<ElemType>::Entry entry = {quantizer->m_deviceId, quantizer->m_useAsync, quantizer};
+    QuantizerPool<ElemType>::s_entries.push_back(entry);
+}
+
 template class MatrixQuantizerImpl<float>;
 template class MatrixQuantizerImpl<double>;
 
@@ -44,6 +103,10 @@ void MatrixComputeStreamEvent::SynchronizeEvent()
 {
 }
 
+void MatrixComputeStreamEvent::SynchronizeComputeStreamWithEvent()
+{
+}
+
 template <typename ElemType>
 void MatrixComputeStreamEvent::SynchronizeQuantizationComputeStreamWithEvent()
 {
@@ -69,6 +132,23 @@ MatrixComputeStreamEvent::MatrixComputeStreamEvent(int deviceId)
 {
 }
 
+MatrixComputeSideStreamSection* MatrixComputeSideStreamSection::Create(int deviceId)
+{
+    if (deviceId >= 0)
+        return new GPUMatrixComputeSideStreamSection(deviceId);
+    else
+        return new MatrixComputeSideStreamSection(deviceId);
+}
+
+MatrixComputeSideStreamSection::~MatrixComputeSideStreamSection()
+{
+}
+
+MatrixComputeSideStreamSection::MatrixComputeSideStreamSection(int deviceId)
+    : m_deviceId(deviceId)
+{
+}
+
 // Explicit template instantiations
 template MATH_API void MatrixComputeStreamEvent::SynchronizeQuantizationComputeStreamWithEvent<float>();
 template MATH_API void MatrixComputeStreamEvent::SynchronizeQuantizationComputeStreamWithEvent<double>();
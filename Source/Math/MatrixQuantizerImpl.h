@@ -20,6 +20,13 @@ class MATH_API MatrixQuantizerImpl
 {
 public:
     static MatrixQuantizerImpl<ElemType>* Create(int deviceId, bool useAsync);
+
+    // Like Create, but draws from a process-lifetime pool of previously recycled instances, so a
+    // reused quantizer comes back with its device context, streams, events and intermediate device
+    // buffers already warm. Pass instances back with Recycle() instead of deleting them.
+    static MatrixQuantizerImpl<ElemType>* CreatePersistent(int deviceId, bool useAsync);
+    static void Recycle(MatrixQuantizerImpl<ElemType>* quantizer);
+
     virtual ~MatrixQuantizerImpl()
     {
     }
@@ -33,9 +40,30 @@ public:
     virtual void UnquantizeAsync(QuantizedMatrix<ElemType>& inQMatrix, Matrix<ElemType>& outMatrix, bool add = false) = 0;
     virtual void WaitUnquantizeAsyncDone() = 0;
 
+    // Complete all outstanding async quantize/unquantize operations
+    void Drain()
+    {
+        WaitQuantizeAsyncDone();
+        WaitUnquantizeAsyncDone();
+    }
+
+    // Pre-allocate any intermediate device buffers needed to quantize (numRows x numCols) matrices
+    // at nBits, so the first quantization does not pay the allocation cost mid-training.
+    // Default: nothing to pre-allocate.
+    virtual void Prewarm(size_t /*numRows*/, size_t /*numCols*/, size_t /*nBits*/)
+    {
+    }
+
+    // Drain outstanding operations and release intermediate buffers; call when the matrix
+    // dimensions this quantizer operates on change, so stale oversized buffers are not retained
+    virtual void Reset()
+    {
+        Drain();
+    }
+
 protected:
     MatrixQuantizerImpl(int deviceId)
-        : m_deviceId(deviceId)
+        : m_deviceId(deviceId), m_useAsync(false)
     {
     }
 
@@ -46,6 +74,7 @@ protected:
 
 private:
     int m_deviceId;
+    bool m_useAsync; // how Create() configured this instance; lets Recycle() re-pool it correctly
 };
 
 // This type records and synchronizes events on the main
@@ -58,6 +87,10 @@ public:
 
     virtual void SynchronizeEvent();
 
+    // Make the current thread's compute stream wait for this event (asynchronously; the host does
+    // not block). Used to fence main-stream work on events recorded inside a side-stream section.
+    virtual void SynchronizeComputeStreamWithEvent();
+
     template <typename ElemType>
     void SynchronizeQuantizationComputeStreamWithEvent();
 
@@ -67,6 +100,25 @@ public:
 protected:
     MatrixComputeStreamEvent(int deviceId);
 
+protected:
+    int m_deviceId;
+};
+
+// While an instance of this type is alive, matrix operations issued by the creating thread run on
+// a pooled side stream instead of the main compute stream. On entry the side stream is fenced
+// behind all work already issued on the main stream, so operations inside the section see the
+// results of everything issued before it; the caller is responsible for fencing later main-stream
+// work on the section's results, by creating MatrixComputeStreamEvents inside the section (they
+// record on the side stream) and synchronizing on them afterwards. On CPU devices this is a no-op.
+class MATH_API MatrixComputeSideStreamSection
+{
+public:
+    static MatrixComputeSideStreamSection* Create(int deviceId);
+    virtual ~MatrixComputeSideStreamSection();
+
+protected:
+    MatrixComputeSideStreamSection(int deviceId);
+
 protected:
     int m_deviceId;
 };
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
 namespace Microsoft { namespace MSR { namespace CNTK {
 
 #ifdef _WIN32
@@ -17,5 +21,126 @@ class MATH_API MemAllocator
 public:
     virtual void* Malloc(size_t size) = 0;
     virtual void Free(void* p) = 0;
+    virtual ~MemAllocator()
+    {
+    }
+};
+
+// ArenaMemAllocator -- bump-pointer arena for short-lived scratch allocations.
+// Carves allocations out of one large block (obtained from an optional underlying allocator, e.g.
+// CUDAPageLockedMemAllocator, or from the heap) by advancing an offset. Free() on an individual
+// allocation is a no-op; instead, Reset() reclaims the entire arena in O(1). Allocations that do
+// not fit fall back to the underlying allocator, and their combined size is folded into the arena's
+// capacity on the following Reset(), so a steady-state workload (such as the per-minibatch
+// temporaries of the training loop) stops hitting the underlying allocator after the first rounds.
+class MATH_API ArenaMemAllocator : public MemAllocator
+{
+    static const size_t c_alignment = 64; // align carved-out allocations to cache lines
+
+public:
+    ArenaMemAllocator(size_t capacity, MemAllocator* underlyingAllocator = nullptr)
+        : m_underlyingAllocator(underlyingAllocator), m_buffer(nullptr), m_capacity(0), m_offset(0), m_overflowSize(0)
+    {
+        Grow(capacity);
+    }
+
+    ~ArenaMemAllocator()
+    {
+        for (auto p : m_overflowAllocations)
+            FreeBlock(p);
+        FreeBlock(m_buffer);
+    }
+
+    void* Malloc(size_t size) override
+    {
+        size_t alignedSize = (size + c_alignment - 1) & ~(c_alignment - 1);
+        if (m_offset + alignedSize <= m_capacity)
+        {
+            void* p = m_buffer + m_offset;
+            m_offset += alignedSize;
+            return p;
+        }
+
+        // Does not fit into the arena; fall back to the underlying allocator and remember the
+        // size so the arena can be regrown accordingly on the next Reset()
+        m_overflowSize += alignedSize;
+        void* p = MallocBlock(size);
+        m_overflowAllocations.push_back(p);
+        return p;
+    }
+
+    void Free(void* p) override
+    {
+        // allocations inside the arena are reclaimed wholesale by Reset()
+        if ((p >= m_buffer) && (p < m_buffer + m_capacity))
+            return;
+
+        auto iter = std::find(m_overflowAllocations.begin(), m_overflowAllocations.end(), p);
+        if (iter != m_overflowAllocations.end())
+        {
+            FreeBlock(p);
+            m_overflowAllocations.erase(iter);
+        }
+    }
+
+    // Reclaim all outstanding arena allocations at once. If any allocations overflowed into the
+    // underlying allocator since the last Reset(), the arena is grown to cover them next time.
+    void Reset()
+    {
+        for (auto p : m_overflowAllocations)
+            FreeBlock(p);
+        m_overflowAllocations.clear();
+
+        if (m_overflowSize > 0)
+        {
+            Grow(m_capacity + m_overflowSize);
+            m_overflowSize = 0;
+        }
+
+        m_offset = 0;
+    }
+
+    size_t Capacity() const
+    {
+        return m_capacity;
+    }
+
+private:
+    void* MallocBlock(size_t size)
+    {
+        if (m_underlyingAllocator != nullptr)
+            return m_underlyingAllocator->Malloc(size);
+
+        return malloc(size);
+    }
+
+    void FreeBlock(void* p)
+    {
+        if (p == nullptr)
+            return;
+
+        if (m_underlyingAllocator != nullptr)
+            m_underlyingAllocator->Free(p);
+        else
+            free(p);
+    }
+
+    void Grow(size_t newCapacity)
+    {
+        // the arena's contents need not survive; allocations are invalidated by Reset() anyway
+        FreeBlock(m_buffer);
+        m_buffer = (char*) MallocBlock(newCapacity);
+        m_capacity = newCapacity;
+    }
+
+private:
+    MemAllocator* m_underlyingAllocator; // where the arena block itself comes from; the heap if null
+    char* m_buffer;
+    size_t m_capacity;
+    size_t m_offset;
+
+    // allocations that did not fit into the arena, served by the underlying allocator instead
+    std::vector<void*> m_overflowAllocations;
+    size_t m_overflowSize;
 };
 } } }
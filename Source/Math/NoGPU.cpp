@@ -15,6 +15,7 @@
 #include "CuDnnConvolutionEngine.h"
 #include "TensorShape.h"
 #include "GPUDataTransferer.h"
+#include "CudaEventTimer.h"
 
 #pragma warning(disable : 4100) // unreferenced formal parameter, which is OK since all functions in here are dummies; disabling this allows to copy-paste prototypes here when we add new functions
 #pragma warning(disable : 4702) // unreachable code, which we get from the NOT_IMPLEMENTED macro which is OK
@@ -25,6 +26,10 @@ namespace Microsoft { namespace MSR { namespace CNTK {
 
 void PrepareDevice(DEVICEID_TYPE deviceId);
 
+void TracingGPUMemoryAllocator::PrintPoolStatistics()
+{
+}
+
 template <class ElemType>
 GPUSPARSE_INDEX_TYPE GPUSparseMatrix<ElemType>::SecondaryIndexValueAt(size_t idx) const
 {
@@ -151,6 +156,10 @@ void GPUSparseMatrix<ElemType>::CopyToDenseMatrix(GPUMatrix<ElemType>& denseMatr
 {
 }
 template <class ElemType>
+void GPUSparseMatrix<ElemType>::CopyToDenseMatrix(GPUMatrix<ElemType>& denseMatrix, const ElemType alpha, const ElemType beta) const
+{
+}
+template <class ElemType>
 void GPUSparseMatrix<ElemType>::CopyToCPUSparseMatrix(CPUSparseMatrix<ElemType>& cpuSparseMatrix) const
 {
 }
@@ -683,6 +692,7 @@ void GPUSparseMatrix<ElemType>::CopyBuffer(OutType* outBuffer, const InType* inB
 #pragma endregion Helper Functions
 
 template class MATH_API GPUSparseMatrix<char>;
+template class MATH_API GPUSparseMatrix<short>;
 template class MATH_API GPUSparseMatrix<float>;
 template class MATH_API GPUSparseMatrix<double>;
 
@@ -771,6 +781,16 @@ size_t GPUMatrix<ElemType>::CopyToArray(ElemType*& arrayCopyTo, size_t& currentA
     return 0;
 }
 
+template <class ElemType>
+void GPUMatrix<ElemType>::CopyToFloat16Array(unsigned short* halfArray) const
+{
+}
+
+template <class ElemType>
+void GPUMatrix<ElemType>::SetValueFromFloat16Array(const size_t numRows, const size_t numCols, const unsigned short* halfArray)
+{
+}
+
 template <class ElemType>
 void GPUMatrix<ElemType>::ChangeDeviceTo(int to_id)
 {
@@ -897,6 +917,21 @@ GPUMatrix<ElemType>& GPUMatrix<ElemType>::AddWithRowSliceValuesOf(const GPUMatri
 {
     return *this;
 }
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignRowGatherOf(const GPUMatrix<ElemType>& /*idx*/, const GPUMatrix<ElemType>& /*a*/)
+{
+    return *this;
+}
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AddWithRowGatherOf(const GPUMatrix<ElemType>& /*idx*/, const GPUMatrix<ElemType>& /*a*/)
+{
+    return *this;
+}
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AddRowScatterOf(const GPUMatrix<ElemType>& /*idx*/, const GPUMatrix<ElemType>& /*a*/)
+{
+    return *this;
+}
 //template<class ElemType> GPUMatrix<ElemType>&  GPUMatrix<ElemType>::AssignRowStackValuesOf(const std::vector<const GPUMatrix<ElemType>*>& inputMatrices, const size_t sliceStartCol, const size_t sliceNumCols) { return *this; }
 
 template <class ElemType>
@@ -909,6 +944,16 @@ GPUMatrix<ElemType>& GPUMatrix<ElemType>::AddToRowRepeatValuesOf(const GPUMatrix
 {
     return *this;
 }
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignGatheredColumnsOf(const GPUMatrix<ElemType>& /*a*/, const std::vector<size_t>& /*columnIndices*/)
+{
+    return *this;
+}
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::ScatterGatheredColumnsOf(const GPUMatrix<ElemType>& /*packed*/, const std::vector<size_t>& /*columnIndices*/)
+{
+    return *this;
+}
 
 template <class ElemType>
 GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignPositiveAndShiftedNegSample(const GPUMatrix<ElemType>& a, const size_t posNumber, const size_t negNumber, const size_t shiftNumber)
@@ -1009,12 +1054,28 @@ void GPUMatrix<ElemType>::SetUniformRandomMask(const ElemType maskRate, const El
 {
 }
 
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignDropoutOf(const GPUMatrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset)
+{
+    return *this;
+}
+
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AddDropoutGradientOf(const GPUMatrix<ElemType>& a, const ElemType dropoutRate, const ElemType scaleValue, const unsigned long long randomSeed, const size_t offset)
+{
+    return *this;
+}
+
 template <class ElemType>
 ElemType GPUMatrix<ElemType>::Adagrad(GPUMatrix<ElemType>& gradients, const bool needAveMultiplier)
 {
     return 0;
 }
 template <class ElemType>
+void GPUMatrix<ElemType>::AdagradUpdate(GPUMatrix<ElemType>& gradients, GPUMatrix<ElemType>& functionValues, const ElemType learnRatePerSample)
+{
+}
+template <class ElemType>
 void GPUMatrix<ElemType>::FSAdagrad(GPUMatrix<ElemType>& gradients, GPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight, ElemType adaMul)
 {
 }
@@ -1064,6 +1125,13 @@ ElemType GPUMatrix<ElemType>::Get00Element() const
     ElemType res = 0;
     return res;
 }
+
+template <class ElemType>
+ElemType GPUMatrix<ElemType>::GetValue(const size_t row, const size_t col) const
+{
+    ElemType res = 0;
+    return res;
+}
 #pragma endregion Basic Operators
 
 #pragma region Member BLAS Functions
@@ -1294,6 +1362,18 @@ GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignLogSoftmaxOf(const GPUMatrix<Ele
     return *this;
 }
 
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignCrossEntropyWithSoftmaxOf(const GPUMatrix<ElemType>& /*labels*/, const GPUMatrix<ElemType>& /*predictions*/, GPUMatrix<ElemType>& /*softmaxStats*/, const GPUMatrix<char>* /*columnsValidityMask*/)
+{
+    return *this;
+}
+
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignIndexedCrossEntropyWithSoftmaxOf(const GPUMatrix<ElemType>& /*labelIndexes*/, const GPUMatrix<ElemType>& /*predictions*/, GPUMatrix<ElemType>& /*softmaxStats*/)
+{
+    return *this;
+}
+
 template <class ElemType>
 GPUMatrix<ElemType>& GPUMatrix<ElemType>::InplaceHardmax(const bool isColWise)
 {
@@ -1436,6 +1516,35 @@ ElemType GPUMatrix<ElemType>::SumOfAbsElements() const
     return ElemType(0);
 }
 
+template <class ElemType>
+void GPUMatrix<ElemType>::AccumulateAbsLogHistogram(int minExponent, GPUMatrix<ElemType>& histogram) const
+{
+}
+
+template <class ElemType>
+void GPUMatrix<ElemType>::BatchNormalizationForward(const GPUMatrix<ElemType>& scale, const GPUMatrix<ElemType>& bias,
+                                                    double expAvgFactor, double epsilon,
+                                                    GPUMatrix<ElemType>& runMean, GPUMatrix<ElemType>& runInvStdDev,
+                                                    GPUMatrix<ElemType>& out,
+                                                    GPUMatrix<ElemType>& saveMean, GPUMatrix<ElemType>& saveInvStdDev) const
+{
+}
+
+template <class ElemType>
+void GPUMatrix<ElemType>::BatchNormalizationForwardInference(const GPUMatrix<ElemType>& scale, const GPUMatrix<ElemType>& bias,
+                                                             const GPUMatrix<ElemType>& runMean, const GPUMatrix<ElemType>& runInvStdDev,
+                                                             GPUMatrix<ElemType>& out) const
+{
+}
+
+template <class ElemType>
+void GPUMatrix<ElemType>::BatchNormalizationBackward(const GPUMatrix<ElemType>& in, GPUMatrix<ElemType>& grad,
+                                                     const GPUMatrix<ElemType>& scale,
+                                                     const GPUMatrix<ElemType>& saveMean, const GPUMatrix<ElemType>& saveInvStdDev,
+                                                     GPUMatrix<ElemType>& scaleGrad, GPUMatrix<ElemType>& biasGrad) const
+{
+}
+
 template <class ElemType>
 ElemType GPUMatrix<ElemType>::SumOfElements() const
 {
@@ -1666,6 +1775,12 @@ GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignNumOfDiff(const GPUMatrix<ElemTy
     return *this;
 }
 
+template <class ElemType>
+GPUMatrix<ElemType>& GPUMatrix<ElemType>::AssignTopKError(const GPUMatrix<ElemType>& /*labels*/, const GPUMatrix<ElemType>& /*predictions*/, const int /*topK*/)
+{
+    return *this;
+}
+
 #pragma endregion Member BLAS Functions
 
 #pragma region Other helper functions
@@ -1761,6 +1876,12 @@ void GPUMatrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const GPUMatrix
 {
 }
 template <class ElemType>
+void GPUMatrix<ElemType>::MultiplyAndWeightedAddBatched(ElemType alpha, const std::vector<const GPUMatrix<ElemType>*>& a, const bool transposeA,
+                                                        const std::vector<const GPUMatrix<ElemType>*>& b, const bool transposeB,
+                                                        ElemType beta, const std::vector<GPUMatrix<ElemType>*>& c)
+{
+}
+template <class ElemType>
 void GPUMatrix<ElemType>::Multiply1x1AndWeightedAdd(ElemType alpha, const GPUMatrix<ElemType>& lhs, const GPUMatrix<ElemType>& rhs, ElemType beta, GPUMatrix<ElemType>& c)
 {
 }
@@ -1849,6 +1970,21 @@ void GPUMatrix<ElemType>::AssignScaledDifference(const GPUMatrix<ElemType>& /*al
 {
 }
 
+template <class ElemType>
+void GPUMatrix<ElemType>::AddScaledSoftmaxDifference(const GPUMatrix<ElemType>& /*alpha*/, const GPUMatrix<ElemType>& /*predictions*/, const GPUMatrix<ElemType>& /*softmaxStats*/, const GPUMatrix<ElemType>& /*labels*/, GPUMatrix<ElemType>& c, const GPUMatrix<char>* /*columnsValidityMask*/)
+{
+}
+
+template <class ElemType>
+void GPUMatrix<ElemType>::AddScaledIndexedSoftmaxDifference(const GPUMatrix<ElemType>& /*alpha*/, const GPUMatrix<ElemType>& /*predictions*/, const GPUMatrix<ElemType>& /*softmaxStats*/, const GPUMatrix<ElemType>& /*labelIndexes*/, GPUMatrix<ElemType>& c)
+{
+}
+
+template <class ElemType>
+void GPUMatrix<ElemType>::AddScaledLogSoftmax(const ElemType alpha, const GPUMatrix<ElemType>& /*weight*/, const GPUMatrix<ElemType>& /*predictions*/, const GPUMatrix<ElemType>& /*softmaxStats*/, GPUMatrix<ElemType>& c)
+{
+}
+
 //c[ci,cj] += a[ai,aj]
 template <class ElemType>
 void GPUMatrix<ElemType>::AddElementToElement(const GPUMatrix<ElemType>& /*a*/, const size_t ai, const size_t aj, GPUMatrix<ElemType>& c, const size_t ci, const size_t cj)
@@ -1936,6 +2072,12 @@ void GPUMatrix<ElemType>::CreateCurandObject(unsigned long seed, const char* cal
 {
 }
 
+template <class ElemType>
+void* GPUMatrix<ElemType>::GetCurandGenerator(unsigned long seed, const char* caller)
+{
+    return NULL;
+}
+
 template <class ElemType>
 void GPUMatrix<ElemType>::ResetCurandObject(unsigned long seed, const char* caller)
 {
@@ -1988,6 +2130,14 @@ ElemType GPUMatrix<ElemType>::LogAddSumOfElements() const
     return ElemType(0);
 }
 
+template <class ElemType>
+void GPUMatrix<ElemType>::RCRFForwardCompute(GPUMatrix<ElemType>& alpha,
+                                             const GPUMatrix<ElemType>& pos_scores,
+                                             const GPUMatrix<ElemType>& pair_scores,
+                                             const int startLbl)
+{
+}
+
 template <class ElemType>
 void GPUMatrix<ElemType>::RCRFBackwardCompute(
     const GPUMatrix<ElemType>& alpha, GPUMatrix<ElemType>& beta,
@@ -2072,6 +2222,7 @@ GPUMatrixComputeStreamEvent::GPUMatrixComputeStreamEvent(int deviceId)
 
 GPUMatrixComputeStreamEvent::~GPUMatrixComputeStreamEvent(){};
 void GPUMatrixComputeStreamEvent::SynchronizeEvent(){};
+void GPUMatrixComputeStreamEvent::SynchronizeComputeStreamWithEvent(){};
 template <>
 void GPUMatrixComputeStreamEvent::SynchronizeQuantizationComputeStreamWithEvent<float>(){};
 template <>
@@ -2083,6 +2234,17 @@ void GPUMatrixComputeStreamEvent::SynchronizeDataTransferFetchStreamWithEvent<do
 
 #pragma endregion GPUMatrixComputeStreamEvent functions
 
+#pragma region GPUMatrixComputeSideStreamSection functions
+
+GPUMatrixComputeSideStreamSection::GPUMatrixComputeSideStreamSection(int deviceId)
+    : MatrixComputeSideStreamSection(deviceId)
+{
+}
+
+GPUMatrixComputeSideStreamSection::~GPUMatrixComputeSideStreamSection(){};
+
+#pragma endregion GPUMatrixComputeSideStreamSection functions
+
 #pragma region GPUDataTransferer functions
 
 template <class ElemType>
@@ -2115,9 +2277,86 @@ void GPUDataTransferer<ElemType>::WaitForCopyCPUToGPUAsync()
 {
 }
 
+template <class ElemType>
+void GPUDataTransferer<ElemType>::CopyGPUToGPUAsync(ElemType*, int, size_t, ElemType*, int)
+{
+}
+
+template <class ElemType>
+void GPUDataTransferer<ElemType>::WaitForCopyGPUToGPUAsync()
+{
+}
+
+template <class ElemType>
+PinnedMemoryRingBuffer<ElemType>::PinnedMemoryRingBuffer(int, size_t, size_t)
+{
+}
+
+template <class ElemType>
+PinnedMemoryRingBuffer<ElemType>::~PinnedMemoryRingBuffer()
+{
+}
+
+template <class ElemType>
+ElemType* PinnedMemoryRingBuffer<ElemType>::BeginWrite()
+{
+    return nullptr;
+}
+
+template <class ElemType>
+size_t PinnedMemoryRingBuffer<ElemType>::CommitWrite(size_t, ElemType*)
+{
+    return 0;
+}
+
+template <class ElemType>
+void PinnedMemoryRingBuffer<ElemType>::WaitForUpload(size_t)
+{
+}
+
+template <class ElemType>
+bool PinnedMemoryRingBuffer<ElemType>::IsUploadDone(size_t)
+{
+    return true;
+}
+
+template class PinnedMemoryRingBuffer<float>;
+template class PinnedMemoryRingBuffer<double>;
+
 #pragma endregion GPUDataTransferer functions
 
+#pragma region CudaEventTimer functions
+
+CudaEventTimer::~CudaEventTimer()
+{
+}
+
+void CudaEventTimer::Begin(DEVICEID_TYPE)
+{
+}
+
+void CudaEventTimer::End()
+{
+}
+
+void CudaEventTimer::Harvest()
+{
+}
+
+double CudaEventTimer::TotalSeconds()
+{
+    return m_totalSeconds;
+}
+
+void CudaEventTimer::Reset()
+{
+    m_totalSeconds = 0;
+}
+
+#pragma endregion CudaEventTimer functions
+
 template class GPUMatrix<char>;
+template class GPUMatrix<short>;
 template class GPUMatrix<float>;
 template class GPUMatrix<double>;
 template class DeviceBoundNumber<float>;
@@ -2134,7 +2373,7 @@ template <class ElemType>
 cublasHandle_t GPUMatrix<ElemType>::s_cuHandle[GPUMatrix<ElemType>::MaxGpus] = {0};
 
 template <class ElemType>
-void* GPUMatrix<ElemType>::s_curandGenerator = NULL;
+void* GPUMatrix<ElemType>::s_curandGenerators[GPUMatrix<ElemType>::MaxGpus] = {0};
 
 template <class ElemType>
 typename CuDnnConvolutionEngineFactory<ElemType>::Tensor4DPtr CuDnnConvolutionEngineFactory<ElemType>::CreateTensor(size_t, size_t, size_t, size_t)
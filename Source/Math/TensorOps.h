@@ -226,6 +226,10 @@ DefBinaryOp(ElementwiseProductWithTanhDerivativeFromOutput, a*(1 - b * b));
 DefBinaryOp(ElementwiseProductWithLinearRectifierDerivativeFromOutput, b > 0 ? a : 0);
 DefBinaryOp(ElementwiseProductWithLogDerivativeFromOutput, a* exp_(-b));
 DefBinaryOp(ElementwiseProductWithCosDerivative, a * -sin_(b)); // note: b = input for cos()
+// fused binary+unary chains, one traversal of the operands (cf. TensorView deferred-op folding)
+DefBinaryOp(SigmoidOfSum, Sigmoid(a + b));
+DefBinaryOp(TanhOfSum, tanh_(a + b));
+DefBinaryOp(LinearRectifierOfSum, a + b > 0 ? a + b : 0);
 //DefBinaryOp(Index, IndexElement(a, b, i));  // note: this one uses the third argument
 
 #pragma pop_macro("DefBinaryOp")
@@ -240,6 +244,7 @@ DefBinaryOp(ElementwiseProductWithCosDerivative, a * -sin_(b)); // note: b = inp
 
 DefTernaryOp(Cond, a ? b : c);
 DefTernaryOp(Clip, a < b ? b : (a > c ? c : a));
+DefTernaryOp(MultiplyAndAdd, a * b + c); // composite op of the elementwise fusion pass
 #pragma pop_macro("DefTernaryOp")
 }
 }
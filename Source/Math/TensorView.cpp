@@ -225,12 +225,115 @@ static bool CheckDifferentObject(const TensorView<ElemType>& a, const TensorView
     return true;
 }
 
+// -------------------------------------------------------------------
+// lazy elementwise expression chains
+// -------------------------------------------------------------------
+
+// try to fold a unary op into a pending op, returning the fused opcode
+// Only valid while the pending alpha is 1, since TensorOp() applies alpha outside of the op.
+static bool TryFuseUnaryOp(ElementWiseOperator pendingOp, ElementWiseOperator unaryOp, ElementWiseOperator& fusedOp)
+{
+    if (pendingOp == ElementWiseOperator::opCopy) // copy is transparent
+    {
+        fusedOp = unaryOp;
+        return true;
+    }
+    if (pendingOp == ElementWiseOperator::opSum)
+    {
+        switch (unaryOp)
+        {
+        case ElementWiseOperator::opSigmoid:
+            fusedOp = ElementWiseOperator::opSigmoidOfSum;
+            return true;
+        case ElementWiseOperator::opTanh:
+            fusedOp = ElementWiseOperator::opTanhOfSum;
+            return true;
+        case ElementWiseOperator::opLinearRectifier:
+            fusedOp = ElementWiseOperator::opLinearRectifierOfSum;
+            return true;
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+template <class ElemType>
+void TensorView<ElemType>::DeferUnaryOpOf(const TensorView& a, ElemType alpha, ElementWiseOperator op)
+{
+    if (a.HasDeferredOp())
+        LogicError("DeferUnaryOpOf: input operands must be materialized before being consumed.");
+    // a pending chain that is overwritten before it was ever consumed is simply dropped
+    m_deferredOp = make_shared<DeferredOp>(DeferredOp{op, 1, {a}, alpha});
+}
+
+template <class ElemType>
+void TensorView<ElemType>::DeferBinaryOpOf(const TensorView& a, const TensorView& b, ElemType alpha, ElementWiseOperator op)
+{
+    if (a.HasDeferredOp() || b.HasDeferredOp())
+        LogicError("DeferBinaryOpOf: input operands must be materialized before being consumed.");
+    m_deferredOp = make_shared<DeferredOp>(DeferredOp{op, 2, {a, b}, alpha});
+}
+
+template <class ElemType>
+void TensorView<ElemType>::DeferScaleBy(ElemType alpha)
+{
+    if (!m_deferredOp) // scaling a plain view: record as a scaled in-place copy
+        m_deferredOp = make_shared<DeferredOp>(DeferredOp{ElementWiseOperator::opCopy, 1, {*this}, alpha});
+    else
+        m_deferredOp->alpha *= alpha; // TensorOp() applies alpha to the op result, so this folds exactly
+}
+
+template <class ElemType>
+void TensorView<ElemType>::DeferUnaryOp(ElementWiseOperator op)
+{
+    if (!m_deferredOp)
+    {
+        m_deferredOp = make_shared<DeferredOp>(DeferredOp{op, 1, {*this}, (ElemType) 1});
+        return;
+    }
+    // fold into the pending op if the vocabulary has a fused opcode; the pending alpha must
+    // still be 1 since TensorOp() applies alpha outside of the op, and op(x) != op(alpha * x)
+    ElementWiseOperator fusedOp;
+    if (m_deferredOp->alpha == 1 && TryFuseUnaryOp(m_deferredOp->op, op, fusedOp))
+    {
+        m_deferredOp->op = fusedOp;
+        return;
+    }
+    // not fusable: flush the pending chain, then record the unary op on the flushed result
+    Materialize();
+    m_deferredOp = make_shared<DeferredOp>(DeferredOp{op, 1, {*this}, (ElemType) 1});
+}
+
+template <class ElemType>
+void TensorView<ElemType>::Materialize(ElemType beta)
+{
+    if (!m_deferredOp)
+        return;
+    auto pending = m_deferredOp; // pop first, or the Do...Of() below would consume it again
+    m_deferredOp = nullptr;
+    if (pending->arity == 1)
+        DoUnaryOpOf(beta, pending->args[0], pending->alpha, pending->op);
+    else
+        DoBinaryOpOf(beta, pending->args[0], pending->args[1], pending->alpha, pending->op);
+}
+
 template <class ElemType>
 void TensorView<ElemType>::DoUnaryOpOf(ElemType beta, const TensorView& a, ElemType alpha, ElementWiseOperator op)
 {
     // static int cc = 0; if (cc++ == 0)
     //    fprintf(stderr, "Tensor Op: Op %d: %s -> %s\n", (int)op, string(a.GetShape()).c_str(), string(GetShape()).c_str());
 
+    if (a.HasDeferredOp())
+        LogicError("DoUnaryOpOf: input operands must be materialized before being consumed.");
+    if (m_deferredOp) // pending lazy chain on the output: consumed by the accumulation, or dropped if overwritten
+    {
+        if (beta != 0)
+            Materialize();
+        else
+            m_deferredOp = nullptr;
+    }
+
     // prepare all tensor descriptor information as needed for execution
     array<size_t, 2> offsets;
     array<SmallVector<ptrdiff_t>, 2> regularStrides, reducingStrides;
@@ -251,6 +354,16 @@ void TensorView<ElemType>::DoBinaryOpOf(ElemType beta, const TensorView& a, cons
     // static int cc = 0; if (cc++ == 0)
     //    fprintf(stderr, "Tensor Op: Op %d: %s op %s -> %s\n", (int)op, string(a.GetShape()).c_str(), string(b.GetShape()).c_str(), string(GetShape()).c_str());
 
+    if (a.HasDeferredOp() || b.HasDeferredOp())
+        LogicError("DoBinaryOpOf: input operands must be materialized before being consumed.");
+    if (m_deferredOp) // pending lazy chain on the output: consumed by the accumulation, or dropped if overwritten
+    {
+        if (beta != 0)
+            Materialize();
+        else
+            m_deferredOp = nullptr;
+    }
+
     array<size_t, 3> offsets;
     array<SmallVector<ptrdiff_t>, 3> regularStrides, reducingStrides;
     SmallVector<size_t> regularOpDims, reducingOpDims;
@@ -269,6 +382,16 @@ void TensorView<ElemType>::DoTernaryOpOf(ElemType beta, const TensorView& a, con
     // static int cc = 0; if (cc++ == 0)
     //    fprintf(stderr, "Tensor Op: Op %d: %s, %s, %s -> %s\n", (int)op, string(a.GetShape()).c_str(), string(b.GetShape()).c_str(), string(c.GetShape()).c_str(), string(GetShape()).c_str());
 
+    if (a.HasDeferredOp() || b.HasDeferredOp() || c.HasDeferredOp())
+        LogicError("DoTernaryOpOf: input operands must be materialized before being consumed.");
+    if (m_deferredOp) // pending lazy chain on the output: consumed by the accumulation, or dropped if overwritten
+    {
+        if (beta != 0)
+            Materialize();
+        else
+            m_deferredOp = nullptr;
+    }
+
     array<size_t, 4> offsets;
     array<SmallVector<ptrdiff_t>, 4> regularStrides, reducingStrides;
     SmallVector<size_t> regularOpDims, reducingOpDims;
@@ -351,6 +474,18 @@ template <class ElemType>
         t3.DoSumOf(0, t1, t2, 1);
         m3.Print();
     }
+    {
+        // lazy fused chain: Plus -> Sigmoid -> Scale runs as a single traversal (opSigmoidOfSum)
+        m1.SetValue(3, 2, {1, 2, 3, 4, 5, 6});
+        m2.SetValue(3, 2, {6, 5, 4, 3, 2, 1});
+        m3.Resize(3, 2);
+        auto t = TensorView(m3);
+        t.DeferBinaryOpOf(TensorView(m1), TensorView(m2), 1, ElementWiseOperator::opSum);
+        t.DeferUnaryOp(ElementWiseOperator::opSigmoid);
+        t.DeferScaleBy(2);
+        t.Materialize();
+        m3.Print();
+    }
 }
 
 template class TensorView<float>;
@@ -40,7 +40,7 @@ public:
     }
     // copy constructor
     TensorView(const TensorView<ElemType>& other)
-        : m_sob(other.m_sob.AsReference()), m_shape(other.m_shape)
+        : m_sob(other.m_sob.AsReference()), m_shape(other.m_shape), m_deferredOp(other.m_deferredOp)
     {
     }
 
@@ -114,12 +114,36 @@ public:
     ForAllTernaryOps(DeclareTernaryTensorOp);
 #pragma pop_macro("DeclareTernaryTensorOp")
 
+    // -------------------------------------------------------------------
+    // lazy elementwise expression chains
+    // Defer...Of() records an operation on 'this' instead of executing it. Follow-up steps
+    // (DeferScaleBy(), DeferUnaryOp()) are folded into the pending record where the op
+    // vocabulary allows: scale factors fold into alpha, a trailing nonlinearity folds into its
+    // fused opcode (e.g. opSum + opSigmoid -> opSigmoidOfSum). Materialize() then runs the whole
+    // chain as one traversal of the operands -- one kernel launch on GPU, one cache pass on CPU.
+    // Materialization is also triggered automatically when the pending result is first consumed
+    // by an eager Do...Of() with beta != 0; chains that get overwritten unconsumed are dropped.
+    // Deferred views must be materialized before being passed as an *input* to another op.
+    // -------------------------------------------------------------------
+
+    void DeferUnaryOpOf(const TensorView& a, ElemType alpha, ElementWiseOperator op);
+    void DeferBinaryOpOf(const TensorView& a, const TensorView& b, ElemType alpha, ElementWiseOperator op);
+    void DeferScaleBy(ElemType alpha);         // scales the (pending) result
+    void DeferUnaryOp(ElementWiseOperator op); // applies a unary op to the (pending) result
+    void Materialize(ElemType beta = 0);       // executes the pending chain: this := beta * this + chain
+    bool HasDeferredOp() const
+    {
+        return m_deferredOp != nullptr;
+    }
+
     static void Test();
 
     void DoUnaryOpOf(ElemType beta, const TensorView& a, ElemType alpha, ElementWiseOperator op);
     void DoBinaryOpOf(ElemType beta, const TensorView& a, const TensorView& b, ElemType alpha, ElementWiseOperator op);
     void DoTernaryOpOf(ElemType beta, const TensorView& a, const TensorView& b, const TensorView& c, ElemType alpha, ElementWiseOperator op);
 
+    struct DeferredOp; // the pending (recorded but not yet executed) operation of a lazy chain; defined below
+
 private:
     // -------------------------------------------------------------------
     // accessors
@@ -145,6 +169,17 @@ private:
     Matrix<ElemType> m_sob; // Storage OBject that holds the data that is being viewed with this TensorView. This is really a reference (not owing the buffer).
     TensorShape m_shape;    // the meta-data that describes the data's shape and/or access pattern
     // TODO: use a reference here or not? With a reference, we can hide more info in here such as cuDNN handles
+
+    std::shared_ptr<DeferredOp> m_deferredOp; // pending lazy chain, or null
+};
+
+template <class ElemType>
+struct TensorView<ElemType>::DeferredOp
+{
+    ElementWiseOperator op;
+    size_t arity;                 // 1 or 2 (number of valid entries in args)
+    std::vector<TensorView> args; // recorded input operands (references into their SOBs)
+    ElemType alpha;
 };
 }
 }
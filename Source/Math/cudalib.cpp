@@ -11,6 +11,7 @@
 #include "cudalib.h"
 #include "cudadevice.h"
 #include <string>
+#include <string.h> // for memcpy()
 #include <assert.h>
 #include <cublas_v2.h>
 
@@ -75,9 +76,79 @@ void freebytes(void *p)
     cudaFree(p) || "cudaFree failed";
 }
 
+// ---------------------------------------------------------------------------
+// staged host-to-device copies
+// The lattice of each utterance is uploaded as half a dozen small arrays that
+// live in pageable STL vectors; a plain cudaMemcpy on each one blocks the host
+// for a full round trip, so uploading a minibatch of lattices costs hundreds of
+// host syncs. Instead we copy through a small ring of page-locked buffers: the
+// host-side copy into the staging buffer is cheap, the DMA is issued
+// asynchronously, and the uploads of consecutive arrays (and utterances) queue
+// back to back on the stream. Only an explicit join() waits for them; kernels
+// launched afterwards are ordered behind the copies by the stream anyway.
+// ---------------------------------------------------------------------------
+
+class stagedcopybuffers
+{
+    static const size_t numbuffers = 4;
+    void *buffers[numbuffers];       // page-locked staging buffers, grown on demand
+    size_t capacities[numbuffers];   // allocated bytes of each
+    cudaEvent_t copydone[numbuffers];// event marking when the DMA that last used the buffer completed
+    size_t next;                     // round-robin cursor
+
+public:
+    stagedcopybuffers()
+        : next(0)
+    {
+        for (size_t i = 0; i < numbuffers; i++)
+        {
+            buffers[i] = NULL;
+            capacities[i] = 0;
+            copydone[i] = NULL;
+        }
+    }
+    // get a staging buffer of at least 'nbytes'
+    // This waits until the DMA that last used the buffer has drained, which with
+    // 'numbuffers' in flight happens long after the copy completed in practice.
+    void *getbuffer(size_t nbytes)
+    {
+        size_t i = next;
+        next = (next + 1) % numbuffers;
+        if (copydone[i] != NULL) // buffer was used before: wait for its copy, then retire the event
+        {
+            cudaEventSynchronize(copydone[i]) || "cudaEventSynchronize failed";
+            cudaEventDestroy(copydone[i]) || "cudaEventDestroy failed";
+            copydone[i] = NULL;
+        }
+        if (capacities[i] < nbytes) // grow on demand
+        {
+            if (buffers[i] != NULL)
+                cudaFreeHost(buffers[i]) || "cudaFreeHost failed";
+            cudaMallocHost(&buffers[i], nbytes) || "cudaMallocHost failed";
+            capacities[i] = nbytes;
+        }
+        return buffers[i];
+    }
+    // mark the buffer handed out last as in flight on the current stream
+    // The event is created here so it always lives in the current device's context.
+    void markinflight()
+    {
+        size_t i = (next + numbuffers - 1) % numbuffers;
+        cudaEventCreateWithFlags(&copydone[i], cudaEventDisableTiming) || "cudaEventCreateWithFlags failed";
+        cudaEventRecord(copydone[i], GetCurrentStream()) || "cudaEventRecord failed";
+    }
+};
+
+static stagedcopybuffers stagingbuffers;
+
 void memcpyh2d(void *dst, size_t byteoffset, const void *src, size_t nbytes)
 {
-    cudaMemcpy(byteoffset + (char *) dst, src, nbytes, cudaMemcpyHostToDevice) || "cudaMemcpy failed";
+    if (nbytes == 0)
+        return;
+    void *staged = stagingbuffers.getbuffer(nbytes);
+    ::memcpy(staged, src, nbytes);
+    cudaMemcpyAsync(byteoffset + (char *) dst, staged, nbytes, cudaMemcpyHostToDevice, GetCurrentStream()) || "cudaMemcpyAsync failed";
+    stagingbuffers.markinflight();
 }
 
 void memcpyd2h(void *dst, const void *src, size_t byteoffset, size_t nbytes)
@@ -36,6 +36,8 @@ BinaryFile::BinaryFile(std::wstring fileName, FileOptions options, size_t size)
     /* If file created, continue to map file. */
 
     m_writeFile = options == fileOptionsReadWrite;
+    m_wholeFileView = NULL;
+    m_stopPrefetch = false;
     m_name = fileName;
     m_maxViewSize = 0x10000000; // 256MB initial max size
     m_hndFile = CreateFile(fileName.c_str(), m_writeFile ? (GENERIC_WRITE | GENERIC_READ) : GENERIC_READ,
@@ -76,6 +78,33 @@ BinaryFile::BinaryFile(std::wstring fileName, FileOptions options, size_t size)
     }
     m_mappedSize = size;
 
+    // when reading, map the entire file in a single view up front. All section headers and
+    // element buffers then become stable pointers into the one mapping, so views never move
+    // (no RemapHeader fixups) and sections are served zero-copy at any offset, aligned or not.
+    // Writing still uses individual views because the mapping has to grow along with the file.
+    if (!m_writeFile && size > 0)
+    {
+        m_wholeFileView = MapViewOfFile(m_hndMapped, FILE_MAP_READ, 0, 0, size);
+        if (m_wholeFileView != NULL)
+        {
+            // sections are stored (and read back) in file-position order, so touching the pages
+            // sequentially walks the epoch's section access order ahead of the readers and keeps
+            // the disk request queue full instead of faulting one page at a time
+            void* view = m_wholeFileView;
+            std::atomic<bool>* stopPrefetch = &m_stopPrefetch;
+            m_prefetchThread = std::thread([view, size, stopPrefetch]()
+                                           {
+                                               const size_t pageSize = 0x1000;
+                                               volatile char touched = 0;
+                                               for (size_t offset = 0; offset < size && !*stopPrefetch; offset += pageSize)
+                                                   touched += *((volatile char*) view + offset);
+                                               touched;
+                                           });
+        }
+        // if the single mapping failed (e.g. address space exhaustion on a huge file),
+        // m_wholeFileView stays NULL and GetView() falls back to individual views
+    }
+
     // if writing the file, the inital size of the file is zero
     if (m_writeFile)
     {
@@ -86,11 +115,17 @@ BinaryFile::BinaryFile(std::wstring fileName, FileOptions options, size_t size)
 // Destructor - destroy the BinaryFile
 BinaryFile::~BinaryFile()
 {
+    // stop the prefetch thread before tearing down the mapping it touches
+    m_stopPrefetch = true;
+    if (m_prefetchThread.joinable())
+        m_prefetchThread.join();
     for (auto iter = m_views.begin(); iter != m_views.end();)
     {
         // the view
         iter = ReleaseView(iter, true);
     }
+    if (m_wholeFileView != NULL)
+        UnmapViewOfFile(m_wholeFileView);
     CloseHandle(m_hndMapped);
 
     // if we are writing the file, truncate to actual size
@@ -193,8 +228,12 @@ vector<ViewPosition>::iterator BinaryFile::ReleaseView(vector<ViewPosition>::ite
     {
         if (m_writeFile)
             FlushViewOfFile(iter->view, iter->size);
-        bool ret = UnmapViewOfFile(iter->view) != FALSE;
-        ret;
+        // views into the whole-file mapping are plain offsets, nothing to unmap per view
+        if (m_wholeFileView == NULL)
+        {
+            bool ret = UnmapViewOfFile(iter->view) != FALSE;
+            ret;
+        }
         iter = m_views.erase(iter);
     }
     return iter;
@@ -206,6 +245,22 @@ vector<ViewPosition>::iterator BinaryFile::ReleaseView(vector<ViewPosition>::ite
 // returns - pointer to the view
 void* BinaryFile::GetView(size_t filePosition, size_t size)
 {
+    // whole-file mapping (read mode): a view is just an offset into the single mapping,
+    // no MapViewOfFile call per view and no allocation-granularity alignment constraint.
+    // The returned address depends only on filePosition, so views never move on reallocate.
+    if (m_wholeFileView != NULL)
+    {
+        if (filePosition + size > m_mappedSize)
+        {
+            char message[128];
+            sprintf_s(message, "Unable to map file %ls @ %lld, view extends past the end of the file", m_name.c_str(), filePosition);
+            RuntimeError(message);
+        }
+        void* view = (byte*) m_wholeFileView + filePosition;
+        m_views.push_back(ViewPosition(view, filePosition, size));
+        return view;
+    }
+
     void* pBuf = MapViewOfFile(m_hndMapped,                                  // handle to map object
                                m_writeFile ? FILE_MAP_WRITE : FILE_MAP_READ, // get correct permissions
                                HIDWORD(filePosition),
@@ -9,6 +9,7 @@
 #define DATAREADER_EXPORTS // creating the exports here
 #include "DataReader.h"
 #include "BinaryReader.h"
+#include "CUDAPageLockedMemAllocator.h"
 #ifdef LEAKDETECT
 #include <vld.h> // leak detection
 #endif
@@ -124,6 +125,11 @@ void BinaryReader<ElemType>::InitFromConfig(const ConfigRecordType& readerConfig
     m_partialMinibatch = false;
     m_traceLevel = readerConfig(L"traceLevel", 0);
 
+    // optionally pin the mapped file pages so minibatch uploads DMA directly from the file mapping
+    // (registration happens lazily on the first GetMinibatch() call, when the target device is known)
+    m_pinMappedPages = readerConfig(L"pinMappedPages", false);
+    m_pinnedViewDevice = -1;
+
     // determine if partial minibatches are desired
     std::string minibatchMode(readerConfig(L"minibatchMode", "Partial"));
     m_partialMinibatch = !_stricmp(minibatchMode.c_str(), "Partial");
@@ -173,6 +179,11 @@ BinaryReader<ElemType>::~BinaryReader()
     // clear the section references, they will be deleted by the sectionFile destructors
     m_sections.clear();
 
+    // unpin the file views before the sectionFile destructors unmap them
+    for (void* view : m_pinnedViews)
+        CUDAPageLockedMemAllocator::UnregisterHostMemory(view, m_pinnedViewDevice);
+    m_pinnedViews.clear();
+
     for (SectionFile* secFile : m_secFiles)
     {
         delete secFile;
@@ -264,6 +275,26 @@ bool BinaryReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<ElemType
     if (endOfDataset)
         return false;
 
+    // on the first minibatch for a GPU target, pin the whole-file views so the SetValue() calls
+    // below copy via DMA straight from the mapped file pages instead of staging through pageable memory
+    if (m_pinMappedPages && m_pinnedViewDevice < 0 && !matrices.empty())
+    {
+        int deviceId = matrices.begin()->second->GetDeviceId();
+        if (deviceId >= 0)
+        {
+            for (SectionFile* secFile : m_secFiles)
+            {
+                void* view = secFile->GetWholeFileView();
+                size_t viewSize = secFile->GetWholeFileViewSize();
+                if (view != NULL && CUDAPageLockedMemAllocator::RegisterHostMemory(view, viewSize, deviceId))
+                    m_pinnedViews.push_back(view);
+                else if (m_traceLevel > 0)
+                    fprintf(stderr, "BinaryReader: could not pin mapped pages of %ls, uploads will use pageable copies\n", secFile->GetName().c_str());
+            }
+            m_pinnedViewDevice = deviceId;
+        }
+    }
+
     for (auto value : matrices)
     {
         wstring matrixName = value.first;
@@ -11,6 +11,8 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <thread>
+#include <atomic>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -137,8 +139,11 @@ protected:
     size_t m_viewAlignment;   // address alignment required by views
     size_t m_filePositionMax; // current maximum file position in the file
     bool m_writeFile;
-    std::wstring m_name;          // name of this
-    vector<ViewPosition> m_views; // keep track of all the views into the file
+    void* m_wholeFileView;            // read mode: single view covering the entire file (NULL when writing, or if the mapping failed)
+    std::thread m_prefetchThread;     // read mode: touches the pages of the whole-file view in file order, ahead of the readers
+    std::atomic<bool> m_stopPrefetch; // signals the prefetch thread to exit early
+    std::wstring m_name;              // name of this
+    vector<ViewPosition> m_views;     // keep track of all the views into the file
 public:
     BinaryFile(std::wstring fileName, FileOptions options = fileOptionsRead, size_t size = 0);
     virtual ~BinaryFile();
@@ -161,6 +166,14 @@ public:
     {
         return m_viewAlignment;
     }
+    void* GetWholeFileView() const
+    {
+        return m_wholeFileView;
+    }
+    size_t GetWholeFileViewSize() const
+    {
+        return m_wholeFileView != NULL ? m_mappedSize : 0;
+    }
     bool Writing()
     {
         return m_writeFile;
@@ -560,6 +573,10 @@ private:
     vector<SectionFile*> m_secFiles;
     std::map<std::wstring, Section*, nocase_compare> m_sections;
 
+    bool m_pinMappedPages;       // pin the mapped file pages so GPU uploads DMA directly from the file mapping
+    int m_pinnedViewDevice;      // device the views were registered with (-1 until registered)
+    vector<void*> m_pinnedViews; // whole-file views that were successfully pinned
+
     /**
     for reading one line per file, i.e., a file has only one line of data
     */
@@ -16,22 +16,7 @@
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
-DWORD HIDWORD(size_t size)
-{
-    return size >> 32;
-}
-DWORD LODWORD(size_t size)
-{
-    return size & 0xFFFFFFFF;
-}
-
-std::string ws2s(const std::wstring& wstr)
-{
-    int size_needed = WideCharToMultiByte(CP_ACP, 0, wstr.c_str(), int(wstr.length() + 1), 0, 0, 0, 0);
-    std::string strTo(size_needed, 0);
-    WideCharToMultiByte(CP_ACP, 0, wstr.c_str(), int(wstr.length() + 1), &strTo[0], size_needed, 0, 0);
-    return strTo;
-}
+size_t RoundUp(size_t value, size_t size); // defined below
 
 template <class ElemType>
 size_t DSSMReader<ElemType>::RandomizeSweep(size_t mbStartSample)
@@ -200,21 +185,19 @@ void DSSMReader<ElemType>::InitFromConfig(const ConfigRecordType& readerConfig)
     m_partialMinibatch = !_stricmp(minibatchMode.c_str(), "Partial");
 
     // Get the config parameters for query feature and doc feature
-    ConfigParameters configFeaturesQuery = readerConfig(m_featuresNameQuery, "");
-    ConfigParameters configFeaturesDoc = readerConfig(m_featuresNameDoc, "");
-
-    if (configFeaturesQuery.size() == 0)
-        RuntimeError("features file not found, required in configuration: i.e. 'features=[file=c:\\myfile.txt;start=1;dim=123]'");
-    if (configFeaturesDoc.size() == 0)
+    if (!readerConfig.Exists(m_featuresNameQuery) || !readerConfig.Exists(m_featuresNameDoc))
         RuntimeError("features file not found, required in configuration: i.e. 'features=[file=c:\\myfile.txt;start=1;dim=123]'");
 
+    const ConfigRecordType& configFeaturesQuery = readerConfig(m_featuresNameQuery);
+    const ConfigRecordType& configFeaturesDoc = readerConfig(m_featuresNameDoc);
+
     // Read in feature size information
     // This information will be used to handle OOVs
     m_featuresDimQuery = configFeaturesQuery(L"dim");
     m_featuresDimDoc = configFeaturesDoc(L"dim");
 
-    std::wstring fileQ = configFeaturesQuery("file");
-    std::wstring fileD = configFeaturesDoc("file");
+    std::wstring fileQ = configFeaturesQuery(L"file");
+    std::wstring fileD = configFeaturesDoc(L"file");
 
     dssm_queryInput.Init(fileQ, m_featuresDimQuery);
     dssm_docInput.Init(fileD, m_featuresDimDoc);
@@ -392,6 +375,8 @@ bool DSSMReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<ElemType>*
     if (actualMBSize > m_mbSize || m_labelsBuffer == NULL)
     {
         size_t rows = labels.GetNumRows();
+        if (m_labelsBuffer != NULL)
+            delete[] m_labelsBuffer;
         m_labelsBuffer = new ElemType[rows * actualMBSize];
         memset(m_labelsBuffer, 0, sizeof(ElemType) * rows * actualMBSize);
         for (int i = 0; i < actualMBSize; i++)
@@ -431,7 +416,7 @@ const std::map<typename IDataReader<ElemType>::LabelIdType, typename IDataReader
 // labelMapping - mapping table from label values to IDs (must be 0-n)
 // note: for tasks with labels, the mapping table must be the same between a training run and a testing run
 template <class ElemType>
-void DSSMReader<ElemType>::SetLabelMapping(const std::wstring& /*sectionName*/, const std::map<typename IDataReader<ElemType>::LabelIdType, typename LabelType>& labelMapping)
+void DSSMReader<ElemType>::SetLabelMapping(const std::wstring& /*sectionName*/, const std::map<typename IDataReader<ElemType>::LabelIdType, typename IDataReader<ElemType>::LabelType>& labelMapping)
 {
     if (m_cachingReader)
     {
@@ -480,74 +465,23 @@ DSSM_BinaryInput<ElemType>::~DSSM_BinaryInput()
 template <class ElemType>
 void DSSM_BinaryInput<ElemType>::Init(wstring fileName, size_t dim)
 {
-
     m_dim = dim;
     mbSize = 0;
-    /*
-    m_hndl = CreateFileA(fileName.c_str(), GENERIC_READ,
-        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-    */
-    m_hndl = CreateFile(fileName.c_str(), GENERIC_READ,
-                        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-    if (m_hndl == INVALID_HANDLE_VALUE)
-    {
-        char message[256];
-        sprintf_s(message, "Unable to Open/Create file %ls, error %x", fileName.c_str(), GetLastError());
-        RuntimeError(message);
-    }
-
-    m_filemap = CreateFileMapping(m_hndl, NULL, PAGE_READONLY, 0, 0, NULL);
-
-    SYSTEM_INFO sysinfo;
-    GetSystemInfo(&sysinfo);
-    DWORD sysGran = sysinfo.dwAllocationGranularity;
 
-    header_buffer = MapViewOfFile(m_filemap,     // handle to map object
-                                  FILE_MAP_READ, // get correct permissions
-                                  HIDWORD(0),
-                                  LODWORD(0),
-                                  sizeof(int64_t) * 2 + sizeof(int32_t));
+    // map the whole file once; offsets table and record data are used in place
+    m_mapping = SharedFileMapping::Open(fileName);
+    const char* view = m_mapping->Data();
 
-    // cout << "After mapviewoffile" << endl;
+    if (m_mapping->Size() < (int64_t)(sizeof(int64_t) * 2 + sizeof(int32_t)))
+        RuntimeError("DSSM_BinaryInput: file %ls is too small to hold a header", fileName.c_str());
 
-    memcpy(&numRows, header_buffer, sizeof(int64_t));
-    memcpy(&numCols, (char*) header_buffer + sizeof(int64_t), sizeof(int32_t));
-    memcpy(&totalNNz, (char*) header_buffer + sizeof(int64_t) + sizeof(int32_t), sizeof(int64_t));
+    memcpy(&numRows, view, sizeof(int64_t));
+    memcpy(&numCols, view + sizeof(int64_t), sizeof(int32_t));
+    memcpy(&totalNNz, view + sizeof(int64_t) + sizeof(int32_t), sizeof(int64_t));
 
-    // cout << "After gotvalues" << endl;
-    int64_t base_offset = sizeof(int64_t) * 2 + sizeof(int32_t);
-
-    int64_t offsets_padding = base_offset % sysGran;
-    base_offset -= offsets_padding;
-
-    int64_t header_size = numRows * sizeof(int64_t) + offsets_padding;
-
-    void* offsets_orig = MapViewOfFile(m_filemap,     // handle to map object
-                                       FILE_MAP_READ, // get correct permissions
-                                       HIDWORD(base_offset),
-                                       LODWORD(base_offset),
-                                       header_size);
-
-    offsets_buffer = (char*) offsets_orig + offsets_padding;
-
-    if (offsets != NULL)
-    {
-        free(offsets);
-    }
-    offsets = (int64_t*) malloc(sizeof(int64_t) * numRows);
-    memcpy(offsets, offsets_buffer, numRows * sizeof(int64_t));
-
-    int64_t header_offset = base_offset + offsets_padding + numRows * sizeof(int64_t);
-
-    int64_t data_padding = header_offset % sysGran;
-    header_offset -= data_padding;
-
-    void* data_orig = MapViewOfFile(m_filemap,     // handle to map object
-                                    FILE_MAP_READ, // get correct permissions
-                                    HIDWORD(header_offset),
-                                    LODWORD(header_offset),
-                                    0);
-    data_buffer = (char*) data_orig + data_padding;
+    // the offsets table follows the header, the record data follows the offsets table
+    offsets = (const int64_t*) (view + sizeof(int64_t) * 2 + sizeof(int32_t));
+    data_buffer = (const char*) (offsets + numRows);
 }
 template <class ElemType>
 bool DSSM_BinaryInput<ElemType>::SetupEpoch(size_t minibatchSize)
@@ -592,10 +526,12 @@ bool DSSM_BinaryInput<ElemType>::Next_Batch(Matrix<ElemType>& matrices, size_t c
         // int64_t cur_offset = offsets[ordering[c]];
         // int32_t nnz;
         colIndices[c] = cur_index;
-        int32_t nnz = *(int32_t*) ((char*) data_buffer + cur_offset);
+        int32_t nnz = *(int32_t*) (data_buffer + cur_offset);
         // memcpy(&nnz, (char*)data_buffer + cur_offset, sizeof(int32_t));
-        memcpy(values + cur_index, (char*) data_buffer + cur_offset + sizeof(int32_t), sizeof(ElemType) * nnz);
-        memcpy(rowIndices + cur_index, (char*) data_buffer + cur_offset + sizeof(int32_t) + sizeof(ElemType) * nnz, sizeof(int32_t) * nnz);
+        if (cur_index + nnz > (int32_t)(MAX_BUFFER * mbSize))
+            RuntimeError("DSSM_BinaryInput: input data is too dense, more than %d nz values per record on average", (int) MAX_BUFFER);
+        memcpy(values + cur_index, data_buffer + cur_offset + sizeof(int32_t), sizeof(ElemType) * nnz);
+        memcpy(rowIndices + cur_index, data_buffer + cur_offset + sizeof(int32_t) + sizeof(ElemType) * nnz, sizeof(int32_t) * nnz);
         /**
         fprintf(stderr, "%4d (%3d, %6d): ", c, nnz, cur_index + nnz);
         for (int i = 0; i < nnz; i++)
@@ -648,19 +584,8 @@ bool DSSM_BinaryInput<ElemType>::Next_Batch(Matrix<ElemType>& matrices, size_t c
 template <class ElemType>
 void DSSM_BinaryInput<ElemType>::Dispose()
 {
-    if (offsets_orig != NULL)
-    {
-        UnmapViewOfFile(offsets_orig);
-    }
-    if (data_orig != NULL)
-    {
-        UnmapViewOfFile(data_orig);
-    }
+    // the mapped view (and with it offsets/data_buffer) is released by m_mapping
 
-    if (offsets != NULL)
-    {
-        free(offsets); // = (ElemType*)malloc(sizeof(float)* 230 * 1024);
-    }
     if (values != NULL)
     {
         free(values); // = (ElemType*)malloc(sizeof(float)* 230 * 1024);
@@ -9,6 +9,7 @@
 #include "DataWriter.h"
 #include "Config.h"
 #include "RandomOrdering.h"
+#include "SharedFileMapping.h"
 #include <string>
 #include <map>
 #include <vector>
@@ -23,30 +24,24 @@ enum LabelKind
     labelOther = 3,      // some other type of label
 };
 
+// One memory-mapped sparse input stream (query or document side).
+// The offsets table and the record data are referenced straight out of the mapped view;
+// only the per-minibatch CSC assembly (which has to de-interleave the per-record nnz
+// headers) copies into scratch buffers.
 template <class ElemType>
 class DSSM_BinaryInput
 {
 private:
-    HANDLE m_hndl;
-    HANDLE m_filemap;
-    HANDLE m_header;
-    HANDLE m_offsets;
-    HANDLE m_data;
+    std::shared_ptr<SharedFileMapping> m_mapping; // keeps the view alive for offsets/data_buffer below
 
-    // void* header_orig; // Don't need this since the header is at the start of the file
-    void* offsets_orig;
-    void* data_orig;
-
-    void* header_buffer;
-    void* offsets_buffer;
-    void* data_buffer;
+    const int64_t* offsets;  // per-record byte offsets into data_buffer (points into the view)
+    const char* data_buffer; // start of the record data (points into the view)
 
     size_t m_dim;
     size_t mbSize;
     size_t MAX_BUFFER = 300;
 
     ElemType* values;    // = (ElemType*)malloc(sizeof(float)* 230 * 1024);
-    int64_t* offsets;    // = (int*)malloc(sizeof(int)* 230 * 1024);
     int32_t* colIndices; // = (int*)malloc(sizeof(int)* (batchsize + 1));
     int32_t* rowIndices; // = (int*)malloc(sizeof(int)* MAX_BUFFER * batchsize);
 
@@ -63,12 +58,17 @@ public:
     void Dispose();
 };
 
+// DSSMReader -- reads query/document pairs for DSSM-style ranker training.
+// Note that the reader emits positive pairs only: negatives are obtained in the network by
+// rotating the document columns of the same minibatch (CosDistanceWithNegativeSamples with
+// its shift/negNumber inputs), so no negative examples are ever read, copied, or uploaded.
 template <class ElemType>
 class DSSMReader : public IDataReader<ElemType>
 {
-    // public:
-    //    typedef std::string LabelType;
-    //    typedef unsigned LabelIdType;
+public:
+    using LabelType = typename IDataReader<ElemType>::LabelType;
+    using LabelIdType = typename IDataReader<ElemType>::LabelIdType;
+
 private:
     int* read_order; // array to shuffle to reorder the dataset
     std::wstring m_featuresNameQuery;
@@ -172,7 +172,7 @@ public:
     }
 
     virtual const std::map<LabelIdType, LabelType>& GetLabelMapping(const std::wstring& sectionName);
-    virtual void SetLabelMapping(const std::wstring& sectionName, const std::map<LabelIdType, typename LabelType>& labelMapping);
+    virtual void SetLabelMapping(const std::wstring& sectionName, const std::map<LabelIdType, LabelType>& labelMapping);
     virtual bool GetData(const std::wstring& sectionName, size_t numRecords, void* data, size_t& dataBufferSize, size_t recordStart = 0);
 
     virtual bool DataEnd(EndDataType endDataType);
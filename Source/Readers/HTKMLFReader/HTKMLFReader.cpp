@@ -18,6 +18,8 @@
 
 #include "rollingwindowsource.h" // minibatch sources
 #include "utterancesourcemulti.h"
+#include "minibatchsourcemixer.h"     // online data mixing over several corpora
+#include "minibatchsourceaugmenter.h" // on-the-fly feature augmentation
 #include "chunkevalsource.h"
 #include "minibatchiterator.h"
 #define DATAREADER_EXPORTS // creating the exports here
@@ -26,6 +28,7 @@
 #include "ScriptableObjects.h"
 #include "HTKMLFReader.h"
 #include "TimerUtility.h"
+#include "MPIWrapper.h" // for mpi.h (and the msmpi link pragma on Windows); used by the corpus-index broadcast below
 #ifdef LEAKDETECT
 #include <vld.h> // for memory leak detection
 #endif
@@ -50,6 +53,131 @@ namespace msra { namespace lm {
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
+// ---------------------------------------------------------------------------
+// broadcasting the compiled corpus index (expanded feature-file lists and MLF
+// labels) from rank 0 to all other ranks of a parallel job, so that only one
+// rank parses the multi-gigabyte script and label files at start-up
+// ---------------------------------------------------------------------------
+// Note: this uses raw MPI on MPI_COMM_WORLD rather than the MPIWrapper instance,
+// which lives in the hosting executable and is not visible from a reader plugin.
+// All ranks construct their readers at the same point, so the collective calls line up.
+
+// append raw bytes / a length-prefixed string to the blob
+template <typename T>
+static void BlobPut(std::vector<char>& blob, const T& v)
+{
+    const char* p = (const char*) &v;
+    blob.insert(blob.end(), p, p + sizeof(T));
+}
+static void BlobPut(std::vector<char>& blob, const std::wstring& s)
+{
+    BlobPut(blob, (unsigned int) s.size());
+    const char* p = (const char*) s.data();
+    blob.insert(blob.end(), p, p + s.size() * sizeof(wchar_t));
+}
+template <typename T>
+static void BlobGet(const char*& p, const char* pend, T& v)
+{
+    if (p + sizeof(T) > pend)
+        RuntimeError("BroadcastCorpusIndex: malformed corpus-index blob");
+    memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+}
+static void BlobGet(const char*& p, const char* pend, std::wstring& s)
+{
+    unsigned int len;
+    BlobGet(p, pend, len);
+    if (p + len * sizeof(wchar_t) > pend)
+        RuntimeError("BroadcastCorpusIndex: malformed corpus-index blob");
+    s.assign((const wchar_t*) p, len);
+    p += len * sizeof(wchar_t);
+}
+
+static void SerializeCorpusIndex(const std::vector<std::vector<std::wstring>>& infilesmulti,
+                                 const std::vector<std::map<std::wstring, std::vector<msra::asr::htkmlfentry>>>& labelsmulti,
+                                 std::vector<char>& blob)
+{
+    BlobPut(blob, (unsigned int) infilesmulti.size());
+    for (const auto& filelist : infilesmulti)
+    {
+        BlobPut(blob, (unsigned int) filelist.size());
+        for (const auto& path : filelist)
+            BlobPut(blob, path);
+    }
+    BlobPut(blob, (unsigned int) labelsmulti.size());
+    for (const auto& labels : labelsmulti)
+    {
+        BlobPut(blob, (unsigned int) labels.size());
+        for (const auto& utt : labels)
+        {
+            BlobPut(blob, utt.first);
+            BlobPut(blob, (unsigned int) utt.second.size());
+            for (const auto& entry : utt.second) // htkmlfentry holds only numeric fields
+                BlobPut(blob, entry);
+        }
+    }
+}
+
+static void DeserializeCorpusIndex(const std::vector<char>& blob,
+                                   std::vector<std::vector<std::wstring>>& infilesmulti,
+                                   std::vector<std::map<std::wstring, std::vector<msra::asr::htkmlfentry>>>& labelsmulti)
+{
+    const char* p = blob.data();
+    const char* pend = p + blob.size();
+    unsigned int numLists, numFiles, numLabelSets, numUtts, numEntries;
+    BlobGet(p, pend, numLists);
+    infilesmulti.resize(numLists);
+    for (auto& filelist : infilesmulti)
+    {
+        BlobGet(p, pend, numFiles);
+        filelist.resize(numFiles);
+        for (auto& path : filelist)
+            BlobGet(p, pend, path);
+    }
+    BlobGet(p, pend, numLabelSets);
+    labelsmulti.resize(numLabelSets);
+    for (auto& labels : labelsmulti)
+    {
+        BlobGet(p, pend, numUtts);
+        std::wstring key;
+        for (unsigned int u = 0; u < numUtts; u++)
+        {
+            BlobGet(p, pend, key);
+            auto& entries = labels[key];
+            BlobGet(p, pend, numEntries);
+            entries.resize(numEntries);
+            for (auto& entry : entries)
+                BlobGet(p, pend, entry);
+        }
+    }
+    if (p != pend)
+        RuntimeError("BroadcastCorpusIndex: malformed corpus-index blob (trailing bytes)");
+}
+
+// broadcast the index from rank 0; on entry, only rank 0 has filled in the two containers
+static void BroadcastCorpusIndex(int mpiRank,
+                                 std::vector<std::vector<std::wstring>>& infilesmulti,
+                                 std::vector<std::map<std::wstring, std::vector<msra::asr::htkmlfentry>>>& labelsmulti)
+{
+    std::vector<char> blob;
+    unsigned long long blobSize = 0;
+    if (mpiRank == 0)
+    {
+        SerializeCorpusIndex(infilesmulti, labelsmulti, blob);
+        blobSize = blob.size();
+    }
+    MPI_Bcast(&blobSize, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+    blob.resize((size_t) blobSize);
+    for (unsigned long long pos = 0; pos < blobSize;) // in chunks, since MPI counts are ints
+    {
+        int chunk = (int) min((unsigned long long) INT_MAX, blobSize - pos);
+        MPI_Bcast(blob.data() + pos, chunk, MPI_CHAR, 0, MPI_COMM_WORLD);
+        pos += chunk;
+    }
+    if (mpiRank != 0)
+        DeserializeCorpusIndex(blob, infilesmulti, labelsmulti);
+}
+
 // Create a Data Reader
 //DATAREADER_API IDataReader* DataReaderFactory(void)
 
@@ -101,7 +229,7 @@ template <class ElemType>
 template <class ConfigRecordType>
 void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType& readerConfig)
 {
-    vector<wstring> scriptpaths;
+    vector<vector<wstring>> scriptpathsmulti; // [feature stream][mixing source]
     vector<wstring> RootPathInScripts;
     wstring RootPathInLatticeTocs;
     vector<wstring> mlfpaths;
@@ -168,7 +296,22 @@ void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType&
         }
 
         m_featureNameToIdMap[featureNames[i]] = iFeat;
-        scriptpaths.push_back(thisFeature(L"scpFile"));
+        if (thisFeature.ExistsCurrent(L"scpFileList")) // online data mixing: one script file per source corpus (mirrors mlfFileList)
+        {
+            vector<wstring> scps;
+            wstring list = thisFeature(L"scpFileList");
+            for (msra::files::textreader r(list); r;)
+            {
+                scps.push_back(r.wgetline());
+            }
+            if (scps.empty())
+                InvalidArgument("scpFileList %ls lists no script files", list.c_str());
+            scriptpathsmulti.push_back(std::move(scps));
+        }
+        else
+        {
+            scriptpathsmulti.push_back(vector<wstring>(1, (const wstring&) thisFeature(L"scpFile")));
+        }
         RootPathInScripts.push_back(thisFeature(L"prefixPathInSCP", L""));
         m_featureNameToDimMap[featureNames[i]] = m_featDims[i];
 
@@ -283,9 +426,17 @@ void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType&
     // only support one set now
     if (cdphonetyingpaths.size() > 0 && statelistpaths.size() > 0 && transPspaths.size() > 0)
         m_hset.loadfromfile(cdphonetyingpaths[0], statelistpaths[0], transPspaths[0]);
-    if (iFeat != scriptpaths.size() || iLabel != mlfpathsmulti.size())
+    if (iFeat != scriptpathsmulti.size() || iLabel != mlfpathsmulti.size())
         RuntimeError("# of inputs files vs. # of inputs or # of output files vs # of outputs inconsistent\n");
 
+    // number of mixing sources: all feature streams must list the same number of corpora
+    const size_t numSources = scriptpathsmulti.empty() ? 1 : scriptpathsmulti[0].size();
+    foreach_index (i, scriptpathsmulti)
+    {
+        if (scriptpathsmulti[i].size() != numSources)
+            RuntimeError("scpFileList: all features must list the same number of script files (%d vs. %d)", (int) numSources, (int) scriptpathsmulti[i].size());
+    }
+
     if (readerConfig.Exists(L"randomize"))
     {
         wstring randomizeString = readerConfig.CanBeString(L"randomize") ? readerConfig(L"randomize") : wstring();
@@ -310,13 +461,39 @@ void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType&
     if (readMethod == L"blockRandomize" && randomize == randomizeNone)
         InvalidArgument("'randomize' cannot be 'none' when 'readMethod' is 'blockRandomize'.");
 
+    // On multi-rank jobs, every rank parses the same script and MLF files at start-up,
+    // so a 32-rank job reads the same multi-gigabyte inputs 32 times. With this option,
+    // rank 0 parses them once and broadcasts the compiled index to the other ranks.
+    bool broadcastIndex = readerConfig(L"broadcastCorpusIndex", false);
+    int mpiRank = 0;
+    if (broadcastIndex)
+    {
+        int mpiInitialized = 0, mpiNumRanks = 1;
+        MPI_Initialized(&mpiInitialized);
+        if (mpiInitialized)
+        {
+            MPI_Comm_rank(MPI_COMM_WORLD, &mpiRank);
+            MPI_Comm_size(MPI_COMM_WORLD, &mpiNumRanks);
+        }
+        if (mpiNumRanks == 1) // not a parallel job: nothing to share
+            broadcastIndex = false;
+    }
+    // when sharing the index, only rank 0 runs the parsing code below; the other ranks
+    // get infilesmulti and labelsmulti through BroadcastCorpusIndex() further down
+    const bool thisRankParses = !broadcastIndex || mpiRank == 0;
+
     // read all input files (from multiple inputs)
+    // With multiple mixing sources, infilesmulti is flattened source-major: the file lists of
+    // source s occupy entries [s * iFeat, (s + 1) * iFeat). This keeps the broadcast below and
+    // the cache-key hashing agnostic of the mixing dimension.
     // TO DO: check for consistency (same number of files in each script file)
     numFiles = 0;
-    foreach_index (i, scriptpaths)
+    if (thisRankParses)
+    for (size_t source = 0; source < numSources; source++)
+    foreach_index (i, scriptpathsmulti)
     {
         vector<wstring> filelist;
-        std::wstring scriptpath = scriptpaths[i];
+        std::wstring scriptpath = scriptpathsmulti[i][source];
         fprintf(stderr, "reading script file %ls ...", scriptpath.c_str());
         size_t n = 0;
         for (msra::files::textreader reader(scriptpath); reader && filelist.size() <= firstfilesonly /*optimization*/;)
@@ -415,11 +592,16 @@ void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType&
 
     // currently assumes all mlfs will have same root name (key)
     set<wstring> restrictmlftokeys; // restrict MLF reader to these files--will make stuff much faster without having to use shortened input files
-    if (infilesmulti[0].size() <= 100)
+    size_t numFirstStreamFiles = 0; // utterances over all mixing sources (first feature stream carries one list per source)
+    if (thisRankParses)
+        for (size_t source = 0; source < numSources; source++)
+            numFirstStreamFiles += infilesmulti[source * iFeat].size();
+    if (thisRankParses && numFirstStreamFiles <= 100)
     {
-        foreach_index (i, infilesmulti[0])
+        for (size_t source = 0; source < numSources; source++)
+        foreach_index (i, infilesmulti[source * iFeat])
         {
-            msra::asr::htkfeatreader::parsedpath ppath(infilesmulti[0][i]);
+            msra::asr::htkfeatreader::parsedpath ppath(infilesmulti[source * iFeat][i]);
             const wstring key = regex_replace((wstring) ppath, wregex(L"\\.[^\\.\\\\/:]*$"), wstring()); // delete extension (or not if none)
             restrictmlftokeys.insert(key);
         }
@@ -433,6 +615,7 @@ void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType&
     // std::vector<msra::asr::htkmlfreader<msra::asr::htkmlfentry,msra::lattices::lattice::htkmlfwordsequence>> labelsmulti;
     std::vector<std::map<std::wstring, std::vector<msra::asr::htkmlfentry>>> labelsmulti;
     // std::vector<std::wstring> pagepath;
+    if (thisRankParses)
     foreach_index (i, mlfpathsmulti)
     {
         const msra::lm::CSymbolSet* wordmap = unigram ? &unigramsymbols : NULL;
@@ -447,6 +630,15 @@ void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType&
         labelsmulti.push_back(std::move(labels));
     }
 
+    if (broadcastIndex)
+    {
+        if (mpiRank == 0)
+            fprintf(stderr, "broadcasting corpus index to the other ranks ...");
+        BroadcastCorpusIndex(mpiRank, infilesmulti, labelsmulti);
+        if (mpiRank == 0)
+            fprintf(stderr, " done\n");
+    }
+
     if (!_wcsicmp(readMethod.c_str(), L"blockRandomize"))
     {
         // construct all the parameters we don't need, but need to be passed to the constructor...
@@ -454,15 +646,139 @@ void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType&
         m_lattices.reset(new msra::dbn::latticesource(latticetocs, m_hset.getsymmap(), RootPathInLatticeTocs));
         m_lattices->setverbosity(m_verbosity);
 
-        // now get the frame source. This has better randomization and doesn't create temp files
-        m_frameSource.reset(new msra::dbn::minibatchutterancesourcemulti(infilesmulti, labelsmulti, m_featDims, m_labelDims, numContextLeft, numContextRight, randomize, *m_lattices, m_latticeMap, m_frameMode));
+        if (numSources > 1 && !m_lattices->empty())
+            RuntimeError("online data mixing (scpFileList) is not supported together with lattices");
+
+        // chunk readahead: prefetch upcoming feature chunks on background threads into this much RAM (0 disables)
+        size_t chunkReadaheadMB = readerConfig(L"chunkReadaheadMB", (size_t) 0);
+        // chunk cache: let chunks the randomization window has moved past keep this much RAM, so that
+        // overlapping windows of later sweeps find them resident instead of re-reading them (0 disables)
+        size_t chunkCacheMB = readerConfig(L"chunkCacheMB", (size_t) 0);
+        // length bucketing: in utterance mode, group utterances of similar length within the randomization
+        // window so a minibatch's parallel sequences waste fewer frames on padding/gaps (0 disables)
+        double lengthBucketingTolerance = readerConfig(L"lengthBucketingTolerance", 0.0);
+
+        // now get the frame source(s). This has better randomization and doesn't create temp files
+        // One source per corpus; all of them share the label map, and each runs its own
+        // randomization and chunk readahead.
+        std::vector<std::unique_ptr<msra::dbn::minibatchsource>> frameSources;
+        for (size_t source = 0; source < numSources; source++)
+        {
+            std::vector<std::vector<wstring>> sourcefiles(infilesmulti.begin() + source * iFeat, infilesmulti.begin() + (source + 1) * iFeat);
+            auto frameSource = new msra::dbn::minibatchutterancesourcemulti(sourcefiles, labelsmulti, m_featDims, m_labelDims, numContextLeft, numContextRight, randomize, *m_lattices, m_latticeMap, m_frameMode);
+            if (chunkReadaheadMB > 0)
+                frameSource->setchunkreadahead(chunkReadaheadMB << 20, readerConfig(L"chunkReadaheadThreads", (size_t) 2));
+            if (chunkCacheMB > 0)
+                frameSource->setchunkcachebudget(chunkCacheMB << 20);
+            if (lengthBucketingTolerance > 0 && !m_frameMode)
+                frameSource->setlengthbucketing(lengthBucketingTolerance);
+            frameSources.push_back(std::unique_ptr<msra::dbn::minibatchsource>(frameSource));
+        }
+
+        if (numSources == 1)
+        {
+            m_frameSource = std::move(frameSources[0]);
+        }
+        else
+        {
+            // online data mixing: serve each minibatch from one corpus, sampled by the
+            // configured weights (default: proportional to corpus size, i.e. equivalent
+            // to concatenating the corpora but without a joint randomization sweep)
+            floatargvector sourceWeightConfig = readerConfig(L"sourceWeights", ConfigRecordType::Array(floatargvector(vector<float>{})));
+            if (sourceWeightConfig.size() != 0 && sourceWeightConfig.size() != numSources)
+                InvalidArgument("sourceWeights must specify one weight per script file in scpFileList (%d vs. %d)", (int) sourceWeightConfig.size(), (int) numSources);
+            std::vector<double> sourceWeights(numSources);
+            for (size_t source = 0; source < numSources; source++)
+                sourceWeights[source] = (sourceWeightConfig.size() != 0) ? (double) sourceWeightConfig[source] : (double) frameSources[source]->totalframes();
+            m_frameSource.reset(new msra::dbn::minibatchsourcemixer(std::move(frameSources), sourceWeights));
+        }
+
+        // on-the-fly feature augmentation: perturb the primary feature stream per utterance
+        // while reading, instead of pre-generating corrupted copies of the corpus offline
+        std::vector<std::unique_ptr<msra::dbn::featureaugmentation>> augmentations;
+        wstring augmentNoiseScpFile = readerConfig(L"augmentNoiseScpFile", L"");
+        if (!augmentNoiseScpFile.empty())
+        {
+            double augmentNoiseMinLevel = readerConfig(L"augmentNoiseMinLevel", 0.1);
+            double augmentNoiseMaxLevel = readerConfig(L"augmentNoiseMaxLevel", 0.5);
+            double augmentNoiseProbability = readerConfig(L"augmentNoiseProbability", 1.0);
+            augmentations.push_back(std::unique_ptr<msra::dbn::featureaugmentation>(
+                new msra::dbn::additivenoiseaugmentation(augmentNoiseScpFile, augmentNoiseMinLevel, augmentNoiseMaxLevel, augmentNoiseProbability)));
+        }
+        size_t augmentFreqMaskCount = readerConfig(L"augmentFreqMaskCount", (size_t) 0);
+        if (augmentFreqMaskCount > 0)
+            augmentations.push_back(std::unique_ptr<msra::dbn::featureaugmentation>(
+                new msra::dbn::frequencymaskaugmentation(augmentFreqMaskCount, readerConfig(L"augmentFreqMaskMaxWidth", (size_t) 8))));
+        size_t augmentTimeMaskCount = readerConfig(L"augmentTimeMaskCount", (size_t) 0);
+        if (augmentTimeMaskCount > 0)
+            augmentations.push_back(std::unique_ptr<msra::dbn::featureaugmentation>(
+                new msra::dbn::timemaskaugmentation(augmentTimeMaskCount, readerConfig(L"augmentTimeMaskMaxFrames", (size_t) 20))));
+        if (!augmentations.empty())
+            m_frameSource.reset(new msra::dbn::minibatchsourceaugmenter(std::move(m_frameSource), std::move(augmentations)));
+
         m_frameSource->setverbosity(m_verbosity);
     }
     else if (!_wcsicmp(readMethod.c_str(), L"rollingWindow"))
     {
+        if (numSources > 1)
+            RuntimeError("online data mixing (scpFileList) requires readMethod=blockRandomize");
         std::wstring pageFilePath;
         std::vector<std::wstring> pagePaths;
-        if (readerConfig.Exists(L"pageFilePath"))
+        bool persistentCache = false;
+        if (readerConfig.Exists(L"pageFileCacheDir"))
+        {
+            // persistent corpus cache: page files go to a fixed directory (typically a local SSD)
+            // under deterministic, corpus-keyed names, and are kept after the job ends. The first
+            // job pays the full read from the original storage; later epochs and later jobs on the
+            // same machine restore from the local copy.
+            std::wstring cacheDir = (const wstring&) readerConfig(L"pageFileCacheDir");
+#ifdef _WIN32
+            std::replace(cacheDir.begin(), cacheDir.end(), '/', '\\');
+            DWORD cacheAttrib = GetFileAttributes(cacheDir.c_str());
+            if (cacheAttrib == INVALID_FILE_ATTRIBUTES || !(cacheAttrib & FILE_ATTRIBUTE_DIRECTORY))
+                RuntimeError("pageFileCacheDir does not exist");
+#endif
+#ifdef __unix__
+            struct stat cacheStatbuf;
+            if (stat(wtocharpath(cacheDir).c_str(), &cacheStatbuf) == -1)
+                RuntimeError("pageFileCacheDir does not exist");
+#endif
+            // key the cache by what determines the page file content: the input file lists
+            // (including time ranges), the label files, and the dimensions/context settings.
+            // FNV-1a; collisions across distinct corpora on one machine are not a practical concern.
+            unsigned long long corpusHash = 14695981039346656037ULL;
+            auto hashin = [&corpusHash](const std::wstring& s)
+            {
+                for (auto c : s)
+                {
+                    corpusHash ^= (unsigned long long) c;
+                    corpusHash *= 1099511628211ULL;
+                }
+            };
+            foreach_index (i, infilesmulti)
+                foreach_index (j, infilesmulti[i])
+                    hashin(infilesmulti[i][j]);
+            foreach_index (i, mlfpathsmulti)
+                foreach_index (j, mlfpathsmulti[i])
+                    hashin(mlfpathsmulti[i][j]);
+            foreach_index (i, m_featDims)
+                hashin(std::to_wstring(m_featDims[i]) + L"/" + std::to_wstring(numContextLeft[i]) + L"/" + std::to_wstring(numContextRight[i]));
+            foreach_index (i, m_labelDims)
+                hashin(std::to_wstring(m_labelDims[i]));
+
+            wchar_t corpusKey[32];
+            swprintf(corpusKey, _countof(corpusKey), L"%016llx", corpusHash);
+            foreach_index (i, infilesmulti)
+            {
+#ifdef _WIN32
+                pagePaths.push_back(cacheDir + L"\\CNTK.corpus." + corpusKey + L"." + std::to_wstring(i) + L".pagefile");
+#else
+                pagePaths.push_back(cacheDir + L"/CNTK.corpus." + corpusKey + L"." + std::to_wstring(i) + L".pagefile");
+#endif
+            }
+            persistentCache = true;
+        }
+        else if (readerConfig.Exists(L"pageFilePath"))
         {
             pageFilePath = (const wstring&) readerConfig(L"pageFilePath");
 
@@ -494,34 +810,37 @@ void HTKMLFReader<ElemType>::PrepareForTrainingOrTesting(const ConfigRecordType&
 #endif
         }
 
+        if (!persistentCache) // (corpus-keyed cache names were already generated above)
+        {
 #ifdef _WIN32
-        if (pageFilePath.size() > MAX_PATH - 14) // max length of input to GetTempFileName is MAX_PATH-14
-            RuntimeError("pageFilePath must be less than %d characters", MAX_PATH - 14);
+            if (pageFilePath.size() > MAX_PATH - 14) // max length of input to GetTempFileName is MAX_PATH-14
+                RuntimeError("pageFilePath must be less than %d characters", MAX_PATH - 14);
 #else
-        if (pageFilePath.size() > PATH_MAX - 14) // max length of input to GetTempFileName is PATH_MAX-14
-            RuntimeError("pageFilePath must be less than %d characters", PATH_MAX - 14);
+            if (pageFilePath.size() > PATH_MAX - 14) // max length of input to GetTempFileName is PATH_MAX-14
+                RuntimeError("pageFilePath must be less than %d characters", PATH_MAX - 14);
 #endif
-        foreach_index (i, infilesmulti)
-        {
+            foreach_index (i, infilesmulti)
+            {
 #ifdef _WIN32
-            wchar_t tempFile[MAX_PATH];
-            GetTempFileName(pageFilePath.c_str(), L"CNTK", 0, tempFile);
-            pagePaths.push_back(tempFile);
+                wchar_t tempFile[MAX_PATH];
+                GetTempFileName(pageFilePath.c_str(), L"CNTK", 0, tempFile);
+                pagePaths.push_back(tempFile);
 #endif
 #ifdef __unix__
-            char tempFile[PATH_MAX];
-            strcpy(tempFile, msra::strfun::utf8(pageFilePath).c_str());
-            int fid = mkstemp(tempFile);
-            unlink(tempFile);
-            close(fid);
-            pagePaths.push_back(GetWC(tempFile));
+                char tempFile[PATH_MAX];
+                strcpy(tempFile, msra::strfun::utf8(pageFilePath).c_str());
+                int fid = mkstemp(tempFile);
+                unlink(tempFile);
+                close(fid);
+                pagePaths.push_back(GetWC(tempFile));
 #endif
+            }
         }
 
         const bool mayhavenoframe = false;
         int addEnergy = 0;
 
-        m_frameSource.reset(new msra::dbn::minibatchframesourcemulti(infilesmulti, labelsmulti, m_featDims, m_labelDims, numContextLeft, numContextRight, randomize, pagePaths, mayhavenoframe, addEnergy));
+        m_frameSource.reset(new msra::dbn::minibatchframesourcemulti(infilesmulti, labelsmulti, m_featDims, m_labelDims, numContextLeft, numContextRight, randomize, pagePaths, mayhavenoframe, addEnergy, persistentCache));
         m_frameSource->setverbosity(m_verbosity);
     }
     else
@@ -629,6 +948,29 @@ void HTKMLFReader<ElemType>::PrepareForWriting(const ConfigRecordType& readerCon
         m_inputFilesMultiIO.push_back(std::move(filelist));
     }
 
+    // with nbruttsineachrecurrentiter > 1, write mode batches several utterances per minibatch
+    // in length-sorted order, so similar-length utterances share a minibatch and few computed
+    // frames are wasted on padding. The frame counts come from the a=b[s,e] ranges of the
+    // script, and GetWriteRecordInfo() lets the caller route each output back to its original
+    // record (pair with indexedWrite=true in the HTKMLFWriter config).
+    if (m_numSeqsPerMB > 1)
+    {
+        m_writeFrameCounts.resize(numFiles);
+        m_writeOrder.resize(numFiles);
+        for (size_t i = 0; i < numFiles; i++)
+        {
+            msra::asr::htkfeatreader::parsedpath ppath(m_inputFilesMultiIO[0][i]);
+            m_writeFrameCounts[i] = ppath.numframes(); // errors out if the script has no frame ranges
+            m_writeOrder[i] = i;
+        }
+        std::stable_sort(m_writeOrder.begin(), m_writeOrder.end(),
+                         [this](size_t a, size_t b)
+                         {
+                             return m_writeFrameCounts[a] < m_writeFrameCounts[b];
+                         });
+        fprintf(stderr, "HTKMLFReader: writing %d utterances in length-sorted order, %d per minibatch\n", (int) numFiles, (int) m_numSeqsPerMB);
+    }
+
     m_fileEvalSource.reset(new msra::dbn::FileEvalSource(realDims, numContextLeft, numContextRight, evalchunksize));
 }
 
@@ -1136,22 +1478,10 @@ bool HTKMLFReader<ElemType>::GetMinibatchToTrainOrTest(std::map<std::wstring, Ma
                                 m_featuresBufferAllocatedMultiIO[id] = dim * m_mbNumTimeSteps * m_numSeqsPerMB;
                             }
 
-                            if (sizeof(ElemType) == sizeof(float))
-                            {
-                                for (size_t j = startFr, k = 0; j < endFr; j++, k++) // column major, so iterate columns
-                                {
-                                    // copy over the entire column at once, need to do this because SSEMatrix may have gaps at the end of the columns
-                                    memcpy_s(&m_featuresBufferMultiIO[id].get()[(k * m_numSeqsPerMB + i) * dim], sizeof(ElemType) * dim, &m_featuresBufferMultiUtt[i].get()[j * dim + m_featuresStartIndexMultiUtt[id + i * numOfFea]], sizeof(ElemType) * dim);
-                                }
-                            }
-                            else // double: must type-cast, cannot memcpy()
-                            {
-                                for (size_t j = startFr, k = 0; j < endFr; j++, k++) // column major, so iterate columns in outside loop
-                                {
-                                    for (int d = 0; d < dim; d++)
-                                        m_featuresBufferMultiIO[id].get()[(k * m_numSeqsPerMB + i) * dim + d] = m_featuresBufferMultiUtt[i].get()[j * dim + d + m_featuresStartIndexMultiUtt[id + i * numOfFea]];
-                                }
-                            }
+                            // both buffers hold ElemType, so this is a straight parallel column copy
+                            copyFramesToMinibatchBuffer(m_featuresBufferMultiIO[id].get(), 0 /*dstT0*/,
+                                                        &m_featuresBufferMultiUtt[i].get()[m_featuresStartIndexMultiUtt[id + i * numOfFea]], startFr,
+                                                        dim, endFr - startFr, i);
                         }
                         else if (m_nameToTypeMap[iter->first] == InputOutputTypes::category)
                         {
@@ -1164,11 +1494,9 @@ bool HTKMLFReader<ElemType>::GetMinibatchToTrainOrTest(std::map<std::wstring, Ma
                                 m_labelsBufferAllocatedMultiIO[id] = dim * m_mbNumTimeSteps * m_numSeqsPerMB;
                             }
 
-                            for (size_t j = startFr, k = 0; j < endFr; j++, k++)
-                            {
-                                for (int d = 0; d < dim; d++)
-                                    m_labelsBufferMultiIO[id].get()[(k * m_numSeqsPerMB + i) * dim + d] = m_labelsBufferMultiUtt[i].get()[j * dim + d + m_labelsStartIndexMultiUtt[id + i * numOfLabel]];
-                            }
+                            copyFramesToMinibatchBuffer(m_labelsBufferMultiIO[id].get(), 0 /*dstT0*/,
+                                                        &m_labelsBufferMultiUtt[i].get()[m_labelsStartIndexMultiUtt[id + i * numOfLabel]], startFr,
+                                                        dim, endFr - startFr, i);
                         }
                     }
                     m_processedFrame[i] += m_mbNumTimeSteps;
@@ -1200,24 +1528,9 @@ bool HTKMLFReader<ElemType>::GetMinibatchToTrainOrTest(std::map<std::wstring, Ma
                                 m_featuresBufferAllocatedMultiIO[id] = dim * m_mbNumTimeSteps * m_numSeqsPerMB;
                             }
 
-                            if (sizeof(ElemType) == sizeof(float))
-                            {
-                                for (size_t j = startFr, k = 0; j < endFr; j++, k++) // column major, so iterate columns
-                                {
-                                    // copy over the entire column at once, need to do this because SSEMatrix may have gaps at the end of the columns
-                                    memcpy_s(&m_featuresBufferMultiIO[id].get()[(k * m_numSeqsPerMB + i) * dim], sizeof(ElemType) * dim, &m_featuresBufferMultiUtt[i].get()[j * dim + m_featuresStartIndexMultiUtt[id + i * numOfFea]], sizeof(ElemType) * dim);
-                                }
-                            }
-                            else
-                            {
-                                for (size_t j = startFr, k = 0; j < endFr; j++, k++) // column major, so iterate columns in outside loop
-                                {
-                                    for (int d = 0; d < dim; d++)
-                                    {
-                                        m_featuresBufferMultiIO[id].get()[(k * m_numSeqsPerMB + i) * dim + d] = m_featuresBufferMultiUtt[i].get()[j * dim + d + m_featuresStartIndexMultiUtt[id + i * numOfFea]];
-                                    }
-                                }
-                            }
+                            copyFramesToMinibatchBuffer(m_featuresBufferMultiIO[id].get(), 0 /*dstT0*/,
+                                                        &m_featuresBufferMultiUtt[i].get()[m_featuresStartIndexMultiUtt[id + i * numOfFea]], startFr,
+                                                        dim, endFr - startFr, i);
                         }
                         else if (m_nameToTypeMap[iter->first] == InputOutputTypes::category)
                         {
@@ -1229,11 +1542,9 @@ bool HTKMLFReader<ElemType>::GetMinibatchToTrainOrTest(std::map<std::wstring, Ma
                                 m_labelsBufferMultiIO[id] = AllocateIntermediateBuffer(data.GetDeviceId(), dim * m_mbNumTimeSteps * m_numSeqsPerMB);
                                 m_labelsBufferAllocatedMultiIO[id] = dim * m_mbNumTimeSteps * m_numSeqsPerMB;
                             }
-                            for (size_t j = startFr, k = 0; j < endFr; j++, k++)
-                            {
-                                for (int d = 0; d < dim; d++)
-                                    m_labelsBufferMultiIO[id].get()[(k * m_numSeqsPerMB + i) * dim + d] = m_labelsBufferMultiUtt[i].get()[j * dim + d + m_labelsStartIndexMultiUtt[id + i * numOfLabel]];
-                            }
+                            copyFramesToMinibatchBuffer(m_labelsBufferMultiIO[id].get(), 0 /*dstT0*/,
+                                                        &m_labelsBufferMultiUtt[i].get()[m_labelsStartIndexMultiUtt[id + i * numOfLabel]], startFr,
+                                                        dim, endFr - startFr, i);
                         }
                     }
                     m_processedFrame[i] += (endFr - startFr);               // advance the cursor
@@ -1268,32 +1579,17 @@ bool HTKMLFReader<ElemType>::GetMinibatchToTrainOrTest(std::map<std::wstring, Ma
                                 {
                                     id = m_featureNameToIdMap[iter->first];
                                     dim = m_featureNameToDimMap[iter->first];
-                                    if (sizeof(ElemType) == sizeof(float))
-                                    {
-                                        for (size_t t = startT, fr = 0; t < endT; t++, fr++) // column major, so iterate columns
-                                        {
-                                            // copy over the entire column at once, need to do this because SSEMatrix may have gaps at the end of the columns (for SSE alignment)
-                                            memcpy_s(&m_featuresBufferMultiIO[id].get()[(t * m_numSeqsPerMB + i) * dim], sizeof(ElemType) * dim, &m_featuresBufferMultiUtt[i].get()[fr * dim + m_featuresStartIndexMultiUtt[id + i * numOfFea]], sizeof(ElemType) * dim);
-                                        }
-                                    }
-                                    else
-                                    {
-                                        for (size_t t = startT, fr = 0; t < endT; t++, fr++) // column major, so iterate columns in outside loop
-                                        {
-                                            for (int d = 0; d < dim; d++)
-                                                m_featuresBufferMultiIO[id].get()[(t * m_numSeqsPerMB + i) * dim + d] = m_featuresBufferMultiUtt[i].get()[fr * dim + d + m_featuresStartIndexMultiUtt[id + i * numOfFea]];
-                                        }
-                                    }
+                                    copyFramesToMinibatchBuffer(m_featuresBufferMultiIO[id].get(), startT,
+                                                                &m_featuresBufferMultiUtt[i].get()[m_featuresStartIndexMultiUtt[id + i * numOfFea]], 0 /*srcT0*/,
+                                                                dim, endT - startT, i);
                                 }
                                 else if (m_nameToTypeMap[iter->first] == InputOutputTypes::category)
                                 {
                                     id = m_labelNameToIdMap[iter->first];
                                     dim = m_labelNameToDimMap[iter->first];
-                                    for (size_t t = startT, fr = 0; t < endT; t++, fr++)
-                                    {
-                                        for (int d = 0; d < dim; d++)
-                                            m_labelsBufferMultiIO[id].get()[(t * m_numSeqsPerMB + i) * dim + d] = m_labelsBufferMultiUtt[i].get()[fr * dim + d + m_labelsStartIndexMultiUtt[id + i * numOfLabel]];
-                                    }
+                                    copyFramesToMinibatchBuffer(m_labelsBufferMultiIO[id].get(), startT,
+                                                                &m_labelsBufferMultiUtt[i].get()[m_labelsStartIndexMultiUtt[id + i * numOfLabel]], 0 /*srcT0*/,
+                                                                dim, endT - startT, i);
                                 }
                             }
 
@@ -1351,6 +1647,21 @@ bool HTKMLFReader<ElemType>::GetMinibatchToTrainOrTest(std::map<std::wstring, Ma
     return true;
 }
 
+// copy a span of utterance columns into the interleaved minibatch buffer
+// dst column (dstT0 + k) of the given parallel sequence receives src column (srcT0 + k).
+// Frame assembly is pure memory movement, so the columns are distributed over worker threads.
+template <class ElemType>
+void HTKMLFReader<ElemType>::copyFramesToMinibatchBuffer(ElemType* dst, size_t dstT0, const ElemType* src, size_t srcT0, size_t dim, size_t framenum, size_t channelIndex)
+{
+#pragma omp parallel for
+    for (long k = 0; k < (long) framenum; k++)
+    {
+        // copy over the entire column at once, need to do this because SSEMatrix may have gaps at the end of the columns
+        memcpy_s(&dst[((dstT0 + k) * m_numSeqsPerMB + channelIndex) * dim], sizeof(ElemType) * dim,
+                 &src[(srcT0 + k) * dim], sizeof(ElemType) * dim);
+    }
+}
+
 // copy an utterance into the minibatch given a location (parallel-sequence index, start frame)
 // TODO: This should use DataFor(). But for that, DataFor() will have to move out from ComputationNode. Ah, it has!
 template <class ElemType>
@@ -1381,24 +1692,9 @@ void HTKMLFReader<ElemType>::fillOneUttDataforParallelmode(std::map<std::wstring
                 m_featuresBufferAllocatedMultiIO[id] = dim * m_mbNumTimeSteps * m_numSeqsPerMB;
             }
 
-            if (sizeof(ElemType) == sizeof(float))
-            {
-                for (size_t j = 0, k = startFr; j < framenum; j++, k++) // column major, so iterate columns
-                {
-                    // copy over the entire column at once, need to do this because SSEMatrix may have gaps at the end of the columns
-                    memcpy_s(&m_featuresBufferMultiIO[id].get()[(k * m_numSeqsPerMB + channelIndex) * dim], sizeof(ElemType) * dim, &m_featuresBufferMultiUtt[sourceChannelIndex].get()[j * dim + m_featuresStartIndexMultiUtt[id + sourceChannelIndex * numOfFea]], sizeof(ElemType) * dim);
-                }
-            }
-            else
-            {
-                for (size_t j = 0, k = startFr; j < framenum; j++, k++) // column major, so iterate columns in outside loop
-                {
-                    for (int d = 0; d < dim; d++)
-                    {
-                        m_featuresBufferMultiIO[id].get()[(k * m_numSeqsPerMB + channelIndex) * dim + d] = m_featuresBufferMultiUtt[sourceChannelIndex].get()[j * dim + d + m_featuresStartIndexMultiUtt[id + sourceChannelIndex * numOfFea]];
-                    }
-                }
-            }
+            copyFramesToMinibatchBuffer(m_featuresBufferMultiIO[id].get(), startFr,
+                                        &m_featuresBufferMultiUtt[sourceChannelIndex].get()[m_featuresStartIndexMultiUtt[id + sourceChannelIndex * numOfFea]], 0 /*srcT0*/,
+                                        dim, framenum, channelIndex);
         }
         else if (m_nameToTypeMap[iter->first] == InputOutputTypes::category)
         {
@@ -1411,13 +1707,9 @@ void HTKMLFReader<ElemType>::fillOneUttDataforParallelmode(std::map<std::wstring
                 m_labelsBufferAllocatedMultiIO[id] = dim * m_mbNumTimeSteps * m_numSeqsPerMB;
             }
 
-            for (size_t j = 0, k = startFr; j < framenum; j++, k++)
-            {
-                for (int d = 0; d < dim; d++)
-                {
-                    m_labelsBufferMultiIO[id].get()[(k * m_numSeqsPerMB + channelIndex) * dim + d] = m_labelsBufferMultiUtt[sourceChannelIndex].get()[j * dim + d + m_labelsStartIndexMultiUtt[id + sourceChannelIndex * numOfLabel]];
-                }
-            }
+            copyFramesToMinibatchBuffer(m_labelsBufferMultiIO[id].get(), startFr,
+                                        &m_labelsBufferMultiUtt[sourceChannelIndex].get()[m_labelsStartIndexMultiUtt[id + sourceChannelIndex * numOfLabel]], 0 /*srcT0*/,
+                                        dim, framenum, channelIndex);
         }
     }
 }
@@ -1446,6 +1738,9 @@ bool HTKMLFReader<ElemType>::GetMinibatchToWrite(std::map<std::wstring, Matrix<E
         m_checkDictionaryKeys = false;
     }
 
+    if (m_numSeqsPerMB > 1)
+        return GetMinibatchToWriteBatched(matrices);
+
     if (m_inputFileIndex < m_inputFilesMultiIO[0].size())
     {
         m_fileEvalSource->Reset();
@@ -1511,6 +1806,7 @@ bool HTKMLFReader<ElemType>::GetMinibatchToWrite(std::map<std::wstring, Matrix<E
 
                 if (sizeof(ElemType) == sizeof(float))
                 {
+#pragma omp parallel for
                     for (int j = 0; j < feat.cols(); j++) // column major, so iterate columns
                     {
                         // copy over the entire column at once, need to do this because SSEMatrix may have gaps at the end of the columns
@@ -1519,6 +1815,7 @@ bool HTKMLFReader<ElemType>::GetMinibatchToWrite(std::map<std::wstring, Matrix<E
                 }
                 else
                 {
+#pragma omp parallel for
                     for (int j = 0; j < feat.cols(); j++) // column major, so iterate columns in outside loop
                     {
                         for (int i = 0; i < feat.rows(); i++)
@@ -1538,6 +1835,122 @@ bool HTKMLFReader<ElemType>::GetMinibatchToWrite(std::map<std::wstring, Matrix<E
     }
 }
 
+// GetMinibatchToWriteBatched - write-mode minibatch with several length-sorted utterances
+// packed as parallel sequences (nbruttsineachrecurrentiter > 1). Shorter utterances are
+// padded with zeroed gap columns up to the longest one of the batch; the caller recovers the
+// per-utterance columns and the original record order through GetWriteRecordInfo().
+template <class ElemType>
+bool HTKMLFReader<ElemType>::GetMinibatchToWriteBatched(std::map<std::wstring, Matrix<ElemType>*>& matrices)
+{
+    size_t numRecords = m_inputFilesMultiIO[0].size();
+    if (m_inputFileIndex >= numRecords)
+        return false;
+
+    size_t numSeqs = min(m_numSeqsPerMB, numRecords - m_inputFileIndex);
+
+    // the frame counts are known from the script, so the buffers can be sized before reading
+    size_t maxFrames = 0;
+    for (size_t u = 0; u < numSeqs; u++)
+        maxFrames = max(maxFrames, m_writeFrameCounts[m_writeOrder[m_inputFileIndex + u]]);
+
+    // allocate (or grow) one staging buffer per feature stream; zeroed so gap columns stay zero
+    for (auto iter = matrices.begin(); iter != matrices.end(); iter++)
+    {
+        if (m_nameToTypeMap.find(iter->first) == m_nameToTypeMap.end() || m_nameToTypeMap[iter->first] != InputOutputTypes::real)
+            continue;
+        size_t id = m_featureNameToIdMap[iter->first];
+        size_t dim = m_featureNameToDimMap[iter->first];
+        if ((m_featuresBufferMultiIO[id] == nullptr) || (m_featuresBufferAllocatedMultiIO[id] < dim * numSeqs * maxFrames))
+        {
+            m_featuresBufferMultiIO[id] = AllocateIntermediateBuffer(iter->second->GetDeviceId(), dim * numSeqs * maxFrames);
+            m_featuresBufferAllocatedMultiIO[id] = dim * numSeqs * maxFrames;
+        }
+        memset(m_featuresBufferMultiIO[id].get(), 0, sizeof(ElemType) * dim * numSeqs * maxFrames);
+    }
+
+    m_pMBLayout->Init(numSeqs, maxFrames);
+    m_writeBatchRecordInfo.clear();
+
+    for (size_t u = 0; u < numSeqs; u++)
+    {
+        size_t record = m_writeOrder[m_inputFileIndex + u];
+
+        // load the next file (or set of files), as in the single-utterance path above
+        m_fileEvalSource->Reset();
+        foreach_index (i, m_inputFilesMultiIO)
+        {
+            msra::asr::htkfeatreader reader;
+
+            const auto path = reader.parse(m_inputFilesMultiIO[i][record]);
+            msra::dbn::matrix feat;
+            string featkind;
+            unsigned int sampperiod;
+            msra::util::attempt(5, [&]()
+                                {
+                                    reader.read(path, featkind, sampperiod, feat);
+                                });
+            fprintf(stderr, "evaluate: reading %d frames of %ls\n", (int) feat.cols(), ((wstring) path).c_str());
+            m_fileEvalSource->AddFile(feat, featkind, sampperiod, i);
+        }
+        m_fileEvalSource->CreateEvalMinibatch();
+
+        size_t numFrames = 0;
+        foreach_index (i, m_inputFilesMultiIO)
+        {
+            const msra::dbn::matrix feat = m_fileEvalSource->ChunkOfFrames(i);
+            numFrames = feat.cols();
+            if (numFrames > maxFrames)
+                RuntimeError("GetMinibatchToWriteBatched: file has more frames than its script entry declares");
+
+            // scatter the utterance's frames into its parallel-sequence slots (column t * numSeqs + u)
+            for (int j = 0; j < feat.cols(); j++)
+            {
+                ElemType* column = &m_featuresBufferMultiIO[i].get()[((size_t) j * numSeqs + u) * feat.rows()];
+                if (sizeof(ElemType) == sizeof(float))
+                {
+                    // copy over the entire column at once, need to do this because SSEMatrix may have gaps at the end of the columns
+                    memcpy_s(column, sizeof(ElemType) * feat.rows(), &feat(0, j), sizeof(ElemType) * feat.rows());
+                }
+                else
+                {
+                    for (int k = 0; k < feat.rows(); k++)
+                        column[k] = feat(k, j);
+                }
+            }
+        }
+
+        m_pMBLayout->AddSequence(NEW_SEQUENCE_ID, u, 0, numFrames);
+        if (numFrames < maxFrames)
+            m_pMBLayout->AddGap(u, numFrames, maxFrames);
+        m_writeBatchRecordInfo.push_back(std::make_pair(record, numFrames));
+    }
+    m_inputFileIndex += numSeqs;
+
+    // populate the input matrices
+    for (auto iter = matrices.begin(); iter != matrices.end(); iter++)
+    {
+        if (m_nameToTypeMap.find(iter->first) == m_nameToTypeMap.end() || m_nameToTypeMap[iter->first] != InputOutputTypes::real)
+            continue;
+        Matrix<ElemType>& data = *matrices[iter->first];
+        size_t id = m_featureNameToIdMap[iter->first];
+        size_t dim = m_featureNameToDimMap[iter->first];
+        data.SetValue(dim, numSeqs * maxFrames, data.GetDeviceId(), m_featuresBufferMultiIO[id].get(), matrixFlagNormal);
+    }
+    return true;
+}
+
+// GetWriteRecordInfo - identify the utterances packed into the current write-mode minibatch:
+// for each parallel sequence, the index of its record in the input script and its number of
+// frames. Only provided when sorted batched writing reorders the script.
+template <class ElemType>
+bool HTKMLFReader<ElemType>::GetWriteRecordInfo(std::vector<std::pair<size_t, size_t>>& recordInfo)
+{
+    if (m_trainOrTest || m_numSeqsPerMB <= 1)
+        return false;
+    recordInfo = m_writeBatchRecordInfo;
+    return true;
+}
+
 template <class ElemType>
 bool HTKMLFReader<ElemType>::ReNewBufferForMultiIO(size_t i)
 {
@@ -1608,6 +2021,7 @@ bool HTKMLFReader<ElemType>::ReNewBufferForMultiIO(size_t i)
 
         if (sizeof(ElemType) == sizeof(float))
         {
+#pragma omp parallel for
             for (int k = 0; k < actualmbsizeOri; k++) // column major, so iterate columns
             {
                 // copy over the entire column at once, need to do this because SSEMatrix may have gaps at the end of the columns
@@ -1616,6 +2030,7 @@ bool HTKMLFReader<ElemType>::ReNewBufferForMultiIO(size_t i)
         }
         else
         {
+#pragma omp parallel for
             for (int k = 0; k < actualmbsizeOri; k++) // column major, so iterate columns in outside loop
             {
                 for (int d = 0; d < featOri.rows(); d++)
@@ -85,6 +85,11 @@ private:
     std::vector<std::vector<std::wstring>> m_inputFilesMultiIO;
 
     size_t m_inputFileIndex;
+    // sorted batched writing (write mode with nbruttsineachrecurrentiter > 1): utterances are
+    // evaluated several per minibatch in length-sorted order to minimize padded frames
+    std::vector<size_t> m_writeOrder;                              // input-script indices in length-sorted processing order
+    std::vector<size_t> m_writeFrameCounts;                        // number of frames of each input-script entry
+    std::vector<std::pair<size_t, size_t>> m_writeBatchRecordInfo; // (script index, frames) per parallel sequence of the current minibatch
     std::vector<size_t> m_featDims;
     std::vector<size_t> m_labelDims;
 
@@ -100,7 +105,9 @@ private:
     bool GetMinibatchToTrainOrTest(std::map<std::wstring, Matrix<ElemType>*>& matrices);
     bool GetMinibatch4SEToTrainOrTest(std::vector<shared_ptr<const msra::dbn::latticepair>>& latticeinput, vector<size_t>& uids, vector<size_t>& boundaries, std::vector<size_t>& extrauttmap);
     void fillOneUttDataforParallelmode(std::map<std::wstring, Matrix<ElemType>*>& matrices, size_t startFr, size_t framenum, size_t channelIndex, size_t sourceChannelIndex);
+    void copyFramesToMinibatchBuffer(ElemType* dst, size_t dstT0, const ElemType* src, size_t srcT0, size_t dim, size_t framenum, size_t channelIndex);
     bool GetMinibatchToWrite(std::map<std::wstring, Matrix<ElemType>*>& matrices);
+    bool GetMinibatchToWriteBatched(std::map<std::wstring, Matrix<ElemType>*>& matrices);
 
     void StartMinibatchLoopToTrainOrTest(size_t mbSize, size_t epoch, size_t subsetNum, size_t numSubsets, size_t requestedEpochSamples = requestDataSize);
     void StartMinibatchLoopToWrite(size_t mbSize, size_t epoch, size_t requestedEpochSamples = requestDataSize);
@@ -179,6 +186,7 @@ public:
     virtual bool GetData(const std::wstring& sectionName, size_t numRecords, void* data, size_t& dataBufferSize, size_t recordStart = 0);
     virtual bool GetMinibatch4SE(std::vector<shared_ptr<const msra::dbn::latticepair>>& latticeinput, vector<size_t>& uids, vector<size_t>& boundaries, vector<size_t>& extrauttmap);
     virtual bool GetHmmData(msra::asr::simplesenonehmm* hmm);
+    virtual bool GetWriteRecordInfo(std::vector<std::pair<size_t, size_t>>& recordInfo) override;
 
     virtual bool DataEnd(EndDataType endDataType);
     void CopyMBLayoutTo(MBLayoutPtr);
@@ -95,6 +95,11 @@ void HTKMLFWriter<ElemType>::InitFromConfig(const ConfigRecordType& writerConfig
     }
     outputFileIndex = 0;
     sampPeriod = 100000;
+
+    // with indexedWrite, SaveData() writes to the output file indexed by its recordStart
+    // argument instead of walking the script sequentially; needed when the reader hands out
+    // records out of script order (e.g. length-sorted batched writing in HTKMLFReader)
+    m_indexedWrite = writerConfig(L"indexedWrite", false);
 }
 
 template <class ElemType>
@@ -111,11 +116,12 @@ void HTKMLFWriter<ElemType>::GetSections(std::map<std::wstring, SectionType, noc
 }
 
 template <class ElemType>
-bool HTKMLFWriter<ElemType>::SaveData(size_t /*recordStart*/, const std::map<std::wstring, void*, nocase_compare>& matrices, size_t /*numRecords*/, size_t /*datasetSize*/, size_t /*byteVariableSized*/)
+bool HTKMLFWriter<ElemType>::SaveData(size_t recordStart, const std::map<std::wstring, void*, nocase_compare>& matrices, size_t /*numRecords*/, size_t /*datasetSize*/, size_t /*byteVariableSized*/)
 {
 
     // std::map<std::wstring, void*, nocase_compare>::iterator iter;
-    if (outputFileIndex >= outputFiles[0].size())
+    size_t fileIndex = m_indexedWrite ? recordStart : outputFileIndex;
+    if (fileIndex >= outputFiles[0].size())
         RuntimeError("index for output scp file out of range...");
 
     for (auto iter = matrices.begin(); iter != matrices.end(); iter++)
@@ -124,7 +130,7 @@ bool HTKMLFWriter<ElemType>::SaveData(size_t /*recordStart*/, const std::map<std
         Matrix<ElemType>& outputData = *(static_cast<Matrix<ElemType>*>(iter->second));
         size_t id = outputNameToIdMap[outputName];
         size_t dim = outputNameToDimMap[outputName];
-        wstring outFile = outputFiles[id][outputFileIndex];
+        wstring outFile = outputFiles[id][fileIndex];
 
         assert(outputData.GetNumRows() == dim);
         dim;
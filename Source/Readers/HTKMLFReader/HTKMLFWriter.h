@@ -25,6 +25,7 @@ private:
     std::map<std::wstring, size_t> outputNameToTypeMap;
     unsigned int sampPeriod;
     size_t outputFileIndex;
+    bool m_indexedWrite; // pick the output file by the recordStart passed to SaveData() instead of sequentially (for callers that write records out of script order)
     void Save(std::wstring& outputFile, Matrix<ElemType>& outputData);
     ElemType* m_tempArray;
     size_t m_tempArraySize;
@@ -336,6 +336,7 @@ class htkfeatreader : protected htkfeatio
     size_t curframe;                     // current # samples read so far
     size_t numframes;                    // number of samples for current logical file
     size_t energyElements;               // how many energy elements to add if addEnergy is true
+    bool streamingmode;                  // one-shot sequential pass: open files cache-bypassing (see fopenStreamOrDie())
 
 public:
     // parser for complex a=b[s,e] syntax
@@ -439,7 +440,8 @@ private:
     {
         wstring physpath = ppath.physicallocation();
         // auto_file_ptr f = fopenOrDie (physpath, L"rbS");
-        auto_file_ptr f(fopenOrDie(physpath, L"rb")); // removed 'S' for now, as we mostly run local anyway, and this will speed up debugging
+        auto_file_ptr f(streamingmode ? fopenStreamOrDie(physpath)
+                                      : fopenOrDie(physpath, L"rb")); // removed 'S' for now, as we mostly run local anyway, and this will speed up debugging
 
         // read the header (12 bytes for htk feature files)
         fileheader H;
@@ -552,6 +554,15 @@ public:
     {
         addEnergy = false;
         energyElements = 0;
+        streamingmode = false;
+    }
+
+    // enable for a one-shot sequential pass over the corpus (e.g. paging into the rolling window):
+    // files are then read through a cache-bypassing read-ahead stream where the platform supports
+    // it, so that streaming TBs of archives once does not evict the cache that re-reads depend on
+    void setstreamingmode(bool to)
+    {
+        streamingmode = to;
     }
 
     // helper to create a parsed-path object
@@ -828,6 +839,105 @@ class htkmlfreader : public map<wstring, vector<ENTRY>> // [key][i] the data
         RuntimeError("htkmlfreader: %s in '%ls'", what.c_str(), curpath.c_str());
     }
 
+    // ------------------------------------------------------------------------
+    // compiled MLF: a binary sidecar file next to the source MLF holding the
+    // fully parsed entries, so that subsequent job starts skip the tokenization
+    // of the (often multi-GB) text MLF entirely. The cache is loaded when it is
+    // newer than both the MLF and the state list, and recompiled (best-effort)
+    // after a text parse otherwise. Not used when also reading word sequences
+    // (MMI) or when restricted to a key subset, since those paths carry more
+    // state than the plain entries stored here.
+    // ------------------------------------------------------------------------
+
+    wstring statelistpath; // remembered for the cache freshness check
+
+    static wstring compiledpath(const wstring& path)
+    {
+        return path + L".cmlf";
+    }
+
+    // try to load the compiled form of 'path'; return false to fall back to text parsing
+    bool readcompiled(const wstring& path)
+    {
+        const wstring cpath = compiledpath(path);
+        if (!msra::files::fuptodate(cpath, path) || (!statelistpath.empty() && !msra::files::fuptodate(cpath, statelistpath)))
+            return false;
+        map<wstring, vector<ENTRY>> entryset; // read into here first, so a malformed cache leaves 'this' untouched
+        try
+        {
+            auto_file_ptr f(fopenOrDie(cpath, L"rb"));
+            fcompareTag(fgetTag(f), "CMLF");
+            int version = fgetint(f);
+            if (version != 1)
+                RuntimeError("readcompiled: unsupported version %d", version);
+            if (fgetint(f) != (int) sizeof(ENTRY)) // e.g. CLASSIDTYPE size changed between builds
+                RuntimeError("readcompiled: entry size differs from this build");
+            unsigned long long numutts;
+            fget(f, numutts);
+            for (unsigned long long k = 0; k < numutts; k++)
+            {
+                vector<ENTRY>& entries = entryset[fgetwstring(f)];
+                if (!entries.empty())
+                    RuntimeError("readcompiled: duplicate utterance key");
+                entries.resize((size_t) fgetint(f));
+                if (!entries.empty())
+                    freadOrDie(&entries[0], sizeof(ENTRY), entries.size(), f);
+            }
+            fcompareTag(fgetTag(f), "EMLF");
+        }
+        catch (const exception& e)
+        {
+            fprintf(stderr, "htkmlfreader: discarding compiled MLF %ls (%s)\n", cpath.c_str(), e.what());
+            return false;
+        }
+        fprintf(stderr, "htkmlfreader: reading compiled MLF file %ls ...", cpath.c_str());
+        for (auto& iter : entryset)
+        {
+            vector<ENTRY>& entries = (*this)[iter.first];
+            if (!entries.empty())
+                malformed(msra::strfun::strprintf("duplicate entry '%ls'", iter.first.c_str()));
+            entries = std::move(iter.second);
+        }
+        fprintf(stderr, " total %lu entries\n", this->size());
+        return true;
+    }
+
+    // compile 'path', i.e. write out our content as its binary sidecar
+    // Best-effort: failure (e.g. a read-only input directory) only prints a warning.
+    void writecompiled(const wstring& path) const
+    {
+        const wstring cpath = compiledpath(path);
+        // concurrent jobs (e.g. MPI ranks) may compile the same MLF at once: write to a
+        // process-unique temp file and rename, so a reader never sees a half-written cache
+        const wstring tmppath = msra::strfun::wstrprintf(L"%ls.%d.tmp", cpath.c_str(), (int) GetCurrentProcessId());
+        try
+        {
+            {
+                auto_file_ptr f(fopenOrDie(tmppath, L"wb"));
+                fputTag(f, "CMLF");
+                fputint(f, 1);                   // version
+                fputint(f, (int) sizeof(ENTRY)); // entries are stored as their raw in-memory image
+                fput(f, (unsigned long long) this->size());
+                for (const auto& iter : *this)
+                {
+                    fputstring(f, iter.first);
+                    fputint(f, (int) iter.second.size());
+                    if (!iter.second.empty())
+                        fwriteOrDie(&iter.second[0], sizeof(ENTRY), iter.second.size(), f);
+                }
+                fputTag(f, "EMLF");
+                fflushOrDie(f);
+            } // this closes the file, as required before rename()
+            renameOrDie(tmppath, cpath);
+        }
+        catch (const exception& e)
+        {
+            fprintf(stderr, "htkmlfreader: failed to write compiled MLF %ls (%s), will re-parse next time\n", cpath.c_str(), e.what());
+            return;
+        }
+        fprintf(stderr, "htkmlfreader: wrote compiled MLF file %ls\n", cpath.c_str());
+    }
+
     vector<char*> readlines(const wstring& path, vector<char>& buffer)
     {
         // load it into RAM in one huge chunk
@@ -1019,8 +1129,17 @@ public:
         if (!restricttokeys.empty() && this->size() >= restricttokeys.size()) // no need to even read the file if we are there (we support multiple files)
             return;
 
-        fprintf(stderr, "htkmlfreader: reading MLF file %ls ...", path.c_str());
+        // fast path: load the compiled binary form if it is up to date (see readcompiled())
+        // We only compile the single-MLF case ('this' still empty), as the sidecar holds the full map.
+        const bool compilable = restricttokeys.empty() && wordmap == NULL && this->empty();
         curpath = path; // for error messages only
+        if (restricttokeys.empty() && wordmap == NULL && readcompiled(path))
+        {
+            curpath.clear();
+            return;
+        }
+
+        fprintf(stderr, "htkmlfreader: reading MLF file %ls ...", path.c_str());
 
         auto_file_ptr f(fopenOrDie(path, L"rb"));
         std::string headerLine = fgetline(f);
@@ -1100,6 +1219,9 @@ public:
 
         curpath.clear();
         fprintf(stderr, " total %lu entries\n", this->size());
+
+        if (compilable) // leave a compiled sidecar behind so the next job start skips the parse
+            writecompiled(path);
     }
 
     // read state list, index is from 0
@@ -1107,6 +1229,7 @@ public:
     {
         if (stateListPath != L"")
         {
+            statelistpath = stateListPath; // remembered for the compiled-MLF freshness check
             vector<char> buffer; // buffer owns the characters--don't release until done
             vector<char*> lines = readlines(stateListPath, buffer);
             size_t index;
@@ -0,0 +1,281 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// minibatchsourceaugmenter.h -- a minibatchsource that applies on-the-fly feature augmentation
+//
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <random>
+#include "minibatchiterator.h" // for the minibatchsource interface
+#include "htkfeatio.h"         // for reading the noise archive
+
+namespace msra { namespace dbn {
+
+// ---------------------------------------------------------------------------
+// featureaugmentation -- base class for per-utterance feature transforms
+//
+// A transform perturbs columns [ts, te) of a feature matrix in place. The range covers one
+// utterance (utterance mode, from the sent-end marks) or the whole minibatch (frame mode).
+// Note that the features arriving here are already context-expanded, so the transforms
+// operate on the assembled input vectors, not on the underlying single frames.
+// ---------------------------------------------------------------------------
+class featureaugmentation
+{
+public:
+    // 'rng' is seeded deterministically per minibatch, so a restarted job re-draws
+    // the same perturbations for the same global position
+    virtual void apply(matrix& feat, size_t ts, size_t te, std::mt19937_64& rng) const = 0;
+    virtual ~featureaugmentation()
+    {
+    }
+
+protected:
+    // neutral fill value for masking: the mean of feature row i over the utterance
+    static float rowmean(const matrix& feat, size_t i, size_t ts, size_t te)
+    {
+        double sum = 0.0;
+        for (size_t t = ts; t < te; t++)
+            sum += feat(i, t);
+        return (float) (sum / (te - ts));
+    }
+};
+
+// ---------------------------------------------------------------------------
+// additivenoiseaugmentation -- mix in a random crop from an archive of noise feature files
+//
+// The archive is a text file listing HTK feature files of noise recordings, read fully into
+// RAM once (noise archives are small compared to a corpus). For each utterance, with the
+// given probability, one noise file, a random crop offset (wrapping around), and a random
+// level in [minlevel, maxlevel] are drawn, and level * noiseframe is added to each feature
+// vector. The noise features must be of the same kind as the corpus features; their dimension
+// must divide the (context-expanded) input dimension, and the crop is tiled across the
+// context copies.
+// ---------------------------------------------------------------------------
+class additivenoiseaugmentation : public featureaugmentation
+{
+    std::vector<std::unique_ptr<matrix>> noises; // the noise archive, one matrix per file
+    double minlevel, maxlevel;                   // mixing level range
+    double probability;                          // fraction of utterances that get noise added
+
+public:
+    additivenoiseaugmentation(const std::wstring& scplistpath, double minlevel, double maxlevel, double probability)
+        : minlevel(minlevel), maxlevel(maxlevel), probability(probability)
+    {
+        msra::asr::htkfeatreader reader;
+        fprintf(stderr, "additivenoiseaugmentation: reading noise archive %ls ...", scplistpath.c_str());
+        for (msra::files::textreader r(scplistpath); r;)
+        {
+            wstring path = r.wgetline();
+            if (path.empty())
+                continue;
+            string kindstr;
+            unsigned int period;
+            noises.push_back(std::unique_ptr<matrix>(new matrix()));
+            reader.read(msra::asr::htkfeatreader::parsedpath(path), kindstr, period, *noises.back());
+        }
+        if (noises.empty())
+            RuntimeError("additivenoiseaugmentation: noise archive %ls lists no feature files", msra::strfun::utf8(scplistpath).c_str());
+        fprintf(stderr, " %d noise segments\n", (int) noises.size());
+    }
+
+    virtual void apply(matrix& feat, size_t ts, size_t te, std::mt19937_64& rng) const override
+    {
+        if (std::uniform_real_distribution<double>(0.0, 1.0)(rng) >= probability)
+            return;
+        const matrix& noise = *noises[rng() % noises.size()];
+        if (feat.rows() % noise.rows() != 0)
+            RuntimeError("additivenoiseaugmentation: noise dimension %d does not divide feature dimension %d", (int) noise.rows(), (int) feat.rows());
+        const size_t offset = rng() % noise.cols();
+        const float level = (float) std::uniform_real_distribution<double>(minlevel, maxlevel)(rng);
+        for (size_t t = ts; t < te; t++)
+        {
+            const size_t noisecol = (offset + t - ts) % noise.cols();
+            for (size_t i = 0; i < feat.rows(); i++)
+                feat(i, t) += level * noise(i % noise.rows(), noisecol);
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// frequencymaskaugmentation -- blank out random bands of feature dimensions
+//
+// For each utterance, 'count' bands of random width in [1, maxwidth] are drawn and the rows
+// in each band are set to their per-utterance mean (the neutral value for any feature kind).
+// ---------------------------------------------------------------------------
+class frequencymaskaugmentation : public featureaugmentation
+{
+    size_t count;    // number of bands to mask per utterance
+    size_t maxwidth; // maximal band width in feature dimensions
+
+public:
+    frequencymaskaugmentation(size_t count, size_t maxwidth)
+        : count(count), maxwidth(maxwidth)
+    {
+    }
+
+    virtual void apply(matrix& feat, size_t ts, size_t te, std::mt19937_64& rng) const override
+    {
+        for (size_t m = 0; m < count; m++)
+        {
+            size_t w = 1 + rng() % maxwidth;
+            if (w > feat.rows())
+                w = feat.rows();
+            const size_t f0 = rng() % (feat.rows() - w + 1);
+            for (size_t i = f0; i < f0 + w; i++)
+            {
+                const float mean = rowmean(feat, i, ts, te);
+                for (size_t t = ts; t < te; t++)
+                    feat(i, t) = mean;
+            }
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// timemaskaugmentation -- blank out random blocks of frames
+//
+// For each utterance, 'count' blocks of random length in [1, maxframes] (clamped to the
+// utterance length) are drawn and all rows in each block are set to their per-utterance mean.
+// ---------------------------------------------------------------------------
+class timemaskaugmentation : public featureaugmentation
+{
+    size_t count;     // number of blocks to mask per utterance
+    size_t maxframes; // maximal block length in frames
+
+public:
+    timemaskaugmentation(size_t count, size_t maxframes)
+        : count(count), maxframes(maxframes)
+    {
+    }
+
+    virtual void apply(matrix& feat, size_t ts, size_t te, std::mt19937_64& rng) const override
+    {
+        const size_t len = te - ts;
+        for (size_t m = 0; m < count; m++)
+        {
+            size_t w = 1 + rng() % maxframes;
+            if (w > len)
+                w = len;
+            const size_t t0 = ts + rng() % (len - w + 1);
+            for (size_t i = 0; i < feat.rows(); i++)
+            {
+                const float mean = rowmean(feat, i, ts, te);
+                for (size_t t = t0; t < t0 + w; t++)
+                    feat(i, t) = mean;
+            }
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// minibatchsourceaugmenter -- applies feature transforms to the batches of a wrapped source
+//
+// Sits between the frame source (including the mixer, which it can wrap) and minibatch
+// assembly. The transforms run per utterance, in place, on the primary feature stream
+// (stream 0); labels, lattices, and transcripts pass through untouched, which restricts the
+// transforms to ones that keep the frame alignment. The transform RNG is seeded from the
+// global time stamp of each batch, so augmentation is reproducible across restarts and
+// across runs.
+// ---------------------------------------------------------------------------
+class minibatchsourceaugmenter : public minibatchsource
+{
+    std::unique_ptr<minibatchsource> source;                         // the wrapped frame source
+    std::vector<std::unique_ptr<featureaugmentation>> augmentations; // applied in order
+
+    // apply all transforms to feature stream 'feat' of a batch read at 'globalts'
+    // 'sentendmarks' are the cumulative utterance ends within the batch (empty in frame
+    // mode, where the frames are shuffled individually and the batch is one segment)
+    void augment(matrix& feat, const std::vector<size_t>& sentendmarks, const size_t globalts) const
+    {
+        if (feat.cols() == 0)
+            return;
+        std::mt19937_64 rng(globalts + 6364136223846793005ULL); // arbitrary fixed offset so position 0 is not the zero seed
+        size_t ts = 0;
+        const size_t numsegments = sentendmarks.empty() ? 1 : sentendmarks.size();
+        for (size_t segment = 0; segment < numsegments; segment++)
+        {
+            const size_t te = sentendmarks.empty() ? feat.cols() : sentendmarks[segment];
+            for (const auto& augmentation : augmentations)
+                augmentation->apply(feat, ts, te, rng);
+            ts = te;
+        }
+    }
+
+public:
+    minibatchsourceaugmenter(std::unique_ptr<minibatchsource>&& source, std::vector<std::unique_ptr<featureaugmentation>>&& augmentations)
+        : source(std::move(source)), augmentations(std::move(augmentations))
+    {
+        if (this->augmentations.empty())
+            LogicError("minibatchsourceaugmenter: no augmentations given");
+    }
+
+    bool getbatch(const size_t globalts,
+                  const size_t framesrequested, msra::dbn::matrix& feat, std::vector<size_t>& uids,
+                  std::vector<const_array_ref<msra::lattices::lattice::htkmlfwordsequence::word>>& transcripts,
+                  std::vector<shared_ptr<const latticesource::latticepair>>& lattices) override
+    {
+        const bool readfromdisk = source->getbatch(globalts, framesrequested, feat, uids, transcripts, lattices);
+        augment(feat, std::vector<size_t>(), globalts);
+        return readfromdisk;
+    }
+
+    bool getbatch(const size_t globalts,
+                  const size_t framesrequested, std::vector<msra::dbn::matrix>& feat, std::vector<std::vector<size_t>>& uids,
+                  std::vector<const_array_ref<msra::lattices::lattice::htkmlfwordsequence::word>>& transcripts,
+                  std::vector<shared_ptr<const latticesource::latticepair>>& lattices, std::vector<std::vector<size_t>>& sentendmark,
+                  std::vector<std::vector<size_t>>& phoneboundaries) override
+    {
+        const bool readfromdisk = source->getbatch(globalts, framesrequested, feat, uids, transcripts, lattices, sentendmark, phoneboundaries);
+        augment(feat[0], sentendmark.empty() ? std::vector<size_t>() : sentendmark[0], globalts);
+        return readfromdisk;
+    }
+
+    bool getbatch(const size_t globalts,
+                  const size_t framesrequested, const size_t subsetnum, const size_t numsubsets, size_t& framesadvanced,
+                  std::vector<msra::dbn::matrix>& feat, std::vector<std::vector<size_t>>& uids,
+                  std::vector<const_array_ref<msra::lattices::lattice::htkmlfwordsequence::word>>& transcripts,
+                  std::vector<shared_ptr<const latticesource::latticepair>>& lattices, std::vector<std::vector<size_t>>& sentendmark,
+                  std::vector<std::vector<size_t>>& phoneboundaries) override
+    {
+        const bool readfromdisk = source->getbatch(globalts, framesrequested, subsetnum, numsubsets, framesadvanced,
+                                                   feat, uids, transcripts, lattices, sentendmark, phoneboundaries);
+        augment(feat[0], sentendmark.empty() ? std::vector<size_t>() : sentendmark[0], globalts);
+        return readfromdisk;
+    }
+
+    bool supportsbatchsubsetting() const override
+    {
+        return source->supportsbatchsubsetting();
+    }
+
+    size_t totalframes() const override
+    {
+        return source->totalframes();
+    }
+
+    double gettimegetbatch() override
+    {
+        return source->gettimegetbatch();
+    }
+
+    size_t firstvalidglobalts(const size_t globalts) override
+    {
+        return source->firstvalidglobalts(globalts);
+    }
+
+    const std::vector<size_t>& unitcounts() const override
+    {
+        return source->unitcounts();
+    }
+
+    void setverbosity(int newverbosity) override
+    {
+        source->setverbosity(newverbosity);
+    }
+};
+};
+};
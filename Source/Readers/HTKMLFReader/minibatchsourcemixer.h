@@ -0,0 +1,210 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// minibatchsourcemixer.h -- a minibatchsource that mixes several sources by sampled weights
+//
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <random>
+#include "minibatchiterator.h" // for the minibatchsource interface
+
+namespace msra { namespace dbn {
+
+// ---------------------------------------------------------------------------
+// minibatchsourcemixer -- online data mixing over several frame sources
+//
+// Wraps N minibatchsources (one per corpus, e.g. clean/noisy/far-field) and serves each
+// getbatch() call from one of them, sampled i.i.d. with the given weights. Every wrapped
+// source keeps its own randomization sweep and its own chunk readahead, and advances only
+// when it is sampled, so heavier-weighted corpora are re-swept more often -- the mix is
+// produced online instead of pre-duplicating data on disk. Sampling uses Walker's alias
+// method, so the per-batch cost is O(1) regardless of the number of sources.
+//
+// The nominal epoch ('totalframes') is the sum over the wrapped sources. Since the mixing
+// ratio is enforced by sampling, each source's position within the nominal epoch is not a
+// function of the global time stamp alone; on a (re)start, firstvalidglobalts() therefore
+// reseeds the sampler from the global position and places every source proportionally into
+// its own timeline, which makes restarting from a checkpoint reproducible.
+// ---------------------------------------------------------------------------
+class minibatchsourcemixer : public minibatchsource
+{
+    std::vector<std::unique_ptr<minibatchsource>> sources; // the wrapped per-corpus sources
+    std::vector<double> weights;                           // normalized mixing weights, one per source
+    // Walker alias table over the weights: sample a slot uniformly, then take either the
+    // slot itself or its alias depending on a biased coin--two random draws, no search
+    std::vector<double> aliasthresholds; // [slot] probability of keeping the slot itself
+    std::vector<size_t> aliases;         // [slot] the other source that fills up the slot
+    std::vector<size_t> sourcepos;       // [source] cumulative time stamp passed to the source's getbatch()
+    size_t lastsource;                   // source that served the last getbatch(), for gettimegetbatch()
+    std::mt19937_64 rng;                 // sampler state; reseeded deterministically in firstvalidglobalts()
+    size_t _totalframes;                 // sum over the wrapped sources
+    int verbosity;
+
+    // build the alias table (Vose's O(N) construction): scale the weights to a mean of 1,
+    // then repeatedly pair an under-full slot with an over-full source that tops it up
+    void buildaliastable()
+    {
+        const size_t n = weights.size();
+        aliasthresholds.assign(n, 1.0);
+        aliases.resize(n);
+        std::vector<double> scaled(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            scaled[i] = weights[i] * n;
+            aliases[i] = i;
+        }
+        std::vector<size_t> small, large;
+        for (size_t i = 0; i < n; i++)
+            (scaled[i] < 1.0 ? small : large).push_back(i);
+        while (!small.empty() && !large.empty())
+        {
+            const size_t s = small.back();
+            small.pop_back();
+            const size_t l = large.back();
+            aliasthresholds[s] = scaled[s];
+            aliases[s] = l;
+            scaled[l] -= 1.0 - scaled[s]; // the large slot donated this much
+            if (scaled[l] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // slots left in either list have (numerically) weight 1.0 and keep themselves
+    }
+
+    // sample the source that serves the next batch; O(1)
+    size_t samplesource()
+    {
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng) * sources.size();
+        const size_t slot = std::min((size_t) u, sources.size() - 1);
+        return (u - (double) slot) < aliasthresholds[slot] ? slot : aliases[slot];
+    }
+
+public:
+    minibatchsourcemixer(std::vector<std::unique_ptr<minibatchsource>>&& sources, const std::vector<double>& mixweights)
+        : sources(std::move(sources)), lastsource(0), verbosity(2)
+    {
+        if (this->sources.size() < 2)
+            LogicError("minibatchsourcemixer: at least two sources required");
+        if (mixweights.size() != this->sources.size())
+            LogicError("minibatchsourcemixer: one weight per source required");
+
+        double weightsum = 0.0;
+        for (const double w : mixweights)
+        {
+            if (w <= 0.0)
+                LogicError("minibatchsourcemixer: weights must be positive");
+            weightsum += w;
+        }
+        weights.resize(mixweights.size());
+        for (size_t i = 0; i < mixweights.size(); i++)
+            weights[i] = mixweights[i] / weightsum;
+        buildaliastable();
+
+        _totalframes = 0;
+        for (const auto& source : this->sources)
+        {
+            _totalframes += source->totalframes();
+            // all sources must emit the same label sets
+            if (source->unitcounts() != this->sources[0]->unitcounts())
+                LogicError("minibatchsourcemixer: sources disagree on the number of output classes");
+        }
+        sourcepos.resize(this->sources.size(), 0);
+    }
+
+    // read a minibatch from one sampled source
+    bool getbatch(const size_t /*globalts*/,
+                  const size_t framesrequested, msra::dbn::matrix& feat, std::vector<size_t>& uids,
+                  std::vector<const_array_ref<msra::lattices::lattice::htkmlfwordsequence::word>>& transcripts,
+                  std::vector<shared_ptr<const latticesource::latticepair>>& lattices) override
+    {
+        const size_t s = samplesource();
+        const bool readfromdisk = sources[s]->getbatch(sourcepos[s], framesrequested, feat, uids, transcripts, lattices);
+        sourcepos[s] += feat.cols();
+        lastsource = s;
+        return readfromdisk;
+    }
+
+    bool getbatch(const size_t /*globalts*/,
+                  const size_t framesrequested, std::vector<msra::dbn::matrix>& feat, std::vector<std::vector<size_t>>& uids,
+                  std::vector<const_array_ref<msra::lattices::lattice::htkmlfwordsequence::word>>& transcripts,
+                  std::vector<shared_ptr<const latticesource::latticepair>>& lattices, std::vector<std::vector<size_t>>& sentendmark,
+                  std::vector<std::vector<size_t>>& phoneboundaries) override
+    {
+        const size_t s = samplesource();
+        const bool readfromdisk = sources[s]->getbatch(sourcepos[s], framesrequested, feat, uids, transcripts, lattices, sentendmark, phoneboundaries);
+        sourcepos[s] += feat[0].cols();
+        lastsource = s;
+        return readfromdisk;
+    }
+
+    bool getbatch(const size_t /*globalts*/,
+                  const size_t framesrequested, const size_t subsetnum, const size_t numsubsets, size_t& framesadvanced,
+                  std::vector<msra::dbn::matrix>& feat, std::vector<std::vector<size_t>>& uids,
+                  std::vector<const_array_ref<msra::lattices::lattice::htkmlfwordsequence::word>>& transcripts,
+                  std::vector<shared_ptr<const latticesource::latticepair>>& lattices, std::vector<std::vector<size_t>>& sentendmark,
+                  std::vector<std::vector<size_t>>& phoneboundaries) override
+    {
+        const size_t s = samplesource();
+        const bool readfromdisk = sources[s]->getbatch(sourcepos[s], framesrequested, subsetnum, numsubsets, framesadvanced,
+                                                       feat, uids, transcripts, lattices, sentendmark, phoneboundaries);
+        sourcepos[s] += framesadvanced;
+        lastsource = s;
+        return readfromdisk;
+    }
+
+    bool supportsbatchsubsetting() const override
+    {
+        for (const auto& source : sources)
+            if (!source->supportsbatchsubsetting())
+                return false;
+        return true;
+    }
+
+    size_t totalframes() const override
+    {
+        return _totalframes;
+    }
+
+    double gettimegetbatch() override
+    {
+        return sources[lastsource]->gettimegetbatch();
+    }
+
+    // (re)position the mixer: reseed the sampler from the global position and place each
+    // source proportionally into its own timeline, so a restart from a checkpoint draws
+    // the same sequence of sources and continues each of them near where it left off
+    size_t firstvalidglobalts(const size_t globalts) override
+    {
+        rng.seed((unsigned long long) globalts + 6364136223846793005ULL); // arbitrary fixed offset so position 0 is not the zero seed
+        for (size_t s = 0; s < sources.size(); s++)
+            sourcepos[s] = sources[s]->firstvalidglobalts((size_t)(globalts * weights[s]));
+        if (verbosity > 0 && globalts == 0)
+        {
+            fprintf(stderr, "minibatchsourcemixer: mixing %d sources:", (int) sources.size());
+            for (size_t s = 0; s < sources.size(); s++)
+                fprintf(stderr, " %.1f%% (%d frames)", 100.0 * weights[s], (int) sources[s]->totalframes());
+            fprintf(stderr, "\n");
+        }
+        return globalts; // any position is a valid start for the mixer itself
+    }
+
+    const std::vector<size_t>& unitcounts() const override
+    {
+        return sources[0]->unitcounts(); // validated identical across sources in the constructor
+    }
+
+    void setverbosity(int newverbosity) override
+    {
+        verbosity = newverbosity;
+        for (const auto& source : sources)
+            source->setverbosity(newverbosity);
+    }
+};
+};
+};
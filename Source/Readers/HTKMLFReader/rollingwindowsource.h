@@ -15,6 +15,10 @@
 #include "minibatchiterator.h"
 #include "biggrowablevectors.h"
 #include "ssematrix.h"
+#ifndef _WIN32
+#include <sys/mman.h> // for memory-mapped access to the page file
+#include <unistd.h>
+#endif
 
 namespace msra { namespace dbn {
 
@@ -33,6 +37,8 @@ class biggrowablevectorarray : public growablevectorbase<msra::dbn::matrix>
     wstring pagepath; // path for paging, empty if no paging
     auto_file_ptr f;  // file handle for paging
     bool reading;     // have we begun reading?
+    bool persistent;  // keep the page file on disk after we are done, for reuse by later jobs
+    bool restored;    // this instance was restored from a kept page file (starts out in reading mode)
 
     // allocate a block
     msra::dbn::matrix *newblock() const
@@ -91,6 +97,71 @@ class biggrowablevectorarray : public growablevectorbase<msra::dbn::matrix>
         f = fopenOrDie(pagepath, wantread ? L"rbS" : L"wbS");
         reading = wantread;
     }
+
+    // persistent-cache support: the page file doubles as a local disk cache of the corpus.
+    // A small sidecar file (pagepath + ".info") records dimension and frame count; a page
+    // file whose size matches that header is complete and can be served without re-reading
+    // the corpus from its original (possibly network) location.
+    static wstring infopathname(const wstring &pagepath)
+    {
+        return pagepath + L".info";
+    }
+    static const unsigned int infomagic = 0x62677661; // 'bgva'
+    static size_t pagefilebytes(size_t m, size_t n, size_t elementsperblock)
+    {
+        const size_t numblocks = (n + elementsperblock - 1) / elementsperblock;
+        const size_t colstride = (m + 3) & ~3; // SSE padding, same formula as the matrix allocator
+        return numblocks * colstride * elementsperblock * sizeof(float);
+    }
+    // read the sidecar; returns true and the recorded dimensions if it is consistent with the page file
+    static bool readinfofile(const wstring &pagepath, size_t elementsperblock, size_t &m, size_t &n)
+    {
+        FILE *fi = _wfopen(infopathname(pagepath).c_str(), L"rbS");
+        if (!fi)
+            return false;
+        unsigned int magic = 0;
+        size_t cachedm = 0, cachedn = 0;
+        bool ok = fread(&magic, sizeof(magic), 1, fi) == 1 && fread(&cachedm, sizeof(cachedm), 1, fi) == 1 && fread(&cachedn, sizeof(cachedn), 1, fi) == 1;
+        fclose(fi);
+        if (!ok || magic != infomagic || cachedm == 0 || cachedn == 0)
+            return false;
+        size_t pagebytes = 0;
+        try
+        {
+            pagebytes = filesize(pagepath.c_str());
+        }
+        catch (...)
+        {
+            return false; // page file missing or inaccessible
+        }
+        if (pagebytes != pagefilebytes(cachedm, cachedn, elementsperblock))
+            return false; // incomplete (e.g. a previous job died mid-write) or from different settings
+        m = cachedm;
+        n = cachedn;
+        return true;
+    }
+    void writeinfofile()
+    {
+        auto_file_ptr fi(fopenOrDie(infopathname(pagepath), L"wbS"));
+        unsigned int magic = infomagic; // (copy: fwrite needs an address)
+        fwriteOrDie(&magic, sizeof(magic), 1, fi);
+        fwriteOrDie(&m, sizeof(m), 1, fi);
+        fwriteOrDie(&n, sizeof(n), 1, fi);
+        fflushOrDie(fi);
+    }
+    // switch directly into reading mode off a kept page file, skipping population
+    bool restorefromcache()
+    {
+        size_t cachedm, cachedn;
+        if (!readinfofile(pagepath, elementsperblock, cachedm, cachedn))
+            return false;
+        m = cachedm;
+        resize_without_commit(cachedn); // sizes 'blocks' without allocating; content stays on disk
+        inmembegin = inmemend = 0;
+        openpagefile(true);
+        mappagefile();
+        return true;
+    }
     void flushlastblock() // during population phase, must be called once per block in sequence
     {
         if (!paging())
@@ -128,26 +199,128 @@ class biggrowablevectorarray : public growablevectorbase<msra::dbn::matrix>
         block.frompagefile(f);
     }
 
+#ifndef _WIN32
+    // zero-copy read access: map the page file read-only and serve feature vectors
+    // directly out of the mapping, instead of fread()ing blocks back into freshly
+    // allocated matrices. The page file stores each block as its raw in-memory image
+    // (colstride x elementsperblock floats), so a view into the mapping has exactly
+    // the layout the matrix code expects, and mmap() returns page-aligned (hence
+    // SSE-aligned) addresses.
+
+    // a non-owning matrix view over one block of the mapping
+    class mappedblockview : public msra::dbn::matrixbase
+    {
+    public:
+        mappedblockview(float *pdata, size_t n, size_t m, size_t colstride)
+        {
+            this->p = pdata;
+            this->numrows = n;
+            this->numcols = m;
+            this->colstride = colstride;
+        }
+        ~mappedblockview()
+        {
+            this->clear(); // the memory belongs to the mapping
+        }
+    };
+
+    float *mapping = NULL; // start of read-only mapping of the page file, NULL if not mapped
+    size_t mappingsize = 0;
+    std::vector<std::unique_ptr<mappedblockview>> mappedblocks; // [blockid] views into 'mapping'
+
+    bool mapped() const
+    {
+        return mapping != NULL;
+    }
+    void mappagefile() // called once when switching to reading mode; failure falls back to fread-based paging
+    {
+        const size_t colstride = (m + 3) & ~3; // SSE padding, same formula as the matrix allocator
+        const size_t blockbytes = colstride * elementsperblock * sizeof(float);
+        mappingsize = blocks.size() * blockbytes;
+        if (mappingsize == 0)
+            return;
+        void *pmap = mmap(NULL, mappingsize, PROT_READ, MAP_SHARED, fileno(f), 0);
+        if (pmap == MAP_FAILED)
+        {
+            fprintf(stderr, "biggrowablevectorarray: mmap of page file failed, falling back to buffered reads\n");
+            mapping = NULL;
+            return;
+        }
+        mapping = (float *) pmap;
+        mappedblocks.resize(blocks.size());
+        foreach_index (b, mappedblocks)
+            mappedblocks[b].reset(new mappedblockview(mapping + b * colstride * elementsperblock, m, elementsperblock, colstride));
+        fprintf(stderr, "biggrowablevectorarray: serving features zero-copy from memory-mapped page file (%lu bytes)\n", (unsigned long) mappingsize);
+    }
+    void unmappagefile()
+    {
+        if (mapped())
+        {
+            mappedblocks.clear();
+            munmap(mapping, mappingsize);
+            mapping = NULL;
+        }
+    }
+#else
+    bool mapped() const
+    {
+        return false;
+    }
+    void mappagefile()
+    {
+    }
+    void unmappagefile()
+    {
+    }
+#endif
+
 public:
-    biggrowablevectorarray(const wstring &pagepath)
-        : growablevectorbase(65536), m(0), inmembegin(0), inmemend(0), pagepath(pagepath), reading(false)
+    // 'persistent' keeps the page file (plus a small .info sidecar) on disk when we are done,
+    // so that later epochs/jobs on the same machine can restore from it instead of re-reading
+    // the corpus from its original location. Pass 'restore' to serve from such a kept file;
+    // probe with cachevalid() first. A restored instance starts out in reading mode.
+    biggrowablevectorarray(const wstring &pagepath, bool persistent = false, bool restore = false)
+        : growablevectorbase(65536), m(0), inmembegin(0), inmemend(0), pagepath(pagepath), reading(false), persistent(persistent), restored(false)
     {
+        if (restore)
+        {
+            assert(persistent);
+            restored = restorefromcache();
+            if (!restored) // cachevalid() said yes but the file changed under us
+                RuntimeError("biggrowablevectorarray: disk cache at '%ls' disappeared or changed while restoring", pagepath.c_str());
+            fprintf(stderr, "biggrowablevectorarray: restored %d frames of dim %d from disk cache at '%ls'\n", (int) n, (int) m, pagepath.c_str());
+            return;
+        }
         openpagefile(false);
         if (paging())
             fprintf(stderr, "biggrowablevectorarray: creating disk backup store at '%ls'\n", pagepath.c_str());
     }
+    // probe whether a complete kept page file exists at this path (sidecar consistent with file size)
+    static bool cachevalid(const wstring &pagepath)
+    {
+        size_t cachedm, cachedn;
+        return readinfofile(pagepath, 65536 /*must match constructor*/, cachedm, cachedn);
+    }
     ~biggrowablevectorarray()
-    { // clean up the big temp file
+    { // clean up the big temp file (unless it is a persistent cache to be reused)
         if (paging())
         {
+            unmappagefile();
             fclose(f);
-            if (_wunlink(pagepath.c_str()) == 0)
+            if (persistent)
+                fprintf(stderr, "biggrowablevectorarray: keeping disk cache at '%ls' for reuse\n", pagepath.c_str());
+            else if (_wunlink(pagepath.c_str()) == 0)
                 fprintf(stderr, "biggrowablevectorarray: deleted disk backup store at '%ls'\n", pagepath.c_str());
             else
                 fprintf(stderr, "biggrowablevectorarray: unable to delete disk backup store at '%ls'\n", pagepath.c_str());
         }
     }
 
+    bool isrestored() const
+    {
+        return restored;
+    }
+
     size_t dim() const
     {
         return m;
@@ -156,6 +329,8 @@ public:
     // reading phase
     void push_back(const std::vector<float> &in)
     {
+        if (restored)
+            LogicError("biggrowablevectorarray: cannot push_back into an instance restored from a disk cache");
         assert(!in.empty());
         assert(m == 0 || m == in.size());
         m = in.size();
@@ -175,6 +350,8 @@ public:
     }
     void no_more_push_back() // done pushing --switch to consumption mode
     {
+        if (restored) // already in reading mode
+            return;
         if (!paging())
             return;
         // finish off last block
@@ -182,11 +359,14 @@ public:
         fflushOrDie(f);
         fprintf(stderr, "biggrowablevectorarray: disk backup store created, %d frames, %lu bytes\n", (int) n, fgetpos(f));
         fclose(f);
+        if (persistent) // record dimensions so later jobs can validate and restore the cache
+            writeinfofile();
         foreach_index (i, blocks)
             assert(!blocks[i]);         // ensure we flushed
         assert(inmembegin == inmemend); // nothing in cache
         // switch to reading mode
         openpagefile(true);
+        mappagefile(); // map it read-only for zero-copy access where supported
     }
 
     // access phase
@@ -195,6 +375,9 @@ public:
     {
         bool readfromdisk = false;
 
+        if (mapped()) // the whole file is visible through the mapping; the OS pages it in on demand
+            return false;
+
         // get bounds rounded to block boundaries
         const size_t ts = bounds.first / elementsperblock * elementsperblock;
         const size_t te = min(n, (bounds.second + elementsperblock - 1) / elementsperblock * elementsperblock);
@@ -225,6 +408,16 @@ public:
     }
     const msra::dbn::matrixstripe operator[](size_t t) const // get a feature vector
     {
+#ifndef _WIN32
+        if (mapped()) // serve the vector directly out of the mapping; note that it is read-only
+        {
+            if (t >= n)
+                LogicError("biggrowablevectorarray: attempt to access vector beyond end");
+            const size_t blockt = getblockt(t);
+            /*const*/ mappedblockview &block = *const_cast<biggrowablevectorarray *>(this)->mappedblocks[t / elementsperblock];
+            return msra::dbn::matrixstripe(block, blockt, 1);
+        }
+#endif
         if (t < inmembegin || t >= inmemend)
             LogicError("biggrowablevectorarray: attempt to access vector without requesting to page it in first");
         const size_t blockt = getblockt(t);
@@ -239,8 +432,13 @@ public:
     {
         if (paging())
         {
+            unmappagefile();
             fclose(f);
-            if (_wunlink(pagepath.c_str()) == 0)
+            if (persistent)
+            {
+                fprintf(stderr, "biggrowablevectorarray: keeping disk cache at '%ls' for reuse\n", pagepath.c_str());
+            }
+            else if (_wunlink(pagepath.c_str()) == 0)
             {
                 fprintf(stderr, "biggrowablevectorarray: deleted disk backup store at '%ls'\n", pagepath.c_str());
             }
@@ -295,6 +493,7 @@ public:
         size_t notfound = 0;             // number of entries missing in MLF
         msra::asr::htkfeatreader reader; // feature reader
         reader.AddEnergy(addEnergy);
+        reader.setstreamingmode(true); // one-shot pass over the corpus: don't let it evict the page cache
 
         foreach_index (i, infiles)
         {
@@ -557,11 +756,97 @@ class minibatchframesourcemulti : public minibatchsource
     double timegetbatch;
     int verbosity;
 
+    // persistent corpus cache: next to the per-stream page files we keep one sidecar with
+    // everything else the constructor derives from its pass over the corpus (sample period,
+    // feature kind, boundary flags, label ids), so a later job restores without touching
+    // the original feature/MLF files at all
+    static const unsigned int labelcachemagic = 0x62676c63; // 'bglc'
+    static wstring labelcachepath(const wstring &pagepath)
+    {
+        return pagepath + L".labels";
+    }
+    bool loadlabelcache(const wstring &path, size_t numlabelsets, const std::vector<size_t> &udim, std::vector<size_t> &numclasses)
+    {
+        FILE *fi = _wfopen(path.c_str(), L"rbS");
+        if (!fi)
+            return false;
+        unsigned int magic = 0, cachedsampperiod = 0;
+        size_t featkindlen = 0, numboundaryflags = 0, cachedsets = 0;
+        bool ok = fread(&magic, sizeof(magic), 1, fi) == 1 && magic == labelcachemagic;
+        ok = ok && fread(&cachedsampperiod, sizeof(cachedsampperiod), 1, fi) == 1;
+        ok = ok && fread(&featkindlen, sizeof(featkindlen), 1, fi) == 1 && featkindlen < 1024;
+        if (ok)
+        {
+            featkind.resize(featkindlen);
+            ok = featkindlen == 0 || fread(&featkind[0], 1, featkindlen, fi) == featkindlen;
+        }
+        ok = ok && fread(&numboundaryflags, sizeof(numboundaryflags), 1, fi) == 1;
+        if (ok)
+        {
+            boundaryflags.resize(numboundaryflags);
+            ok = numboundaryflags == 0 || fread(boundaryflags.data(), sizeof(char), numboundaryflags, fi) == numboundaryflags;
+        }
+        ok = ok && fread(&cachedsets, sizeof(cachedsets), 1, fi) == 1 && cachedsets == numlabelsets;
+        for (size_t j = 0; ok && j < cachedsets; j++)
+        {
+            size_t setclasses = 0, setframes = 0;
+            ok = fread(&setclasses, sizeof(setclasses), 1, fi) == 1 && fread(&setframes, sizeof(setframes), 1, fi) == 1;
+            ok = ok && setclasses <= udim[j]; // model dimension changed -> cache does not apply
+            if (ok)
+            {
+                classids.push_back(std::vector<CLASSIDTYPE>(setframes));
+                ok = setframes == 0 || fread(classids[j].data(), sizeof(CLASSIDTYPE), setframes, fi) == setframes;
+                numclasses.push_back(setclasses);
+            }
+        }
+        fclose(fi);
+        if (!ok) // reject wholesale; constructor falls back to reading the corpus
+        {
+            sampperiod = 0;
+            featkind.clear();
+            boundaryflags.clear();
+            classids.clear();
+            numclasses.clear();
+            return false;
+        }
+        sampperiod = cachedsampperiod;
+        return true;
+    }
+    void savelabelcache(const wstring &path, const std::vector<size_t> &numclasses)
+    {
+        auto_file_ptr fi(fopenOrDie(path, L"wbS"));
+        unsigned int magic = labelcachemagic; // (copy: fwrite needs an address)
+        fwriteOrDie(&magic, sizeof(magic), 1, fi);
+        unsigned int cachedsampperiod = sampperiod;
+        fwriteOrDie(&cachedsampperiod, sizeof(cachedsampperiod), 1, fi);
+        size_t featkindlen = featkind.size();
+        fwriteOrDie(&featkindlen, sizeof(featkindlen), 1, fi);
+        if (featkindlen > 0)
+            fwriteOrDie(featkind.data(), 1, featkindlen, fi);
+        size_t numboundaryflags = boundaryflags.size();
+        fwriteOrDie(&numboundaryflags, sizeof(numboundaryflags), 1, fi);
+        if (numboundaryflags > 0)
+            fwriteOrDie(boundaryflags.data(), sizeof(char), numboundaryflags, fi);
+        size_t numsets = classids.size();
+        fwriteOrDie(&numsets, sizeof(numsets), 1, fi);
+        foreach_index (j, classids)
+        {
+            size_t setclasses = numclasses[j], setframes = classids[j].size();
+            fwriteOrDie(&setclasses, sizeof(setclasses), 1, fi);
+            fwriteOrDie(&setframes, sizeof(setframes), 1, fi);
+            if (setframes > 0)
+                fwriteOrDie(classids[j].data(), sizeof(CLASSIDTYPE), setframes, fi);
+        }
+        fflushOrDie(fi);
+        fprintf(stderr, "minibatchframesourcemulti: wrote corpus label cache to '%ls'\n", path.c_str());
+    }
+
 public:
     // constructor
     // Pass empty labels to denote unsupervised training (so getbatch() will not return uids).
     minibatchframesourcemulti(const std::vector<std::vector<wstring>> &infiles, const std::vector<map<std::wstring, std::vector<msra::asr::htkmlfentry>>> &labels,
-                              std::vector<size_t> vdim, std::vector<size_t> udim, std::vector<size_t> leftcontext, std::vector<size_t> rightcontext, size_t randomizationrange, const std::vector<wstring> &pagepath, const bool mayhavenoframe = false, int addEnergy = 0)
+                              std::vector<size_t> vdim, std::vector<size_t> udim, std::vector<size_t> leftcontext, std::vector<size_t> rightcontext, size_t randomizationrange, const std::vector<wstring> &pagepath, const bool mayhavenoframe = false, int addEnergy = 0,
+                              const bool persistentcache = false)
         : vdim(vdim), leftcontext(leftcontext), rightcontext(rightcontext), sampperiod(0), featdim(0), numframes(0), timegetbatch(0), verbosity(2), maxvdim(0)
     {
 
@@ -586,14 +871,48 @@ public:
         if (labels.size() == 0)
             fprintf(stderr, "no MLF label files detected\n");
 
+        // persistent corpus cache: restore from kept page files if every stream has a complete
+        // one and the label sidecar matches; then the whole corpus pass below is skipped
+        bool usecache = persistentcache;
         foreach_index (i, infiles)
         {
-            pframes.push_back(unique_ptr<biggrowablevectorarray>(new biggrowablevectorarray(pagepath[i])));
+            if (usecache && !biggrowablevectorarray::cachevalid(pagepath[i]))
+                usecache = false;
+        }
+        if (usecache)
+            usecache = loadlabelcache(labelcachepath(pagepath[0]), labels.size(), udim, numclasses);
+
+        foreach_index (i, infiles)
+        {
+            pframes.push_back(unique_ptr<biggrowablevectorarray>(new biggrowablevectorarray(pagepath[i], persistentcache, usecache)));
 
             if (vdim[i] > maxvdim)
                 maxvdim = vdim[i];
         }
 
+        if (usecache)
+        {
+            numframes = pframes[0]->size();
+            featdim = pframes[0]->dim();
+            foreach_index (i, infiles)
+            {
+                if (pframes[i]->size() != numframes)
+                    RuntimeError("minibatchframesourcemulti: corpus cache streams disagree on frame count; delete '%ls'* and rerun", pagepath[0].c_str());
+            }
+            if (boundaryflags.size() != numframes)
+                RuntimeError("minibatchframesourcemulti: corpus cache label sidecar inconsistent with page files; delete '%ls'* and rerun", pagepath[0].c_str());
+            foreach_index (j, classids)
+            {
+                if (classids[j].size() != numframes)
+                    RuntimeError("minibatchframesourcemulti: corpus cache label sidecar inconsistent with page files; delete '%ls'* and rerun", pagepath[0].c_str());
+                fprintf(stderr, "minibatchframesourcemulti: restored label set %d: %d classes\n", j, (int) numclasses[j]);
+            }
+            fprintf(stderr, "minibatchframesourcemulti: restored %d feature sets with %d frames from the corpus cache\n", (int) infiles.size(), (int) numframes);
+            if (numframes > 0)
+                randomordering.resize(numframes, randomizationrange);
+            return;
+        }
+
         foreach_index (i, labels)
         {
             classids.push_back(std::vector<CLASSIDTYPE>());
@@ -610,6 +929,7 @@ public:
             featkind.clear();
             msra::asr::htkfeatreader reader; // feature reader
             reader.AddEnergy(addEnergy);
+            reader.setstreamingmode(true); // one-shot pass over the corpus: don't let it evict the page cache
 
             foreach_index (i, infiles[m]) // read each feature file in set m
             {
@@ -751,6 +1071,10 @@ public:
         if (numframes == 0 && !mayhavenoframe)
             RuntimeError("minibatchframesource: no input features given!");
 
+        // persist the label sidecar alongside the kept page files for later jobs
+        if (persistentcache)
+            savelabelcache(labelcachepath(pagepath[0]), numclasses);
+
         // initialize randomizer
         if (numframes > 0)
             randomordering.resize(numframes, randomizationrange);
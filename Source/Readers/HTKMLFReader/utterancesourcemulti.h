@@ -13,6 +13,10 @@
 #include "minibatchsourcehelpers.h"
 #include "minibatchiterator.h"
 #include "unordered_set"
+#include <future>
+#include <memory>
+#include <mutex>
+#include <map>
 
 namespace msra { namespace dbn {
 
@@ -140,6 +144,7 @@ class minibatchutterancesourcemulti : public minibatchsource
                 LogicError("requiredata: cannot page in virgin block");
             if (isinram())
                 LogicError("requiredata: called when data is already in memory");
+            std::future<void> latticefetch; // in-flight background fetch of this chunk's lattices
             try // this function supports retrying since we read from the unrealible network, i.e. do not return in a broken state
             {
                 msra::asr::htkfeatreader reader; // feature reader (we reinstantiate it for each block, i.e. we reopen the file actually)
@@ -149,26 +154,45 @@ class minibatchutterancesourcemulti : public minibatchsource
                     reader.getinfo(utteranceset[0].parsedpath, featkind, featdim, sampperiod);
                     fprintf(stderr, "requiredata: determined feature kind as %d-dimensional '%s' with frame shift %.1f ms\n", (int) featdim, featkind.c_str(), sampperiod / 1e4);
                 }
-                // read all utterances; if they are in the same archive, htkfeatreader will be efficient in not closing the file
                 frames.resize(featdim, totalframes);
+                // page in lattice data on a background task, overlapped with the feature reads below;
+                // lattices live in a separate archive whose reads are serialized internally, so for
+                // sequence training this decode would otherwise add its full cost to the chunk latency
                 if (!latticesource.empty())
+                {
                     lattices.resize(utteranceset.size());
+                    latticefetch = std::async(std::launch::async, [&]()
+                                              {
+                                                  foreach_index (i, utteranceset)
+                                                      latticesource.getlattices(utteranceset[i].key(), lattices[i], numframes(i));
+                                              });
+                }
+                // read all utterances; if they are in the same archive, htkfeatreader will be efficient in not closing the file
                 foreach_index (i, utteranceset)
                 {
                     // fprintf (stderr, ".");
                     // read features for this file
                     auto uttframes = getutteranceframes(i);                                                    // matrix stripe for this utterance (currently unfilled)
                     reader.read(utteranceset[i].parsedpath, (const string &) featkind, sampperiod, uttframes); // note: file info here used for checkuing only
-                    // page in lattice data
-                    if (!latticesource.empty())
-                        latticesource.getlattices(utteranceset[i].key(), lattices[i], uttframes.cols());
                 }
+                if (latticefetch.valid())
+                    latticefetch.get();
                 // fprintf (stderr, "\n");
                 if (verbosity)
                     fprintf(stderr, "requiredata: %d utterances read\n", (int) utteranceset.size());
             }
             catch (...)
             {
+                if (latticefetch.valid()) // must not release 'lattices' while the fetch still writes into it
+                {
+                    try
+                    {
+                        latticefetch.get();
+                    }
+                    catch (...)
+                    {
+                    }
+                }
                 releasedata();
                 throw;
             }
@@ -196,6 +220,7 @@ class minibatchutterancesourcemulti : public minibatchsource
     size_t numutterances; // total number of utterances
     size_t _totalframes;  // total frames (same as classids.size() if we have labels)
     double timegetbatch;  // [v-hansu] for time measurement
+    double lengthbucketingtolerance; // see setlengthbucketing(); 0 disables bucketing
     // sequence in random order of actual use (randomized, where randomization is cached)
     const size_t randomizationrange; // parameter remembered; this is the full window (e.g. 48 hours), not the half window
     size_t currentsweep;             // randomization is currently cached for this sweep; if it changes, rebuild all below
@@ -240,6 +265,26 @@ class minibatchutterancesourcemulti : public minibatchsource
     };
     std::vector<std::vector<chunk>> randomizedchunks; // utterance chunks after being brought into random order (we randomize within a rolling window over them)
     size_t chunksinram;                               // (for diagnostics messages)
+    // chunk readahead (see setchunkreadahead()):
+    // Chunks enter the paging window in increasing randomized-chunk order, i.e. the visitation order
+    // is known ahead of time. We prefetch upcoming chunks in that order on background threads into a
+    // bounded RAM budget ahead of the window, and evict behind the window in the same order.
+    size_t readaheadbudget;                                       // bytes that chunks prefetched ahead of the window may occupy (0: readahead disabled)
+    size_t readaheadthreads;                                      // max number of chunks read concurrently in the background
+    std::mutex readaheadmutex;                                    // protects readaheadinflight
+    std::map<size_t, std::shared_future<void>> readaheadinflight; // [randomized chunk index] -> pending background read
+    // generational chunk cache (see setchunkcachebudget()):
+    // Chunks inside the paging window or the readahead horizon are pinned. With a cache budget,
+    // chunks the window moves past are merely unpinned instead of paged out, and eviction happens
+    // oldest-use-first only once the resident unpinned bytes exceed the budget. A chunk that
+    // re-enters a window while still resident (randomization windows of successive sweeps overlap
+    // in chunk content) is then found in RAM instead of being re-read.
+    size_t chunkcachebudget;          // bytes that resident chunks outside window/readahead may keep occupying (0: page out immediately, the old behavior)
+    size_t cachegeneration;           // LRU clock: bumped on every chunk use to stamp chunklastuse[]
+    std::vector<size_t> chunklastuse; // [original chunk index] -> generation of last use (stable across sweeps, unlike randomized indices)
+    std::vector<char> chunkeverread;  // [original chunk index] -> chunk has been paged in at least once
+    size_t numchunkpageins;           // re-read statistics: total page-ins...
+    size_t numdistinctchunkreads;     // ...vs. distinct chunks read; the ratio is the re-read rate, reported once per sweep
     struct utteranceref                               // describes the underlying random utterance associated with an utterance position
     {
         size_t chunkindex;     // lives in this chunk (index into randomizedchunks[])
@@ -389,7 +434,7 @@ public:
     minibatchutterancesourcemulti(const std::vector<std::vector<wstring>> &infiles, const std::vector<map<wstring, std::vector<msra::asr::htkmlfentry>>> &labels,
                                   std::vector<size_t> vdim, std::vector<size_t> udim, std::vector<size_t> leftcontext, std::vector<size_t> rightcontext, size_t randomizationrange,
                                   const latticesource &lattices, const map<wstring, msra::lattices::lattice::htkmlfwordsequence> &allwordtranscripts, const bool framemode)
-        : vdim(vdim), leftcontext(leftcontext), rightcontext(rightcontext), sampperiod(0), featdim(0), randomizationrange(randomizationrange), currentsweep(SIZE_MAX), lattices(lattices), allwordtranscripts(allwordtranscripts), framemode(framemode), chunksinram(0), timegetbatch(0), verbosity(2)
+        : vdim(vdim), leftcontext(leftcontext), rightcontext(rightcontext), sampperiod(0), featdim(0), randomizationrange(randomizationrange), currentsweep(SIZE_MAX), prefetchedsweep(SIZE_MAX), lattices(lattices), allwordtranscripts(allwordtranscripts), framemode(framemode), chunksinram(0), readaheadbudget(0), readaheadthreads(2), chunkcachebudget(0), cachegeneration(0), numchunkpageins(0), numdistinctchunkreads(0), timegetbatch(0), lengthbucketingtolerance(0), verbosity(2)
     // [v-hansu] change framemode (lattices.empty()) into framemode (false) to run utterance mode without lattice
     // you also need to change another line, search : [v-hansu] comment out to run utterance mode without lattice
     {
@@ -694,7 +739,35 @@ public:
         }
     }
 
+    ~minibatchutterancesourcemulti()
+    {
+        if (prefetchedschedule.valid())
+            prefetchedschedule.wait(); // the schedule precompute reads allchunks[] metadata
+        drainreadahead(); // background reads write into chunk data we are about to tear down
+    }
+
 private:
+    // wait for all pending background readahead reads and discard their results
+    // Used before destruction and before re-randomization, both of which invalidate what the reads reference.
+    void drainreadahead()
+    {
+        std::map<size_t, std::shared_future<void>> pending;
+        {
+            std::lock_guard<std::mutex> lock(readaheadmutex);
+            pending.swap(readaheadinflight);
+        }
+        for (auto &kv : pending)
+        {
+            try
+            {
+                kv.second.get();
+            }
+            catch (...)
+            {
+            }
+        }
+    }
+
     // shuffle a vector into random order by randomly swapping elements
 
     template <typename VECTOR>
@@ -737,22 +810,46 @@ private:
         // We only need to test the chunk index. Utterance and frame can be randomized within a chunk as we want, as long it is in RAM.
     }
 
-    // big long helper to update all cached randomization information
-    // This is a rather complex process since we randomize on two levels:
-    //  - chunks of consecutive data in the feature archive
-    //  - within a range of chunks that is paged into RAM
-    //     - utterances (in utt mode), or
-    //     - frames (in frame mode)
-    // The 'globalts' parameter is the start time that triggered the rerandomization; it is NOT the base time of the randomized area.
-    size_t lazyrandomization(const size_t globalts)
+    // a fully computed chunk/utterance randomization for one sweep (see computesweepschedule())
+    // The iterators held by positionchunkwindows[] point into randomizedchunks[0]; moving the
+    // vectors preserves their heap buffers, so a schedule may be computed into one of these and
+    // installed into the members by moves without invalidating anything.
+    struct sweepschedule
     {
-        const size_t sweep = globalts / _totalframes; // which sweep (this determines randomization)
-        if (sweep == currentsweep)                    // already got this one--nothing to do
-            return sweep;
+        std::vector<std::vector<chunk>> randomizedchunks;
+        std::vector<positionchunkwindow> positionchunkwindows;          // (utterance mode only)
+        std::vector<utteranceref> randomizedutterancerefs;              // (utterance mode only)
+        std::unordered_map<size_t, size_t> randomizedutteranceposmap;   // (utterance mode only)
+    };
+    // schedule for an upcoming sweep, precomputed on a background thread while the current sweep
+    // is still being processed; installing it at the epoch transition is then just a few moves
+    std::future<std::shared_ptr<sweepschedule>> prefetchedschedule;
+    size_t prefetchedsweep; // sweep that prefetchedschedule is (being) computed for
+
+    // The schedule computation drives the process-wide C rand() from fixed seeds. A background
+    // precompute racing another source's seeded section (or the frame path below) would interleave
+    // the draws and perturb both schedules, so every seeded section serializes on this one lock;
+    // each section re-seeds at its start, which keeps its draws a pure function of the sweep.
+    static std::mutex &schedulerandlock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
 
-        currentsweep = sweep;
-        if (verbosity > 0)
-            fprintf(stderr, "lazyrandomization: re-randomizing for sweep %d in %s mode\n", (int) currentsweep, framemode ? "frame" : "utterance");
+    // compute the randomized chunk sequence (and, in utterance mode, the randomized utterance
+    // sequence) for one sweep. This is the expensive part of lazyrandomization() — minutes of
+    // single-threaded shuffling on corpora with millions of utterances — factored out so it can
+    // run on a background thread for the upcoming sweep. Reads only corpus layout fixed at
+    // construction (allchunks[] metadata, dimensions, randomization range).
+    std::shared_ptr<sweepschedule> computesweepschedule(const size_t sweep) const
+    {
+        std::lock_guard<std::mutex> randlock(schedulerandlock());
+
+        auto schedule = std::make_shared<sweepschedule>();
+        auto &randomizedchunks = schedule->randomizedchunks;
+        auto &positionchunkwindows = schedule->positionchunkwindows;
+        auto &randomizedutterancerefs = schedule->randomizedutterancerefs;
+        auto &randomizedutteranceposmap = schedule->randomizedutteranceposmap;
 
         const size_t sweepts = sweep * _totalframes; // first global frame index for this sweep
 
@@ -904,6 +1001,35 @@ private:
                 }
             }
 
+            // bucketing stage: group utterances of similar length within each randomized chunk.
+            // All utterance positions defined by one chunk share the same paging window, so the refs
+            // assigned to them may be permuted freely without violating the window constraints
+            // verified below. getbatch() packs consecutive positions into the parallel sequences of
+            // a minibatch, so ordering each chunk's positions by (quantized) length means utterances
+            // batched together have similar lengths, cutting the frames wasted on the padding/gap
+            // columns that the network must mask out. Lengths are quantized into buckets that grow
+            // by the configured tolerance, and the sort is stable, so the randomized order survives
+            // within each bucket and across chunk boundaries.
+            if (lengthbucketingtolerance > 0)
+            {
+                const double bucketwidth = log(1.0 + lengthbucketingtolerance);
+                foreach_index (k, randomizedchunks[0])
+                {
+                    chunk &chunk = randomizedchunks[0][k];
+                    auto lengthbucket = [&](const utteranceref &uttref)
+                    {
+                        const size_t n = randomizedchunks[0][uttref.chunkindex].getchunkdata().numframes(uttref.utteranceindex);
+                        return (int) (log((double) n) / bucketwidth);
+                    };
+                    std::stable_sort(randomizedutterancerefs.begin() + chunk.utteranceposbegin,
+                                     randomizedutterancerefs.begin() + chunk.utteranceposend(),
+                                     [&](const utteranceref &a, const utteranceref &b)
+                                     {
+                                         return lengthbucket(a) < lengthbucket(b);
+                                     });
+                }
+            }
+
             // place the randomized utterances on the global timeline so we can find them by globalts
             size_t t = sweepts;
             foreach_index (i, randomizedutterancerefs)
@@ -933,7 +1059,58 @@ private:
                 randomizedutteranceposmap[uttref.globalts] = (size_t) pos;
             }
         }
-        else // frame mode
+
+        return schedule;
+    }
+
+    // big long helper to update all cached randomization information
+    // This is a rather complex process since we randomize on two levels:
+    //  - chunks of consecutive data in the feature archive
+    //  - within a range of chunks that is paged into RAM
+    //     - utterances (in utt mode), or
+    //     - frames (in frame mode)
+    // The 'globalts' parameter is the start time that triggered the rerandomization; it is NOT the base time of the randomized area.
+    size_t lazyrandomization(const size_t globalts)
+    {
+        const size_t sweep = globalts / _totalframes; // which sweep (this determines randomization)
+        if (sweep == currentsweep)                    // already got this one--nothing to do
+            return sweep;
+
+        currentsweep = sweep;
+        if (verbosity > 0)
+            fprintf(stderr, "lazyrandomization: re-randomizing for sweep %d in %s mode\n", (int) currentsweep, framemode ? "frame" : "utterance");
+        if (numchunkpageins > 0 && verbosity > 0) // cumulative corpus re-read rate; 1.0 means every chunk was read exactly once
+            fprintf(stderr, "lazyrandomization: %d chunk page-ins over %d distinct chunks so far (re-read rate %.2f)\n",
+                    (int) numchunkpageins, (int) numdistinctchunkreads, numchunkpageins / (double) numdistinctchunkreads);
+        if (chunklastuse.size() != allchunks[0].size()) // (first sweep)
+        {
+            chunklastuse.assign(allchunks[0].size(), 0);
+            chunkeverread.assign(allchunks[0].size(), 0);
+        }
+
+        // background readahead reads reference randomizedchunks[], which we are about to rebuild
+        drainreadahead();
+
+        const size_t sweepts = sweep * _totalframes; // first global frame index for this sweep
+
+        // obtain this sweep's schedule: normally it was already precomputed on a background thread
+        // while the previous sweep was still being processed, and installing it costs only a few
+        // moves; on the first sweep, or after jumping to a non-consecutive epoch, compute it here
+        std::shared_ptr<sweepschedule> schedule;
+        if (prefetchedschedule.valid() && prefetchedsweep == sweep)
+            schedule = prefetchedschedule.get();
+        else
+        {
+            if (prefetchedschedule.valid())
+                prefetchedschedule.get(); // was computed for another sweep (e.g. restarted from a checkpoint); discard
+            schedule = computesweepschedule(sweep);
+        }
+        randomizedchunks = std::move(schedule->randomizedchunks);
+        positionchunkwindows = std::move(schedule->positionchunkwindows);
+        randomizedutterancerefs = std::move(schedule->randomizedutterancerefs);
+        randomizedutteranceposmap = std::move(schedule->randomizedutteranceposmap);
+
+        if (framemode) // frame mode: frame randomization is layered over the chunk schedule installed above
         {
             // This sets up the following members:
             //  - randomizedframerefs
@@ -942,6 +1119,7 @@ private:
             if (randomizedframerefs.size() != _totalframes)
                 randomizedframerefs.resize(_totalframes);
 
+            std::lock_guard<std::mutex> randlock(schedulerandlock()); // a schedule precompute may be driving rand() concurrently
             srand((unsigned int) sweep + 1);
             // An original timeline is established by the randomized chunks, denoted by 't'.
             // Returned frames are indexed by frame position j = (globalt - sweept), which have an associated underlying 't'.
@@ -1054,12 +1232,211 @@ private:
             assert(t == _totalframes);
         }
 
+        // kick off the next sweep's schedule on a background thread; sweeps are consumed
+        // consecutively, so it is ready by the time the next epoch transition asks for it
+        const size_t nextsweep = sweep + 1;
+        prefetchedsweep = nextsweep;
+        prefetchedschedule = std::async(std::launch::async, [this, nextsweep]
+                                        {
+                                            return computesweepschedule(nextsweep);
+                                        });
+
         return sweep;
     }
 
+    // estimated RAM use of randomized chunk k once paged in, summed over all feature streams
+    size_t chunkbytes(size_t k) const
+    {
+        size_t bytes = 0;
+        foreach_index (m, randomizedchunks)
+            bytes += randomizedchunks[m][k].getchunkdata().totalframes * featdim[m] * sizeof(float);
+        return bytes;
+    }
+
+    // wait for a pending background read of randomized chunk k, if any (readahead support)
+    // Returns true if a background read completed successfully, i.e. the chunk is now resident
+    // without us having issued a synchronous read. A failed background read is swallowed here;
+    // the caller will simply fall back to the synchronous path (which retries).
+    bool completereadahead(size_t k)
+    {
+        std::shared_future<void> pending;
+        {
+            std::lock_guard<std::mutex> lock(readaheadmutex);
+            auto iter = readaheadinflight.find(k);
+            if (iter == readaheadinflight.end())
+                return false;
+            pending = iter->second;
+        }
+        bool succeeded = true;
+        try
+        {
+            pending.get();
+        }
+        catch (const std::exception &e)
+        {
+            fprintf(stderr, "completereadahead: background read of chunk %d failed: %s\n", (int) k, e.what());
+            succeeded = false;
+        }
+        std::lock_guard<std::mutex> lock(readaheadmutex);
+        readaheadinflight.erase(k);
+        return succeeded;
+    }
+
+    // schedule background reads for upcoming chunks (those that will enter the paging window next)
+    // The readahead horizon is the run of chunks at/after 'windowend' (for this MPI subset) whose
+    // cumulative size fits the RAM budget; within it we kick off up to 'readaheadthreads' reads for
+    // chunks that are neither resident nor already in flight. releaseahead() below uses the same
+    // horizon definition, so prefetched chunks survive the regular paging housekeeping until visited.
+    void schedulereadahead(const size_t windowend, const size_t subsetnum, const size_t numsubsets)
+    {
+        if (readaheadbudget == 0)
+            return;
+        foreach_index (m, randomizedchunks) // feature info is lazily filled in by the very first read--wait for that
+            if (featdim[m] == 0)
+                return;
+        size_t numinflight;
+        {
+            std::lock_guard<std::mutex> lock(readaheadmutex);
+            numinflight = readaheadinflight.size();
+        }
+        size_t bytesahead = 0;
+        for (size_t k = windowend; k < randomizedchunks[0].size(); k++)
+        {
+            if ((k % numsubsets) != subsetnum) // in MPI mode, we skip chunks this way
+                continue;
+            if (bytesahead + chunkbytes(k) > readaheadbudget) // horizon ends where the budget runs out
+                break;
+            bytesahead += chunkbytes(k);
+            bool inflight;
+            {
+                std::lock_guard<std::mutex> lock(readaheadmutex);
+                inflight = readaheadinflight.find(k) != readaheadinflight.end();
+            }
+            if (inflight || randomizedchunks[0][k].getchunkdata().isinram()) // (isinram() only checked when no worker can be touching the chunk)
+                continue;
+            if (numinflight >= readaheadthreads)
+                continue;
+            std::lock_guard<std::mutex> lock(readaheadmutex);
+            readaheadinflight[k] = std::async(std::launch::async, [this, k]()
+                                              {
+                                                  foreach_index (m, randomizedchunks)
+                                                  {
+                                                      auto &chunkdata = randomizedchunks[m][k].getchunkdata();
+                                                      msra::util::attempt(5, [&]() // (reading from network)
+                                                                          {
+                                                                              chunkdata.requiredata(featkind[m], featdim[m], sampperiod[m], this->lattices);
+                                                                          });
+                                                  }
+                                                  // note: 'chunksinram' is bumped by the main thread when it picks the chunk up
+                                              }).share();
+            numinflight++;
+        }
+    }
+
+    // unpin all chunks ahead of the window, sparing those inside the readahead horizon
+    // Without readahead and cache budget this is plain paging-out of everything at/after
+    // 'windowend'; with them, the prefetched run of upcoming chunks stays resident, and chunks
+    // beyond it remain cached until enforcecachebudget() needs their RAM back.
+    void releaseahead(const size_t windowend, const size_t subsetnum, const size_t numsubsets)
+    {
+        size_t bytesahead = 0;
+        for (size_t k = windowend; k < randomizedchunks[0].size(); k++)
+        {
+            if (readaheadbudget > 0 && (k % numsubsets) == subsetnum && bytesahead + chunkbytes(k) <= readaheadbudget)
+            {
+                bytesahead += chunkbytes(k); // inside the readahead horizon--keep it resident
+                continue;
+            }
+            unpinrandomizedchunk(k);
+        }
+    }
+
+    // original (pre-randomization) index of randomized chunk k; stable across sweeps, which is what
+    // the cache bookkeeping must be keyed by since a resident chunk outlives the sweep's ordering
+    size_t originalchunkindex(size_t k) const
+    {
+        return (size_t) (randomizedchunks[0][k].uttchunkdata - allchunks[0].begin());
+    }
+
+    // re-read statistics: account for a page-in of randomized chunk k, wherever the read happened
+    void countpagein(size_t k)
+    {
+        numchunkpageins++;
+        const size_t orig = originalchunkindex(k);
+        if (orig < chunkeverread.size() && !chunkeverread[orig])
+        {
+            chunkeverread[orig] = 1;
+            numdistinctchunkreads++;
+        }
+    }
+
+    // the window has moved past randomized chunk k: page it out, or, with a cache budget, merely
+    // leave it resident for enforcecachebudget() to evict oldest-use-first when RAM runs short
+    void unpinrandomizedchunk(size_t k)
+    {
+        if (chunkcachebudget == 0)
+            releaserandomizedchunk(k);
+    }
+
+    // generational eviction: page out resident chunks outside the window and the readahead horizon,
+    // oldest last use first, until the remaining ones fit the cache budget
+    void enforcecachebudget(const size_t windowbegin, const size_t windowend, const size_t subsetnum, const size_t numsubsets)
+    {
+        if (chunkcachebudget == 0)
+            return;
+        // determine the pinned set: the current window plus the readahead horizon (same definition as releaseahead())
+        std::vector<char> pinned(randomizedchunks[0].size(), 0);
+        for (size_t k = windowbegin; k < windowend && k < randomizedchunks[0].size(); k++)
+            pinned[k] = 1;
+        size_t bytesahead = 0;
+        for (size_t k = windowend; k < randomizedchunks[0].size(); k++)
+        {
+            if ((k % numsubsets) != subsetnum)
+                continue;
+            if (bytesahead + chunkbytes(k) > readaheadbudget)
+                break;
+            bytesahead += chunkbytes(k);
+            pinned[k] = 1;
+        }
+        // collect the resident unpinned chunks; only they count against the budget
+        std::vector<std::pair<size_t, size_t>> evictable; // (generation of last use, randomized chunk index)
+        size_t unpinnedbytes = 0;
+        foreach_index (k, randomizedchunks[0])
+        {
+            if (pinned[k])
+                continue;
+            {
+                std::lock_guard<std::mutex> lock(readaheadmutex); // isinram() must not race with a background read
+                if (readaheadinflight.find(k) != readaheadinflight.end())
+                    continue; // a stale background read; leave it for a later pass (or the window) to pick up
+            }
+            if (!randomizedchunks[0][k].getchunkdata().isinram())
+                continue;
+            unpinnedbytes += chunkbytes(k);
+            evictable.push_back(std::make_pair(chunklastuse[originalchunkindex(k)], (size_t) k));
+        }
+        if (unpinnedbytes <= chunkcachebudget)
+            return;
+        std::sort(evictable.begin(), evictable.end()); // oldest generation first
+        for (const auto &e : evictable)
+        {
+            if (unpinnedbytes <= chunkcachebudget)
+                break;
+            unpinnedbytes -= chunkbytes(e.second);
+            releaserandomizedchunk(e.second);
+        }
+    }
+
     // helper to page out a chunk with log message
     void releaserandomizedchunk(size_t k)
     {
+        // let a pending background read of this chunk finish first (it writes into the chunk data)
+        if (completereadahead(k))
+        {
+            chunksinram++; // (was paged in behind our back; the loop below will page it right back out)
+            countpagein(k);
+        }
+
         size_t numreleased = 0;
         foreach_index (m, randomizedchunks)
         {
@@ -1094,6 +1471,16 @@ private:
         if (chunkindex < windowbegin || chunkindex >= windowend)
             LogicError("requirerandomizedchunk: requested utterance outside in-memory chunk range");
 
+        if (originalchunkindex(chunkindex) < chunklastuse.size())
+            chunklastuse[originalchunkindex(chunkindex)] = ++cachegeneration; // stamp for the generational eviction
+
+        // pick up the chunk from the background readahead if it has been (or is being) prefetched
+        if (completereadahead(chunkindex))
+        {
+            chunksinram++; // the background read paged it in; the check below will now find it resident
+            countpagein(chunkindex);
+        }
+
         foreach_index (m, randomizedchunks)
         {
             auto &chunk = randomizedchunks[m][chunkindex];
@@ -1117,6 +1504,7 @@ private:
                                     });
             }
             chunksinram++;
+            countpagein(chunkindex);
             return true;
         }
         else
@@ -1164,6 +1552,36 @@ public:
         verbosity = newverbosity;
     }
 
+    // setchunkreadahead - enable background prefetching of upcoming chunks
+    // rambudget - bytes of RAM that chunks prefetched ahead of the paging window may occupy (0 disables readahead)
+    // numthreads - number of chunks to read concurrently in the background
+    // In lattice (MMI) mode this prefetches the chunk's lattices along with its features;
+    // the lattice archive serializes its reads internally, so extra threads mainly help features.
+    void setchunkreadahead(size_t rambudget, size_t numthreads)
+    {
+        readaheadbudget = rambudget;
+        readaheadthreads = max(numthreads, (size_t) 1);
+    }
+
+    // setchunkcachebudget - keep chunks cached beyond the paging window
+    // rambudget - bytes of RAM that resident chunks outside the window and readahead horizon may
+    //             keep occupying; they are evicted oldest-use-first only once this is exceeded
+    //             (0 restores immediate page-out). Randomization windows of successive sweeps
+    //             overlap in chunk content, so cached chunks cut the corpus re-read rate, which is
+    //             reported once per sweep.
+    void setchunkcachebudget(size_t rambudget)
+    {
+        chunkcachebudget = rambudget;
+    }
+
+    // setlengthbucketing - group utterances of similar length when randomizing (utterance mode only)
+    // tolerance - relative length difference tolerated within a bucket, e.g. 0.3 buckets together
+    //             utterances whose lengths differ by up to ~30%; 0 disables bucketing
+    void setlengthbucketing(double tolerance)
+    {
+        lengthbucketingtolerance = tolerance;
+    }
+
     // get the next minibatch
     // A minibatch is made up of one or more utterances.
     // We will return less than 'framesrequested' unless the first utterance is too long.
@@ -1215,9 +1633,8 @@ public:
             const size_t windowbegin = positionchunkwindows[spos].windowbegin();
             const size_t windowend = positionchunkwindows[epos - 1].windowend();
             for (size_t k = 0; k < windowbegin; k++)
-                releaserandomizedchunk(k);
-            for (size_t k = windowend; k < randomizedchunks[0].size(); k++)
-                releaserandomizedchunk(k);
+                unpinrandomizedchunk(k);
+            releaseahead(windowend, subsetnum, numsubsets); // unpin chunks ahead of the window (sparing the readahead horizon)
             for (size_t pos = spos; pos < epos; pos++)
                 if ((randomizedutterancerefs[pos].chunkindex % numsubsets) == subsetnum)
                     readfromdisk |= requirerandomizedchunk(randomizedutterancerefs[pos].chunkindex, windowbegin, windowend); // (window range passed in for checking only)
@@ -1225,6 +1642,10 @@ public:
             // Note that the above loop loops over all chunks incl. those that we already should have.
             // This has an effect, e.g., if 'numsubsets' has changed (we will fill gaps).
 
+            // kick off background reads for chunks that will enter the window next
+            schedulereadahead(windowend, subsetnum, numsubsets);
+            enforcecachebudget(windowbegin, windowend, subsetnum, numsubsets); // evict cached chunks oldest-first if over the RAM budget
+
             // determine the true #frames we return, for allocation--it is less than mbframes in the case of MPI/data-parallel sub-set mode
             size_t tspos = 0;
             for (size_t pos = spos; pos < epos; pos++)
@@ -1365,14 +1786,17 @@ public:
             if (verbosity > 0)
                 fprintf(stderr, "getbatch: getting randomized frames [%d..%d] (%d frames out of %d requested) in sweep %d; chunks [%d..%d] -> chunk window [%d..%d)\n",
                         (int) globalts, (int) globalte, (int) mbframes, (int) framesrequested, (int) sweep, (int) firstchunk, (int) lastchunk, (int) windowbegin, (int) windowend);
-            // release all data outside, and page in all data inside
+            // unpin all data outside, and page in all data inside
             for (size_t k = 0; k < windowbegin; k++)
-                releaserandomizedchunk(k);
+                unpinrandomizedchunk(k);
             for (size_t k = windowbegin; k < windowend; k++)
                 if ((k % numsubsets) == subsetnum)                                     // in MPI mode, we skip chunks this way
                     readfromdisk |= requirerandomizedchunk(k, windowbegin, windowend); // (window range passed in for checking only, redundant here)
-            for (size_t k = windowend; k < randomizedchunks[0].size(); k++)
-                releaserandomizedchunk(k);
+            releaseahead(windowend, subsetnum, numsubsets); // unpin chunks ahead of the window (sparing the readahead horizon)
+
+            // kick off background reads for chunks that will enter the window next
+            schedulereadahead(windowend, subsetnum, numsubsets);
+            enforcecachebudget(windowbegin, windowend, subsetnum, numsubsets); // evict cached chunks oldest-first if over the RAM budget
 
             // determine the true #frames we return--it is less than mbframes in the case of MPI/data-parallel sub-set mode
             // First determine it for all nodes, then pick the min over all nodes, as to give all the same #frames for better load balancing.
@@ -1412,20 +1836,44 @@ public:
             }
 
             // return randomized frames for the time range of those utterances
-            size_t currmpinodeframecount = 0;
-            for (size_t j = 0; j < mbframes; j++)
+            // Gather this node's frame refs first, then sort them by location within the chunk window.
+            // Frame order within a frame-mode minibatch carries no meaning (each column is an independent
+            // sample, and uids[] are permuted identically), while visiting the chunk data in storage order
+            // turns the assembly from a random gather over the chunk cache into a mostly sequential sweep,
+            // with runs of consecutive frames coalesced into single memcpy()s below.
+            std::vector<frameref> batchrefs;
+            batchrefs.reserve(feat[0].cols());
+            for (size_t pos = 0; pos < mbframes && batchrefs.size() < feat[0].cols(); pos++) // (cap: MPI/data-parallel mode; all nodes return the same #frames, which is how feat(,) is allocated)
             {
-                if (currmpinodeframecount >= feat[0].cols()) // MPI/data-parallel mode: all nodes return the same #frames, which is how feat(,) is allocated
-                    break;
-
                 // map to time index inside arrays
-                const size_t framepos = (globalts + j) % _totalframes; // using mod because we may actually run beyond the sweep for the last call
+                const size_t framepos = (globalts + pos) % _totalframes; // using mod because we may actually run beyond the sweep for the last call
                 const frameref &frameref = randomizedframerefs[framepos];
 
                 // in MPI/data-parallel mode, skip frames that are not in chunks loaded for this MPI node
                 if ((frameref.chunkindex % numsubsets) != subsetnum)
                     continue;
 
+                batchrefs.push_back(frameref);
+            }
+            std::sort(batchrefs.begin(), batchrefs.end(), [](const frameref &a, const frameref &b)
+                      {
+                          if (a.chunkindex != b.chunkindex)
+                              return a.chunkindex < b.chunkindex;
+                          if (a.utteranceindex != b.utteranceindex)
+                              return a.utteranceindex < b.utteranceindex;
+                          return a.frameindex < b.frameindex;
+                      });
+
+            size_t currmpinodeframecount = 0;
+            for (size_t r0 = 0; r0 < batchrefs.size();)
+            {
+                const frameref &frameref = batchrefs[r0];
+
+                // maximal run of consecutive frames of the same utterance; these are contiguous columns in the chunk
+                size_t r1 = r0 + 1;
+                while (r1 < batchrefs.size() && batchrefs[r1].chunkindex == frameref.chunkindex && batchrefs[r1].utteranceindex == frameref.utteranceindex && batchrefs[r1].frameindex == batchrefs[r1 - 1].frameindex + 1)
+                    r1++;
+
                 // random utterance
                 readfromdisk |= requirerandomizedchunk(frameref.chunkindex, windowbegin, windowend); // (this is just a check; should not actually page in anything)
 
@@ -1439,31 +1887,42 @@ public:
                     assert(n == uttframes.cols() && chunkdata.numframes(frameref.utteranceindex) == n);
                     n;
 
-                    // copy frame and class labels
-                    const size_t t = frameref.frameindex;
-
                     size_t leftextent, rightextent;
                     // page in the needed range of frames
                     if (leftcontext[i] == 0 && rightcontext[i] == 0)
                     {
-                        leftextent = rightextent = augmentationextent(uttframevectors[t].size(), vdim[i]);
+                        leftextent = rightextent = augmentationextent(uttframevectors[frameref.frameindex].size(), vdim[i]);
                     }
                     else
                     {
                         leftextent = leftcontext[i];
                         rightextent = rightcontext[i];
                     }
-                    augmentneighbors(uttframevectors, noboundaryflags, t, leftextent, rightextent, feat[i], currmpinodeframecount);
+                    if (leftextent == 0 && rightextent == 0 && uttframes.getcolstride() == feat[i].getcolstride())
+                    {
+                        // no neighbor expansion: the whole run is one contiguous block of columns in the chunk
+                        memcpy(&feat[i](0, currmpinodeframecount), &uttframes(0, frameref.frameindex), (r1 - r0) * uttframes.getcolstride() * sizeof(float));
+                    }
+                    else
+                    {
+                        for (size_t r = r0; r < r1; r++)
+                            augmentneighbors(uttframevectors, noboundaryflags, batchrefs[r].frameindex, leftextent, rightextent, feat[i], currmpinodeframecount + (r - r0));
+                    }
 
+                    // copy class labels
                     if (issupervised() && i == 0)
                     {
-                        auto frameclassids = getclassids(frameref);
-                        foreach_index (k, uids)
-                            uids[k][currmpinodeframecount] = frameclassids[k][t];
+                        for (size_t r = r0; r < r1; r++)
+                        {
+                            auto frameclassids = getclassids(batchrefs[r]);
+                            foreach_index (k, uids)
+                                uids[k][currmpinodeframecount + (r - r0)] = frameclassids[k][batchrefs[r].frameindex];
+                        }
                     }
                 }
 
-                currmpinodeframecount++;
+                currmpinodeframecount += r1 - r0;
+                r0 = r1;
             }
         }
         timegetbatch = timergetbatch;
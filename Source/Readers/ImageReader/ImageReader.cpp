@@ -343,7 +343,7 @@ private:
 // ImageReader
 
 template <class ElemType>
-static void CopyFromImage(const cv::Mat& src, std::vector<ElemType>& dst, size_t ivDst, bool transpose);
+static void CopyFromImage(const cv::Mat& src, ElemType* dst, size_t ivDst, bool transpose);
 
 static std::launch GetLaunchPolicy(bool prefetch)
 {
@@ -352,8 +352,10 @@ static std::launch GetLaunchPolicy(bool prefetch)
 
 template <class ElemType>
 ImageReader<ElemType>::ImageReader()
-    : m_seed(0), m_rng(m_seed), m_imgListRand(true), m_pMBLayout(make_shared<MBLayout>()), m_mbFmt(DataFormat::NCHW)
+    : m_seed(0), m_rng(m_seed), m_imgListRand(true), m_pMBLayout(make_shared<MBLayout>()), m_mbFmt(DataFormat::NCHW), m_curBuf(0), m_matrixDeviceId(-1)
 {
+    m_bufSize.fill(0);
+    m_bufDeviceId.fill(-1);
     m_transforms.push_back(std::make_unique<CropTransform>(m_seed));
     m_transforms.push_back(std::make_unique<ScaleTransform>(sizeof(ElemType) == 4 ? CV_32F : CV_64F, m_seed));
     m_transforms.push_back(std::make_unique<MeanTransform>());
@@ -470,11 +472,11 @@ void ImageReader<ElemType>::StartDistributedMinibatchLoop(size_t mbSize, size_t
         m_mbStart = 0;
     }
 
-    m_featBuf.resize(m_mbSize * m_featDim);
-    m_labBuf.resize(m_mbSize * m_labDim);
-    m_mbPrefetchFut = std::async(GetLaunchPolicy(m_prefetch), [this]()
+    EnsureStagingBuffer(m_curBuf);
+    size_t fillBuf = m_curBuf;
+    m_mbPrefetchFut = std::async(GetLaunchPolicy(m_prefetch), [this, fillBuf]()
                                  {
-                                     return ReadImages();
+                                     return ReadImages(fillBuf);
                                  });
 }
 
@@ -491,19 +493,26 @@ bool ImageReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<ElemType>
         return false;
 
     Matrix<ElemType>& features = *matrices[m_featName];
-    features.SetValue(m_featDim, mbSize, features.GetDeviceId(), m_featBuf.data(), matrixFlagNormal);
+    m_matrixDeviceId = features.GetDeviceId();
+
+    // Hand the filled slot to the matrices and start decoding the next minibatch into
+    // the other slot right away, so image decode overlaps with the upload to the GPU.
+    size_t filledBuf = m_curBuf;
+    m_curBuf = (m_curBuf + 1) % c_numStagingBufs;
+    EnsureStagingBuffer(m_curBuf);
+    size_t fillBuf = m_curBuf;
+    m_mbPrefetchFut = std::async(GetLaunchPolicy(m_prefetch), [this, fillBuf]()
+                                 {
+                                     return ReadImages(fillBuf);
+                                 });
+
+    features.SetValue(m_featDim, mbSize, features.GetDeviceId(), m_featBuf[filledBuf].get(), matrixFlagNormal);
 
     Matrix<ElemType>& labels = *matrices[m_labName];
-    labels.SetValue(m_labDim, mbSize, labels.GetDeviceId(), m_labBuf.data(), matrixFlagNormal);
+    labels.SetValue(m_labDim, mbSize, labels.GetDeviceId(), m_labBuf[filledBuf].get(), matrixFlagNormal);
 
     m_pMBLayout->InitAsFrameMode(mbSize);
 
-    // It is safe to run prefetching with just one buffer as SetValue is synchronous so there will be no race.
-    m_mbPrefetchFut = std::async(GetLaunchPolicy(m_prefetch), [this]()
-                                 {
-                                     return ReadImages();
-                                 });
-
     return true;
 }
 
@@ -536,8 +545,55 @@ void ImageReader<ElemType>::SetRandomSeed(unsigned int seed)
     m_rng.seed(m_seed);
 }
 
+// GetCUDAAllocator/EnsureStagingBuffer - staging buffer management. Buffers live in
+// page-locked memory when the input matrices are on a GPU so the DMA engine can copy
+// them without an intermediate staging pass; on CPU devices plain heap memory is used.
+template <class ElemType>
+std::unique_ptr<CUDAPageLockedMemAllocator>& ImageReader<ElemType>::GetCUDAAllocator(int deviceID)
+{
+    if (m_cudaAllocator != nullptr && m_cudaAllocator->GetDeviceId() != deviceID)
+        m_cudaAllocator.reset(nullptr);
+
+    if (m_cudaAllocator == nullptr)
+        m_cudaAllocator.reset(new CUDAPageLockedMemAllocator(deviceID));
+
+    return m_cudaAllocator;
+}
+
+template <class ElemType>
+std::shared_ptr<ElemType> ImageReader<ElemType>::AllocateIntermediateBuffer(int deviceID, size_t numElements)
+{
+    if (deviceID >= 0)
+    {
+        return std::shared_ptr<ElemType>((ElemType*) GetCUDAAllocator(deviceID)->Malloc(sizeof(ElemType) * numElements),
+                                         [this, deviceID](ElemType* p)
+                                         {
+                                             this->GetCUDAAllocator(deviceID)->Free((char*) p);
+                                         });
+    }
+    else
+    {
+        return std::shared_ptr<ElemType>(new ElemType[numElements], [](ElemType* p)
+                                         {
+                                             delete[] p;
+                                         });
+    }
+}
+
+template <class ElemType>
+void ImageReader<ElemType>::EnsureStagingBuffer(size_t bufIndex)
+{
+    if (m_bufSize[bufIndex] >= m_mbSize && m_bufDeviceId[bufIndex] == m_matrixDeviceId)
+        return;
+
+    m_featBuf[bufIndex] = AllocateIntermediateBuffer(m_matrixDeviceId, m_mbSize * m_featDim);
+    m_labBuf[bufIndex] = AllocateIntermediateBuffer(m_matrixDeviceId, m_mbSize * m_labDim);
+    m_bufSize[bufIndex] = m_mbSize;
+    m_bufDeviceId[bufIndex] = m_matrixDeviceId;
+}
+
 template <class ElemType>
-size_t ImageReader<ElemType>::ReadImages()
+size_t ImageReader<ElemType>::ReadImages(size_t bufIndex)
 {
     if (m_mbStart >= m_files.size() || m_mbStart >= m_epochStart + m_epochSize)
         return 0;
@@ -546,7 +602,9 @@ size_t ImageReader<ElemType>::ReadImages()
     if (mbLim > m_files.size())
         mbLim = m_files.size();
 
-    std::fill(m_labBuf.begin(), m_labBuf.end(), static_cast<ElemType>(0));
+    ElemType* featBuf = m_featBuf[bufIndex].get();
+    ElemType* labBuf = m_labBuf[bufIndex].get();
+    std::fill(labBuf, labBuf + m_mbSize * m_labDim, static_cast<ElemType>(0));
 
     size_t actualMBSize = mbLim - m_mbStart;
     size_t iStart = actualMBSize * m_subsetNum / m_numSubsets;
@@ -566,8 +624,8 @@ size_t ImageReader<ElemType>::ReadImages()
         assert(img.rows * img.cols * img.channels() == m_featDim);
         // When IMREAD_COLOR is used, OpenCV stores image in BGR format.
         // Transpose is required if requested mini-batch format is NCHW.
-        CopyFromImage(img, m_featBuf, m_featDim * i, m_mbFmt == DataFormat::NCHW);
-        m_labBuf[m_labDim * i + p.second] = 1;
+        CopyFromImage(img, featBuf, m_featDim * i, m_mbFmt == DataFormat::NCHW);
+        labBuf[m_labDim * i + p.second] = 1;
     }
 
     m_mbStart += actualMBSize;
@@ -578,17 +636,16 @@ template class ImageReader<double>;
 template class ImageReader<float>;
 
 template <class ElemType>
-static void CopyFromImage(const cv::Mat& src, std::vector<ElemType>& dst, size_t ivDst, bool transpose)
+static void CopyFromImage(const cv::Mat& src, ElemType* dst, size_t ivDst, bool transpose)
 {
     assert(src.isContinuous());
     assert(src.channels() == 3);
 
     size_t count = src.rows * src.cols * src.channels();
-    assert(ivDst + count <= dst.size());
 
     auto data = reinterpret_cast<const ElemType*>(src.ptr());
     if (!transpose)
-        std::copy(data, data + count, dst.begin() + ivDst);
+        std::copy(data, data + count, dst + ivDst);
     else
     {
         size_t crow = src.rows * src.cols;
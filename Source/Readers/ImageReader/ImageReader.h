@@ -7,6 +7,7 @@
 
 #include "Basics.h"
 #include "DataReader.h"
+#include "CUDAPageLockedMemAllocator.h"
 #include <random>
 #include <memory>
 #include <future>
@@ -105,8 +106,18 @@ private:
 
     bool m_prefetch;
     std::future<size_t> m_mbPrefetchFut;
-    std::vector<ElemType> m_featBuf;
-    std::vector<ElemType> m_labBuf;
+
+    // Ring of staging buffers: the prefetch task decodes the next minibatch into one
+    // slot while the previous one is uploaded into the input matrices. Buffers are
+    // page-locked once the target GPU is known, for faster host-to-device copies.
+    static const size_t c_numStagingBufs = 2;
+    std::array<std::shared_ptr<ElemType>, c_numStagingBufs> m_featBuf;
+    std::array<std::shared_ptr<ElemType>, c_numStagingBufs> m_labBuf;
+    std::array<size_t, c_numStagingBufs> m_bufSize;   // per-slot capacity in samples
+    std::array<int, c_numStagingBufs> m_bufDeviceId;  // device each slot was allocated for
+    size_t m_curBuf;                                  // slot the prefetch task fills next
+    int m_matrixDeviceId;                             // device of the input matrices (-1 until first GetMinibatch)
+    std::unique_ptr<CUDAPageLockedMemAllocator> m_cudaAllocator;
 
     bool m_imgListRand;
 
@@ -114,6 +125,9 @@ private:
     DataFormat m_mbFmt;
 
 private:
-    size_t ReadImages();
+    size_t ReadImages(size_t bufIndex);
+    void EnsureStagingBuffer(size_t bufIndex);
+    std::unique_ptr<CUDAPageLockedMemAllocator>& GetCUDAAllocator(int deviceID);
+    std::shared_ptr<ElemType> AllocateIntermediateBuffer(int deviceID, size_t numElements);
 };
 } } }
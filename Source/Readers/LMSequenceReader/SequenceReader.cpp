@@ -58,24 +58,31 @@ size_t SequenceReader<ElemType>::RecordsToRead(size_t mbStartSample, bool tail)
 template <class ElemType>
 typename IDataReader<ElemType>::LabelIdType SequenceReader<ElemType>::GetIdFromLabel(const std::string& labelValue, LabelInfo& labelInfo)
 {
-    auto found = labelInfo.mapLabelToId.find(labelValue);
-    string unk = this->mUnk;
-    // not yet found, add to the map
-    if (found == labelInfo.mapLabelToId.end())
-    {
-        found = labelInfo.mapLabelToId.find(unk);
-        if (found == labelInfo.mapLabelToId.end())
-            RuntimeError("%s not in vocabulary", labelValue.c_str());
-    }
-    return found->second;
+    // the hash index shadows mapLabelToId; rebuild it when the map's generation
+    // moved past the one the index was built from (vocabulary load and
+    // SetLabelMapping bump the generation whenever they repopulate the map)
+    if (labelInfo.vocabIndex.Generation() != labelInfo.mapGeneration)
+        labelInfo.vocabIndex.Build(labelInfo.mapLabelToId, labelInfo.mapGeneration);
+
+    LabelIdType labelId;
+    if (labelInfo.vocabIndex.Find(labelValue, labelId))
+        return labelId;
+
+    // not found, fall back to the unknown-word token
+    if (!labelInfo.vocabIndex.Find(this->mUnk, labelId))
+        RuntimeError("%s not in vocabulary", labelValue.c_str());
+    return labelId;
 }
 
 template <class ElemType>
 bool SequenceReader<ElemType>::CheckIdFromLabel(const std::string& labelValue, const LabelInfo& labelInfo, unsigned& labelId)
 {
-    auto found = labelInfo.mapLabelToId.find(labelValue);
+    // use the hash index when it is in sync with the map; this overload takes a
+    // const LabelInfo and thus may not rebuild it
+    if (labelInfo.vocabIndex.Generation() == labelInfo.mapGeneration)
+        return labelInfo.vocabIndex.Find(labelValue, labelId);
 
-    // not yet found, add to the map
+    auto found = labelInfo.mapLabelToId.find(labelValue);
     if (found == labelInfo.mapLabelToId.end())
     {
         return false;
@@ -497,6 +504,7 @@ void SequenceReader<ElemType>::InitFromConfig(const ConfigRecordType& readerConf
                     m_labelInfo[index].mapIdToLabel[i] = label;
                     m_labelInfo[index].mapLabelToId[label] = i;
                 }
+                m_labelInfo[index].mapGeneration++;
                 m_labelInfo[index].idMax = (LabelIdType) arrayLabels.size();
                 m_labelInfo[index].mapName = labelPath;
             }
@@ -520,6 +528,7 @@ void SequenceReader<ElemType>::InitFromConfig(const ConfigRecordType& readerConf
                         m_labelInfo[index].mapIdToLabel[i] = label;
                         m_labelInfo[index].mapLabelToId[label] = i;
                     }
+                    m_labelInfo[index].mapGeneration++;
                     m_labelInfo[index].idMax = (LabelIdType)(iMax + 1);
                 }
                 m_labelInfo[index].mapName = labelPath;
@@ -1004,8 +1013,13 @@ void SequenceReader<ElemType>::GetLabelOutput(std::map<std::wstring, Matrix<Elem
     if (labels == nullptr)
         return;
 
+    // draw all noise samples for the minibatch up front in one pass over the alias table
+    std::vector<int> noiseSamples;
     if (readerMode == ReaderMode::NCE)
+    {
         labels->Resize(2 * (this->noise_sample_size + 1), actualmbsize);
+        m_noiseSampler.sample(this->noise_sample_size * actualmbsize, noiseSamples);
+    }
     else if (readerMode == ReaderMode::Class)
         labels->Resize(4, actualmbsize);
     else if (readerMode == ReaderMode::Softmax)
@@ -1023,7 +1037,7 @@ void SequenceReader<ElemType>::GetLabelOutput(std::map<std::wstring, Matrix<Elem
             labels->SetValue(1, j, (ElemType) m_noiseSampler.logprob(wrd));
             for (size_t noiseid = 0; noiseid < this->noise_sample_size; noiseid++)
             {
-                int wid = m_noiseSampler.sample();
+                int wid = noiseSamples[j * this->noise_sample_size + noiseid];
                 labels->SetValue(2 * (noiseid + 1), j, (ElemType) wid);
                 labels->SetValue(2 * (noiseid + 1) + 1, j, -(ElemType) m_noiseSampler.logprob(wid));
             }
@@ -1339,6 +1353,7 @@ void SequenceReader<ElemType>::SetLabelMapping(const std::wstring& /*sectionName
     {
         labelInfo.mapLabelToId[var.second] = var.first;
     }
+    labelInfo.mapGeneration++;
 }
 
 // GetData - Gets metadata from the specified section (into CPU memory)
@@ -1473,6 +1488,7 @@ void BatchSequenceReader<ElemType>::InitFromConfig(const ConfigRecordType& reade
                     m_labelInfo[index].mapIdToLabel[i] = label;
                     m_labelInfo[index].mapLabelToId[label] = i;
                 }
+                m_labelInfo[index].mapGeneration++;
                 m_labelInfo[index].idMax = (LabelIdType) arrayLabels.size();
                 m_labelInfo[index].mapName = labelPath;
             }
@@ -1501,6 +1517,7 @@ void BatchSequenceReader<ElemType>::InitFromConfig(const ConfigRecordType& reade
                         m_labelInfo[index].mapIdToLabel[i] = label;
                         m_labelInfo[index].mapLabelToId[label] = i;
                     }
+                    m_labelInfo[index].mapGeneration++;
                     m_labelInfo[index].idMax = (LabelIdType)(iMax + 1);
                 }
                 m_labelInfo[index].mapName = labelPath;
@@ -1735,6 +1752,37 @@ size_t BatchSequenceReader<ElemType>::FindNextSentences(size_t numRead)
     return sln;
 }
 
+// BuildLabelTempIds - convert the whole parsed token window into label ids in one pass
+// labelIn - input label description (must be a category label for the fast path)
+// labelInfo - output label description
+// nextWord - true if the output label is the next word of the input stream
+// The assembly loop in EnsureDataAvailable revisits each token once per minibatch the
+// token appears in; precomputing the ids here turns those repeated lookups into copies.
+template <class ElemType>
+void BatchSequenceReader<ElemType>::BuildLabelTempIds(LabelInfo& labelIn, LabelInfo& labelInfo, bool nextWord)
+{
+    m_labelTempIdIn.clear();
+    m_labelTempIdOut.clear();
+
+    // only the common LM configuration (category input, next-word output) is
+    // precomputed; anything else falls back to per-token lookup
+    if (labelIn.type != labelCategory || !nextWord)
+        return;
+
+    m_labelTempIdIn.reserve(m_labelTemp.size());
+    m_labelTempIdOut.reserve(m_labelTemp.size());
+    LabelIdType endId = GetIdFromLabel(labelInfo.endSequence, labelInfo);
+    for (size_t t = 0; t < m_labelTemp.size(); t++)
+    {
+        m_labelTempIdIn.push_back(GetIdFromLabel(m_labelTemp[t], labelIn));
+        // the output stream maps the input's sentence-ending token to its own end id
+        if (!_stricmp(m_labelTemp[t].c_str(), labelIn.endSequence.c_str()))
+            m_labelTempIdOut.push_back(endId);
+        else
+            m_labelTempIdOut.push_back(GetIdFromLabel(m_labelTemp[t], labelInfo));
+    }
+}
+
 template <class ElemType>
 bool BatchSequenceReader<ElemType>::EnsureDataAvailable(size_t /*mbStartSample*/, size_t& firstPosInSentence)
 {
@@ -1768,6 +1816,10 @@ bool BatchSequenceReader<ElemType>::EnsureDataAvailable(size_t /*mbStartSample*/
 
         std::random_shuffle(m_parser.mSentenceIndex2SentenceInfo.begin(), m_parser.mSentenceIndex2SentenceInfo.end());
 
+        // convert the freshly parsed token window to ids in a single pass; the
+        // assembly loop below revisits each token once per minibatch it appears in
+        BuildLabelTempIds(labelIn, labelInfo, nextWord);
+
         m_readNextSampleLine += mNumRead;
         sLn = FindNextSentences(mNumRead);
     }
@@ -1784,6 +1836,16 @@ bool BatchSequenceReader<ElemType>::EnsureDataAvailable(size_t /*mbStartSample*/
             size_t seq = mToProcess[k];
             size_t label = m_parser.mSentenceIndex2SentenceInfo[seq].sBegin + i;
 
+            // fast path: ids for the whole window were precomputed in one pass
+            if (!m_labelTempIdIn.empty())
+            {
+                assert(labelIn.dim > m_labelTempIdIn[label]); // if this goes off labelOut dimension is too small
+                m_featureData.push_back((float) m_labelTempIdIn[label]);
+                m_labelIdData.push_back(m_labelTempIdOut[label + 1]);
+                m_totalSamples++;
+                continue;
+            }
+
             // labelIn should be a category label
             LabelType labelValue = m_labelTemp[label++];
 
@@ -2066,8 +2128,13 @@ void BatchSequenceReader<ElemType>::GetLabelOutput(std::map<std::wstring,
     if (labels == nullptr)
         return;
 
+    // draw all noise samples for the minibatch up front in one pass over the alias table
+    std::vector<int> noiseSamples;
     if (readerMode == ReaderMode::NCE)
+    {
         labels->Resize(2 * (this->noise_sample_size + 1), actualmbsize);
+        m_noiseSampler.sample(this->noise_sample_size * actualmbsize, noiseSamples);
+    }
     else if (readerMode == ReaderMode::Class)
         labels->Resize(4, actualmbsize, false);
     else
@@ -2092,7 +2159,7 @@ void BatchSequenceReader<ElemType>::GetLabelOutput(std::map<std::wstring,
                 labels->SetValue(1, j, (ElemType) m_noiseSampler.logprob(wrd));
                 for (size_t noiseid = 0; noiseid < this->noise_sample_size; noiseid++)
                 {
-                    int wid = m_noiseSampler.sample();
+                    int wid = noiseSamples[j * this->noise_sample_size + noiseid];
                     labels->SetValue(2 * (noiseid + 1), j, (ElemType) wid);
                     labels->SetValue(2 * (noiseid + 1) + 1, j, -(ElemType) m_noiseSampler.logprob(wid));
                 }
@@ -12,10 +12,12 @@
 #include "Config.h"
 #include "SequenceParser.h"
 #include "RandomOrdering.h"
+#include "VocabularyHashIndex.h"
 #include <string>
 #include <map>
 #include <vector>
 #include <random>
+#include <numeric>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -44,15 +46,21 @@ enum ReaderMode
     None = 4, // some other type of label
 };
 
+// samples noise words from the unigram distribution in O(1) per draw using Walker's alias
+// method: the distribution is flattened into equally likely bins, each shared by at most two
+// words, so a draw is one uniform bin pick plus one biased coin flip instead of the binary
+// search that std::piecewise_constant_distribution performs
 template <typename Count>
 class noiseSampler
 {
     std::vector<double> m_prob, m_log_prob;
+    std::vector<double> m_aliasThreshold; // probability of keeping the bin's own word
+    std::vector<int> m_alias;             // word to fall back to otherwise
     std::uniform_int_distribution<Count> unif_int;
+    std::uniform_real_distribution<double> unif_real;
     bool uniform_sampling;
     double uniform_prob;
     double uniform_log_prob;
-    std::piecewise_constant_distribution<double> d;
     std::mt19937 rng;
 
 public:
@@ -65,15 +73,51 @@ public:
         size_t k = counts.size();
         uniform_prob = 1.0 / k;
         uniform_log_prob = std::log(uniform_prob);
-        std::vector<double> vn(counts.size() + 1);
-        for (int i = 0; i < vn.size(); i++)
-            vn[i] = i;
-        d = std::piecewise_constant_distribution<double>(vn.begin(), vn.end(), counts.begin());
         unif_int = std::uniform_int_distribution<Count>(0, (long) counts.size() - 1);
-        m_prob = d.densities();
-        m_log_prob.resize(m_prob.size());
+        unif_real = std::uniform_real_distribution<double>(0.0, 1.0);
+
+        double total = std::accumulate(counts.begin(), counts.end(), 0.0);
+        m_prob.resize(k);
+        m_log_prob.resize(k);
         for (int i = 0; i < k; i++)
+        {
+            m_prob[i] = counts[i] / total;
             m_log_prob[i] = std::log(m_prob[i]);
+        }
+
+        // build the alias table (Vose's variant): distribute the probability mass over k bins
+        // of capacity 1/k each, topping up bins of light words from heavy ones
+        m_aliasThreshold.resize(k);
+        m_alias.resize(k);
+        std::vector<double> scaled(k);
+        std::vector<int> light, heavy;
+        for (int i = 0; i < k; i++)
+        {
+            scaled[i] = m_prob[i] * k;
+            (scaled[i] < 1.0 ? light : heavy).push_back(i);
+        }
+        while (!light.empty() && !heavy.empty())
+        {
+            int s = light.back();
+            light.pop_back();
+            int l = heavy.back();
+            heavy.pop_back();
+            m_aliasThreshold[s] = scaled[s];
+            m_alias[s] = l;
+            scaled[l] -= 1.0 - scaled[s];
+            (scaled[l] < 1.0 ? light : heavy).push_back(l);
+        }
+        // whatever is left holds (up to rounding) its full bin
+        for (int i = 0; i < light.size(); i++)
+        {
+            m_aliasThreshold[light[i]] = 1.0;
+            m_alias[light[i]] = light[i];
+        }
+        for (int i = 0; i < heavy.size(); i++)
+        {
+            m_aliasThreshold[heavy[i]] = 1.0;
+            m_alias[heavy[i]] = heavy[i];
+        }
     }
     int size() const
     {
@@ -100,13 +144,21 @@ public:
         int m = unif_int(eng);
         if (uniform_sampling)
             return m;
-        return (int) d(eng);
+        return unif_real(eng) < m_aliasThreshold[m] ? m : m_alias[m];
     }
 
     int sample()
     {
         return sample(this->rng);
     }
+
+    // draw a whole minibatch worth of noise samples in one pass
+    void sample(size_t count, std::vector<int>& samples)
+    {
+        samples.resize(count);
+        for (size_t i = 0; i < count; i++)
+            samples[i] = sample(this->rng);
+    }
 };
 
 template <class ElemType>
@@ -206,6 +258,8 @@ protected:
         LabelKind type; // labels are categories, create mapping table
         std::map<LabelIdType, LabelType> mapIdToLabel;
         std::map<LabelType, LabelIdType> mapLabelToId;
+        VocabularyHashIndex vocabIndex; // open-addressing index over mapLabelToId, rebuilt lazily when mapGeneration moves
+        size_t mapGeneration = 0;       // bumped whenever mapLabelToId is (re)populated; drives vocabIndex rebuilds
         LabelIdType idMax;         // maximum label ID we have encountered so far
         LabelIdType dim;           // maximum label ID we will ever see (used for array dimensions)
         std::string beginSequence; // starting sequence string (i.e. <s>)
@@ -382,6 +436,11 @@ private:
 
     std::vector<ElemType> m_featureTemp;
     std::vector<LabelType> m_labelTemp;
+    // ids for the whole m_labelTemp window, precomputed in one pass after parsing
+    // (empty if the configuration is not category-input/next-word-output)
+    std::vector<LabelIdType> m_labelTempIdIn;
+    std::vector<LabelIdType> m_labelTempIdOut;
+    void BuildLabelTempIds(LabelInfo& labelIn, LabelInfo& labelInfo, bool nextWord);
 
     bool mSentenceEnd;
     bool mSentenceBegin;
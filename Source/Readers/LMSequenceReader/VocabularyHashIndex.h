@@ -0,0 +1,111 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// VocabularyHashIndex.h - open-addressing hash index over a label-to-id map
+//
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// VocabularyHashIndex - flat open-addressing (linear probing) index over a
+// label -> id map. The map stays the authoritative store; the index is rebuilt
+// from it whenever the map's generation counter moves past the one the index
+// was built from, and only accelerates lookups, which the sequence readers
+// issue once per token while assembling minibatches.
+class VocabularyHashIndex
+{
+public:
+    VocabularyHashIndex()
+        : m_size(0), m_generation((size_t) -1)
+    {
+    }
+
+    size_t Size() const
+    {
+        return m_size;
+    }
+
+    // Generation - the map generation this index was built from; (size_t)-1 until the first Build()
+    size_t Generation() const
+    {
+        return m_generation;
+    }
+
+    void Clear()
+    {
+        m_labels.clear();
+        m_ids.clear();
+        m_occupied.clear();
+        m_size = 0;
+        m_generation = (size_t) -1;
+    }
+
+    // Build - (re)build the index from the authoritative map, recording the
+    // generation the caller says the map is at
+    void Build(const std::map<std::string, unsigned>& mapLabelToId, size_t generation)
+    {
+        m_generation = generation;
+        // capacity is the smallest power of two keeping load at or below 50%,
+        // so probe chains stay short and the modulo reduces to a mask
+        size_t capacity = 16;
+        while (capacity < mapLabelToId.size() * 2)
+            capacity *= 2;
+        m_labels.assign(capacity, std::string());
+        m_ids.assign(capacity, 0);
+        m_occupied.assign(capacity, false);
+        m_size = mapLabelToId.size();
+        for (const auto& entry : mapLabelToId)
+        {
+            size_t slot = Hash(entry.first) & (capacity - 1);
+            while (m_occupied[slot])
+                slot = (slot + 1) & (capacity - 1);
+            m_labels[slot] = entry.first;
+            m_ids[slot] = entry.second;
+            m_occupied[slot] = true;
+        }
+    }
+
+    // Find - look up a label; returns false if the label is not in the index
+    bool Find(const std::string& label, unsigned& id) const
+    {
+        if (m_size == 0)
+            return false;
+        size_t mask = m_labels.size() - 1;
+        size_t slot = Hash(label) & mask;
+        while (m_occupied[slot])
+        {
+            if (m_labels[slot] == label)
+            {
+                id = m_ids[slot];
+                return true;
+            }
+            slot = (slot + 1) & mask;
+        }
+        return false;
+    }
+
+private:
+    // FNV-1a over the label bytes
+    static size_t Hash(const std::string& label)
+    {
+        size_t h = (size_t) 14695981039346656037ULL;
+        for (size_t i = 0; i < label.size(); i++)
+        {
+            h ^= (unsigned char) label[i];
+            h *= (size_t) 1099511628211ULL;
+        }
+        return h;
+    }
+
+    std::vector<std::string> m_labels;
+    std::vector<unsigned> m_ids;
+    std::vector<bool> m_occupied;
+    size_t m_size;       // number of entries (not capacity)
+    size_t m_generation; // see Generation()
+};
+} } }
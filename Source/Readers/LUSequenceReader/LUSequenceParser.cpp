@@ -44,8 +44,19 @@ template class LUSequenceParser<double, double>;
 template class LUSequenceParser<double, std::string>;
 template class LUSequenceParser<double, std::wstring>;
 
+// mark the corpus index as covering the whole corpus and persist it for later runs
 template <class NumType, class LabelType>
-long BatchLUSequenceParser<NumType, LabelType>::Parse(size_t recordsRequested, std::vector<long> *labels, std::vector<vector<long>> *input, std::vector<SequencePosition> *seqPos, const map<wstring, long> &inputlabel2id, const map<wstring, long> &outputlabel2id, bool canMultiplePassData)
+static void CompleteCorpusIndex(BatchLUSequenceParser<NumType, LabelType>& parser)
+{
+    if (parser.mCorpusIndexComplete)
+        return;
+    parser.mCorpusIndexComplete = true;
+    parser.mCorpusSentenceCount = parser.mSentenceFileOffsets.size();
+    parser.SaveCorpusIndex();
+}
+
+template <class NumType, class LabelType>
+long BatchLUSequenceParser<NumType, LabelType>::Parse(size_t recordsRequested, std::vector<long> *labels, std::vector<vector<long>> *input, std::vector<SequencePosition> *seqPos, const unordered_map<wstring, long> &inputlabel2id, const unordered_map<wstring, long> &outputlabel2id, bool canMultiplePassData)
 {
     fprintf(stderr, "BatchLUSequenceParser: Parsing input data...\n");
 
@@ -60,17 +71,25 @@ long BatchLUSequenceParser<NumType, LabelType>::Parse(size_t recordsRequested, s
     bool bAtEOS = false; // whether the reader is at the end of sentence position
     SequencePosition sequencePositionLast(0, 0, 0);
 
+    bool atSentenceStart = true; // Parse() always picks up at a sentence boundary
+
     wstring ch;
     while (lineCount < recordsRequested && mFile.good())
     {
+        // remember where this line starts; if it begins a new sentence, it goes into the corpus index
+        int64_t lineStart = mCorpusIndexComplete ? -1 : (int64_t) mFile.tellg();
+
         getline(mFile, ch);
         ch = wtrim(ch);
 
         if (mFile.eof())
         {
+            // reaching EOF means the sequential pass has now covered the whole corpus
+            CompleteCorpusIndex(*this);
             if (canMultiplePassData)
             {
                 ParseReset(); // restart from the corpus begining
+                atSentenceStart = true;
                 continue;
             }
             else
@@ -83,6 +102,7 @@ long BatchLUSequenceParser<NumType, LabelType>::Parse(size_t recordsRequested, s
         {
             AddOneItem(labels, input, seqPos, lineCount, recordCount, orgRecordCount, sequencePositionLast);
             bAtEOS = true;
+            atSentenceStart = true;
             continue;
         }
 
@@ -94,6 +114,14 @@ long BatchLUSequenceParser<NumType, LabelType>::Parse(size_t recordsRequested, s
             continue;
 
         bAtEOS = false;
+        if (atSentenceStart)
+        {
+            // this line begins a new sentence; extend the corpus index if this is the
+            // first pass to reach that sentence (appends stay contiguous with the index)
+            if (!mCorpusIndexComplete && mNextGlobalSentence == mSentenceFileOffsets.size())
+                mSentenceFileOffsets.push_back(lineStart);
+            atSentenceStart = false;
+        }
         vector<long> vtmp;
         for (size_t i = 0; i < vstr.size() - 1; i++)
         {
@@ -124,6 +152,7 @@ long BatchLUSequenceParser<NumType, LabelType>::Parse(size_t recordsRequested, s
         {
             AddOneItem(labels, input, seqPos, lineCount, recordCount, orgRecordCount, sequencePositionLast);
             bAtEOS = true;
+            atSentenceStart = true;
         }
 
     } // while
@@ -149,6 +178,81 @@ long BatchLUSequenceParser<NumType, LabelType>::Parse(size_t recordsRequested, s
     return lineCount;
 }
 
+// size in bytes of the corpus file, used to detect a stale sidecar index
+static int64_t CorpusFileSize(const wstring& fileName)
+{
+    FILE* f = nullptr;
+    if (_wfopen_s(&f, fileName.c_str(), L"rb") || f == nullptr)
+        return -1;
+    _fseeki64(f, 0, SEEK_END);
+    int64_t size = _ftelli64(f);
+    fclose(f);
+    return size;
+}
+
+// sidecar layout: magic, corpus byte size (staleness check), sentence count, then one file offset per sentence
+template <class NumType, class LabelType>
+void BatchLUSequenceParser<NumType, LabelType>::SaveCorpusIndex()
+{
+    FILE* f = nullptr;
+    if (_wfopen_s(&f, IndexPathName().c_str(), L"wb") || f == nullptr)
+    {
+        // not fatal: without the index the reader just falls back to sequential re-reading
+        fprintf(stderr, "BatchLUSequenceParser: cannot write corpus index %ls\n", IndexPathName().c_str());
+        return;
+    }
+
+    unsigned int magic = indexmagic;
+    int64_t corpusSize = CorpusFileSize(mFileName);
+    int64_t count = (int64_t) mSentenceFileOffsets.size();
+    bool good = fwrite(&magic, sizeof(magic), 1, f) == 1 &&
+                fwrite(&corpusSize, sizeof(corpusSize), 1, f) == 1 &&
+                fwrite(&count, sizeof(count), 1, f) == 1 &&
+                (count == 0 || fwrite(mSentenceFileOffsets.data(), sizeof(int64_t), (size_t) count, f) == (size_t) count);
+    if (fclose(f) != 0 || !good)
+        fprintf(stderr, "BatchLUSequenceParser: error writing corpus index %ls\n", IndexPathName().c_str());
+    else if (m_traceLevel > 0)
+        fprintf(stderr, "BatchLUSequenceParser: saved corpus index with %d sentences to %ls\n", (int) count, IndexPathName().c_str());
+}
+
+template <class NumType, class LabelType>
+void BatchLUSequenceParser<NumType, LabelType>::LoadCorpusIndex()
+{
+    mSentenceFileOffsets.clear();
+    mCorpusIndexComplete = false;
+    mCorpusSentenceCount = 0;
+    mNextGlobalSentence = 0;
+
+    FILE* f = nullptr;
+    if (_wfopen_s(&f, IndexPathName().c_str(), L"rb") || f == nullptr)
+        return; // no index yet; the first sequential pass will build one
+
+    unsigned int magic = 0;
+    int64_t corpusSize = -1;
+    int64_t count = 0;
+    bool good = fread(&magic, sizeof(magic), 1, f) == 1 &&
+                fread(&corpusSize, sizeof(corpusSize), 1, f) == 1 &&
+                fread(&count, sizeof(count), 1, f) == 1 &&
+                magic == indexmagic && count >= 0 &&
+                corpusSize == CorpusFileSize(mFileName); // corpus changed since the index was built
+    if (good && count > 0)
+    {
+        mSentenceFileOffsets.resize((size_t) count);
+        good = fread(mSentenceFileOffsets.data(), sizeof(int64_t), (size_t) count, f) == (size_t) count;
+    }
+    fclose(f);
+
+    if (!good)
+    {
+        fprintf(stderr, "BatchLUSequenceParser: ignoring stale or unreadable corpus index %ls\n", IndexPathName().c_str());
+        mSentenceFileOffsets.clear();
+        return;
+    }
+
+    mCorpusIndexComplete = true;
+    mCorpusSentenceCount = (size_t) count;
+}
+
 template class BatchLUSequenceParser<float, std::string>;
 template class BatchLUSequenceParser<double, std::string>;
 template class BatchLUSequenceParser<float, std::wstring>;
@@ -11,6 +11,7 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <unordered_map>
 #include <stdint.h>
 #include "Platform.h"
 #include "DataReader.h"
@@ -140,6 +141,17 @@ public:
     std::wstring mFileName;
     vector<stSentenceInfo> mSentenceIndex2SentenceInfo;
 
+    // corpus index: file position of the first line of every sentence, recorded during the
+    // first sequential pass and persisted in a binary sidecar next to the corpus file, so
+    // that later epochs and checkpoint resumes can seek straight to a sentence in O(1)
+    // instead of re-reading the corpus from the beginning
+    vector<int64_t> mSentenceFileOffsets; // [global sentence id] -> stream position of first line
+    size_t mCorpusSentenceCount;          // total number of sentences; valid once mCorpusIndexComplete
+    bool mCorpusIndexComplete;            // EOF seen once: the index covers the whole corpus
+    size_t mNextGlobalSentence;           // global id of the next sentence Parse() will produce
+
+    static const unsigned int indexmagic = 0x6c756978; // 'luix'
+
 public:
     using LUSequenceParser<NumType, LabelType>::m_dimFeatures;
     using LUSequenceParser<NumType, LabelType>::m_dimLabelsIn;
@@ -156,7 +168,8 @@ public:
     using LUSequenceParser<NumType, LabelType>::m_labels;
     using LUSequenceParser<NumType, LabelType>::m_beginSequence;
     using LUSequenceParser<NumType, LabelType>::m_endSequence;
-    BatchLUSequenceParser(){};
+    BatchLUSequenceParser()
+        : mCorpusSentenceCount(0), mCorpusIndexComplete(false), mNextGlobalSentence(0){};
     ~BatchLUSequenceParser()
     {
         mFile.close();
@@ -188,6 +201,8 @@ public:
 #endif
         if (!mFile.good())
             RuntimeError("cannot open file %ls", fileName);
+
+        LoadCorpusIndex(); // pick up the corpus index from a previous run, if one exists
     }
 
     void ParseReset()
@@ -200,8 +215,38 @@ public:
 #endif
         if (!mFile.good())
             RuntimeError("cannot open file %ls", mFileName.c_str());
+        mNextGlobalSentence = 0;
+    }
+
+    wstring IndexPathName() const
+    {
+        return mFileName + L".index";
+    }
+
+    // reposition the parser at the given sentence in O(1) using the corpus index;
+    // returns false if the index does not cover that sentence yet (caller then falls
+    // back to sequential reading from the corpus beginning)
+    bool SeekToSentence(size_t gid)
+    {
+        if (gid >= mSentenceFileOffsets.size())
+            return false;
+        mFile.clear(); // (a previous pass may have left the stream in EOF state)
+        mFile.seekg((std::streamoff) mSentenceFileOffsets[gid]);
+        if (!mFile.good())
+            RuntimeError("SeekToSentence: error seeking to sentence %d in file %ls", (int) gid, mFileName.c_str());
+        mNextGlobalSentence = gid;
+        return true;
     }
 
+    // total number of sentences in the corpus; 0 if not known yet (no complete pass and no sidecar index)
+    size_t CorpusSentenceCount() const
+    {
+        return mCorpusIndexComplete ? mCorpusSentenceCount : 0;
+    }
+
+    void LoadCorpusIndex(); // read the sidecar index; starts fresh if missing or stale
+    void SaveCorpusIndex(); // write the sidecar index once the first pass has seen the whole corpus
+
     void AddOneItem(std::vector<long>* labels, std::vector<vector<long>>* input, std::vector<SequencePosition>* seqPos, long& lineCount,
                     long& recordCount, long orgRecordCount, SequencePosition& sequencePositionLast)
     {
@@ -211,6 +256,7 @@ public:
 
         recordCount = (long) labels->size() - orgRecordCount;
         lineCount++;
+        mNextGlobalSentence++; // one more sentence consumed from the corpus
     }
 
     // Parse - Parse the data
@@ -225,7 +271,7 @@ public:
     // numbers - pointer to vector to return the numbers
     // seqPos - pointers to the other two arrays showing positions of each sequence
     // returns - number of records actually read, if the end of file is reached the return value will be < requested records
-    long Parse(size_t recordsRequested, std::vector<long>* labels, std::vector<vector<long>>* input, std::vector<SequencePosition>* seqPos, const map<wstring, long>& inputlabel2id, const map<wstring, long>& outputlabel2id, bool mAllowMultPassData = false);
+    long Parse(size_t recordsRequested, std::vector<long>* labels, std::vector<vector<long>>* input, std::vector<SequencePosition>* seqPos, const unordered_map<wstring, long>& inputlabel2id, const unordered_map<wstring, long>& outputlabel2id, bool mAllowMultPassData = false);
 };
 }
 }
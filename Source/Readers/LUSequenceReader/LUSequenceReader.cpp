@@ -43,10 +43,10 @@ BatchLUSequenceReader<ElemType>::~BatchLUSequenceReader()
 
 template <class ElemType>
 void BatchLUSequenceReader<ElemType>::ReadLabelInfo(const wstring& vocfile,
-                                                    map<wstring, long>& word4idx,
+                                                    unordered_map<wstring, long>& word4idx,
                                                     bool readClass,
                                                     map<wstring, long>& word4cls,
-                                                    map<long, wstring>& idx4word,
+                                                    unordered_map<long, wstring>& idx4word,
                                                     map<long, long>& idx4class,
                                                     int& mNbrCls)
 {
@@ -268,7 +268,7 @@ void LUSequenceReader<ElemType>::LoadLabelFile(const std::wstring& filePath, std
 template <class ElemType>
 void LUSequenceReader<ElemType>::ChangeMaping(const map<LabelType, LabelType>& maplist,
                                               const LabelType& unkstr,
-                                              map<LabelType, LabelIdType>& word4idx)
+                                              unordered_map<LabelType, LabelIdType>& word4idx)
 {
     auto punk = word4idx.find(unkstr);
     for (auto ptr = word4idx.begin(); ptr != word4idx.end(); ptr++)
@@ -278,7 +278,16 @@ void LUSequenceReader<ElemType>::ChangeMaping(const map<LabelType, LabelType>& m
         if (maplist.find(wrd) != maplist.end())
         {
             LabelType mpp = maplist.find(wrd)->second;
-            idx = word4idx[mpp];
+            // look up without inserting: an insertion could rehash and invalidate ptr
+            auto pmap = word4idx.find(mpp);
+            if (pmap == word4idx.end())
+            {
+                if (punk == word4idx.end())
+                    RuntimeError("check unk list is missing ");
+                idx = punk->second;
+            }
+            else
+                idx = pmap->second;
         }
         else
         {
@@ -512,6 +521,12 @@ void BatchLUSequenceReader<ElemType>::StartMinibatchLoop(size_t mbSize, size_t e
     Reset();
 
     m_parser.ParseReset(); // restart from the corpus beginning
+
+    // with a corpus index built on an earlier pass (or loaded from its sidecar file), seek
+    // straight to this epoch's first sentence in O(1) instead of re-reading everything before it
+    size_t corpusSentences = m_parser.CorpusSentenceCount();
+    if (epoch > 0 && m_epochSize != requestDataSize && corpusSentences > 0)
+        m_parser.SeekToSentence((epoch * m_epochSize) % corpusSentences);
 }
 
 template <class ElemType>
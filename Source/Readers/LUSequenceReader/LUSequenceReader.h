@@ -15,6 +15,7 @@
 #include "ScriptableObjects.h"
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
@@ -124,8 +125,9 @@ protected:
     struct LabelInfo
     {
         LabelKind type; // labels are categories, create mapping table
-        map<LabelType, LabelIdType> word4idx;
-        map<LabelIdType, LabelType> idx4word;
+        // hash-based lookup: these maps are consulted once per token while parsing
+        unordered_map<LabelType, LabelIdType> word4idx;
+        unordered_map<LabelIdType, LabelType> idx4word;
         LabelIdType idMax;       // maximum label ID we have encountered so far
         long dim;                // maximum label ID we will ever see (used for array dimensions)
         LabelType beginSequence; // starting sequence string (i.e. <s>)
@@ -176,7 +178,7 @@ public:
     void Init(const ScriptableObjects::IConfigRecord&){};
     void ChangeMaping(const map<LabelType, LabelType>& maplist,
                       const LabelType& unkstr,
-                      map<LabelType, LabelIdType>& word4idx);
+                      unordered_map<LabelType, LabelIdType>& word4idx);
 
     void Destroy(){};
 
@@ -336,10 +338,10 @@ public:
 public:
     void GetClassInfo(LabelInfo& lblInfo);
     void ReadLabelInfo(const wstring& vocfile,
-                       map<wstring, long>& word4idx,
+                       unordered_map<wstring, long>& word4idx,
                        bool readClass,
                        map<wstring, long>& word4cls,
-                       map<long, wstring>& idx4word,
+                       unordered_map<long, wstring>& idx4word,
                        map<long, long>& idx4class,
                        int& mNbrCls);
 
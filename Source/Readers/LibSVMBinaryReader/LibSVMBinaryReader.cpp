@@ -188,6 +188,38 @@ void SparseBinaryMatrix<ElemType>::ResizeArrays(size_t newNNz)
     this->m_maxNNz = newMaxNNz;
 }
 
+// ReserveNNz - grow the value/row-index arrays to hold totalNNz nonzeros up front
+// so the per-microbatch ResizeArrays calls never reallocate pinned memory mid-epoch
+template <class ElemType>
+void SparseBinaryMatrix<ElemType>::ReserveNNz(size_t totalNNz)
+{
+    if (totalNNz <= this->m_maxNNz)
+    {
+        return;
+    }
+    int32_t* rowIndices = (int32_t*) CUDAPageLockedMemAllocator::Malloc(sizeof(int32_t) * totalNNz, this->m_deviceID);
+    ElemType* values = (ElemType*) CUDAPageLockedMemAllocator::Malloc(sizeof(ElemType) * totalNNz, this->m_deviceID);
+
+    if (m_nnz > 0)
+    {
+        memcpy(rowIndices, m_rowIndices, sizeof(int32_t) * m_nnz);
+        memcpy(values, this->m_values, sizeof(ElemType) * m_nnz);
+    }
+
+    if (m_rowIndices != nullptr)
+    {
+        CUDAPageLockedMemAllocator::Free(this->m_rowIndices, this->m_deviceID);
+    }
+    if (this->m_values != nullptr)
+    {
+        CUDAPageLockedMemAllocator::Free(this->m_values, this->m_deviceID);
+    }
+
+    m_rowIndices = rowIndices;
+    this->m_values = values;
+    this->m_maxNNz = totalNNz;
+}
+
 template <class ElemType>
 void SparseBinaryMatrix<ElemType>::Clear()
 {
@@ -228,7 +260,7 @@ void SparseBinaryMatrix<ElemType>::Fill(Matrix<ElemType>* matrix)
 
 template <class ElemType>
 SparseBinaryInput<ElemType>::SparseBinaryInput(std::wstring fileName)
-    : m_fileName(fileName), m_readOrder(nullptr), m_readOrderLength(0), m_randomize(false), m_tempValues(nullptr), m_tempValuesSize(0), m_offsets(nullptr), m_offsetsStart(0), m_startMB(0), m_endMB(0)
+    : m_fileName(fileName), m_readOrder(nullptr), m_readOrderLength(0), m_randomize(false), m_tempValues(nullptr), m_tempValuesSize(0), m_offsets(nullptr), m_offsetsStart(0), m_startMB(0), m_endMB(0), m_maxNNzPerMB(0)
 {
     std::string name = msra::strfun::utf8(m_fileName);
     m_inFile.open(name, ifstream::binary | ifstream::in);
@@ -445,6 +477,15 @@ void SparseBinaryInput<ElemType>::StartDistributedMinibatchLoop(size_t mbSize, s
         // fprintf(stderr, "m_offsets[%lu] = %lu\n", c, m_offsets[c]);
     }
     // fprintf(stderr, "max mb size: %ld\n", m_maxMBSize);
+
+    // worst-case nonzeros a minibatch can carry: no microbatch in the window can hold
+    // more nonzeros than fit in its byte span (one value + one row index each), and a
+    // minibatch is assembled from m_mbSize / m_microBatchSize microbatches; used by
+    // FillMatrices to pre-size the sparse arrays once instead of growing them mid-epoch
+    size_t maxNNzPerMicroBatch = m_maxMBSize / (sizeof(ElemType) + sizeof(int32_t));
+    size_t microBatchesPerMB = (m_mbSize + m_microBatchSize - 1) / m_microBatchSize;
+    m_maxNNzPerMB = maxNNzPerMicroBatch * microBatchesPerMB;
+
     size_t maxMem = 1024 * 1024 * 1024; // 1GB
     size_t maxPointers = maxMem / m_maxMBSize;
     for (size_t c = 0; c < maxPointers; c++)
@@ -625,6 +666,7 @@ size_t SparseBinaryInput<ElemType>::FillMatrices(std::map<std::wstring, shared_p
     for (auto mat : matrices)
     {
         mat.second->SetMaxRows(m_mbSize);
+        mat.second->ReserveNNz(m_maxNNzPerMB); // no-op once the arrays are at full size
         mat.second->Clear();
     }
     void* data_buffer;
@@ -743,14 +785,19 @@ void LibSVMBinaryReader<ElemType>::StartDistributedMinibatchLoop(size_t mbSize,
 template <class ElemType>
 void LibSVMBinaryReader<ElemType>::CheckDataMatrices(std::map<std::wstring, Matrix<ElemType>*>& matrices)
 {
-    if (m_dataMatrices.empty())
+    if (m_dataMatrices[0].empty())
     {
-        for (auto inmat : matrices)
+        // create both staging buffers so minibatch assembly can run in the
+        // background while the previously assembled one is uploaded to the GPU
+        for (size_t c = 0; c < 2; c++)
         {
-            shared_ptr<BinaryMatrix<ElemType>> mat = m_dataInput->CreateMatrix(inmat.first, inmat.second->GetDeviceId());
-            if (mat != nullptr)
+            for (auto inmat : matrices)
             {
-                m_dataMatrices[inmat.first] = mat;
+                shared_ptr<BinaryMatrix<ElemType>> mat = m_dataInput->CreateMatrix(inmat.first, inmat.second->GetDeviceId());
+                if (mat != nullptr)
+                {
+                    m_dataMatrices[c][inmat.first] = mat;
+                }
             }
         }
     }
@@ -795,9 +842,11 @@ bool LibSVMBinaryReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<El
         {
             // fprintf(stderr, "not valid\n");
             CheckDataMatrices(matrices);
-            m_pendingAsyncGetMinibatch = std::async(std::launch::async, [this]()
+            m_curDataMatrix = 0;
+            size_t fillDataMatrix = m_curDataMatrix;
+            m_pendingAsyncGetMinibatch = std::async(std::launch::async, [this, fillDataMatrix]()
                                                     {
-                                                        return m_dataInput->FillMatrices(m_dataMatrices);
+                                                        return m_dataInput->FillMatrices(m_dataMatrices[fillDataMatrix]);
                                                     });
         }
 //fprintf(stderr, "before get.\n");
@@ -817,11 +866,21 @@ bool LibSVMBinaryReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<El
             return false;
         }
 
+        // start assembling the next minibatch into the other staging buffer
+        // before this one is handed to the GPU, so assembly and upload overlap
+        size_t filledDataMatrix = m_curDataMatrix;
+        m_curDataMatrix = 1 - m_curDataMatrix;
+        size_t fillDataMatrix = m_curDataMatrix;
+        m_pendingAsyncGetMinibatch = std::async(std::launch::async, [this, fillDataMatrix]()
+                                                {
+                                                    return m_dataInput->FillMatrices(m_dataMatrices[fillDataMatrix]);
+                                                });
+
         m_pMBLayout->InitAsFrameMode(actualMBSize);
 #if DEBUG
         reader_series->write_flag(_T("starting fill."));
 #endif
-        for (auto matrix : m_dataMatrices)
+        for (auto matrix : m_dataMatrices[filledDataMatrix])
         {
             auto findMat = matrices.find(matrix.first);
             if (findMat != matrices.end())
@@ -837,11 +896,6 @@ bool LibSVMBinaryReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<El
         {
             DoDSSMMatrix(*(findMat->second), actualMBSize);
         }
-        m_pendingAsyncGetMinibatch = std::async(std::launch::async, [this]()
-                                                {
-                                                    // CheckDataMatrices(matrices);
-                                                    return m_dataInput->FillMatrices(m_dataMatrices);
-                                                });
     }
 #if DEBUG
     cur_read++;
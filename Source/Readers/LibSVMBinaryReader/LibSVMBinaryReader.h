@@ -75,6 +75,9 @@ public:
     }
     virtual void ResizeArrays(size_t) = 0;
     virtual void SetMaxRows(size_t maxRows) = 0;
+    virtual void ReserveNNz(size_t /*totalNNz*/)
+    {
+    } // only meaningful for sparse matrices
 
 protected:
     wstring m_matrixName;
@@ -135,6 +138,7 @@ public:
     }
     virtual void ResizeArrays(size_t newMaxNNz) override;
     virtual void SetMaxRows(size_t maxRows) override;
+    virtual void ReserveNNz(size_t totalNNz) override;
 
 protected:
     int32_t* m_rowIndices;
@@ -200,6 +204,7 @@ private:
 
     size_t m_windowSize;
     size_t m_curWindowSize;
+    size_t m_maxNNzPerMB; // worst-case nonzeros per minibatch, used to pre-size the sparse arrays
 
     bool m_randomize;
     size_t* m_readOrder; // array to shuffle to reorder the dataset
@@ -246,7 +251,7 @@ public:
     virtual void Destroy();
 
     LibSVMBinaryReader()
-        : DSSMLabels(nullptr), DSSMCols(0)
+        : DSSMLabels(nullptr), DSSMCols(0), m_curDataMatrix(0)
     {
         m_pMBLayout = make_shared<MBLayout>();
     };
@@ -300,7 +305,10 @@ private:
 
     std::shared_ptr<SparseBinaryInput<ElemType>> m_dataInput;
 
-    std::map<std::wstring, shared_ptr<BinaryMatrix<ElemType>>> m_dataMatrices;
+    // two staging buffers: while one is being uploaded to the GPU, the
+    // background task assembles the next minibatch into the other one
+    std::map<std::wstring, shared_ptr<BinaryMatrix<ElemType>>> m_dataMatrices[2];
+    size_t m_curDataMatrix;
 
     unsigned long m_randomize; // randomization range
 
@@ -15,52 +15,20 @@
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
-DWORD HIDWORD(size_t size)
-{
-    return size >> 32;
-}
-DWORD LODWORD(size_t size)
-{
-    return size & 0xFFFFFFFF;
-}
-
 template <class ElemType>
 SparsePCReader<ElemType>::~SparsePCReader()
 {
-    if (m_filemap != NULL)
-    {
-        UnmapViewOfFile(m_filemap);
-    }
-
-    if (m_dataBuffer != NULL)
-    {
-        UnmapViewOfFile(m_dataBuffer);
-    }
-
-    CloseHandle(m_hndl);
-
-    for (int i = 0; i < m_featureCount; i++)
+    if (m_fillPending.valid()) // let a slab preparation in flight finish before tearing down
     {
-        if (m_values[i] != NULL)
+        try
         {
-            free(m_values[i]);
+            m_fillPending.get();
         }
-
-        if (m_rowIndices[i] != NULL)
-        {
-            free(m_rowIndices[i]);
-        }
-
-        if (m_colIndices[i] != NULL)
+        catch (...)
         {
-            free(m_colIndices[i]);
         }
     }
-
-    if (m_labelsBuffer != NULL)
-    {
-        free(m_labelsBuffer);
-    }
+    // shard mappings are released by their shared_ptrs
 }
 
 template <class ElemType>
@@ -91,58 +59,42 @@ void SparsePCReader<ElemType>::InitFromConfig(const ConfigRecordType& readerConf
     std::vector<std::wstring> featureNames;
     std::vector<std::wstring> labelNames;
 
-    m_file = (const wstring&) readerConfig(L"file");
+    // 'file' may name a single file or a list of shard files, which are read back to back
+    stringargvector files = readerConfig(L"file", ConfigRecordType::Array(stringargvector()));
+    m_files = files;
+    if (m_files.empty())
+        RuntimeError("SparsePCReader requires a 'file' parameter naming at least one data file");
 
     // Determine the names of the features and lables sections in the config file.
     // features - [in,out] a vector of feature name strings
     // labels - [in,out] a vector of label name strings
     GetFileConfigNames(readerConfig, featureNames, labelNames);
 
-    if (labelNames.size() != 1)
-    {
-        RuntimeError("SparsePC requires exactly one label. Their names should match those in NDL definition");
-        return;
-    }
+    if (labelNames.size() > 1)
+        RuntimeError("SparsePCReader supports at most one label. Its name should match the one in the NDL definition");
+    // no label section at all means unsupervised mode: the data files then carry no label field
+    m_labelName = labelNames.empty() ? L"" : labelNames[0];
 
     m_featureCount = featureNames.size();
-    m_labelName = labelNames[0];
 
     m_featureNames = std::vector<std::wstring>(m_featureCount);
     m_dims = std::vector<size_t>(m_featureCount);
-    m_values = std::vector<ElemType*>(m_featureCount);
-    m_rowIndices = std::vector<int32_t*>(m_featureCount);
-    m_colIndices = std::vector<int32_t*>(m_featureCount);
 
     for (int i = 0; i < m_featureCount; i++)
     {
         // In the config file, we must specify query features first, then document features. The sequence is different here. Pay attention
         m_featureNames[i] = featureNames[m_featureCount - i - 1];
 
-        ConfigParameters featureConfig = readerConfig(m_featureNames[i], "");
-
-        if (featureConfig.size() == 0)
+        if (!readerConfig.Exists(m_featureNames[i]))
             RuntimeError("features config not found, required in configuration: i.e. 'features=[dim=506530]'");
 
-        m_dims[i] = featureConfig("dim");
-    }
-
-    m_hndl = CreateFile(m_file.c_str(), GENERIC_READ,
-                        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-    if (m_hndl == INVALID_HANDLE_VALUE)
-    {
-        char message[256];
-        sprintf_s(message, "Unable to Open/Create file %ls, error %x", m_file.c_str(), GetLastError());
-        RuntimeError(message);
+        const ConfigRecordType& featureConfig = readerConfig(m_featureNames[i]);
+        m_dims[i] = featureConfig(L"dim");
     }
 
-    GetFileSizeEx(m_hndl, (PLARGE_INTEGER) &m_filePositionMax);
-    m_filemap = CreateFileMapping(m_hndl, NULL, PAGE_READONLY, 0, 0, NULL);
-
-    m_dataBuffer = (char*) MapViewOfFile(m_filemap,
-                                         FILE_MAP_READ,
-                                         HIDWORD(0),
-                                         LODWORD(0),
-                                         0);
+    // map all shards up front; SharedFileMapping pools the views per file name
+    for (const auto& file : m_files)
+        m_shards.push_back(SharedFileMapping::Open(file));
 }
 
 //StartMinibatchLoop - Startup a minibatch loop
@@ -150,119 +102,217 @@ void SparsePCReader<ElemType>::InitFromConfig(const ConfigRecordType& readerConf
 // epoch - [in] epoch number for this loop --ignored
 // requestedEpochSamples - [in] number of samples to randomize --ignored
 template <class ElemType>
-void SparsePCReader<ElemType>::StartMinibatchLoop(size_t mbSize, size_t /*epoch*/, size_t /*requestedEpochSamples*/)
+void SparsePCReader<ElemType>::StartMinibatchLoop(size_t mbSize, size_t epoch, size_t requestedEpochSamples)
 {
-    if (m_values[0] == NULL || m_miniBatchSize != mbSize)
-    {
-        m_miniBatchSize = mbSize;
+    return StartDistributedMinibatchLoop(mbSize, epoch, 0, 1, requestedEpochSamples);
+}
+
+//StartDistributedMinibatchLoop - Startup a distributed minibatch loop
+// Each rank parses the full record stream (headers only for foreign records) but assembles
+// and uploads only every numSubsets-th minibatch, offset by subsetNum.
+template <class ElemType>
+void SparsePCReader<ElemType>::StartDistributedMinibatchLoop(size_t mbSize, size_t /*epoch*/, size_t subsetNum, size_t numSubsets, size_t /*requestedEpochSamples*/)
+{
+    if (subsetNum >= numSubsets)
+        InvalidArgument("StartDistributedMinibatchLoop: subsetNum %d out of range of %d subsets", (int) subsetNum, (int) numSubsets);
+
+    // a slab preparation from the previous loop may still be in flight; it uses the read
+    // cursor we are about to reset
+    if (m_fillPending.valid())
+        m_fillPending.get();
 
+    m_miniBatchSize = mbSize;
+    m_subsetNum = subsetNum;
+    m_numSubsets = numSubsets;
+
+    for (size_t s = 0; s < 2; s++)
+    {
+        SparseSlab& slab = m_slabs[s];
+        slab.values.resize(m_featureCount);
+        slab.rowIndices.resize(m_featureCount);
+        slab.colIndices.resize(m_featureCount);
         for (int i = 0; i < m_featureCount; i++)
         {
-            if (m_values[i] != NULL)
-            {
-                free(m_values[i]);
-                free(m_colIndices[i]);
-                free(m_rowIndices[i]);
-                free(m_labelsBuffer);
-            }
-
-            m_values[i] = (ElemType*) malloc(sizeof(ElemType) * m_dims[i] * m_miniBatchSize / m_sparsenessFactor);
-            m_rowIndices[i] = (int32_t*) malloc(sizeof(int32_t) * m_dims[i] * m_miniBatchSize / m_sparsenessFactor);
-            m_colIndices[i] = (int32_t*) malloc(sizeof(int32_t) * (m_miniBatchSize + 1));
-            m_labelsBuffer = (ElemType*) malloc(sizeof(ElemType) * m_miniBatchSize);
+            slab.values[i].reserve(m_dims[i] * m_miniBatchSize / m_sparsenessFactor);
+            slab.rowIndices[i].reserve(m_dims[i] * m_miniBatchSize / m_sparsenessFactor);
+            slab.colIndices[i].reserve(m_miniBatchSize + 1);
         }
+        slab.labels.reserve(m_miniBatchSize);
+        slab.numCols = 0;
+        slab.endOfData = false;
     }
 
-    // reset the next read sample
+    // rewind to the start of the data and kick off preparation of the first minibatch
+    m_currShard = 0;
     m_currOffset = 0;
+    m_bytesRead = 0;
+    m_mbCounter = 0;
+    m_atEndOfData = false;
+    m_currSlab = 0;
+    m_fillPending = std::async(std::launch::async, [this]()
+                               {
+                                   FillSlab(m_slabs[0]);
+                               });
 }
 
-// GetMinibatch - Get the next minibatch (features and labels)
-// matrices - [in] a map with named matrix types (i.e. 'features', 'labels') mapped to the corresponding matrix,
-//             [out] each matrix resized if necessary containing data.
-// returns - true if there are more minibatches, false if no more minibatchs remain
+// FillSlab - Parse the next minibatch owned by this rank into CSC slab form.
+// Runs on a background thread; the read cursor (m_currShard/m_currOffset/m_mbCounter) is only
+// ever touched here and in StartDistributedMinibatchLoop, never while a fill is pending.
+// On return, slab.numCols == 0 means no data is left for this rank.
 template <class ElemType>
-bool SparsePCReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<ElemType>*>& matrices)
+void SparsePCReader<ElemType>::FillSlab(SparseSlab& slab)
 {
-    // get out if they didn't call StartMinibatchLoop() first
-    if (m_miniBatchSize == 0)
-        return false;
+    slab.numCols = 0;
+    slab.endOfData = false;
+    const bool haveLabels = !m_labelName.empty();
 
-    // Return early (for debugging purposes)
-    if (m_maxReadData > 0 && m_currOffset >= m_maxReadData)
-        return false;
-
-    if (m_currOffset >= m_filePositionMax)
-        return false;
-
-    Matrix<ElemType>* labels = nullptr; // labels to return, or NULL if no labels in matrix set
-    auto labelEntry = matrices.find(m_labelName);
-    if (labelEntry != matrices.end())
+    for (;;)
     {
-        labels = labelEntry->second;
+        // step over exhausted shards
+        while (m_currShard < m_shards.size() && m_currOffset >= (int64_t) m_shards[m_currShard]->Size())
+        {
+            m_currShard++;
+            m_currOffset = 0;
+        }
 
-        if (labels->GetNumRows() != 1)
-            RuntimeError("SparsePCReader only supports single label value per column but the network expected %d.", (int) labels->GetNumRows());
-    }
+        // all data consumed, or early exit for debugging
+        if (m_currShard >= m_shards.size() || (m_maxReadData > 0 && m_bytesRead >= m_maxReadData))
+        {
+            slab.endOfData = true;
+            return;
+        }
 
-    std::vector<int32_t> currIndex = std::vector<int32_t>(m_featureCount);
-    for (int i = 0; i < m_featureCount; i++)
-    {
-        currIndex[i] = 0;
-    }
+        const bool ours = (m_mbCounter % m_numSubsets) == m_subsetNum;
+        m_mbCounter++;
 
-    size_t j = 0;
+        const char* dataBuffer = m_shards[m_currShard]->Data();
+        const int64_t shardSize = (int64_t) m_shards[m_currShard]->Size();
+        const int64_t startOffset = m_currOffset;
 
-    for (j = 0; j < m_miniBatchSize && m_currOffset < m_filePositionMax; j++)
-    {
-        for (int i = 0; i < m_featureCount; i++)
+        if (ours)
         {
-            m_colIndices[i][j] = currIndex[i];
+            for (int i = 0; i < m_featureCount; i++)
+            {
+                slab.values[i].clear();
+                slab.rowIndices[i].clear();
+                slab.colIndices[i].assign(1, 0); // column j's nz range is [colIndices[j], colIndices[j+1])
+            }
+            slab.labels.clear();
+        }
 
-            int32_t nnz = *(int32_t*) ((char*) m_dataBuffer + m_currOffset);
-            m_currOffset += sizeof(int32_t);
+        // a minibatch never straddles a shard boundary (each shard behaves like a standalone
+        // file of the original single-file format, so the last minibatch per shard may be short)
+        size_t j = 0;
+        for (; j < m_miniBatchSize && m_currOffset < shardSize; j++)
+        {
+            for (int i = 0; i < m_featureCount; i++)
+            {
+                int32_t nnz = *(int32_t*) (dataBuffer + m_currOffset);
+                m_currOffset += sizeof(int32_t);
+
+                if (nnz > m_dims[i] / m_sparsenessFactor)
+                    RuntimeError("Input data is too dense - increase sparsenessFactor");
+
+                if (ours)
+                {
+                    const ElemType* values = (const ElemType*) (dataBuffer + m_currOffset);
+                    slab.values[i].insert(slab.values[i].end(), values, values + nnz);
+                }
+                m_currOffset += sizeof(ElemType) * nnz;
+
+                if (ours)
+                {
+                    const int32_t* rowIndices = (const int32_t*) (dataBuffer + m_currOffset);
+                    slab.rowIndices[i].insert(slab.rowIndices[i].end(), rowIndices, rowIndices + nnz);
+                    slab.colIndices[i].push_back((int32_t) slab.rowIndices[i].size());
+                }
+                m_currOffset += sizeof(int32_t) * nnz;
+            }
 
-            if (nnz > m_dims[i] / m_sparsenessFactor)
+            if (haveLabels)
             {
-                RuntimeError("Input data is too dense - not enough memory allocated");
+                if (ours)
+                    slab.labels.push_back(*(ElemType*) (dataBuffer + m_currOffset));
+                m_currOffset += sizeof(ElemType);
             }
 
-            memcpy(m_values[i] + currIndex[i], (char*) m_dataBuffer + m_currOffset, sizeof(ElemType) * nnz);
-            m_currOffset += (sizeof(ElemType) * nnz);
+            if (m_verificationCode != 0)
+            {
+                int32_t verifCode = *(int32_t*) (dataBuffer + m_currOffset);
 
-            memcpy(m_rowIndices[i] + currIndex[i], (char*) m_dataBuffer + m_currOffset, sizeof(int32_t) * nnz);
-            m_currOffset += (sizeof(int32_t) * nnz);
+                if (verifCode != m_verificationCode)
+                    RuntimeError("Verification code did not match (expected %d) - error in reading data", m_verificationCode);
 
-            currIndex[i] += nnz;
+                m_currOffset += sizeof(int32_t);
+            }
         }
 
-        ElemType label = *(ElemType*) ((char*) m_dataBuffer + m_currOffset);
-        m_labelsBuffer[j] = label;
-        m_currOffset += sizeof(ElemType);
+        m_bytesRead += m_currOffset - startOffset;
 
-        if (m_verificationCode != 0)
+        if (ours)
         {
-            int32_t verifCode = *(int32_t*) ((char*) m_dataBuffer + m_currOffset);
-
-            if (verifCode != m_verificationCode)
+            slab.numCols = j;
+            // no further data? (do the shard stepping now so the check is accurate)
+            while (m_currShard < m_shards.size() && m_currOffset >= (int64_t) m_shards[m_currShard]->Size())
             {
-                RuntimeError("Verification code did not match (expected %d) - error in reading data", m_verificationCode);
-                return false;
+                m_currShard++;
+                m_currOffset = 0;
             }
-
-            m_currOffset += sizeof(int32_t);
+            slab.endOfData = m_currShard >= m_shards.size() || (m_maxReadData > 0 && m_bytesRead >= m_maxReadData);
+            return;
         }
+        // not ours: headers parsed, nothing copied; go find the next minibatch
     }
+}
 
+// GetMinibatch - Get the next minibatch (features and labels)
+// matrices - [in] a map with named matrix types (i.e. 'features', 'labels') mapped to the corresponding matrix,
+//             [out] each matrix resized if necessary containing data.
+// returns - true if there are more minibatches, false if no more minibatchs remain
+template <class ElemType>
+bool SparsePCReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<ElemType>*>& matrices)
+{
+    // get out if they didn't call StartMinibatchLoop() first
+    if (m_miniBatchSize == 0)
+        return false;
+
+    if (m_fillPending.valid()) // wait for the background slab preparation (rethrows its errors)
+        m_fillPending.get();   // (already consumed if the previous call hit the end of the data)
+
+    SparseSlab& slab = m_slabs[m_currSlab];
+    if (slab.numCols == 0)
+    {
+        m_atEndOfData = true;
+        return false;
+    }
+    m_atEndOfData = slab.endOfData;
+
+    // kick off preparation of the next minibatch before uploading this one
+    size_t backSlab = 1 - m_currSlab;
+    m_fillPending = std::async(std::launch::async, [this, backSlab]()
+                               {
+                                   FillSlab(m_slabs[backSlab]);
+                               });
+
+    Matrix<ElemType>* labels = nullptr; // labels to return, or NULL if no labels in matrix set
+    auto labelEntry = matrices.find(m_labelName);
+    if (!m_labelName.empty() && labelEntry != matrices.end())
+    {
+        labels = labelEntry->second;
+
+        if (labels->GetNumRows() != 1)
+            RuntimeError("SparsePCReader only supports single label value per column but the network expected %d.", (int) labels->GetNumRows());
+    }
+
+    size_t j = slab.numCols;
     for (int i = 0; i < m_featureCount; i++)
     {
-        m_colIndices[i][j] = currIndex[i];
         Matrix<ElemType>& features = *matrices[m_featureNames[i]];
 
         if (features.GetFormat() != MatrixFormat::matrixFormatSparseCSC)
             features.SwitchToMatrixType(MatrixType::SPARSE, MatrixFormat::matrixFormatSparseCSC, false);
 
-        features.SetMatrixFromCSCFormat(m_colIndices[i], m_rowIndices[i], m_values[i], currIndex[i], m_dims[i], j);
+        features.SetMatrixFromCSCFormat(slab.colIndices[i].data(), slab.rowIndices[i].data(), slab.values[i].data(), slab.values[i].size(), m_dims[i], j);
     }
 
     if (m_returnDense || m_doGradientCheck)
@@ -277,7 +327,7 @@ bool SparsePCReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<ElemTy
     {
         labels->Resize(1, j);
         labels->SetValue((ElemType) 0);
-        labels->SetValue(1, j, labels->GetDeviceId(), m_labelsBuffer, 0);
+        labels->SetValue(1, j, labels->GetDeviceId(), slab.labels.data(), 0);
     }
 
     // create the MBLayout
@@ -287,6 +337,8 @@ bool SparsePCReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<ElemTy
     for (size_t s = 0; s < j / m_microBatchSize; s++)
         m_pMBLayout->AddSequence(NEW_SEQUENCE_ID, s, 0, m_microBatchSize);
 
+    m_currSlab = backSlab; // next call consumes the slab being prepared right now
+
     return true;
 }
 
@@ -300,10 +352,10 @@ bool SparsePCReader<ElemType>::DataEnd(EndDataType endDataType)
         assert(false);
         break;
     case endDataEpoch:
-        ret = (m_currOffset >= m_filePositionMax);
+        ret = m_atEndOfData;
         break;
     case endDataSet:
-        ret = (m_currOffset >= m_filePositionMax);
+        ret = m_atEndOfData;
         break;
     case endDataSentence: // for fast reader each minibatch is considered a "sentence", so always true --huh?
         ret = true;
@@ -325,7 +377,7 @@ const std::map<typename IDataReader<ElemType>::LabelIdType, typename IDataReader
 // labelMapping - mapping table from label values to IDs (must be 0-n)
 // note: for tasks with labels, the mapping table must be the same between a training run and a testing run
 template <class ElemType>
-void SparsePCReader<ElemType>::SetLabelMapping(const std::wstring& /*sectionName*/, const std::map<typename IDataReader<ElemType>::LabelIdType, typename LabelType>& labelMapping)
+void SparsePCReader<ElemType>::SetLabelMapping(const std::wstring& /*sectionName*/, const std::map<typename IDataReader<ElemType>::LabelIdType, typename IDataReader<ElemType>::LabelType>& labelMapping)
 {
     m_mapIdToLabel = labelMapping;
     m_mapLabelToId.clear();
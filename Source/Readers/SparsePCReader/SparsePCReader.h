@@ -9,22 +9,39 @@
 #include "DataWriter.h"
 #include "Config.h"
 #include "RandomOrdering.h"
+#include "SharedFileMapping.h"
 #include <string>
 #include <map>
 #include <vector>
+#include <future>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
 template <class ElemType>
 class SparsePCReader : public IDataReader<ElemType>
 {
+public:
+    using LabelType = typename IDataReader<ElemType>::LabelType;
+    using LabelIdType = typename IDataReader<ElemType>::LabelIdType;
+
 private:
+    // one minibatch in CSC form, assembled off the calling thread (double-buffered)
+    struct SparseSlab
+    {
+        std::vector<std::vector<ElemType>> values;     // [feature stream] nz values
+        std::vector<std::vector<int32_t>> rowIndices;  // [feature stream] nz row indices
+        std::vector<std::vector<int32_t>> colIndices;  // [feature stream] column offsets (numCols + 1 entries)
+        std::vector<ElemType> labels;                  // one label per column (empty in unsupervised mode)
+        size_t numCols;                                // columns in this minibatch; 0 means end of data
+        bool endOfData;                                // no further data follows this minibatch
+    };
+
     ConfigParameters m_readerConfig;
-    std::wstring m_file;
+    std::vector<std::wstring> m_files; // one or more shard files, read back to back
     size_t m_featureCount;
     std::vector<std::wstring> m_featureNames;
     std::vector<size_t> m_dims;
-    std::wstring m_labelName;
+    std::wstring m_labelName; // empty means unsupervised mode (no labels in the file)
     size_t m_miniBatchSize;
     size_t m_microBatchSize;
     int64_t m_maxReadData; // For early exit during debugging
@@ -32,22 +49,31 @@ private:
     bool m_returnDense;
     size_t m_sparsenessFactor;
     int32_t m_verificationCode;
-    std::vector<ElemType*> m_values;
-    std::vector<int32_t*> m_rowIndices;
-    std::vector<int32_t*> m_colIndices;
-    ElemType* m_labelsBuffer;
     MBLayoutPtr m_pMBLayout;
 
-    HANDLE m_hndl;
-    HANDLE m_filemap;
-    void* m_dataBuffer;
-    int64_t m_filePositionMax;
-    int64_t m_currOffset;
+    std::vector<std::shared_ptr<SharedFileMapping>> m_shards; // memory-mapped shard files
+    size_t m_currShard;   // shard the parse position is in
+    int64_t m_currOffset; // parse position within that shard
+    int64_t m_bytesRead;  // cumulative bytes consumed, across shards (for maxReadData)
     int m_traceLevel;
 
+    // distributed reading: this rank owns every m_numSubsets-th minibatch
+    size_t m_subsetNum;
+    size_t m_numSubsets;
+    size_t m_mbCounter; // minibatches parsed so far (owned or skipped)
+
+    // double-buffered slab preparation: while the net consumes slab m_currSlab, the
+    // background task fills the other one
+    SparseSlab m_slabs[2];
+    size_t m_currSlab;
+    std::future<void> m_fillPending;
+    bool m_atEndOfData; // end-of-data flag of the last slab handed out (for DataEnd())
+
     std::map<LabelIdType, LabelType> m_mapIdToLabel;
     std::map<LabelType, LabelIdType> m_mapLabelToId;
 
+    void FillSlab(SparseSlab& slab);
+
 public:
     SparsePCReader()
         : m_pMBLayout(make_shared<MBLayout>()){};
@@ -64,6 +90,11 @@ public:
         InitFromConfig(config);
     }
     virtual void StartMinibatchLoop(size_t mbSize, size_t epoch, size_t requestedEpochSamples = requestDataSize);
+    virtual bool SupportsDistributedMBRead() const override
+    {
+        return true;
+    }
+    virtual void StartDistributedMinibatchLoop(size_t mbSize, size_t epoch, size_t subsetNum, size_t numSubsets, size_t requestedEpochSamples = requestDataSize) override;
     virtual bool GetMinibatch(std::map<std::wstring, Matrix<ElemType>*>& matrices);
 
     size_t GetNumParallelSequences()
@@ -76,7 +107,7 @@ public:
         pMBLayout->CopyFrom(m_pMBLayout);
     }
     virtual const std::map<LabelIdType, LabelType>& GetLabelMapping(const std::wstring& sectionName);
-    virtual void SetLabelMapping(const std::wstring& sectionName, const std::map<LabelIdType, typename LabelType>& labelMapping);
+    virtual void SetLabelMapping(const std::wstring& sectionName, const std::map<LabelIdType, LabelType>& labelMapping);
     virtual bool GetData(const std::wstring& /*sectionName*/, size_t /*numRecords*/, void* /*data*/, size_t& /*dataBufferSize*/, size_t /*recordStart*/)
     {
         RuntimeError("GetData not supported in SparsePCReader");
@@ -0,0 +1,375 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// UCIBinaryCache.cpp - columnar binary cache for UCIFastReader
+//
+
+#include "stdafx.h"
+#include "Basics.h"
+#include "fileutil.h"
+#include "CrossProcessMutex.h"
+#include "UCIFastReader.h" // for LabelKind
+#include "UCIBinaryCache.h"
+#include <stdlib.h>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// on-disk layout: CacheHeader, then numRecords feature columns of featureDim elements,
+// then numRecords label entries (label ids for category, values for regression, absent for none)
+struct CacheHeader
+{
+    uint64_t magic;       // identifies the file as a UCI binary cache
+    uint32_t version;     // format version
+    uint32_t elemSize;    // sizeof(ElemType) the cache was written with
+    uint64_t featureDim;  // elements per feature column
+    uint32_t labelKind;   // LabelKind the cache carries
+    uint32_t labelSize;   // bytes per record in the label block
+    uint64_t numRecords;  // records in the file
+    uint64_t reserved[3]; // pad the header to 64 bytes
+};
+
+static const uint64_t c_cacheMagic = 0x4548434143494355ULL; // "UCICACHE"
+static const uint32_t c_cacheVersion = 1;
+
+template <class ElemType>
+UCIBinaryCache<ElemType>::UCIBinaryCache(const std::wstring& cachePath, const std::wstring& sourcePath, size_t featureDim, int labelKind)
+    : m_cachePath(cachePath),
+      m_sourcePath(sourcePath),
+      m_writePath(cachePath + L".writing"),
+      m_labelWritePath(cachePath + L".labels.writing"),
+      m_featureDim(featureDim),
+      m_labelKind(labelKind),
+      m_featureFile(NULL),
+      m_labelFile(NULL),
+      m_numWritten(0),
+      m_writing(false),
+      m_view(NULL),
+      m_viewSize(0),
+      m_numRecords(0),
+      m_features(NULL),
+      m_labels(NULL)
+#ifdef _WIN32
+      ,
+      m_hndFile(NULL),
+      m_hndMapped(NULL)
+#endif
+{
+    if (labelKind == labelCategory)
+        m_labelSize = sizeof(unsigned);
+    else if (labelKind == labelRegression)
+        m_labelSize = sizeof(ElemType);
+    else
+        m_labelSize = 0;
+}
+
+template <class ElemType>
+UCIBinaryCache<ElemType>::~UCIBinaryCache()
+{
+    Unmap();
+    if (m_writing) // never finalized (e.g. the run stopped early): discard the partial files
+        Abandon();
+}
+
+// Map - memory-map the complete cache file read-only
+// size - size of the file in bytes
+// returns - true if the mapping succeeded
+template <class ElemType>
+bool UCIBinaryCache<ElemType>::Map(size_t size)
+{
+#ifdef _WIN32
+    HANDLE hndFile = CreateFile(m_cachePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hndFile == INVALID_HANDLE_VALUE)
+        return false;
+    HANDLE hndMapped = CreateFileMapping(hndFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (hndMapped == NULL)
+    {
+        CloseHandle(hndFile);
+        return false;
+    }
+    m_view = MapViewOfFile(hndMapped, FILE_MAP_READ, 0, 0, 0);
+    if (m_view == NULL)
+    {
+        CloseHandle(hndMapped);
+        CloseHandle(hndFile);
+        return false;
+    }
+    m_hndFile = hndFile;
+    m_hndMapped = hndMapped;
+#else
+    int fd = open(msra::strfun::utf8(m_cachePath).c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    m_view = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file alive
+    if (m_view == MAP_FAILED)
+    {
+        m_view = NULL;
+        return false;
+    }
+#endif
+    m_viewSize = size;
+    return true;
+}
+
+template <class ElemType>
+void UCIBinaryCache<ElemType>::Unmap()
+{
+    if (m_view == NULL)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_view);
+    CloseHandle((HANDLE) m_hndMapped);
+    CloseHandle((HANDLE) m_hndFile);
+    m_hndMapped = m_hndFile = NULL;
+#else
+    munmap(m_view, m_viewSize);
+#endif
+    m_view = NULL;
+    m_viewSize = 0;
+    m_numRecords = 0;
+    m_features = NULL;
+    m_labels = NULL;
+}
+
+// TryLoad - map an existing cache file if it is present, up to date, and matches our shape
+// returns - true if the cache is now readable
+template <class ElemType>
+bool UCIBinaryCache<ElemType>::TryLoad()
+{
+    Unmap();
+
+    if (!fexists(m_cachePath))
+        return false;
+    if (!msra::files::fuptodate(m_cachePath, m_sourcePath))
+    {
+        fprintf(stderr, "UCIBinaryCache: cache file %ls is older than %ls, rebuilding\n", m_cachePath.c_str(), m_sourcePath.c_str());
+        return false;
+    }
+
+    CacheHeader header;
+    FILE* f = fopen(msra::strfun::utf8(m_cachePath).c_str(), "rb");
+    if (f == NULL)
+        return false;
+    size_t headerRead = fread(&header, sizeof(header), 1, f);
+    fclose(f);
+    if (headerRead != 1 ||
+        header.magic != c_cacheMagic ||
+        header.version != c_cacheVersion ||
+        header.elemSize != sizeof(ElemType) ||
+        header.featureDim != m_featureDim ||
+        header.labelKind != (uint32_t) m_labelKind ||
+        header.labelSize != m_labelSize)
+    {
+        fprintf(stderr, "UCIBinaryCache: cache file %ls does not match the reader configuration, rebuilding\n", m_cachePath.c_str());
+        return false;
+    }
+
+    size_t expectedSize = sizeof(CacheHeader) + (size_t) header.numRecords * (m_featureDim * sizeof(ElemType) + m_labelSize);
+    size_t actualSize = (size_t) filesize64(m_cachePath.c_str());
+    if (actualSize != expectedSize)
+    {
+        fprintf(stderr, "UCIBinaryCache: cache file %ls has unexpected size (%lu vs. %lu bytes), rebuilding\n", m_cachePath.c_str(), (unsigned long) actualSize, (unsigned long) expectedSize);
+        return false;
+    }
+
+    if (!Map(actualSize))
+    {
+        fprintf(stderr, "UCIBinaryCache: failed to memory-map cache file %ls\n", m_cachePath.c_str());
+        return false;
+    }
+
+    m_numRecords = (size_t) header.numRecords;
+    m_features = (const ElemType*) ((const unsigned char*) m_view + sizeof(CacheHeader));
+    m_labels = (const unsigned char*) m_view + sizeof(CacheHeader) + m_numRecords * m_featureDim * sizeof(ElemType);
+    return true;
+}
+
+// BuildLockName - system-wide lock name derived from the cache path, so all processes
+// caching the same file (e.g. the MPI ranks on one host) contend for the same builder slot
+template <class ElemType>
+std::string UCIBinaryCache<ElemType>::BuildLockName() const
+{
+    std::string path = msra::strfun::utf8(m_cachePath);
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        hash ^= (unsigned char) path[i];
+        hash *= 1099511628211ULL;
+    }
+    char name[48];
+    sprintf(name, "CNTK_UCIBinaryCache_%016llx", (unsigned long long) hash);
+    return name;
+}
+
+// BeginWrite - start streaming a new cache file
+// Caching is best effort: if the files cannot be created we warn and carry on without a cache.
+template <class ElemType>
+void UCIBinaryCache<ElemType>::BeginWrite()
+{
+    // only one process per host builds the cache (think 8 MPI ranks handed the same
+    // config); the ones that lose the race keep parsing the text source and pick the
+    // finished cache up at a later epoch boundary via TryLoad()
+    m_buildLock.reset(new CrossProcessMutex(BuildLockName()));
+    if (!m_buildLock->Acquire(false /*wait*/))
+    {
+        fprintf(stderr, "UCIBinaryCache: cache %ls is being built by another process\n", m_cachePath.c_str());
+        m_buildLock.reset();
+        return;
+    }
+
+    m_featureFile = fopen(msra::strfun::utf8(m_writePath).c_str(), "wb");
+    if (m_featureFile != NULL && m_labelSize > 0)
+        m_labelFile = fopen(msra::strfun::utf8(m_labelWritePath).c_str(), "wb");
+    if (m_featureFile == NULL || (m_labelSize > 0 && m_labelFile == NULL))
+    {
+        fprintf(stderr, "UCIBinaryCache: unable to create cache file %ls, caching disabled\n", m_writePath.c_str());
+        Abandon();
+        return;
+    }
+
+    // reserve room for the header, filled in by Finalize() once the record count is known
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    fwrite(&header, sizeof(header), 1, m_featureFile);
+
+    m_numWritten = 0;
+    m_writing = true;
+}
+
+// Append - add parsed records to the cache being written
+// features - numRecords columns of featureDim elements each
+// labelIds - per-record label ids (labelCategory only, otherwise NULL)
+// labelStrings - per-record label strings converted to values (labelRegression only, otherwise NULL)
+template <class ElemType>
+void UCIBinaryCache<ElemType>::Append(const ElemType* features, size_t numRecords, const unsigned* labelIds, const std::string* labelStrings)
+{
+    if (!m_writing)
+        return;
+
+    size_t written = fwrite(features, m_featureDim * sizeof(ElemType), numRecords, m_featureFile);
+    if (written == numRecords && m_labelKind == labelCategory)
+        written = fwrite(labelIds, sizeof(unsigned), numRecords, m_labelFile);
+    else if (written == numRecords && m_labelKind == labelRegression)
+    {
+        std::vector<ElemType> values(numRecords);
+        for (size_t i = 0; i < numRecords; i++)
+            values[i] = (ElemType) atof(labelStrings[i].c_str());
+        written = fwrite(values.data(), sizeof(ElemType), numRecords, m_labelFile);
+    }
+    if (written != numRecords)
+    {
+        fprintf(stderr, "UCIBinaryCache: write to cache file %ls failed, caching disabled\n", m_writePath.c_str());
+        Abandon();
+        return;
+    }
+    m_numWritten += numRecords;
+}
+
+// Finalize - complete the cache: append the label block, write the header, and rename into place
+// expectedRecords - record count of the dataset; the cache is discarded if we wrote a different number
+template <class ElemType>
+void UCIBinaryCache<ElemType>::Finalize(size_t expectedRecords)
+{
+    if (!m_writing)
+        return;
+    if (m_numWritten != expectedRecords)
+    {
+        fprintf(stderr, "UCIBinaryCache: wrote %lu records but dataset has %lu, discarding cache\n", (unsigned long) m_numWritten, (unsigned long) expectedRecords);
+        Abandon();
+        return;
+    }
+
+    // append the label side file to the feature block
+    if (m_labelFile != NULL)
+    {
+        fclose(m_labelFile);
+        m_labelFile = fopen(msra::strfun::utf8(m_labelWritePath).c_str(), "rb");
+        if (m_labelFile == NULL)
+        {
+            Abandon();
+            return;
+        }
+        char buffer[65536];
+        size_t bytesRead;
+        while ((bytesRead = fread(buffer, 1, sizeof(buffer), m_labelFile)) > 0)
+        {
+            if (fwrite(buffer, 1, bytesRead, m_featureFile) != bytesRead)
+            {
+                Abandon();
+                return;
+            }
+        }
+        fclose(m_labelFile);
+        m_labelFile = NULL;
+        remove(msra::strfun::utf8(m_labelWritePath).c_str());
+    }
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = c_cacheMagic;
+    header.version = c_cacheVersion;
+    header.elemSize = sizeof(ElemType);
+    header.featureDim = m_featureDim;
+    header.labelKind = (uint32_t) m_labelKind;
+    header.labelSize = (uint32_t) m_labelSize;
+    header.numRecords = m_numWritten;
+    fseek(m_featureFile, 0, SEEK_SET);
+    size_t written = fwrite(&header, sizeof(header), 1, m_featureFile);
+    int closed = fclose(m_featureFile);
+    m_featureFile = NULL;
+    m_writing = false;
+    if (written != 1 || closed != 0)
+    {
+        fprintf(stderr, "UCIBinaryCache: failed to complete cache file %ls\n", m_writePath.c_str());
+        remove(msra::strfun::utf8(m_writePath).c_str());
+        m_buildLock.reset(); // releases the build lock
+        return;
+    }
+
+    // rename into place so a crash never leaves a half-written file under the final name
+    remove(msra::strfun::utf8(m_cachePath).c_str()); // rename() does not overwrite on Windows
+    if (rename(msra::strfun::utf8(m_writePath).c_str(), msra::strfun::utf8(m_cachePath).c_str()) != 0)
+    {
+        fprintf(stderr, "UCIBinaryCache: failed to rename cache file %ls to %ls\n", m_writePath.c_str(), m_cachePath.c_str());
+        remove(msra::strfun::utf8(m_writePath).c_str());
+    }
+
+    // release the build lock only after the finished cache is visible under its final
+    // name, so waiting processes never observe the half-built state
+    m_buildLock.reset();
+}
+
+// Abandon - give up on the cache being written and remove the partial files
+template <class ElemType>
+void UCIBinaryCache<ElemType>::Abandon()
+{
+    if (m_featureFile != NULL)
+    {
+        fclose(m_featureFile);
+        m_featureFile = NULL;
+        remove(msra::strfun::utf8(m_writePath).c_str());
+    }
+    if (m_labelFile != NULL)
+    {
+        fclose(m_labelFile);
+        m_labelFile = NULL;
+        remove(msra::strfun::utf8(m_labelWritePath).c_str());
+    }
+    m_writing = false;
+    m_buildLock.reset(); // releases the build lock so another process can try
+}
+
+// instantiate all the combinations we expect to be used
+template class UCIBinaryCache<double>;
+template class UCIBinaryCache<float>;
+} } }
@@ -0,0 +1,114 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// UCIBinaryCache.h - columnar binary cache for UCIFastReader
+//
+// On the first pass over a UCI text file the parsed features and labels are streamed out
+// as raw column-major blocks behind a small header. Subsequent epochs (and runs) memory-map
+// that file and serve records by pointer arithmetic, skipping the text parse entirely.
+//
+// The mapping is shared, so when several processes on one host read the same cache (e.g.
+// the MPI ranks of a data-parallel job) the corpus occupies physical memory only once.
+// A cross-process lock keyed by the cache path makes sure only one of them builds it.
+//
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <memory>
+
+class CrossProcessMutex; // Common/CrossProcessMutex.h
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+template <class ElemType>
+class UCIBinaryCache
+{
+private:
+    std::wstring m_cachePath;      // final cache file
+    std::wstring m_sourcePath;     // text file the cache is derived from (for staleness checks)
+    std::wstring m_writePath;      // cache file while being written (renamed on completion)
+    std::wstring m_labelWritePath; // temporary side file for the label block while writing
+
+    size_t m_featureDim; // elements per record in the feature block
+    int m_labelKind;     // LabelKind the cache carries (labelNone/labelCategory/labelRegression)
+    size_t m_labelSize;  // bytes per record in the label block (0 for labelNone)
+
+    // write state
+    FILE* m_featureFile;
+    FILE* m_labelFile;
+    size_t m_numWritten;
+    bool m_writing;
+    std::unique_ptr<CrossProcessMutex> m_buildLock; // held while this process builds the cache (one builder per host)
+
+    std::string BuildLockName() const;
+
+    // read state (memory-mapped view of the complete cache)
+    void* m_view;
+    size_t m_viewSize;
+    size_t m_numRecords;
+    const ElemType* m_features;
+    const unsigned char* m_labels;
+#ifdef _WIN32
+    void* m_hndFile;   // HANDLE
+    void* m_hndMapped; // HANDLE
+#endif
+
+    bool Map(size_t size);
+    void Unmap();
+
+public:
+    UCIBinaryCache(const std::wstring& cachePath, const std::wstring& sourcePath, size_t featureDim, int labelKind);
+    ~UCIBinaryCache();
+
+    // TryLoad - map an existing cache file if it is present, up to date, and matches our shape
+    // returns - true if the cache is now readable
+    bool TryLoad();
+
+    // BeginWrite - start streaming a new cache file (written as <cache>.writing, renamed when complete)
+    void BeginWrite();
+
+    // Append - add parsed records to the cache being written
+    // features - numRecords*featureDim elements; labelIds/labelValues per label kind (unused ones NULL)
+    void Append(const ElemType* features, size_t numRecords, const unsigned* labelIds, const std::string* labelStrings);
+
+    // Finalize - complete the cache: verify the record count, write the header, and rename into place
+    void Finalize(size_t expectedRecords);
+
+    // Abandon - give up on the cache being written and remove the partial files
+    void Abandon();
+
+    bool IsReadable() const
+    {
+        return m_view != NULL;
+    }
+    bool IsWriting() const
+    {
+        return m_writing;
+    }
+    size_t NumRecords() const
+    {
+        return m_numRecords;
+    }
+    size_t NumRecordsWritten() const
+    {
+        return m_numWritten;
+    }
+
+    // record accessors, only valid while IsReadable()
+    const ElemType* Features(size_t record) const
+    {
+        return m_features + record * m_featureDim;
+    }
+    unsigned LabelId(size_t record) const // labelCategory
+    {
+        return ((const unsigned*) m_labels)[record];
+    }
+    ElemType LabelValue(size_t record) const // labelRegression
+    {
+        return ((const ElemType*) m_labels)[record];
+    }
+};
+} } }
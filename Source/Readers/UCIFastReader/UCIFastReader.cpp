@@ -101,6 +101,11 @@ bool UCIFastReader<ElemType>::EnsureDataAvailable(size_t mbStartSample, bool end
         m_labelData.resize(epochSample);
     }
 
+    // if the binary cache is being written, remember which file record this read starts at
+    // (during the first sequential pass over the file this is simply the next sample to read)
+    size_t cacheRecordBase = m_readNextSample;
+    size_t cacheRecordsBeforeWrap = size_t(-1);
+
     int recordsRead = 0;
     do
     {
@@ -113,6 +118,10 @@ bool UCIFastReader<ElemType>::EnsureDataAvailable(size_t mbStartSample, bool end
         // we should only get less records than requested at when we hit the end of the dataset
         if (recordsRead < numberToRead)
         {
+            // the file ends here; anything read after this point wrapped around to the beginning
+            if (cacheRecordsBeforeWrap == size_t(-1))
+                cacheRecordsBeforeWrap = recordsRead;
+
             // update dataset variables
             size_t additionalToRead = UpdateDataVariables(mbStartSample + recordsRead);
 
@@ -165,6 +174,25 @@ bool UCIFastReader<ElemType>::EnsureDataAvailable(size_t mbStartSample, bool end
             m_labelIdData.push_back(labelId);
         }
     }
+
+    // feed the binary cache; only the first sequential pass over the file can build it
+    if (m_binaryCache && m_binaryCache->IsWriting())
+    {
+        size_t numNewRecords = min((size_t) recordsRead, cacheRecordsBeforeWrap);
+        if (m_binaryCache->NumRecordsWritten() != cacheRecordBase)
+            m_binaryCache->Abandon(); // records arrived out of order (e.g. we started mid-dataset)
+        else if (numNewRecords > 0)
+            m_binaryCache->Append(&m_featureData[epochSample * m_featureCount], numNewRecords,
+                                  m_labelType == labelCategory ? &m_labelIdData[epochSample] : NULL,
+                                  m_labelType == labelRegression ? &m_labelData[epochSample] : NULL);
+        if (cacheRecordsBeforeWrap != size_t(-1)) // reached the end of the file: the cache is complete
+        {
+            m_binaryCache->Finalize(m_totalSamples);
+            if (m_binaryCache->TryLoad() && m_traceLevel > 0)
+                fprintf(stderr, "UCIFastReader: binary cache complete, subsequent epochs will be served from it\n");
+        }
+    }
+
     // if there more to read (always is, unless we want partial minibatches
     return moreToRead;
 }
@@ -198,7 +226,7 @@ size_t UCIFastReader<ElemType>::UpdateDataVariables(size_t mbStartSample)
         if (m_randomizeRange > m_epochSize)
         {
             m_randomizeRange = m_epochSize;
-            m_randomordering.Resize(m_randomizeRange, m_randomizeRange);
+            m_randomordering.Resize(m_randomizeRange, m_randomizeRange, m_randomizeOnTheFly);
         }
 
         // write the label file if we hit the end of the file
@@ -319,6 +347,8 @@ void UCIFastReader<ElemType>::InitFromConfig(const ConfigRecordType& readerConfi
     m_readNextSample = 0;
     m_traceLevel = readerConfig(L"traceLevel", 0);
     m_parser.SetTraceLevel(m_traceLevel);
+    // number of threads the parser may use to convert one read buffer (numeric files only)
+    m_parser.SetNumParserThreads(readerConfig(L"numParserThreads", (size_t) 1));
 
     m_prefetchEnabled = readerConfig(L"prefetch", false);
     // set the feature count to at least one (we better have one feature...)
@@ -345,6 +375,10 @@ void UCIFastReader<ElemType>::InitFromConfig(const ConfigRecordType& readerConfi
         m_randomizeRange = randomizeAuto;
     }
 
+    // constant-memory randomization: evaluate a block-pseudorandom ordering on the fly instead of
+    // materializing the index map (use for corpora too large to afford 4 bytes per sample)
+    m_randomizeOnTheFly = readerConfig(L"randomizeOnTheFly", false);
+
     // determine if we partial minibatches are desired
     std::string minibatchMode(readerConfig(L"minibatchMode", "partial"));
     m_partialMinibatch = !_stricmp(minibatchMode.c_str(), "partial");
@@ -417,13 +451,31 @@ void UCIFastReader<ElemType>::InitFromConfig(const ConfigRecordType& readerConfi
 
     // if we know the size of the randomization now, resize, otherwise wait until we know the epochSize in StartMinibatchLoop()
     if (Randomize() && m_randomizeRange != randomizeAuto)
-        m_randomordering.Resize(m_randomizeRange, m_randomizeRange);
+        m_randomordering.Resize(m_randomizeRange, m_randomizeRange, m_randomizeOnTheFly);
 
     // if the value they passed in as udim is not big enough, add something on
     if (udim < m_labelIdMax)
         udim = m_labelIdMax;
     m_labelDim = (LabelIdType) udim;
 
+    // columnar binary cache: the first pass over the text file writes out the parsed
+    // features/labels as raw blocks, subsequent epochs memory-map them and skip the parse
+    std::wstring cacheFile = readerConfig(L"cacheFile", L"");
+    if (!cacheFile.empty())
+    {
+        m_binaryCache.reset(new UCIBinaryCache<ElemType>(cacheFile, file, m_featureCount, m_labelType));
+        // category label ids are only meaningful when the mapping file existed up front
+        bool canReadCache = !(m_labelType == labelCategory && m_labelIdMax == 0);
+        if (canReadCache && m_binaryCache->TryLoad())
+        {
+            m_totalSamples = m_binaryCache->NumRecords();
+            if (m_traceLevel > 0)
+                fprintf(stderr, "UCIFastReader: serving %lu records from binary cache %ls\n", (unsigned long) m_totalSamples, cacheFile.c_str());
+        }
+        else
+            m_binaryCache->BeginWrite();
+    }
+
     mOneLinePerFile = readerConfig(L"oneLinePerFile", false);
 }
 
@@ -550,6 +602,26 @@ void UCIFastReader<ElemType>::ReleaseMemory()
 template <class ElemType>
 void UCIFastReader<ElemType>::SetupEpoch()
 {
+    // another process on this host may have finished building the shared cache since we
+    // last looked (e.g. the MPI rank that won the build lock); map it now so every rank
+    // serves from the same physical copy
+    if (m_binaryCache && !m_binaryCache->IsReadable() && !m_binaryCache->IsWriting() &&
+        !(m_labelType == labelCategory && m_labelIdMax == 0) && m_binaryCache->TryLoad())
+    {
+        m_totalSamples = m_binaryCache->NumRecords();
+        if (m_traceLevel > 0)
+            fprintf(stderr, "UCIFastReader: serving %lu records from binary cache built by another process\n", (unsigned long) m_totalSamples);
+    }
+
+    // serving from the binary cache: records are addressed directly, no file positioning needed
+    if (m_binaryCache && m_binaryCache->IsReadable())
+    {
+        if (!m_endReached)
+            UpdateDataVariables(0); // determine epoch size and randomization range from the known record count
+        m_readNextSample = m_epochStartSample = m_mbStartSample = m_epoch * m_epochSize;
+        return;
+    }
+
     // if we are starting fresh (epoch zero and no data read), init everything
     // however if we are using cachingWriter, we need to know record count, so do that first
     if (m_epoch == 0 && m_totalSamples == 0 && m_cachingWriter != NULL)
@@ -712,7 +784,7 @@ void UCIFastReader<ElemType>::StartDistributedMinibatchLoop(size_t mbSize, size_
         {
             if ((m_epochSize != requestDataSize && m_epochSize % m_randomizeRange != 0) || (m_randomizeRange % m_mbSize != 0))
                 RuntimeError("randomizeRange must be an even multiple of mbSize and an integral factor of epochSize");
-            m_randomordering.Resize(m_randomizeRange, m_randomizeRange);
+            m_randomordering.Resize(m_randomizeRange, m_randomizeRange, m_randomizeOnTheFly);
         }
     }
 
@@ -805,6 +877,159 @@ bool UCIFastReader<ElemType>::GetMinibatch(std::map<std::wstring, Matrix<ElemTyp
     return minibatchesRemaining;
 }
 
+// GetMinibatchFromCache - fill the next minibatch from the memory-mapped binary cache
+// Records are addressed by pointer arithmetic into the map, so no parsing or file reads
+// happen here beyond the page faults of the mapping itself.
+// matrices - [in] a map with named matrix types (i.e. 'features', 'labels') mapped to the corresponding matrix,
+//             [out] each matrix resized if necessary containing data.
+// returns - true if there are more minibatches, false if no more minibatchs remain
+template <class ElemType>
+bool UCIFastReader<ElemType>::GetMinibatchFromCache(std::map<std::wstring, Matrix<ElemType>*>& matrices)
+{
+    // get the features array
+    if (matrices.find(m_featuresName) == matrices.end())
+        RuntimeError("Features matrix not found in config file, there should be a section '%ls=[...]' in the configuration file.", m_featuresName.c_str());
+
+    Matrix<ElemType>& features = *matrices[m_featuresName];
+
+    // get out if they didn't call StartMinibatchLoop() first
+    if (m_mbSize == 0)
+        return false;
+
+    // check to see if we have changed epochs, if so we are done with this one.
+    if (m_mbStartSample / m_epochSize != m_epoch)
+        return false;
+
+    bool randomize = Randomize();
+    size_t epochSample = m_mbStartSample % m_epochSize; // where the minibatch starts in this epoch
+    size_t randomizeSet = randomize ? RandomizeSweep(m_mbStartSample) : 0;
+    const auto& tmap = m_randomordering(randomizeSet);
+    size_t recordStart = m_mbStartSample % m_totalSamples;
+
+    // actual size is either what requested, or total number of samples read so far
+    size_t actualmbsize = min(m_totalSamples, m_mbSize);
+
+    // check for an odd sized last minibatch
+    if (epochSample + actualmbsize > m_epochSize)
+        actualmbsize = m_epochSize - epochSample;
+
+    // in partial minibatch mode we stop at the end of the dataset instead of wrapping around
+    if (m_partialMinibatch)
+        actualmbsize = min(m_totalSamples - recordStart, actualmbsize);
+
+    if (m_featuresBuffer == NULL)
+    {
+        m_featuresBuffer = AllocateIntermediateBuffer(features.GetDeviceId(), m_mbSize * m_featureCount);
+        memset(m_featuresBuffer.get(), 0, sizeof(ElemType) * m_mbSize * m_featureCount);
+    }
+
+    if (m_labelsBuffer == NULL)
+    {
+        if (m_labelType == labelCategory)
+        {
+            m_labelsBuffer = AllocateIntermediateBuffer(features.GetDeviceId(), m_labelDim * m_mbSize);
+            m_labelsIdBuffer = std::shared_ptr<LabelIdType>(new LabelIdType[m_mbSize], [](LabelIdType* p)
+                                                            {
+                                                                delete[] p;
+                                                            });
+        }
+        else if (m_labelType != labelNone)
+        {
+            m_labelsBuffer = AllocateIntermediateBuffer(features.GetDeviceId(), m_mbSize);
+            m_labelsIdBuffer = NULL;
+        }
+    }
+
+    if (m_labelType == labelCategory)
+    {
+        memset(m_labelsBuffer.get(), 0, sizeof(ElemType) * m_labelDim * actualmbsize);
+        memset(m_labelsIdBuffer.get(), 0, sizeof(LabelIdType) * actualmbsize);
+    }
+    else if (m_labelType != labelNone)
+    {
+        memset(m_labelsBuffer.get(), 0, sizeof(ElemType) * 1 * actualmbsize);
+    }
+
+    if (actualmbsize > 0)
+    {
+        // determine randomization base index
+        size_t randBase = 0; // (keep compiler happy)
+        if (randomize)
+            randBase = epochSample - epochSample % m_randomizeRange;
+
+        // loop through all the samples, copying each record straight from the mapping
+        int j = 0;
+        for (size_t jSample = m_mbStartSample; j < actualmbsize; ++j, ++jSample)
+        {
+            // pick the right sample with randomization if desired
+            size_t jRand = randomize ? (randBase + tmap[jSample % m_randomizeRange]) : jSample;
+            jRand %= m_epochSize;
+
+            // epoch sample jRand lives at this record of the cache file
+            size_t fileRecord = (m_epoch * m_epochSize + jRand) % m_totalSamples;
+
+            // cached feature column goes into matrix column
+            memcpy(&m_featuresBuffer.get()[j * m_featureCount], m_binaryCache->Features(fileRecord), sizeof(ElemType) * m_featureCount);
+
+            if (m_labelType == labelCategory)
+            {
+                LabelIdType labelId = (LabelIdType) m_binaryCache->LabelId(fileRecord);
+                if (labelId >= m_labelDim)
+                    RuntimeError("binary cache contains label id %u outside of the label mapping (dimension %u), delete the cache file to rebuild it", (unsigned) labelId, (unsigned) m_labelDim);
+                m_labelsBuffer.get()[j * m_labelDim + labelId] = (ElemType) 1;
+                m_labelsIdBuffer.get()[j] = labelId;
+            }
+            else if (m_labelType == labelRegression)
+            {
+                m_labelsBuffer.get()[j] = m_binaryCache->LabelValue(fileRecord);
+            }
+        }
+    }
+
+    // There may be multiple parallel trainers reading at the same time in which case
+    // we will slice the data to only return the share of the current trainer's subset
+    size_t currSubsetStartCol = (actualmbsize * m_subsetNum) / m_numSubsets;
+    size_t currSubsetEndCol = (actualmbsize * (m_subsetNum + 1)) / m_numSubsets;
+    size_t currSubsetSize = currSubsetEndCol - currSubsetStartCol;
+    // create the respective MBLayout
+    // Every sample is returned as a sequence of 1 frame.
+    m_pMBLayout->InitAsFrameMode(currSubsetSize);
+
+    // advance to the next minibatch
+    m_mbStartSample += actualmbsize;
+
+    // if they don't want partial minibatches, skip data transfer and return
+    if (actualmbsize < m_mbSize && !m_partialMinibatch || actualmbsize == 0 || currSubsetSize == 0) // no records found (end of minibatch)
+    {
+        return false;
+    }
+
+    // now transfer to the GPU as needed
+    features.SetValue(m_featureCount, currSubsetSize, features.GetDeviceId(), m_featuresBuffer.get() + (m_featureCount * currSubsetStartCol), matrixFlagNormal);
+    if (m_labelType == labelCategory)
+    {
+        auto labelEntry = matrices.find(m_labelsName);
+        if (labelEntry != matrices.end())
+        {
+            Matrix<ElemType>* labels = labelEntry->second;
+            if (labels != nullptr)
+                labels->SetValue(m_labelDim, currSubsetSize, labels->GetDeviceId(), m_labelsBuffer.get() + (m_labelDim * currSubsetStartCol), matrixFlagNormal);
+        }
+    }
+    else if (m_labelType != labelNone)
+    {
+        auto labelEntry = matrices.find(m_labelsName);
+        if (labelEntry != matrices.end())
+        {
+            Matrix<ElemType>* labels = labelEntry->second;
+            if (labels != nullptr)
+                labels->SetValue(1, currSubsetSize, labels->GetDeviceId(), m_labelsBuffer.get() + (1 * currSubsetStartCol), matrixFlagNormal);
+        }
+    }
+    // we read some records, so process them
+    return true;
+}
+
 // GetMinibatchImpl - The actual implementation of getting the next minibatch (features and labels)
 // matrices - [in] a map with named matrix types (i.e. 'features', 'labels') mapped to the corresponding matrix,
 //             [out] each matrix resized if necessary containing data.
@@ -816,6 +1041,11 @@ bool UCIFastReader<ElemType>::GetMinibatchImpl(std::map<std::wstring, Matrix<Ele
     {
         return m_cachingReader->GetMinibatch(matrices);
     }
+    // serve straight out of the memory-mapped binary cache if we have one
+    if (m_binaryCache && m_binaryCache->IsReadable())
+    {
+        return GetMinibatchFromCache(matrices);
+    }
     // get the features array
     if (matrices.find(m_featuresName) == matrices.end())
         RuntimeError("Features matrix not found in config file, there should be a section '%ls=[...]' in the configuration file.", m_featuresName.c_str());
@@ -1075,7 +1305,10 @@ bool UCIFastReader<ElemType>::DataEnd(EndDataType endDataType)
         ret = (m_mbStartSample / m_epochSize != m_epoch);
         break;
     case endDataSet:
-        ret = EnsureDataAvailable(m_mbStartSample, true);
+        if (m_binaryCache && m_binaryCache->IsReadable()) // total record count is known, no need to read ahead
+            ret = (m_mbStartSample % m_totalSamples) != 0;
+        else
+            ret = EnsureDataAvailable(m_mbStartSample, true);
         break;
     case endDataSentence: // for fast reader each minibatch is considered a "sentence", so always true
         ret = true;
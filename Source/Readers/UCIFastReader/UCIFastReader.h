@@ -12,6 +12,7 @@
 #include "RandomOrdering.h"
 #include <future>
 #include "UCIParser.h"
+#include "UCIBinaryCache.h"
 #include <string>
 #include <map>
 #include <vector>
@@ -55,6 +56,7 @@ private:
     size_t m_epochStartSample;       // the starting sample for the epoch
     size_t m_totalSamples;           // number of samples in the dataset
     size_t m_randomizeRange;         // randomization range
+    bool m_randomizeOnTheFly;        // evaluate the random ordering on demand (constant memory)
     size_t m_featureCount;           // feature count
     size_t m_readNextSample;         // next sample to read
     bool m_labelFirst;               // the label is the first element in a line
@@ -108,6 +110,11 @@ private:
     void InitCache(const ConfigParameters& config);
     void InitCache(const ScriptableObjects::IConfigRecord& config);
 
+    // columnar binary cache ('cacheFile' config): written during the first pass over the
+    // text file, memory-mapped and served from directly in all subsequent epochs
+    std::unique_ptr<UCIBinaryCache<ElemType>> m_binaryCache;
+    bool GetMinibatchFromCache(std::map<std::wstring, Matrix<ElemType>*>& matrices);
+
     size_t RandomizeSweep(size_t epochSample);
     bool Randomize()
     {
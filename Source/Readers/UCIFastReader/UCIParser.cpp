@@ -10,6 +10,10 @@
 #include "UCIParser.h"
 #include <stdexcept>
 #include <stdint.h>
+#include <string.h>
+#include <future>
+#include <type_traits>
+#include <utility>
 
 #if WIN32
 #define ftell64 _ftelli64
@@ -17,6 +21,101 @@
 #define ftell64 ftell
 #endif
 
+// SSE2 is baseline on x64 and enabled for our x86 builds (-msse3 on Linux)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UCIPARSER_USE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// FindNewline - locate the next '\n' in [pos, end)
+// Scans 16 bytes per step with SSE2 compare/movemask; returns 'end' if none is found.
+static inline const BYTE* FindNewline(const BYTE* pos, const BYTE* end)
+{
+#ifdef UCIPARSER_USE_SSE2
+    const __m128i newlines = _mm_set1_epi8('\n');
+    while (pos + 16 <= end)
+    {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) pos), newlines));
+        if (mask != 0)
+        {
+#ifdef _MSC_VER
+            unsigned long bit;
+            _BitScanForward(&bit, (unsigned long) mask);
+            return pos + bit;
+#else
+            return pos + __builtin_ctz(mask);
+#endif
+        }
+        pos += 16;
+    }
+#endif
+    const BYTE* found = (const BYTE*) memchr(pos, '\n', end - pos);
+    return found != NULL ? found : end;
+}
+
+// ParseNumberFast - branch-minimal ASCII-to-double conversion for one token
+// Accumulates digits exactly like the state machine does (double mantissa, divider for the
+// fraction, pow() for the exponent), so results match the slow path bit for bit.
+// Advances pos past the number characters; 'valid' is cleared if the token is not a number.
+static inline double ParseNumberFast(const BYTE*& pos, const BYTE* end, bool& valid)
+{
+    const BYTE* p = pos;
+    double sign = 1;
+    if (p < end && (*p == '-' || *p == '+'))
+        sign = (*p++ == '-') ? -1 : 1;
+
+    const BYTE* digitsStart = p;
+    double value = 0;
+    while (p < end && (unsigned) (*p - '0') <= 9)
+        value = value * 10 + (*p++ - '0');
+
+    if (p < end && *p == '.')
+    {
+        p++;
+        double fraction = 0;
+        double divider = 1;
+        while (p < end && (unsigned) (*p - '0') <= 9)
+        {
+            fraction = fraction * 10 + (*p++ - '0');
+            divider *= 10;
+        }
+        value += fraction / divider;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        double exponentSign = 1;
+        if (p < end && (*p == '-' || *p == '+'))
+            exponentSign = (*p++ == '-') ? -1 : 1;
+        double exponent = 0;
+        while (p < end && (unsigned) (*p - '0') <= 9)
+            exponent = exponent * 10 + (*p++ - '0');
+        value = value * pow(10.0, exponentSign * exponent);
+    }
+
+    // the token must contain at least one digit and end at a delimiter
+    valid = (p > digitsStart) && (p == end || *p == ' ' || *p == '\t' || *p == '\r');
+    pos = p;
+    return sign * value;
+}
+
+// AppendLabelValue - store a numeric label value
+// The overload for string labels is never reached (the fast path is disabled for them),
+// but it must exist so that those template instantiations compile.
+template <typename LabelType>
+static inline void AppendLabelValue(std::vector<LabelType>* labels, double value)
+{
+    if (labels != NULL)
+        labels->push_back((LabelType) value);
+}
+static inline void AppendLabelValue(std::vector<std::string>* /*labels*/, double /*value*/)
+{
+}
+
 // SetState for a particular value
 template <typename NumType, typename LabelType>
 void UCIParser<NumType, LabelType>::SetState(int value, ParseState m_current_state, ParseState next_state)
@@ -235,6 +334,7 @@ void UCIParser<NumType, LabelType>::Init()
     PrepareStartPosition(0);
     m_fileBuffer = NULL;
     m_pFile = NULL;
+    m_numParserThreads = 1;
     m_stateTable = new DWORD[AllStateMax * 256];
     SetupStateTables();
 }
@@ -479,6 +579,13 @@ void UCIParser<NumType, LabelType>::SetTraceLevel(int traceLevel)
     m_traceLevel = traceLevel;
 }
 
+// SetNumParserThreads - number of threads Parse() may use to convert one buffer (default 1)
+template <typename NumType, typename LabelType>
+void UCIParser<NumType, LabelType>::SetNumParserThreads(size_t numThreads)
+{
+    m_numParserThreads = numThreads == 0 ? 1 : numThreads;
+}
+
 // Parse - Parse the data
 // recordsRequested - number of records requested
 // numbers - pointer to vector to return the numbers (must be allocated)
@@ -494,6 +601,11 @@ long UCIParser<NumType, LabelType>::Parse(size_t recordsRequested, std::vector<N
     m_numbers = numbers;
     m_labels = labels;
 
+    // fast path: numeric-only files are tokenized with SIMD scans instead of the
+    // byte-at-a-time state machine (string labels and line counting keep the slow path)
+    if (m_parseMode == ParseNormal && !std::is_same<LabelType, std::string>::value)
+        return ParseFast(recordsRequested, numbers, labels);
+
     long TickStart = GetTickCount();
     long recordCount = 0;
     size_t bufferIndex = m_byteCounter - m_bufferStart;
@@ -655,6 +767,179 @@ long UCIParser<NumType, LabelType>::Parse(size_t recordsRequested, std::vector<N
     return recordCount;
 }
 
+// ParseLineFast - convert one text line of whitespace-delimited numbers
+// Values are routed to the feature or label vector by their column index, mirroring
+// DoneWithValue(). Static so that worker threads can run it on shards concurrently.
+template <typename NumType, typename LabelType>
+void UCIParser<NumType, LabelType>::ParseLineFast(const BYTE* pos, const BYTE* end,
+                                                  size_t startFeatures, size_t dimFeatures, size_t startLabels, size_t dimLabels,
+                                                  std::vector<NumType>* numbers, std::vector<LabelType>* labels, int64_t& numbersConverted)
+{
+    if (numbers == NULL) // not storing: the state machine skips all processing in this case, too
+        return;
+
+    size_t index = 0; // element (column) index within the line
+    while (pos < end)
+    {
+        // skip delimiters
+        while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+            pos++;
+        if (pos == end)
+            break;
+
+        const BYTE* tokenStart = pos;
+        bool valid;
+        double value = ParseNumberFast(pos, end, valid);
+        if (!valid)
+        {
+            // skip the rest of the token; mirrors the state machine's handling of strings
+            while (pos < end && *pos != ' ' && *pos != '\t' && *pos != '\r')
+                pos++;
+            fprintf(stderr, "\n** String found in numeric-only file: %.*s\n", (int) (pos - tokenStart), tokenStart);
+            index++;
+            continue;
+        }
+
+        size_t stored = 0;
+        if (startLabels <= index && index < startLabels + dimLabels)
+        {
+            AppendLabelValue(labels, value);
+            numbersConverted++;
+            stored++;
+        }
+        if (startFeatures <= index && index < startFeatures + dimFeatures)
+        {
+            numbers->push_back((NumType) value);
+            numbersConverted++;
+            stored++;
+        }
+        index += stored == 0 ? 1 : stored; // skipped columns still advance the index
+    }
+}
+
+// ParseFast - fast path of Parse() for numeric-only files
+// Scans each buffer for complete lines with SIMD newline searches, then converts the lines
+// with the branch-minimal number parser -- either inline or, when SetNumParserThreads()
+// asked for more than one thread, sharded at line boundaries across concurrent workers
+// whose outputs are appended in shard order (so the resulting layout is unchanged).
+template <typename NumType, typename LabelType>
+long UCIParser<NumType, LabelType>::ParseFast(size_t recordsRequested, std::vector<NumType>* numbers, std::vector<LabelType>* labels)
+{
+    long TickStart = GetTickCount();
+    long recordCount = 0;
+
+    while (m_byteCounter < m_fileSize && (size_t) recordCount < recordsRequested)
+    {
+        // check to see if we need to update the buffer
+        size_t bufferValid = min(m_bufferSize, (size_t)(m_fileSize - m_bufferStart));
+        size_t bufferIndex = (size_t)(m_byteCounter - m_bufferStart);
+        if (bufferIndex >= bufferValid)
+        {
+            m_spaceDelimitedStart = m_byteCounter; // nothing needs to survive the refill
+            UpdateBuffer();
+            bufferValid = min(m_bufferSize, (size_t)(m_fileSize - m_bufferStart));
+            bufferIndex = (size_t)(m_byteCounter - m_bufferStart);
+        }
+
+        const BYTE* end = m_fileBuffer + bufferValid;
+        const BYTE* pos = m_fileBuffer + bufferIndex;
+        const bool atEndOfFile = m_bufferStart + bufferValid >= (size_t) m_fileSize;
+
+        // gather the extents of the complete lines in the buffer
+        std::vector<std::pair<const BYTE*, const BYTE*>> lines; // [begin, end) excluding the '\n'
+        bool prevWasNewline = m_current_state == EndOfLine;
+        while (pos < end && (size_t) recordCount + lines.size() < recordsRequested)
+        {
+            const BYTE* eol = FindNewline(pos, end);
+            if (eol == end)
+            {
+                if (!atEndOfFile)
+                    break; // the line continues in the next buffer
+                pos = end; // unterminated final line: consumed but never completed (matches the state machine)
+                break;
+            }
+            if (!(eol == pos && prevWasNewline)) // consecutive newlines do not start a new record
+                lines.push_back(std::make_pair(pos, eol));
+            prevWasNewline = true;
+            pos = eol + 1;
+        }
+
+        // no complete line in the buffer: slide the partial line to the front and refill
+        if (lines.empty() && pos == m_fileBuffer + bufferIndex && !atEndOfFile)
+        {
+            m_spaceDelimitedStart = m_byteCounter; // keep the partial line across the refill
+            m_byteCounter = m_bufferStart + bufferValid;
+            if ((size_t)(m_byteCounter - m_spaceDelimitedStart) >= m_bufferSize)
+                RuntimeError("UCIParser::Parse - a single line is longer than the read buffer");
+            UpdateBuffer();
+            m_byteCounter = m_spaceDelimitedStart; // rescan from the start of the line
+            continue;
+        }
+
+        if (m_numParserThreads > 1 && lines.size() >= m_numParserThreads * 4)
+        {
+            // shard the lines across worker threads, each converting into its own vectors
+            size_t numShards = m_numParserThreads;
+            size_t linesPerShard = (lines.size() + numShards - 1) / numShards;
+            std::vector<std::vector<NumType>> shardNumbers(numShards);
+            std::vector<std::vector<LabelType>> shardLabels(numShards);
+            std::vector<int64_t> shardConverted(numShards, 0);
+            std::vector<std::future<void>> workers;
+            for (size_t shard = 0; shard < numShards; shard++)
+            {
+                size_t beginLine = min(shard * linesPerShard, lines.size());
+                size_t endLine = min(beginLine + linesPerShard, lines.size());
+                if (beginLine >= endLine)
+                    break;
+                workers.push_back(std::async(std::launch::async, [this, &lines, &shardNumbers, &shardLabels, &shardConverted, shard, beginLine, endLine]
+                {
+                    for (size_t line = beginLine; line < endLine; line++)
+                        ParseLineFast(lines[line].first, lines[line].second,
+                                      m_startFeatures, m_dimFeatures, m_startLabels, m_dimLabels,
+                                      &shardNumbers[shard], &shardLabels[shard], shardConverted[shard]);
+                }));
+            }
+            for (auto& worker : workers)
+                worker.get();
+
+            for (size_t shard = 0; shard < numShards; shard++)
+            {
+                if (numbers != NULL)
+                    numbers->insert(numbers->end(), shardNumbers[shard].begin(), shardNumbers[shard].end());
+                if (labels != NULL)
+                    labels->insert(labels->end(), shardLabels[shard].begin(), shardLabels[shard].end());
+                m_totalNumbersConverted += shardConverted[shard];
+            }
+        }
+        else
+        {
+            for (const auto& line : lines)
+                ParseLineFast(line.first, line.second,
+                              m_startFeatures, m_dimFeatures, m_startLabels, m_dimLabels,
+                              numbers, labels, m_totalNumbersConverted);
+        }
+
+        if (m_traceLevel > 1)
+        {
+            // print progress dots
+            for (long r = recordCount + 1; r <= recordCount + (long) lines.size(); r++)
+                if (r % 100 == 0)
+                    fprintf(stderr, r % 10000 == 0 ? "#" : r % 1000 == 0 ? "+" : ".");
+        }
+
+        recordCount += (long) lines.size();
+        m_byteCounter = m_bufferStart + (pos - m_fileBuffer);
+        m_spaceDelimitedStart = m_byteCounter;
+        m_current_state = EndOfLine;
+    }
+
+    long TickStop = GetTickCount();
+
+    if (m_traceLevel > 2)
+        fprintf(stderr, "\n%ld ms, %ld numbers parsed\n\n", TickStop - TickStart, m_totalNumbersConverted);
+    return recordCount;
+}
+
 // StoreLabel - string version gets last space delimited string and stores in labels vector
 template <>
 void UCIParser<float, std::string>::StoreLabel(float /*finalResult*/)
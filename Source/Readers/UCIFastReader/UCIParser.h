@@ -132,6 +132,16 @@ private:
     // returns - number of records read
     size_t UpdateBuffer();
 
+    // number of worker threads ParseFast() may shard one buffer across
+    size_t m_numParserThreads;
+
+    // fast path for numeric-only files: SIMD newline scan, branch-minimal conversion,
+    // optional multi-threaded sharding (not used for string labels or line counting)
+    long ParseFast(size_t recordsRequested, std::vector<NumType>* numbers, std::vector<LabelType>* labels);
+    static void ParseLineFast(const BYTE* pos, const BYTE* end,
+                              size_t startFeatures, size_t dimFeatures, size_t startLabels, size_t dimLabels,
+                              std::vector<NumType>* numbers, std::vector<LabelType>* labels, int64_t& numbersConverted);
+
 public:
     // UCIParser constructor
     UCIParser();
@@ -164,6 +174,9 @@ public:
     // traceLevel - traceLevel, zero means no output, 1 epoch related output, > 1 all output
     void SetTraceLevel(int traceLevel);
 
+    // SetNumParserThreads - number of threads Parse() may use to convert one buffer (default 1)
+    void SetNumParserThreads(size_t numThreads);
+
     // ParseInit - Initialize a parse of a file
     // fileName - path to the file to open
     // startFeatures - column (zero based) where features start
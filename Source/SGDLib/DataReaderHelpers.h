@@ -6,16 +6,754 @@
 #include "DataReader.h"
 #include "ComputationNetwork.h"
 #include "MPIWrapper.h"
+#include "RegionProfiler.h"
 #include "SpecialPurposeNodes.h"        // for SequenceWithSoftmaxNode
 #include <string>
 #include <map>
 #include <set>
+#include <future>
+#include <memory>
+#include <stdlib.h> // for getenv() (minibatch capture/replay)
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
 /*static*/ struct DataReaderHelpers
 {
 
+    // -------------------------------------------------------------------
+    // MinibatchPrefetcher -- double-buffered read-ahead on top of any IDataReader
+    // -------------------------------------------------------------------
+    // While the network computes on minibatch N, a background task already runs
+    // GetMinibatch() for minibatch N+1 into a set of staging matrices, which are then
+    // handed over by swapping buffers. This generalizes the swap-based prefetch scheme
+    // that UCIFastReader implements internally to arbitrary readers. Readers that place
+    // their output on a GPU device perform the host-to-device copy from the background
+    // thread, so that transfer overlaps with computation as well.
+    // With readSideChannel, the sequence-training side channel (GetMinibatch4SE(): lattices,
+    // uids, phone boundaries, utterance map) is read from the background thread as well, so
+    // that reading and parsing the next minibatch's lattices from the archive overlaps with
+    // the current minibatch's compute. Note that the gamma computation itself cannot be moved
+    // ahead the same way: it consumes the network's acoustic scores for the very minibatch it
+    // belongs to, which only exist after that minibatch's forward pass.
+    template <class ElemType>
+    class MinibatchPrefetcher
+    {
+        IDataReader<ElemType>* m_reader;
+        std::map<std::wstring, std::unique_ptr<Matrix<ElemType>>> m_stagingMatrices;
+        MBLayoutPtr m_stagingLayout;
+        std::future<bool> m_pendingRead;
+        // staging buffers for the sequence-training side channel
+        bool m_readSideChannel;
+        std::vector<shared_ptr<const msra::dbn::latticepair>> m_stagingLattices;
+        std::vector<size_t> m_stagingUids, m_stagingBoundaries, m_stagingExtraUttMap;
+
+        void LaunchRead(const std::map<std::wstring, Matrix<ElemType>*>& inputMatrices)
+        {
+            // lazily create one staging matrix per input, on the input's device
+            for (const auto& iter : inputMatrices)
+            {
+                if (m_stagingMatrices.find(iter.first) == m_stagingMatrices.end())
+                    m_stagingMatrices[iter.first].reset(new Matrix<ElemType>(iter.second->GetDeviceId()));
+            }
+            m_pendingRead = std::async(std::launch::async, [this]()
+                                       {
+                                           PROFILE_REGION("PrefetchMinibatch"); // shows up as its own thread lane in the trace
+                                           std::map<std::wstring, Matrix<ElemType>*> stagingMatrices;
+                                           for (const auto& iter : m_stagingMatrices)
+                                               stagingMatrices[iter.first] = iter.second.get();
+                                           bool wasDataRead = m_reader->GetMinibatch(stagingMatrices);
+                                           if (wasDataRead)
+                                           {
+                                               m_reader->CopyMBLayoutTo(m_stagingLayout);
+                                               if (m_readSideChannel)
+                                                   m_reader->GetMinibatch4SE(m_stagingLattices, m_stagingUids, m_stagingBoundaries, m_stagingExtraUttMap);
+                                           }
+                                           return wasDataRead;
+                                       });
+        }
+
+    public:
+        MinibatchPrefetcher(IDataReader<ElemType>& reader, bool readSideChannel = false)
+            : m_reader(&reader), m_stagingLayout(make_shared<MBLayout>()), m_readSideChannel(readSideChannel)
+        {
+        }
+
+        // wait for any in-flight read and discard its result;
+        // must be called before StartMinibatchLoop() is issued for a new epoch
+        void Reset()
+        {
+            if (m_pendingRead.valid())
+                m_pendingRead.get();
+        }
+
+        ~MinibatchPrefetcher()
+        {
+            Reset();
+        }
+
+        // fetch the next minibatch into inputMatrices/pMBLayout, then immediately kick off
+        // the background read for the one after; with readSideChannel, the lattice arguments
+        // receive the staged side-channel data by swapping
+        bool GetMinibatch(std::map<std::wstring, Matrix<ElemType>*>& inputMatrices, MBLayoutPtr pMBLayout,
+                          std::vector<shared_ptr<const msra::dbn::latticepair>>* latticeinput = nullptr,
+                          std::vector<size_t>* uids = nullptr, std::vector<size_t>* boundaries = nullptr, std::vector<size_t>* extrauttmap = nullptr)
+        {
+            if (m_readSideChannel != (latticeinput != nullptr))
+                LogicError("MinibatchPrefetcher: side-channel arguments do not match the readSideChannel setting given at construction.");
+            if (!m_pendingRead.valid()) // first call after construction or Reset()
+                LaunchRead(inputMatrices);
+
+            bool wasDataRead = m_pendingRead.get();
+            if (!wasDataRead)
+                return false;
+
+            // hand the staged data to the network by swapping buffers, then read ahead
+            for (auto& iter : inputMatrices)
+            {
+                auto staging = m_stagingMatrices.find(iter.first);
+                if (staging == m_stagingMatrices.end())
+                    LogicError("MinibatchPrefetcher: no staging matrix for input %ls.", iter.first.c_str());
+                std::swap(*iter.second, *staging->second);
+            }
+            pMBLayout->CopyFrom(m_stagingLayout);
+            if (m_readSideChannel)
+            {
+                latticeinput->swap(m_stagingLattices);
+                uids->swap(m_stagingUids);
+                boundaries->swap(m_stagingBoundaries);
+                extrauttmap->swap(m_stagingExtraUttMap);
+            }
+
+            LaunchRead(inputMatrices);
+            return true;
+        }
+    };
+
+    // -------------------------------------------------------------------
+    // MinibatchCachingReader -- records a minibatch loop once, then replays it from memory
+    // -------------------------------------------------------------------
+    // Wraps any IDataReader. The first minibatch loop passes through to the wrapped
+    // reader and keeps a copy of every minibatch it serves (the input matrices on
+    // their original device, plus the MBLayout); every further loop replays those
+    // copies without touching the reader again. Repeated passes over the same small
+    // sample set--the learning-rate search probes every candidate rate this way--thus
+    // pay for reading and host-to-device transfer only once and are compute-only
+    // afterwards. The replayed loops must use the same minibatch size and sample
+    // count as the recorded one.
+    // Note: not usable with sequence training; GetMinibatch4SE() reads additional
+    // reader state (lattices etc.) that is not cached here.
+    template <class ElemType>
+    class MinibatchCachingReader : public IDataReader<ElemType>
+    {
+        struct CachedMinibatch
+        {
+            std::map<std::wstring, std::unique_ptr<Matrix<ElemType>>> matrices;
+            MBLayoutPtr layout;
+            size_t numParallelSequences;
+        };
+
+        IDataReader<ElemType>* m_reader;
+        std::vector<CachedMinibatch> m_cache;
+        size_t m_pos;     // next minibatch to replay
+        bool m_recording; // true while the first loop still passes through to the wrapped reader
+        bool m_started;   // has StartMinibatchLoop() been called at least once?
+        size_t m_mbSize, m_epochSamples; // loop arguments of the recording pass
+
+    public:
+        MinibatchCachingReader(IDataReader<ElemType>& reader)
+            : m_reader(&reader), m_pos(0), m_recording(false), m_started(false), m_mbSize(0), m_epochSamples(0)
+        {
+        }
+
+        virtual void Init(const ConfigParameters&) override
+        {
+            NOT_IMPLEMENTED; // wraps an already initialized reader
+        }
+        virtual void Init(const ScriptableObjects::IConfigRecord&) override
+        {
+            NOT_IMPLEMENTED;
+        }
+        virtual void Destroy() override
+        {
+        } // lifetime is owned by the creator, not the reader factory
+
+        virtual void StartMinibatchLoop(size_t mbSize, size_t epoch, size_t requestedEpochSamples = requestDataSize) override
+        {
+            if (!m_started) // first loop: record it
+            {
+                m_reader->StartMinibatchLoop(mbSize, epoch, requestedEpochSamples);
+                BeginRecording(mbSize, requestedEpochSamples);
+                return;
+            }
+            BeginReplay(mbSize, requestedEpochSamples);
+        }
+
+        virtual bool SupportsDistributedMBRead() const override
+        {
+            return m_reader->SupportsDistributedMBRead();
+        }
+        virtual void StartDistributedMinibatchLoop(size_t mbSize, size_t epoch, size_t subsetNum, size_t numSubsets, size_t requestedEpochSamples = requestDataSize) override
+        {
+            if (!m_started) // first loop: record this rank's subset
+            {
+                m_reader->StartDistributedMinibatchLoop(mbSize, epoch, subsetNum, numSubsets, requestedEpochSamples);
+                BeginRecording(mbSize, requestedEpochSamples);
+                return;
+            }
+            BeginReplay(mbSize, requestedEpochSamples);
+        }
+
+    private:
+        // record/replay bookkeeping shared by the plain and the distributed start; the wrapped
+        // reader has already been started (once, by whichever of the two starts ran first)
+        void BeginRecording(size_t mbSize, size_t requestedEpochSamples)
+        {
+            m_started = true;
+            m_recording = true;
+            m_mbSize = mbSize;
+            m_epochSamples = requestedEpochSamples;
+        }
+        void BeginReplay(size_t mbSize, size_t requestedEpochSamples)
+        {
+            if (mbSize != m_mbSize || requestedEpochSamples != m_epochSamples)
+                LogicError("MinibatchCachingReader: replayed loop asks for minibatchSize=%d/epochSamples=%d but minibatchSize=%d/epochSamples=%d were recorded.",
+                           (int) mbSize, (int) requestedEpochSamples, (int) m_mbSize, (int) m_epochSamples);
+            if (m_recording) // switching to replay: report what we hold
+            {
+                m_recording = false;
+                size_t bytes = 0;
+                for (const auto& mb : m_cache)
+                    for (const auto& iter : mb.matrices)
+                        bytes += iter.second->GetNumElements() * sizeof(ElemType);
+                fprintf(stderr, "MinibatchCachingReader: replaying %d cached minibatches (%.1f MB) from memory\n",
+                        (int) m_cache.size(), bytes / (1024.0 * 1024.0));
+            }
+            m_pos = 0;
+        }
+
+    public:
+
+        virtual bool GetMinibatch(std::map<std::wstring, Matrix<ElemType>*>& matrices) override
+        {
+            if (m_recording)
+            {
+                if (!m_reader->GetMinibatch(matrices))
+                    return false;
+                CachedMinibatch mb;
+                for (const auto& iter : matrices)
+                    mb.matrices[iter.first].reset(new Matrix<ElemType>(*iter.second, iter.second->GetDeviceId()));
+                mb.layout = make_shared<MBLayout>();
+                m_reader->CopyMBLayoutTo(mb.layout);
+                mb.numParallelSequences = m_reader->GetNumParallelSequences();
+                m_cache.push_back(std::move(mb));
+                return true;
+            }
+            if (m_pos >= m_cache.size())
+                return false;
+            const CachedMinibatch& mb = m_cache[m_pos];
+            for (auto& iter : matrices)
+            {
+                auto cached = mb.matrices.find(iter.first);
+                if (cached == mb.matrices.end())
+                    LogicError("MinibatchCachingReader: input %ls was not part of the recorded minibatches.", iter.first.c_str());
+                iter.second->SetValue(*cached->second);
+            }
+            m_pos++;
+            return true;
+        }
+
+        virtual size_t GetNumParallelSequences() override
+        {
+            if (m_recording || m_cache.empty())
+                return m_reader->GetNumParallelSequences();
+            return m_cache[m_pos > 0 ? m_pos - 1 : 0].numParallelSequences;
+        }
+
+        virtual void CopyMBLayoutTo(MBLayoutPtr pMBLayout) override
+        {
+            if (m_recording)
+                m_reader->CopyMBLayoutTo(pMBLayout);
+            else if (m_pos == 0)
+                LogicError("MinibatchCachingReader: CopyMBLayoutTo() called before any minibatch was replayed.");
+            else
+                pMBLayout->CopyFrom(m_cache[m_pos - 1].layout);
+        }
+
+        virtual bool DataEnd(EndDataType endDataType) override
+        {
+            if (m_recording)
+                return m_reader->DataEnd(endDataType);
+            return true; // replayed data has no reader-side end-of-data processing
+        }
+
+        virtual void SetRandomSeed(unsigned seed = 0) override
+        {
+            m_reader->SetRandomSeed(seed);
+        }
+        virtual int GetSentenceEndIdFromOutputLabel() override
+        {
+            return m_reader->GetSentenceEndIdFromOutputLabel();
+        }
+        virtual bool RequireSentenceSeg() const override
+        {
+            return m_reader->RequireSentenceSeg();
+        }
+    };
+
+    // -------------------------------------------------------------------
+    // DecimatingDistributedReader -- reader-side decimation for readers without native distributed reading
+    // -------------------------------------------------------------------
+    // Wraps any IDataReader and makes SupportsDistributedMBRead() true, so parallel training
+    // takes the distributed-reading path with every reader. In a distributed loop, the wrapped
+    // reader assembles each full minibatch into host-side scratch matrices, and only the columns
+    // of this rank's parallel-sequence range are packed and pushed into the consumer's (typically
+    // GPU-resident) input matrices. The fallback path for such readers -- materialize the full
+    // minibatch in the input nodes, then DecimateMinibatch() it in place -- pays a full-size
+    // host-to-device transfer plus two full copies per rank; through the wrapper, each rank
+    // transfers and copies only its own 1/numSubsets share, and with prefetching the full-batch
+    // assembly runs on the background thread. What the wrapper cannot eliminate is the decode
+    // itself: a reader that only exposes a sequential GetMinibatch() must decode all columns to
+    // advance its position; removing that requires native subset reads in the reader itself.
+    // Note: not usable with sequence training; GetMinibatch4SE() reads additional reader state
+    // (lattices etc.) that is not decimated here.
+    template <class ElemType>
+    class DecimatingDistributedReader : public IDataReader<ElemType>
+    {
+        IDataReader<ElemType>* m_reader;
+        size_t m_subsetNum, m_numSubsets;
+        bool m_decimating; // true inside a loop started through StartDistributedMinibatchLoop()
+        std::map<std::wstring, std::unique_ptr<Matrix<ElemType>>> m_scratch; // host-side full minibatch, one matrix per input stream
+        Matrix<ElemType> m_packed; // host-side packed subset columns, reused across streams
+        MBLayoutPtr m_layout;      // decimated layout of the last minibatch served
+
+    public:
+        DecimatingDistributedReader(IDataReader<ElemType>& reader)
+            : m_reader(&reader), m_subsetNum(0), m_numSubsets(1), m_decimating(false), m_packed(CPUDEVICE)
+        {
+        }
+
+        virtual void Init(const ConfigParameters&) override
+        {
+            NOT_IMPLEMENTED; // wraps an already initialized reader
+        }
+        virtual void Init(const ScriptableObjects::IConfigRecord&) override
+        {
+            NOT_IMPLEMENTED;
+        }
+        virtual void Destroy() override
+        {
+        } // lifetime is owned by the creator, not the reader factory
+
+        virtual void StartMinibatchLoop(size_t mbSize, size_t epoch, size_t requestedEpochSamples = requestDataSize) override
+        {
+            m_decimating = false; // non-distributed loops (e.g. before parallelizationStartEpoch) pass through undecimated
+            m_reader->StartMinibatchLoop(mbSize, epoch, requestedEpochSamples);
+        }
+
+        virtual bool SupportsDistributedMBRead() const override
+        {
+            return true;
+        }
+        virtual void StartDistributedMinibatchLoop(size_t mbSize, size_t epoch, size_t subsetNum, size_t numSubsets, size_t requestedEpochSamples = requestDataSize) override
+        {
+            m_subsetNum = subsetNum;
+            m_numSubsets = numSubsets;
+            m_decimating = numSubsets > 1;
+            // every rank runs the wrapped reader over the same full minibatch stream and keeps its slice
+            m_reader->StartMinibatchLoop(mbSize, epoch, requestedEpochSamples);
+        }
+
+        virtual bool GetMinibatch(std::map<std::wstring, Matrix<ElemType>*>& matrices) override
+        {
+            if (!m_decimating)
+                return m_reader->GetMinibatch(matrices);
+
+            // read the full minibatch into host-side scratch matrices
+            std::map<std::wstring, Matrix<ElemType>*> scratch;
+            for (const auto& iter : matrices)
+            {
+                auto& mat = m_scratch[iter.first];
+                if (!mat)
+                    mat.reset(new Matrix<ElemType>(CPUDEVICE));
+                scratch[iter.first] = mat.get();
+            }
+            if (!m_reader->GetMinibatch(scratch))
+                return false;
+
+            MBLayoutPtr fullLayout = make_shared<MBLayout>();
+            m_reader->CopyMBLayoutTo(fullLayout);
+            size_t numParallelSequences = fullLayout->GetNumParallelSequences();
+            size_t nT = fullLayout->GetNumTimeSteps();
+
+            // this rank's parallel-sequence range [st, en); the same split as DecimateMinibatch()
+            size_t st = numParallelSequences * m_subsetNum / m_numSubsets;
+            size_t en = numParallelSequences * (m_subsetNum + 1) / m_numSubsets;
+
+            // pack the subset columns on the host, then push only those to the consumer's device
+            for (auto& iter : matrices)
+            {
+                Matrix<ElemType>& full = *scratch[iter.first];
+                size_t numRows = full.GetNumRows();
+                if (full.GetNumCols() != numParallelSequences * nT)
+                    LogicError("DecimatingDistributedReader: input %ls has %d columns, but the MBLayout declares %d.",
+                               iter.first.c_str(), (int) full.GetNumCols(), (int) (numParallelSequences * nT));
+                if (en == st) // more ranks than parallel sequences: this rank sits this minibatch out
+                {
+                    iter.second->Resize(numRows, 0);
+                    continue;
+                }
+                // viewed as (numRows * numParallelSequences) x nT, the subset is a row slice,
+                // i.e. one contiguous block per time step, and the packed result already has
+                // the column order of a numRows x ((en - st) * nT) minibatch
+                m_packed.AssignRowSliceValuesOf(full.Reshaped(numRows * numParallelSequences, nT), st * numRows, (en - st) * numRows);
+                iter.second->SetValue(numRows, (en - st) * nT, iter.second->GetDeviceId(), m_packed.BufferPointer());
+            }
+
+            // decimate the layout: the sequences in [st, en), shifted down by st
+            m_layout = make_shared<MBLayout>(en - st, nT);
+            for (const auto& seq : fullLayout->GetAllSequences())
+            {
+                if (seq.s >= st && seq.s < en)
+                {
+                    auto shiftedSeq = seq;
+                    shiftedSeq.s -= st;
+                    m_layout->AddSequence(shiftedSeq);
+                }
+            }
+            return true;
+        }
+
+        virtual size_t GetNumParallelSequences() override
+        {
+            if (m_decimating && m_layout)
+                return m_layout->GetNumParallelSequences();
+            return m_reader->GetNumParallelSequences();
+        }
+
+        virtual void CopyMBLayoutTo(MBLayoutPtr pMBLayout) override
+        {
+            if (m_decimating && m_layout)
+                pMBLayout->CopyFrom(m_layout);
+            else
+                m_reader->CopyMBLayoutTo(pMBLayout);
+        }
+
+        virtual bool DataEnd(EndDataType endDataType) override
+        {
+            return m_reader->DataEnd(endDataType);
+        }
+
+        virtual void SetRandomSeed(unsigned seed = 0) override
+        {
+            m_reader->SetRandomSeed(seed);
+        }
+        virtual int GetSentenceEndIdFromOutputLabel() override
+        {
+            return m_reader->GetSentenceEndIdFromOutputLabel();
+        }
+        virtual bool RequireSentenceSeg() const override
+        {
+            return m_reader->RequireSentenceSeg();
+        }
+    };
+
+    // -------------------------------------------------------------------
+    // MinibatchFileCapture / MinibatchReplayReader -- record decoded minibatches to a file, replay them later
+    // -------------------------------------------------------------------
+    // For benchmarking compute changes with the reader out of the equation. A training run with
+    // environment variable CNTK_MB_CAPTURE=<file> set records the first CNTK_MB_CAPTURE_COUNT
+    // (default 64) decoded minibatches -- the input matrices exactly as handed to the network,
+    // after any decimation, plus the MBLayout -- into a binary file. A later run with
+    // CNTK_MB_REPLAY=<file> set substitutes a reader that serves the recorded minibatches from
+    // memory in a loop, so ForwardProp()/Backprop() changes are timed on exactly the data
+    // distribution of the real job, at zero reader cost. Unlike MinibatchCachingReader above,
+    // the recording survives the process, so capture and benchmark can be separate jobs.
+    //
+    // File format: a small header (magic, version, element size), then per minibatch the number
+    // of input streams, each stream's name/dimensions/elements, and the MBLayout as its dimensions
+    // plus all SequenceInfo records (gaps included). Multi-byte values are written in host byte
+    // order; the file is a local diagnostic artifact, not an interchange format.
+
+    template <class ElemType>
+    class MinibatchFileCapture
+    {
+        static const unsigned int s_fileMagic = 0x52424d43; // 'CMBR'
+        static const unsigned int s_fileVersion = 1;
+
+        FILE* m_file;
+        size_t m_numRemaining;
+        std::string m_path;
+
+        template <class T>
+        void WriteValue(T value)
+        {
+            if (fwrite(&value, sizeof(T), 1, m_file) != 1)
+                RuntimeError("MinibatchFileCapture: error writing to %s", m_path.c_str());
+        }
+
+    public:
+        MinibatchFileCapture()
+            : m_file(nullptr), m_numRemaining(0)
+        {
+        }
+        ~MinibatchFileCapture()
+        {
+            if (m_file != nullptr)
+                fclose(m_file);
+        }
+
+        bool IsCapturing() const
+        {
+            return m_file != nullptr;
+        }
+
+        void Begin(const std::string& path, size_t numMinibatches)
+        {
+            m_path = path;
+            m_file = fopen(path.c_str(), "wb");
+            if (m_file == nullptr)
+                RuntimeError("MinibatchFileCapture: cannot create %s", path.c_str());
+            m_numRemaining = numMinibatches;
+            WriteValue(s_fileMagic);
+            WriteValue(s_fileVersion);
+            WriteValue((unsigned int) sizeof(ElemType));
+            fprintf(stderr, "MinibatchFileCapture: recording up to %d minibatches to %s\n", (int) numMinibatches, path.c_str());
+        }
+
+        void CaptureMinibatch(const std::map<std::wstring, Matrix<ElemType>*>& inputMatrices, const MBLayoutPtr& pMBLayout)
+        {
+            if (!IsCapturing())
+                return;
+
+            WriteValue((unsigned int) inputMatrices.size());
+            ElemType* tempArray = nullptr;
+            size_t tempArraySize = 0;
+            for (const auto& iter : inputMatrices)
+            {
+                std::string name = msra::strfun::utf8(iter.first);
+                WriteValue((unsigned int) name.size());
+                if (!name.empty() && fwrite(name.data(), 1, name.size(), m_file) != name.size())
+                    RuntimeError("MinibatchFileCapture: error writing to %s", m_path.c_str());
+                WriteValue((unsigned long long) iter.second->GetNumRows());
+                WriteValue((unsigned long long) iter.second->GetNumCols());
+                iter.second->CopyToArray(tempArray, tempArraySize); // brings GPU data to a host buffer
+                size_t numElements = iter.second->GetNumElements();
+                if (numElements > 0 && fwrite(tempArray, sizeof(ElemType), numElements, m_file) != numElements)
+                    RuntimeError("MinibatchFileCapture: error writing to %s", m_path.c_str());
+            }
+            delete[] tempArray;
+
+            std::vector<long long> layoutData;
+            pMBLayout->SerializeTo(layoutData); // run-length span records, O(#sequences)
+            if (fwrite(layoutData.data(), sizeof(long long), layoutData.size(), m_file) != layoutData.size())
+                RuntimeError("MinibatchFileCapture: error writing to %s", m_path.c_str());
+
+            if (--m_numRemaining == 0)
+            {
+                fclose(m_file);
+                m_file = nullptr;
+                fprintf(stderr, "MinibatchFileCapture: capture to %s complete\n", m_path.c_str());
+            }
+        }
+    };
+
+    template <class ElemType>
+    class MinibatchReplayReader : public IDataReader<ElemType>
+    {
+        struct RecordedMinibatch
+        {
+            std::map<std::wstring, std::unique_ptr<Matrix<ElemType>>> matrices; // in host memory
+            MBLayoutPtr layout;
+            size_t numCols; // samples this minibatch counts towards the epoch
+        };
+
+        std::vector<RecordedMinibatch> m_minibatches;
+        size_t m_pos;              // next minibatch to serve (wraps around)
+        size_t m_lastServed;       // minibatch the last GetMinibatch() call served
+        size_t m_samplesRemaining; // samples left in the current epoch; requestDataSize means one single pass
+        size_t m_servedThisEpoch;
+
+        FILE* m_file;
+        std::string m_path;
+
+        template <class T>
+        T ReadValue()
+        {
+            T value;
+            if (fread(&value, sizeof(T), 1, m_file) != 1)
+                RuntimeError("MinibatchReplayReader: error reading %s (truncated capture?)", m_path.c_str());
+            return value;
+        }
+
+    public:
+        MinibatchReplayReader(const std::string& path)
+            : m_pos(0), m_lastServed(0), m_samplesRemaining(0), m_servedThisEpoch(0), m_path(path)
+        {
+            m_file = fopen(path.c_str(), "rb");
+            if (m_file == nullptr)
+                RuntimeError("MinibatchReplayReader: cannot open %s", path.c_str());
+            if (ReadValue<unsigned int>() != 0x52424d43)
+                RuntimeError("MinibatchReplayReader: %s is not a minibatch capture file", path.c_str());
+            if (ReadValue<unsigned int>() != 1)
+                RuntimeError("MinibatchReplayReader: %s has an unsupported capture version", path.c_str());
+            if (ReadValue<unsigned int>() != sizeof(ElemType))
+                RuntimeError("MinibatchReplayReader: %s was captured with a different element size", path.c_str());
+
+            size_t bytes = 0;
+            std::vector<ElemType> buffer;
+            for (;;)
+            {
+                unsigned int numStreams;
+                if (fread(&numStreams, sizeof(numStreams), 1, m_file) != 1)
+                    break; // clean EOF: all recorded minibatches read
+
+                RecordedMinibatch mb;
+                for (unsigned int i = 0; i < numStreams; i++)
+                {
+                    unsigned int nameSize = ReadValue<unsigned int>();
+                    std::string name(nameSize, 0);
+                    if (nameSize > 0 && fread(&name[0], 1, nameSize, m_file) != nameSize)
+                        RuntimeError("MinibatchReplayReader: error reading %s (truncated capture?)", m_path.c_str());
+                    size_t rows = (size_t) ReadValue<unsigned long long>();
+                    size_t cols = (size_t) ReadValue<unsigned long long>();
+                    buffer.resize(rows * cols);
+                    if (rows * cols > 0 && fread(buffer.data(), sizeof(ElemType), rows * cols, m_file) != rows * cols)
+                        RuntimeError("MinibatchReplayReader: error reading %s (truncated capture?)", m_path.c_str());
+                    std::unique_ptr<Matrix<ElemType>> matrix(new Matrix<ElemType>(CPUDEVICE));
+                    matrix->SetValue(rows, cols, CPUDEVICE, buffer.data());
+                    mb.numCols = cols;
+                    bytes += rows * cols * sizeof(ElemType);
+                    mb.matrices[msra::strfun::utf16(name)] = std::move(matrix);
+                }
+
+                std::vector<long long> layoutData(3); // layout header: numParallelSequences, numTimeSteps, numSequences
+                if (fread(layoutData.data(), sizeof(long long), 3, m_file) != 3)
+                    RuntimeError("MinibatchReplayReader: error reading %s (truncated capture?)", m_path.c_str());
+                layoutData.resize(3 + 4 * (size_t) layoutData[2]); // one span record per sequence
+                if (fread(layoutData.data() + 3, sizeof(long long), layoutData.size() - 3, m_file) != layoutData.size() - 3)
+                    RuntimeError("MinibatchReplayReader: error reading %s (truncated capture?)", m_path.c_str());
+                mb.layout = make_shared<MBLayout>();
+                mb.layout->DeserializeFrom(layoutData.data(), layoutData.size()); // replays gap records and reader-assigned ids verbatim
+                m_minibatches.push_back(std::move(mb));
+            }
+            fclose(m_file);
+            m_file = nullptr;
+
+            if (m_minibatches.empty())
+                RuntimeError("MinibatchReplayReader: %s contains no minibatches", path.c_str());
+            fprintf(stderr, "MinibatchReplayReader: loaded %d recorded minibatches (%.1f MB) from %s\n",
+                    (int) m_minibatches.size(), bytes / (1024.0 * 1024.0), path.c_str());
+        }
+
+        virtual void Init(const ConfigParameters&) override
+        {
+            NOT_IMPLEMENTED; // constructed directly from a capture file, not through the reader factory
+        }
+        virtual void Init(const ScriptableObjects::IConfigRecord&) override
+        {
+            NOT_IMPLEMENTED;
+        }
+        virtual void Destroy() override
+        {
+        } // lifetime is owned by the creator, not the reader factory
+
+        virtual void StartMinibatchLoop(size_t /*mbSize*/, size_t /*epoch*/, size_t requestedEpochSamples = requestDataSize) override
+        {
+            // the recorded minibatches are served as-is regardless of the requested size; the
+            // sample count decides when the epoch ends. requestDataSize means one single pass.
+            m_samplesRemaining = requestedEpochSamples;
+            m_servedThisEpoch = 0;
+        }
+
+        virtual void StartDistributedMinibatchLoop(size_t mbSize, size_t epoch, size_t /*subsetNum*/, size_t /*numSubsets*/, size_t requestedEpochSamples = requestDataSize) override
+        {
+            // each rank replays its own capture file (captures are taken after decimation)
+            StartMinibatchLoop(mbSize, epoch, requestedEpochSamples);
+        }
+        virtual bool SupportsDistributedMBRead() const override
+        {
+            return true;
+        }
+
+        virtual bool GetMinibatch(std::map<std::wstring, Matrix<ElemType>*>& matrices) override
+        {
+            if (m_samplesRemaining == requestDataSize) // single pass
+            {
+                if (m_servedThisEpoch >= m_minibatches.size())
+                    return false;
+            }
+            else if (m_samplesRemaining == 0)
+                return false;
+
+            if (m_pos >= m_minibatches.size())
+                m_pos = 0; // loop
+            const RecordedMinibatch& mb = m_minibatches[m_pos];
+            for (auto& iter : matrices)
+            {
+                auto recorded = mb.matrices.find(iter.first);
+                if (recorded == mb.matrices.end())
+                    RuntimeError("MinibatchReplayReader: input %ls was not part of the capture.", iter.first.c_str());
+                iter.second->SetValue(*recorded->second); // SetValue() handles the transfer if the target lives on a GPU
+            }
+            m_lastServed = m_pos;
+            m_pos++;
+            m_servedThisEpoch++;
+            if (m_samplesRemaining != requestDataSize)
+                m_samplesRemaining -= (m_samplesRemaining > mb.numCols) ? mb.numCols : m_samplesRemaining;
+            return true;
+        }
+
+        virtual size_t GetNumParallelSequences() override
+        {
+            return m_minibatches[m_lastServed].layout->GetNumParallelSequences();
+        }
+
+        virtual void CopyMBLayoutTo(MBLayoutPtr pMBLayout) override
+        {
+            pMBLayout->CopyFrom(m_minibatches[m_lastServed].layout);
+        }
+
+        virtual bool DataEnd(EndDataType) override
+        {
+            return true; // replayed data has no reader-side end-of-data processing
+        }
+    };
+
+    // -------------------------------------------------------------------
+    // AuditMinibatchLayout() -- cross-check MBLayout metadata against the delivered minibatch (CNTK_MB_AUDIT=1)
+    // -------------------------------------------------------------------
+    // The steady-state training loop takes all per-minibatch sample bookkeeping from host-side
+    // MBLayout metadata (DetermineActualMBSizeFromFeatures() and GetActualNumSamples() read only
+    // layout counters and never touch device data, so the only device synchronization left per
+    // minibatch is the criterion fetch). This audit verifies that the metadata actually agrees
+    // with what the reader delivered: every input matrix must match the layout's column count,
+    // and the layout's incremental sample counters must match a recount over its sequence spans.
+    // Enable it via CNTK_MB_AUDIT=1 when a reader is suspected of layout drift.
+    template <class ElemType>
+    static void AuditMinibatchLayout(const std::map<std::wstring, Matrix<ElemType>*>& inputMatrices, const MBLayoutPtr& pMBLayout)
+    {
+        size_t numCols = pMBLayout->GetNumCols();
+        for (const auto& iter : inputMatrices)
+        {
+            if (iter.second->GetNumCols() != numCols)
+                LogicError("AuditMinibatchLayout: input '%ls' has %d columns, but the MBLayout declares %d.",
+                           iter.first.c_str(), (int) iter.second->GetNumCols(), (int) numCols);
+        }
+
+        size_t numFrames = 0, numGapFrames = 0;
+        for (const auto& seq : pMBLayout->GetAllSequences())
+        {
+            size_t b = (size_t) std::max(seq.tBegin, (ptrdiff_t) 0);
+            size_t e = std::min(seq.tEnd, pMBLayout->GetNumTimeSteps());
+            numFrames += e - b;
+            if (seq.seqId == GAP_SEQUENCE_ID)
+                numGapFrames += e - b;
+        }
+        if (pMBLayout->GetActualNumSamples() != numFrames - numGapFrames)
+            LogicError("AuditMinibatchLayout: MBLayout sample counters say %d actual samples, but its sequence spans add up to %d.",
+                       (int) pMBLayout->GetActualNumSamples(), (int) (numFrames - numGapFrames));
+    }
+
     // -------------------------------------------------------------------
     // GetMinibatchIntoNetwork() -- get one minibatch from Reader (this->trainSetDataReader) into Network (this->net)
     // Returns false if no data is read. In that case, no other return value can be expected to contain meaningful values (e.g. actualMBSize will be unchanged).
@@ -31,7 +769,8 @@ namespace Microsoft { namespace MSR { namespace CNTK {
                                         bool useDistributedMBReading,
                                         bool useParallelTrain,
                                         std::map<std::wstring, Matrix<ElemType>*>& inputMatrices,
-                                        size_t& actualMBSize)
+                                        size_t& actualMBSize,
+                                        MinibatchPrefetcher<ElemType>* prefetcher = nullptr)
     {
         auto pMBLayout = net->GetMBLayoutPtr();
         // Reading consists of a sequence of Reader API calls:
@@ -39,8 +778,24 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         //  - SetActualMiniBatchSizeFromFeatures()  --tells Network to resize the nodes' buffers
         //  - CopyMBLayoutTo()   --copies the MBLayout from Reader to Network
         // with the special twist that in presence of parallelization, there is some decimation involved.
+        // When a prefetcher is passed, the first two steps come out of its staging buffers
+        // while the reader already works on the next minibatch in the background.
 
-        bool wasDataRead = trainSetDataReader.GetMinibatch(inputMatrices); // fill in the minibatch data into the Input nodes' buffers directly
+        // determine the sequence-training side-channel targets up front, so that a prefetcher
+        // can hand over its staged copies together with the minibatch data
+        std::vector<shared_ptr<const msra::dbn::latticepair>>* latticeinput = nullptr;
+        std::vector<size_t>*uids = nullptr, *boundaries = nullptr, *extrauttmap = nullptr;
+        if ((criterionNode != nullptr) && (criterionNode->OperationName() == L"SequenceWithSoftmax"))
+        {
+            auto node = dynamic_pointer_cast<SequenceWithSoftmaxNode<ElemType>>(criterionNode);
+            latticeinput = node->getLatticePtr();
+            uids = node->getuidprt();
+            boundaries = node->getboundaryprt();
+            extrauttmap = node->getextrauttmap();
+        }
+
+        bool wasDataRead = prefetcher ? prefetcher->GetMinibatch(inputMatrices, pMBLayout, latticeinput, uids, boundaries, extrauttmap)
+                                      : trainSetDataReader.GetMinibatch(inputMatrices); // fill in the minibatch data into the Input nodes' buffers directly
         // If this returns false, the matrices may contain garbage or not sized to 0 columns.
         // On the other hand, if it returns a 0-column matrix, that would be a perfectly cromulent minibatch (in case of data parallelism with distributed reading).
 
@@ -48,21 +803,15 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         if (!wasDataRead)
             return false;
 
-        // get some additional information when doing sequence training
+        // get the additional sequence-training information when not prefetching (the prefetcher
+        // already read it on the background thread, along with the minibatch data)
         // TODO: This should not need to be called in case of wasDataRead == false, since in that case, returned values are invalid.
-        if ((criterionNode != nullptr) && (criterionNode->OperationName() == L"SequenceWithSoftmax"))
-        {
-            auto node = dynamic_pointer_cast<SequenceWithSoftmaxNode<ElemType>>(criterionNode);
-            auto latticeinput = node->getLatticePtr();
-            auto uids = node->getuidprt();
-            auto boundaries = node->getboundaryprt();
-            auto extrauttmap = node->getextrauttmap();
-
+        if (latticeinput != nullptr && prefetcher == nullptr)
             trainSetDataReader.GetMinibatch4SE(*latticeinput, *uids, *boundaries, *extrauttmap);
-        }
 
-        // get layout meta-data
-        trainSetDataReader.CopyMBLayoutTo(pMBLayout);
+        // get layout meta-data (the prefetcher already copied it along with the data)
+        if (prefetcher == nullptr)
+            trainSetDataReader.CopyMBLayoutTo(pMBLayout);
 
         // decimate if needed. Decimation happens in-place.
         if (!useDistributedMBReading && useParallelTrain)
@@ -85,6 +834,33 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         // BUGBUG: This has a definitional problem once we support multiple feature streams with different lenghts.
         actualMBSize = net->DetermineActualMBSizeFromFeatures();
 
+        // CNTK_MB_AUDIT=1: verify the layout metadata the bookkeeping above relies on
+        static bool s_auditChecked = false;
+        static bool s_audit = false;
+        if (!s_auditChecked)
+        {
+            s_auditChecked = true;
+            s_audit = (getenv("CNTK_MB_AUDIT") != nullptr);
+        }
+        if (s_audit)
+            AuditMinibatchLayout(inputMatrices, pMBLayout);
+
+        // CNTK_MB_CAPTURE=<file>: record the decoded minibatches exactly as the network sees them,
+        // for later replay through MinibatchReplayReader (see above)
+        static MinibatchFileCapture<ElemType> s_capture;
+        static bool s_captureChecked = false;
+        if (!s_captureChecked)
+        {
+            s_captureChecked = true;
+            const char* capturePath = getenv("CNTK_MB_CAPTURE");
+            if (capturePath != nullptr)
+            {
+                const char* captureCount = getenv("CNTK_MB_CAPTURE_COUNT");
+                s_capture.Begin(capturePath, (captureCount != nullptr) ? (size_t) atoi(captureCount) : 64);
+            }
+        }
+        s_capture.CaptureMinibatch(inputMatrices, pMBLayout);
+
         return true;
     }
 
@@ -430,9 +1206,9 @@ namespace Microsoft { namespace MSR { namespace CNTK {
             for (auto x : m_NetStatefulNodes)
             {
                 wstring name = x.first;
-                if (m_NetStates[name].empty())
+                if (m_NetStates[name].size() < actualnumSubminibatches)
                 {
-                    // this only happens in the first minibatch in an epoch
+                    // grow only; the split count may vary from minibatch to minibatch
                     m_NetStates[name].resize(actualnumSubminibatches);
                 }
             }
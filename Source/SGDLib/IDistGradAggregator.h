@@ -21,6 +21,19 @@ public:
     // Returns a boolean indicating if any samples were processed
     virtual bool AggregateGradients(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, int epochNumber) = 0;
 
+    // Overlapped (per-layer) aggregation: aggregators that support it can start aggregating an
+    // individual gradient as soon as backprop has finalized it, instead of waiting for the full
+    // backward pass; AggregateGradients() then only completes the outstanding work. Aggregators
+    // that do not support this simply ignore the notification.
+    virtual bool SupportsOverlappedAggregation() const
+    {
+        return false;
+    }
+
+    virtual void MarkGradientReady(Matrix<ElemType>* /*gradient*/)
+    {
+    }
+
     size_t NumProc()
     {
         return m_mpi->NumNodesInUse();
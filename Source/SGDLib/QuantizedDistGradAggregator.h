@@ -0,0 +1,440 @@
+#pragma once
+
+#include "IDistGradAggregator.h"
+#include "CUDAPageLockedMemAllocator.h"
+#include "MatrixQuantizerImpl.h"
+#include "QuantizedMatrix.h"
+#include "TimerUtility.h"
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Aggregates gradients in quantized form using the in-tree MatrixQuantizer machinery
+// (ColumnQuantizer / QuantizedMatrix), so reduced-precision aggregation is available without the
+// external quantized-aggregation package (QUANTIZED_GRADIENT_AGGREGATION builds).
+//
+// The exchange is a two-phase column-striped allreduce. Each node owns a contiguous stripe of every
+// gradient's columns. In phase one every node quantizes its local gradients (feeding the
+// quantization error back into a per-gradient residual that is added to the next minibatch's
+// gradient) and sends each peer the quantized stripe that peer owns; the received stripes are
+// dequantized and summed into the owned stripe. In phase two the aggregated stripe is re-quantized
+// (with its own error-feedback residual) and broadcast to all peers, so every node dequantizes the
+// identical packets and the model replicas stay bitwise in sync. Only quantized packets ever cross
+// the wire: for 1-bit quantization that is a ~32x traffic reduction for float gradients.
+template <class ElemType>
+class QuantizedDistGradAggregator : public IDistGradAggregator<ElemType>
+{
+    UsingIDistGradAggregatorMembers;
+
+public:
+    QuantizedDistGradAggregator(MPIWrapper* mpi, size_t numGradientBits, bool zeroThresholdFor1Bit, int syncStatsTrace)
+        : IDistGradAggregator<ElemType>(mpi), m_numGradientBits(numGradientBits), m_zeroThresholdFor1Bit(zeroThresholdFor1Bit),
+          m_initialized(false), m_syncStatsTrace(syncStatsTrace), m_iterationCount(0)
+    {
+        if ((m_numGradientBits < 1) || (m_numGradientBits > (8 * sizeof(ElemType))))
+            InvalidArgument("QuantizedDistGradAggregator: gradientBits must be in [1, %d].", (int) (8 * sizeof(ElemType)));
+    }
+
+    ~QuantizedDistGradAggregator()
+    {
+        // return the quantizers to the process-lifetime pool so a later aggregator reuses their
+        // device contexts, streams and intermediate buffers instead of re-establishing them
+        for (size_t i = 0; i < m_quantizers.size(); ++i)
+        {
+            MatrixQuantizerImpl<ElemType>::Recycle(m_quantizers[i].release());
+        }
+
+        for (size_t i = 0; i < m_recvHeaders.size(); ++i)
+        {
+            DistGradHeader::Destroy(m_recvHeaders[i]);
+        }
+    }
+
+    // Aggregate the gradient matrices across all nodes
+    bool AggregateGradients(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, int epochNumber) override
+    {
+        UNUSED(epochNumber);
+
+        if (!m_initialized)
+            Initialize(gradients, headerCPU->numEvalNode);
+
+        bool showSyncPerfStats = (m_syncStatsTrace > 0) && ((m_iterationCount % m_syncStatsTrace) == 0);
+        m_iterationCount++;
+
+        AggregateGradientsImpl(gradients, headerCPU, showSyncPerfStats);
+        return (headerCPU->numSamples != 0);
+    }
+
+private:
+    // contiguous range of columns of one gradient owned by one node
+    struct Stripe
+    {
+        size_t startCol;
+        size_t numCols;
+    };
+
+    // balanced column partition; the first (numCols % NumProc()) stripes are one column bigger
+    Stripe GetStripe(size_t numCols, size_t rank)
+    {
+        size_t numProc = NumProc();
+        size_t stripeSize = numCols / numProc;
+        size_t numBiggerStripes = numCols % numProc;
+        Stripe stripe;
+        stripe.startCol = (rank * stripeSize) + std::min((size_t) rank, numBiggerStripes);
+        stripe.numCols = stripeSize + ((rank < numBiggerStripes) ? 1 : 0);
+        return stripe;
+    }
+
+    void Initialize(const std::vector<Matrix<ElemType>*>& gradients, int numEvalNodes)
+    {
+        int deviceId = gradients[0]->GetDeviceId();
+        if (deviceId != CPUDEVICE)
+        {
+            m_allocator.reset(new CUDAPageLockedMemAllocator(deviceId));
+        }
+
+        size_t numProc = NumProc();
+        for (size_t i = 0; i < gradients.size(); i++)
+        {
+            // Make sure none of the gradient matrixes are sparse - we currently do not support aggregation of sparse gradient matrices
+            if (gradients[i]->GetMatrixType() != DENSE)
+                RuntimeError("Gradient aggregation for sparse gradient matrices is currently unsupported!");
+
+            size_t numRows = gradients[i]->GetNumRows();
+            size_t numCols = gradients[i]->GetNumCols();
+            m_qColSizes.push_back(QuantizedColumn<ElemType>::QuantizedColumnSize(m_numGradientBits, numRows));
+
+            m_quantizers.push_back(std::unique_ptr<MatrixQuantizerImpl<ElemType>>(MatrixQuantizerImpl<ElemType>::CreatePersistent(deviceId, true /*useAsync*/)));
+            m_quantizers.back()->Prewarm(numRows, numCols, m_numGradientBits); // intermediate device buffers allocated here, not on the first minibatch
+
+            // residual for quantizing the local gradient (error feedback across minibatches)
+            m_preAggResiduals.push_back(std::unique_ptr<Matrix<ElemType>>(new Matrix<ElemType>(numRows, numCols, deviceId)));
+            m_preAggResiduals.back()->SetValue(0);
+
+            // quantized form of the full local gradient; also reused as the receive buffer for the
+            // aggregated stripes in the second exchange phase. Lives on the CPU (page-locked for GPU
+            // gradients) since this is what goes over the wire.
+            m_gradQuantized.push_back(std::unique_ptr<QuantizedMatrix<ElemType>>(
+                new QuantizedMatrix<ElemType>(numRows, numCols, m_numGradientBits, CPUDEVICE, m_allocator.get())));
+
+            // the column stripe of this gradient owned by this node, and its re-quantization state
+            Stripe myStripe = GetStripe(numCols, MyRank());
+            m_myStripes.push_back(myStripe);
+            if (myStripe.numCols > 0)
+            {
+                m_aggGradStripes.push_back(std::unique_ptr<Matrix<ElemType>>(new Matrix<ElemType>(numRows, myStripe.numCols, deviceId)));
+                m_stripeResiduals.push_back(std::unique_ptr<Matrix<ElemType>>(new Matrix<ElemType>(numRows, myStripe.numCols, deviceId)));
+                m_stripeResiduals.back()->SetValue(0);
+                m_aggQuantized.push_back(std::unique_ptr<QuantizedMatrix<ElemType>>(
+                    new QuantizedMatrix<ElemType>(numRows, myStripe.numCols, m_numGradientBits, CPUDEVICE, m_allocator.get())));
+            }
+            else
+            {
+                m_aggGradStripes.push_back(nullptr);
+                m_stripeResiduals.push_back(nullptr);
+                m_aggQuantized.push_back(nullptr);
+            }
+
+            // receive buffers for the peers' quantized contributions to our stripe
+            m_recvQuantized.push_back(std::vector<std::unique_ptr<QuantizedMatrix<ElemType>>>());
+            for (size_t j = 0; j < numProc - 1; j++)
+            {
+                if (myStripe.numCols > 0)
+                {
+                    m_recvQuantized.back().push_back(std::unique_ptr<QuantizedMatrix<ElemType>>(
+                        new QuantizedMatrix<ElemType>(numRows, myStripe.numCols, m_numGradientBits, CPUDEVICE, m_allocator.get())));
+                }
+                else
+                {
+                    m_recvQuantized.back().push_back(nullptr);
+                }
+            }
+        }
+
+        if (m_mpi->IsMainNode())
+        {
+            for (size_t i = 0; i < NumProc() - 1; ++i)
+            {
+                m_recvHeaders.push_back(DistGradHeader::Create(numEvalNodes));
+            }
+        }
+
+        m_initialized = true;
+    }
+
+    void AggregateGradientsImpl(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool showSyncPerfStats)
+    {
+        Timer aggregationTimer;
+        int deviceId = gradients[0]->GetDeviceId();
+        if (showSyncPerfStats)
+        {
+            std::unique_ptr<MatrixComputeStreamEvent> mainStreamSyncEvent(MatrixComputeStreamEvent::Create(deviceId));
+            mainStreamSyncEvent->SynchronizeEvent();
+            aggregationTimer.Start();
+        }
+
+        size_t numGradMatrices = gradients.size();
+
+        if (headerCPU->numSamples == 0)
+        {
+            assert(headerCPU->criterion == 0);
+            for (int i = 0; i < headerCPU->numEvalNode; ++i)
+            {
+                assert(headerCPU->evalErrors[i] == 0);
+            }
+
+            // If the current node did not process any samples, the gradients should be zero'd
+            for (size_t i = 0; i < numGradMatrices; ++i)
+            {
+                gradients[i]->SetValue(0);
+            }
+        }
+
+        // Initiate receive of the header on the main node
+        std::vector<MPI_Request> recvHeaderRequests(NumProc() - 1);
+        if (m_mpi->IsMainNode())
+        {
+            for (size_t j = 0; j < NumProc() - 1; ++j)
+            {
+                int source = (j >= MyRank()) ? (j + 1) : j;
+                // We use a tag of 'numGradMatrices' for the pre-aggregation header
+                MPI_Irecv(m_recvHeaders[j], m_recvHeaders[j]->Size(), MPI_CHAR, source, numGradMatrices, m_mpi->Communicator(), &(recvHeaderRequests[j])) || MpiFail("MPI_Irecv");
+            }
+        }
+
+        // Send the headers from all nodes but the main node
+        MPI_Request sendHeaderRequest;
+        if (!m_mpi->IsMainNode())
+        {
+            MPI_Isend(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank(), numGradMatrices, m_mpi->Communicator(), &sendHeaderRequest) || MpiFail("MPI_Isend");
+        }
+
+        // Initiate receive of the peers' quantized contributions to our stripe. Tag 'i' identifies
+        // gradient i's phase-one packets. Posted before any compute so arrivals can land immediately.
+        std::vector<MPI_Request> recvStripeRequests;
+        for (size_t i = 0; i < numGradMatrices; ++i)
+        {
+            if (m_myStripes[i].numCols == 0)
+                continue;
+            for (size_t j = 0; j < NumProc() - 1; ++j)
+            {
+                int source = (j >= MyRank()) ? (j + 1) : j;
+                MPI_Request recvRequest;
+                MPI_Irecv(m_recvQuantized[i][j]->GetArray(), (int) (m_qColSizes[i] * m_myStripes[i].numCols), MPI_CHAR, source, (int) i, m_mpi->Communicator(), &recvRequest) || MpiFail("MPI_Irecv");
+                recvStripeRequests.push_back(recvRequest);
+            }
+        }
+
+        // Phase 1: quantize the local gradients, feeding the quantization error back into the residual.
+        // All quantizations are launched up front on the quantizer streams; we then complete them one
+        // gradient at a time and post each gradient's sends as soon as its packet is in host memory,
+        // overlapping the wire with the fetches still in flight.
+        for (size_t i = 0; i < numGradMatrices; ++i)
+        {
+            m_quantizers[i]->QuantizeAsync(*gradients[i], *m_preAggResiduals[i], *m_gradQuantized[i], *m_preAggResiduals[i], m_zeroThresholdFor1Bit);
+        }
+        std::vector<MPI_Request> sendStripeRequests;
+        for (size_t i = 0; i < numGradMatrices; ++i)
+        {
+            m_quantizers[i]->WaitQuantizeAsyncDone();
+
+            // send each peer the quantized stripe of columns it owns
+            for (size_t rank = 0; rank < NumProc(); ++rank)
+            {
+                if (rank == MyRank())
+                    continue;
+                Stripe stripe = GetStripe(gradients[i]->GetNumCols(), rank);
+                if (stripe.numCols == 0)
+                    continue;
+                MPI_Request sendRequest;
+                MPI_Isend(m_gradQuantized[i]->GetQuantizedColumn(stripe.startCol), (int) (m_qColSizes[i] * stripe.numCols), MPI_CHAR, (int) rank, (int) i, m_mpi->Communicator(), &sendRequest) || MpiFail("MPI_Isend");
+                sendStripeRequests.push_back(sendRequest);
+            }
+        }
+
+        // Our own contribution: dequantize our quantized stripe into the aggregation stripe. Using the
+        // quantized (not original) values keeps the aggregate identical on all nodes.
+        for (size_t i = 0; i < numGradMatrices; ++i)
+        {
+            if (m_myStripes[i].numCols == 0)
+                continue;
+            QuantizedMatrix<ElemType> ownStripe = m_gradQuantized[i]->ColumnSlice(m_myStripes[i].startCol, m_myStripes[i].numCols);
+            m_quantizers[i]->UnquantizeAsync(ownStripe, *m_aggGradStripes[i], false /*add*/);
+            m_quantizers[i]->WaitUnquantizeAsyncDone();
+        }
+
+        // As the peers' stripes arrive, dequantize-add them into the aggregation stripe
+        if (!recvStripeRequests.empty())
+        {
+            MPI_Waitall((int) recvStripeRequests.size(), recvStripeRequests.data(), MPI_STATUSES_IGNORE) || MpiFail("MPI_Waitall");
+        }
+        for (size_t i = 0; i < numGradMatrices; ++i)
+        {
+            if (m_myStripes[i].numCols == 0)
+                continue;
+            for (size_t j = 0; j < NumProc() - 1; ++j)
+            {
+                m_quantizers[i]->UnquantizeAsync(*m_recvQuantized[i][j], *m_aggGradStripes[i], true /*add*/);
+                m_quantizers[i]->WaitUnquantizeAsyncDone();
+            }
+        }
+
+        // Phase 2: re-quantize the aggregated stripe (with its own error-feedback residual) and
+        // broadcast it; packets use tag 'numGradMatrices + 1 + i'. Same launch-all/complete-one-
+        // at-a-time pattern as phase 1, so each stripe hits the wire as soon as it is ready.
+        for (size_t i = 0; i < numGradMatrices; ++i)
+        {
+            if (m_myStripes[i].numCols == 0)
+                continue;
+            m_quantizers[i]->QuantizeAsync(*m_aggGradStripes[i], *m_stripeResiduals[i], *m_aggQuantized[i], *m_stripeResiduals[i], m_zeroThresholdFor1Bit);
+        }
+
+        // Receive the other nodes' aggregated stripes directly into place in the full quantized matrix
+        std::vector<MPI_Request> recvAggStripeRequests;
+        for (size_t i = 0; i < numGradMatrices; ++i)
+        {
+            for (size_t rank = 0; rank < NumProc(); ++rank)
+            {
+                if (rank == MyRank())
+                    continue;
+                Stripe stripe = GetStripe(gradients[i]->GetNumCols(), rank);
+                if (stripe.numCols == 0)
+                    continue;
+                MPI_Request recvRequest;
+                MPI_Irecv(m_gradQuantized[i]->GetQuantizedColumn(stripe.startCol), (int) (m_qColSizes[i] * stripe.numCols), MPI_CHAR, (int) rank, (int) (numGradMatrices + 1 + i), m_mpi->Communicator(), &recvRequest) || MpiFail("MPI_Irecv");
+                recvAggStripeRequests.push_back(recvRequest);
+            }
+        }
+
+        // As each re-quantized stripe completes, copy it into place and send it to all peers
+        std::vector<MPI_Request> sendAggStripeRequests;
+        for (size_t i = 0; i < numGradMatrices; ++i)
+        {
+            if (m_myStripes[i].numCols == 0)
+                continue;
+            m_quantizers[i]->WaitQuantizeAsyncDone();
+            memcpy(m_gradQuantized[i]->GetQuantizedColumn(m_myStripes[i].startCol), m_aggQuantized[i]->GetArray(), m_qColSizes[i] * m_myStripes[i].numCols);
+            for (size_t rank = 0; rank < NumProc(); ++rank)
+            {
+                if (rank == MyRank())
+                    continue;
+                MPI_Request sendRequest;
+                MPI_Isend(m_aggQuantized[i]->GetArray(), (int) (m_qColSizes[i] * m_myStripes[i].numCols), MPI_CHAR, (int) rank, (int) (numGradMatrices + 1 + i), m_mpi->Communicator(), &sendRequest) || MpiFail("MPI_Isend");
+                sendAggStripeRequests.push_back(sendRequest);
+            }
+        }
+
+        // On the main node wait for the headers to arrive and aggregate
+        if (m_mpi->IsMainNode())
+        {
+            size_t numNodesHeadersReceivedFrom = 0;
+            while (numNodesHeadersReceivedFrom < (NumProc() - 1))
+            {
+                int idx = MPI_UNDEFINED;
+                MPI_Waitany(recvHeaderRequests.size(), recvHeaderRequests.data(), &idx, MPI_STATUS_IGNORE) || MpiFail("MPI_Waitany");
+                if (idx == MPI_UNDEFINED)
+                {
+                    break;
+                }
+
+                numNodesHeadersReceivedFrom++;
+
+                headerCPU->Aggregate(m_recvHeaders[idx], true);
+            }
+
+            assert(numNodesHeadersReceivedFrom == (NumProc() - 1));
+        }
+
+        MPI_Request recvAggHeaderRequest;
+        // Initiate receive of the aggregate header
+        if (!m_mpi->IsMainNode())
+        {
+            MPI_Irecv(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank(), numGradMatrices + 1 + numGradMatrices, m_mpi->Communicator(), &recvAggHeaderRequest) || MpiFail("MPI_Irecv");
+        }
+
+        // Intiate send of the aggregate header from main node
+        std::vector<MPI_Request> sendAggHeaderRequests(NumProc() - 1);
+        if (m_mpi->IsMainNode())
+        {
+            for (size_t j = 0; j < NumProc() - 1; ++j)
+            {
+                int dest = (j >= MyRank()) ? (j + 1) : j;
+                MPI_Isend(headerCPU, headerCPU->Size(), MPI_CHAR, dest, numGradMatrices + 1 + numGradMatrices, m_mpi->Communicator(), &(sendAggHeaderRequests[j])) || MpiFail("MPI_Isend");
+            }
+        }
+
+        // Wait for all aggregated stripes and dequantize the full quantized matrix back into the gradient
+        if (!recvAggStripeRequests.empty())
+        {
+            MPI_Waitall((int) recvAggStripeRequests.size(), recvAggStripeRequests.data(), MPI_STATUSES_IGNORE) || MpiFail("MPI_Waitall");
+        }
+        for (size_t i = 0; i < numGradMatrices; ++i)
+        {
+            m_quantizers[i]->UnquantizeAsync(*m_gradQuantized[i], *gradients[i], false /*add*/);
+        }
+        for (size_t i = 0; i < numGradMatrices; ++i)
+        {
+            m_quantizers[i]->WaitUnquantizeAsyncDone();
+        }
+
+        // Wait to receive aggregate header
+        if (!m_mpi->IsMainNode())
+        {
+            MPI_Wait(&recvAggHeaderRequest, MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+        }
+
+        // Wait for completion of the async send requests
+        if (!sendStripeRequests.empty())
+        {
+            MPI_Waitall((int) sendStripeRequests.size(), sendStripeRequests.data(), MPI_STATUSES_IGNORE) || MpiFail("MPI_Waitall");
+        }
+        if (!sendAggStripeRequests.empty())
+        {
+            MPI_Waitall((int) sendAggStripeRequests.size(), sendAggStripeRequests.data(), MPI_STATUSES_IGNORE) || MpiFail("MPI_Waitall");
+        }
+        if (!m_mpi->IsMainNode())
+        {
+            MPI_Wait(&sendHeaderRequest, MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+        }
+        else
+        {
+            MPI_Waitall(sendAggHeaderRequests.size(), sendAggHeaderRequests.data(), MPI_STATUSES_IGNORE) || MpiFail("MPI_Waitall");
+        }
+
+        if (showSyncPerfStats)
+        {
+            aggregationTimer.Stop();
+            double epochTime = aggregationTimer.ElapsedSeconds();
+            fprintf(stderr, "Actual quantized gradient aggregation time: %.6g\n", epochTime);
+        }
+    }
+
+private:
+    std::unique_ptr<CUDAPageLockedMemAllocator> m_allocator;
+
+    size_t m_numGradientBits;
+    bool m_zeroThresholdFor1Bit;
+
+    // per-gradient quantization state; see Initialize() for what each piece holds
+    std::vector<std::unique_ptr<MatrixQuantizerImpl<ElemType>>> m_quantizers;
+    std::vector<std::unique_ptr<Matrix<ElemType>>> m_preAggResiduals;
+    std::vector<std::unique_ptr<QuantizedMatrix<ElemType>>> m_gradQuantized;
+    std::vector<Stripe> m_myStripes;
+    std::vector<std::unique_ptr<Matrix<ElemType>>> m_aggGradStripes;
+    std::vector<std::unique_ptr<Matrix<ElemType>>> m_stripeResiduals;
+    std::vector<std::unique_ptr<QuantizedMatrix<ElemType>>> m_aggQuantized;
+    std::vector<std::vector<std::unique_ptr<QuantizedMatrix<ElemType>>>> m_recvQuantized;
+    std::vector<size_t> m_qColSizes; // bytes of one quantized column, per gradient
+
+    std::vector<DistGradHeader*> m_recvHeaders;
+
+    bool m_initialized;
+
+    int m_syncStatsTrace;
+
+    // Only used for controlling frequency of measuring/showing gradient aggregation perf stats
+    size_t m_iterationCount;
+};
+} } }
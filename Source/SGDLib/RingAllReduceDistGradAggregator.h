@@ -0,0 +1,397 @@
+#pragma once
+
+#include "IDistGradAggregator.h"
+#include "CUDAPageLockedMemAllocator.h"
+#include "GPUDataTransferer.h"
+#include "TimerUtility.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Aggregates gradients using an explicit ring allreduce instead of per-matrix MPI_Iallreduce calls.
+// All gradient matrices are packed into one contiguous buffer which is then reduced in two phases
+// (reduce-scatter followed by allgather) over a ring of the participating nodes. Each node only ever
+// talks to its two ring neighbors, so the reduction is bandwidth-bound rather than latency-bound and
+// the cost of issuing one collective per gradient matrix is amortized away. Within each ring step the
+// chunk owned by the step is further split into fixed-size segments whose receives are pipelined with
+// the local reduction, overlapping communication and compute.
+template <class ElemType>
+class RingAllReduceDistGradAggregator : public IDistGradAggregator<ElemType>
+{
+    UsingIDistGradAggregatorMembers;
+
+    // Number of elements per pipelined segment within a ring step
+    static const size_t c_segmentNumElements = 1 << 20;
+
+public:
+    RingAllReduceDistGradAggregator(MPIWrapper* mpi, int syncStatsTrace)
+        : IDistGradAggregator<ElemType>(mpi), m_initialized(false), m_syncStatsTrace(syncStatsTrace), m_iterationCount(0), m_totalGradientsSizeInElements(0)
+    {
+    }
+
+    ~RingAllReduceDistGradAggregator()
+    {
+        for (size_t i = 0; i < m_recvHeaders.size(); ++i)
+        {
+            DistGradHeader::Destroy(m_recvHeaders[i]);
+        }
+    }
+
+    // Aggregate the gradient matrices across all nodes
+    bool AggregateGradients(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, int epochNumber) override
+    {
+        UNUSED(epochNumber);
+
+        if (!m_initialized)
+            Initialize(gradients, headerCPU->numEvalNode);
+
+        bool showSyncPerfStats = (m_syncStatsTrace > 0) && ((m_iterationCount % m_syncStatsTrace) == 0);
+        m_iterationCount++;
+
+        AggregateGradientsImpl(gradients, headerCPU, showSyncPerfStats);
+        return (headerCPU->numSamples != 0);
+    }
+
+private:
+    std::shared_ptr<ElemType> AllocateBuffer(int deviceId, size_t numElements)
+    {
+        // Use pinned memory for GPU devices for better copy performance
+        if (deviceId >= 0)
+        {
+            return std::shared_ptr<ElemType>((ElemType*) m_allocator->Malloc(sizeof(ElemType) * numElements), [this](ElemType* p)
+                                             {
+                                                 m_allocator->Free(p);
+                                             });
+        }
+
+        return std::shared_ptr<ElemType>(new ElemType[numElements], [](ElemType* p)
+                                         {
+                                             delete[] p;
+                                         });
+    }
+
+    void Initialize(const std::vector<Matrix<ElemType>*>& gradients, int numEvalNodes)
+    {
+        int deviceId = gradients[0]->GetDeviceId();
+        if (deviceId != CPUDEVICE)
+        {
+            m_allocator.reset(new CUDAPageLockedMemAllocator(deviceId));
+        }
+
+        // Compute the offset of each gradient matrix in the packed aggregation buffer
+        m_totalGradientsSizeInElements = 0;
+        for (size_t i = 0; i < gradients.size(); i++)
+        {
+            // Make sure none of the gradient matrixes are sparse - we currently do not support aggregation of sparse gradient matrices
+            if (gradients[i]->GetMatrixType() != DENSE)
+                RuntimeError("Gradient aggregation for sparse gradient matrices is currently unsupported!");
+
+            m_gradientOffsets.push_back(m_totalGradientsSizeInElements);
+            m_totalGradientsSizeInElements += gradients[i]->GetNumElements();
+
+            if (deviceId != CPUDEVICE)
+            {
+                m_gpuDataTransferers.push_back(std::unique_ptr<GPUDataTransferer<ElemType>>(new GPUDataTransferer<ElemType>(deviceId, false /*useConcurrentCUDAStreams*/)));
+            }
+        }
+
+        m_aggregationBuffer = AllocateBuffer(deviceId, m_totalGradientsSizeInElements);
+
+        // Partition the packed buffer into one chunk per node for the ring phases; the first
+        // (totalSize % numProc) chunks are one element bigger so the chunks cover the buffer exactly
+        size_t numProc = NumProc();
+        size_t chunkSize = m_totalGradientsSizeInElements / numProc;
+        size_t numBiggerChunks = m_totalGradientsSizeInElements % numProc;
+        m_chunkOffsets.push_back(0);
+        for (size_t c = 0; c < numProc; c++)
+        {
+            m_chunkOffsets.push_back(m_chunkOffsets[c] + chunkSize + ((c < numBiggerChunks) ? 1 : 0));
+        }
+
+        // The receive staging buffer needs to hold the segments of one chunk during reduce-scatter
+        size_t maxChunkSize = chunkSize + ((numBiggerChunks > 0) ? 1 : 0);
+        if ((numProc > 1) && (maxChunkSize > 0))
+        {
+            m_recvSegmentBuffer = AllocateBuffer(deviceId, maxChunkSize);
+        }
+
+        if (m_mpi->IsMainNode())
+        {
+            for (size_t i = 0; i < NumProc() - 1; ++i)
+            {
+                m_recvHeaders.push_back(DistGradHeader::Create(numEvalNodes));
+            }
+        }
+
+        m_initialized = true;
+    }
+
+    void AggregateGradientsImpl(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool showSyncPerfStats)
+    {
+        Timer aggregationTimer;
+        int deviceId = gradients[0]->GetDeviceId();
+        if (showSyncPerfStats)
+        {
+            std::unique_ptr<MatrixComputeStreamEvent> mainStreamSyncEvent(MatrixComputeStreamEvent::Create(deviceId));
+            mainStreamSyncEvent->SynchronizeEvent();
+            aggregationTimer.Start();
+        }
+
+        size_t numGradMatrices = gradients.size();
+
+        if (headerCPU->numSamples == 0)
+        {
+            assert(headerCPU->criterion == 0);
+            for (int i = 0; i < headerCPU->numEvalNode; ++i)
+            {
+                assert(headerCPU->evalErrors[i] == 0);
+            }
+
+            // If the current node did not process any samples, the gradients should be zero'd
+            for (size_t i = 0; i < numGradMatrices; ++i)
+            {
+                gradients[i]->SetValue(0);
+            }
+        }
+
+        // Initiate transfer of the gradient matrices into the packed CPU buffer
+        if (deviceId >= 0)
+        {
+            for (size_t i = 0; i < numGradMatrices; ++i)
+            {
+                m_gpuDataTransferers[i]->CopyGPUToCPUAsync(gradients[i]->BufferPointer(), gradients[i]->GetNumElements(), m_aggregationBuffer.get() + m_gradientOffsets[i]);
+            }
+        }
+
+        // Initiate receive of the header on the main node
+        std::vector<MPI_Request> recvHeaderRequests(NumProc() - 1);
+        if (m_mpi->IsMainNode())
+        {
+            for (size_t j = 0; j < NumProc() - 1; ++j)
+            {
+                int source = (j >= MyRank()) ? (j + 1) : j;
+                // We use a tag of 'numGradMatrices' for the pre-aggregation header
+                MPI_Irecv(m_recvHeaders[j], m_recvHeaders[j]->Size(), MPI_CHAR, source, numGradMatrices, m_mpi->Communicator(), &(recvHeaderRequests[j])) || MpiFail("MPI_Irecv");
+            }
+        }
+
+        // Send the headers from all nodes but the main node
+        MPI_Request sendHeaderRequest;
+        if (!m_mpi->IsMainNode())
+        {
+            MPI_Isend(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank(), numGradMatrices, m_mpi->Communicator(), &sendHeaderRequest) || MpiFail("MPI_Isend");
+        }
+
+        // Wait for the device-to-host transfers (or pack the CPU-side gradients) and run the ring
+        if (deviceId >= 0)
+        {
+            for (size_t i = 0; i < numGradMatrices; ++i)
+            {
+                m_gpuDataTransferers[i]->WaitForCopyGPUToCPUAsync();
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < numGradMatrices; ++i)
+            {
+                memcpy(m_aggregationBuffer.get() + m_gradientOffsets[i], gradients[i]->BufferPointer(), sizeof(ElemType) * gradients[i]->GetNumElements());
+            }
+        }
+
+        RingAllReduce(m_aggregationBuffer.get(), (int) (2 * numGradMatrices + 2) /*baseTag*/);
+
+        // On the main node wait for the headers to arrive and aggregate
+        if (m_mpi->IsMainNode())
+        {
+            size_t numNodesHeadersReceivedFrom = 0;
+            while (numNodesHeadersReceivedFrom < (NumProc() - 1))
+            {
+                int idx = MPI_UNDEFINED;
+                MPI_Waitany(recvHeaderRequests.size(), recvHeaderRequests.data(), &idx, MPI_STATUS_IGNORE) || MpiFail("MPI_Waitany");
+                if (idx == MPI_UNDEFINED)
+                {
+                    break;
+                }
+
+                numNodesHeadersReceivedFrom++;
+
+                headerCPU->Aggregate(m_recvHeaders[idx], true);
+            }
+
+            assert(numNodesHeadersReceivedFrom == (NumProc() - 1));
+        }
+
+        MPI_Request recvAggHeaderRequest;
+        // Initiate receive of the aggregate header
+        if (!m_mpi->IsMainNode())
+        {
+            MPI_Irecv(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank(), numGradMatrices + 1 + numGradMatrices, m_mpi->Communicator(), &recvAggHeaderRequest) || MpiFail("MPI_Irecv");
+        }
+
+        // Intiate send of the aggregate header from main node
+        std::vector<MPI_Request> sendAggHeaderRequests(NumProc() - 1);
+        if (m_mpi->IsMainNode())
+        {
+            for (size_t j = 0; j < NumProc() - 1; ++j)
+            {
+                int dest = (j >= MyRank()) ? (j + 1) : j;
+                MPI_Isend(headerCPU, headerCPU->Size(), MPI_CHAR, dest, numGradMatrices + 1 + numGradMatrices, m_mpi->Communicator(), &(sendAggHeaderRequests[j])) || MpiFail("MPI_Isend");
+            }
+        }
+
+        // Initiate transfer of the aggregated gradients back out of the packed buffer
+        if (deviceId >= 0)
+        {
+            for (size_t i = 0; i < numGradMatrices; ++i)
+            {
+                m_gpuDataTransferers[i]->CopyCPUToGPUAsync(m_aggregationBuffer.get() + m_gradientOffsets[i], gradients[i]->GetNumElements(), gradients[i]->BufferPointer());
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < numGradMatrices; ++i)
+            {
+                memcpy(gradients[i]->BufferPointer(), m_aggregationBuffer.get() + m_gradientOffsets[i], sizeof(ElemType) * gradients[i]->GetNumElements());
+            }
+        }
+
+        // Wait to receive aggregate header
+        if (!m_mpi->IsMainNode())
+        {
+            MPI_Wait(&recvAggHeaderRequest, MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+        }
+
+        // Wait for all the transfers to finish
+        if (deviceId >= 0)
+        {
+            for (size_t i = 0; i < numGradMatrices; ++i)
+            {
+                m_gpuDataTransferers[i]->WaitForCopyCPUToGPUAsync();
+            }
+        }
+
+        // Wait for completion of the async send requests
+        if (!m_mpi->IsMainNode())
+        {
+            MPI_Wait(&sendHeaderRequest, MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+        }
+        else
+        {
+            MPI_Waitall(sendAggHeaderRequests.size(), sendAggHeaderRequests.data(), MPI_STATUSES_IGNORE) || MpiFail("MPI_Waitall");
+        }
+
+        if (showSyncPerfStats)
+        {
+            aggregationTimer.Stop();
+            double epochTime = aggregationTimer.ElapsedSeconds();
+            fprintf(stderr, "Actual gradient aggregation time: %.6g\n", epochTime);
+        }
+    }
+
+    // Sum 'buffer' element-wise across all nodes using a reduce-scatter phase followed by an
+    // allgather phase over the ring. After P-1 reduce-scatter steps each node owns the fully
+    // reduced chunk (rank + 1) % P, which the allgather phase then circulates around the ring.
+    void RingAllReduce(ElemType* buffer, int baseTag)
+    {
+        size_t numProc = NumProc();
+        if (numProc == 1)
+            return;
+
+        size_t rank = MyRank();
+        int prevRank = (int) ((rank + numProc - 1) % numProc);
+        int nextRank = (int) ((rank + 1) % numProc);
+
+        // Reduce-scatter: in step s we send the chunk we reduced in step s-1 to the next node and
+        // receive the chunk the previous node just reduced, adding it to our local contribution.
+        // The chunk is moved in fixed-size segments so receiving segment k+1 overlaps with reducing
+        // segment k into the local buffer.
+        for (size_t step = 0; step < numProc - 1; step++)
+        {
+            size_t sendChunk = (rank + numProc - step) % numProc;
+            size_t recvChunk = (rank + numProc - step - 1) % numProc;
+
+            size_t numRecvElements = m_chunkOffsets[recvChunk + 1] - m_chunkOffsets[recvChunk];
+            size_t numSegments = (numRecvElements + c_segmentNumElements - 1) / c_segmentNumElements;
+
+            std::vector<MPI_Request> recvRequests(numSegments);
+            for (size_t seg = 0; seg < numSegments; seg++)
+            {
+                size_t segOffset = seg * c_segmentNumElements;
+                size_t segElements = std::min(c_segmentNumElements, numRecvElements - segOffset);
+                MPI_Irecv(m_recvSegmentBuffer.get() + segOffset, (int) segElements, MPIWrapper::GetDataType(buffer), prevRank, baseTag + (int) seg, m_mpi->Communicator(), &recvRequests[seg]) || MpiFail("MPI_Irecv");
+            }
+
+            std::vector<MPI_Request> sendRequests;
+            size_t numSendElements = m_chunkOffsets[sendChunk + 1] - m_chunkOffsets[sendChunk];
+            for (size_t segOffset = 0; segOffset < numSendElements; segOffset += c_segmentNumElements)
+            {
+                size_t segElements = std::min(c_segmentNumElements, numSendElements - segOffset);
+                MPI_Request sendRequest;
+                MPI_Isend(buffer + m_chunkOffsets[sendChunk] + segOffset, (int) segElements, MPIWrapper::GetDataType(buffer), nextRank, baseTag + (int) (segOffset / c_segmentNumElements), m_mpi->Communicator(), &sendRequest) || MpiFail("MPI_Isend");
+                sendRequests.push_back(sendRequest);
+            }
+
+            // Reduce each received segment into the local buffer as soon as it arrives
+            for (size_t seg = 0; seg < numSegments; seg++)
+            {
+                MPI_Wait(&recvRequests[seg], MPI_STATUS_IGNORE) || MpiFail("MPI_Wait");
+
+                size_t segOffset = seg * c_segmentNumElements;
+                size_t segElements = std::min(c_segmentNumElements, numRecvElements - segOffset);
+                ElemType* dst = buffer + m_chunkOffsets[recvChunk] + segOffset;
+                const ElemType* src = m_recvSegmentBuffer.get() + segOffset;
+#pragma omp parallel for
+                for (long i = 0; i < (long) segElements; i++)
+                {
+                    dst[i] += src[i];
+                }
+            }
+
+            MPI_Waitall((int) sendRequests.size(), sendRequests.data(), MPI_STATUSES_IGNORE) || MpiFail("MPI_Waitall");
+        }
+
+        // Allgather: circulate the fully reduced chunks around the ring; received data is final so
+        // it can be received directly into place without staging
+        for (size_t step = 0; step < numProc - 1; step++)
+        {
+            size_t sendChunk = (rank + 1 + numProc - step) % numProc;
+            size_t recvChunk = (rank + numProc - step) % numProc;
+
+            MPI_Request recvRequest;
+            MPI_Request sendRequest;
+            size_t numRecvElements = m_chunkOffsets[recvChunk + 1] - m_chunkOffsets[recvChunk];
+            size_t numSendElements = m_chunkOffsets[sendChunk + 1] - m_chunkOffsets[sendChunk];
+            MPI_Irecv(buffer + m_chunkOffsets[recvChunk], (int) numRecvElements, MPIWrapper::GetDataType(buffer), prevRank, baseTag, m_mpi->Communicator(), &recvRequest) || MpiFail("MPI_Irecv");
+            MPI_Isend(buffer + m_chunkOffsets[sendChunk], (int) numSendElements, MPIWrapper::GetDataType(buffer), nextRank, baseTag, m_mpi->Communicator(), &sendRequest) || MpiFail("MPI_Isend");
+            MPI_Wait(&recvRequest, MPI_STATUS_IGNORE) || MpiFail("MPI_Wait");
+            MPI_Wait(&sendRequest, MPI_STATUS_IGNORE) || MpiFail("MPI_Wait");
+        }
+    }
+
+private:
+    std::unique_ptr<CUDAPageLockedMemAllocator> m_allocator;
+
+    // Packed buffer holding all gradients contiguously on the CPU, and the offset of each matrix in it
+    std::shared_ptr<ElemType> m_aggregationBuffer;
+    std::vector<size_t> m_gradientOffsets;
+    size_t m_totalGradientsSizeInElements;
+
+    // Per-node chunk boundaries within the packed buffer ([NumProc() + 1] entries)
+    std::vector<size_t> m_chunkOffsets;
+
+    // Staging buffer for the incoming chunk segments during the reduce-scatter phase
+    std::shared_ptr<ElemType> m_recvSegmentBuffer;
+
+    std::vector<std::unique_ptr<GPUDataTransferer<ElemType>>> m_gpuDataTransferers;
+
+    std::vector<DistGradHeader*> m_recvHeaders;
+
+    bool m_initialized;
+
+    int m_syncStatsTrace;
+
+    // Only used for controlling frequency of measuring/showing gradient aggregation perf stats
+    size_t m_iterationCount;
+};
+} } }
@@ -9,11 +9,18 @@
 #include "SpecialPurposeNodes.h"        // for SequenceWithSoftmaxNode
 #include "DataReaderHelpers.h"
 #include "MatrixQuantizerImpl.h"
+#include "GPUDataTransferer.h"
+#include "CUDAPageLockedMemAllocator.h"
+#include "GPUWatcher.h" // for free-memory queries during minibatch-size tuning
 #ifdef QUANTIZED_GRADIENT_AGGREGATION
 #include "AllReduceDistGradAggregator.h"
 #endif
 #include "SimpleDistGradAggregator.h"
+#include "RingAllReduceDistGradAggregator.h"
+#include "QuantizedDistGradAggregator.h"
 #include "ProgressTracing.h"
+#include "RegionProfiler.h"
+#include "ValueQuantizer.h" // for compressed checkpoints
 
 #include <map>
 #include <set>
@@ -136,6 +143,17 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                                       IDataReader<ElemType>* trainSetDataReader,
                                       IDataReader<ElemType>* validationSetDataReader)
 {
+    // CNTK_MB_REPLAY=<file>: train on minibatches recorded with CNTK_MB_CAPTURE instead of the
+    // configured reader, for benchmarking compute changes with the reader out of the equation
+    std::unique_ptr<DataReaderHelpers::MinibatchReplayReader<ElemType>> replayReader;
+    const char* replayPath = getenv("CNTK_MB_REPLAY");
+    if (replayPath != nullptr)
+    {
+        fprintf(stderr, "Replaying recorded minibatches from %s instead of the configured reader.\n", replayPath);
+        replayReader.reset(new DataReaderHelpers::MinibatchReplayReader<ElemType>(replayPath));
+        trainSetDataReader = replayReader.get();
+    }
+
     auto& featureNodes = net->FeatureNodes();
     auto& labelNodes = net->LabelNodes();
     auto& criterionNodes = GetTrainCriterionNodes(net);
@@ -144,6 +162,24 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
     for (const auto& node : criterionNodes)
         fprintf(stderr, "\t%ls = %ls\n", node->NodeName().c_str(), node->OperationName().c_str());
 
+    // if parallel training asks for distributed minibatch reading but the reader cannot do it
+    // natively, interpose a wrapper that serves each rank only its subset of every minibatch;
+    // the fallback -- materializing the full minibatch on every rank and decimating it in
+    // place -- transfers and copies numSubsets times the data each rank uses
+    // (see DecimatingDistributedReader)
+    std::unique_ptr<DataReaderHelpers::DecimatingDistributedReader<ElemType>> decimatingReader;
+    if ((g_mpi != nullptr) && (g_mpi->NumNodesInUse() > 1) &&
+        (m_parallelizationMethod != ParallelizationMethod::None) &&
+        m_enableDistributedMBReading &&
+        !trainSetDataReader->SupportsDistributedMBRead() &&
+        criterionNodes[0]->OperationName() != L"SequenceWithSoftmax") // sequence training reads side-channel data the wrapper cannot decimate
+    {
+        fprintf(stderr, "Reader does not support distributed reading natively; decimating reader-side (each rank keeps 1/%d of each minibatch).\n",
+                (int) g_mpi->NumNodesInUse());
+        decimatingReader.reset(new DataReaderHelpers::DecimatingDistributedReader<ElemType>(*trainSetDataReader));
+        trainSetDataReader = decimatingReader.get(); // all epochs below read through the wrapper; freed when training returns
+    }
+
     // determine evaluationNodes from GetEvalCriterionNodes(), ensuring each criterion is only logged once
     std::vector<ComputationNodeBasePtr> evaluationNodes;
     {
@@ -173,6 +209,10 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
     // allocate memory for forward and backward computation
     net->AllocateAllMatrices(evaluationNodes, additionalNodesToEvaluate, criterionNodes[0]);
 
+    // report how the model would split into pipeline stages, if requested
+    if (m_pipelinePlanStages > 1)
+        net->PlanPipelinePartition(m_pipelinePlanStages);
+
     // get feature and label nodes into an array of matrices that will be passed to GetMinibatch()
     // TODO: instead, remember the nodes directly, to be able to handle both float and double nodes; current version will crash for mixed networks
     std::map<std::wstring, Matrix<ElemType>*>* inputMatrices = new std::map<std::wstring, Matrix<ElemType>*>();
@@ -262,6 +302,13 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
     {
         InitDistGradAgg(evaluationNodes.size(), m_traceLevel);
     }
+
+    // in parallel runs, make sure every rank starts from bit-identical weights by broadcasting
+    // the learnable parameters from the main node; this also covers models whose initialization
+    // is not deterministic across ranks
+    if ((g_mpi != nullptr) && (g_mpi->NumNodesInUse() > 1) && (m_parallelizationMethod != ParallelizationMethod::None))
+        BroadcastLearnableParameters(learnableNodes, 0 /*main node*/);
+
     // precompute mean and invStdDev nodes and save initial model
     if (PreCompute(net, trainSetDataReader, featureNodes, labelNodes, inputMatrices) || startEpoch == 0)
     {
@@ -315,6 +362,21 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                                                   m_seqGammarCalcAMF, m_seqGammarCalcLMF, m_seqGammarCalcWP, m_seqGammarCalcbMMIFactor, m_seqGammarCalcUsesMBR);
     }
 
+    // accumulate per-node timings during training, to be reported after each epoch
+    if (m_dumpNodeTimings)
+        net->EnableNodeTiming(true);
+
+    // sample value/gradient dynamic-range histograms during training, reported after each epoch
+    if (m_dynamicRangeHistogramMBs > 0)
+        net->EnableDynamicRangeTracking(m_dynamicRangeHistogramMBs);
+
+    // profile-guided CPU/GPU placement of small nodes needs the per-node timings as well
+    if (m_autoDevicePlacementMBs > 0)
+    {
+        net->EnableNodeTiming(true);
+        net->EnableAutoDevicePlacement(m_autoDevicePlacementMBs);
+    }
+
     // --- MAIN EPOCH LOOP
     for (int i = startEpoch; i < (int) m_maxEpochs; i++) // TODO: why is this an int, and not a size_t?
     {
@@ -325,6 +387,11 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
             g_mpi->WaitAll();
         }
 
+        // a speculative StartMinibatchLoop() for this epoch may still be running (see
+        // PrimeNextEpochMinibatchLoop()); nothing below -- not even the GetNumParallelSequences()
+        // workaround calls -- may touch the train reader before it completes
+        JoinPrimedMinibatchLoop();
+
         Timer timer;
         timer.Start();
 
@@ -366,6 +433,7 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                     i + 1, learnRatePerSample, m_minLearnRate);
             if (m_autoLearnRateSearchType != LearningRateSearchAlgorithm::None)
             {
+                FinishPendingCheckPointSave();
                 net->Save(m_modelPath);
             }
             break;
@@ -378,7 +446,20 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
         // basis for a set number of epochs.  For epochs after that point, m_mbSize.size(), either
         // we just keep using
         // the last minibatch size, or we use tuning to try and find a better one.
-        if (m_autoAdjustMinibatch && i >= m_mbSize.size())
+        if (m_autoAdjustMinibatchByThroughput && i >= m_mbSize.size())
+        {
+            // Tune by live throughput. The tuning minibatches are regular training updates
+            // (learning rate and momentum are per sample), so no frames are re-run afterwards.
+            chosenMinibatchSize = AdaptiveMinibatchSizingByThroughput(net, refNet, refNode, i,
+                                                                      trainSetDataReader, learnRatePerSample,
+                                                                      m_mbSize[i], featureNodes, labelNodes,
+                                                                      criterionNodes, evaluationNodes,
+                                                                      inputMatrices, learnableNodes,
+                                                                      smoothedGradients,
+                                                                      /*in/out*/ totalSamplesSeen);
+            m_prevChosenMinibatchSize = chosenMinibatchSize;
+        }
+        else if (m_autoAdjustMinibatch && i >= m_mbSize.size())
         {
             size_t numFramesToUseInSearch = m_numMiniBatch4LRSearch[i] * m_mbSize[i];
             if (m_epochSize != requestDataSize)
@@ -413,25 +494,69 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
         fprintf(stderr, "Starting Epoch %d: learning rate per sample = %f  effective momentum = %f  momentum as time constant = %.1f samples\n",
                 i + 1, learnRatePerSample, MomentumPerMB(momentumPerSample, actualMinibatchSize), momentumAsTimeConstant);
 
-        TrainOneEpoch(net,
-                      refNet,
-                      refNode,
-                      i,
-                      m_epochSize,
-                      trainSetDataReader,
-                      learnRatePerSample,
-                      chosenMinibatchSize,
-                      featureNodes,
-                      labelNodes,
-                      criterionNodes,
-                      evaluationNodes,
-                      inputMatrices,
-                      learnableNodes, smoothedGradients,
-                      epochCriterion, epochEvalErrors, totalSamplesSeen);
+        if (m_traceLevel > 2)
+            ResetMatrixTransferStatistics(); // count per epoch so ping-ponging matrices show up against this epoch's sample count
+
+        try
+        {
+            TrainOneEpoch(net,
+                          refNet,
+                          refNode,
+                          i,
+                          m_epochSize,
+                          trainSetDataReader,
+                          learnRatePerSample,
+                          chosenMinibatchSize,
+                          featureNodes,
+                          labelNodes,
+                          criterionNodes,
+                          evaluationNodes,
+                          inputMatrices,
+                          learnableNodes, smoothedGradients,
+                          epochCriterion, epochEvalErrors, totalSamplesSeen);
+        }
+        catch (...)
+        {
+            // a mid-epoch failure is often an allocation blowing up; report where the
+            // device memory went before surfacing the error
+            net->PrintAllocationReport();
+            throw;
+        }
+
+        // kick off the next epoch's StartMinibatchLoop() in the background so the reader's schedule
+        // computation and first chunk reads overlap the checkpoint save and validation below; skipped
+        // when the next epoch's parameters cannot be predicted (learning-rate search and adaptive
+        // minibatch sizing pick the minibatch size by running trial epochs on the reader first)
+        if (i + 1 < (int) m_maxEpochs &&
+            !(m_autoLearnRateSearchType == LearningRateSearchAlgorithm::SearchBeforeEpoch && i + 1 >= (int) m_learningRatesParam.size()) &&
+            !((m_autoAdjustMinibatch || m_autoAdjustMinibatchByThroughput) && i + 1 >= (int) m_mbSize.size()))
+        {
+            bool nextUsesParallelTrain = (i + 1 >= m_parallelizationStartEpochNum) &&
+                                         (m_parallelizationMethod == ParallelizationMethod::DataParallelSGD ||
+                                          m_parallelizationMethod == ParallelizationMethod::ModelAveragingSGD);
+            bool nextUseDistributedMBReading = nextUsesParallelTrain && m_enableDistributedMBReading &&
+                                               trainSetDataReader->SupportsDistributedMBRead();
+            PrimeNextEpochMinibatchLoop(trainSetDataReader, m_mbSize[i + 1], i + 1, m_epochSize, nextUseDistributedMBReading);
+        }
 
         timer.Stop();
         double epochTime = timer.ElapsedSeconds();
 
+        if (m_dumpNodeTimings)
+            net->ReportNodeTiming(); // dump the sorted hot-node report for this epoch and reset the accumulators
+
+        if (m_dynamicRangeHistogramMBs > 0)
+            net->ReportDynamicRange(); // dump the per-node dynamic-range report for this epoch and reset the histograms
+
+        if (m_traceLevel > 2)
+            ReportMatrixTransferStatistics("Cross-device matrix transfers this epoch");
+
+        if (m_traceLevel > 0)
+        {
+            net->PrintAllocationReport();                    // buffers never shrink, so this doubles as the epoch's high-watermark report
+            TracingGPUMemoryAllocator::PrintPoolStatistics(); // device-side counterpart: buffer-pool watermark and reuse counters
+        }
+
         if (m_useEvalCriterionControlLR && epochEvalErrors.size() > 0)
         {
             lrControlCriterion = epochEvalErrors[0];
@@ -479,11 +604,16 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
             }
         }
 
-        if ((g_mpi == nullptr) || g_mpi->IsMainNode())
+        if (validationSetDataReader != trainSetDataReader && validationSetDataReader != nullptr)
         {
-            if (validationSetDataReader != trainSetDataReader && validationSetDataReader != nullptr)
+            // If the validation reader can shard the data, all ranks evaluate their own subset and the
+            // evaluator combines the results (and then every rank holds the same score). Otherwise only
+            // the main node evaluates, as before.
+            bool useDistributedValidation = (g_mpi != nullptr) && (g_mpi->NumNodesInUse() > 1) &&
+                                            m_enableDistributedMBReading && validationSetDataReader->SupportsDistributedMBRead();
+            if (useDistributedValidation || (g_mpi == nullptr) || g_mpi->IsMainNode())
             {
-                SimpleEvaluator<ElemType> evalforvalidation(net);
+                SimpleEvaluator<ElemType> evalforvalidation(net, 100, 0, m_prefetchMinibatches);
                 vector<wstring> cvSetTrainAndEvalNodes;
                 if (criterionNodes.size() > 0)
                 {
@@ -495,12 +625,15 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                 }
 
                 vector<double> vScore = evalforvalidation.Evaluate(validationSetDataReader, cvSetTrainAndEvalNodes, m_mbSize[i]);
-                fprintf(stderr, "Finished Epoch[%2d of %d]: [Validation Set] TrainLossPerSample = %.8g", i + 1, (int) m_maxEpochs, vScore[0]);
-                if (vScore.size() > 1)
+                if ((g_mpi == nullptr) || g_mpi->IsMainNode())
                 {
-                    fprintf(stderr, "; EvalErrPerSample = %.8g", vScore[1]);
+                    fprintf(stderr, "Finished Epoch[%2d of %d]: [Validation Set] TrainLossPerSample = %.8g", i + 1, (int) m_maxEpochs, vScore[0]);
+                    if (vScore.size() > 1)
+                    {
+                        fprintf(stderr, "; EvalErrPerSample = %.8g", vScore[1]);
+                    }
+                    fprintf(stderr, "\n");
                 }
-                fprintf(stderr, "\n");
 
                 if (m_useCVSetControlLRIfCVExists)
                 {
@@ -544,6 +677,13 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
             {
                 if (m_loadBestModel)
                 {
+                    // make sure the main node's background checkpoint save is not still writing (or
+                    // pruning) these files; the barrier holds the other ranks back until it has joined
+                    FinishPendingCheckPointSave();
+                    if (g_mpi != nullptr)
+                    {
+                        g_mpi->WaitAll();
+                    }
                     auto bestModelPath = GetModelNameForEpoch(i - m_learnRateAdjustInterval);
                     fprintf(stderr, "Loading previous model with best training-criterion value: %ls.\n", bestModelPath.c_str());
                     net->RereadPersistableParameters<ElemType>(bestModelPath);
@@ -569,6 +709,7 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                     }
                     else
                     {
+                        FinishPendingCheckPointSave();
                         net->Save(GetModelNameForEpoch(i, true));
 
                         fprintf(stderr, "Finished training and saved final model\n\n");
@@ -624,8 +765,10 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
         // persist model and check-point info
         if ((g_mpi == nullptr) || g_mpi->IsMainNode())
         {
-            net->Save(GetModelNameForEpoch(i));
-            SaveCheckPointInfo(i, totalSamplesSeen, learnRatePerSample, smoothedGradients, prevCriterion, chosenMinibatchSize);
+            // collect the checkpoint files that become obsolete once this one is safely on disk;
+            // they must only be deleted after the new files have been renamed into place, or a
+            // crash mid-write would leave no usable checkpoint at all
+            std::vector<wstring> obsoleteCheckPointFiles;
             if (!m_keepCheckPointFiles)
             {
                 // delete previous checkpoint file to save space
@@ -633,18 +776,31 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                 {
                     if (epochsSinceLastLearnRateAdjust != 1)
                     {
-                        _wunlink(GetCheckPointFileNameForEpoch(i - 1).c_str());
+                        obsoleteCheckPointFiles.push_back(GetCheckPointFileNameForEpoch(i - 1));
                     }
                     if (epochsSinceLastLearnRateAdjust == m_learnRateAdjustInterval)
                     {
-                        _wunlink(GetCheckPointFileNameForEpoch(i - m_learnRateAdjustInterval).c_str());
+                        obsoleteCheckPointFiles.push_back(GetCheckPointFileNameForEpoch(i - m_learnRateAdjustInterval));
                     }
                 }
                 else
                 {
-                    _wunlink(GetCheckPointFileNameForEpoch(i - 1).c_str());
+                    obsoleteCheckPointFiles.push_back(GetCheckPointFileNameForEpoch(i - 1));
                 }
             }
+
+            if (m_saveCheckPointsAsync)
+            {
+                SaveCheckPointAsync(net, i, totalSamplesSeen, learnRatePerSample, learnableNodes,
+                                    smoothedGradients, prevCriterion, chosenMinibatchSize, obsoleteCheckPointFiles);
+            }
+            else
+            {
+                net->Save(GetModelNameForEpoch(i));
+                SaveCheckPointInfo(i, totalSamplesSeen, learnRatePerSample, smoothedGradients, prevCriterion, chosenMinibatchSize);
+                for (const auto& obsoleteFile : obsoleteCheckPointFiles)
+                    _wunlink(obsoleteFile.c_str());
+            }
         }
 
         if (learnRatePerSample < 1e-12)
@@ -655,6 +811,12 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
     }
     // --- END OF MAIN EPOCH LOOP
 
+    // the loop may have been left by break with a speculative reader start still in flight
+    JoinPrimedMinibatchLoop();
+
+    // a background checkpoint save may still be streaming out the last epoch's files
+    FinishPendingCheckPointSave();
+
     // Synchronize all ranks before proceeding to ensure that
     // rank 0 has finished writing the model file
     if (g_mpi != nullptr)
@@ -680,6 +842,42 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
 }
 
 // -----------------------------------------------------------------------
+// issue the reader's (possibly distributed) StartMinibatchLoop() for one epoch
+template <class ElemType>
+void SGD<ElemType>::StartTrainMinibatchLoop(IDataReader<ElemType>* trainSetDataReader, size_t mbSize, int epochNumber, size_t epochSize, bool useDistributedMBReading)
+{
+    if (useDistributedMBReading)
+    {
+        trainSetDataReader->StartDistributedMinibatchLoop(mbSize, epochNumber, g_mpi->CurrentNodeRank(),
+                                                          g_mpi->NumNodesInUse(), epochSize);
+    }
+    else
+    {
+        trainSetDataReader->StartMinibatchLoop(mbSize, epochNumber, epochSize);
+    }
+}
+
+// speculatively start the next epoch's minibatch loop on a background thread
+// Called when an epoch's last training minibatch has been consumed: the train reader then sits
+// idle through the checkpoint save and the validation run (which uses a separate reader), while
+// its StartMinibatchLoop() -- randomization schedule computation and the first chunk reads -- is
+// exactly what makes the next epoch start cold. TrainOneEpoch() waits for the primed call and
+// skips its own when the parameters match; on a mismatch it simply starts the loop over
+// (StartMinibatchLoop() is restartable), so a wrong speculation costs only the background work.
+template <class ElemType>
+void SGD<ElemType>::PrimeNextEpochMinibatchLoop(IDataReader<ElemType>* trainSetDataReader, size_t mbSize, int epochNumber, size_t epochSize, bool useDistributedMBReading)
+{
+    JoinPrimedMinibatchLoop(); // (can only still be pending if the primed epoch never ran)
+    m_primedLoopEpoch = epochNumber;
+    m_primedLoopMBSize = mbSize;
+    m_primedLoopEpochSize = epochSize;
+    m_primedLoopDistributed = useDistributedMBReading;
+    m_primedMinibatchLoop = std::async(std::launch::async, [=]()
+                                       {
+                                           StartTrainMinibatchLoop(trainSetDataReader, mbSize, epochNumber, epochSize, useDistributedMBReading);
+                                       });
+}
+
 // TrainOneEpoch() -- train one epoch
 // -----------------------------------------------------------------------
 
@@ -709,6 +907,14 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
     double totalTimeInMBs = 0; // use double since timer has sub-microsecond time resolution
     double epochCriterionLastMBs = 0;
 
+    // breakdown of where the minibatch time goes, reported with the progress log line so that
+    // a slow job can be diagnosed at a glance as reader-, compute-, comm-, or update-bound
+    double readTimeInMBs = 0;      // GetMinibatchIntoNetwork()
+    double computeTimeInMBs = 0;   // ForwardProp()/Backprop()
+    double aggregateTimeInMBs = 0; // AggregateGradients() resp. model-averaging sync
+    double updateTimeInMBs = 0;    // UpdateWeights()
+    Timer phaseTimer;
+
     int numSamplesLastMBs = 0;
     std::vector<double> epochEvalErrorsLastMBs(epochEvalErrors.size(), 0);
 
@@ -717,7 +923,6 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
 
     int numMBsRun = 0;
 
-    // NOTE: the following two local matrices are not used in distGradAgg path
     // assume only one training criterion node for each epoch.
     // The criterion values are accumulated here over the minibatches (without having to pull them off the GPU).
     Matrix<ElemType> localEpochCriterion(1, 1, net->GetDeviceId());
@@ -726,6 +931,11 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
     localEpochCriterion.SetValue(0);
     localEpochEvalErrors.SetValue(0);
 
+    // portion of the local accumulators that has already been folded into a DistGradHeader
+    // (gradient-aggregation path only; see there)
+    double localCriterionAlreadyReported = 0;
+    std::vector<double> localEvalErrorsAlreadyReported(epochEvalErrors.size(), 0);
+
     bool useGradientAggregation = ((m_parallelizationMethod == ParallelizationMethod::DataParallelSGD) &&
                                    (epochNumber >= m_parallelizationStartEpochNum));
     bool useModelAveraging = ((m_parallelizationMethod == ParallelizationMethod::ModelAveragingSGD) &&
@@ -737,6 +947,11 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
     size_t nSynced = 0;
     float nSecondsOnMASync = 0;
     float nSecondsSinceLastMAPerfReport = 0;
+    if (useModelAveraging && m_maAdaptiveSyncFrequency)
+    {
+        // drift patterns change with the learning rate, so re-learn the interval each epoch
+        m_nFramesBetweenMASync = m_nFramesBetweenMASyncBase;
+    }
 
     std::vector<Matrix<ElemType>*> learnParamsGradients;
     if (useGradientAggregation)
@@ -753,14 +968,18 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
     bool useDistributedMBReading = useParallelTrain &&
                                    m_enableDistributedMBReading &&
                                    trainSetDataReader->SupportsDistributedMBRead();
-    if (useDistributedMBReading)
+    JoinPrimedMinibatchLoop(); // a speculative reader start may be in flight; it must finish before we touch the reader
+    bool primedLoopMatches = m_primedLoopEpoch == epochNumber && m_primedLoopMBSize == tunedMBSize &&
+                             m_primedLoopEpochSize == epochSize && m_primedLoopDistributed == useDistributedMBReading;
+    m_primedLoopEpoch = -1; // consumed (or superseded) either way
+    if (primedLoopMatches)
     {
-        trainSetDataReader->StartDistributedMinibatchLoop(tunedMBSize, epochNumber, g_mpi->CurrentNodeRank(),
-                                                          g_mpi->NumNodesInUse(), epochSize);
+        if (m_traceLevel > 0)
+            fprintf(stderr, "TrainOneEpoch: minibatch loop for epoch %d was already started during the previous end-of-epoch phase\n", epochNumber + 1);
     }
     else
     {
-        trainSetDataReader->StartMinibatchLoop(tunedMBSize, epochNumber, epochSize);
+        StartTrainMinibatchLoop(trainSetDataReader, tunedMBSize, epochNumber, epochSize, useDistributedMBReading);
     }
 
     net->StartEvaluateMinibatchLoop(evaluationNodes);
@@ -790,9 +1009,21 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
         }
     }
     // this is non-trivial, we need a manager object to handle this
-    if (numSubminibatchesNeeded > 1)
+    // With maxSamplesInRAM, the above count is only an estimate; the actual decision is made per
+    // minibatch below (the dispatcher must hence be set up even if the estimate says 1), so that
+    // only oversized minibatches--e.g. those holding the long-utterance tail--are actually split.
+    if (numSubminibatchesNeeded > 1 || m_maxSamplesInRAM < SIZE_MAX)
         smbDispatcher.Init(net, learnableNodes, criterionNodes, evaluationNodes);
 
+    // Double-buffered read-ahead: while the network computes on one minibatch, the reader already
+    // fills the next one into staging buffers on a background thread. For sequence training, the
+    // lattice side channel (GetMinibatch4SE()) is read ahead as well, so the next minibatch's
+    // lattices are parsed from the archive while the current minibatch's forward/backward runs.
+    // Not combined with sub-minibatching.
+    std::unique_ptr<DataReaderHelpers::MinibatchPrefetcher<ElemType>> prefetcher;
+    if (m_prefetchMinibatches && numSubminibatchesNeeded <= 1 && m_maxSamplesInRAM == SIZE_MAX)
+        prefetcher.reset(new DataReaderHelpers::MinibatchPrefetcher<ElemType>(*trainSetDataReader, criterionNodes[0]->OperationName() == L"SequenceWithSoftmax"));
+
     // The following is a special feature only supported by the Kaldi2Reader for more efficient sequence training.
     // This attemps to compute the error signal for the whole utterance, which will
     // be fed to the neural network as features. Currently it is a workaround
@@ -810,18 +1041,23 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
         {
             fprintf(stderr, ", BufferedAsyncGradientAggregation is ENABLED");
         }
+        if (m_overlappedGradientAggregation)
+        {
+            fprintf(stderr, ", OverlappedGradientAggregation is ENABLED");
+        }
     }
     if (useDistributedMBReading)
     {
         fprintf(stderr, ", distributed reading is ENABLED");
     }
-    if (numSubminibatchesNeeded > 1)
+    if (prefetcher)
     {
-        if (m_maxSamplesInRAM < SIZE_MAX)
-            fprintf(stderr, ", with maximum %d samples in RAM", (int) m_maxSamplesInRAM);
-        else
-            fprintf(stderr, ", with %d subminibatch", (int) numSubminibatchesNeeded);
+        fprintf(stderr, ", minibatch prefetching is ENABLED");
     }
+    if (m_maxSamplesInRAM < SIZE_MAX)
+        fprintf(stderr, ", with maximum %d samples in RAM", (int) m_maxSamplesInRAM);
+    else if (numSubminibatchesNeeded > 1)
+        fprintf(stderr, ", with %d subminibatch", (int) numSubminibatchesNeeded);
     fprintf(stderr, ".\n");
 
     Timer timer;
@@ -835,8 +1071,19 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
         // get minibatch
         // TODO: is it guaranteed that the GPU is already completed at this point, is it safe to overwrite the buffers?
         size_t actualMBSize = 0;
-        bool wasDataRead = DataReaderHelpers::GetMinibatchIntoNetwork(*trainSetDataReader, net, criterionNodes[0],
-                                                                      useDistributedMBReading, useParallelTrain, *inputMatrices, actualMBSize);
+        phaseTimer.Restart();
+        bool wasDataRead;
+        {
+            PROFILE_REGION("GetMinibatch");
+            StartupProfiling::BeginPhase("firstMinibatch"); // no-op after the startup summary has been emitted
+            wasDataRead = DataReaderHelpers::GetMinibatchIntoNetwork(*trainSetDataReader, net, criterionNodes[0],
+                                                                     useDistributedMBReading, useParallelTrain, *inputMatrices, actualMBSize,
+                                                                     prefetcher.get());
+            StartupProfiling::EndPhase();
+            StartupProfiling::EmitSummary();
+        }
+        phaseTimer.Stop();
+        readTimeInMBs += phaseTimer.ElapsedSeconds();
         if (!wasDataRead && (!useDistributedMBReading || noMoreSamplesToProcess)) // in case of distributed reading, we do a few more loops until all ranks have completed
             break;                                                                // end of epoch
 
@@ -880,10 +1127,17 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
             }
 
             // do forward and back propagation
+            phaseTimer.Restart();
 
             // We optionally break the minibatch into sub-minibatches.
             // This, when enabled, is used when a full minibatch does not fit into GPU RAM.
-            size_t actualNumSubminibatches = numSubminibatchesNeeded <= 1 ? 1 : smbDispatcher.GetMinibatchIntoCache(*trainSetDataReader, *net, *inputMatrices, numSubminibatchesNeeded);
+            // With maxSamplesInRAM, we decide per minibatch from its actual column count rather
+            // than from the per-epoch estimate, so that a regular minibatch runs in one piece
+            // (no caching or gradient-accumulation overhead) and only oversized ones are split.
+            size_t numSubminibatchesForThisMB = numSubminibatchesNeeded;
+            if (m_maxSamplesInRAM < SIZE_MAX)
+                numSubminibatchesForThisMB = (size_t) std::ceil((float) net->GetMBLayoutPtr()->GetNumCols() / m_maxSamplesInRAM);
+            size_t actualNumSubminibatches = numSubminibatchesForThisMB <= 1 ? 1 : smbDispatcher.GetMinibatchIntoCache(*trainSetDataReader, *net, *inputMatrices, numSubminibatchesForThisMB);
             for (size_t ismb = 0; ismb < actualNumSubminibatches; ismb++)
             {
                 if (actualNumSubminibatches > 1)
@@ -897,6 +1151,8 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
                 // forward prop for evaluate eval nodes
                 // ===========================================================
 
+                PROFILE_REGION("ForwardBackward");
+
                 // compute eval node first since when gradient is computed the forward function values
                 // may be changed and need to be recomputed when gradient and function value share the same matrix
                 net->ForwardProp(evaluationNodes); // the bulk of this evaluation is reused in ComputeGradient() below
@@ -912,7 +1168,24 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
                 // ===========================================================
 
                 if (learnRatePerSample > 0.01 * m_minLearnRate) // only compute gradient when learning rate is large enough
-                    net->Backprop(criterionNodes[0]);
+                {
+                    // When overlapped gradient aggregation is enabled, hand each learnable parameter's
+                    // gradient to the aggregator as soon as backprop has finalized it, so that its
+                    // allreduce runs while the remaining layers are still being backpropagated.
+                    // Not combined with sub-minibatching, where gradients only become final after the
+                    // last sub-minibatch.
+                    if (useGradientAggregation && (m_distGradAgg != nullptr) && m_distGradAgg->SupportsOverlappedAggregation() && (actualNumSubminibatches == 1))
+                    {
+                        net->Backprop(criterionNodes[0], [this](const ComputationNodeBasePtr& nodep)
+                                      {
+                                          auto node = dynamic_pointer_cast<ComputationNode<ElemType>>(nodep);
+                                          if (node && node->IsParameterUpdateRequired())
+                                              m_distGradAgg->MarkGradientReady(&node->Gradient());
+                                      });
+                    }
+                    else
+                        net->Backprop(criterionNodes[0]);
+                }
 
                 // house-keeping for sub-minibatching
                 if (actualNumSubminibatches > 1)
@@ -920,8 +1193,19 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
             }                                                        // end sub-minibatch loop
             if (actualNumSubminibatches > 1)
                 smbDispatcher.DoneWithCurrentMinibatch();
+
+            // note: GPU launches are asynchronous, so part of the kernel time may be attributed
+            // to whichever later phase forces the sync (use dumpNodeTimings for exact kernel times)
+            phaseTimer.Stop();
+            computeTimeInMBs += phaseTimer.ElapsedSeconds();
         } // if (actualMBSize > 0)
 
+        // reclaim (in O(1)) all per-minibatch scratch space the nodes requested during forward/backprop
+        ComputationNode<ElemType>::ResetScratchSpace();
+
+        // profile-guided device placement, if enabled (cheap no-op once placement is decided)
+        net->UpdateAutoDevicePlacement();
+
         // for progress and statistics, we should only count frames that are not gaps
         size_t numSamplesWithLabel = wasDataRead ? net->GetNumSamplesWithLabel(actualMBSize) : 0;
 
@@ -971,15 +1255,47 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
                 }
             }
 
+            // accumulate criterion values on the device; they are read back and folded into the
+            // gradient header only every m_numMBsToShowResult minibatches, since pulling each value
+            // off the GPU forces a device sync per minibatch
+            if (actualMBSize > 0)
+            {
+                Matrix<ElemType>::AddElementToElement(dynamic_pointer_cast<ComputationNode<ElemType>>(criterionNodes[0])->Value(),
+                                                      0, 0, localEpochCriterion, 0, 0);
+                for (size_t i = 0; i < evaluationNodes.size(); i++)
+                    Matrix<ElemType>::AddElementToElement(dynamic_pointer_cast<ComputationNode<ElemType>>(evaluationNodes[i])->Value(),
+                                                          0, 0, localEpochEvalErrors, 0, i);
+            }
+
             // prepare the header
             m_gradHeader->numEvalNode = evaluationNodes.size();
             m_gradHeader->numSamples = actualMBSize;
             m_gradHeader->numSamplesWithLabel = numSamplesWithLabel;
-            m_gradHeader->criterion = actualMBSize > 0 ? criterionNodes[0]->Get00Element() : 0.0;
-            for (size_t i = 0; i < evaluationNodes.size(); i++)
-                m_gradHeader->evalErrors[i] = actualMBSize > 0 ? evaluationNodes[i]->Get00Element() : 0.0;
+            if ((numMBsRun + 1) % m_numMBsToShowResult == 0) // numMBsRun is incremented below, after aggregation
+            {
+                // fold everything accumulated since the last report into this header, so the
+                // aggregated epoch totals come out the same as if we had read them every minibatch
+                double localCriterion = localEpochCriterion.Get00Element();
+                m_gradHeader->criterion = localCriterion - localCriterionAlreadyReported;
+                localCriterionAlreadyReported = localCriterion;
+                for (size_t i = 0; i < evaluationNodes.size(); i++)
+                {
+                    double localEvalError = localEpochEvalErrors(0, i);
+                    m_gradHeader->evalErrors[i] = localEvalError - localEvalErrorsAlreadyReported[i];
+                    localEvalErrorsAlreadyReported[i] = localEvalError;
+                }
+            }
+            else
+            {
+                m_gradHeader->criterion = 0.0;
+                for (size_t i = 0; i < evaluationNodes.size(); i++)
+                    m_gradHeader->evalErrors[i] = 0.0;
+            }
 
+            phaseTimer.Restart();
             bool samplesProcessed = m_distGradAgg->AggregateGradients(learnParamsGradients, m_gradHeader, epochNumber);
+            phaseTimer.Stop();
+            aggregateTimeInMBs += phaseTimer.ElapsedSeconds();
             noMoreSamplesToProcess = !samplesProcessed;
 
             aggregateNumSamples = m_gradHeader->numSamples;
@@ -992,6 +1308,15 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
         // update model parameters
         if ((aggregateNumSamples > 0) && (learnRatePerSample > m_minLearnRate * 0.01))
         {
+            phaseTimer.Restart();
+            // When overlapParamUpdate is enabled, issue the updates on a side stream and park an
+            // update-completion event on each parameter node; the next ForwardProp fences each
+            // consumer on its parameters' events only, so the forward kernels of early layers
+            // overlap the still-running updates of later layers. Model averaging reads parameter
+            // values on the host right below, so it keeps the fully synchronous path.
+            std::unique_ptr<MatrixComputeSideStreamSection> updateSection;
+            if (m_overlapParamUpdate && !useModelAveraging)
+                updateSection.reset(MatrixComputeSideStreamSection::Create(net->GetDeviceId()));
             auto smoothedGradientIter = smoothedGradients.begin();
             for (auto nodeIter = learnableNodes.begin(); nodeIter != learnableNodes.end(); nodeIter++, smoothedGradientIter++)
             {
@@ -1007,17 +1332,23 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
                                   GetMomentumPerSample(epochNumber /*BUGBUG workaround:*/, net->GetMBLayoutPtr()->GetNumParallelSequences()), aggregateNumSamples,
                                   m_L2RegWeight, m_L1RegWeight,
                                   m_needAveMultiplier, m_useNesterovMomentum);
+                    if (updateSection)
+                        node->SetParameterUpdateFence(std::shared_ptr<MatrixComputeStreamEvent>(MatrixComputeStreamEvent::Create(node->GetDeviceId()))); // records on the side stream
 #ifdef _DEBUG
                     if (dynamic_pointer_cast<ComputationNode<ElemType>>(node)->Value().HasNan("TrainOneEpoch/UpdateWeights(): "))
                         LogicError("%ls %ls operation has NaNs in functionValues after parameter update.", node->NodeName().c_str(), node->OperationName().c_str());
 #endif
                 }
             }
+            updateSection.reset(); // leave the side-stream section; subsequent work goes back to the main stream
+            phaseTimer.Stop();
+            updateTimeInMBs += phaseTimer.ElapsedSeconds();
         }
 
         // aggregation by model averaging
         if (useModelAveraging)
         {
+            phaseTimer.Restart();
             // Determine if any samples were processed across any of the ranks
             if (useDistributedMBReading)
             {
@@ -1057,6 +1388,8 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
                 }
                 aggregateNumSamplesWithLabel = processedSamples;
             }
+            phaseTimer.Stop();
+            aggregateTimeInMBs += phaseTimer.ElapsedSeconds();
         }
 
         timer.Stop();
@@ -1127,6 +1460,19 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
             string formatString = "TotalTime = " + GeneratePaddedFloatOrExpFormat(0, 4, totalTimeInMBs) + "s; SamplesPerSecond = %.1f\n";
             SGDTrace(stderr, formatString.c_str(), totalTimeInMBs, numSamplesLastMBs / totalTimeInMBs);
 
+            // time breakdown, so that one can see at a glance whether a slow job is reader-,
+            // compute-, comm-, or update-bound (times are wall clock, remainder is loop overhead)
+            SGDTrace(stderr, "  Breakdown: ReadTime = %.4fs; ComputeTime = %.4fs; AggregateTime = %.4fs; UpdateTime = %.4fs\n",
+                     readTimeInMBs, computeTimeInMBs, aggregateTimeInMBs, updateTimeInMBs);
+
+            // binary trace channel: one fixed-size record instead of the formatted lines above,
+            // so numMBsToShowResult can be lowered (with traceLevel=0) without stalling minibatches
+            if (BinaryProgressTracing::IsEnabled())
+                BinaryProgressTracing::Emit(BinaryProgressTracing::kindMinibatch, (unsigned int) epochNumber + 1, (unsigned int) numMBsRun,
+                                            (float) numSamplesLastMBs, (float) trainLossPerSample,
+                                            (float) (epochEvalErrors.empty() ? 0.0 : (epochEvalErrors[0] - epochEvalErrorsLastMBs[0]) / numSamplesLastMBs),
+                                            (float) (numSamplesLastMBs / totalTimeInMBs));
+
             // progress tracing for compute cluster management
             if (wasProgressPrinted)
             {
@@ -1140,6 +1486,10 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
 
             // reset statistics
             totalTimeInMBs = 0;
+            readTimeInMBs = 0;
+            computeTimeInMBs = 0;
+            aggregateTimeInMBs = 0;
+            updateTimeInMBs = 0;
             numSamplesLastMBs = 0;
 
             epochCriterionLastMBs = epochCriterion;
@@ -1175,8 +1525,36 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
 
     // --- END MAIN MINIBATCH LOOP
 
+    // drain the last minibatch's overlapped updates before anything reads the parameters on the
+    // host (checkpointing, CV evaluation); mid-epoch they are consumed by the next ForwardProp
+    if (m_overlapParamUpdate)
+        for (auto& node : learnableNodes)
+            node->CompletePendingParameterUpdate();
+
     if (useModelAveraging && (g_mpi->NumNodesInUse() > 1))
     {
+        // finish an in-flight asynchronous sync first; its frames have not been counted yet
+        if (m_useAsyncModelAveraging)
+        {
+            size_t nPendingFrames = 0;
+            if (ModelAveragingSyncAsyncPoll(learnableNodes, true /*blocking*/, nPendingFrames))
+            {
+                totalSamplesSeen += nPendingFrames;
+                totalEpochSamples += nPendingFrames;
+            }
+        }
+
+        // likewise drain all outstanding bounded-staleness syncs, oldest first
+        if (m_maMaxStaleSyncs > 0)
+        {
+            size_t nPendingFrames = 0;
+            while (ModelAveragingBoundedStalenessPoll(learnableNodes, true /*blocking*/, nPendingFrames))
+            {
+                totalSamplesSeen += nPendingFrames;
+                totalEpochSamples += nPendingFrames;
+            }
+        }
+
         // may not be synced after epoch finished, so do the sync here
         int residualSampels = (int) nSamplesSinceLastModelSync;
         g_mpi->AllReduce(&residualSampels, 1);
@@ -1187,6 +1565,26 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
         nSamplesSinceLastModelSync = 0;
     }
 
+    // fold in any criterion values accumulated on the device since the last report
+    // (these never made it into a gradient header, so they must be merged over nodes here)
+    if (useGradientAggregation)
+    {
+        double residualCriterion = localEpochCriterion.Get00Element() - localCriterionAlreadyReported;
+        std::vector<double> residualEvalErrors(epochEvalErrors.size());
+        for (size_t i = 0; i < epochEvalErrors.size(); i++)
+            residualEvalErrors[i] = (double) localEpochEvalErrors(0, i) - localEvalErrorsAlreadyReported[i];
+
+        if (g_mpi->NumNodesInUse() > 1)
+        {
+            g_mpi->AllReduce(&residualCriterion, 1);
+            g_mpi->AllReduce(residualEvalErrors);
+        }
+
+        epochCriterion += residualCriterion;
+        for (size_t i = 0; i < epochEvalErrors.size(); i++)
+            epochEvalErrors[i] += residualEvalErrors[i];
+    }
+
     // compute final criterion values
     if (useGradientAggregation)
     {
@@ -1283,6 +1681,13 @@ bool SGD<ElemType>::PreCompute(ComputationNetworkPtr net,
         fprintf(stderr, "\tNodeName: %ls\n", (node->NodeName()).c_str());
     }
 
+    // warm start: if a valid cache exists, side-load the precomputed statistics and skip the data pass
+    if (!m_preComputeCacheFile.empty() && TryLoadPreComputeCache(nodes))
+    {
+        fprintf(stderr, "Precomputing --> all nodes loaded from cache %ls, skipping the pass over the training data.\n\n", m_preComputeCacheFile.c_str());
+        return true;
+    }
+
     // compute
     // trainSetDataReader->StartMinibatchLoop(m_mbSize[0],  0 , requestDataSize);
     // trainSetDataReader->StartMinibatchLoop(m_mbSize[0],  0 , m_epochSize); // only based on one epoch
@@ -1332,9 +1737,111 @@ bool SGD<ElemType>::PreCompute(ComputationNetworkPtr net,
     }
     fprintf(stderr, "\nPrecomputing --> Completed.\n\n");
 
+    // refresh the cache for the next restart; in parallel runs only the main node writes
+    if (!m_preComputeCacheFile.empty() && ((g_mpi == nullptr) || g_mpi->IsMainNode()))
+        SavePreComputeCache(nodes);
+
     return true;
 }
 
+// TryLoadPreComputeCache - side-load the precomputed statistics from m_preComputeCacheFile
+// Returns true only if the cache key matches and every node in 'nodes' was found with
+// matching dimensions; any mismatch or I/O problem falls back to the regular data pass.
+template <class ElemType>
+bool SGD<ElemType>::TryLoadPreComputeCache(const std::list<ComputationNodeBasePtr>& nodes)
+{
+    if (m_preComputeCacheKey.empty())
+    {
+        fprintf(stderr, "preComputeCacheFile: no cache key available from the reader configuration, cache disabled\n");
+        return false;
+    }
+    if (!fexists(m_preComputeCacheFile.c_str()))
+        return false;
+
+    try
+    {
+        File fstream(m_preComputeCacheFile, FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead);
+        fstream.GetMarker(FileMarker::fileMarkerBeginSection, L"BPreComputeCache");
+
+        std::string storedKey;
+        fstream >> storedKey;
+        if (storedKey != m_preComputeCacheKey)
+        {
+            fprintf(stderr, "preComputeCacheFile: reader configuration has changed, recomputing\n");
+            return false;
+        }
+
+        size_t numNodes;
+        fstream >> numNodes;
+        std::map<std::wstring, Matrix<ElemType>> cachedValues;
+        for (size_t i = 0; i < numNodes; i++)
+        {
+            std::wstring nodeName;
+            fstream >> nodeName;
+            Matrix<ElemType> value(CPUDEVICE);
+            fstream >> value;
+            cachedValues.insert(make_pair(nodeName, std::move(value)));
+        }
+        fstream.GetMarker(FileMarker::fileMarkerEndSection, L"EPreComputeCache");
+
+        // validate the full set before side-loading anything, so we never leave a partial load behind
+        for (const auto& nodeIter : nodes)
+        {
+            auto node = static_pointer_cast<PreComputedNodeBase<ElemType>>(nodeIter);
+            auto found = cachedValues.find(node->NodeName());
+            if (found == cachedValues.end() || found->second.GetNumRows() != nodeIter->GetSampleLayout().GetNumElements())
+            {
+                fprintf(stderr, "preComputeCacheFile: node %ls not found in cache or dimensions changed, recomputing\n", node->NodeName().c_str());
+                return false;
+            }
+        }
+        for (const auto& nodeIter : nodes)
+        {
+            auto node = static_pointer_cast<PreComputedNodeBase<ElemType>>(nodeIter);
+            node->SideLoadFromMatrix(cachedValues.find(node->NodeName())->second);
+        }
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "preComputeCacheFile: failed to load %ls (%s), recomputing\n", m_preComputeCacheFile.c_str(), e.what());
+        return false;
+    }
+}
+
+// SavePreComputeCache - write the finalized precompute values to m_preComputeCacheFile
+// Best effort: a failed write only costs the next restart its warm start.
+template <class ElemType>
+void SGD<ElemType>::SavePreComputeCache(const std::list<ComputationNodeBasePtr>& nodes)
+{
+    if (m_preComputeCacheKey.empty()) // without a key we could not detect staleness, so do not write
+        return;
+
+    wstring tempFileName = m_preComputeCacheFile + L".tmp";
+    try
+    {
+        {
+            File fstream(tempFileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
+            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BPreComputeCache");
+            fstream << m_preComputeCacheKey;
+            fstream << nodes.size();
+            for (const auto& nodeIter : nodes)
+            {
+                auto node = static_pointer_cast<PreComputedNodeBase<ElemType>>(nodeIter);
+                fstream << node->NodeName();
+                fstream << node->Value();
+            }
+            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EPreComputeCache");
+            fstream.Flush();
+        }
+        renameOrDie(tempFileName, m_preComputeCacheFile);
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "preComputeCacheFile: failed to write %ls (%s)\n", m_preComputeCacheFile.c_str(), e.what());
+    }
+}
+
 // return a reasonable initial learning rate based on the initial mbsize
 template <class ElemType>
 double SGD<ElemType>::SearchForBestLearnRate(ComputationNetworkPtr net,
@@ -1389,6 +1896,16 @@ double SGD<ElemType>::SearchForBestLearnRate(ComputationNetworkPtr net,
                        /*out*/ prevCriterion,
                        /*out*/ dummyMinibatchSize);
 
+    // optionally probe the candidates on minibatches cached in memory: the base mini-epoch
+    // below records them through the real reader, every further probe replays the copies,
+    // making it compute-only (see MinibatchCachingReader)
+    std::unique_ptr<DataReaderHelpers::MinibatchCachingReader<ElemType>> cachedReader;
+    if (m_useCachedMBsForLRSearch && criterionNodes[0]->OperationName() != L"SequenceWithSoftmax")
+    {
+        cachedReader.reset(new DataReaderHelpers::MinibatchCachingReader<ElemType>(*trainSetDataReader));
+        trainSetDataReader = cachedReader.get(); // all probes below go through the cache; freed when the search returns
+    }
+
     // if model is not changed this is what we will get
     TrainOneMiniEpochAndReloadModel(net, refNet, refNode, epochNumber,
                                     numFramesToUseInSearch, trainSetDataReader, 0, m_mbSize[epochNumber],
@@ -1705,6 +2222,120 @@ size_t SGD<ElemType>::SearchForBestMinibatchSize(ComputationNetworkPtr net,
     return lastTriedTrialMinibatchSize;
 }
 
+// AdaptiveMinibatchSizingByThroughput() -- choose the largest minibatch size that still pays off,
+// judged by live training throughput instead of trial mini-epochs.
+// Starting from the configured size, each candidate trains m_minibatchThroughputTuningNumMBs
+// regular minibatches while we measure samples/sec and, on GPU, the remaining free device
+// memory (GPUWatcher). Doubling stops when throughput no longer improves by at least 2% or
+// when the headroom would not cover another doubling of the per-minibatch working set.
+// Because learning rate and momentum are specified per sample, the tuning minibatches are
+// valid model updates at every candidate size; unlike AdaptiveMinibatchSizing(), nothing is
+// rolled back or re-run. Note that each candidate restarts the epoch's minibatch loop, so the
+// first frames of the epoch receive a few extra updates; this is the same data the epoch
+// trains on anyway.
+template <class ElemType>
+size_t SGD<ElemType>::AdaptiveMinibatchSizingByThroughput(ComputationNetworkPtr net,
+                                                          ComputationNetworkPtr refNet,
+                                                          const ComputationNodeBasePtr& refNode,
+                                                          const int epochNumber,
+                                                          IDataReader<ElemType>* trainSetDataReader,
+                                                          const double learnRatePerSample,
+                                                          const size_t initialMinibatchSize,
+                                                          const std::vector<ComputationNodeBasePtr>& featureNodes,
+                                                          const std::vector<ComputationNodeBasePtr>& labelNodes,
+                                                          const std::vector<ComputationNodeBasePtr>& criterionNodes,
+                                                          const std::vector<ComputationNodeBasePtr>& evaluationNodes,
+                                                          std::map<std::wstring, Matrix<ElemType>*>* inputMatrices,
+                                                          const std::list<ComputationNodeBasePtr>& learnableNodes,
+                                                          std::list<Matrix<ElemType>>& smoothedGradients,
+                                                          /*in/out*/ size_t& totalSamplesSeen)
+{
+    if (epochNumber < 2 && m_prevChosenMinibatchSize != 0)
+    {
+        // newly started training: any previous MB size stored in the model is to be ignored
+        fprintf(stderr, "before epoch .2, previous minibatchSize %zd is "
+                        "considered invalid -> resetting\n",
+                m_prevChosenMinibatchSize);
+        m_prevChosenMinibatchSize = 0;
+    }
+
+    // check if we need to skip
+    if (m_prevChosenMinibatchSize != 0 &&
+        (epochNumber + 1) > m_minibatchSizeTuningFrequency &&
+        (epochNumber + 1) % m_minibatchSizeTuningFrequency != 0)
+    {
+        fprintf(stderr, "AdaptiveMinibatchByThroughput: tuning in epoch %d skipped, "
+                        "keeping minibatchSize of %zd\n",
+                epochNumber + 1, m_prevChosenMinibatchSize);
+        return m_prevChosenMinibatchSize;
+    }
+
+    const int deviceId = net->GetDeviceId();
+    size_t chosenMinibatchSize = RoundToMultipleOf64(initialMinibatchSize);
+    double bestSamplesPerSecond = 0;
+    size_t prevFreeMem = (deviceId >= 0) ? GPUWatcher::GetFreeMemoryOnCUDADevice(deviceId) : 0;
+
+    for (size_t trialMinibatchSize = chosenMinibatchSize;
+         trialMinibatchSize <= m_minibatchSizeTuningMax;
+         trialMinibatchSize = RoundToMultipleOf64(2 * trialMinibatchSize))
+    {
+        fprintf(stderr, "\nAdaptiveMinibatchByThroughput: timing %zd minibatches with trial minibatchSize=%zd out of range %zd..%zd ...\n\n",
+                m_minibatchThroughputTuningNumMBs, trialMinibatchSize, chosenMinibatchSize, m_minibatchSizeTuningMax);
+
+        double epochCriterion = std::numeric_limits<double>::infinity();
+        std::vector<double> epochEvalErrors(evaluationNodes.size(), std::numeric_limits<double>::infinity());
+
+        Timer timer;
+        timer.Start();
+        size_t samplesProcessed = TrainOneEpoch(net, refNet, refNode, epochNumber,
+                                                trialMinibatchSize * m_minibatchThroughputTuningNumMBs,
+                                                trainSetDataReader, learnRatePerSample, trialMinibatchSize,
+                                                featureNodes, labelNodes, criterionNodes, evaluationNodes,
+                                                inputMatrices, learnableNodes, smoothedGradients,
+                                                /*out*/ epochCriterion, /*out*/ epochEvalErrors,
+                                                /*in/out*/ totalSamplesSeen,
+                                                "AdaptiveMinibatchByThroughput:");
+        timer.Stop();
+
+        double samplesPerSecond = samplesProcessed / timer.ElapsedSeconds();
+        fprintf(stderr, "AdaptiveMinibatchByThroughput: minibatchSize=%zd processed %zd samples at %.1f samples/sec\n",
+                trialMinibatchSize, samplesProcessed, samplesPerSecond);
+
+        if (samplesPerSecond < bestSamplesPerSecond * 1.02)
+        {
+            // larger minibatches no longer translate into meaningfully higher throughput
+            fprintf(stderr, "AdaptiveMinibatchByThroughput: throughput converged, "
+                            "keeping minibatchSize of %zd\n",
+                    chosenMinibatchSize);
+            break;
+        }
+
+        chosenMinibatchSize = trialMinibatchSize;
+        bestSamplesPerSecond = samplesPerSecond;
+
+        if (deviceId >= 0)
+        {
+            size_t freeMem = GPUWatcher::GetFreeMemoryOnCUDADevice(deviceId);
+            // the last doubling grew the working set by (prevFreeMem - freeMem); the next
+            // doubling needs about twice that again, which we require to fit with 100% headroom
+            size_t memGrowth = (prevFreeMem > freeMem) ? prevFreeMem - freeMem : 0;
+            if (memGrowth > 0 && freeMem < 4 * memGrowth)
+            {
+                fprintf(stderr, "AdaptiveMinibatchByThroughput: %zd MB free on device %d would not "
+                                "cover another doubling (last one took %zd MB), keeping minibatchSize of %zd\n",
+                        freeMem >> 20, deviceId, memGrowth >> 20, chosenMinibatchSize);
+                break;
+            }
+            prevFreeMem = freeMem;
+        }
+    }
+
+    fprintf(stderr, "AdaptiveMinibatchByThroughput: chose minibatchSize of %zd at %.1f samples/sec\n\n",
+            chosenMinibatchSize, bestSamplesPerSecond);
+
+    return chosenMinibatchSize;
+}
+
 // run training over a small subset of an epoch, for purpose of automatic LR and MB-size tuning
 template <class ElemType>
 void SGD<ElemType>::TrainOneMiniEpochAndReloadModel(ComputationNetworkPtr net,
@@ -1834,14 +2465,71 @@ void SGD<ElemType>::InitDistGradAgg(int numEvalNodes, int traceLevel)
         if (m_distGradAgg == nullptr)
         {
 #ifdef QUANTIZED_GRADIENT_AGGREGATION
+            if (m_overlappedGradientAggregation)
+            {
+                RuntimeError("useOverlappedGradientAggregation is currently unsupported with quantized gradient aggregation!");
+            }
+
             m_distGradAgg = new AllReduceDistGradAggregator<ElemType>(g_mpi, m_numGradientBits, m_zeroThresholdFor1Bit, true /*useQuantizationForSelfStripe*/, m_bufferedAsyncGradientAggregation, traceLevel, m_syncStatsTrace);
 #else
             if (m_numGradientBits != (8 * sizeof(ElemType)))
             {
-                RuntimeError("Gradient quantization is unsupported in CNTK binaries built without quantized gradient aggregation support!");
+                // quantized aggregation built on the in-tree MatrixQuantizer machinery
+                if (m_useFp16GradientTransfer)
+                {
+                    RuntimeError("useFp16GradientTransfer is currently unsupported with quantized gradient aggregation!");
+                }
+
+                if (m_bufferedAsyncGradientAggregation)
+                {
+                    RuntimeError("useBufferedAsyncGradientAggregation is currently unsupported with quantized gradient aggregation!");
+                }
+
+                if (m_overlappedGradientAggregation)
+                {
+                    RuntimeError("useOverlappedGradientAggregation is currently unsupported with quantized gradient aggregation!");
+                }
+
+                if (m_useRingAllReduceAggregation)
+                {
+                    RuntimeError("useRingAllReduceAggregation is currently unsupported with quantized gradient aggregation!");
+                }
+
+                m_distGradAgg = new QuantizedDistGradAggregator<ElemType>(g_mpi, m_numGradientBits, m_zeroThresholdFor1Bit, m_syncStatsTrace);
+            }
+            else if (m_useRingAllReduceAggregation)
+            {
+                if (m_useFp16GradientTransfer)
+                {
+                    RuntimeError("useFp16GradientTransfer is currently unsupported with useRingAllReduceAggregation!");
+                }
+
+                if (m_bufferedAsyncGradientAggregation)
+                {
+                    RuntimeError("useBufferedAsyncGradientAggregation is currently unsupported with useRingAllReduceAggregation!");
+                }
+
+                if (m_overlappedGradientAggregation)
+                {
+                    RuntimeError("useOverlappedGradientAggregation is currently unsupported with useRingAllReduceAggregation!");
+                }
+
+                m_distGradAgg = new RingAllReduceDistGradAggregator<ElemType>(g_mpi, m_syncStatsTrace);
             }
+            else
+            {
+                if (m_bufferedAsyncGradientAggregation && m_overlappedGradientAggregation)
+                {
+                    RuntimeError("useBufferedAsyncGradientAggregation cannot be combined with useOverlappedGradientAggregation!");
+                }
+
+                if (m_useFp16GradientTransfer && m_overlappedGradientAggregation)
+                {
+                    RuntimeError("useFp16GradientTransfer cannot be combined with useOverlappedGradientAggregation!");
+                }
 
-            m_distGradAgg = new SimpleDistGradAggregator<ElemType>(g_mpi, m_bufferedAsyncGradientAggregation, m_syncStatsTrace);
+                m_distGradAgg = new SimpleDistGradAggregator<ElemType>(g_mpi, m_bufferedAsyncGradientAggregation, m_syncStatsTrace, m_overlappedGradientAggregation, m_useFp16GradientTransfer);
+            }
 #endif // !QUANTIZED_GRADIENT_AGGREGATION
         }
 
@@ -1871,6 +2559,21 @@ bool SGD<ElemType>::ModelAveragingProcessing(size_t nSamplesSinceLastSync, const
         first = false;
     }
 
+    nProcessedFrames = 0;
+
+    // asynchronous mode: apply a previously posted sync as soon as its allreduce has completed,
+    // independently of whether a new one is due (this is the "next safe boundary")
+    if (m_useAsyncModelAveraging && m_maAsyncInFlight)
+        ModelAveragingSyncAsyncPoll(learnableNodes, false /*blocking*/, nProcessedFrames);
+
+    // bounded-staleness mode: likewise, but any number of completed syncs can be pending
+    if (m_maMaxStaleSyncs > 0)
+    {
+        size_t nFrames = 0;
+        while (ModelAveragingBoundedStalenessPoll(learnableNodes, false /*blocking*/, nFrames))
+            nProcessedFrames += nFrames;
+    }
+
     char bNeedToSync = (char) 0; // use char for bool
     if (g_mpi->IsMainNode() && nSamplesSinceLastSync >= m_nFramesBetweenMASync)
     {
@@ -1884,7 +2587,39 @@ bool SGD<ElemType>::ModelAveragingProcessing(size_t nSamplesSinceLastSync, const
         double elapsedsec = MAtimer.ElapsedSeconds();
         SecondsSinceLastSyncFinished = first ? 0 : (float) elapsedsec;
         MAtimer.Start();
-        nProcessedFrames = ModelAveragingSync((int) nSamplesSinceLastSync, learnableNodes);
+        if (m_maMaxStaleSyncs > 0)
+        {
+            // bounded-staleness mode: throttle only when the bound is reached -- i.e. block on
+            // the oldest outstanding sync, which every rank has posted m_maMaxStaleSyncs sync
+            // intervals ago, so this waits on the slowest rank only when we have run that far
+            // ahead of it; otherwise just post and keep training
+            while (m_maOutstandingSyncs.size() >= m_maMaxStaleSyncs)
+            {
+                size_t nFrames = 0;
+                ModelAveragingBoundedStalenessPoll(learnableNodes, true /*blocking*/, nFrames);
+                nProcessedFrames += nFrames;
+            }
+            m_maOutstandingSyncs.push_back(MAOutstandingSync());
+            MAOutstandingSync& sync = m_maOutstandingSyncs.back();
+            ModelAveragingFillContribution((int) nSamplesSinceLastSync, learnableNodes, sync.contribution, sync.snapshot);
+            g_mpi->AllReduceAsync(sync.contribution.data(), sync.contribution.size(), &sync.request);
+        }
+        else if (m_useAsyncModelAveraging)
+        {
+            // drain a still-in-flight sync first (it has had a full sync interval to complete,
+            // so this hardly ever blocks), then post this rank's contribution and keep training
+            if (m_maAsyncInFlight)
+            {
+                size_t nFrames = 0;
+                ModelAveragingSyncAsyncPoll(learnableNodes, true /*blocking*/, nFrames);
+                nProcessedFrames += nFrames;
+            }
+            ModelAveragingSyncAsyncBegin((int) nSamplesSinceLastSync, learnableNodes);
+        }
+        else
+        {
+            nProcessedFrames = ModelAveragingSync((int) nSamplesSinceLastSync, learnableNodes);
+        }
         MAtimer.Stop();
         SecondsSpentOnSync = (float) MAtimer.ElapsedSeconds();
 
@@ -1892,7 +2627,6 @@ bool SGD<ElemType>::ModelAveragingProcessing(size_t nSamplesSinceLastSync, const
     }
     else
     {
-        nProcessedFrames = 0;
         return false;
     }
     return true;
@@ -1906,6 +2640,10 @@ size_t SGD<ElemType>::ModelAveragingSync(int nSamplesSinceLastSync, const std::l
         return nSamplesSinceLastSync;
     }
 
+    // quantized-delta mode transmits compressed weight deltas instead of the full weights
+    if (m_maSyncDeltaBits < 8 * sizeof(ElemType))
+        return ModelAveragingSyncQuantized(nSamplesSinceLastSync, learnableNodes);
+
     // ========================================
     // Sec. 1 calculate factor
     // ========================================
@@ -1922,6 +2660,25 @@ size_t SGD<ElemType>::ModelAveragingSync(int nSamplesSinceLastSync, const std::l
         factor = (nSamplesSinceLastSync + 0.0f) / nTotalSamples;
     }
 
+    // adaptive sync frequency: measure how far the replicas have drifted apart since the last
+    // sync. With per-rank weights factor_r summing to one, the weighted spread of the rank
+    // models around their average is  sum_r factor_r * ||w_r||^2 - ||w_avg||^2.  Both terms
+    // come out identical on every rank (the first from an allreduce, the second from the
+    // averaged model), so all ranks later make the same interval decision for free.
+    double preSyncWeightedSqNorm = 0;
+    if (m_maAdaptiveSyncFrequency)
+    {
+        for (auto iter = learnableNodes.begin(); iter != learnableNodes.end(); iter++)
+        {
+            ComputationNodeBasePtr pNode = *iter;
+            if (!pNode->IsParameterUpdateRequired())
+                continue;
+            double norm = (double) dynamic_pointer_cast<ComputationNode<ElemType>>(pNode)->Value().FrobeniusNorm();
+            preSyncWeightedSqNorm += factor * norm * norm;
+        }
+        g_mpi->AllReduce(&preSyncWeightedSqNorm, 1);
+    }
+
     // ========================================
     // Sec. 2 sync models based on factor
     // Note: this is suboptimal at the moment:
@@ -1952,9 +2709,346 @@ size_t SGD<ElemType>::ModelAveragingSync(int nSamplesSinceLastSync, const std::l
         delete[] px;
     }
 
+    if (m_maAdaptiveSyncFrequency)
+    {
+        double avgSqNorm = 0;
+        for (auto iter = learnableNodes.begin(); iter != learnableNodes.end(); iter++)
+        {
+            ComputationNodeBasePtr pNode = *iter;
+            if (!pNode->IsParameterUpdateRequired())
+                continue;
+            double norm = (double) dynamic_pointer_cast<ComputationNode<ElemType>>(pNode)->Value().FrobeniusNorm();
+            avgSqNorm += norm * norm;
+        }
+        double drift = max(preSyncWeightedSqNorm - avgSqNorm, 0.0); // clamp rounding noise
+        AdaptMASyncFrequency(sqrt(drift) / (sqrt(avgSqNorm) + EPSILON));
+    }
+
     return nTotalSamples;
 }
 
+// AdaptMASyncFrequency - multiplicative-increase/decrease controller on the model-averaging
+// sync interval. When the replicas agree (measured disagreement below half the target) the
+// interval doubles, up to maxSyncFrequencyInFrames -- on a near-converged model further syncs
+// are pure communication overhead. When they have drifted past twice the target it halves,
+// back down to the configured syncFrequencyInFrames. Every rank feeds this the same measured
+// value, so the interval stays consistent across ranks without extra communication.
+template <class ElemType>
+void SGD<ElemType>::AdaptMASyncFrequency(double relativeDisagreement)
+{
+    size_t newInterval = m_nFramesBetweenMASync;
+    if (relativeDisagreement < m_maSyncTargetDisagreement / 2)
+        newInterval = min(m_nFramesBetweenMASync * 2, m_nFramesBetweenMASyncMax);
+    else if (relativeDisagreement > m_maSyncTargetDisagreement * 2)
+        newInterval = max(m_nFramesBetweenMASync / 2, m_nFramesBetweenMASyncBase);
+
+    if (newInterval != m_nFramesBetweenMASync)
+    {
+        if (g_mpi->IsMainNode())
+        {
+            fprintf(stderr, "AdaptMASyncFrequency: replica disagreement %.4f, sync interval %d -> %d frames\n",
+                    relativeDisagreement, (int) m_nFramesBetweenMASync, (int) newInterval);
+        }
+        m_nFramesBetweenMASync = newInterval;
+    }
+}
+
+// ModelAveragingSyncQuantized - like ModelAveragingSync, but each rank transmits only its
+// movement since the model all ranks agreed on at the previous sync, quantized with
+// QuantizedMatrix. The quantization error is kept locally and folded into the next sync's
+// delta (error feedback), so nothing is lost permanently. Every rank reconstructs the
+// average from the same quantized payloads in the same order, which keeps the agreed-on
+// base model bit-identical across ranks without any extra communication.
+template <class ElemType>
+size_t SGD<ElemType>::ModelAveragingSyncQuantized(int nSamplesSinceLastSync, const std::list<ComputationNodeBasePtr>& learnableNodes)
+{
+    // calculate this rank's share of the average, same as in ModelAveragingSync
+    float factor = 0;
+    int nTotalSamples = nSamplesSinceLastSync;
+    g_mpi->AllReduce(&nTotalSamples, 1);
+    if (nTotalSamples <= 0)
+    {
+        // prepare for overflow
+        factor = 1.0f / g_mpi->NumNodesInUse();
+    }
+    else
+    {
+        factor = (nSamplesSinceLastSync + 0.0f) / nTotalSamples;
+    }
+
+    size_t numRanks = g_mpi->NumNodesInUse();
+    size_t myRank = g_mpi->CurrentNodeRank();
+
+    for (auto iter = learnableNodes.begin(); iter != learnableNodes.end(); iter++)
+    {
+        ComputationNodeBasePtr pNode = *iter;
+        if (!pNode->IsParameterUpdateRequired())
+            continue;
+
+        Matrix<ElemType>& mat = dynamic_pointer_cast<ComputationNode<ElemType>>(pNode)->Value();
+        MAQuantizedNodeState& state = m_maQuantStates[pNode->NodeName()];
+        if (state.baseModel == nullptr)
+        {
+            // first sync: no agreed-on base model exists yet, so average this node at full
+            // precision once and use the result as the base for all subsequent deltas
+            Matrix<ElemType>::Scale((ElemType) factor, mat);
+            ElemType* px = mat.CopyToArray();
+            size_t nx = mat.GetNumElements();
+            g_mpi->AllReduce(px, nx);
+            mat.SetValue(mat.GetNumRows(), mat.GetNumCols(), mat.GetDeviceId(), px);
+            delete[] px;
+
+            state.baseModel = std::make_shared<Matrix<ElemType>>(mat, mat.GetDeviceId());
+            state.residual = std::make_shared<Matrix<ElemType>>(mat.GetNumRows(), mat.GetNumCols(), mat.GetDeviceId());
+            state.residual->SetValue((ElemType) 0);
+            state.quantizer.reset(MatrixQuantizerImpl<ElemType>::Create(mat.GetDeviceId(), false /*useAsync*/));
+            state.sendQ = std::make_shared<QuantizedMatrix<ElemType>>(mat.GetNumRows(), mat.GetNumCols(), m_maSyncDeltaBits, CPUDEVICE);
+            state.recvQ = std::make_shared<QuantizedMatrix<ElemType>>(mat.GetNumRows(), mat.GetNumCols(), m_maSyncDeltaBits, CPUDEVICE);
+            state.recvBuf.resize(state.sendQ->GetSize() * numRanks);
+            continue;
+        }
+
+        // this rank's contribution to the new average: its share of its own movement since the base
+        Matrix<ElemType> delta(mat.GetNumRows(), mat.GetNumCols(), mat.GetDeviceId());
+        delta.AssignDifferenceOf(mat, *state.baseModel);
+        Matrix<ElemType>::Scale((ElemType) factor, delta);
+
+        // quantize with error feedback: what this sync loses, the next one carries
+        state.quantizer->QuantizeAsync(delta, *state.residual, *state.sendQ, *state.residual, false /*zeroThresholdFor1Bit*/);
+        state.quantizer->WaitQuantizeAsyncDone();
+
+        // exchange payloads: every rank receives every rank's quantized delta
+        size_t qSize = state.sendQ->GetSize();
+        g_mpi->AllGather(state.sendQ->GetArray(), qSize, state.recvBuf.data());
+
+        // reconstruct the new agreed-on model: base + everyone's quantized delta
+        Matrix<ElemType>& base = *state.baseModel;
+        for (size_t rank = 0; rank < numRanks; rank++)
+        {
+            QuantizedMatrix<ElemType>& qDelta = (rank == myRank) ? *state.sendQ : *state.recvQ;
+            if (rank != myRank)
+                memcpy(qDelta.GetArray(), state.recvBuf.data() + rank * qSize, qSize);
+            state.quantizer->UnquantizeAsync(qDelta, base, true /*add*/);
+            state.quantizer->WaitUnquantizeAsyncDone();
+        }
+        mat.SetValue(base);
+    }
+
+    return nTotalSamples;
+}
+
+// BroadcastLearnableParameters - make the learnable parameters on all ranks bit-identical to srcRank's
+// All weight matrices are laid out back to back in one buffer so that a single broadcast covers
+// everything; on GPU devices the buffer is page-locked and the gather/scatter copies are staged
+// through GPUDataTransferer, the same path the gradient aggregators use.
+template <class ElemType>
+void SGD<ElemType>::BroadcastLearnableParameters(const std::list<ComputationNodeBasePtr>& learnableNodes, size_t srcRank)
+{
+    if ((g_mpi == nullptr) || (g_mpi->NumNodesInUse() <= 1))
+        return;
+
+    size_t totalElements = 0;
+    int deviceId = CPUDEVICE;
+    for (auto iter = learnableNodes.begin(); iter != learnableNodes.end(); iter++)
+    {
+        ComputationNodeBasePtr pNode = *iter;
+        if (!pNode->IsParameterUpdateRequired())
+            continue;
+
+        Matrix<ElemType>& mat = dynamic_pointer_cast<ComputationNode<ElemType>>(pNode)->Value();
+        if (mat.GetMatrixType() != DENSE)
+            RuntimeError("BroadcastLearnableParameters: broadcasting sparse parameter matrices is currently unsupported!");
+        totalElements += mat.GetNumElements();
+        deviceId = mat.GetDeviceId();
+    }
+    if (totalElements == 0)
+        return;
+
+    // pinned staging buffer for GPU devices, plain memory otherwise
+    std::unique_ptr<CUDAPageLockedMemAllocator> allocator;
+    std::shared_ptr<ElemType> pinnedBuffer;
+    std::vector<ElemType> cpuBuffer;
+    ElemType* buffer;
+    std::unique_ptr<GPUDataTransferer<ElemType>> transferer;
+    if (deviceId != CPUDEVICE)
+    {
+        allocator.reset(new CUDAPageLockedMemAllocator(deviceId));
+        pinnedBuffer = std::shared_ptr<ElemType>((ElemType*) allocator->Malloc(totalElements * sizeof(ElemType)),
+                                                 [&allocator](ElemType* p)
+                                                 {
+                                                     allocator->Free(p);
+                                                 });
+        buffer = pinnedBuffer.get();
+        transferer.reset(new GPUDataTransferer<ElemType>(deviceId, false));
+    }
+    else
+    {
+        cpuBuffer.resize(totalElements);
+        buffer = cpuBuffer.data();
+    }
+
+    // gather: the copies all run on the same stream, so one wait after the last one suffices
+    size_t offset = 0;
+    for (auto iter = learnableNodes.begin(); iter != learnableNodes.end(); iter++)
+    {
+        ComputationNodeBasePtr pNode = *iter;
+        if (!pNode->IsParameterUpdateRequired())
+            continue;
+
+        Matrix<ElemType>& mat = dynamic_pointer_cast<ComputationNode<ElemType>>(pNode)->Value();
+        if (deviceId != CPUDEVICE)
+            transferer->CopyGPUToCPUAsync(mat.BufferPointer(), mat.GetNumElements(), buffer + offset);
+        else
+            memcpy(buffer + offset, mat.BufferPointer(), mat.GetNumElements() * sizeof(ElemType));
+        offset += mat.GetNumElements();
+    }
+    if (deviceId != CPUDEVICE)
+        transferer->WaitForCopyGPUToCPUAsync();
+
+    g_mpi->Bcast(buffer, totalElements, srcRank);
+
+    // scatter: the source rank's weights are unchanged, so it can skip the copy back
+    if (g_mpi->CurrentNodeRank() != srcRank)
+    {
+        offset = 0;
+        for (auto iter = learnableNodes.begin(); iter != learnableNodes.end(); iter++)
+        {
+            ComputationNodeBasePtr pNode = *iter;
+            if (!pNode->IsParameterUpdateRequired())
+                continue;
+
+            Matrix<ElemType>& mat = dynamic_pointer_cast<ComputationNode<ElemType>>(pNode)->Value();
+            if (deviceId != CPUDEVICE)
+                transferer->CopyCPUToGPUAsync(buffer + offset, mat.GetNumElements(), mat.BufferPointer());
+            else
+                memcpy(mat.BufferPointer(), buffer + offset, mat.GetNumElements() * sizeof(ElemType));
+            offset += mat.GetNumElements();
+        }
+        if (deviceId != CPUDEVICE)
+            transferer->WaitForCopyCPUToGPUAsync();
+    }
+}
+
+// begin an asynchronous model-averaging sync: snapshot the local weights, post one non-blocking
+// allreduce over all of them, and return immediately so that training continues while the
+// collective makes progress in the background. ModelAveragingSyncAsyncPoll() applies the result.
+template <class ElemType>
+void SGD<ElemType>::ModelAveragingSyncAsyncBegin(int nSamplesSinceLastSync, const std::list<ComputationNodeBasePtr>& learnableNodes)
+{
+    assert(!m_maAsyncInFlight);
+
+    ModelAveragingFillContribution(nSamplesSinceLastSync, learnableNodes, m_maAsyncContribution, m_maAsyncSnapshot);
+    g_mpi->AllReduceAsync(m_maAsyncContribution.data(), m_maAsyncContribution.size(), &m_maAsyncRequest);
+    m_maAsyncInFlight = true;
+}
+
+// build the buffers for one asynchronous sync: the weight matrices are laid out back to back so
+// that a single allreduce covers everything, with a trailing element carrying this rank's sample
+// count for the frame accounting; 'snapshot' keeps the unscaled weights of the post moment
+template <class ElemType>
+void SGD<ElemType>::ModelAveragingFillContribution(int nSamplesSinceLastSync, const std::list<ComputationNodeBasePtr>& learnableNodes,
+                                                   std::vector<ElemType>& contribution, std::vector<ElemType>& snapshot)
+{
+    size_t totalElements = 0;
+    for (auto iter = learnableNodes.begin(); iter != learnableNodes.end(); iter++)
+    {
+        ComputationNodeBasePtr pNode = *iter;
+        if (pNode->IsParameterUpdateRequired())
+            totalElements += dynamic_pointer_cast<ComputationNode<ElemType>>(pNode)->Value().GetNumElements();
+    }
+    contribution.resize(totalElements + 1);
+    snapshot.resize(totalElements);
+
+    // the per-rank sample counts are not known until the collective completes, so the async
+    // variants use a uniform 1/N average rather than the sample-count weighting of the sync path
+    const ElemType factor = (ElemType)(1.0 / g_mpi->NumNodesInUse());
+    size_t offset = 0;
+    for (auto iter = learnableNodes.begin(); iter != learnableNodes.end(); iter++)
+    {
+        ComputationNodeBasePtr pNode = *iter;
+        if (!pNode->IsParameterUpdateRequired())
+            continue;
+
+        Matrix<ElemType>& mat = dynamic_pointer_cast<ComputationNode<ElemType>>(pNode)->Value();
+        size_t nx = mat.GetNumElements();
+        ElemType* px = mat.CopyToArray();
+        memcpy(snapshot.data() + offset, px, nx * sizeof(ElemType));
+        for (size_t i = 0; i < nx; i++)
+            contribution[offset + i] = factor * px[i];
+        delete[] px;
+        offset += nx;
+    }
+    contribution[totalElements] = (ElemType) nSamplesSinceLastSync;
+}
+
+// fold the merged average of a completed sync into the weights: they become the average plus
+// whatever progress this rank has made since the snapshot was taken, so the minibatches that
+// ran while the collective was in flight are not lost. Returns the total sample count the
+// merged average covers.
+template <class ElemType>
+size_t SGD<ElemType>::ModelAveragingApplyMerge(const std::list<ComputationNodeBasePtr>& learnableNodes,
+                                               const std::vector<ElemType>& contribution, const std::vector<ElemType>& snapshot)
+{
+    size_t offset = 0;
+    for (auto iter = learnableNodes.begin(); iter != learnableNodes.end(); iter++)
+    {
+        ComputationNodeBasePtr pNode = *iter;
+        if (!pNode->IsParameterUpdateRequired())
+            continue;
+
+        Matrix<ElemType>& mat = dynamic_pointer_cast<ComputationNode<ElemType>>(pNode)->Value();
+        size_t nx = mat.GetNumElements();
+        ElemType* px = mat.CopyToArray();
+        for (size_t i = 0; i < nx; i++)
+            px[i] += contribution[offset + i] - snapshot[offset + i];
+        mat.SetValue(mat.GetNumRows(), mat.GetNumCols(), mat.GetDeviceId(), px);
+        delete[] px;
+        offset += nx;
+    }
+
+    return (size_t) contribution[offset];
+}
+
+// apply (or wait for) the oldest outstanding bounded-staleness sync; returns true if one was applied
+template <class ElemType>
+bool SGD<ElemType>::ModelAveragingBoundedStalenessPoll(const std::list<ComputationNodeBasePtr>& learnableNodes, bool blocking, size_t& nProcessedFrames)
+{
+    nProcessedFrames = 0;
+    if (m_maOutstandingSyncs.empty())
+        return false;
+
+    MAOutstandingSync& sync = m_maOutstandingSyncs.front();
+    if (blocking)
+        g_mpi->WaitRequest(&sync.request);
+    else if (!g_mpi->TestRequest(&sync.request))
+        return false;
+
+    nProcessedFrames = ModelAveragingApplyMerge(learnableNodes, sync.contribution, sync.snapshot);
+    m_maOutstandingSyncs.pop_front();
+    return true;
+}
+
+// apply a completed asynchronous sync: the weights become the merged average plus whatever
+// progress this rank has made since the snapshot was taken, so the minibatches that ran while
+// the collective was in flight are not lost. Returns true if a sync was applied;
+// nProcessedFrames then holds the total sample count the merged average covers.
+template <class ElemType>
+bool SGD<ElemType>::ModelAveragingSyncAsyncPoll(const std::list<ComputationNodeBasePtr>& learnableNodes, bool blocking, size_t& nProcessedFrames)
+{
+    nProcessedFrames = 0;
+    if (!m_maAsyncInFlight)
+        return false;
+
+    if (blocking)
+        g_mpi->WaitRequest(&m_maAsyncRequest);
+    else if (!g_mpi->TestRequest(&m_maAsyncRequest))
+        return false;
+    m_maAsyncInFlight = false;
+
+    nProcessedFrames = ModelAveragingApplyMerge(learnableNodes, m_maAsyncContribution, m_maAsyncSnapshot);
+    return true;
+}
+
 // public:
 // UpdateWeightsS - static version of UpdateWeights()
 // not static since it wants to access protected methods on the SGD object
@@ -1984,10 +3078,27 @@ template <class ElemType>
     // make actualMBSize is a valid value
     assert(actualMBSize > 0);
 
+    GradientsUpdateType adpType = sgd->GradUpdateType();
+
     // clipping gradients to prevent outliers
-    sgd->ClipGradient(gradientValues, actualMBSize);
+    // For norm clipping with the plain SGD update on a dense gradient (and no L2 term, which by
+    // definition is added unclipped), the clip is not applied in place: the norm is one reduction
+    // pass, and the scale factor is folded into the coefficients of the momentum update below,
+    // saving a full write+read pass over every gradient matrix. All other combinations keep the
+    // explicit in-place clip.
+    ElemType gradientClipScale = 1;
+    if (sgd->m_clippingThresholdPerSample != std::numeric_limits<double>::infinity() &&
+        !sgd->m_gradientClippingWithTruncation && L2RegWeight == 0 &&
+        adpType == GradientsUpdateType::None && gradientValues.GetMatrixType() == MatrixType::DENSE)
+    {
+        double maxGradientPerMB = sgd->m_clippingThresholdPerSample * actualMBSize;
+        double gradientNorm = gradientValues.FrobeniusNorm();
+        if (gradientNorm > maxGradientPerMB)
+            gradientClipScale = (ElemType) (maxGradientPerMB / gradientNorm);
+    }
+    else
+        sgd->ClipGradient(gradientValues, actualMBSize);
 
-    GradientsUpdateType adpType = sgd->GradUpdateType();
     double noiseStd = sgd->GradientUpdateNoiseStd();
     Matrix<ElemType> sgdUpdateNoise((DEVICEID_TYPE) functionValues.GetDeviceId());
     if (noiseStd > 0)
@@ -2009,7 +3120,8 @@ template <class ElemType>
     if (adpType == GradientsUpdateType::None)
     {
         smoothedGradient.NormalGrad(gradientValues, functionValues,
-                                    (ElemType) learnRatePerSample, (ElemType) momentum, useNesterovMomentum);
+                                    (ElemType) learnRatePerSample, (ElemType) momentum, useNesterovMomentum,
+                                    gradientClipScale);
     }
     else if (adpType == GradientsUpdateType::AdaGrad ||
              (adpType == GradientsUpdateType::RmsProp && gradientValues.GetMatrixType() == MatrixType::SPARSE) ||
@@ -2017,8 +3129,17 @@ template <class ElemType>
     {
         // rmsprop for sparse is not implemented yet, delegate it with adagrad
 
-        double aveMultiplier = smoothedGradient.Adagrad(gradientValues, needAveMultiplier);
-        Matrix<ElemType>::ScaleAndAdd((ElemType)(-learnRatePerSample / aveMultiplier), gradientValues, functionValues);
+        if (!needAveMultiplier && gradientValues.GetMatrixType() == MatrixType::DENSE)
+        {
+            // fused path: accumulator update, rsqrt scaling and the weight write in one pass
+            // (the average multiplier needs a global reduction, which forces the two-pass form)
+            smoothedGradient.AdagradUpdate(gradientValues, functionValues, (ElemType) learnRatePerSample);
+        }
+        else
+        {
+            double aveMultiplier = smoothedGradient.Adagrad(gradientValues, needAveMultiplier);
+            Matrix<ElemType>::ScaleAndAdd((ElemType)(-learnRatePerSample / aveMultiplier), gradientValues, functionValues);
+        }
     }
     else if (adpType == GradientsUpdateType::FSAdaGrad)
     {
@@ -2124,15 +3245,43 @@ void SGD<ElemType>::SaveCheckPointInfo(const size_t epoch, const size_t totalSam
             fstream << minibatchSize;
             fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EMinibatchSize");
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
-
-            for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
+            if (m_compressCheckpoints)
             {
-                const Matrix<ElemType>& smoothedGradient = *smoothedGradientIter;
-                fstream << smoothedGradient;
+                // store the smoothed gradients quantized to 16 bits, halving the checkpoint size;
+                // LoadCheckPointInfo() reconstructs them transparently. The quantization error is
+                // bounded by (max-min)/2^16 per matrix, well below the noise in the gradient moments.
+                fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient16");
+                for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
+                {
+                    const Matrix<ElemType>& smoothedGradient = *smoothedGradientIter;
+                    size_t numElements = smoothedGradient.GetNumElements();
+                    ElemType* values = smoothedGradient.CopyToArray();
+                    ElemType qmin = 0, qmax = 0;
+                    for (size_t i = 0; i < numElements; i++)
+                    {
+                        qmin = min(qmin, values[i]);
+                        qmax = max(qmax, values[i]);
+                    }
+                    fstream << smoothedGradient.GetNumRows() << smoothedGradient.GetNumCols() << qmin << qmax;
+                    ValueQuantizer<ElemType> quantizer(4 /*ldNbits, i.e. 16 bits*/, qmin, qmax);
+                    for (size_t i = 0; i < numElements; i++)
+                        fstream << (unsigned short) quantizer.template Quantize<false>(values[i]);
+                    delete[] values;
+                }
+                fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient16");
             }
+            else
+            {
+                fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
+
+                for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
+                {
+                    const Matrix<ElemType>& smoothedGradient = *smoothedGradientIter;
+                    fstream << smoothedGradient;
+                }
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
+                fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
+            }
 
             fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECKP");
 
@@ -2144,6 +3293,51 @@ void SGD<ElemType>::SaveCheckPointInfo(const size_t epoch, const size_t totalSam
     }
 }
 
+// Saves the model and checkpoint info on a background thread so that training can continue while
+// the (potentially large) files are streamed out. The learnable parameters and smoothed gradients
+// are snapshotted into CPU-side copies up front; everything else that Save() writes (topology,
+// precomputed statistics) does not change during regular training. Both writers go through the
+// .tmp-then-rename guard, and obsolete checkpoint files are only deleted afterwards, so a crash
+// mid-write never costs us the previous checkpoint.
+template <class ElemType>
+void SGD<ElemType>::SaveCheckPointAsync(ComputationNetworkPtr net, const int epoch, const size_t totalSamplesSeen,
+                                        const double learnRatePerSample,
+                                        const std::list<ComputationNodeBasePtr>& learnableNodes,
+                                        const std::list<Matrix<ElemType>>& smoothedGradients,
+                                        const double prevCriterion,
+                                        const size_t minibatchSize,
+                                        const std::vector<std::wstring>& obsoleteCheckPointFiles)
+{
+    // only one checkpoint save may be in flight at a time (double buffering: the previous
+    // epoch's write typically finished long ago, so this does not normally block)
+    FinishPendingCheckPointSave();
+
+    // snapshot the learnable parameters into detached CPU-resident node copies; Save() below
+    // will write these in place of the live nodes, which training keeps updating
+    auto nodeOverrides = make_shared<std::map<std::wstring, ComputationNodeBasePtr>>();
+    for (const auto& node : learnableNodes)
+    {
+        auto nodeCopy = dynamic_pointer_cast<ComputationNode<ElemType>>(node->Duplicate(node->NodeName(), CopyNodeFlags::copyNodeValue));
+        if (nodeCopy->Value().GetDeviceId() >= 0)
+            nodeCopy->Value().TransferFromDeviceToDevice(nodeCopy->Value().GetDeviceId(), CPUDEVICE, true /*ismoved*/);
+        (*nodeOverrides)[node->NodeName()] = nodeCopy;
+    }
+
+    // snapshot the smoothed gradients into CPU memory so the writer thread never touches the GPU
+    auto smoothedGradientsCopy = make_shared<std::list<Matrix<ElemType>>>();
+    for (const auto& smoothedGradient : smoothedGradients)
+        smoothedGradientsCopy->emplace_back(smoothedGradient, CPUDEVICE);
+
+    wstring modelFileName = GetModelNameForEpoch(epoch);
+    m_checkPointSaveThread = std::thread([=]()
+    {
+        net->Save(modelFileName, FileOptions::fileOptionsBinary, nodeOverrides.get());
+        SaveCheckPointInfo(epoch, totalSamplesSeen, learnRatePerSample, *smoothedGradientsCopy, prevCriterion, minibatchSize);
+        for (const auto& obsoleteFile : obsoleteCheckPointFiles)
+            _wunlink(obsoleteFile.c_str());
+    });
+}
+
 template <class ElemType>
 bool SGD<ElemType>::LoadCheckPointInfo(const size_t epochNumber,
                                        /*out*/ size_t& totalSamplesSeen,
@@ -2177,14 +3371,42 @@ bool SGD<ElemType>::LoadCheckPointInfo(const size_t epochNumber,
         minibatchSize = m_mbSize[epochNumber];
     }
 
-    fstream.GetMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
-
-    for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
+    if (fstream.TryGetMarker(FileMarker::fileMarkerBeginSection, L"BGradient16")) // compressed checkpoint (compressCheckpoints)
     {
-        Matrix<ElemType>& smoothedGradient = *smoothedGradientIter;
-        fstream >> smoothedGradient;
+        for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
+        {
+            Matrix<ElemType>& smoothedGradient = *smoothedGradientIter;
+            size_t numRows, numCols;
+            ElemType qmin, qmax;
+            fstream >> numRows >> numCols >> qmin >> qmax;
+            if (numRows != smoothedGradient.GetNumRows() || numCols != smoothedGradient.GetNumCols())
+                RuntimeError("LoadCheckPointInfo: dimensions of compressed smoothed gradient [%d x %d] do not match the model [%d x %d].",
+                             (int) numRows, (int) numCols, (int) smoothedGradient.GetNumRows(), (int) smoothedGradient.GetNumCols());
+
+            size_t numElements = numRows * numCols;
+            std::vector<ElemType> values(numElements);
+            ValueQuantizer<ElemType> quantizer(4 /*ldNbits, i.e. 16 bits*/, qmin, qmax);
+            for (size_t i = 0; i < numElements; i++)
+            {
+                unsigned short code;
+                fstream >> code;
+                values[i] = quantizer.Unquantize(code);
+            }
+            smoothedGradient.SetValue(numRows, numCols, smoothedGradient.GetDeviceId(), values.data());
+        }
+        fstream.GetMarker(FileMarker::fileMarkerEndSection, L"EGradient16");
+    }
+    else
+    {
+        fstream.GetMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
+
+        for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
+        {
+            Matrix<ElemType>& smoothedGradient = *smoothedGradientIter;
+            fstream >> smoothedGradient;
+        }
+        fstream.GetMarker(FileMarker::fileMarkerEndSection, L"EGradient");
     }
-    fstream.GetMarker(FileMarker::fileMarkerEndSection, L"EGradient");
 
     fstream.GetMarker(FileMarker::fileMarkerEndSection, L"ECKP");
 
@@ -2424,11 +3646,21 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     m_minibatchSizeTuningMax = configAALR(L"minibatchSizeTuningMax", (size_t) 1048576);
     m_minibatchSearchCriterionErrorMargin = configAALR(L"minibatchSearchCriterionErrorMargin", (size_t) 1);
 
+    // Throughput-driven alternative to autoAdjustMinibatch: instead of judging trial mini-epochs
+    // by the training criterion, time a few hundred live minibatches per candidate size and keep
+    // doubling while samples/sec still improves and GPU memory headroom permits.
+    m_autoAdjustMinibatchByThroughput = configAALR(L"autoAdjustMinibatchByThroughput", false);
+    m_minibatchThroughputTuningNumMBs = configAALR(L"minibatchThroughputTuningNumMBs", (size_t) 100);
+
     // the number of minibatches used to search
     // the learning rate. Its typically set to 10-20% of
     // the total minibatches in an epoch.
     m_numMiniBatch4LRSearch = configAALR(L"numMiniBatch4LRSearch", ConfigRecordType::Array(intargvector(vector<int>{500})));
 
+    // keep the search minibatches resident in memory and replay them for every candidate
+    // rate, so that only the first probe pays for reading them
+    m_useCachedMBsForLRSearch = configAALR(L"useCachedMBsForLRSearch", false);
+
     m_numPrevLearnRates = configAALR(L"numPrevLearnRates", (size_t) 5);
     m_numBestSearchEpoch = configAALR(L"numBestSearchEpoch", (size_t) 1);
     m_loadBestModel = configAALR(L"loadBestModel", true);
@@ -2442,6 +3674,7 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     m_truncated = configSGD(L"truncated", false);
     m_maxSamplesInRAM = configSGD(L"maxSamplesInRAM", (size_t) SIZE_MAX);
     m_numSubminiBatches = configSGD(L"numSubminibatches", (size_t) 1);
+    m_prefetchMinibatches = configSGD(L"prefetchMinibatches", false);
 
     // the number of samples in each epoch (0 means, use all the samples in each epoch).
     m_epochSize = configSGD(L"epochSize", (size_t) 0);
@@ -2468,6 +3701,11 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     m_traceLevel = configSGD(L"traceLevel", (int) 0);
     m_numMBsToShowResult = configSGD(L"numMBsToShowResult", (size_t) 10);
     m_numMBsToCUDAProfile = configSGD(L"numMBsToCUDAProfile", (size_t) 0);
+    m_dumpNodeTimings = configSGD(L"dumpNodeTimings", false);
+    m_dynamicRangeHistogramMBs = configSGD(L"dynamicRangeHistogramMBs", (size_t) 0);
+    m_autoDevicePlacementMBs = configSGD(L"autoDevicePlacementMBs", (size_t) 0);
+    m_pipelinePlanStages = configSGD(L"pipelinePlanStages", (size_t) 0);
+    m_overlapParamUpdate = configSGD(L"overlapParamUpdate", false);
 
     m_gradientClippingWithTruncation = configSGD(L"gradientClippingWithTruncation", true);
     m_clippingThresholdPerSample = configSGD(L"clippingThresholdPerSample", numeric_limits<double>::infinity());
@@ -2624,9 +3862,19 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     m_numGradientBits = 32;
     m_zeroThresholdFor1Bit = true;
     m_bufferedAsyncGradientAggregation = false;
+    m_useRingAllReduceAggregation = false;
+    m_overlappedGradientAggregation = false;
+    m_useFp16GradientTransfer = false;
     m_enableDistributedMBReading = false;
     m_parallelizationStartEpochNum = 0;
     m_nFramesBetweenMASync = 40000; // default 40k frames
+    m_useAsyncModelAveraging = false;
+    m_maMaxStaleSyncs = 0;
+    m_maSyncDeltaBits = 8 * sizeofElemType;
+    m_maAdaptiveSyncFrequency = false;
+    m_nFramesBetweenMASyncBase = m_nFramesBetweenMASync;
+    m_nFramesBetweenMASyncMax = 8 * m_nFramesBetweenMASync;
+    m_maSyncTargetDisagreement = 0.02;
 
     if ((g_mpi != nullptr) && configSGD.Exists(L"ParallelTrain"))
     {
@@ -2643,6 +3891,9 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
             m_numGradientBits = configDataParallelSGD(L"gradientBits", defaultGradientBits);
             m_zeroThresholdFor1Bit = configDataParallelSGD(L"useZeroThresholdFor1BitQuantization", true);
             m_bufferedAsyncGradientAggregation = configDataParallelSGD(L"useBufferedAsyncGradientAggregation", false);
+            m_useRingAllReduceAggregation = configDataParallelSGD(L"useRingAllReduceAggregation", false);
+            m_overlappedGradientAggregation = configDataParallelSGD(L"useOverlappedGradientAggregation", false);
+            m_useFp16GradientTransfer = configDataParallelSGD(L"useFp16GradientTransfer", false);
             if ((m_numGradientBits < 1) || (m_numGradientBits > (8 * sizeofElemType)))
             {
                 InvalidArgument("gradientBits must be in the range [1, 32] when using precision=float and in range [1, 64] when using precision=double!");
@@ -2653,6 +3904,26 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
         {
             const ConfigRecordType& configMASGD(configParallelTrain(L"ModelAveragingSGD", ConfigRecordType::Record()));
             m_nFramesBetweenMASync = configMASGD(L"syncFrequencyInFrames", (size_t) 40000);
+            m_useAsyncModelAveraging = configMASGD(L"useAsyncModelAveraging", false);
+            m_maMaxStaleSyncs = configMASGD(L"maxStaleSyncs", (size_t) 0); // > 0 enables bounded-staleness asynchronous averaging
+            m_maSyncDeltaBits = configMASGD(L"syncDeltaBits", (size_t)(8 * sizeofElemType)); // < full precision enables quantized-delta syncs
+            if ((m_maSyncDeltaBits < 1) || (m_maSyncDeltaBits > (8 * sizeofElemType)))
+            {
+                InvalidArgument("syncDeltaBits must be in the range [1, 32] when using precision=float and in range [1, 64] when using precision=double!");
+            }
+            m_maAdaptiveSyncFrequency = configMASGD(L"adaptiveSyncFrequency", false);
+            m_nFramesBetweenMASyncBase = m_nFramesBetweenMASync;
+            m_nFramesBetweenMASyncMax = configMASGD(L"maxSyncFrequencyInFrames", (size_t)(8 * m_nFramesBetweenMASync));
+            m_maSyncTargetDisagreement = configMASGD(L"syncTargetDisagreement", 0.02);
+            if (m_nFramesBetweenMASyncMax < m_nFramesBetweenMASync)
+            {
+                InvalidArgument("maxSyncFrequencyInFrames must not be smaller than syncFrequencyInFrames!");
+            }
+            if (m_maAdaptiveSyncFrequency && (m_useAsyncModelAveraging || m_maMaxStaleSyncs > 0 || m_maSyncDeltaBits < 8 * sizeofElemType))
+            {
+                fprintf(stderr, "WARNING: adaptiveSyncFrequency is only supported with plain synchronous model averaging and will be ignored\n");
+                m_maAdaptiveSyncFrequency = false;
+            }
         }
     }
 }
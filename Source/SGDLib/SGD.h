@@ -16,6 +16,8 @@
 #include "Config.h"
 #include <chrono>
 #include <random>
+#include <thread>
+#include <future>
 #include "Profiler.h"
 
 using namespace std; // ugh! TODO: get rid of this from .h files!!!
@@ -160,6 +162,10 @@ protected:
     // if m_maxTempMemSizeInSamples = SIZE_MAX (which means users do not specify the option) and m_numSubminiBatches > 1
     // we divide one minibatch to m_numSubminiBatches subMinibatches
 
+    bool m_prefetchMinibatches;
+    // if true, the reader fills the next minibatch into staging buffers on a background thread
+    // while the network computes on the current one (see DataReaderHelpers::MinibatchPrefetcher)
+
     // the number of samples in each epoch (0 means, use all the samples in each epoch).
     size_t m_epochSize;
     size_t m_maxComputedEpochSize;
@@ -173,6 +179,10 @@ protected:
     intargvector m_numMiniBatch4LRSearch;
     size_t m_numBestSearchEpoch;
 
+    // probe learning-rate candidates on minibatches cached in memory instead of re-reading
+    // them for every candidate (see MinibatchCachingReader)
+    bool m_useCachedMBsForLRSearch;
+
     LearningRateSearchAlgorithm m_autoLearnRateSearchType;
 
     AdaptationRegType m_adaptationRegType;
@@ -196,6 +206,8 @@ protected:
     size_t m_minibatchSearchCriterionErrorMargin;
     size_t m_minibatchSizeTuningFrequency;
     size_t m_minibatchSizeTuningMax;
+    bool m_autoAdjustMinibatchByThroughput;   // tune the minibatch size by live samples/sec instead of trial epochs
+    size_t m_minibatchThroughputTuningNumMBs; // number of live minibatches to time per candidate size
 
     floatargvector m_dropoutRates;
     size_t m_maxTempMemSizeInSamplesForCNN;
@@ -212,6 +224,27 @@ protected:
     int m_numMBsToShowResult;
     int m_numMBsToCUDAProfile;
 
+    // if true, accumulate per-node forward/backward timings (wall clock plus CUDA-event device time)
+    // and dump a sorted hot-node report at the end of every epoch
+    bool m_dumpNodeTimings;
+
+    // sample log2 histograms of every node's value/gradient magnitudes on each Nth minibatch and
+    // dump a per-node dynamic-range report at the end of every epoch (see
+    // ComputationNetwork::EnableDynamicRangeTracking()); 0 disables
+    size_t m_dynamicRangeHistogramMBs;
+
+    // number of minibatches per profiling phase of the automatic CPU/GPU node placement
+    // (see ComputationNetwork::EnableAutoDevicePlacement()); 0 disables
+    size_t m_autoDevicePlacementMBs;
+
+    // number of pipeline stages to plan a multi-device model split for (report only; see
+    // ComputationNetwork::PlanPipelinePartition()); 0 disables
+    size_t m_pipelinePlanStages;
+
+    // if true, issue parameter updates on a side GPU stream and fence the next forward pass
+    // per parameter, so early layers' forward kernels overlap late layers' updates
+    bool m_overlapParamUpdate;
+
     bool m_doGradientCheck;
     double m_gradientCheckSigDigit;
 
@@ -234,9 +267,19 @@ protected:
     int m_numGradientBits;
     bool m_bufferedAsyncGradientAggregation;
     bool m_zeroThresholdFor1Bit;
+    bool m_useRingAllReduceAggregation; // aggregate over a packed buffer with an explicit ring allreduce instead of per-matrix collectives
+    bool m_overlappedGradientAggregation; // start each gradient's allreduce as soon as backprop has finalized it, overlapping communication with the backward pass
+    bool m_useFp16GradientTransfer;       // stage GPU gradients across PCIe as packed half precision; the MPI reduction itself stays in full precision
 
     // Parallel training related with MA
     size_t m_nFramesBetweenMASync;
+    bool m_useAsyncModelAveraging; // post the averaging allreduce non-blocking and keep training while it completes (see ModelAveragingSyncAsyncBegin())
+    size_t m_maMaxStaleSyncs;      // bounded-staleness mode: up to this many averaging allreduces may be outstanding at once (0 = off)
+    size_t m_maSyncDeltaBits;      // transmit weight deltas quantized to this many bits with residual carry (8 * sizeof(ElemType) = full precision, off)
+    bool m_maAdaptiveSyncFrequency;    // adapt the sync interval at runtime from measured replica disagreement (see AdaptMASyncFrequency())
+    size_t m_nFramesBetweenMASyncBase; // the configured syncFrequencyInFrames; lower bound and epoch-start value of the adaptive interval
+    size_t m_nFramesBetweenMASyncMax;  // ceiling the adaptive interval may grow to
+    double m_maSyncTargetDisagreement; // relative replica disagreement the adaptive controller steers towards
 
     bool m_needAveMultiplier;
     double m_L2RegWeight;
@@ -256,6 +299,12 @@ protected:
 template <class ElemType>
 class IDistGradAggregator;
 
+template <class ElemType>
+class QuantizedMatrix;
+
+template <class ElemType>
+class MatrixQuantizerImpl;
+
 // -----------------------------------------------------------------------
 // class SGD
 // -----------------------------------------------------------------------
@@ -277,13 +326,17 @@ public:
           // TODO: The next few do not belong into SGD any more than the network or reader we operate on. Either move network and reader in here, or move these out.
           m_modelPath((const wstring&) configSGD(L"modelPath")),
           m_keepCheckPointFiles(configSGD(L"keepCheckPointFiles", false)),
+          m_saveCheckPointsAsync(configSGD(L"saveCheckPointsAsync", false)),
+          m_compressCheckpoints(configSGD(L"compressCheckpoints", false)),
           // m_validateAfterModelReloading(configSGD(L"validateAfterModelReloading", true)),
           m_trainCriterionNodeName((const wstring&) configSGD(L"trainCriterionNodeName", L"")),
           m_evalCriterionNodeName((const wstring&) configSGD(L"evalCriterionNodeName", L"")),
+          m_preComputeCacheFile((const wstring&) configSGD(L"preComputeCacheFile", L"")),
           m_prevChosenMinibatchSize(0),
           m_lastFinishedEpochTrainLoss(0.0),
           m_distGradAgg(nullptr),
-          m_gradHeader(nullptr)
+          m_gradHeader(nullptr),
+          m_maAsyncInFlight(false)
     {
         msra::files::make_intermediate_dirs(m_modelPath);
     }
@@ -295,6 +348,11 @@ public:
     {
     }
 
+    ~SGD()
+    {
+        FinishPendingCheckPointSave();
+    }
+
     void Train(function<ComputationNetworkPtr(DEVICEID_TYPE)> createNetworkFn, DEVICEID_TYPE deviceId,
                IDataReader<ElemType>* trainSetDataReader,
                IDataReader<ElemType>* validationSetDataReader,
@@ -304,6 +362,13 @@ public:
                IDataReader<ElemType>* validationSetDataReader,
                const DEVICEID_TYPE deviceID, const bool makeMode = true);
 
+    // set the staleness key for the precompute cache ('preComputeCacheFile' config parameter);
+    // computed by the caller from the reader configuration, since only the caller sees the input file list
+    void SetPreComputeCacheKey(const std::string& key)
+    {
+        m_preComputeCacheKey = key;
+    }
+
 protected:
 
     std::vector<ComputationNodeBasePtr>& GetTrainCriterionNodes(ComputationNetworkPtr net);
@@ -324,6 +389,10 @@ protected:
                     std::vector<ComputationNodeBasePtr>& labelNodes,
                     std::map<std::wstring, Matrix<ElemType>*>* inputMatrices);
 
+    // precompute cache: returns true if all nodes could be side-loaded from m_preComputeCacheFile
+    bool TryLoadPreComputeCache(const std::list<ComputationNodeBasePtr>& nodes);
+    void SavePreComputeCache(const std::list<ComputationNodeBasePtr>& nodes);
+
     // return a reasonable initial learning rate based on the initial mbsize
     double SearchForBestLearnRate(ComputationNetworkPtr net,
                                   ComputationNetworkPtr refNet,
@@ -375,6 +444,22 @@ protected:
                                    std::list<Matrix<ElemType>>& smoothedGradients,
                                    const double learningRateAdjustmentFactor);
 
+    size_t AdaptiveMinibatchSizingByThroughput(ComputationNetworkPtr net,
+                                               ComputationNetworkPtr refNet,
+                                               const ComputationNodeBasePtr& refNode,
+                                               const int epochNumber,
+                                               IDataReader<ElemType>* trainSetDataReader,
+                                               const double learnRatePerSample,
+                                               const size_t initialMinibatchSize,
+                                               const std::vector<ComputationNodeBasePtr>& featureNodes,
+                                               const std::vector<ComputationNodeBasePtr>& labelNodes,
+                                               const std::vector<ComputationNodeBasePtr>& criterionNodes,
+                                               const std::vector<ComputationNodeBasePtr>& evaluationNodes,
+                                               std::map<std::wstring, Matrix<ElemType>*>* inputMatrices,
+                                               const std::list<ComputationNodeBasePtr>& learnableNodes,
+                                               std::list<Matrix<ElemType>>& smoothedGradients,
+                                               /*in/out*/ size_t& totalSamplesSeen);
+
     // uses a small percentage of training data of minibatch to
     // speculatively train with various MB sizes; then picks the best
     size_t SearchForBestMinibatchSize(ComputationNetworkPtr net,
@@ -430,6 +515,32 @@ protected:
 
     size_t ModelAveragingSync(int nSamplesSinceLastSync, const std::list<ComputationNodeBasePtr>& learnableNodes);
 
+    // quantized-delta variant: transmits each rank's movement since the last agreed-on model,
+    // quantized with residual carry, instead of the full fp32 weights
+    size_t ModelAveragingSyncQuantized(int nSamplesSinceLastSync, const std::list<ComputationNodeBasePtr>& learnableNodes);
+
+    // adjust m_nFramesBetweenMASync from the replica disagreement measured during a sync
+    void AdaptMASyncFrequency(double relativeDisagreement);
+
+    // make the learnable parameters on all ranks bit-identical to those on 'srcRank'
+    void BroadcastLearnableParameters(const std::list<ComputationNodeBasePtr>& learnableNodes, size_t srcRank);
+
+    // asynchronous variant: Begin() snapshots the weights and posts a non-blocking allreduce,
+    // Poll() applies the merged average (plus local progress made in the meantime) once it completes
+    void ModelAveragingSyncAsyncBegin(int nSamplesSinceLastSync, const std::list<ComputationNodeBasePtr>& learnableNodes);
+    bool ModelAveragingSyncAsyncPoll(const std::list<ComputationNodeBasePtr>& learnableNodes, bool blocking, size_t& nProcessedFrames);
+
+    // shared pieces of the asynchronous variants: build the scaled contribution + snapshot for one
+    // sync, and fold a completed sync's merged average back into the weights (returns its frames)
+    void ModelAveragingFillContribution(int nSamplesSinceLastSync, const std::list<ComputationNodeBasePtr>& learnableNodes,
+                                        std::vector<ElemType>& contribution, std::vector<ElemType>& snapshot);
+    size_t ModelAveragingApplyMerge(const std::list<ComputationNodeBasePtr>& learnableNodes,
+                                    const std::vector<ElemType>& contribution, const std::vector<ElemType>& snapshot);
+
+    // bounded-staleness variant: up to maxStaleSyncs non-blocking syncs may be outstanding before
+    // the rank throttles by blocking on its oldest one (see ModelAveragingProcessing())
+    bool ModelAveragingBoundedStalenessPoll(const std::list<ComputationNodeBasePtr>& learnableNodes, bool blocking, size_t& nProcessedFrames);
+
 public:
     // UpdateWeightsS - static version of UpdateWeights()
     static void UpdateWeightsS(const SGD* sgd, Matrix<ElemType>& functionValues,
@@ -462,6 +573,39 @@ protected:
                             const double prevCriterion,
                             const size_t minibatchSize);
 
+    // saves model and checkpoint info on a background thread, from CPU-side snapshots taken up front,
+    // so that training can continue while the files are streamed out
+    void SaveCheckPointAsync(ComputationNetworkPtr net, const int epoch, const size_t totalSamplesSeen,
+                             const double learnRatePerSample,
+                             const std::list<ComputationNodeBasePtr>& learnableNodes,
+                             const std::list<Matrix<ElemType>>& smoothedGradients,
+                             const double prevCriterion,
+                             const size_t minibatchSize,
+                             const std::vector<std::wstring>& obsoleteCheckPointFiles);
+
+    // blocks until an in-flight background checkpoint save (if any) has finished; must be called
+    // before reading or overwriting the files it writes
+    void FinishPendingCheckPointSave()
+    {
+        if (m_checkPointSaveThread.joinable())
+            m_checkPointSaveThread.join();
+    }
+
+    // issue the reader's (possibly distributed) StartMinibatchLoop() for one epoch
+    void StartTrainMinibatchLoop(IDataReader<ElemType>* trainSetDataReader, size_t mbSize, int epochNumber, size_t epochSize, bool useDistributedMBReading);
+
+    // speculatively start the next epoch's minibatch loop on a background thread, so the reader's
+    // schedule computation and first chunk reads overlap the end-of-epoch checkpoint/validation phase
+    void PrimeNextEpochMinibatchLoop(IDataReader<ElemType>* trainSetDataReader, size_t mbSize, int epochNumber, size_t epochSize, bool useDistributedMBReading);
+
+    // blocks until a speculative StartMinibatchLoop() (if any) has finished; must be called before
+    // anything else touches the train reader
+    void JoinPrimedMinibatchLoop()
+    {
+        if (m_primedMinibatchLoop.valid())
+            m_primedMinibatchLoop.get();
+    }
+
     bool LoadCheckPointInfo(const size_t epochNumber,
                             /*out*/ size_t& totalSamplesSeen,
                             /*out*/ double& learnRatePerSample,
@@ -495,17 +639,60 @@ public:
 protected:
     wstring m_modelPath;
     bool m_keepCheckPointFiles;
+    bool m_saveCheckPointsAsync;
+    bool m_compressCheckpoints; // store the smoothed gradients 16-bit quantized (see SaveCheckPointInfo())
+    std::thread m_checkPointSaveThread; // at most one checkpoint save may be in flight
+
+    // speculative next-epoch reader start (see PrimeNextEpochMinibatchLoop())
+    std::future<void> m_primedMinibatchLoop; // in-flight background StartMinibatchLoop() for the next epoch
+    int m_primedLoopEpoch = -1;              // epoch number it was issued for (-1: none primed)
+    size_t m_primedLoopMBSize = 0;           // remaining parameters it was issued with, for the match check
+    size_t m_primedLoopEpochSize = 0;
+    bool m_primedLoopDistributed = false;
     // bool m_validateAfterModelReloading; // TODO: remove this. Why would one not validate a model?
 
     wstring m_trainCriterionNodeName;
     wstring m_evalCriterionNodeName;
 
+    // precompute cache: file that stores the finalized values of all precompute nodes
+    // (Mean/InvStdDev), so that a warm restart skips the full pass over the training data.
+    // The key is a hash over the reader configuration; an empty key disables the cache.
+    wstring m_preComputeCacheFile;
+    std::string m_preComputeCacheKey;
+
     size_t m_prevChosenMinibatchSize;
     double m_lastFinishedEpochTrainLoss;
 
     IDistGradAggregator<ElemType>* m_distGradAgg;
     struct DistGradHeader* m_gradHeader;
 
+    // state of an in-flight asynchronous model-averaging sync (see ModelAveragingSyncAsyncBegin())
+    std::vector<ElemType> m_maAsyncContribution; // scaled local weights + sample count; the allreduce runs in place on this
+    std::vector<ElemType> m_maAsyncSnapshot;     // unscaled local weights at post time, to carry local progress over the merge
+    MPI_Request m_maAsyncRequest;
+    bool m_maAsyncInFlight;
+
+    // bounded-staleness asynchronous model averaging (see ModelAveragingProcessing())
+    struct MAOutstandingSync
+    {
+        std::vector<ElemType> contribution; // scaled local weights + sample count; the allreduce runs in place on this
+        std::vector<ElemType> snapshot;     // unscaled local weights at post time
+        MPI_Request request;
+    };
+    std::list<MAOutstandingSync> m_maOutstandingSyncs; // posted but not yet applied syncs, oldest first
+
+    // per-node state of quantized-delta model averaging (see ModelAveragingSyncQuantized())
+    struct MAQuantizedNodeState
+    {
+        std::shared_ptr<Matrix<ElemType>> baseModel; // model all ranks agreed on at the last sync
+        std::shared_ptr<Matrix<ElemType>> residual;  // quantization error carried into the next sync
+        std::shared_ptr<QuantizedMatrix<ElemType>> sendQ; // this rank's quantized delta
+        std::shared_ptr<QuantizedMatrix<ElemType>> recvQ; // scratch for unquantizing one remote payload
+        std::shared_ptr<MatrixQuantizerImpl<ElemType>> quantizer;
+        std::vector<char> recvBuf; // allgathered payloads of all ranks, ordered by rank
+    };
+    std::map<std::wstring, MAQuantizedNodeState> m_maQuantStates;
+
 private:
     int SGDTrace(FILE* __restrict __stream, const char* __restrict __format, ...);
 };
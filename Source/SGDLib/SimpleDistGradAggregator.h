@@ -2,8 +2,12 @@
 
 #include "IDistGradAggregator.h"
 #include "CUDAPageLockedMemAllocator.h"
+#include <algorithm>
+#include <condition_variable>
 #include <future>
+#include <mutex>
 #include "GPUDataTransferer.h"
+#include "HalfConverter.h"
 #include "TimerUtility.h"
 
 namespace Microsoft { namespace MSR { namespace CNTK {
@@ -14,9 +18,13 @@ class SimpleDistGradAggregator : public IDistGradAggregator<ElemType>
     UsingIDistGradAggregatorMembers;
 
 public:
-    SimpleDistGradAggregator(MPIWrapper* mpi, bool useAsyncAggregation, int syncStatsTrace)
-        : IDistGradAggregator<ElemType>(mpi), m_useAsyncAggregation(useAsyncAggregation), m_currentEpochNumber(-1), m_bufferedGradHeader(nullptr), m_syncStatsTrace(syncStatsTrace), m_iterationCount(0)
+    SimpleDistGradAggregator(MPIWrapper* mpi, bool useAsyncAggregation, int syncStatsTrace, bool useOverlappedAggregation = false, bool useFp16GradientTransfer = false)
+        : IDistGradAggregator<ElemType>(mpi), m_useAsyncAggregation(useAsyncAggregation), m_currentEpochNumber(-1), m_bufferedGradHeader(nullptr), m_syncStatsTrace(syncStatsTrace), m_iterationCount(0), m_useOverlappedAggregation(useOverlappedAggregation), m_useFp16GradientTransfer(useFp16GradientTransfer)
     {
+        if (m_useAsyncAggregation && m_useOverlappedAggregation)
+            LogicError("SimpleDistGradAggregator: buffered async gradient aggregation cannot be combined with overlapped aggregation!");
+        if (m_useFp16GradientTransfer && m_useOverlappedAggregation)
+            LogicError("SimpleDistGradAggregator: fp16 gradient transfer cannot be combined with overlapped aggregation!");
     }
 
     ~SimpleDistGradAggregator()
@@ -39,6 +47,12 @@ public:
         bool showSyncPerfStats = (m_syncStatsTrace > 0) && ((m_iterationCount % m_syncStatsTrace) == 0);
         m_iterationCount++;
 
+        if (m_useOverlappedAggregation)
+        {
+            AggregateGradientsOverlapped(gradients, headerCPU, showSyncPerfStats);
+            return (headerCPU->numSamples != 0);
+        }
+
         if (m_useAsyncAggregation)
         {
             // If we are performing async gradient aggregation, let's wait for the pending gradient aggregation to finish
@@ -121,6 +135,53 @@ public:
         }
     }
 
+    bool SupportsOverlappedAggregation() const override
+    {
+        return m_useOverlappedAggregation;
+    }
+
+    // Called (from the backprop thread) as soon as a gradient has received its final contribution.
+    // Hands the gradient to the communication worker, which aggregates the gradients in a fixed
+    // order while the remainder of the backward pass is still running.
+    void MarkGradientReady(Matrix<ElemType>* gradient) override
+    {
+        // Until the first AggregateGradients() call has registered the gradients and set up the
+        // buffers we do not know the gradient set yet; the first minibatch is aggregated without overlap.
+        if (!m_useOverlappedAggregation || (m_currentEpochNumber == -1))
+            return;
+
+        auto iter = m_gradientIndices.find(gradient);
+        if (iter == m_gradientIndices.end()) // not a gradient we aggregate
+            return;
+
+        size_t gradientIndex = iter->second;
+        int deviceId = gradient->GetDeviceId();
+
+        // Record an event on the main GPU compute stream so that the communication worker can
+        // synchronize the data transfer stream with the completion of this gradient's computation
+        MatrixComputeStreamEvent* mainStreamSyncEvent = MatrixComputeStreamEvent::Create(deviceId);
+
+        {
+            std::unique_lock<std::mutex> lock(m_overlapMutex);
+            m_gradientReadyEvents[gradientIndex] = mainStreamSyncEvent;
+            m_gradientReady[gradientIndex] = true;
+        }
+        m_overlapReadyCondition.notify_one();
+
+        // Lazily start the communication worker on the first ready gradient of this minibatch
+        if (!m_pendingOverlappedAggregation.valid())
+        {
+            m_pendingOverlappedAggregation = std::async(std::launch::async, [this, deviceId]
+                                                        {
+                                                            // We are starting on a new thread. Make sure the new thread is
+                                                            // setup to use the right device
+                                                            Matrix<ElemType>::SetDevice(deviceId);
+
+                                                            OverlappedAggregationWorker();
+                                                        });
+        }
+    }
+
 private:
     std::shared_ptr<ElemType> AllocateIntermediateBuffer(int deviceID, size_t numElements)
     {
@@ -134,6 +195,18 @@ private:
                                          });
     }
 
+    // pinned host buffer for staging gradients across PCIe in half precision
+    std::shared_ptr<unsigned short> AllocateHalfBuffer(int deviceID, size_t numElements)
+    {
+        assert(deviceID >= 0);
+
+        size_t totalSize = sizeof(unsigned short) * numElements;
+        return std::shared_ptr<unsigned short>((unsigned short*) m_allocator->Malloc(totalSize), [this, deviceID](unsigned short* p)
+                                               {
+                                                   m_allocator->Free(p);
+                                               });
+    }
+
     bool ResetCurrentEpoch(const std::vector<Matrix<ElemType>*>& gradients, int numEvalNode, int epochNumber)
     {
         bool isNewEpoch = (m_currentEpochNumber != epochNumber);
@@ -155,14 +228,28 @@ private:
 
                 if (deviceId != CPUDEVICE)
                 {
-                    m_gpuDataTransferers.push_back(std::unique_ptr<GPUDataTransferer<ElemType>>(new GPUDataTransferer<ElemType>(deviceId, m_useAsyncAggregation)));
+                    m_gpuDataTransferers.push_back(std::unique_ptr<GPUDataTransferer<ElemType>>(new GPUDataTransferer<ElemType>(deviceId, m_useAsyncAggregation || m_useOverlappedAggregation)));
                     m_intermediateCPUBuffers.push_back(AllocateIntermediateBuffer(deviceId, gradients[i]->GetNumElements()));
+                    if (m_useFp16GradientTransfer)
+                        m_halfCPUBuffers.push_back(AllocateHalfBuffer(deviceId, gradients[i]->GetNumElements()));
                 }
 
                 if (m_useAsyncAggregation)
                 {
                     m_bufferedGradients[gradients[i]].reset(new Matrix<ElemType>(gradients[i]->GetNumRows(), gradients[i]->GetNumCols(), deviceId));
                 }
+
+                if (m_useOverlappedAggregation)
+                {
+                    m_registeredGradients.push_back(gradients[i]);
+                    m_gradientIndices[gradients[i]] = i;
+                }
+            }
+
+            if (m_useOverlappedAggregation)
+            {
+                m_gradientReady.resize(gradients.size(), false);
+                m_gradientReadyEvents.resize(gradients.size(), nullptr);
             }
 
             if (m_useAsyncAggregation)
@@ -205,6 +292,155 @@ private:
         return isNewEpoch;
     }
 
+    // Aggregates the registered gradients in fixed reverse-registration order. Backprop finalizes
+    // the gradients of the topmost layers first, so this approximates the order in which they become
+    // ready. The order must be identical on all nodes since the MPI collectives have to be issued in
+    // matching order on every rank; hence we wait for each gradient in turn rather than aggregating
+    // them in completion order.
+    void OverlappedAggregationWorker()
+    {
+        for (size_t i = m_registeredGradients.size(); i-- > 0;)
+        {
+            MatrixComputeStreamEvent* mainStreamSyncEvent;
+            {
+                std::unique_lock<std::mutex> lock(m_overlapMutex);
+                m_overlapReadyCondition.wait(lock, [this, i]
+                                             {
+                                                 return m_gradientReady[i];
+                                             });
+                mainStreamSyncEvent = m_gradientReadyEvents[i];
+            }
+
+            AggregateSingleGradient(i, mainStreamSyncEvent);
+        }
+    }
+
+    void AggregateSingleGradient(size_t i, MatrixComputeStreamEvent* mainStreamSyncEvent)
+    {
+        Matrix<ElemType>* gradient = m_registeredGradients[i];
+        int deviceId = gradient->GetDeviceId();
+
+        ElemType* reductionBuffer = gradient->BufferPointer();
+        if (deviceId >= 0)
+        {
+            // Make sure the data transfer stream does not fetch the gradient before its computation
+            // on the main compute stream has completed
+            mainStreamSyncEvent->SynchronizeDataTransferFetchStreamWithEvent<ElemType>();
+
+            m_gpuDataTransferers[i]->CopyGPUToCPUAsync(gradient->BufferPointer(), gradient->GetNumElements(), m_intermediateCPUBuffers[i].get());
+            m_gpuDataTransferers[i]->WaitForCopyGPUToCPUAsync();
+            reductionBuffer = m_intermediateCPUBuffers[i].get();
+        }
+
+        delete mainStreamSyncEvent;
+
+        MPI_Allreduce(MPI_IN_PLACE, reductionBuffer, gradient->GetNumElements(), MPIWrapper::GetDataType(reductionBuffer), MPI_SUM, m_mpi->Communicator()) || MpiFail("MPI_Allreduce");
+
+        if (deviceId >= 0)
+        {
+            m_gpuDataTransferers[i]->CopyCPUToGPUAsync(m_intermediateCPUBuffers[i].get(), gradient->GetNumElements(), gradient->BufferPointer());
+            m_gpuDataTransferers[i]->WaitForCopyCPUToGPUAsync();
+        }
+    }
+
+    void AggregateGradientsOverlapped(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool showSyncPerfStats)
+    {
+        Timer aggregationTimer;
+        if (showSyncPerfStats)
+            aggregationTimer.Start();
+
+        size_t numGradMatrices = gradients.size();
+
+        if (m_pendingOverlappedAggregation.valid())
+        {
+            // Wait for the communication worker to finish aggregating the gradients that backprop
+            // handed to it
+            m_pendingOverlappedAggregation.get();
+        }
+        else
+        {
+            // No gradients were handed to the worker this minibatch (this node did not process any
+            // samples, backprop was skipped, or this is the very first minibatch where the gradient
+            // set was not known yet). The per-gradient collectives must still be issued in the same
+            // order since the other ranks participate in them.
+            if (headerCPU->numSamples == 0)
+            {
+                assert(headerCPU->criterion == 0);
+
+                // If the current node did not process any samples, the gradients should be zero'd
+                for (size_t i = 0; i < numGradMatrices; ++i)
+                {
+                    gradients[i]->SetValue(0);
+                }
+            }
+
+            for (size_t i = numGradMatrices; i-- > 0;)
+            {
+                AggregateSingleGradient(i, MatrixComputeStreamEvent::Create(gradients[i]->GetDeviceId()));
+            }
+        }
+
+        // reset the ready flags for the next minibatch
+        std::fill(m_gradientReady.begin(), m_gradientReady.end(), false);
+
+        // Exchange and aggregate the headers; same protocol as the non-overlapped path, but only
+        // entered after all gradient collectives have completed, so that at no point two threads
+        // issue MPI calls concurrently
+        std::vector<MPI_Request> recvHeaderRequests(NumProc() - 1);
+        if (m_mpi->IsMainNode())
+        {
+            for (size_t j = 0; j < NumProc() - 1; ++j)
+            {
+                int source = (j >= MyRank()) ? (j + 1) : j;
+                // We use a tag of 'numGradMatrices' for the pre-aggregation header
+                MPI_Irecv(m_recvHeaders[j], m_recvHeaders[j]->Size(), MPI_CHAR, source, numGradMatrices, m_mpi->Communicator(), &(recvHeaderRequests[j])) || MpiFail("MPI_Irecv");
+            }
+
+            size_t numNodesHeadersReceivedFrom = 0;
+            while (numNodesHeadersReceivedFrom < (NumProc() - 1))
+            {
+                int idx = MPI_UNDEFINED;
+                MPI_Waitany(recvHeaderRequests.size(), recvHeaderRequests.data(), &idx, MPI_STATUS_IGNORE) || MpiFail("MPI_Waitany");
+                if (idx == MPI_UNDEFINED)
+                {
+                    break;
+                }
+
+                numNodesHeadersReceivedFrom++;
+
+                headerCPU->Aggregate(m_recvHeaders[idx], true);
+            }
+
+            assert(numNodesHeadersReceivedFrom == (NumProc() - 1));
+
+            // Broadcast the aggregated header back to the other nodes
+            std::vector<MPI_Request> sendAggHeaderRequests(NumProc() - 1);
+            for (size_t j = 0; j < NumProc() - 1; ++j)
+            {
+                int dest = (j >= MyRank()) ? (j + 1) : j;
+                MPI_Isend(headerCPU, headerCPU->Size(), MPI_CHAR, dest, numGradMatrices + 1 + numGradMatrices, m_mpi->Communicator(), &(sendAggHeaderRequests[j])) || MpiFail("MPI_Isend");
+            }
+
+            MPI_Waitall(sendAggHeaderRequests.size(), sendAggHeaderRequests.data(), MPI_STATUSES_IGNORE) || MpiFail("MPI_Waitall");
+        }
+        else
+        {
+            MPI_Request sendHeaderRequest;
+            MPI_Isend(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank(), numGradMatrices, m_mpi->Communicator(), &sendHeaderRequest) || MpiFail("MPI_Isend");
+
+            MPI_Recv(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank(), numGradMatrices + 1 + numGradMatrices, m_mpi->Communicator(), MPI_STATUS_IGNORE) || MpiFail("MPI_Recv");
+
+            MPI_Wait(&sendHeaderRequest, MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+        }
+
+        if (showSyncPerfStats)
+        {
+            aggregationTimer.Stop();
+            double epochTime = aggregationTimer.ElapsedSeconds();
+            fprintf(stderr, "Actual gradient aggregation time: %.6g\n", epochTime);
+        }
+    }
+
     void AggregateGradientsImpl(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool showSyncPerfStats)
     {
         Timer aggregationTimer;
@@ -244,7 +480,10 @@ private:
         {
             for (size_t i = 0; i < numGradMatrices; ++i)
             {
-                m_gpuDataTransferers[i]->CopyGPUToCPUAsync(gradients[i]->BufferPointer(), gradients[i]->GetNumElements(), m_intermediateCPUBuffers[i].get());
+                if (m_useFp16GradientTransfer) // convert on the device, so only half-width data crosses the bus
+                    gradients[i]->CopyToFloat16Array(m_halfCPUBuffers[i].get());
+                else
+                    m_gpuDataTransferers[i]->CopyGPUToCPUAsync(gradients[i]->BufferPointer(), gradients[i]->GetNumElements(), m_intermediateCPUBuffers[i].get());
             }
         }
 
@@ -274,7 +513,10 @@ private:
             ElemType* reductionBuffer = gradients[i]->BufferPointer();
             if (deviceId >= 0)
             {
-                m_gpuDataTransferers[i]->WaitForCopyGPUToCPUAsync();
+                if (m_useFp16GradientTransfer) // expand to ElemType, so the MPI reduction itself stays full precision
+                    HalfConverter<ElemType>::FromHalfBuffer(m_halfCPUBuffers[i].get(), gradients[i]->GetNumElements(), m_intermediateCPUBuffers[i].get());
+                else
+                    m_gpuDataTransferers[i]->WaitForCopyGPUToCPUAsync();
                 reductionBuffer = m_intermediateCPUBuffers[i].get();
             }
 
@@ -328,7 +570,13 @@ private:
             MPI_Wait(&allReduceRequests[i], MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
             if (deviceId >= 0)
             {
-                m_gpuDataTransferers[i]->CopyCPUToGPUAsync(m_intermediateCPUBuffers[i].get(), gradients[i]->GetNumElements(), gradients[i]->BufferPointer());
+                if (m_useFp16GradientTransfer) // ship the aggregate back in half-width, expand on the device
+                {
+                    HalfConverter<ElemType>::ToHalfBuffer(m_intermediateCPUBuffers[i].get(), gradients[i]->GetNumElements(), m_halfCPUBuffers[i].get());
+                    gradients[i]->SetValueFromFloat16Array(gradients[i]->GetNumRows(), gradients[i]->GetNumCols(), m_halfCPUBuffers[i].get());
+                }
+                else
+                    m_gpuDataTransferers[i]->CopyCPUToGPUAsync(m_intermediateCPUBuffers[i].get(), gradients[i]->GetNumElements(), gradients[i]->BufferPointer());
             }
         }
 
@@ -338,8 +586,8 @@ private:
             MPI_Wait(&recvAggHeaderRequest, MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
         }
 
-        // Wait for all the transfers to finish
-        if (deviceId >= 0)
+        // Wait for all the transfers to finish (the fp16 path uploads synchronously)
+        if (deviceId >= 0 && !m_useFp16GradientTransfer)
         {
             for (size_t i = 0; i < numGradMatrices; ++i)
             {
@@ -368,6 +616,7 @@ private:
 private:
     std::unique_ptr<CUDAPageLockedMemAllocator> m_allocator;
     std::vector<std::shared_ptr<ElemType>> m_intermediateCPUBuffers;
+    std::vector<std::shared_ptr<unsigned short>> m_halfCPUBuffers; // pinned staging buffers for fp16 gradient transfer
 
     std::vector<std::unique_ptr<GPUDataTransferer<ElemType>>> m_gpuDataTransferers;
 
@@ -389,5 +638,28 @@ private:
     size_t m_iterationCount;
 
     int m_currentEpochNumber;
+
+    // Aggregate each gradient as soon as backprop has finalized it, overlapping communication
+    // with the remainder of the backward pass
+    bool m_useOverlappedAggregation;
+
+    // Stage GPU gradients across PCIe as packed half precision (convert on the device, expand
+    // on the host), halving the bus traffic in both directions; the MPI reduction itself stays
+    // in ElemType. No effect for CPU-resident gradients.
+    bool m_useFp16GradientTransfer;
+
+    // Registered gradients in registration order and the index of each gradient matrix therein
+    std::vector<Matrix<ElemType>*> m_registeredGradients;
+    std::unordered_map<Matrix<ElemType>*, size_t> m_gradientIndices;
+
+    // Per-gradient ready flags and compute stream sync events, set by MarkGradientReady() on the
+    // backprop thread and consumed by the communication worker
+    std::vector<bool> m_gradientReady;
+    std::vector<MatrixComputeStreamEvent*> m_gradientReadyEvents;
+    std::mutex m_overlapMutex;
+    std::condition_variable m_overlapReadyCondition;
+
+    // Future corresponding to the communication worker of the current minibatch
+    std::future<void> m_pendingOverlappedAggregation;
 };
 } } }
@@ -24,13 +24,17 @@ template <class ElemType>
 class SimpleEvaluator
 {
 public:
-    SimpleEvaluator(ComputationNetworkPtr net, const size_t numMBsToShowResult = 100, const int traceLevel = 0)
-        : m_net(net), m_numMBsToShowResult(numMBsToShowResult), m_traceLevel(traceLevel)
+    SimpleEvaluator(ComputationNetworkPtr net, const size_t numMBsToShowResult = 100, const int traceLevel = 0, const bool prefetchMinibatches = false)
+        : m_net(net), m_numMBsToShowResult(numMBsToShowResult), m_traceLevel(traceLevel), m_prefetchMinibatches(prefetchMinibatches)
     {
     }
 
     // returns evaluation node values per sample determined by evalNodeNames (which can include both training and eval criterion nodes)
-    vector<double> Evaluate(IDataReader<ElemType>* dataReader, const vector<wstring>& evalNodeNames, const size_t mbSize, const size_t testSize = requestDataSize)
+    // distributed - shard the eval set across the MPI ranks and AllReduce the results (the
+    //               default). Pass false to evaluate the full set locally even when MPI is
+    //               active, e.g. when the caller distributes whole models across the ranks
+    //               instead (cross validation) and a collective per model would be wrong.
+    vector<double> Evaluate(IDataReader<ElemType>* dataReader, const vector<wstring>& evalNodeNames, const size_t mbSize, const size_t testSize = requestDataSize, const bool distributed = true)
     {
         // determine nodes to evaluate
         std::vector<ComputationNodeBasePtr> evalNodes;
@@ -92,11 +96,41 @@ public:
         for (int i = 0; i < evalResults.size(); i++)
             evalResultsLastMBs.push_back((ElemType) 0);
 
-        dataReader->StartMinibatchLoop(mbSize, 0, testSize);
+        // accumulate the criteria on the device and fetch them to the host only when they are
+        // displayed: reading Get00Element() after every minibatch forces a GPU sync per node,
+        // which serializes evaluation against the device
+        std::vector<shared_ptr<Matrix<ElemType>>> evalResultsAccum;
+        for (int i = 0; i < evalNodes.size(); i++)
+        {
+            evalResultsAccum.push_back(make_shared<Matrix<ElemType>>(1, 1, m_net->GetDeviceId()));
+            evalResultsAccum[i]->SetValue(0);
+        }
+        auto fetchEvalResults = [&]()
+        {
+            for (int i = 0; i < evalNodes.size(); i++)
+                evalResults[i] = (double) evalResultsAccum[i]->Get00Element();
+        };
+
+        // distributed evaluation: with multiple MPI ranks and a reader that can shard the data, every
+        // rank evaluates its own subset of the eval set, accumulating metrics and sample counts
+        // locally; the per-rank partial sums are combined with one AllReduce at the very end,
+        // rather than synchronizing the ranks per minibatch
+        bool useDistributedMBReading = distributed && (g_mpi != nullptr) && (g_mpi->NumNodesInUse() > 1) && dataReader->SupportsDistributedMBRead();
+        if (useDistributedMBReading)
+            dataReader->StartDistributedMinibatchLoop(mbSize, 0, g_mpi->CurrentNodeRank(), g_mpi->NumNodesInUse(), testSize);
+        else
+            dataReader->StartMinibatchLoop(mbSize, 0, testSize);
         m_net->StartEvaluateMinibatchLoop(evalNodes);
 
-        while (DataReaderHelpers::GetMinibatchIntoNetwork(*dataReader, m_net, nullptr, false, false, inputMatrices, actualMBSize))
+        std::unique_ptr<DataReaderHelpers::MinibatchPrefetcher<ElemType>> prefetcher;
+        if (m_prefetchMinibatches)
+            prefetcher.reset(new DataReaderHelpers::MinibatchPrefetcher<ElemType>(*dataReader));
+
+        while (DataReaderHelpers::GetMinibatchIntoNetwork(*dataReader, m_net, nullptr, useDistributedMBReading, false, inputMatrices, actualMBSize, prefetcher.get()))
         {
+            if (actualMBSize == 0) // a rank whose shard ran out may be handed empty minibatches near the end
+                continue;
+
             ComputationNetwork::BumpEvalTimeStamp(featureNodes);
             ComputationNetwork::BumpEvalTimeStamp(labelNodes);
 
@@ -104,11 +138,12 @@ public:
             // Later, when we apply different labels on different nodes
             // we need to add code to call this function multiple times, one for each criteria node
             size_t numSamplesWithLabel = m_net->GetNumSamplesWithLabel(actualMBSize);
-            for (int i = 0; i < evalNodes.size(); i++)
-            {
-                m_net->ForwardProp(evalNodes[i]);
-                evalResults[i] += (double) evalNodes[i]->Get00Element(); // criterionNode should be a scalar
-            }
+
+            // evaluate all nodes in one sweep; sub-expressions shared between the criteria are
+            // computed only once, since forward prop skips nodes that are up to date w.r.t. their inputs
+            m_net->ForwardProp(evalNodes);
+            for (int i = 0; i < evalNodes.size(); i++) // criterionNode should be a scalar
+                Matrix<ElemType>::ScaleAndAdd((ElemType) 1, dynamic_pointer_cast<ComputationNode<ElemType>>(evalNodes[i])->Value(), *evalResultsAccum[i]);
 
             totalEpochSamples += numSamplesWithLabel;
             numMBsRun++;
@@ -119,6 +154,7 @@ public:
 
                 if (numMBsRun % m_numMBsToShowResult == 0)
                 {
+                    fetchEvalResults();
                     DisplayEvalStatistics(lastMBsRun + 1, numMBsRun, numSamplesLastMBs, evalNodes, evalResults, evalResultsLastMBs);
 
                     for (int i = 0; i < evalResults.size(); i++)
@@ -135,6 +171,16 @@ public:
             dataReader->DataEnd(endDataSentence);
         }
 
+        fetchEvalResults();
+
+        // combine the per-rank partial sums; MPI_Allreduce performs the tree reduction internally,
+        // and this is the only collective of the whole evaluation
+        if (useDistributedMBReading)
+        {
+            g_mpi->AllReduce(evalResults);
+            g_mpi->AllReduce(&totalEpochSamples, 1);
+        }
+
         // show last batch of results
         if (m_traceLevel > 0 && numSamplesLastMBs > 0)
         {
@@ -199,6 +245,7 @@ protected:
     ComputationNetworkPtr m_net;
     size_t m_numMBsToShowResult;
     int m_traceLevel;
+    bool m_prefetchMinibatches; // read the next minibatch on a background thread while the network computes (see DataReaderHelpers::MinibatchPrefetcher)
     void operator=(const SimpleEvaluator&); // (not assignable)
 };
 } } }
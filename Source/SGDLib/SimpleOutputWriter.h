@@ -10,10 +10,13 @@
 #include "DataReaderHelpers.h"
 #include "Helpers.h"
 #include "fileutil.h"
+#include "File.h" // for FormatTextRows()
 #include <vector>
 #include <string>
 #include <stdexcept>
 #include <fstream>
+#include <future>
+#include <memory>
 
 using namespace std;
 
@@ -50,9 +53,13 @@ public:
                 outputNodes.push_back(m_net->GetNodeFromName(outputNodeNames[i]));
         }
 
-        // allocate memory for forward computation
+        // allocate memory for forward computation; restricting the roots to the requested output
+        // nodes means matrices of training-only branches (criteria etc.) are never allocated, and
+        // ForwardProp() below likewise only evaluates the ancestor subgraph of each output node
         m_net->AllocateAllMatrices({}, outputNodes, nullptr);
 
+        PrepareOutputSubgraphForInference(outputNodes);
+
         // specify feature value nodes
         std::vector<ComputationNodeBasePtr>& featureNodes = m_net->FeatureNodes();
         std::vector<ComputationNodeBasePtr>& labelNodes = m_net->LabelNodes();
@@ -73,6 +80,21 @@ public:
         size_t totalEpochSamples = 0;
         std::map<std::wstring, void*, nocase_compare> outputMatrices;
 
+        // Double-buffered write pipeline: the outputs of each minibatch are copied into host-side staging
+        // matrices and streamed through the DataWriter on a background task, while the main thread already
+        // fetches and forward-propagates the next minibatch. One buffer is filled while the other is written;
+        // at most one write is in flight at a time, so minibatches reach the writer in order.
+        const size_t numStagingSlots = 2;
+        std::vector<std::vector<std::unique_ptr<Matrix<ElemType>>>> stagingValues(numStagingSlots);
+        for (size_t slot = 0; slot < numStagingSlots; slot++)
+            for (size_t i = 0; i < outputNodes.size(); i++)
+                stagingValues[slot].push_back(std::unique_ptr<Matrix<ElemType>>(new Matrix<ElemType>(CPUDEVICE)));
+        size_t currentSlot = 0;
+        std::future<void> pendingWrite;
+        size_t tempArraySize = 0;
+        ElemType* tempArray = nullptr;
+        std::vector<std::pair<size_t, size_t>> recordInfo; // per-sequence (record index, frames) when the reader batches records out of script order
+
         size_t actualMBSize;
         while (DataReaderHelpers::GetMinibatchIntoNetwork(dataReader, m_net, nullptr, false, false, inputMatrices, actualMBSize))
         {
@@ -82,7 +104,11 @@ public:
             for (int i = 0; i < outputNodes.size(); i++)
             {
                 m_net->ForwardProp(outputNodes[i]);
-                outputMatrices[outputNodes[i]->NodeName()] = (void*) (&dynamic_pointer_cast<ComputationNode<ElemType>>(outputNodes[i])->Value());
+
+                Matrix<ElemType>& outputValues = dynamic_pointer_cast<ComputationNode<ElemType>>(outputNodes[i])->Value();
+                outputValues.CopyToArray(tempArray, tempArraySize);
+                stagingValues[currentSlot][i]->SetValue(outputValues.GetNumRows(), outputValues.GetNumCols(), CPUDEVICE, tempArray);
+                outputMatrices[outputNodes[i]->NodeName()] = (void*) stagingValues[currentSlot][i].get();
             }
 
             if (doUnitTest)
@@ -93,7 +119,56 @@ public:
                 dataWriter.SaveData(0, inputMatricesUnitTest, actualMBSize, actualMBSize, 0);
             }
             else
-                dataWriter.SaveData(0, outputMatrices, actualMBSize, actualMBSize, 0);
+            {
+                // wait for the previous write to finish before starting the next one; this also guarantees
+                // that the staging slot we fill in the next iteration is no longer being read by the writer
+                if (pendingWrite.valid())
+                    pendingWrite.get();
+
+                if (dataReader.GetWriteRecordInfo(recordInfo) && !recordInfo.empty())
+                {
+                    // the reader packed several out-of-script-order records into the minibatch as
+                    // parallel sequences: slice each record's frames out of the interleaved columns
+                    // and hand it to the writer separately, with its script index as the record
+                    // start so the writer can restore the original order (pair with a writer that
+                    // honors it, i.e. indexedWrite=true for the HTKMLFWriter)
+                    auto writeRecordInfo = recordInfo;
+                    pendingWrite = std::async(std::launch::async, [&dataWriter, &outputNodes, &stagingValues, currentSlot, writeRecordInfo]
+                                              {
+                                                  size_t numSeqs = writeRecordInfo.size();
+                                                  std::vector<std::unique_ptr<Matrix<ElemType>>> recordValues;
+                                                  for (size_t i = 0; i < outputNodes.size(); i++)
+                                                      recordValues.push_back(std::unique_ptr<Matrix<ElemType>>(new Matrix<ElemType>(CPUDEVICE)));
+                                                  std::map<std::wstring, void*, nocase_compare> recordMatrices;
+                                                  for (size_t u = 0; u < numSeqs; u++)
+                                                  {
+                                                      size_t numFrames = writeRecordInfo[u].second;
+                                                      for (int i = 0; i < outputNodes.size(); i++)
+                                                      {
+                                                          Matrix<ElemType>& mb = *stagingValues[currentSlot][i];
+                                                          size_t numRows = mb.GetNumRows();
+                                                          recordValues[i]->Resize(numRows, numFrames);
+                                                          for (size_t t = 0; t < numFrames; t++)
+                                                              memcpy(recordValues[i]->BufferPointer() + t * numRows,
+                                                                     mb.BufferPointer() + (t * numSeqs + u) * numRows,
+                                                                     sizeof(ElemType) * numRows);
+                                                          recordMatrices[outputNodes[i]->NodeName()] = (void*) recordValues[i].get();
+                                                      }
+                                                      dataWriter.SaveData(writeRecordInfo[u].first, recordMatrices, numFrames, numFrames, 0);
+                                                  }
+                                              });
+                }
+                else
+                {
+                    auto writeOutputMatrices = outputMatrices;
+                    size_t writeMBSize = actualMBSize;
+                    pendingWrite = std::async(std::launch::async, [&dataWriter, writeOutputMatrices, writeMBSize]
+                                              {
+                                                  dataWriter.SaveData(0, writeOutputMatrices, writeMBSize, writeMBSize, 0);
+                                              });
+                }
+                currentSlot = (currentSlot + 1) % numStagingSlots;
+            }
 
             totalEpochSamples += actualMBSize;
 
@@ -102,10 +177,15 @@ public:
             dataReader.DataEnd(endDataSentence);
         }
 
+        // drain the last in-flight write before the staging buffers go out of scope
+        if (pendingWrite.valid())
+            pendingWrite.get();
+
         if (m_verbosity > 0)
             fprintf(stderr, "Total Samples Evaluated = %lu\n", totalEpochSamples);
 
         // clean up
+        delete[] tempArray;
     }
 
     void WriteOutput(IDataReader<ElemType>& dataReader, size_t mbSize, std::wstring outputPath, const std::vector<std::wstring>& outputNodeNames, size_t numOutputSamples = requestDataSize)
@@ -136,9 +216,12 @@ public:
             outputStreams.push_back(new ofstream(wtocharpath(outputPath + L"." + outputNodes[i]->NodeName()).c_str()));
 #endif
 
-        // allocate memory for forward computation
+        // allocate memory for forward computation; as in the DataWriter-based overload above, the
+        // restricted roots keep training-only branches out of both allocation and evaluation
         m_net->AllocateAllMatrices({}, outputNodes, nullptr);
 
+        PrepareOutputSubgraphForInference(outputNodes);
+
         // specify feature value nodes
         auto& featureNodes = m_net->FeatureNodes();
         std::map<std::wstring, Matrix<ElemType>*> inputMatrices;
@@ -155,6 +238,16 @@ public:
         size_t tempArraySize = 0;
         ElemType* tempArray = nullptr;
 
+        // Double-buffered write pipeline, as in the DataWriter-based overload above: outputs are copied
+        // into host staging buffers and formatted to the output streams on a background task, overlapping
+        // the disk writes with the forward propagation of the next minibatch.
+        const size_t numStagingSlots = 2;
+        std::vector<std::vector<std::vector<ElemType>>> stagingData(numStagingSlots, std::vector<std::vector<ElemType>>(outputNodes.size()));
+        std::vector<std::vector<std::pair<size_t, size_t>>> stagingDims(numStagingSlots, std::vector<std::pair<size_t, size_t>>(outputNodes.size()));
+        std::vector<std::string> formatBuffers(outputNodes.size()); // reusable text buffers; at most one write is in flight, so one set suffices
+        size_t currentSlot = 0;
+        std::future<void> pendingWrite;
+
         size_t actualMBSize;
         while (DataReaderHelpers::GetMinibatchIntoNetwork(dataReader, m_net, nullptr, false, false, inputMatrices, actualMBSize))
         {
@@ -165,24 +258,38 @@ public:
                 m_net->ForwardProp(outputNodes[i]);
 
                 Matrix<ElemType>& outputValues = dynamic_pointer_cast<ComputationNode<ElemType>>(outputNodes[i])->Value();
-                ofstream& outputStream = *outputStreams[i];
                 outputValues.CopyToArray(tempArray, tempArraySize);
-                ElemType* pCurValue = tempArray;
-                foreach_column (j, outputValues)
-                {
-                    foreach_row (k, outputValues)
-                    {
-                        outputStream << *pCurValue++ << " ";
-                    }
-                    outputStream << endl;
-                }
+                stagingData[currentSlot][i].assign(tempArray, tempArray + outputValues.GetNumElements());
+                stagingDims[currentSlot][i] = std::make_pair(outputValues.GetNumRows(), outputValues.GetNumCols());
             }
 
+            // wait for the previous write to finish before starting the next one; this also guarantees
+            // that the staging slot we fill in the next iteration is no longer being read by the writer
+            if (pendingWrite.valid())
+                pendingWrite.get();
+
+            pendingWrite = std::async(std::launch::async, [&, currentSlot]
+                                      {
+                                          for (int i = 0; i < outputStreams.size(); i++)
+                                          {
+                                              // format the whole minibatch into a reusable buffer and write it as one block;
+                                              // per-value ostream formatting caps posterior dumps at a few tens of MB/s per core
+                                              File::FormatTextRows(formatBuffers[i], stagingData[currentSlot][i].data(),
+                                                                   stagingDims[currentSlot][i].first, stagingDims[currentSlot][i].second);
+                                              outputStreams[i]->write(formatBuffers[i].data(), formatBuffers[i].size());
+                                          }
+                                      });
+            currentSlot = (currentSlot + 1) % numStagingSlots;
+
             totalEpochSamples += actualMBSize;
 
             fprintf(stderr, "Minibatch[%lu]: ActualMBSize = %lu\n", ++numMBsRun, actualMBSize);
         }
 
+        // drain the last in-flight write before closing the streams
+        if (pendingWrite.valid())
+            pendingWrite.get();
+
         fprintf(stderr, "Total Samples Evaluated = %lu\n", totalEpochSamples);
 
         // clean up
@@ -196,6 +303,21 @@ public:
     }
 
 private:
+    // Switch stochastic training nodes in the output nodes' ancestor subgraphs to their inference
+    // behavior. Currently that is dropout, whose rate is forced to 0 so the node becomes a
+    // pass-through (the mask is pre-scaled by 1/(1-rate) during training, so no further scaling is
+    // needed here). A freshly loaded model already has rate 0, but a network handed over
+    // mid-training (e.g. cloned for adaptation) may not.
+    void PrepareOutputSubgraphForInference(const std::vector<ComputationNodeBasePtr>& outputNodes)
+    {
+        for (auto& outputNode : outputNodes)
+        {
+            double prevDropoutRate = -1.0; // unknown; forces the switch
+            unsigned long dropOutSeed = 1;
+            ComputationNetwork::SetDropoutRate<ElemType>(m_net, outputNode, 0.0, prevDropoutRate, dropOutSeed);
+        }
+    }
+
     ComputationNetworkPtr m_net;
     int m_verbosity;
     void operator=(const SimpleOutputWriter&); // (not assignable)
@@ -11,6 +11,7 @@
 #include "latticearchive.h"
 #include "simplesenonehmm.h" // the model
 #include "ssematrix.h"       // the matrices
+#include "logsumexp.h"       // batched logadd for the forward/backward edge loops
 #include "latticestorage.h"
 #include <unordered_map>
 #include <list>
@@ -517,6 +518,26 @@ double lattice::forwardbackwardlattice(const std::vector<float> &edgeacscores, p
     logbetas.assign(nodes.size(), LOGZERO);
     logbetas.back() = 0.0f;
 
+    // Scratch for batching the logadd() contributions per node, so that each group can be
+    // reduced with a single vectorized log-sum-exp instead of a chain of scalar logadd()s.
+    // Edges are sorted by end node (enforced by checklattice()), so the forward pass gets its
+    // groups for free; for the backward pass we build an index of the edges grouped by start
+    // node (a counting sort; the order within a group does not matter).
+    std::vector<double> pathscores, pathaccscores;
+    pathscores.reserve(64);
+    pathaccscores.reserve(64);
+    std::vector<size_t> firstoutedge(nodes.size() + 1, 0); // [i] start of node i's group in edgesbystartnode[]
+    std::vector<size_t> edgesbystartnode(edges.size());    // edge indices grouped by start node
+    foreach_index (j, edges)
+        firstoutedge[edges[j].S + 1]++;
+    for (size_t i = 2; i <= nodes.size(); i++)
+        firstoutedge[i] += firstoutedge[i - 1];
+    {
+        std::vector<size_t> writepos(firstoutedge.begin(), firstoutedge.end() - 1);
+        foreach_index (j, edges)
+            edgesbystartnode[writepos[edges[j].S]++] = j;
+    }
+
     // --- sMBR version
 
     if (sMBRmode)
@@ -529,15 +550,31 @@ double lattice::forwardbackwardlattice(const std::vector<float> &edgeacscores, p
         std::vector<double> logframescorrectedge(edges.size());  // raw counts of correct frames in each edge
 
         // forward pass
+        // All contributions to a node's alpha are consecutive (edges are sorted by end node),
+        // so we buffer each group and reduce it in one go.
+        size_t accumnode = SIZE_MAX; // node the score buffers currently belong to
+        auto flushaccs = [&]()
+        {
+            logalphas[accumnode] = msra::math::logsumexp(pathscores.data(), pathscores.size());
+            logaccalphas[accumnode] = msra::math::logsumexp(pathaccscores.data(), pathaccscores.size());
+            pathscores.clear();
+            pathaccscores.clear();
+        };
         foreach_index (j, edges)
         {
             if (islogzero(edgeacscores[j])) // indicates that this edge is pruned
                 continue;
             const auto &e = edges[j];
-            const double inscore = logalphas[e.S];
+            if (e.E != accumnode) // entering a new group: the previous node's contributions are complete
+            {
+                if (accumnode != SIZE_MAX)
+                    flushaccs();
+                accumnode = e.E;
+            }
+            const double inscore = logalphas[e.S]; // (final, since e.S precedes the group being accumulated)
             const double edgescore = (e.l * lmf + wp + edgeacscores[j]) / amf;
             const double pathscore = inscore + edgescore;
-            logadd(logalphas[e.E], pathscore);
+            pathscores.push_back(pathscore);
 
             size_t ts = nodes[e.S].t;
             size_t te = nodes[e.E].t;
@@ -548,8 +585,10 @@ double lattice::forwardbackwardlattice(const std::vector<float> &edgeacscores, p
             double loginaccs = logaccalphas[e.S] - logalphas[e.S];
             logadd(loginaccs, logframescorrectedge[j]);
             double logpathacc = loginaccs + logalphas[e.S] + edgescore;
-            logadd(logaccalphas[e.E], logpathacc);
+            pathaccscores.push_back(logpathacc);
         }
+        if (accumnode != SIZE_MAX) // flush the last group
+            flushaccs();
         foreach_index (j, logaccalphas)
             logaccalphas[j] -= logalphas[j];
 
@@ -562,32 +601,46 @@ double lattice::forwardbackwardlattice(const std::vector<float> &edgeacscores, p
         }
 
         // backward pass and computation of state-conditioned frames-correct count
-        for (size_t j = edges.size() - 1; j + 1 > 0; j--)
+        // The beta contributions scatter over the start nodes, so this walks the nodes in
+        // reverse topological order and batches each node's out-edges through the index built
+        // above; the betas of all end nodes seen here have been finalized in earlier iterations.
+        for (size_t i = nodes.size() - 1; i + 1 > 0; i--)
         {
-            if (islogzero(edgeacscores[j])) // indicates that this edge is pruned
-                continue;
-            const auto &e = edges[j];
-            const double inscore = logbetas[e.E];
-            const double edgescore = (e.l * lmf + wp + edgeacscores[j]) / amf;
-            const double pathscore = inscore + edgescore;
-            logadd(logbetas[e.S], pathscore);
-
-            double loginaccs = logaccbetas[e.E] - logbetas[e.E];
-            logadd(loginaccs, logframescorrectedge[j]);
-            double logpathacc = loginaccs + logbetas[e.E] + edgescore;
-            logadd(logaccbetas[e.S], logpathacc);
-
-            // sum up to get final expected frames-correct count per state == per edge (since we assume hard state alignment)
-            double logpp = logalphas[e.S] + edgescore + logbetas[e.E] - totalfwscore;
-            if (logpp > 1e-2)
-                fprintf(stderr, "forwardbackward: WARNING: edge J=%d log posterior %.10f > 0\n", (int) j, (float) logpp);
-            if (logpp > 0.0)
-                logpp = 0.0;
-            logpps[j] = logpp;
-            double tmplogeframecorrect = logframescorrectedge[j];
-            logadd(tmplogeframecorrect, logaccalphas[e.S]);
-            logadd(tmplogeframecorrect, logaccbetas[e.E] - logbetas[e.E]);
-            Eframescorrectbuf[j] = exp(tmplogeframecorrect);
+            for (size_t k = firstoutedge[i]; k < firstoutedge[i + 1]; k++)
+            {
+                const size_t j = edgesbystartnode[k];
+                if (islogzero(edgeacscores[j])) // indicates that this edge is pruned
+                    continue;
+                const auto &e = edges[j]; // (e.S == i)
+                const double inscore = logbetas[e.E];
+                const double edgescore = (e.l * lmf + wp + edgeacscores[j]) / amf;
+                const double pathscore = inscore + edgescore;
+                pathscores.push_back(pathscore);
+
+                double loginaccs = logaccbetas[e.E] - logbetas[e.E];
+                logadd(loginaccs, logframescorrectedge[j]);
+                double logpathacc = loginaccs + logbetas[e.E] + edgescore;
+                pathaccscores.push_back(logpathacc);
+
+                // sum up to get final expected frames-correct count per state == per edge (since we assume hard state alignment)
+                double logpp = logalphas[e.S] + edgescore + logbetas[e.E] - totalfwscore;
+                if (logpp > 1e-2)
+                    fprintf(stderr, "forwardbackward: WARNING: edge J=%d log posterior %.10f > 0\n", (int) j, (float) logpp);
+                if (logpp > 0.0)
+                    logpp = 0.0;
+                logpps[j] = logpp;
+                double tmplogeframecorrect = logframescorrectedge[j];
+                logadd(tmplogeframecorrect, logaccalphas[e.S]);
+                logadd(tmplogeframecorrect, logaccbetas[e.E] - logbetas[e.E]);
+                Eframescorrectbuf[j] = exp(tmplogeframecorrect);
+            }
+            if (!pathscores.empty())
+            {
+                logbetas[i] = msra::math::logsumexp(pathscores.data(), pathscores.size());
+                logaccbetas[i] = msra::math::logsumexp(pathaccscores.data(), pathaccscores.size());
+                pathscores.clear();
+                pathaccscores.clear();
+            }
         }
         foreach_index (j, logaccbetas)
             logaccbetas[j] -= logbetas[j];
@@ -605,14 +658,29 @@ double lattice::forwardbackwardlattice(const std::vector<float> &edgeacscores, p
 
     // --- MMI version
 
-    // forward pass
+    // forward pass, batching the contributions per end node as in the sMBR version
+    size_t accumnode = SIZE_MAX; // node the score buffer currently belongs to
     foreach_index (j, edges)
     {
         const auto &e = edges[j];
+        if (e.E != accumnode) // entering a new group: the previous node's contributions are complete
+        {
+            if (accumnode != SIZE_MAX)
+            {
+                logalphas[accumnode] = msra::math::logsumexp(pathscores.data(), pathscores.size());
+                pathscores.clear();
+            }
+            accumnode = e.E;
+        }
         const double inscore = logalphas[e.S];
         const double edgescore = (e.l * lmf + wp + edgeacscores[j]) / amf; // note: edgeacscores[j] == LOGZERO if edge was pruned
         const double pathscore = inscore + edgescore;
-        logadd(logalphas[e.E], pathscore);
+        pathscores.push_back(pathscore);
+    }
+    if (accumnode != SIZE_MAX) // flush the last group
+    {
+        logalphas[accumnode] = msra::math::logsumexp(pathscores.data(), pathscores.size());
+        pathscores.clear();
     }
     const double totalfwscore = logalphas.back();
     if (islogzero(totalfwscore))
@@ -621,23 +689,32 @@ double lattice::forwardbackwardlattice(const std::vector<float> &edgeacscores, p
         return LOGZERO; // failed, do not use resulting matrix
     }
 
-    // backward pass
+    // backward pass, per start node in reverse topological order as in the sMBR version
     // this also computes the word posteriors on the fly, since we are at it
-    for (size_t j = edges.size() - 1; j + 1 > 0; j--)
+    for (size_t i = nodes.size() - 1; i + 1 > 0; i--)
     {
-        const auto &e = edges[j];
-        const double inscore = logbetas[e.E];
-        const double edgescore = (e.l * lmf + wp + edgeacscores[j]) / amf;
-        const double pathscore = inscore + edgescore;
-        logadd(logbetas[e.S], pathscore);
-
-        // compute lattice posteriors on the fly since we are at it
-        double logpp = logalphas[e.S] + edgescore + logbetas[e.E] - totalfwscore;
-        if (logpp > 1e-2)
-            fprintf(stderr, "forwardbackward: WARNING: edge J=%d log posterior %.10f > 0\n", (int) j, (float) logpp);
-        if (logpp > 0.0)
-            logpp = 0.0;
-        logpps[j] = logpp;
+        for (size_t k = firstoutedge[i]; k < firstoutedge[i + 1]; k++)
+        {
+            const size_t j = edgesbystartnode[k];
+            const auto &e = edges[j]; // (e.S == i)
+            const double inscore = logbetas[e.E];
+            const double edgescore = (e.l * lmf + wp + edgeacscores[j]) / amf;
+            const double pathscore = inscore + edgescore;
+            pathscores.push_back(pathscore);
+
+            // compute lattice posteriors on the fly since we are at it
+            double logpp = logalphas[e.S] + edgescore + logbetas[e.E] - totalfwscore;
+            if (logpp > 1e-2)
+                fprintf(stderr, "forwardbackward: WARNING: edge J=%d log posterior %.10f > 0\n", (int) j, (float) logpp);
+            if (logpp > 0.0)
+                logpp = 0.0;
+            logpps[j] = logpp;
+        }
+        if (!pathscores.empty())
+        {
+            logbetas[i] = msra::math::logsumexp(pathscores.data(), pathscores.size());
+            pathscores.clear();
+        }
     }
 
     const double totalbwscore = logbetas.front();
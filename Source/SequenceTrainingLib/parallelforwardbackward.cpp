@@ -605,7 +605,7 @@ struct parallelstateimpl
             logframescorrectedgegpu->allocate(edges.size());
 
         if (copyuids)
-            uidsgpu->assign(uids, true);
+            uidsgpu->assign(uids, false); // async is fine: the kernels that read this are ordered behind the copy by the stream
 
         if (allocateaccvectors)
         {
@@ -10,6 +10,9 @@
 #include <chrono>
 #include <iostream>
 #include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
 #include "Matrix.h"
 #include "CPUMatrix.h"
 #include "Sequences.h"
@@ -73,6 +76,9 @@ void rnnForwardPropSRP(Matrix<ElemType>& functionValues, size_t mNbr, Matrix<Ele
     }
 }
 
+template <class ElemType>
+void oldRNNForwardPropSRP(const size_t timeIdxInSeq, const int delay, const bool reset, const ElemType default_activity, Matrix<ElemType>& functionValues, const Matrix<ElemType>& pastActivity, const Matrix<ElemType>& inputFunctionValues, const size_t indexInBatch, const size_t mNbr);
+
 template <class ElemType>
 void oldRnnForwardPropSRP(Matrix<ElemType>& functionValues, size_t mNbr, Matrix<ElemType>& pastActivity, Matrix<ElemType>& inputFunctionValues)
 {
@@ -435,30 +441,314 @@ void MandSTest(int count, int devId)
     delete[] data3;
 }
 
-int wmain()
+// ===========================================================================
+// benchmark suite
+//
+// Times the hot Matrix kernels over a sweep of shapes, with warmup and
+// statistical repetition, and can emit the measurements as JSON. A previous
+// JSON file can be passed back in as a baseline; the run then fails (non-zero
+// exit code) if any kernel regressed beyond the threshold, so a perf drop
+// between drops breaks the build instead of shipping silently.
+// ===========================================================================
+
+struct BenchmarkResult
 {
-    ColumnSliceMultAndAddTest<float>(2048, 2048, 256, 0);
+    std::string name;
+    double meanMs;
+    double stdevMs;
+    double minMs;
+    double medianMs;
+    int repeats;
+};
+
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner(int warmup, int repeats)
+        : m_warmup(warmup), m_repeats(repeats)
+    {
+    }
 
-    TestRnnForwardPropSRP<float>();
+    // time 'body' m_repeats times (after m_warmup untimed runs) and record the statistics
+    template <class Body>
+    void Run(const std::string& name, Body body)
+    {
+        try
+        {
+            for (int i = 0; i < m_warmup; i++)
+                body();
+
+            std::vector<double> samplesMs(m_repeats);
+            for (int i = 0; i < m_repeats; i++)
+            {
+                auto t_start = std::chrono::high_resolution_clock::now();
+                body();
+                auto t_end = std::chrono::high_resolution_clock::now();
+                samplesMs[i] = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+            }
+
+            std::sort(samplesMs.begin(), samplesMs.end());
+            BenchmarkResult result;
+            result.name = name;
+            result.repeats = m_repeats;
+            result.minMs = samplesMs.front();
+            result.medianMs = samplesMs[m_repeats / 2];
+            double sum = 0;
+            for (double s : samplesMs)
+                sum += s;
+            result.meanMs = sum / m_repeats;
+            double sqSum = 0;
+            for (double s : samplesMs)
+                sqSum += (s - result.meanMs) * (s - result.meanMs);
+            result.stdevMs = m_repeats > 1 ? sqrt(sqSum / (m_repeats - 1)) : 0;
+            m_results.push_back(result);
+
+            printf("%-56s min %10.3f ms  median %10.3f ms  mean %10.3f ms  stdev %8.3f ms\n",
+                   name.c_str(), result.minMs, result.medianMs, result.meanMs, result.stdevMs);
+        }
+        catch (const std::exception& e)
+        {
+            // e.g. an op not implemented for this device/matrix-type combination
+            printf("%-56s SKIPPED (%s)\n", name.c_str(), e.what());
+        }
+    }
+
+    const std::vector<BenchmarkResult>& Results() const
+    {
+        return m_results;
+    }
+
+    // write the measurements in a machine-readable form, suitable for archiving as a baseline
+    bool WriteJson(const std::string& path) const
+    {
+        FILE* f = fopen(path.c_str(), "w");
+        if (f == nullptr)
+        {
+            fprintf(stderr, "WriteJson: cannot open '%s' for writing\n", path.c_str());
+            return false;
+        }
+        fprintf(f, "{\n  \"benchmarks\": [\n");
+        for (size_t i = 0; i < m_results.size(); i++)
+        {
+            const BenchmarkResult& r = m_results[i];
+            fprintf(f, "    { \"name\": \"%s\", \"min_ms\": %.6f, \"median_ms\": %.6f, \"mean_ms\": %.6f, \"stdev_ms\": %.6f, \"repeats\": %d }%s\n",
+                    r.name.c_str(), r.minMs, r.medianMs, r.meanMs, r.stdevMs, r.repeats, i + 1 < m_results.size() ? "," : "");
+        }
+        fprintf(f, "  ]\n}\n");
+        fclose(f);
+        return true;
+    }
+
+    // compare against a baseline JSON written by WriteJson(); returns the number of kernels whose
+    // best (min) time regressed by more than 'threshold' (e.g. 0.2 = 20% slower than baseline)
+    int CompareWithBaseline(const std::string& path, double threshold) const
+    {
+        std::map<std::string, double> baselineMinMs;
+        if (!ReadBaseline(path, baselineMinMs))
+        {
+            fprintf(stderr, "CompareWithBaseline: cannot read baseline '%s'\n", path.c_str());
+            return -1;
+        }
+
+        int regressions = 0;
+        for (const BenchmarkResult& r : m_results)
+        {
+            auto found = baselineMinMs.find(r.name);
+            if (found == baselineMinMs.end())
+            {
+                printf("BASELINE MISSING %-48s (new benchmark, not compared)\n", r.name.c_str());
+                continue;
+            }
+            double ratio = found->second > 0 ? r.minMs / found->second : 1.0;
+            if (ratio > 1.0 + threshold)
+            {
+                printf("REGRESSION       %-48s baseline %10.3f ms -> now %10.3f ms (%+.1f%%)\n",
+                       r.name.c_str(), found->second, r.minMs, (ratio - 1.0) * 100.0);
+                regressions++;
+            }
+        }
+        if (regressions == 0)
+            printf("No kernel regressed beyond %.0f%% of baseline.\n", threshold * 100.0);
+        return regressions;
+    }
+
+private:
+    // minimal parser for the JSON that WriteJson() emits (one benchmark object per line)
+    static bool ReadBaseline(const std::string& path, std::map<std::string, double>& baselineMinMs)
+    {
+        FILE* f = fopen(path.c_str(), "r");
+        if (f == nullptr)
+            return false;
+        char line[1024];
+        while (fgets(line, sizeof(line), f) != nullptr)
+        {
+            char name[256];
+            double minMs;
+            if (sscanf(line, " { \"name\": \"%255[^\"]\", \"min_ms\": %lf", name, &minMs) == 2)
+                baselineMinMs[name] = minMs;
+        }
+        fclose(f);
+        return true;
+    }
+
+    int m_warmup;
+    int m_repeats;
+    std::vector<BenchmarkResult> m_results;
+};
+
+// benchmark name including shape and device, e.g. "MultiplyAndWeightedAdd_1024x1024x1024_dev-1"
+static std::string BenchName(const char* op, size_t n, size_t k, size_t m, DEVICEID_TYPE deviceId)
+{
+    char buffer[256];
+    if (k == 0)
+        sprintf(buffer, "%s_%dx%d_dev%d", op, (int) n, (int) m, (int) deviceId);
+    else
+        sprintf(buffer, "%s_%dx%dx%d_dev%d", op, (int) n, (int) k, (int) m, (int) deviceId);
+    return buffer;
+}
+
+// force completion of asynchronously launched GPU work so the timed interval covers the kernel
+template <class ElemType>
+static void SyncResult(Matrix<ElemType>& m)
+{
+    if (m.GetDeviceId() >= 0)
+        m.Get00Element(); // a single-element readback synchronizes with the compute stream
+}
+
+template <class ElemType>
+void RunKernelBenchmarks(BenchmarkRunner& runner, DEVICEID_TYPE deviceId)
+{
+    // C = alpha * A * B + beta * C over a shape sweep covering square GEMMs and the
+    // skinny per-minibatch shapes the networks actually hit
+    const struct { size_t n, k, m; } gemmShapes[] = {{256, 256, 256}, {1024, 1024, 1024}, {2048, 2048, 256}, {1024, 4096, 128}};
+    for (const auto& shape : gemmShapes)
+    {
+        Matrix<ElemType> A(shape.n, shape.k, deviceId);
+        A.SetUniformRandomValue(-1, 1);
+        Matrix<ElemType> B(shape.k, shape.m, deviceId);
+        B.SetUniformRandomValue(-1, 1);
+        Matrix<ElemType> C(shape.n, shape.m, deviceId);
+        C.SetValue(0);
+        runner.Run(BenchName("MultiplyAndWeightedAdd", shape.n, shape.k, shape.m, deviceId), [&]()
+                   {
+                       Matrix<ElemType>::MultiplyAndWeightedAdd((ElemType) 0.324, A, false, B, false, (ElemType) 0.632, C);
+                       SyncResult(C);
+                   });
+    }
+
+    // elementwise sigmoid and transpose over a sweep of activation-sized matrices
+    const struct { size_t n, m; } elemShapes[] = {{256, 256}, {1024, 1024}, {4096, 1024}};
+    for (const auto& shape : elemShapes)
+    {
+        Matrix<ElemType> A(shape.n, shape.m, deviceId);
+        A.SetUniformRandomValue(-1, 1);
+        Matrix<ElemType> C(shape.n, shape.m, deviceId);
+        runner.Run(BenchName("AssignSigmoidOf", shape.n, 0, shape.m, deviceId), [&]()
+                   {
+                       C.AssignSigmoidOf(A);
+                       SyncResult(C);
+                   });
+        Matrix<ElemType> T(shape.m, shape.n, deviceId);
+        runner.Run(BenchName("AssignTransposeOf", shape.n, 0, shape.m, deviceId), [&]()
+                   {
+                       T.AssignTransposeOf(A);
+                       SyncResult(T);
+                   });
+    }
+
+    // sparse * dense -> dense, with input sparsity typical of one-hot/embedding layers
+    const struct { size_t n, k, m; } sparseShapes[] = {{1024, 1024, 256}, {4096, 4096, 256}};
+    for (const auto& shape : sparseShapes)
+    {
+        Matrix<ElemType> A(shape.n, shape.k, deviceId);
+        A.SetValue(0);
+        const size_t nonZerosPerColumn = std::max((size_t) 1, shape.n / 100); // ~1% density
+        for (size_t j = 0; j < shape.k; j++)
+            for (size_t z = 0; z < nonZerosPerColumn; z++)
+                A.SetValue((z * 331 + j * 17) % shape.n, j, (ElemType) 1.0);
+        A.SwitchToMatrixType(MatrixType::SPARSE, matrixFormatSparseCSC, true /*keepValues*/);
+        Matrix<ElemType> B(shape.k, shape.m, deviceId);
+        B.SetUniformRandomValue(-1, 1);
+        Matrix<ElemType> C(shape.n, shape.m, deviceId);
+        C.SetValue(0);
+        runner.Run(BenchName("SparseMultiplyAndWeightedAdd", shape.n, shape.k, shape.m, deviceId), [&]()
+                   {
+                       Matrix<ElemType>::MultiplyAndWeightedAdd((ElemType) 1.0, A, false, B, false, (ElemType) 0.0, C);
+                       SyncResult(C);
+                   });
+    }
+}
 
+// the pre-suite ad-hoc timings, kept reachable for comparison with old logs
+static void RunLegacyTests()
+{
+    ColumnSliceMultAndAddTest<float>(2048, 2048, 256, 0);
+    TestRnnForwardPropSRP<float>();
     TestOldRnnForwardPropSRP<float>();
+}
 
-    // MandSTest<float>(100, 2);
+static std::string ToNarrow(const wchar_t* s)
+{
+    std::string result;
+    for (; *s; s++)
+        result += (char) *s; // arguments are plain ASCII
+    return result;
+}
 
-    /*cout<<endl<<"********************Matrix SquareMultiplyAndWeightedAdd10TimesAvg TEST********************"<<endl;
-    SquareMultiplyAndAdd10TimesAvgTest<float>(4096,10);
+int wmain(int argc, wchar_t* argv[])
+{
+    DEVICEID_TYPE deviceId = CPUDEVICE;
+    int warmup = 2;
+    int repeats = 10;
+    double threshold = 0.2; // fail on >20% regression by default; that is the size of drop that has slipped through before
+    std::string jsonPath, baselinePath;
+    bool legacy = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = ToNarrow(argv[i]);
+        std::string value = i + 1 < argc ? ToNarrow(argv[i + 1]) : "";
+        if (arg == "--legacy")
+            legacy = true;
+        else if (arg == "--device" && !value.empty())
+            deviceId = value == "cpu" ? CPUDEVICE : (DEVICEID_TYPE) atoi(value.c_str()), i++;
+        else if (arg == "--warmup" && !value.empty())
+            warmup = atoi(value.c_str()), i++;
+        else if (arg == "--repeats" && !value.empty())
+            repeats = atoi(value.c_str()), i++;
+        else if (arg == "--threshold" && !value.empty())
+            threshold = atof(value.c_str()), i++;
+        else if (arg == "--json" && !value.empty())
+            jsonPath = value, i++;
+        else if (arg == "--baseline" && !value.empty())
+            baselinePath = value, i++;
+        else
+        {
+            fprintf(stderr, "usage: MathPerformanceTests [--device cpu|<id>] [--warmup n] [--repeats n]\n"
+                            "                            [--json out.json] [--baseline in.json] [--threshold frac] [--legacy]\n");
+            return 2;
+        }
+    }
+
+    if (legacy)
+    {
+        RunLegacyTests();
+        return 0;
+    }
+
+    printf("Math kernel benchmarks: device %d, %d warmup + %d timed runs per kernel\n", (int) deviceId, warmup, repeats);
+    BenchmarkRunner runner(warmup, repeats);
+    RunKernelBenchmarks<float>(runner, deviceId);
 
-    cout<<endl<<"********************Matrix AddMultiplyAndInplaceSigmoid TEST********************"<<endl;    
-    AddMultiplyAndInplaceSigmoidTest<float>(11,10,12);    
-    AddMultiplyAndInplaceSigmoidTest<float>(110,100,120);    
-    AddMultiplyAndInplaceSigmoidTest<float>(1100,1000,1200);    
-    AddMultiplyAndInplaceSigmoidTest<float>(11000,10000,1200);
+    if (!jsonPath.empty() && !runner.WriteJson(jsonPath))
+        return 2;
 
-    cout<<endl<<"********************Matrix MultiplyAndWeightedAdd TEST********************"<<endl;    
-    MultiplyAndWeightedAddTest<float>(11,10,12);    
-    MultiplyAndWeightedAddTest<float>(110,100,120);    
-    MultiplyAndWeightedAddTest<float>(1100,1000,1200);    
-    MultiplyAndWeightedAddTest<float>(11000,10000,12000);*/
+    if (!baselinePath.empty())
+    {
+        int regressions = runner.CompareWithBaseline(baselinePath, threshold);
+        if (regressions != 0)
+            return 1; // gate: regression (or unreadable baseline) fails the run
+    }
 
     return 0;
 }
@@ -0,0 +1,157 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// Tests of the fused batch normalization primitives of CPUMatrix against a naive
+// per-statistic reference computed in double precision.
+//
+#include "stdafx.h"
+#include <cmath>
+#include <vector>
+#include "../../../Source/Math/CPUMatrix.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+typedef CPUMatrix<double> DMatrix;
+
+const double c_bnEpsilon = 1e-5;   // the epsilon inside the inverse standard deviation
+const double c_bnTolerance = 1e-9; // comparison tolerance against the reference (absolute)
+
+// naive reference statistics: mean and inverse standard deviation of the row group
+// {s, s+S, s+2S, ...} over all columns (S == rows gives per-activation statistics)
+static void ReferenceMeanInvStdDev(const DMatrix& x, long s, long S, double& mean, double& invStdDev)
+{
+    const long D = (long) x.GetNumRows();
+    const long N = (long) x.GetNumCols();
+    const double n = (double) N * (D / S);
+
+    double sum = 0;
+    for (long j = 0; j < N; j++)
+        for (long r = s; r < D; r += S)
+            sum += x(r, j);
+    mean = sum / n;
+
+    double sqSum = 0;
+    for (long j = 0; j < N; j++)
+        for (long r = s; r < D; r += S)
+            sqSum += (x(r, j) - mean) * (x(r, j) - mean);
+    invStdDev = 1.0 / sqrt(sqSum / n + c_bnEpsilon);
+}
+
+// shared body of the forward tests; S divides D, S == D tests per-activation mode
+static void CheckBatchNormalizationForward(long D, long N, long S, unsigned long seed)
+{
+    DMatrix x = DMatrix::RandomUniform((int) D, (int) N, -2.0, 2.0, seed);
+    DMatrix scale = DMatrix::RandomUniform((int) S, 1, 0.5, 1.5, seed + 1);
+    DMatrix bias = DMatrix::RandomUniform((int) S, 1, -1.0, 1.0, seed + 2);
+    DMatrix runMean = DMatrix::RandomUniform((int) S, 1, -1.0, 1.0, seed + 3);
+    DMatrix runInvStdDev = DMatrix::RandomUniform((int) S, 1, 0.5, 1.5, seed + 4);
+    DMatrix runMeanBefore(runMean);
+    DMatrix runInvStdDevBefore(runInvStdDev);
+
+    const double expAvgFactor = 0.3;
+    DMatrix out((int) D, (int) N), saveMean((int) S, 1), saveInvStdDev((int) S, 1);
+    x.BatchNormalizationForward(scale, bias, expAvgFactor, c_bnEpsilon, runMean, runInvStdDev, out, saveMean, saveInvStdDev);
+
+    for (long s = 0; s < S; s++)
+    {
+        double mean, invStdDev;
+        ReferenceMeanInvStdDev(x, s, S, mean, invStdDev);
+
+        BOOST_CHECK_SMALL(saveMean(s, 0) - mean, c_bnTolerance);
+        BOOST_CHECK_SMALL(saveInvStdDev(s, 0) - invStdDev, c_bnTolerance);
+
+        // running statistics blend by the exponential-average factor
+        BOOST_CHECK_SMALL(runMean(s, 0) - ((1 - expAvgFactor) * runMeanBefore(s, 0) + expAvgFactor * mean), c_bnTolerance);
+        BOOST_CHECK_SMALL(runInvStdDev(s, 0) - ((1 - expAvgFactor) * runInvStdDevBefore(s, 0) + expAvgFactor * invStdDev), c_bnTolerance);
+
+        for (long j = 0; j < N; j++)
+            for (long r = s; r < D; r += S)
+                BOOST_CHECK_SMALL(out(r, j) - (scale(s, 0) * (x(r, j) - mean) * invStdDev + bias(s, 0)), c_bnTolerance);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(BatchNormalizationSuite)
+
+BOOST_FIXTURE_TEST_CASE(CPUBatchNormalizationForwardPerActivation, RandomSeedFixture)
+{
+    CheckBatchNormalizationForward(16, 64, 16, IncrementCounter());
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUBatchNormalizationForwardSpatial, RandomSeedFixture)
+{
+    // 3 statistics shared across 4 rows each (channels fastest-varying)
+    CheckBatchNormalizationForward(12, 10, 3, IncrementCounter());
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUBatchNormalizationForwardInference, RandomSeedFixture)
+{
+    const long D = 12, N = 7, S = 4;
+    DMatrix x = DMatrix::RandomUniform(D, N, -2.0, 2.0, IncrementCounter());
+    DMatrix scale = DMatrix::RandomUniform(S, 1, 0.5, 1.5, IncrementCounter());
+    DMatrix bias = DMatrix::RandomUniform(S, 1, -1.0, 1.0, IncrementCounter());
+    DMatrix runMean = DMatrix::RandomUniform(S, 1, -1.0, 1.0, IncrementCounter());
+    DMatrix runInvStdDev = DMatrix::RandomUniform(S, 1, 0.5, 1.5, IncrementCounter());
+
+    DMatrix out(D, N);
+    x.BatchNormalizationForwardInference(scale, bias, runMean, runInvStdDev, out);
+
+    for (long j = 0; j < N; j++)
+        for (long r = 0; r < D; r++)
+        {
+            long s = r % S;
+            BOOST_CHECK_SMALL(out(r, j) - (scale(s, 0) * (x(r, j) - runMean(s, 0)) * runInvStdDev(s, 0) + bias(s, 0)), c_bnTolerance);
+        }
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUBatchNormalizationBackward, RandomSeedFixture)
+{
+    const long D = 8, N = 16, S = 4;
+    DMatrix x = DMatrix::RandomUniform(D, N, -2.0, 2.0, IncrementCounter());
+    DMatrix dy = DMatrix::RandomUniform(D, N, -1.0, 1.0, IncrementCounter());
+    DMatrix scale = DMatrix::RandomUniform(S, 1, 0.5, 1.5, IncrementCounter());
+    DMatrix bias = DMatrix::RandomUniform(S, 1, -1.0, 1.0, IncrementCounter());
+
+    // obtain saved statistics from a forward pass, the way the engine calls it
+    DMatrix runMean(S, 1), runInvStdDev(S, 1), out(D, N), saveMean(S, 1), saveInvStdDev(S, 1);
+    runMean.SetValue(0.0);
+    runInvStdDev.SetValue(0.0);
+    x.BatchNormalizationForward(scale, bias, 1.0, c_bnEpsilon, runMean, runInvStdDev, out, saveMean, saveInvStdDev);
+
+    // the input gradient accumulates, so prime it with a known value
+    DMatrix grad = DMatrix::RandomUniform(D, N, -1.0, 1.0, IncrementCounter());
+    DMatrix gradBefore(grad);
+    DMatrix scaleGrad(S, 1), biasGrad(S, 1);
+    dy.BatchNormalizationBackward(x, grad, scale, saveMean, saveInvStdDev, scaleGrad, biasGrad);
+
+    const double n = (double) N * (D / S);
+    for (long s = 0; s < S; s++)
+    {
+        const double mean = saveMean(s, 0);
+        const double invStdDev = saveInvStdDev(s, 0);
+
+        double dBias = 0, dScale = 0;
+        for (long j = 0; j < N; j++)
+            for (long r = s; r < D; r += S)
+            {
+                dBias += dy(r, j);
+                dScale += dy(r, j) * (x(r, j) - mean) * invStdDev;
+            }
+        BOOST_CHECK_SMALL(biasGrad(s, 0) - dBias, c_bnTolerance);
+        BOOST_CHECK_SMALL(scaleGrad(s, 0) - dScale, c_bnTolerance);
+
+        for (long j = 0; j < N; j++)
+            for (long r = s; r < D; r += S)
+            {
+                double xHat = (x(r, j) - mean) * invStdDev;
+                double dx = scale(s, 0) * invStdDev * (dy(r, j) - (dBias + xHat * dScale) / n);
+                BOOST_CHECK_SMALL(grad(r, j) - (gradBefore(r, j) + dx), c_bnTolerance);
+            }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}
+} } }
@@ -3,6 +3,10 @@
 // Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
 //
 #include "stdafx.h"
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
 #include "../../../Source/Math/CPUMatrix.h"
 
 using namespace Microsoft::MSR::CNTK;
@@ -898,6 +902,85 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixSeedingDouble, RandomSeedFixture)
     BOOST_CHECK(m1.IsEqualTo(m2));
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUMatrixVectorMaxTopK, RandomSeedFixture)
+{
+    const int rows = 32;
+    const int cols = 17;
+    const int topK = 5;
+    SMatrix m = SMatrix::RandomUniform(rows, cols, -10.0f, 10.0f, IncrementCounter());
+
+    SMatrix maxIndexes, maxValues;
+    m.VectorMax(maxIndexes, maxValues, true, topK);
+    BOOST_REQUIRE_EQUAL(maxValues.GetNumRows(), topK);
+    BOOST_REQUIRE_EQUAL(maxValues.GetNumCols(), cols);
+    BOOST_REQUIRE_EQUAL(maxIndexes.GetNumRows(), topK);
+    BOOST_REQUIRE_EQUAL(maxIndexes.GetNumCols(), cols);
+
+    SMatrix top1Indexes, top1Values;
+    m.VectorMax(top1Indexes, top1Values, true, 1);
+
+    for (int j = 0; j < cols; j++)
+    {
+        // reference: the k largest values of the column, by full sort
+        std::vector<float> reference(rows);
+        for (int i = 0; i < rows; i++)
+            reference[i] = m(i, j);
+        std::sort(reference.begin(), reference.end(), std::greater<float>());
+
+        // the selection returns the top k in unspecified order; each value must sit at its index
+        std::vector<float> selected(topK);
+        for (int i = 0; i < topK; i++)
+        {
+            selected[i] = maxValues(i, j);
+            BOOST_CHECK_EQUAL(m((int) maxIndexes(i, j), j), maxValues(i, j));
+        }
+        std::sort(selected.begin(), selected.end(), std::greater<float>());
+        for (int i = 0; i < topK; i++)
+            BOOST_CHECK_EQUAL(selected[i], reference[i]);
+
+        // and the largest of them must agree with the dedicated top-1 path
+        BOOST_CHECK_EQUAL(selected[0], top1Values(0, j));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUMatrixAssignTopKError, RandomSeedFixture)
+{
+    const int numClasses = 20;
+    const int numSamples = 50;
+    SMatrix predictions = SMatrix::RandomUniform(numClasses, numSamples, 0.0f, 1.0f, IncrementCounter());
+
+    // one-hot labels with a random true class per sample
+    std::mt19937 rng(IncrementCounter());
+    SMatrix labels(numClasses, numSamples);
+    labels.SetValue(0.0f);
+    std::vector<int> trueClass(numSamples);
+    for (int j = 0; j < numSamples; j++)
+    {
+        trueClass[j] = rng() % numClasses;
+        labels(trueClass[j], j) = 1.0f;
+    }
+
+    for (int topK : {1, 3, 5, numClasses})
+    {
+        // reference: a sample is an error iff at least k predictions beat the one at the label
+        float referenceErrors = 0;
+        for (int j = 0; j < numSamples; j++)
+        {
+            const float predAtLabel = predictions(trueClass[j], j);
+            int numGreater = 0;
+            for (int i = 0; i < numClasses; i++)
+                numGreater += (predictions(i, j) > predAtLabel);
+            referenceErrors += (numGreater >= topK);
+        }
+
+        SMatrix errors;
+        errors.AssignTopKError(labels, predictions, topK);
+        BOOST_REQUIRE_EQUAL(errors.GetNumRows(), 1);
+        BOOST_REQUIRE_EQUAL(errors.GetNumCols(), 1);
+        BOOST_CHECK_EQUAL(errors(0, 0), referenceErrors);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }
 } } }
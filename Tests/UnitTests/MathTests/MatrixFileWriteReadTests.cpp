@@ -12,6 +12,11 @@
 #include "../../Common/File.cpp"
 #include "../../Common/fileutil.cpp"
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
 #include <string>
 
 using namespace Microsoft::MSR::CNTK;
@@ -94,6 +99,135 @@ BOOST_FIXTURE_TEST_CASE(GPUMatrixFileWriteRead, RandomSeedFixture)
     BOOST_CHECK(matrixGpuCopy.IsEqualTo(matrixGpuRead, c_epsilonFloatE5));
 }
 
+BOOST_AUTO_TEST_SUITE_END()
+
+// ----------------------------------------------------------------------------
+// File::FormatFloatText() (Grisu2 shortest-representation formatting)
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(FileFormattingSuite)
+
+static std::string FormatToString(double value)
+{
+    char buffer[32];
+    size_t len = File::FormatFloatText(buffer, value);
+    BOOST_REQUIRE(len > 0 && len < sizeof(buffer));
+    return std::string(buffer, len);
+}
+
+static std::string FormatToString(float value)
+{
+    char buffer[32];
+    size_t len = File::FormatFloatText(buffer, value);
+    BOOST_REQUIRE(len > 0 && len < sizeof(buffer));
+    return std::string(buffer, len);
+}
+
+static double FormatAndParseBack(double value)
+{
+    return strtod(FormatToString(value).c_str(), nullptr);
+}
+
+static float FormatAndParseBack(float value)
+{
+    return strtof(FormatToString(value).c_str(), nullptr);
+}
+
+BOOST_FIXTURE_TEST_CASE(FormatFloatTextSpecialValues, RandomSeedFixture)
+{
+    BOOST_CHECK_EQUAL(FormatToString(0.0), "0");
+    BOOST_CHECK_EQUAL(FormatToString(-0.0), "0"); // the sign of a zero is not preserved
+    BOOST_CHECK_EQUAL(FormatToString(1.0), "1");
+    BOOST_CHECK_EQUAL(FormatToString(-1.0), "-1");
+    BOOST_CHECK_EQUAL(FormatToString(0.1f), "0.1"); // single-precision boundaries keep float output short
+    BOOST_CHECK_EQUAL(FormatToString(std::numeric_limits<double>::quiet_NaN()), "nan");
+    BOOST_CHECK_EQUAL(FormatToString(std::numeric_limits<double>::infinity()), "inf");
+    BOOST_CHECK_EQUAL(FormatToString(-std::numeric_limits<double>::infinity()), "-inf");
+}
+
+BOOST_FIXTURE_TEST_CASE(FormatFloatTextBoundaryValues, RandomSeedFixture)
+{
+    // exact round trip at the extremes of both precisions
+    BOOST_CHECK_EQUAL(FormatAndParseBack(std::numeric_limits<double>::denorm_min()), std::numeric_limits<double>::denorm_min());
+    BOOST_CHECK_EQUAL(FormatAndParseBack(std::numeric_limits<double>::min()), std::numeric_limits<double>::min());
+    BOOST_CHECK_EQUAL(FormatAndParseBack(std::numeric_limits<double>::max()), std::numeric_limits<double>::max());
+    BOOST_CHECK_EQUAL(FormatAndParseBack(std::numeric_limits<double>::lowest()), std::numeric_limits<double>::lowest());
+    BOOST_CHECK_EQUAL(FormatAndParseBack(std::numeric_limits<float>::denorm_min()), std::numeric_limits<float>::denorm_min());
+    BOOST_CHECK_EQUAL(FormatAndParseBack(std::numeric_limits<float>::min()), std::numeric_limits<float>::min());
+    BOOST_CHECK_EQUAL(FormatAndParseBack(std::numeric_limits<float>::max()), std::numeric_limits<float>::max());
+
+    for (double p = 1e-300; p <= 1e300; p *= 10)
+        BOOST_CHECK_EQUAL(FormatAndParseBack(p), p);
+}
+
+BOOST_FIXTURE_TEST_CASE(FormatFloatTextRoundTripDouble, RandomSeedFixture)
+{
+    // random bit patterns round-trip bit-exact through strtod
+    std::mt19937_64 rng(IncrementCounter());
+    for (int i = 0; i < 100000; i++)
+    {
+        uint64_t bits = rng();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!(value == value) || value - value != 0 || value == 0) // NaN, infinity, +-0
+            continue;
+        double parsed = FormatAndParseBack(value);
+        uint64_t parsedBits;
+        memcpy(&parsedBits, &parsed, sizeof(parsedBits));
+        BOOST_REQUIRE_EQUAL(parsedBits, bits);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(FormatFloatTextRoundTripFloat, RandomSeedFixture)
+{
+    // random bit patterns round-trip bit-exact through strtof
+    std::mt19937 rng(IncrementCounter());
+    for (int i = 0; i < 100000; i++)
+    {
+        uint32_t bits = rng();
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!(value == value) || value - value != 0 || value == 0) // NaN, infinity, +-0
+            continue;
+        float parsed = FormatAndParseBack(value);
+        uint32_t parsedBits;
+        memcpy(&parsedBits, &parsed, sizeof(parsedBits));
+        BOOST_REQUIRE_EQUAL(parsedBits, bits);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(FormatFloatTextPrintfParity, RandomSeedFixture)
+{
+    // parses back to the same value as a round-trip-precision printf (the notations differ;
+    // e.g. the formatter prefers fixed form over a wider exponent range than %g does)
+    std::mt19937_64 rng(IncrementCounter());
+    char printfBuffer[64];
+    for (int i = 0; i < 10000; i++)
+    {
+        uint64_t bits = rng();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!(value == value) || value - value != 0 || value == 0)
+            continue;
+        std::string ours = FormatToString(value);
+        sprintf(printfBuffer, "%.17g", value);
+        BOOST_REQUIRE_EQUAL(strtod(ours.c_str(), nullptr), strtod(printfBuffer, nullptr));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(FormatTextRowsLayout, RandomSeedFixture)
+{
+    // column-major data comes out as one line per column, elements space-terminated
+    const float data[] = {1.0f, 2.5f, -3.0f, 4.0f}; // 2 rows x 2 columns
+    std::string buffer;
+    File::FormatTextRows(buffer, data, 2, 2);
+    BOOST_CHECK_EQUAL(buffer, "1 2.5 \n-3 4 \n");
+
+    // the buffer is cleared on entry, so it can be reused across minibatches
+    File::FormatTextRows(buffer, data, 4, 1);
+    BOOST_CHECK_EQUAL(buffer, "1 2.5 -3 4 \n");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }
 } } }
@@ -0,0 +1,94 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// Tests of the merge/no-merge decisions of EliminateCommonSubexpressions(). The
+// graphs use Log/Plus only, which none of the fusion passes that run in the same
+// compilation rewrite, so the node counts below reflect the CSE pass alone.
+//
+#include "stdafx.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetwork.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetworkBuilder.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// build features -> { left = Log(features), right = Log(features) } -> out = Plus(left, right);
+// 'left' and 'right' are structurally identical, so CSE may merge them unless told otherwise
+struct DuplicateLogNetwork
+{
+    ComputationNetworkPtr net;
+    shared_ptr<ComputationNode<float>> features, left, right, out;
+
+    DuplicateLogNetwork()
+    {
+        net = make_shared<ComputationNetwork>(CPUDEVICE);
+        ComputationNetworkBuilder<float> builder(*net);
+        features = builder.CreateInputNode(L"features", 3);
+        left = builder.Log(features, L"left");
+        right = builder.Log(features, L"right");
+        out = builder.Plus(left, right, L"out");
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(CsePassSuite)
+
+BOOST_AUTO_TEST_CASE(CseMergesDuplicateSubtrees)
+{
+    DuplicateLogNetwork dup;
+    dup.net->EnableGraphOptimizations(true);
+    dup.net->CompileNetwork();
+
+    // one of the duplicates is merged away...
+    BOOST_CHECK_EQUAL(dup.net->GetTotalNumberOfNodes(), 3u); // features, one Log, out
+
+    // ...and both names resolve to the surviving node
+    BOOST_CHECK(dup.net->GetNodeFromName(L"left") == dup.net->GetNodeFromName(L"right"));
+    BOOST_CHECK(dup.net->GetNodeFromName(L"out")->Input(0) == dup.net->GetNodeFromName(L"out")->Input(1));
+}
+
+BOOST_AUTO_TEST_CASE(CseDisabledByDefault)
+{
+    // graph optimizations are opt-in; without them the duplicates must survive
+    DuplicateLogNetwork dup;
+    dup.net->CompileNetwork();
+
+    BOOST_CHECK_EQUAL(dup.net->GetTotalNumberOfNodes(), 4u);
+    BOOST_CHECK(dup.net->GetNodeFromName(L"left") != dup.net->GetNodeFromName(L"right"));
+}
+
+BOOST_AUTO_TEST_CASE(CseKeepsNodeGroupMembers)
+{
+    // nodes that configs refer to by name (here: tagged as outputs) keep their identity
+    // even when a structurally identical twin exists
+    DuplicateLogNetwork dup;
+    dup.net->OutputNodes().push_back(dup.left);
+    dup.net->OutputNodes().push_back(dup.right);
+    dup.net->EnableGraphOptimizations(true);
+    dup.net->CompileNetwork();
+
+    BOOST_CHECK_EQUAL(dup.net->GetTotalNumberOfNodes(), 4u);
+    BOOST_CHECK(dup.net->GetNodeFromName(L"left") != dup.net->GetNodeFromName(L"right"));
+}
+
+BOOST_AUTO_TEST_CASE(CseSkipsNonMergeableOperations)
+{
+    // Dropout carries private random state, so identical Dropout siblings must not merge
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<float> builder(*net);
+    auto features = builder.CreateInputNode(L"features", 3);
+    auto left = builder.Dropout(features, L"left");
+    auto right = builder.Dropout(features, L"right");
+    builder.Plus(left, right, L"out");
+
+    net->EnableGraphOptimizations(true);
+    net->CompileNetwork();
+
+    BOOST_CHECK_EQUAL(net->GetTotalNumberOfNodes(), 4u);
+    BOOST_CHECK(net->GetNodeFromName(L"left") != net->GetNodeFromName(L"right"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}
+} } }
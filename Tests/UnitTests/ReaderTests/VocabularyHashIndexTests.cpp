@@ -0,0 +1,104 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// Tests of the open-addressing vocabulary index the LM sequence readers use to
+// accelerate label-to-id lookups.
+//
+#include "stdafx.h"
+#include <map>
+#include <string>
+#include "../../../Source/Readers/LMSequenceReader/VocabularyHashIndex.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+BOOST_AUTO_TEST_SUITE(VocabularyHashIndexSuite)
+
+BOOST_AUTO_TEST_CASE(VocabularyHashIndexFindParityWithMap)
+{
+    // synthesized vocabulary; w0, w1, ... plus some typical token shapes
+    std::map<std::string, unsigned> vocabulary;
+    for (unsigned i = 0; i < 1000; i++)
+        vocabulary["w" + std::to_string(i)] = i;
+    vocabulary["<s>"] = 1000;
+    vocabulary["</s>"] = 1001;
+    vocabulary["<unk>"] = 1002;
+    vocabulary[""] = 1003; // the empty label hashes and probes like any other
+
+    VocabularyHashIndex index;
+    index.Build(vocabulary, 1);
+    BOOST_REQUIRE_EQUAL(index.Size(), vocabulary.size());
+
+    for (const auto& entry : vocabulary)
+    {
+        unsigned id = 0;
+        BOOST_REQUIRE(index.Find(entry.first, id));
+        BOOST_REQUIRE_EQUAL(id, entry.second);
+    }
+
+    // absent labels must miss, including near-collisions of present ones
+    unsigned id = 0;
+    BOOST_CHECK(!index.Find("w1000", id));
+    BOOST_CHECK(!index.Find("W0", id));
+    BOOST_CHECK(!index.Find("<S>", id));
+}
+
+BOOST_AUTO_TEST_CASE(VocabularyHashIndexEmpty)
+{
+    VocabularyHashIndex index;
+    BOOST_CHECK_EQUAL(index.Size(), 0u);
+
+    unsigned id = 0;
+    BOOST_CHECK(!index.Find("anything", id));
+
+    // building from an empty map is valid and still finds nothing
+    std::map<std::string, unsigned> empty;
+    index.Build(empty, 1);
+    BOOST_CHECK_EQUAL(index.Size(), 0u);
+    BOOST_CHECK(!index.Find("anything", id));
+}
+
+BOOST_AUTO_TEST_CASE(VocabularyHashIndexGenerationTracking)
+{
+    VocabularyHashIndex index;
+    BOOST_CHECK_EQUAL(index.Generation(), (size_t) -1); // never built
+
+    std::map<std::string, unsigned> vocabulary;
+    vocabulary["a"] = 0;
+    index.Build(vocabulary, 7);
+    BOOST_CHECK_EQUAL(index.Generation(), 7u);
+
+    index.Clear();
+    BOOST_CHECK_EQUAL(index.Generation(), (size_t) -1);
+    BOOST_CHECK_EQUAL(index.Size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(VocabularyHashIndexSameSizeRemap)
+{
+    // SetLabelMapping() may replace the whole mapping without changing its size;
+    // the generation counter is what makes the index notice such a change
+    std::map<std::string, unsigned> vocabulary;
+    vocabulary["a"] = 0;
+    vocabulary["b"] = 1;
+
+    VocabularyHashIndex index;
+    index.Build(vocabulary, 1);
+
+    vocabulary["a"] = 1;
+    vocabulary["b"] = 0;
+    BOOST_CHECK(index.Generation() != 2); // a reader would rebuild at this point
+    index.Build(vocabulary, 2);
+    BOOST_CHECK_EQUAL(index.Generation(), 2u);
+
+    unsigned id = 0;
+    BOOST_REQUIRE(index.Find("a", id));
+    BOOST_CHECK_EQUAL(id, 1u);
+    BOOST_REQUIRE(index.Find("b", id));
+    BOOST_CHECK_EQUAL(id, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}
+} } }